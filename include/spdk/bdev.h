@@ -227,8 +227,15 @@ struct spdk_bdev_ext_io_opts {
 	 * request is submitted.
 	 */
 	struct spdk_accel_sequence *accel_sequence;
+	/**
+	 * Placement hint of a write, 0 for none.  Writes sharing a hint are expected to have
+	 * a similar lifetime, e.g. belong to the same data stream, so that bdevs supporting data
+	 * placement (like NVMe namespaces with Flexible Data Placement enabled) can store them
+	 * together.  Bdevs without such support ignore it.
+	 */
+	uint16_t placement_hint;
 } __attribute__((packed));
-SPDK_STATIC_ASSERT(sizeof(struct spdk_bdev_ext_io_opts) == 40, "Incorrect size");
+SPDK_STATIC_ASSERT(sizeof(struct spdk_bdev_ext_io_opts) == 42, "Incorrect size");
 
 /**
  * Get the options for the bdev module.
@@ -567,6 +574,17 @@ uint32_t spdk_bdev_get_block_size(const struct spdk_bdev *bdev);
  */
 uint32_t spdk_bdev_get_write_unit_size(const struct spdk_bdev *bdev);
 
+/**
+ * Get the NUMA node of the device backing this bdev.
+ *
+ * Threads running on that node get the best performance out of the bdev.
+ *
+ * \param bdev Block device to query.
+ *
+ * \return NUMA node ID of the bdev, or -1 (SPDK_ENV_SOCKET_ID_ANY) if unknown.
+ */
+int32_t spdk_bdev_get_numa_id(const struct spdk_bdev *bdev);
+
 /**
  * Get size of block device in logical blocks.
  *
@@ -608,6 +626,175 @@ void spdk_bdev_get_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits);
 void spdk_bdev_set_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits,
 				   void (*cb_fn)(void *cb_arg, int status), void *cb_arg);
 
+/**
+ * Create a quality of service group.
+ *
+ * The rate limits of a group are shared by all bdevs that are added to it with
+ * spdk_bdev_set_qos_group(). They are enforced together with the rate limits of
+ * each bdev, so an I/O is only submitted if both the bdev and its group have quota
+ * left in the current timeslice.
+ *
+ * The group's quota is replenished by a poller on the calling thread.
+ *
+ * \param name Unique name of the group.
+ * \param limits Pointer to the QoS rate limits array which holding the limits.
+ * UINT64_MAX or 0 means that a limit is not set.
+ *
+ * \return 0 on success, negated errno on failure.
+ *
+ * The limits are ordered based on the @ref spdk_bdev_qos_rate_limit_type enum.
+ */
+int spdk_bdev_qos_group_create(const char *name, uint64_t *limits);
+
+/**
+ * Delete a quality of service group. The group must not have any bdevs.
+ *
+ * \param name Name of the group.
+ *
+ * \return 0 on success, -ENOENT if the group does not exist, -EBUSY if bdevs are
+ * still attached to it.
+ */
+int spdk_bdev_qos_group_delete(const char *name);
+
+/**
+ * Set the rate limits of a quality of service group.
+ *
+ * \param name Name of the group.
+ * \param limits Pointer to the QoS rate limits array which holding the limits.
+ * UINT64_MAX means that a limit is not changed, 0 means unlimited.
+ *
+ * \return 0 on success, -ENOENT if the group does not exist.
+ *
+ * The limits are ordered based on the @ref spdk_bdev_qos_rate_limit_type enum.
+ */
+int spdk_bdev_qos_group_set_rate_limits(const char *name, uint64_t *limits);
+
+/**
+ * Get the rate limits of a quality of service group.
+ *
+ * \param name Name of the group.
+ * \param limits Pointer to the QoS rate limits array which holding the limits.
+ *
+ * \return 0 on success, -ENOENT if the group does not exist.
+ *
+ * The limits are ordered based on the @ref spdk_bdev_qos_rate_limit_type enum.
+ */
+int spdk_bdev_qos_group_get_rate_limits(const char *name, uint64_t *limits);
+
+/**
+ * Add a bdev to a quality of service group or remove it from its group.
+ *
+ * A bdev can be a member of a single group at a time. It has to be removed from
+ * its current group before it can be added to a different one.
+ *
+ * \param bdev Block device.
+ * \param group_name Name of the group to add the bdev to, or NULL to remove the bdev
+ * from its current group.
+ * \param cb_fn Callback function to be called when the group has been updated.
+ * \param cb_arg Argument to pass to cb_fn.
+ */
+void spdk_bdev_set_qos_group(struct spdk_bdev *bdev, const char *group_name,
+			     void (*cb_fn)(void *cb_arg, int status), void *cb_arg);
+
+/**
+ * Get the name of the quality of service group a bdev belongs to.
+ *
+ * \param bdev Block device to query.
+ *
+ * \return Name of the group or NULL if the bdev is not a member of any group.
+ */
+const char *spdk_bdev_get_qos_group(struct spdk_bdev *bdev);
+
+/**
+ * Set the tail latency target of a bdev.
+ *
+ * The 99th percentile latency of the read and write I/O to the bdev is sampled
+ * periodically. Whenever it exceeds the target, the throughput of the members of
+ * the same quality of service group that have no latency target (best-effort
+ * bdevs) is reduced. It is gradually restored while the target is met. Setting
+ * a target on a bdev that is not a member of any group only enables the latency
+ * sampling.
+ *
+ * \param bdev Block device.
+ * \param latency_target_us Latency target in microseconds. 0 removes the target
+ * and makes the bdev best-effort again.
+ * \param cb_fn Callback function to be called when the target has been updated.
+ * \param cb_arg Argument to pass to cb_fn.
+ */
+void spdk_bdev_set_qos_latency_target(struct spdk_bdev *bdev, uint64_t latency_target_us,
+				      void (*cb_fn)(void *cb_arg, int status), void *cb_arg);
+
+/**
+ * Get the tail latency target of a bdev.
+ *
+ * \param bdev Block device to query.
+ *
+ * \return Latency target in microseconds or 0 if the bdev has no latency target.
+ */
+uint64_t spdk_bdev_get_qos_latency_target(struct spdk_bdev *bdev);
+
+struct spdk_bdev_merge_opts {
+	/**
+	 * The size of spdk_bdev_merge_opts according to the caller of this library is used for
+	 * ABI compatibility. The library uses this field to know how many fields in this
+	 * structure are valid. And the library will populate any remaining fields with default
+	 * values.
+	 */
+	size_t size;
+
+	/**
+	 * Maximum time in microseconds a read or write is held back waiting for I/O it can be
+	 * merged with. Default: 0, i.e. merging is disabled.
+	 */
+	uint32_t window_us;
+
+	/**
+	 * Maximum number of I/O merged into one. Reaching it submits the merged I/O right away.
+	 * Default: 32, which is also the upper limit.
+	 */
+	uint32_t max_ios;
+
+	/** Maximum size of a merged I/O in blocks. Default: 0, i.e. not limited. */
+	uint64_t max_blocks;
+};
+SPDK_STATIC_ASSERT(sizeof(struct spdk_bdev_merge_opts) == 24, "Incorrect size");
+
+/**
+ * Initialize spdk_bdev_merge_opts with default values.
+ *
+ * \param opts Options to initialize.
+ * \param size Size of opts, sizeof(struct spdk_bdev_merge_opts).
+ */
+void spdk_bdev_merge_opts_init(struct spdk_bdev_merge_opts *opts, size_t size);
+
+/**
+ * Set the merging options of a bdev.
+ *
+ * When merging is enabled, each channel of the bdev holds back reads and writes for up to
+ * window_us and merges the ones of the same type that are LBA-contiguous into a single I/O
+ * to the bdev module. The original I/O are completed once the merged I/O completes, with
+ * its status. I/O with metadata buffers, memory domains or accel sequences are never merged.
+ * I/O statistics count the original I/O, not the merged ones.
+ *
+ * \param bdev Block device.
+ * \param opts Merging options.
+ * \param cb_fn Callback function to be called when the options have been applied to all
+ * channels of the bdev.
+ * \param cb_arg Argument to pass to cb_fn.
+ */
+void spdk_bdev_set_merge_opts(struct spdk_bdev *bdev, const struct spdk_bdev_merge_opts *opts,
+			      void (*cb_fn)(void *cb_arg, int status), void *cb_arg);
+
+/**
+ * Get the merging options of a bdev.
+ *
+ * \param bdev Block device to query.
+ * \param opts Options to fill in.
+ * \param size Size of opts, sizeof(struct spdk_bdev_merge_opts).
+ */
+void spdk_bdev_get_merge_opts(struct spdk_bdev *bdev, struct spdk_bdev_merge_opts *opts,
+			      size_t size);
+
 /**
  * Get minimum I/O buffer address alignment for a bdev.
  *
@@ -851,6 +1038,101 @@ struct spdk_io_channel *spdk_bdev_get_io_channel(struct spdk_bdev_desc *desc);
  */
 void *spdk_bdev_get_module_ctx(struct spdk_bdev_desc *desc);
 
+/**
+ * Options of the I/O pool registered on a bdev I/O channel.
+ */
+struct spdk_bdev_channel_io_pool_opts {
+	/** Size of this structure in bytes, should be set to sizeof(struct spdk_bdev_channel_io_pool_opts) */
+	size_t size;
+
+	/** Number of spdk_bdev_io structures reserved for the I/O channel. */
+	uint32_t num_bdev_ios;
+
+	/**
+	 * Size of each buffer in buf_pool. Must be a multiple of spdk_bdev_get_buf_align()
+	 * and at least sizeof(void *).
+	 */
+	uint32_t buf_size;
+
+	/**
+	 * Memory holding num_bufs buffers of buf_size bytes each, aligned to
+	 * spdk_bdev_get_buf_align(). Optional, the memory is owned by the caller and has to
+	 * stay valid until the pool is unregistered.
+	 */
+	void *buf_pool;
+
+	/** Number of buffers in buf_pool. */
+	uint32_t num_bufs;
+
+	uint8_t reserved[4];
+} __attribute__((packed));
+SPDK_STATIC_ASSERT(sizeof(struct spdk_bdev_channel_io_pool_opts) == 32, "Incorrect size");
+
+/**
+ * Initialize I/O pool options with default values.
+ *
+ * \param opts Options to initialize.
+ * \param opts_size sizeof(*opts)
+ */
+void spdk_bdev_channel_io_pool_opts_init(struct spdk_bdev_channel_io_pool_opts *opts,
+		size_t opts_size);
+
+/**
+ * Register an I/O pool on a bdev I/O channel.
+ *
+ * I/O submitted on the channel take their spdk_bdev_io from the pool instead of the global
+ * spdk_bdev_io pool, falling back to the global pool only when the pool is exhausted.
+ *
+ * If a buffer pool is provided, its alignment is checked once here. From then on, all data
+ * buffers submitted on the channel are trusted to satisfy spdk_bdev_get_buf_align(), so the
+ * bdev layer no longer checks the alignment of each I/O and never bounces it. The caller
+ * has to make sure the buffers are either taken from the pool via
+ * spdk_bdev_channel_get_pool_buf() or aligned by other means.
+ *
+ * This function must be called from the thread the I/O channel belongs to.
+ *
+ * \param ch I/O channel. Obtained by calling spdk_bdev_get_io_channel().
+ * \param opts Options of the I/O pool.
+ *
+ * \return 0 on success.
+ * \return -EINVAL if the options are invalid or the buffer pool is not aligned.
+ * \return -EEXIST if an I/O pool is already registered on the channel.
+ * \return -ENOMEM if the spdk_bdev_io structures couldn't be allocated.
+ */
+int spdk_bdev_channel_register_io_pool(struct spdk_io_channel *ch,
+				       const struct spdk_bdev_channel_io_pool_opts *opts);
+
+/**
+ * Unregister the I/O pool from a bdev I/O channel. An I/O pool still registered when the
+ * I/O channel is released is unregistered implicitly.
+ *
+ * This function must be called from the thread the I/O channel belongs to.
+ *
+ * \param ch I/O channel. Obtained by calling spdk_bdev_get_io_channel().
+ *
+ * \return 0 on success.
+ * \return -ENOENT if no I/O pool is registered on the channel.
+ * \return -EBUSY if spdk_bdev_io structures or buffers of the pool are still in use.
+ */
+int spdk_bdev_channel_unregister_io_pool(struct spdk_io_channel *ch);
+
+/**
+ * Get a buffer from the buffer pool registered on a bdev I/O channel.
+ *
+ * \param ch I/O channel. Obtained by calling spdk_bdev_get_io_channel().
+ *
+ * \return Pointer to a buffer of the pool's buf_size bytes or NULL if none is available.
+ */
+void *spdk_bdev_channel_get_pool_buf(struct spdk_io_channel *ch);
+
+/**
+ * Return a buffer obtained by spdk_bdev_channel_get_pool_buf() to the pool.
+ *
+ * \param ch I/O channel the buffer was obtained from.
+ * \param buf Buffer to return.
+ */
+void spdk_bdev_channel_put_pool_buf(struct spdk_io_channel *ch, void *buf);
+
 /**
  * \defgroup bdev_io_submit_functions bdev I/O Submit Functions
  *
@@ -1304,6 +1586,62 @@ int spdk_bdev_writev_blocks_ext(struct spdk_bdev_desc *desc, struct spdk_io_chan
 				uint64_t num_blocks, spdk_bdev_io_completion_cb cb, void *cb_arg,
 				struct spdk_bdev_ext_io_opts *opts);
 
+/**
+ * Description of one I/O of a batch submitted by spdk_bdev_submit_batch().
+ */
+struct spdk_bdev_batch_io {
+	/** SPDK_BDEV_IO_TYPE_READ or SPDK_BDEV_IO_TYPE_WRITE */
+	enum spdk_bdev_io_type type;
+
+	/** Number of elements in iovs */
+	int iovcnt;
+
+	/** Data buffers to read into or write from */
+	struct iovec *iovs;
+
+	/** Separate metadata buffer, optional */
+	void *md_buf;
+
+	/** The offset, in blocks, from the start of the block device */
+	uint64_t offset_blocks;
+
+	/** The number of blocks to read or write */
+	uint64_t num_blocks;
+
+	/** Called when the I/O is complete */
+	spdk_bdev_io_completion_cb cb;
+
+	/** Argument passed to cb */
+	void *cb_arg;
+};
+
+/**
+ * Submit a batch of read and write requests to the bdev on the given channel.
+ *
+ * Each I/O is processed like the one submitted by spdk_bdev_readv_blocks_with_md() or
+ * spdk_bdev_writev_blocks_with_md(), but the I/O that go straight to the bdev module are
+ * handed over to it together if it supports that, so that the device can be notified once
+ * for the whole batch.
+ *
+ * \ingroup bdev_io_submit_functions
+ *
+ * \param desc Block device descriptor.
+ * \param ch I/O channel. Obtained by calling spdk_bdev_get_io_channel().
+ * \param ios Array of I/O to submit.
+ * \param num_ios Number of I/O in the array.
+ *
+ * \return number of I/O submitted, in the order of the array. If it's less than num_ios,
+ * the remaining I/O weren't submitted, submitting them again reports the reason.
+ * \return negative errno if not even the first I/O could be submitted:
+ *   * -EINVAL - an I/O type other than read or write, or offset_blocks and/or
+ *   num_blocks are out of range, or md_buf is set and the bdev doesn't support
+ *   separate metadata
+ *   * -ENOMEM - spdk_bdev_io buffer cannot be allocated
+ *   * -EBADF - desc not open for writing and the I/O is a write
+ */
+int spdk_bdev_submit_batch(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+			   struct spdk_bdev_batch_io *ios, uint32_t num_ios);
+
 /**
  * Submit a compare request to the bdev on the given channel.
  *
@@ -2029,6 +2367,101 @@ uint64_t spdk_bdev_io_get_seek_offset(const struct spdk_bdev_io *bdev_io);
 void spdk_bdev_histogram_enable(struct spdk_bdev *bdev, spdk_bdev_histogram_status_cb cb_fn,
 				void *cb_arg, bool enable);
 
+/** Maximum number of size classes of a histogram breakdown */
+#define SPDK_BDEV_HISTOGRAM_MAX_SIZE_CLASSES	8
+
+struct spdk_bdev_enable_histogram_opts {
+	/**
+	 * The size of spdk_bdev_enable_histogram_opts according to the caller of this library is
+	 * used for ABI compatibility. The library uses this field to know how many fields in this
+	 * structure are valid. And the library will populate any remaining fields with default
+	 * values.
+	 */
+	size_t size;
+
+	/**
+	 * Besides the histogram of all I/O, collect separate histograms for each I/O type and
+	 * size class. Default: false.
+	 */
+	bool breakdown;
+
+	uint8_t reserved[3];
+
+	/** Number of valid entries in size_class_bounds. Default: 0, i.e. a single size class. */
+	uint32_t num_size_class_bounds;
+
+	/**
+	 * Upper bounds of the size classes in bytes, inclusive and in ascending order. I/O larger
+	 * than the last bound falls into an extra size class.
+	 */
+	uint64_t size_class_bounds[SPDK_BDEV_HISTOGRAM_MAX_SIZE_CLASSES - 1];
+};
+SPDK_STATIC_ASSERT(sizeof(struct spdk_bdev_enable_histogram_opts) == 72, "Incorrect size");
+
+/**
+ * Initialize spdk_bdev_enable_histogram_opts with default values.
+ *
+ * \param opts Options to initialize.
+ * \param size Size of opts, sizeof(struct spdk_bdev_enable_histogram_opts).
+ */
+void spdk_bdev_enable_histogram_opts_init(struct spdk_bdev_enable_histogram_opts *opts,
+		size_t size);
+
+/**
+ * Enable or disable collecting histogram data on a bdev, with options.
+ *
+ * Enabling histograms on a bdev that already collects them resets the breakdown histograms
+ * if the options change.
+ *
+ * \param bdev Block device.
+ * \param cb_fn Callback function to be called when histograms are enabled.
+ * \param cb_arg Argument to pass to cb_fn.
+ * \param enable Enable/disable flag
+ * \param opts Options of the histograms, NULL for the defaults. Ignored when disabling.
+ */
+void spdk_bdev_histogram_enable_ext(struct spdk_bdev *bdev, spdk_bdev_histogram_status_cb cb_fn,
+				    void *cb_arg, bool enable,
+				    struct spdk_bdev_enable_histogram_opts *opts);
+
+/**
+ * Latency histograms of a bdev broken down by I/O type and size class.
+ */
+struct spdk_bdev_histogram_breakdown {
+	/** Number of size classes the I/O of each type is split into */
+	uint32_t num_size_classes;
+
+	/** Upper bounds of the size classes in bytes, the last size class is unbounded */
+	uint64_t size_class_bounds[SPDK_BDEV_HISTOGRAM_MAX_SIZE_CLASSES - 1];
+
+	/** Histograms indexed by I/O type and size class, NULL if no such I/O completed */
+	struct spdk_histogram_data
+		*histogram[SPDK_BDEV_NUM_IO_TYPES][SPDK_BDEV_HISTOGRAM_MAX_SIZE_CLASSES];
+};
+
+typedef void (*spdk_bdev_histogram_breakdown_cb)(void *cb_arg, int status,
+		struct spdk_bdev_histogram_breakdown *breakdown);
+
+/**
+ * Get the histograms of a bdev broken down by I/O type and size class, merged from all of
+ * its channels. The breakdown passed to cb_fn is only valid during the execution of cb_fn.
+ *
+ * The status passed to cb_fn is -EFAULT if histograms are not enabled with breakdown.
+ *
+ * \param bdev Block device.
+ * \param cb_fn Callback function to be called with data collected on bdev.
+ * \param cb_arg Argument to pass to cb_fn.
+ */
+void spdk_bdev_histogram_get_breakdown(struct spdk_bdev *bdev,
+				       spdk_bdev_histogram_breakdown_cb cb_fn, void *cb_arg);
+
+/**
+ * Get the name of an I/O type.
+ *
+ * \param io_type I/O type.
+ * \return Name of the I/O type, NULL if it's not valid.
+ */
+const char *spdk_bdev_get_io_type_name(enum spdk_bdev_io_type io_type);
+
 /**
  * Get aggregated histogram data from a bdev. Callback provides merged histogram
  * for specified bdev.
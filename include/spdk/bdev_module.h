@@ -367,6 +367,16 @@ struct spdk_bdev_fn_table {
 
 	/** Check if bdev can handle spdk_accel_sequence to handle I/O of specific type. */
 	bool (*accel_sequence_supported)(void *ctx, enum spdk_bdev_io_type type);
+
+	/**
+	 * Process a batch of I/O requests at once. Optional - may be NULL.
+	 *
+	 * I/O submitted through spdk_bdev_submit_batch() that reach the module together are
+	 * passed here instead of submit_request, so that the module can notify the device once
+	 * per batch. Each I/O has to be handled as if it was passed to submit_request.
+	 */
+	void (*submit_request_batch)(struct spdk_io_channel *ch, struct spdk_bdev_io **bdev_ios,
+				     uint32_t num_ios);
 };
 
 /** bdev I/O completion status */
@@ -518,6 +528,17 @@ struct spdk_bdev {
 	 */
 	uint32_t max_rw_size;
 
+	/**
+	 * NUMA node of the device backing this bdev, if any.
+	 */
+	struct {
+		/** Set to true if \ref id holds the NUMA node ID of the bdev */
+		bool id_valid;
+
+		/** NUMA node ID, valid only if \ref id_valid is true */
+		int32_t id;
+	} numa;
+
 	/**
 	 * UUID for this bdev.
 	 *
@@ -728,6 +749,12 @@ struct spdk_bdev {
 		bool	histogram_enabled;
 		bool	histogram_in_progress;
 
+		/** options the histograms were enabled with */
+		struct spdk_bdev_enable_histogram_opts histogram_opts;
+
+		/** options for merging contiguous reads and writes */
+		struct spdk_bdev_merge_opts merge_opts;
+
 		/** Currently locked ranges for this bdev.  Used to populate new channels. */
 		lba_range_tailq_t locked_ranges;
 
@@ -815,6 +842,9 @@ struct spdk_bdev_io {
 			/* Sequence of accel operations */
 			struct spdk_accel_sequence *accel_sequence;
 
+			/** Placement hint of a write, see \ref spdk_bdev_ext_io_opts */
+			uint16_t placement_hint;
+
 			/** stored user callback in case we split the I/O and use a temporary callback */
 			spdk_bdev_io_completion_cb stored_user_cb;
 
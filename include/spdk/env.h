@@ -857,6 +857,41 @@ int spdk_pci_device_disable_interrupt(struct spdk_pci_device *dev);
  */
 int spdk_pci_device_get_interrupt_efd(struct spdk_pci_device *dev);
 
+/**
+ * Enable PCI device interrupts with a separate event file descriptor for each vector.
+ * (Experimental)
+ *
+ * Vector 0 is tied to the event file descriptor returned by
+ * spdk_pci_device_get_interrupt_efd(), vectors 1 to efd_count get their own.
+ *
+ * \param dev PCI device.
+ * \param efd_count Number of vectors, besides vector 0, to create event file descriptors for.
+ *
+ * \return 0 on success, negative value on error.
+ */
+int spdk_pci_device_enable_interrupts(struct spdk_pci_device *dev, uint32_t efd_count);
+
+/**
+ * Disable the PCI device interrupts enabled by spdk_pci_device_enable_interrupts()
+ * and release their event file descriptors. (Experimental)
+ *
+ * \param dev PCI device.
+ *
+ * \return 0 on success, negative value on error.
+ */
+int spdk_pci_device_disable_interrupts(struct spdk_pci_device *dev);
+
+/**
+ * Get the event file descriptor associated with a given PCI device interrupt vector.
+ * (Experimental)
+ *
+ * \param dev PCI device.
+ * \param index Interrupt vector.
+ *
+ * \return Event file descriptor on success, negative value on error.
+ */
+int spdk_pci_device_get_interrupt_efd_by_index(struct spdk_pci_device *dev, uint32_t index);
+
 /**
  * Get the domain of a PCI device.
  *
@@ -284,6 +284,18 @@ struct spdk_nvme_ctrlr_opts {
 	 * Set the IP protocol type of service value for RDMA transport. Default is 0, which means that the TOS will not be set.
 	 */
 	uint8_t transport_tos;
+
+	/**
+	 * Enable interrupt-driven completions on the I/O qpairs of this controller, once they're
+	 * added to a poll group running in interrupt mode, see spdk_nvme_poll_group_get_fd().
+	 * Supported by the PCIe (MSI-X), vfio-user and TCP transports.
+	 *
+	 * Cleared when the controller is attached if its transport or device can't provide
+	 * interrupts. Qpairs without interrupts are polled by the poll group instead.
+	 *
+	 * Default is `false`.
+	 */
+	bool enable_interrupts;
 };
 SPDK_STATIC_ASSERT(sizeof(struct spdk_nvme_ctrlr_opts) == 824, "Incorrect size");
 
@@ -621,7 +633,8 @@ struct spdk_nvme_ns_cmd_ext_io_opts {
 	uint16_t apptag_mask;
 	/** Application tag to use end-to-end protection information. */
 	uint16_t apptag;
-	/** Command dword 13 specific field. */
+	/** Command dword 13 specific field. For writes using a directive, the directive specific
+	 *  value (e.g. the FDP placement identifier) goes in its upper 16 bits. */
 	uint32_t cdw13;
 	/** Accel sequence (only valid if SPDK_NVME_CTRLR_ACCEL_SEQUENCE_SUPPORTED is set and the
 	 *  qpair is part of a poll group).
@@ -1320,6 +1333,19 @@ uint32_t spdk_nvme_ctrlr_get_num_ns(struct spdk_nvme_ctrlr *ctrlr);
  */
 struct spdk_pci_device *spdk_nvme_ctrlr_get_pci_device(struct spdk_nvme_ctrlr *ctrlr);
 
+/**
+ * Get the NUMA node the given NVMe controller is attached to.
+ *
+ * The queues and requests of the qpairs of the controller are allocated from that node
+ * when possible.
+ *
+ * \param ctrlr Opaque handle to NVMe controller.
+ *
+ * \return NUMA node ID of the controller, or SPDK_ENV_SOCKET_ID_ANY if not known, e.g. for
+ * controllers attached over a fabric.
+ */
+int32_t spdk_nvme_ctrlr_get_numa_id(const struct spdk_nvme_ctrlr *ctrlr);
+
 /**
  * Get the maximum data transfer size of a given NVMe controller.
  *
@@ -2728,6 +2754,25 @@ struct spdk_nvme_poll_group *spdk_nvme_poll_group_create(void *ctx,
  */
 struct spdk_nvme_poll_group *spdk_nvme_qpair_get_optimal_poll_group(struct spdk_nvme_qpair *qpair);
 
+/**
+ * Create a pool of requests shared by all qpairs in a poll group.
+ *
+ * Each qpair first uses the io_queue_requests requests it preallocated. When
+ * those run out, it borrows requests from the shared pool, and returns them on
+ * completion. Pair this with a small spdk_nvme_io_qpair_opts::io_queue_requests
+ * so that memory scales with in-flight I/O instead of with the number of qpairs.
+ *
+ * This must be called before any qpair is added to the poll group.
+ *
+ * \param group The poll group.
+ * \param num_requests Number of requests in the shared pool.
+ *
+ * \return 0 on success, -EINVAL if num_requests is 0, -EBUSY if the poll group
+ * already has a pool or contains qpairs, or -ENOMEM on memory allocation failure.
+ */
+int spdk_nvme_poll_group_set_shared_requests(struct spdk_nvme_poll_group *group,
+		uint32_t num_requests);
+
 /**
  * Add an spdk_nvme_qpair to a poll group. qpairs may only be added to
  * a poll group if they are in the disconnected state; i.e. either they were
@@ -2758,7 +2803,8 @@ int spdk_nvme_poll_group_remove(struct spdk_nvme_poll_group *group, struct spdk_
  *
  * \param group The group to destroy.
  *
- * return 0 on success, -EBUSY if the poll group is not empty.
+ * return 0 on success, -EBUSY if the poll group is not empty or requests of its shared pool
+ * are still outstanding.
  */
 int spdk_nvme_poll_group_destroy(struct spdk_nvme_poll_group *group);
 
@@ -2779,6 +2825,60 @@ int spdk_nvme_poll_group_destroy(struct spdk_nvme_poll_group *group);
 int64_t spdk_nvme_poll_group_process_completions(struct spdk_nvme_poll_group *group,
 		uint32_t completions_per_qpair, spdk_nvme_disconnected_qpair_cb disconnected_qpair_cb);
 
+/**
+ * Start a submission batch on a poll group.
+ *
+ * Until spdk_nvme_poll_group_submit_batch_end() is called, the I/O submitted to the qpairs
+ * of this group is queued without notifying the controllers. This only affects the PCIe
+ * and vfio-user transports, the other transports submit as usual.
+ *
+ * \param group The poll group.
+ */
+void spdk_nvme_poll_group_submit_batch_begin(struct spdk_nvme_poll_group *group);
+
+/**
+ * End the submission batch of a poll group.
+ *
+ * The submission queue doorbell of each qpair of the group with new commands queued is rung
+ * once, for all the commands submitted since spdk_nvme_poll_group_submit_batch_begin().
+ *
+ * \param group The poll group.
+ */
+void spdk_nvme_poll_group_submit_batch_end(struct spdk_nvme_poll_group *group);
+
+/**
+ * Switch the poll group to interrupt mode and return its file descriptor.
+ *
+ * The returned fd becomes readable whenever any qpair of the group has completions to
+ * process, or a qpair got disconnected. Qpairs of controllers created with
+ * spdk_nvme_ctrlr_opts.enable_interrupts set are waited on through their own fd. The
+ * others, and those whose transport has no fd for them, keep the fd readable for as long
+ * as they're connected, so that they're polled.
+ *
+ * \param group The poll group.
+ *
+ * \return the file descriptor on success, -EINVAL if qpairs were already added to the group,
+ * or another negative errno if the fd group cannot be created.
+ */
+int spdk_nvme_poll_group_get_fd(struct spdk_nvme_poll_group *group);
+
+/**
+ * Process the events of a poll group in interrupt mode.
+ *
+ * This is meant to be called once the fd returned by spdk_nvme_poll_group_get_fd() is
+ * readable. It doesn't block: the pending events are cleared and the completions are
+ * processed the same way as spdk_nvme_poll_group_process_completions() would.
+ *
+ * \param group The poll group.
+ * \param disconnected_qpair_cb A callback function of type spdk_nvme_disconnected_qpair_cb.
+ * Must be non-NULL.
+ *
+ * \return The number of completions across all qpairs, -EINVAL if the group isn't in interrupt
+ * mode, or another negative errno on failure.
+ */
+int64_t spdk_nvme_poll_group_wait(struct spdk_nvme_poll_group *group,
+				  spdk_nvme_disconnected_qpair_cb disconnected_qpair_cb);
+
 /**
  * Check if all qpairs in the poll group are connected.
  *
@@ -3115,6 +3215,61 @@ uint32_t spdk_nvme_ns_get_ana_group_id(const struct spdk_nvme_ns *ns);
  */
 enum spdk_nvme_ana_state spdk_nvme_ns_get_ana_state(const struct spdk_nvme_ns *ns);
 
+/**
+ * Signature for the callback of spdk_nvme_ns_update_placement_ids().
+ *
+ * \param cb_arg Argument passed to spdk_nvme_ns_update_placement_ids().
+ * \param rc 0 on success, negated errno otherwise, including when FDP is disabled for the
+ * endurance group of the namespace. The previous placement identifiers are kept on failure.
+ */
+typedef void (*spdk_nvme_ns_placement_ids_cb)(void *cb_arg, int rc);
+
+/**
+ * Retrieve the Flexible Data Placement (FDP) placement identifiers of the given namespace.
+ *
+ * The reclaim unit handle status of the namespace is read with I/O Management Receive
+ * commands submitted on the given I/O qpair. The user must poll the qpair, or its poll group,
+ * until cb_fn is called. The placement identifiers are then available through
+ * spdk_nvme_ns_get_placement_id().
+ *
+ * The placement identifiers must not be updated while I/O using them are being submitted.
+ *
+ * \param ns Namespace to update.
+ * \param qpair I/O qpair to submit the commands on.
+ * \param cb_fn Callback function to invoke once the placement identifiers are updated.
+ * \param cb_arg Argument to pass to the callback function.
+ *
+ * \return 0 if the first command was submitted, -ENOTSUP if the controller doesn't support
+ * FDP, negated errno otherwise. cb_fn is only called when 0 is returned.
+ */
+int spdk_nvme_ns_update_placement_ids(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
+				      spdk_nvme_ns_placement_ids_cb cb_fn, void *cb_arg);
+
+/**
+ * Get the number of FDP placement identifiers of the given namespace.
+ *
+ * \param ns Namespace to query.
+ *
+ * \return the number of placement identifiers retrieved by the last call to
+ * spdk_nvme_ns_update_placement_ids(), 0 if FDP can't be used for the namespace.
+ */
+uint16_t spdk_nvme_ns_get_num_placement_ids(const struct spdk_nvme_ns *ns);
+
+/**
+ * Get an FDP placement identifier of the given namespace.
+ *
+ * A write placed with it is submitted with SPDK_NVME_IO_FLAGS_DATA_PLACEMENT_DIRECTIVE set
+ * in its I/O flags and the placement identifier in the upper 16 bits of its command dword 13,
+ * see \ref spdk_nvme_ns_cmd_ext_io_opts.
+ *
+ * \param ns Namespace to query.
+ * \param index Index of the placement identifier, lower than
+ * spdk_nvme_ns_get_num_placement_ids().
+ *
+ * \return the placement identifier.
+ */
+uint16_t spdk_nvme_ns_get_placement_id(const struct spdk_nvme_ns *ns, uint16_t index);
+
 /**
  * Submit a write I/O to the specified NVMe namespace.
  *
@@ -4246,6 +4401,10 @@ struct spdk_nvme_transport_ops {
 	int (*ctrlr_ready)(struct spdk_nvme_ctrlr *ctrlr);
 
 	volatile struct spdk_nvme_registers *(*ctrlr_get_registers)(struct spdk_nvme_ctrlr *ctrlr);
+
+	int (*qpair_get_fd)(struct spdk_nvme_qpair *qpair);
+
+	void (*poll_group_submit_batch_end)(struct spdk_nvme_transport_poll_group *tgroup);
 };
 
 /**
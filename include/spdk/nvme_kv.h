@@ -0,0 +1,175 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 the SPDK authors.
+ */
+
+/**
+ * \file
+ * NVMe driver public API extension for Key Value Command Set
+ */
+
+#ifndef SPDK_NVME_KV_H
+#define SPDK_NVME_KV_H
+
+#include "spdk/stdinc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "spdk/nvme.h"
+
+/**
+ * Get the Key Value Command Set Specific Identify Namespace data
+ * as defined by the NVMe Key Value Command Set Specification.
+ *
+ * This function is thread safe and can be called at any point while the controller
+ * is attached to the SPDK NVMe driver.
+ *
+ * \param ns Namespace.
+ *
+ * \return a pointer to the namespace data, or NULL if the namespace is not
+ * a Key Value namespace.
+ */
+const struct spdk_nvme_kv_ns_data *spdk_nvme_kv_ns_get_data(struct spdk_nvme_ns *ns);
+
+/**
+ * Get the maximum key length, in bytes, of the given namespace.
+ *
+ * The value is taken from the first KV format descriptor of the namespace.
+ *
+ * This function is thread safe and can be called at any point while the controller
+ * is attached to the SPDK NVMe driver.
+ *
+ * \param ns Namespace to query.
+ *
+ * \return the maximum key length of the given namespace in bytes.
+ */
+uint32_t spdk_nvme_kv_ns_get_max_key_len(struct spdk_nvme_ns *ns);
+
+/**
+ * Get the maximum value length, in bytes, of the given namespace.
+ *
+ * The value is taken from the first KV format descriptor of the namespace.
+ *
+ * This function is thread safe and can be called at any point while the controller
+ * is attached to the SPDK NVMe driver.
+ *
+ * \param ns Namespace to query.
+ *
+ * \return the maximum value length of the given namespace in bytes.
+ */
+uint32_t spdk_nvme_kv_ns_get_max_value_len(struct spdk_nvme_ns *ns);
+
+/**
+ * Submit a Store command to the specified NVMe Key Value namespace.
+ *
+ * The command is submitted to a qpair allocated by spdk_nvme_ctrlr_alloc_io_qpair().
+ * The user must ensure that only one thread submits I/O on a given qpair at any
+ * given time.
+ *
+ * \param ns NVMe namespace to submit the Store command.
+ * \param qpair I/O queue pair to submit the request.
+ * \param key Key to store the value under.
+ * \param key_len Length of the key in bytes, from 1 to SPDK_NVME_KV_KEY_MAX_LEN.
+ * \param buffer Virtual address pointer to the value. It must be allocated by
+ * spdk_dma_malloc() or spdk_dma_zmalloc().
+ * \param buffer_size Size of the value in bytes.
+ * \param store_opts Bitwise OR of enum spdk_nvme_kv_store_opts values, or 0.
+ * \param cb_fn Callback function to invoke when the I/O is completed.
+ * \param cb_arg Argument to pass to the callback function.
+ *
+ * \return 0 if successfully submitted, negated errno if the key length or the store
+ * options are invalid (-EINVAL) or an nvme_request structure cannot be allocated (-ENOMEM).
+ */
+int spdk_nvme_kv_store(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
+		       const void *key, uint32_t key_len, void *buffer, uint32_t buffer_size,
+		       uint32_t store_opts, spdk_nvme_cmd_cb cb_fn, void *cb_arg);
+
+/**
+ * Submit a Retrieve command to the specified NVMe Key Value namespace.
+ *
+ * On success, dword 0 of the completion holds the size of the value stored
+ * under the key, which may be larger than buffer_size.
+ *
+ * \param ns NVMe namespace to submit the Retrieve command.
+ * \param qpair I/O queue pair to submit the request.
+ * \param key Key of the value to retrieve.
+ * \param key_len Length of the key in bytes, from 1 to SPDK_NVME_KV_KEY_MAX_LEN.
+ * \param buffer Virtual address pointer to the buffer the value is read into.
+ * It must be allocated by spdk_dma_malloc() or spdk_dma_zmalloc().
+ * \param buffer_size Size of the buffer in bytes.
+ * \param cb_fn Callback function to invoke when the I/O is completed.
+ * \param cb_arg Argument to pass to the callback function.
+ *
+ * \return 0 if successfully submitted, negated errno if the key length is invalid
+ * (-EINVAL) or an nvme_request structure cannot be allocated (-ENOMEM).
+ */
+int spdk_nvme_kv_retrieve(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
+			  const void *key, uint32_t key_len, void *buffer, uint32_t buffer_size,
+			  spdk_nvme_cmd_cb cb_fn, void *cb_arg);
+
+/**
+ * Submit a Delete command to the specified NVMe Key Value namespace.
+ *
+ * \param ns NVMe namespace to submit the Delete command.
+ * \param qpair I/O queue pair to submit the request.
+ * \param key Key to delete.
+ * \param key_len Length of the key in bytes, from 1 to SPDK_NVME_KV_KEY_MAX_LEN.
+ * \param cb_fn Callback function to invoke when the I/O is completed.
+ * \param cb_arg Argument to pass to the callback function.
+ *
+ * \return 0 if successfully submitted, negated errno if the key length is invalid
+ * (-EINVAL) or an nvme_request structure cannot be allocated (-ENOMEM).
+ */
+int spdk_nvme_kv_delete(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
+			const void *key, uint32_t key_len,
+			spdk_nvme_cmd_cb cb_fn, void *cb_arg);
+
+/**
+ * Submit an Exist command to the specified NVMe Key Value namespace.
+ *
+ * The command completes successfully if the key exists, and with the
+ * SPDK_NVME_SC_KV_KEY_DOES_NOT_EXIST status otherwise.
+ *
+ * \param ns NVMe namespace to submit the Exist command.
+ * \param qpair I/O queue pair to submit the request.
+ * \param key Key to look up.
+ * \param key_len Length of the key in bytes, from 1 to SPDK_NVME_KV_KEY_MAX_LEN.
+ * \param cb_fn Callback function to invoke when the I/O is completed.
+ * \param cb_arg Argument to pass to the callback function.
+ *
+ * \return 0 if successfully submitted, negated errno if the key length is invalid
+ * (-EINVAL) or an nvme_request structure cannot be allocated (-ENOMEM).
+ */
+int spdk_nvme_kv_exist(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
+		       const void *key, uint32_t key_len,
+		       spdk_nvme_cmd_cb cb_fn, void *cb_arg);
+
+/**
+ * Submit a List command to the specified NVMe Key Value namespace.
+ *
+ * The controller returns the keys of the namespace, starting at the given key,
+ * in the format defined by the NVMe Key Value Command Set Specification.
+ *
+ * \param ns NVMe namespace to submit the List command.
+ * \param qpair I/O queue pair to submit the request.
+ * \param key Key to start listing from.
+ * \param key_len Length of the key in bytes, from 1 to SPDK_NVME_KV_KEY_MAX_LEN.
+ * \param buffer Virtual address pointer to the buffer the key list is read into.
+ * It must be allocated by spdk_dma_malloc() or spdk_dma_zmalloc().
+ * \param buffer_size Size of the buffer in bytes.
+ * \param cb_fn Callback function to invoke when the I/O is completed.
+ * \param cb_arg Argument to pass to the callback function.
+ *
+ * \return 0 if successfully submitted, negated errno if the key length is invalid
+ * (-EINVAL) or an nvme_request structure cannot be allocated (-ENOMEM).
+ */
+int spdk_nvme_kv_list(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
+		      const void *key, uint32_t key_len, void *buffer, uint32_t buffer_size,
+		      spdk_nvme_cmd_cb cb_fn, void *cb_arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
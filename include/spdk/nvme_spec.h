@@ -1701,6 +1701,33 @@ enum spdk_nvme_zns_opcode {
 	SPDK_NVME_OPC_ZONE_APPEND			= 0x7d,
 };
 
+/**
+ * Key Value command set opcodes
+ *
+ * The Key Value command set replaces the NVM command set, and some of its
+ * opcodes are reused with a different meaning.
+ */
+enum spdk_nvme_kv_opcode {
+	SPDK_NVME_OPC_KV_STORE				= 0x01,
+	SPDK_NVME_OPC_KV_RETRIEVE			= 0x02,
+	SPDK_NVME_OPC_KV_LIST				= 0x06,
+	SPDK_NVME_OPC_KV_DELETE				= 0x10,
+	SPDK_NVME_OPC_KV_EXIST				= 0x14,
+};
+
+/** Maximum length of a key of the Key Value command set, in bytes */
+#define SPDK_NVME_KV_KEY_MAX_LEN	16
+
+/**
+ * Store options of the Key Value Store command
+ */
+enum spdk_nvme_kv_store_opts {
+	/** Store the value only if the key already exists */
+	SPDK_NVME_KV_STORE_MUST_EXIST			= 0x1,
+	/** Store the value only if the key does not exist yet */
+	SPDK_NVME_KV_STORE_MUST_NOT_EXIST		= 0x2,
+};
+
 /**
  * Data transfer (bits 1:0) of an NVMe opcode.
  *
@@ -3044,6 +3071,83 @@ struct spdk_nvme_zns_ns_data {
 };
 SPDK_STATIC_ASSERT(sizeof(struct spdk_nvme_zns_ns_data) == 4096, "Incorrect size");
 
+/**
+ * Key Value format descriptor
+ */
+struct spdk_nvme_kv_format {
+	/** key max length, in bytes */
+	uint16_t		kvkml;
+
+	uint8_t			reserved2[2];
+
+	/** value max length, in bytes */
+	uint32_t		kvvml;
+
+	/** max number of keys, 0 if not reported */
+	uint32_t		kvmnk;
+
+	uint8_t			reserved12[4];
+};
+SPDK_STATIC_ASSERT(sizeof(struct spdk_nvme_kv_format) == 16, "Incorrect size");
+
+/**
+ * Key Value Command Set Specific Identify Namespace data structure
+ */
+struct spdk_nvme_kv_ns_data {
+	/** namespace size, in bytes */
+	uint64_t		nsze;
+
+	uint8_t			reserved8[8];
+
+	/** namespace utilization, in bytes */
+	uint64_t		nuse;
+
+	/** namespace features */
+	uint8_t			nsfeat;
+
+	/** number of KV formats */
+	uint8_t			nkvf;
+
+	/** namespace multi-path I/O and namespace sharing capabilities */
+	uint8_t			nmic;
+
+	/** reservation capabilities */
+	uint8_t			rescap;
+
+	/** format progress indicator */
+	uint8_t			fpi;
+
+	uint8_t			reserved29[3];
+
+	/** namespace optimal value granularity, in bytes */
+	uint32_t		novg;
+
+	/** ANA group identifier */
+	uint32_t		anagrpid;
+
+	uint8_t			reserved40[3];
+
+	/** namespace attributes */
+	uint8_t			nsattr;
+
+	/** NVM set identifier */
+	uint16_t		nvmsetid;
+
+	/** endurance group identifier */
+	uint16_t		endgid;
+
+	uint8_t			reserved48[24];
+
+	/** KV format support */
+	struct spdk_nvme_kv_format	kvf[16];
+
+	uint8_t			reserved328[2744];
+
+	uint8_t			vendor_specific[1024];
+};
+SPDK_STATIC_ASSERT(sizeof(struct spdk_nvme_kv_ns_data) == 4096, "Incorrect size");
+SPDK_STATIC_ASSERT(offsetof(struct spdk_nvme_kv_ns_data, kvf) == 72, "Incorrect offset");
+
 /**
  * IO command set vector for IDENTIFY_IOCS
  */
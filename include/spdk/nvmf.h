@@ -353,6 +353,67 @@ typedef void (*nvmf_qpair_disconnect_cb)(void *ctx);
 int spdk_nvmf_qpair_disconnect(struct spdk_nvmf_qpair *qpair, nvmf_qpair_disconnect_cb cb_fn,
 			       void *ctx);
 
+/**
+ * Function to be called once spdk_nvmf_qpair_move() completes.
+ *
+ * \param cb_arg Argument passed to spdk_nvmf_qpair_move().
+ * \param status 0 if the qpair was moved, negative errno otherwise.
+ */
+typedef void (*spdk_nvmf_qpair_move_done_fn)(void *cb_arg, int status);
+
+/**
+ * Move an I/O qpair to another poll group without disconnecting the host.
+ *
+ * The qpair stops starting new commands and waits for the ones in flight to complete.
+ * Its transport state is then detached from its current poll group and attached to
+ * the destination poll group, where the qpair resumes processing commands. If the
+ * commands in flight don't complete within 10 seconds, the move is given up, the qpair
+ * resumes processing commands in its current poll group and cb_fn gets -ETIMEDOUT.
+ *
+ * This function must be called from the thread of the qpair's current poll group.
+ *
+ * \param qpair The I/O qpair to move.
+ * \param group The poll group to move the qpair to.
+ * \param cb_fn Function to call on the current thread once the move completes.
+ * \param cb_arg Argument passed to cb_fn.
+ *
+ * \return 0 if the move was started, in which case cb_fn will be called.
+ * \return -EINVAL if the qpair is not an active I/O qpair or is already in the poll group.
+ * \return -ENOTSUP if the transport does not support moving qpairs.
+ * \return -EBUSY if the qpair is already being moved.
+ * \return -ENOMEM if the move could not be started because of memory allocation failure.
+ */
+int spdk_nvmf_qpair_move(struct spdk_nvmf_qpair *qpair, struct spdk_nvmf_poll_group *group,
+			 spdk_nvmf_qpair_move_done_fn cb_fn, void *cb_arg);
+
+/**
+ * Function to be called once spdk_nvmf_tgt_rebalance_poll_groups() completes.
+ *
+ * \param cb_arg Argument passed to spdk_nvmf_tgt_rebalance_poll_groups().
+ * \param status 0 if a qpair was moved or if no qpair needed to be moved, negative
+ * errno otherwise.
+ */
+typedef void (*spdk_nvmf_tgt_rebalance_done_fn)(void *cb_arg, int status);
+
+/**
+ * Move an I/O qpair from the busiest to the idlest poll group of the target.
+ *
+ * The load of each poll group is the number of NVMe I/O commands completed by its qpairs
+ * since the previous call to this function. If the busiest poll group is significantly more
+ * loaded than the idlest one, the qpair whose load is the closest to half of the difference
+ * is moved with spdk_nvmf_qpair_move(). Calling this function periodically spreads the load
+ * of long-lived connections across the poll groups.
+ *
+ * \param tgt The target to rebalance.
+ * \param cb_fn Function to call on the current thread once the rebalancing pass completes.
+ * \param cb_arg Argument passed to cb_fn.
+ *
+ * \return 0 if the rebalancing pass was started, in which case cb_fn will be called.
+ * \return -ENOMEM if the pass could not be started because of memory allocation failure.
+ */
+int spdk_nvmf_tgt_rebalance_poll_groups(struct spdk_nvmf_tgt *tgt,
+					spdk_nvmf_tgt_rebalance_done_fn cb_fn, void *cb_arg);
+
 /**
  * Get the peer's transport ID for this queue pair.
  *
@@ -596,6 +657,55 @@ int spdk_nvmf_subsystem_disconnect_host(struct spdk_nvmf_subsystem *subsystem,
 					spdk_nvmf_tgt_subsystem_listen_done_fn cb_fn,
 					void *cb_arg);
 
+/** Maximum fair queuing weight of a host or a namespace */
+#define SPDK_NVMF_FQ_MAX_WEIGHT 1000
+
+/**
+ * Set the fair queuing weight of an allowed host.
+ *
+ * When fair queuing is enabled on the subsystem, READ and WRITE commands are
+ * dispatched in proportion to the product of the weight of the host that sent
+ * them and the weight of the namespace they target. The default weight of a host
+ * is 1. The new weight applies to commands queued after this call returns.
+ *
+ * \param subsystem Subsystem to modify.
+ * \param hostnqn The NQN of a host added with spdk_nvmf_subsystem_add_host().
+ * \param weight Weight of the host, from 1 to SPDK_NVMF_FQ_MAX_WEIGHT.
+ *
+ * \return 0 on success, -EINVAL if the weight is out of range, or -ENOENT if the
+ * host is not in the list of allowed hosts.
+ */
+int spdk_nvmf_subsystem_set_host_weight(struct spdk_nvmf_subsystem *subsystem,
+					const char *hostnqn, uint32_t weight);
+
+/**
+ * Enable or disable weighted fair queuing of I/O in a subsystem.
+ *
+ * Each poll group lets up to max_inflight READ and WRITE commands of the subsystem
+ * run at once. Further commands are queued per host and namespace, and dispatched
+ * as others complete in the order of their virtual finish time. The cost of a
+ * command is its transfer length plus a fixed per-command cost, divided by the
+ * product of its host and namespace weights.
+ *
+ * \param subsystem Subsystem to modify.
+ * \param max_inflight Number of commands each poll group runs at once before it
+ * starts queuing them, or 0 to disable fair queuing.
+ *
+ * \return 0 on success, or negated errno value on failure.
+ */
+int spdk_nvmf_subsystem_set_fair_queuing(struct spdk_nvmf_subsystem *subsystem,
+		uint32_t max_inflight);
+
+/**
+ * Get the fair queuing setting of a subsystem.
+ *
+ * \param subsystem Subsystem to query.
+ *
+ * \return the number of commands each poll group runs at once before it starts
+ * queuing them, or 0 if fair queuing is disabled.
+ */
+uint32_t spdk_nvmf_subsystem_get_fair_queuing(const struct spdk_nvmf_subsystem *subsystem);
+
 /**
  * Set whether a subsystem should allow any host or only hosts in the allowed list.
  *
@@ -913,8 +1023,18 @@ struct spdk_nvmf_ns_opts {
 	 */
 	uint32_t anagrpid;
 
-	/* Hole at bytes 60-63. */
-	uint8_t reserved60[4];
+	/**
+	 * Forward all the I/O commands, except the reservation ones, to the bdev unchanged as
+	 * NVMe passthrough commands, and return the status they complete with to the host.
+	 *
+	 * The bdev has to support SPDK_BDEV_IO_TYPE_NVME_IO and its blocks have to map directly
+	 * to the LBAs of an NVMe namespace, e.g. an NVMe bdev.  Zero-copy and DIF insert/strip
+	 * are not used for such a namespace.
+	 */
+	bool passthru_io;
+
+	/* Hole at bytes 61-63. */
+	uint8_t reserved61[3];
 } __attribute__((packed));
 SPDK_STATIC_ASSERT(sizeof(struct spdk_nvmf_ns_opts) == 64, "Incorrect size");
 
@@ -1045,6 +1165,27 @@ struct spdk_bdev *spdk_nvmf_ns_get_bdev(struct spdk_nvmf_ns *ns);
 void spdk_nvmf_ns_get_opts(const struct spdk_nvmf_ns *ns, struct spdk_nvmf_ns_opts *opts,
 			   size_t opts_size);
 
+/**
+ * Set the fair queuing weight of a namespace.
+ *
+ * The default weight of a namespace is 1. See spdk_nvmf_subsystem_set_fair_queuing().
+ *
+ * \param ns Namespace to modify.
+ * \param weight Weight of the namespace, from 1 to SPDK_NVMF_FQ_MAX_WEIGHT.
+ *
+ * \return 0 on success, or -EINVAL if the weight is out of range.
+ */
+int spdk_nvmf_ns_set_weight(struct spdk_nvmf_ns *ns, uint32_t weight);
+
+/**
+ * Get the fair queuing weight of a namespace.
+ *
+ * \param ns Namespace to query.
+ *
+ * \return weight of the namespace.
+ */
+uint32_t spdk_nvmf_ns_get_weight(const struct spdk_nvmf_ns *ns);
+
 /**
  * Get the serial number of the specified subsystem.
  *
@@ -114,8 +114,14 @@ struct spdk_nvmf_request {
 
 	/* Timeout tracked for connect and abort flows. */
 	uint64_t timeout_tsc;
+
+	/* Virtual finish time assigned by the fair queuing stage */
+	uint64_t			fq_finish_tag;
+	STAILQ_ENTRY(spdk_nvmf_request)	fq_link;
+	/* Counted as in flight by the fair queuing stage */
+	bool				fq_tracked;
 };
-SPDK_STATIC_ASSERT(sizeof(struct spdk_nvmf_request) == 776, "Incorrect size");
+SPDK_STATIC_ASSERT(sizeof(struct spdk_nvmf_request) == 800, "Incorrect size");
 
 enum spdk_nvmf_qpair_state {
 	SPDK_NVMF_QPAIR_UNINITIALIZED = 0,
@@ -150,6 +156,19 @@ struct spdk_nvmf_qpair {
 
 	bool					connect_received;
 	bool					disconnect_started;
+
+	/* Set while the qpair is being moved to another poll group */
+	struct spdk_nvmf_qpair_move_ctx		*move_ctx;
+
+	/* Number of NVMe I/O commands completed since the last poll group rebalancing
+	 * pass, and during the period that preceded it */
+	uint64_t				completed_nvme_io;
+	uint64_t				last_period_nvme_io;
+
+	/* Fair queuing weight of the host, valid as long as fq_weight_gen
+	 * matches the generation of the subsystem */
+	uint32_t				fq_host_weight;
+	uint32_t				fq_weight_gen;
 };
 
 struct spdk_nvmf_transport_poll_group {
@@ -359,6 +378,43 @@ struct spdk_nvmf_transport_ops {
 	int (*poll_group_remove)(struct spdk_nvmf_transport_poll_group *group,
 				 struct spdk_nvmf_qpair *qpair);
 
+	/**
+	 * Detach an active qpair from a poll group without disconnecting it, so that it can
+	 * be attached to another poll group. Called repeatedly on the thread of the poll group
+	 * until it returns something else than -EAGAIN. From the first call on, the transport
+	 * must not start new requests on the qpair, and return -EAGAIN until the requests in
+	 * flight have completed. Optional, qpairs cannot be moved if it is not provided.
+	 */
+	int (*poll_group_detach)(struct spdk_nvmf_transport_poll_group *group,
+				 struct spdk_nvmf_qpair *qpair);
+
+	/**
+	 * Attach a qpair detached by poll_group_detach to a poll group and resume it. The qpair
+	 * must be tracked by the poll group even if this fails, so that it can be disconnected.
+	 */
+	int (*poll_group_attach)(struct spdk_nvmf_transport_poll_group *group,
+				 struct spdk_nvmf_qpair *qpair);
+
+	/**
+	 * Give up on detaching a qpair for which poll_group_detach didn't return 0 yet and
+	 * resume processing its commands on its current poll group.
+	 */
+	void (*poll_group_cancel_detach)(struct spdk_nvmf_transport_poll_group *group,
+					 struct spdk_nvmf_qpair *qpair);
+
+	/**
+	 * Stop processing the poll group from anything else than its poller, e.g. interrupts.
+	 * Called on the thread of the poll group when the target pauses polling, before its
+	 * poller is unregistered. Optional.
+	 */
+	void (*poll_group_pause)(struct spdk_nvmf_transport_poll_group *group);
+
+	/**
+	 * Undo poll_group_pause. Called on the thread of the poll group when the target resumes
+	 * polling, after its poller was registered again. Optional.
+	 */
+	int (*poll_group_resume)(struct spdk_nvmf_transport_poll_group *group);
+
 	/**
 	 * Poll the group to process I/O
 	 */
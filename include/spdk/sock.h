@@ -495,6 +495,18 @@ bool spdk_sock_is_ipv4(struct spdk_sock *sock);
  */
 bool spdk_sock_is_connected(struct spdk_sock *sock);
 
+/**
+ * Get the file descriptor that becomes readable when data can be received from the socket.
+ *
+ * This allows waiting for a socket in interrupt mode. The fd must not be used for I/O.
+ *
+ * \param sock Socket to get the fd of.
+ *
+ * \return the file descriptor on success, -ENOTSUP if the socket implementation doesn't
+ * support it.
+ */
+int spdk_sock_get_interrupt_fd(struct spdk_sock *sock);
+
 /**
  * Callback function for spdk_sock_group_add_sock().
  *
@@ -585,6 +597,24 @@ int spdk_sock_group_poll_count(struct spdk_sock_group *group, int max_events);
  */
 int spdk_sock_group_close(struct spdk_sock_group **group);
 
+/**
+ * Get the file descriptor that becomes readable when the sock group has events to poll.
+ *
+ * This allows waiting for all the sockets of the group in interrupt mode. The events
+ * are still consumed by spdk_sock_group_poll() and the fd must not be used for I/O.
+ * The fd is valid until the group is closed.
+ *
+ * Events for data already buffered by the socket implementation are not signaled,
+ * so the group should be polled until spdk_sock_group_poll() reports no events
+ * before waiting on the fd.
+ *
+ * \param group Group to get the fd of.
+ *
+ * \return the file descriptor on success, -ENOTSUP if any of the socket implementations
+ * doesn't support it, or another negated errno on failure.
+ */
+int spdk_sock_group_get_interrupt_fd(struct spdk_sock_group *group);
+
 /**
  * Get the optimal sock group for this sock.
  *
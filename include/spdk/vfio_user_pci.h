@@ -25,6 +25,28 @@ struct vfio_device *spdk_vfio_user_setup(const char *path);
 
 void spdk_vfio_user_release(struct vfio_device *dev);
 
+/**
+ * Get the number of MSI-X vectors of the device.
+ *
+ * \param dev vfio-user device.
+ *
+ * \return the number of vectors on success, negative errno otherwise.
+ */
+int spdk_vfio_user_get_msix_count(struct vfio_device *dev);
+
+/**
+ * Have MSI-X vectors of the device signal event fds.
+ *
+ * \param dev vfio-user device.
+ * \param start First vector to set.
+ * \param efds Event fds to signal, one for each vector.
+ * \param count Number of vectors to set, 0 disables triggering all vectors from start on.
+ *
+ * \return 0 on success, negative errno otherwise.
+ */
+int spdk_vfio_user_set_msix_efds(struct vfio_device *dev, uint32_t start, int *efds,
+				 uint32_t count);
+
 /* For fuzzing only */
 int spdk_vfio_user_dev_send_request(struct vfio_device *dev, enum vfio_user_command command,
 				    void *arg, size_t arg_len, size_t buf_len, int *fds,
@@ -59,6 +59,7 @@ struct spdk_sock_group {
 	STAILQ_HEAD(, spdk_sock_group_impl)	group_impls;
 	STAILQ_HEAD(, spdk_sock_group_provided_buf) pool;
 	void					*ctx;
+	struct spdk_fd_group			*fgrp;
 };
 
 struct spdk_sock_group_impl {
@@ -99,6 +100,7 @@ struct spdk_net_impl {
 	bool (*is_ipv6)(struct spdk_sock *sock);
 	bool (*is_ipv4)(struct spdk_sock *sock);
 	bool (*is_connected)(struct spdk_sock *sock);
+	int (*get_interrupt_fd)(struct spdk_sock *sock);
 
 	struct spdk_sock_group_impl *(*group_impl_get_optimal)(struct spdk_sock *sock,
 			struct spdk_sock_group_impl *hint);
@@ -108,6 +110,7 @@ struct spdk_net_impl {
 	int (*group_impl_poll)(struct spdk_sock_group_impl *group, int max_events,
 			       struct spdk_sock **socks);
 	int (*group_impl_close)(struct spdk_sock_group_impl *group);
+	int (*group_impl_get_interrupt_fd)(struct spdk_sock_group_impl *group);
 
 	int (*get_opts)(struct spdk_sock_impl_opts *opts, size_t *len);
 	int (*set_opts)(const struct spdk_sock_impl_opts *opts, size_t len);
@@ -322,6 +325,31 @@ end:
 	return iovcnt;
 }
 
+/**
+ * Describe the part of an iovec array that follows its first offset bytes.
+ *
+ * \return the number of elements of diov that were filled.
+ */
+static inline int
+spdk_sock_iov_skip(struct iovec *iovs, int iovcnt, size_t offset, struct iovec *diov, int diovcnt)
+{
+	int i, j = 0;
+
+	for (i = 0; i < iovcnt && j < diovcnt; i++) {
+		if (offset >= iovs[i].iov_len) {
+			offset -= iovs[i].iov_len;
+			continue;
+		}
+
+		diov[j].iov_base = (uint8_t *)iovs[i].iov_base + offset;
+		diov[j].iov_len = iovs[i].iov_len - offset;
+		offset = 0;
+		j++;
+	}
+
+	return j;
+}
+
 static inline void
 spdk_sock_get_placement_id(int fd, enum spdk_placement_mode mode, int *placement_id)
 {
@@ -51,6 +51,8 @@ int __itt_init_ittlib(const char *, __itt_group_id);
 #define SPDK_BDEV_QOS_MIN_BYTES_PER_SEC		(1024 * 1024)
 #define SPDK_BDEV_QOS_MAX_MBYTES_PER_SEC	(UINT64_MAX / (1024 * 1024))
 #define SPDK_BDEV_QOS_LIMIT_NOT_DEFINED		UINT64_MAX
+#define SPDK_BDEV_QOS_LATENCY_WINDOW_IN_USEC	100000
+#define SPDK_BDEV_QOS_LATENCY_PERCENTILE	99
 #define SPDK_BDEV_IO_POLL_INTERVAL_IN_MSEC	1000
 
 /* The maximum number of children requests for a UNMAP or WRITE ZEROES command
@@ -109,6 +111,8 @@ struct spdk_bdev_mgr {
 
 	TAILQ_HEAD(, spdk_bdev_open_async_ctx) async_bdev_opens;
 
+	TAILQ_HEAD(, spdk_bdev_qos_group) qos_groups;
+
 #ifdef SPDK_CONFIG_VTUNE
 	__itt_domain	*domain;
 #endif
@@ -121,6 +125,7 @@ static struct spdk_bdev_mgr g_bdev_mgr = {
 	.init_complete = false,
 	.module_init_complete = false,
 	.async_bdev_opens = TAILQ_HEAD_INITIALIZER(g_bdev_mgr.async_bdev_opens),
+	.qos_groups = TAILQ_HEAD_INITIALIZER(g_bdev_mgr.qos_groups),
 };
 
 static void
@@ -207,6 +212,61 @@ struct spdk_bdev_qos {
 
 	/** Poller that processes queued I/O commands each time slice. */
 	struct spdk_poller *poller;
+
+	/** QoS group this bdev belongs to, or NULL. Only changed on the QoS thread. */
+	struct spdk_bdev_qos_group *group;
+
+	/** Target for the tail latency of the I/O to this bdev in microseconds, or 0
+	 *  if the bdev is best-effort. */
+	uint64_t latency_target_us;
+
+	/** Latency target in tsc ticks. */
+	uint64_t latency_target_ticks;
+
+	/** Timestamp of start of the current latency measurement window. */
+	uint64_t latency_window_start;
+
+	/** Whether the latency samples are being collected from the channels. */
+	bool latency_collect_in_progress;
+};
+
+struct spdk_bdev_qos_group {
+	/** Name of the group. */
+	char *name;
+
+	/** Rate limits shared by all bdevs in the group. */
+	struct spdk_bdev_qos_limit rate_limits[SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES];
+
+	/** The thread on which the poller is running. */
+	struct spdk_thread *thread;
+
+	/** Size of a timeslice in tsc ticks. */
+	uint64_t timeslice_size;
+
+	/** Timestamp of start of last timeslice. */
+	uint64_t last_timeslice;
+
+	/** Poller that replenishes the group quota each time slice. */
+	struct spdk_poller *poller;
+
+	/** Number of bdevs referencing this group. Protected by g_bdev_mgr.spinlock. */
+	uint32_t num_bdevs;
+
+	/** Adaptive limits applied to the members without a latency target. They are
+	 *  tightened whenever a member with a latency target misses it. */
+	struct spdk_bdev_qos_limit be_limits[SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES];
+
+	/** I/O and bytes submitted by best-effort members in the current window. */
+	uint64_t be_ios;
+	uint64_t be_bytes;
+
+	/** Set when a member missed its latency target in the current window. */
+	bool latency_missed;
+
+	/** Timestamp of start of the current latency window. */
+	uint64_t latency_window_start;
+
+	TAILQ_ENTRY(spdk_bdev_qos_group) link;
 };
 
 struct spdk_bdev_mgmt_channel {
@@ -224,7 +284,7 @@ struct spdk_bdev_mgmt_channel {
 	struct spdk_iobuf_channel iobuf;
 
 	TAILQ_HEAD(, spdk_bdev_shared_resource)	shared_resources;
-	TAILQ_HEAD(, spdk_bdev_io_wait_entry)	io_wait_queue;
+	TAILQ_HEAD(bdev_io_wait_queue, spdk_bdev_io_wait_entry)	io_wait_queue;
 };
 
 /*
@@ -267,6 +327,50 @@ struct spdk_bdev_shared_resource {
 #define BDEV_CH_RESET_IN_PROGRESS	(1 << 0)
 #define BDEV_CH_QOS_ENABLED		(1 << 1)
 
+/* Maximum number of I/O handed over to a module's submit_request_batch at once */
+#define BDEV_CH_BATCH_MAX_IOS		32
+
+/* Default and maximum number of I/O merged into one, each of them needs at least one iovec */
+#define BDEV_CH_MERGE_MAX_IOS		SPDK_BDEV_IO_NUM_CHILD_IOV
+
+/*
+ * Reads and writes held back by a channel to be merged into a single I/O.
+ */
+struct bdev_channel_merge {
+	uint32_t		max_ios;
+	uint64_t		max_blocks;
+
+	/* Submits the held back I/O once per merge window */
+	struct spdk_poller	*poller;
+
+	/* Held back I/O, all of the same type and LBA-contiguous */
+	bdev_io_tailq_t		ios;
+	uint32_t		num_ios;
+	int			iovcnt;
+	uint8_t			type;
+	uint64_t		offset_blocks;
+	uint64_t		num_blocks;
+};
+
+/*
+ * spdk_bdev_io structures and data buffers registered by the user of a channel.
+ */
+struct bdev_channel_io_pool {
+	/* Reserved spdk_bdev_io structures */
+	void			*ios;
+	size_t			io_size;
+	uint32_t		num_ios;
+	uint32_t		num_free_ios;
+	STAILQ_HEAD(, spdk_bdev_io) free_ios;
+
+	/* Caller owned buffers, the free ones are linked through their first bytes */
+	void			*bufs;
+	uint32_t		buf_size;
+	uint32_t		num_bufs;
+	uint32_t		num_free_bufs;
+	void			*free_bufs;
+};
+
 struct spdk_bdev_channel {
 	struct spdk_bdev	*bdev;
 
@@ -308,6 +412,25 @@ struct spdk_bdev_channel {
 
 	struct spdk_histogram_data *histogram;
 
+	/* Histograms per I/O type and size class, allocated on first use */
+	struct spdk_bdev_histogram_breakdown *histogram_breakdown;
+
+	/* I/O pool registered by the user of the channel, if any */
+	struct bdev_channel_io_pool *io_pool;
+
+	/* Data buffers submitted on this channel are trusted to be aligned */
+	bool			bufs_aligned;
+
+	/*
+	 * I/O collected for the module's submit_request_batch while spdk_bdev_submit_batch()
+	 * is in progress, NULL otherwise.
+	 */
+	struct spdk_bdev_io	**batch_ios;
+	uint32_t		batch_num_ios;
+
+	/* Reads and writes held back for merging, NULL if merging is disabled */
+	struct bdev_channel_merge *merge;
+
 #ifdef SPDK_CONFIG_VTUNE
 	uint64_t		start_tsc;
 	uint64_t		interval_tsc;
@@ -321,6 +444,13 @@ struct spdk_bdev_channel {
 
 	/** List of I/Os queued by QoS. */
 	bdev_io_tailq_t		qos_queued_io;
+
+	/** QoS latency target in tsc ticks, or 0 if the latency isn't tracked. */
+	uint64_t		latency_target_ticks;
+
+	/** I/Os completed and I/Os that missed the latency target since the last collection. */
+	uint64_t		latency_ios;
+	uint64_t		latency_misses;
 };
 
 struct media_event_entry {
@@ -365,6 +495,7 @@ struct set_qos_limit_ctx {
 	void (*cb_fn)(void *cb_arg, int status);
 	void *cb_arg;
 	struct spdk_bdev *bdev;
+	struct spdk_bdev_qos_group *group;
 };
 
 struct spdk_bdev_channel_iter {
@@ -403,6 +534,10 @@ static int bdev_write_zero_buffer(struct spdk_bdev_io *bdev_io);
 static void bdev_enable_qos_msg(struct spdk_bdev_channel_iter *i, struct spdk_bdev *bdev,
 				struct spdk_io_channel *ch, void *_ctx);
 static void bdev_enable_qos_done(struct spdk_bdev *bdev, void *_ctx, int status);
+static void bdev_qos_group_put(struct spdk_bdev_qos_group *group);
+static void bdev_qos_groups_free(void);
+static void bdev_qos_limits_get(const struct spdk_bdev_qos_limit *rate_limits, uint64_t *limits);
+static bool bdev_qos_has_rate_limits(struct spdk_bdev_qos *qos);
 
 static int bdev_readv_blocks_with_md(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
 				     struct iovec *iov, int iovcnt, void *md_buf, uint64_t offset_blocks,
@@ -414,7 +549,7 @@ static int bdev_writev_blocks_with_md(struct spdk_bdev_desc *desc, struct spdk_i
 				      struct iovec *iov, int iovcnt, void *md_buf,
 				      uint64_t offset_blocks, uint64_t num_blocks,
 				      struct spdk_memory_domain *domain, void *domain_ctx,
-				      struct spdk_accel_sequence *seq,
+				      struct spdk_accel_sequence *seq, uint16_t placement_hint,
 				      spdk_bdev_io_completion_cb cb, void *cb_arg);
 
 static int bdev_lock_lba_range(struct spdk_bdev_desc *desc, struct spdk_io_channel *_ch,
@@ -1432,6 +1567,35 @@ bdev_submit_request(struct spdk_bdev *bdev, struct spdk_io_channel *ioch,
 	bdev->fn_table->submit_request(ioch, bdev_io);
 }
 
+static void
+bdev_ch_submit_batch(struct spdk_bdev_channel *bdev_ch)
+{
+	struct spdk_bdev_io **bdev_ios = bdev_ch->batch_ios;
+	uint32_t i, num_ios = bdev_ch->batch_num_ios;
+
+	if (num_ios == 0) {
+		return;
+	}
+
+	bdev_ch->batch_num_ios = 0;
+
+	for (i = 0; i < num_ios; i++) {
+		/* Ownership of the accel sequence moves to the module, see bdev_submit_request() */
+		if ((bdev_ios[i]->type == SPDK_BDEV_IO_TYPE_WRITE ||
+		     bdev_ios[i]->type == SPDK_BDEV_IO_TYPE_READ) &&
+		    bdev_ios[i]->u.bdev.accel_sequence != NULL) {
+			assert(!bdev_io_needs_sequence_exec(bdev_ios[i]->internal.desc, bdev_ios[i]));
+			bdev_ios[i]->internal.accel_sequence = NULL;
+		}
+	}
+
+	bdev_ch->bdev->fn_table->submit_request_batch(bdev_ch->channel, bdev_ios, num_ios);
+
+	for (i = 0; i < num_ios; i++) {
+		bdev_ios[i]->internal.in_submit_request = false;
+	}
+}
+
 static inline void
 bdev_ch_resubmit_io(struct spdk_bdev_shared_resource *shared_resource, struct spdk_bdev_io *bdev_io)
 {
@@ -1785,7 +1949,8 @@ spdk_bdev_io_get_buf(struct spdk_bdev_io *bdev_io, spdk_bdev_io_get_buf_cb cb, u
 	alignment = spdk_bdev_get_buf_align(bdev);
 
 	if (_is_buf_allocated(bdev_io->u.bdev.iovs) &&
-	    _are_iovs_aligned(bdev_io->u.bdev.iovs, bdev_io->u.bdev.iovcnt, alignment)) {
+	    (bdev_io->internal.ch->bufs_aligned ||
+	     _are_iovs_aligned(bdev_io->u.bdev.iovs, bdev_io->u.bdev.iovcnt, alignment))) {
 		/* Buffer already present and aligned */
 		cb(spdk_bdev_io_get_io_channel(bdev_io), bdev_io, true);
 		return;
@@ -1858,6 +2023,9 @@ bdev_module_get_max_ctx_size(void)
 static void
 bdev_enable_histogram_config_json(struct spdk_bdev *bdev, struct spdk_json_write_ctx *w)
 {
+	struct spdk_bdev_enable_histogram_opts *opts = &bdev->internal.histogram_opts;
+	uint32_t i;
+
 	if (!bdev->internal.histogram_enabled) {
 		return;
 	}
@@ -1869,6 +2037,36 @@ bdev_enable_histogram_config_json(struct spdk_bdev *bdev, struct spdk_json_write
 	spdk_json_write_named_string(w, "name", bdev->name);
 
 	spdk_json_write_named_bool(w, "enable", bdev->internal.histogram_enabled);
+	if (opts->breakdown) {
+		spdk_json_write_named_bool(w, "breakdown", true);
+		spdk_json_write_named_array_begin(w, "size_class_bounds");
+		for (i = 0; i < opts->num_size_class_bounds; i++) {
+			spdk_json_write_uint64(w, opts->size_class_bounds[i]);
+		}
+		spdk_json_write_array_end(w);
+	}
+	spdk_json_write_object_end(w);
+
+	spdk_json_write_object_end(w);
+}
+
+static void
+bdev_merge_config_json(struct spdk_bdev *bdev, struct spdk_json_write_ctx *w)
+{
+	struct spdk_bdev_merge_opts *opts = &bdev->internal.merge_opts;
+
+	if (opts->window_us == 0) {
+		return;
+	}
+
+	spdk_json_write_object_begin(w);
+	spdk_json_write_named_string(w, "method", "bdev_set_merge_opts");
+
+	spdk_json_write_named_object_begin(w, "params");
+	spdk_json_write_named_string(w, "name", bdev->name);
+	spdk_json_write_named_uint32(w, "window_us", opts->window_us);
+	spdk_json_write_named_uint32(w, "max_ios", opts->max_ios);
+	spdk_json_write_named_uint64(w, "max_blocks", opts->max_blocks);
 	spdk_json_write_object_end(w);
 
 	spdk_json_write_object_end(w);
@@ -1885,6 +2083,34 @@ bdev_qos_config_json(struct spdk_bdev *bdev, struct spdk_json_write_ctx *w)
 		return;
 	}
 
+	if (qos->group) {
+		spdk_json_write_object_begin(w);
+		spdk_json_write_named_string(w, "method", "bdev_qos_group_add_bdev");
+
+		spdk_json_write_named_object_begin(w, "params");
+		spdk_json_write_named_string(w, "name", qos->group->name);
+		spdk_json_write_named_string(w, "bdev_name", bdev->name);
+		spdk_json_write_object_end(w);
+
+		spdk_json_write_object_end(w);
+	}
+
+	if (qos->latency_target_us != 0) {
+		spdk_json_write_object_begin(w);
+		spdk_json_write_named_string(w, "method", "bdev_set_qos_latency_target");
+
+		spdk_json_write_named_object_begin(w, "params");
+		spdk_json_write_named_string(w, "name", bdev->name);
+		spdk_json_write_named_uint64(w, "latency_target_us", qos->latency_target_us);
+		spdk_json_write_object_end(w);
+
+		spdk_json_write_object_end(w);
+	}
+
+	if (!bdev_qos_has_rate_limits(qos)) {
+		return;
+	}
+
 	spdk_bdev_get_qos_rate_limits(bdev, limits);
 
 	spdk_json_write_object_begin(w);
@@ -1902,6 +2128,35 @@ bdev_qos_config_json(struct spdk_bdev *bdev, struct spdk_json_write_ctx *w)
 	spdk_json_write_object_end(w);
 }
 
+static void
+bdev_qos_groups_config_json(struct spdk_json_write_ctx *w)
+{
+	struct spdk_bdev_qos_group *group;
+	uint64_t limits[SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES];
+	int i;
+
+	spdk_spin_lock(&g_bdev_mgr.spinlock);
+	TAILQ_FOREACH(group, &g_bdev_mgr.qos_groups, link) {
+		memset(limits, 0, sizeof(limits));
+		bdev_qos_limits_get(group->rate_limits, limits);
+
+		spdk_json_write_object_begin(w);
+		spdk_json_write_named_string(w, "method", "bdev_qos_group_create");
+
+		spdk_json_write_named_object_begin(w, "params");
+		spdk_json_write_named_string(w, "name", group->name);
+		for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+			if (limits[i] > 0) {
+				spdk_json_write_named_uint64(w, qos_rpc_type[i], limits[i]);
+			}
+		}
+		spdk_json_write_object_end(w);
+
+		spdk_json_write_object_end(w);
+	}
+	spdk_spin_unlock(&g_bdev_mgr.spinlock);
+}
+
 void
 spdk_bdev_subsystem_config_json(struct spdk_json_write_ctx *w)
 {
@@ -1924,6 +2179,7 @@ spdk_bdev_subsystem_config_json(struct spdk_json_write_ctx *w)
 	spdk_json_write_object_end(w);
 
 	bdev_examine_allowlist_config_json(w);
+	bdev_qos_groups_config_json(w);
 
 	TAILQ_FOREACH(bdev_module, &g_bdev_mgr.bdev_modules, internal.tailq) {
 		if (bdev_module->config_json) {
@@ -1940,6 +2196,7 @@ spdk_bdev_subsystem_config_json(struct spdk_json_write_ctx *w)
 
 		bdev_qos_config_json(bdev, w);
 		bdev_enable_histogram_config_json(bdev, w);
+		bdev_merge_config_json(bdev, w);
 	}
 
 	spdk_spin_unlock(&g_bdev_mgr.spinlock);
@@ -2225,6 +2482,7 @@ bdev_mgr_unregister_cb(void *io_device)
 	spdk_free(g_bdev_mgr.zero_buffer);
 
 	bdev_examine_allowlist_free();
+	bdev_qos_groups_free();
 
 	cb_fn(g_fini_cb_arg);
 	g_fini_cb_fn = NULL;
@@ -2433,13 +2691,24 @@ spdk_bdev_finish(spdk_bdev_fini_cb cb_fn, void *cb_arg)
 	}
 }
 
+static inline bool
+bdev_channel_io_pool_owns_io(struct bdev_channel_io_pool *pool, struct spdk_bdev_io *bdev_io)
+{
+	return (uintptr_t)bdev_io - (uintptr_t)pool->ios < (uintptr_t)pool->num_ios * pool->io_size;
+}
+
 struct spdk_bdev_io *
 bdev_channel_get_io(struct spdk_bdev_channel *channel)
 {
 	struct spdk_bdev_mgmt_channel *ch = channel->shared_resource->mgmt_ch;
+	struct bdev_channel_io_pool *pool = channel->io_pool;
 	struct spdk_bdev_io *bdev_io;
 
-	if (ch->per_thread_cache_count > 0) {
+	if (pool != NULL && pool->num_free_ios > 0) {
+		bdev_io = STAILQ_FIRST(&pool->free_ios);
+		STAILQ_REMOVE_HEAD(&pool->free_ios, internal.buf_link);
+		pool->num_free_ios--;
+	} else if (ch->per_thread_cache_count > 0) {
 		bdev_io = STAILQ_FIRST(&ch->per_thread_cache);
 		STAILQ_REMOVE_HEAD(&ch->per_thread_cache, internal.buf_link);
 		ch->per_thread_cache_count--;
@@ -2460,22 +2729,42 @@ void
 spdk_bdev_free_io(struct spdk_bdev_io *bdev_io)
 {
 	struct spdk_bdev_mgmt_channel *ch;
+	struct bdev_channel_io_pool *pool;
+	struct spdk_bdev_io_wait_entry *entry, *last;
 
 	assert(bdev_io != NULL);
 	assert(bdev_io->internal.status != SPDK_BDEV_IO_STATUS_PENDING);
 
 	ch = bdev_io->internal.ch->shared_resource->mgmt_ch;
+	pool = bdev_io->internal.ch->io_pool;
 
 	if (bdev_io->internal.buf != NULL) {
 		bdev_io_put_buf(bdev_io);
 	}
 
+	if (pool != NULL && bdev_channel_io_pool_owns_io(pool, bdev_io)) {
+		pool->num_free_ios++;
+		STAILQ_INSERT_HEAD(&pool->free_ios, bdev_io, internal.buf_link);
+		/*
+		 * Waiters submitting to other channels can't use this bdev_io and queue
+		 * themselves again, so wake each of the current waiters at most once.
+		 */
+		last = TAILQ_LAST(&ch->io_wait_queue, bdev_io_wait_queue);
+		while (pool->num_free_ios > 0 && !TAILQ_EMPTY(&ch->io_wait_queue)) {
+			entry = TAILQ_FIRST(&ch->io_wait_queue);
+			TAILQ_REMOVE(&ch->io_wait_queue, entry, link);
+			entry->cb_fn(entry->cb_arg);
+			if (entry == last) {
+				break;
+			}
+		}
+		return;
+	}
+
 	if (ch->per_thread_cache_count < ch->bdev_io_cache_size) {
 		ch->per_thread_cache_count++;
 		STAILQ_INSERT_HEAD(&ch->per_thread_cache, bdev_io, internal.buf_link);
 		while (ch->per_thread_cache_count > 0 && !TAILQ_EMPTY(&ch->io_wait_queue)) {
-			struct spdk_bdev_io_wait_entry *entry;
-
 			entry = TAILQ_FIRST(&ch->io_wait_queue);
 			TAILQ_REMOVE(&ch->io_wait_queue, entry, link);
 			entry->cb_fn(entry->cb_arg);
@@ -2575,6 +2864,100 @@ bdev_get_io_size_in_byte(struct spdk_bdev_io *bdev_io)
 	}
 }
 
+static struct spdk_bdev_histogram_breakdown *
+bdev_histogram_breakdown_alloc(const struct spdk_bdev_enable_histogram_opts *opts)
+{
+	struct spdk_bdev_histogram_breakdown *breakdown;
+
+	breakdown = calloc(1, sizeof(*breakdown));
+	if (breakdown == NULL) {
+		return NULL;
+	}
+
+	breakdown->num_size_classes = opts->num_size_class_bounds + 1;
+	memcpy(breakdown->size_class_bounds, opts->size_class_bounds,
+	       opts->num_size_class_bounds * sizeof(opts->size_class_bounds[0]));
+
+	return breakdown;
+}
+
+static bool
+bdev_histogram_breakdown_matches(const struct spdk_bdev_histogram_breakdown *breakdown,
+				 const struct spdk_bdev_enable_histogram_opts *opts)
+{
+	return opts->breakdown && breakdown->num_size_classes == opts->num_size_class_bounds + 1 &&
+	       memcmp(breakdown->size_class_bounds, opts->size_class_bounds,
+		      opts->num_size_class_bounds * sizeof(opts->size_class_bounds[0])) == 0;
+}
+
+static void
+bdev_histogram_breakdown_free(struct spdk_bdev_histogram_breakdown *breakdown)
+{
+	uint32_t type, i;
+
+	if (breakdown == NULL) {
+		return;
+	}
+
+	for (type = 0; type < SPDK_BDEV_NUM_IO_TYPES; type++) {
+		for (i = 0; i < breakdown->num_size_classes; i++) {
+			if (breakdown->histogram[type][i] != NULL) {
+				spdk_histogram_data_free(breakdown->histogram[type][i]);
+			}
+		}
+	}
+
+	free(breakdown);
+}
+
+static uint64_t
+bdev_histogram_io_size(struct spdk_bdev_io *bdev_io)
+{
+	switch (bdev_io->type) {
+	case SPDK_BDEV_IO_TYPE_NVME_IO:
+	case SPDK_BDEV_IO_TYPE_NVME_IO_MD:
+		return bdev_io->u.nvme_passthru.nbytes;
+	case SPDK_BDEV_IO_TYPE_READ:
+	case SPDK_BDEV_IO_TYPE_WRITE:
+	case SPDK_BDEV_IO_TYPE_UNMAP:
+	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
+	case SPDK_BDEV_IO_TYPE_ZCOPY:
+	case SPDK_BDEV_IO_TYPE_COMPARE:
+	case SPDK_BDEV_IO_TYPE_COMPARE_AND_WRITE:
+	case SPDK_BDEV_IO_TYPE_COPY:
+		return bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen;
+	default:
+		return 0;
+	}
+}
+
+static void
+bdev_histogram_breakdown_tally(struct spdk_bdev_histogram_breakdown *breakdown,
+			       struct spdk_bdev_io *bdev_io, uint64_t tsc_diff)
+{
+	struct spdk_histogram_data **histogram;
+	uint64_t size = bdev_histogram_io_size(bdev_io);
+	uint32_t i;
+
+	for (i = 0; i < breakdown->num_size_classes - 1; i++) {
+		if (size <= breakdown->size_class_bounds[i]) {
+			break;
+		}
+	}
+
+	histogram = &breakdown->histogram[bdev_io->type][i];
+	if (spdk_unlikely(*histogram == NULL)) {
+		/* Most combinations of I/O type and size class never show up, so the histograms
+		 * are only allocated once they do. */
+		*histogram = spdk_histogram_data_alloc();
+		if (*histogram == NULL) {
+			return;
+		}
+	}
+
+	spdk_histogram_data_tally(*histogram, tsc_diff);
+}
+
 static inline bool
 bdev_qos_rw_queue_io(struct spdk_bdev_qos_limit *limit, struct spdk_bdev_io *io, uint64_t delta)
 {
@@ -2609,6 +2992,11 @@ bdev_qos_rw_queue_io(struct spdk_bdev_qos_limit *limit, struct spdk_bdev_io *io,
 static inline void
 bdev_qos_rw_rewind_io(struct spdk_bdev_qos_limit *limit, struct spdk_bdev_io *io, uint64_t delta)
 {
+	if (!limit->max_per_timeslice) {
+		/* The QoS is disabled, so nothing was taken from the quota */
+		return;
+	}
+
 	__atomic_add_fetch(&limit->remaining_this_timeslice, delta, __ATOMIC_RELAXED);
 }
 
@@ -2672,6 +3060,31 @@ bdev_qos_w_bps_rewind_quota(struct spdk_bdev_qos_limit *limit, struct spdk_bdev_
 	}
 }
 
+static void
+bdev_qos_limit_set_ops(struct spdk_bdev_qos_limit *limit, enum spdk_bdev_qos_rate_limit_type type)
+{
+	switch (type) {
+	case SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT:
+		limit->queue_io = bdev_qos_rw_iops_queue;
+		limit->rewind_quota = bdev_qos_rw_iops_rewind_quota;
+		break;
+	case SPDK_BDEV_QOS_RW_BPS_RATE_LIMIT:
+		limit->queue_io = bdev_qos_rw_bps_queue;
+		limit->rewind_quota = bdev_qos_rw_bps_rewind_quota;
+		break;
+	case SPDK_BDEV_QOS_R_BPS_RATE_LIMIT:
+		limit->queue_io = bdev_qos_r_bps_queue;
+		limit->rewind_quota = bdev_qos_r_bps_rewind_quota;
+		break;
+	case SPDK_BDEV_QOS_W_BPS_RATE_LIMIT:
+		limit->queue_io = bdev_qos_w_bps_queue;
+		limit->rewind_quota = bdev_qos_w_bps_rewind_quota;
+		break;
+	default:
+		break;
+	}
+}
+
 static void
 bdev_qos_set_ops(struct spdk_bdev_qos *qos)
 {
@@ -2683,26 +3096,7 @@ bdev_qos_set_ops(struct spdk_bdev_qos *qos)
 			continue;
 		}
 
-		switch (i) {
-		case SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT:
-			qos->rate_limits[i].queue_io = bdev_qos_rw_iops_queue;
-			qos->rate_limits[i].rewind_quota = bdev_qos_rw_iops_rewind_quota;
-			break;
-		case SPDK_BDEV_QOS_RW_BPS_RATE_LIMIT:
-			qos->rate_limits[i].queue_io = bdev_qos_rw_bps_queue;
-			qos->rate_limits[i].rewind_quota = bdev_qos_rw_bps_rewind_quota;
-			break;
-		case SPDK_BDEV_QOS_R_BPS_RATE_LIMIT:
-			qos->rate_limits[i].queue_io = bdev_qos_r_bps_queue;
-			qos->rate_limits[i].rewind_quota = bdev_qos_r_bps_rewind_quota;
-			break;
-		case SPDK_BDEV_QOS_W_BPS_RATE_LIMIT:
-			qos->rate_limits[i].queue_io = bdev_qos_w_bps_queue;
-			qos->rate_limits[i].rewind_quota = bdev_qos_w_bps_rewind_quota;
-			break;
-		default:
-			break;
-		}
+		bdev_qos_limit_set_ops(&qos->rate_limits[i], i);
 	}
 }
 
@@ -2718,36 +3112,23 @@ _bdev_io_complete_in_submit(struct spdk_bdev_channel *bdev_ch,
 }
 
 static inline void
-bdev_io_do_submit(struct spdk_bdev_channel *bdev_ch, struct spdk_bdev_io *bdev_io)
+bdev_io_submit_to_module(struct spdk_bdev_channel *bdev_ch, struct spdk_bdev_io *bdev_io)
 {
 	struct spdk_bdev *bdev = bdev_io->bdev;
 	struct spdk_io_channel *ch = bdev_ch->channel;
 	struct spdk_bdev_shared_resource *shared_resource = bdev_ch->shared_resource;
 
-	if (spdk_unlikely(bdev_io->type == SPDK_BDEV_IO_TYPE_ABORT)) {
-		struct spdk_bdev_mgmt_channel *mgmt_channel = shared_resource->mgmt_ch;
-		struct spdk_bdev_io *bio_to_abort = bdev_io->u.abort.bio_to_abort;
-
-		if (bdev_abort_queued_io(&shared_resource->nomem_io, bio_to_abort) ||
-		    bdev_abort_buf_io(mgmt_channel, bio_to_abort)) {
-			_bdev_io_complete_in_submit(bdev_ch, bdev_io,
-						    SPDK_BDEV_IO_STATUS_SUCCESS);
-			return;
-		}
-	}
-
-	if (spdk_unlikely(bdev_io->type == SPDK_BDEV_IO_TYPE_WRITE &&
-			  bdev_io->bdev->split_on_write_unit &&
-			  bdev_io->u.bdev.num_blocks < bdev_io->bdev->write_unit_size)) {
-		SPDK_ERRLOG("IO num_blocks %lu does not match the write_unit_size %u\n",
-			    bdev_io->u.bdev.num_blocks, bdev_io->bdev->write_unit_size);
-		_bdev_io_complete_in_submit(bdev_ch, bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
-		return;
-	}
-
 	if (spdk_likely(TAILQ_EMPTY(&shared_resource->nomem_io))) {
 		bdev_io_increment_outstanding(bdev_ch, shared_resource);
 		bdev_io->internal.in_submit_request = true;
+		if (bdev_ch->batch_ios != NULL) {
+			/* Submitted along with the rest of the batch */
+			if (bdev_ch->batch_num_ios == BDEV_CH_BATCH_MAX_IOS) {
+				bdev_ch_submit_batch(bdev_ch);
+			}
+			bdev_ch->batch_ios[bdev_ch->batch_num_ios++] = bdev_io;
+			return;
+		}
 		bdev_submit_request(bdev, ch, bdev_io);
 		bdev_io->internal.in_submit_request = false;
 	} else {
@@ -2760,29 +3141,359 @@ bdev_io_do_submit(struct spdk_bdev_channel *bdev_ch, struct spdk_bdev_io *bdev_i
 	}
 }
 
-static bool
-bdev_qos_queue_io(struct spdk_bdev_qos *qos, struct spdk_bdev_io *bdev_io)
+static void
+bdev_ch_merge_done(struct spdk_bdev_io *merged_io, bool success, void *cb_arg)
 {
-	int i;
+	struct spdk_bdev_channel *bdev_ch = merged_io->internal.ch;
+	struct spdk_bdev_io *bdev_io = cb_arg, *next;
 
-	if (bdev_qos_io_to_limit(bdev_io) == true) {
-		for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
-			if (!qos->rate_limits[i].queue_io) {
-				continue;
-			}
+	/*
+	 * The original I/O are still linked together, see bdev_ch_merge_flush().  They never
+	 * reached the module, so count them as outstanding before completing them the regular
+	 * way, which accounts for them in the statistics and histograms.
+	 */
+	while (bdev_io != NULL) {
+		next = TAILQ_NEXT(bdev_io, internal.link);
 
-			if (qos->rate_limits[i].queue_io(&qos->rate_limits[i],
-							 bdev_io) == true) {
-				for (i -= 1; i >= 0 ; i--) {
-					if (!qos->rate_limits[i].queue_io) {
-						continue;
-					}
+		bdev_io->internal.error = merged_io->internal.error;
+		bdev_io_increment_outstanding(bdev_ch, bdev_ch->shared_resource);
+		spdk_bdev_io_complete(bdev_io, merged_io->internal.status);
 
-					qos->rate_limits[i].rewind_quota(&qos->rate_limits[i], bdev_io);
-				}
-				return true;
-			}
-		}
+		bdev_io = next;
+	}
+
+	spdk_bdev_free_io(merged_io);
+}
+
+static void
+bdev_ch_merge_flush(struct spdk_bdev_channel *bdev_ch)
+{
+	struct bdev_channel_merge *merge = bdev_ch->merge;
+	struct spdk_bdev_io *first, *bdev_io, *tmp, *merged_io;
+	int iovcnt = 0;
+
+	first = TAILQ_FIRST(&merge->ios);
+	if (first == NULL) {
+		return;
+	}
+
+	merged_io = NULL;
+	if (merge->num_ios > 1) {
+		merged_io = bdev_channel_get_io(bdev_ch);
+	}
+
+	if (merged_io == NULL) {
+		/* Nothing to merge with or no spare bdev_io, submit the I/O as they are */
+		TAILQ_FOREACH_SAFE(bdev_io, &merge->ios, internal.link, tmp) {
+			TAILQ_REMOVE(&merge->ios, bdev_io, internal.link);
+			bdev_io_submit_to_module(bdev_ch, bdev_io);
+		}
+		merge->num_ios = 0;
+		merge->iovcnt = 0;
+		merge->num_blocks = 0;
+		return;
+	}
+
+	TAILQ_FOREACH(bdev_io, &merge->ios, internal.link) {
+		memcpy(&merged_io->child_iov[iovcnt], bdev_io->u.bdev.iovs,
+		       bdev_io->u.bdev.iovcnt * sizeof(struct iovec));
+		iovcnt += bdev_io->u.bdev.iovcnt;
+	}
+	assert(iovcnt == merge->iovcnt);
+
+	merged_io->internal.ch = bdev_ch;
+	merged_io->internal.desc = first->internal.desc;
+	merged_io->type = merge->type;
+	merged_io->u.bdev.iovs = merged_io->child_iov;
+	merged_io->u.bdev.iovcnt = iovcnt;
+	merged_io->u.bdev.md_buf = NULL;
+	merged_io->u.bdev.num_blocks = merge->num_blocks;
+	merged_io->u.bdev.offset_blocks = merge->offset_blocks;
+	merged_io->u.bdev.memory_domain = NULL;
+	merged_io->u.bdev.memory_domain_ctx = NULL;
+	merged_io->u.bdev.accel_sequence = NULL;
+	merged_io->u.bdev.placement_hint = first->u.bdev.placement_hint;
+	bdev_io_init(merged_io, bdev_ch->bdev, first, bdev_ch_merge_done);
+	assert(!merged_io->internal.split);
+
+	/*
+	 * The original I/O stay linked through internal.link so that bdev_ch_merge_done() can
+	 * walk them starting from the first one.  The merged I/O bypasses the locked range
+	 * check, as the original I/O already passed it.
+	 */
+	TAILQ_INIT(&merge->ios);
+	merge->num_ios = 0;
+	merge->iovcnt = 0;
+	merge->num_blocks = 0;
+
+	TAILQ_INSERT_TAIL(&bdev_ch->io_submitted, merged_io, internal.ch_link);
+	merged_io->internal.submit_tsc = spdk_get_ticks();
+	spdk_trace_record_tsc(merged_io->internal.submit_tsc, TRACE_BDEV_IO_START, 0, 0,
+			      (uintptr_t)merged_io, (uint64_t)merged_io->type, first,
+			      merged_io->u.bdev.offset_blocks, merged_io->u.bdev.num_blocks,
+			      spdk_bdev_get_name(bdev_ch->bdev));
+
+	bdev_io_submit_to_module(bdev_ch, merged_io);
+}
+
+static bool
+bdev_io_can_merge(struct spdk_bdev_io *bdev_io)
+{
+	if (bdev_io->type != SPDK_BDEV_IO_TYPE_READ && bdev_io->type != SPDK_BDEV_IO_TYPE_WRITE) {
+		return false;
+	}
+
+	return bdev_io->u.bdev.md_buf == NULL &&
+	       bdev_io->u.bdev.memory_domain == NULL &&
+	       bdev_io->u.bdev.accel_sequence == NULL &&
+	       bdev_io->internal.orig_iovcnt == 0 &&
+	       bdev_io->u.bdev.iovcnt > 0 &&
+	       bdev_io->u.bdev.iovs[0].iov_base != NULL;
+}
+
+/* Check whether bdev_io can be appended to the held back I/O */
+static bool
+bdev_ch_merge_fits(struct spdk_bdev_channel *bdev_ch, struct spdk_bdev_io *bdev_io)
+{
+	struct bdev_channel_merge *merge = bdev_ch->merge;
+	struct spdk_bdev *bdev = bdev_ch->bdev;
+	uint64_t num_blocks = merge->num_blocks + bdev_io->u.bdev.num_blocks;
+	int iovcnt = merge->iovcnt + bdev_io->u.bdev.iovcnt;
+	uint32_t io_boundary;
+
+	if (bdev_io->type != merge->type ||
+	    bdev_io->u.bdev.offset_blocks != merge->offset_blocks + merge->num_blocks) {
+		return false;
+	}
+
+	if (bdev_io->type == SPDK_BDEV_IO_TYPE_WRITE &&
+	    bdev_io->u.bdev.placement_hint != TAILQ_FIRST(&merge->ios)->u.bdev.placement_hint) {
+		return false;
+	}
+
+	if (iovcnt > SPDK_BDEV_IO_NUM_CHILD_IOV ||
+	    (bdev->max_num_segments != 0 && iovcnt > (int)bdev->max_num_segments)) {
+		return false;
+	}
+
+	if ((merge->max_blocks != 0 && num_blocks > merge->max_blocks) ||
+	    (bdev->max_rw_size != 0 && num_blocks > bdev->max_rw_size)) {
+		return false;
+	}
+
+	/* The merged I/O must not need to be split again */
+	if (bdev_io->type == SPDK_BDEV_IO_TYPE_WRITE && bdev->split_on_write_unit) {
+		io_boundary = bdev->write_unit_size;
+	} else if (bdev->split_on_optimal_io_boundary) {
+		io_boundary = bdev->optimal_io_boundary;
+	} else {
+		io_boundary = 0;
+	}
+
+	if (io_boundary != 0 &&
+	    merge->offset_blocks / io_boundary != (merge->offset_blocks + num_blocks - 1) / io_boundary) {
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * Hold back a read or write to merge it with the LBA-contiguous ones following it.  Returns
+ * true if bdev_io was held back.
+ */
+static bool
+bdev_ch_merge_io(struct spdk_bdev_channel *bdev_ch, struct spdk_bdev_io *bdev_io)
+{
+	struct bdev_channel_merge *merge = bdev_ch->merge;
+
+	if (!bdev_io_can_merge(bdev_io)) {
+		/* Keep the held back I/O ahead of this one */
+		bdev_ch_merge_flush(bdev_ch);
+		return false;
+	}
+
+	if (merge->num_ios != 0 && !bdev_ch_merge_fits(bdev_ch, bdev_io)) {
+		bdev_ch_merge_flush(bdev_ch);
+	}
+
+	if (merge->num_ios == 0) {
+		merge->type = bdev_io->type;
+		merge->offset_blocks = bdev_io->u.bdev.offset_blocks;
+	}
+
+	TAILQ_INSERT_TAIL(&merge->ios, bdev_io, internal.link);
+	merge->num_ios++;
+	merge->iovcnt += bdev_io->u.bdev.iovcnt;
+	merge->num_blocks += bdev_io->u.bdev.num_blocks;
+
+	if (merge->num_ios >= merge->max_ios) {
+		bdev_ch_merge_flush(bdev_ch);
+	}
+
+	return true;
+}
+
+static int
+bdev_ch_merge_poll(void *arg)
+{
+	struct spdk_bdev_channel *bdev_ch = arg;
+
+	if (bdev_ch->merge->num_ios == 0) {
+		return SPDK_POLLER_IDLE;
+	}
+
+	bdev_ch_merge_flush(bdev_ch);
+
+	return SPDK_POLLER_BUSY;
+}
+
+static int
+bdev_channel_set_merge(struct spdk_bdev_channel *ch, const struct spdk_bdev_merge_opts *opts)
+{
+	struct bdev_channel_merge *merge = ch->merge;
+
+	if (merge != NULL) {
+		/* Submit what was held back under the previous options */
+		bdev_ch_merge_flush(ch);
+		spdk_poller_unregister(&merge->poller);
+	}
+
+	if (opts->window_us == 0) {
+		free(merge);
+		ch->merge = NULL;
+		return 0;
+	}
+
+	if (merge == NULL) {
+		merge = calloc(1, sizeof(*merge));
+		if (merge == NULL) {
+			return -ENOMEM;
+		}
+		TAILQ_INIT(&merge->ios);
+	}
+
+	merge->poller = SPDK_POLLER_REGISTER(bdev_ch_merge_poll, ch, opts->window_us);
+	if (merge->poller == NULL) {
+		free(merge);
+		ch->merge = NULL;
+		return -ENOMEM;
+	}
+
+	merge->max_ios = opts->max_ios;
+	merge->max_blocks = opts->max_blocks;
+	ch->merge = merge;
+
+	return 0;
+}
+
+static inline void
+bdev_io_do_submit(struct spdk_bdev_channel *bdev_ch, struct spdk_bdev_io *bdev_io)
+{
+	struct spdk_bdev_shared_resource *shared_resource = bdev_ch->shared_resource;
+
+	if (spdk_unlikely(bdev_io->type == SPDK_BDEV_IO_TYPE_ABORT)) {
+		struct spdk_bdev_mgmt_channel *mgmt_channel = shared_resource->mgmt_ch;
+		struct spdk_bdev_io *bio_to_abort = bdev_io->u.abort.bio_to_abort;
+
+		if (bdev_abort_queued_io(&shared_resource->nomem_io, bio_to_abort) ||
+		    bdev_abort_buf_io(mgmt_channel, bio_to_abort)) {
+			_bdev_io_complete_in_submit(bdev_ch, bdev_io,
+						    SPDK_BDEV_IO_STATUS_SUCCESS);
+			return;
+		}
+	}
+
+	if (spdk_unlikely(bdev_io->type == SPDK_BDEV_IO_TYPE_WRITE &&
+			  bdev_io->bdev->split_on_write_unit &&
+			  bdev_io->u.bdev.num_blocks < bdev_io->bdev->write_unit_size)) {
+		SPDK_ERRLOG("IO num_blocks %lu does not match the write_unit_size %u\n",
+			    bdev_io->u.bdev.num_blocks, bdev_io->bdev->write_unit_size);
+		_bdev_io_complete_in_submit(bdev_ch, bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		return;
+	}
+
+	if (spdk_unlikely(bdev_ch->merge != NULL) && bdev_ch_merge_io(bdev_ch, bdev_io)) {
+		return;
+	}
+
+	bdev_io_submit_to_module(bdev_ch, bdev_io);
+}
+
+static void
+bdev_qos_limits_rewind_quota(struct spdk_bdev_qos_limit *limits, int count,
+			     struct spdk_bdev_io *bdev_io)
+{
+	int i;
+
+	for (i = count - 1; i >= 0 ; i--) {
+		if (!limits[i].queue_io) {
+			continue;
+		}
+
+		limits[i].rewind_quota(&limits[i], bdev_io);
+	}
+}
+
+static bool
+bdev_qos_limits_queue_io(struct spdk_bdev_qos_limit *limits, struct spdk_bdev_io *bdev_io)
+{
+	int i;
+
+	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+		if (!limits[i].queue_io) {
+			continue;
+		}
+
+		if (limits[i].queue_io(&limits[i], bdev_io) == true) {
+			bdev_qos_limits_rewind_quota(limits, i, bdev_io);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static bool
+bdev_qos_group_queue_io(struct spdk_bdev_qos_group *group, struct spdk_bdev_qos *qos,
+			struct spdk_bdev_io *bdev_io)
+{
+	if (bdev_qos_limits_queue_io(group->rate_limits, bdev_io)) {
+		return true;
+	}
+
+	if (qos->latency_target_ticks != 0) {
+		return false;
+	}
+
+	/* Best-effort bdevs are additionally held to the limits derived from the
+	 * latency targets of the other members of the group. */
+	if (bdev_qos_limits_queue_io(group->be_limits, bdev_io)) {
+		bdev_qos_limits_rewind_quota(group->rate_limits, SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES, bdev_io);
+		return true;
+	}
+
+	__atomic_add_fetch(&group->be_ios, 1, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&group->be_bytes, bdev_get_io_size_in_byte(bdev_io), __ATOMIC_RELAXED);
+
+	return false;
+}
+
+static bool
+bdev_qos_queue_io(struct spdk_bdev_qos *qos, struct spdk_bdev_io *bdev_io)
+{
+	if (bdev_qos_io_to_limit(bdev_io) == false) {
+		return false;
+	}
+
+	if (bdev_qos_limits_queue_io(qos->rate_limits, bdev_io)) {
+		return true;
+	}
+
+	if (qos->group != NULL && bdev_qos_group_queue_io(qos->group, qos, bdev_io)) {
+		/* The group ran out of quota, so give back what this bdev's own limits took. */
+		bdev_qos_limits_rewind_quota(qos->rate_limits, SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES, bdev_io);
+		return true;
 	}
 
 	return false;
@@ -3010,6 +3721,7 @@ bdev_io_split_submit(struct spdk_bdev_io *bdev_io, struct iovec *iov, int iovcnt
 						iov, iovcnt, md_buf, current_offset,
 						num_blocks, bdev_io->internal.memory_domain,
 						bdev_io->internal.memory_domain_ctx, NULL,
+						bdev_io->u.bdev.placement_hint,
 						bdev_io_split_done, bdev_io);
 		break;
 	case SPDK_BDEV_IO_TYPE_UNMAP:
@@ -3695,71 +4407,60 @@ spdk_bdev_dump_info_json(struct spdk_bdev *bdev, struct spdk_json_write_ctx *w)
 }
 
 static void
-bdev_qos_update_max_quota_per_timeslice(struct spdk_bdev_qos *qos)
+bdev_qos_limits_update_max_quota_per_timeslice(struct spdk_bdev_qos_limit *limits)
 {
 	uint32_t max_per_timeslice = 0;
 	int i;
 
 	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
-		if (qos->rate_limits[i].limit == SPDK_BDEV_QOS_LIMIT_NOT_DEFINED) {
-			qos->rate_limits[i].max_per_timeslice = 0;
+		if (limits[i].limit == SPDK_BDEV_QOS_LIMIT_NOT_DEFINED) {
+			limits[i].max_per_timeslice = 0;
 			continue;
 		}
 
-		max_per_timeslice = qos->rate_limits[i].limit *
+		max_per_timeslice = limits[i].limit *
 				    SPDK_BDEV_QOS_TIMESLICE_IN_USEC / SPDK_SEC_TO_USEC;
 
-		qos->rate_limits[i].max_per_timeslice = spdk_max(max_per_timeslice,
-							qos->rate_limits[i].min_per_timeslice);
+		limits[i].max_per_timeslice = spdk_max(max_per_timeslice,
+						       limits[i].min_per_timeslice);
 
-		__atomic_store_n(&qos->rate_limits[i].remaining_this_timeslice,
-				 qos->rate_limits[i].max_per_timeslice, __ATOMIC_RELEASE);
+		__atomic_store_n(&limits[i].remaining_this_timeslice,
+				 limits[i].max_per_timeslice, __ATOMIC_RELEASE);
 	}
-
-	bdev_qos_set_ops(qos);
 }
 
 static void
-bdev_channel_submit_qos_io(struct spdk_bdev_channel_iter *i, struct spdk_bdev *bdev,
-			   struct spdk_io_channel *io_ch, void *ctx)
+bdev_qos_update_max_quota_per_timeslice(struct spdk_bdev_qos *qos)
 {
-	struct spdk_bdev_channel *bdev_ch = __io_ch_to_bdev_ch(io_ch);
-	int status;
-
-	bdev_qos_io_submit(bdev_ch, bdev->internal.qos);
-
-	/* if all IOs were sent then continue the iteration, otherwise - stop it */
-	/* TODO: channels round robing */
-	status = TAILQ_EMPTY(&bdev_ch->qos_queued_io) ? 0 : 1;
-
-	spdk_bdev_for_each_channel_continue(i, status);
+	bdev_qos_limits_update_max_quota_per_timeslice(qos->rate_limits);
+	bdev_qos_set_ops(qos);
 }
 
-
 static void
-bdev_channel_submit_qos_io_done(struct spdk_bdev *bdev, void *ctx, int status)
+bdev_qos_limits_init(struct spdk_bdev_qos_limit *limits)
 {
+	int i;
+
+	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+		if (bdev_qos_is_iops_rate_limit(i) == true) {
+			limits[i].min_per_timeslice = SPDK_BDEV_QOS_MIN_IO_PER_TIMESLICE;
+		} else {
+			limits[i].min_per_timeslice = SPDK_BDEV_QOS_MIN_BYTE_PER_TIMESLICE;
+		}
 
+		if (limits[i].limit == 0) {
+			limits[i].limit = SPDK_BDEV_QOS_LIMIT_NOT_DEFINED;
+		}
+	}
 }
 
-static int
-bdev_channel_poll_qos(void *arg)
+static void
+bdev_qos_limits_refill(struct spdk_bdev_qos_limit *limits, uint64_t *last_timeslice,
+		       uint64_t timeslice_size, uint64_t now)
 {
-	struct spdk_bdev *bdev = arg;
-	struct spdk_bdev_qos *qos = bdev->internal.qos;
-	uint64_t now = spdk_get_ticks();
 	int i;
 	int64_t remaining_last_timeslice;
 
-	if (now < (qos->last_timeslice + qos->timeslice_size)) {
-		/* We received our callback earlier than expected - return
-		 *  immediately and wait to do accounting until at least one
-		 *  timeslice has actually expired.  This should never happen
-		 *  with a well-behaved timer implementation.
-		 */
-		return SPDK_POLLER_IDLE;
-	}
-
 	/* Reset for next round of rate limiting */
 	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
 		/* We may have allowed the IOs or bytes to slightly overrun in the last
@@ -3767,48 +4468,164 @@ bdev_channel_poll_qos(void *arg)
 		 * here, we'll account for the overrun so that the next timeslice will
 		 * be appropriately reduced.
 		 */
-		remaining_last_timeslice = __atomic_exchange_n(&qos->rate_limits[i].remaining_this_timeslice,
+		remaining_last_timeslice = __atomic_exchange_n(&limits[i].remaining_this_timeslice,
 					   0, __ATOMIC_RELAXED);
 		if (remaining_last_timeslice < 0) {
 			/* There could be a race condition here as both bdev_qos_rw_queue_io() and bdev_channel_poll_qos()
 			 * potentially use 2 atomic ops each, so they can intertwine.
 			 * This race can potentialy cause the limits to be a little fuzzy but won't cause any real damage.
 			 */
-			__atomic_store_n(&qos->rate_limits[i].remaining_this_timeslice,
+			__atomic_store_n(&limits[i].remaining_this_timeslice,
 					 remaining_last_timeslice, __ATOMIC_RELAXED);
 		}
 	}
 
-	while (now >= (qos->last_timeslice + qos->timeslice_size)) {
-		qos->last_timeslice += qos->timeslice_size;
+	while (now >= (*last_timeslice + timeslice_size)) {
+		*last_timeslice += timeslice_size;
 		for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
-			__atomic_add_fetch(&qos->rate_limits[i].remaining_this_timeslice,
-					   qos->rate_limits[i].max_per_timeslice, __ATOMIC_RELAXED);
+			__atomic_add_fetch(&limits[i].remaining_this_timeslice,
+					   limits[i].max_per_timeslice, __ATOMIC_RELAXED);
 		}
 	}
-
-	spdk_bdev_for_each_channel(bdev, bdev_channel_submit_qos_io, qos,
-				   bdev_channel_submit_qos_io_done);
-
-	return SPDK_POLLER_BUSY;
 }
 
 static void
-bdev_channel_destroy_resource(struct spdk_bdev_channel *ch)
+bdev_channel_submit_qos_io(struct spdk_bdev_channel_iter *i, struct spdk_bdev *bdev,
+			   struct spdk_io_channel *io_ch, void *ctx)
 {
-	struct spdk_bdev_shared_resource *shared_resource;
-	struct lba_range *range;
+	struct spdk_bdev_channel *bdev_ch = __io_ch_to_bdev_ch(io_ch);
+	int status;
 
-	bdev_free_io_stat(ch->stat);
-#ifdef SPDK_CONFIG_VTUNE
-	bdev_free_io_stat(ch->prev_stat);
-#endif
+	bdev_qos_io_submit(bdev_ch, bdev->internal.qos);
 
-	while (!TAILQ_EMPTY(&ch->locked_ranges)) {
-		range = TAILQ_FIRST(&ch->locked_ranges);
-		TAILQ_REMOVE(&ch->locked_ranges, range, tailq);
-		free(range);
-	}
+	/* if all IOs were sent then continue the iteration, otherwise - stop it */
+	/* TODO: channels round robing */
+	status = TAILQ_EMPTY(&bdev_ch->qos_queued_io) ? 0 : 1;
+
+	spdk_bdev_for_each_channel_continue(i, status);
+}
+
+
+static void
+bdev_channel_submit_qos_io_done(struct spdk_bdev *bdev, void *ctx, int status)
+{
+
+}
+
+struct bdev_qos_latency_ctx {
+	uint64_t ios;
+	uint64_t misses;
+};
+
+static void
+bdev_qos_latency_collect_msg(struct spdk_bdev_channel_iter *i, struct spdk_bdev *bdev,
+			     struct spdk_io_channel *io_ch, void *_ctx)
+{
+	struct spdk_bdev_channel *bdev_ch = __io_ch_to_bdev_ch(io_ch);
+	struct bdev_qos_latency_ctx *ctx = _ctx;
+
+	ctx->ios += bdev_ch->latency_ios;
+	ctx->misses += bdev_ch->latency_misses;
+	bdev_ch->latency_ios = 0;
+	bdev_ch->latency_misses = 0;
+
+	spdk_bdev_for_each_channel_continue(i, 0);
+}
+
+static void
+bdev_qos_latency_collect_done(struct spdk_bdev *bdev, void *_ctx, int status)
+{
+	struct bdev_qos_latency_ctx *ctx = _ctx;
+	struct spdk_bdev_qos *qos;
+	bool missed;
+
+	/* The target is missed if more than (100 - percentile)% of I/O took longer than it. */
+	missed = ctx->misses * 100 > ctx->ios * (100 - SPDK_BDEV_QOS_LATENCY_PERCENTILE);
+
+	spdk_spin_lock(&bdev->internal.spinlock);
+	qos = bdev->internal.qos;
+	if (qos != NULL) {
+		qos->latency_collect_in_progress = false;
+		if (missed && qos->group != NULL) {
+			SPDK_DEBUGLOG(bdev, "bdev %s missed its latency target: %" PRIu64 " of %" PRIu64
+				      " I/O\n", bdev->name, ctx->misses, ctx->ios);
+			__atomic_store_n(&qos->group->latency_missed, true, __ATOMIC_RELAXED);
+		}
+	}
+	spdk_spin_unlock(&bdev->internal.spinlock);
+
+	free(ctx);
+}
+
+static void
+bdev_qos_latency_collect(struct spdk_bdev *bdev, struct spdk_bdev_qos *qos, uint64_t now)
+{
+	struct bdev_qos_latency_ctx *ctx;
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		return;
+	}
+
+	qos->latency_window_start = now;
+	qos->latency_collect_in_progress = true;
+	spdk_bdev_for_each_channel(bdev, bdev_qos_latency_collect_msg, ctx,
+				   bdev_qos_latency_collect_done);
+}
+
+static int
+bdev_channel_poll_qos(void *arg)
+{
+	struct spdk_bdev *bdev = arg;
+	struct spdk_bdev_qos *qos = bdev->internal.qos;
+	uint64_t now = spdk_get_ticks();
+
+	if (now < (qos->last_timeslice + qos->timeslice_size)) {
+		/* We received our callback earlier than expected - return
+		 *  immediately and wait to do accounting until at least one
+		 *  timeslice has actually expired.  This should never happen
+		 *  with a well-behaved timer implementation.
+		 */
+		return SPDK_POLLER_IDLE;
+	}
+
+	bdev_qos_limits_refill(qos->rate_limits, &qos->last_timeslice, qos->timeslice_size, now);
+
+	spdk_bdev_for_each_channel(bdev, bdev_channel_submit_qos_io, qos,
+				   bdev_channel_submit_qos_io_done);
+
+	if (qos->latency_target_ticks != 0 && !qos->latency_collect_in_progress &&
+	    now >= qos->latency_window_start +
+	    SPDK_BDEV_QOS_LATENCY_WINDOW_IN_USEC * spdk_get_ticks_hz() / SPDK_SEC_TO_USEC) {
+		bdev_qos_latency_collect(bdev, qos, now);
+	}
+
+	return SPDK_POLLER_BUSY;
+}
+
+static void
+bdev_channel_destroy_resource(struct spdk_bdev_channel *ch)
+{
+	struct spdk_bdev_shared_resource *shared_resource;
+	struct lba_range *range;
+
+	bdev_free_io_stat(ch->stat);
+#ifdef SPDK_CONFIG_VTUNE
+	bdev_free_io_stat(ch->prev_stat);
+#endif
+
+	if (ch->merge != NULL) {
+		assert(TAILQ_EMPTY(&ch->merge->ios));
+		spdk_poller_unregister(&ch->merge->poller);
+		free(ch->merge);
+		ch->merge = NULL;
+	}
+
+	while (!TAILQ_EMPTY(&ch->locked_ranges)) {
+		range = TAILQ_FIRST(&ch->locked_ranges);
+		TAILQ_REMOVE(&ch->locked_ranges, range, tailq);
+		free(range);
+	}
 
 	spdk_put_io_channel(ch->channel);
 	spdk_put_io_channel(ch->accel_channel);
@@ -3835,7 +4652,6 @@ static void
 bdev_enable_qos(struct spdk_bdev *bdev, struct spdk_bdev_channel *ch)
 {
 	struct spdk_bdev_qos	*qos = bdev->internal.qos;
-	int			i;
 
 	assert(spdk_spin_held(&bdev->internal.spinlock));
 
@@ -3856,29 +4672,19 @@ bdev_enable_qos(struct spdk_bdev *bdev, struct spdk_bdev_channel *ch)
 
 			qos->thread = spdk_io_channel_get_thread(io_ch);
 
-			for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
-				if (bdev_qos_is_iops_rate_limit(i) == true) {
-					qos->rate_limits[i].min_per_timeslice =
-						SPDK_BDEV_QOS_MIN_IO_PER_TIMESLICE;
-				} else {
-					qos->rate_limits[i].min_per_timeslice =
-						SPDK_BDEV_QOS_MIN_BYTE_PER_TIMESLICE;
-				}
-
-				if (qos->rate_limits[i].limit == 0) {
-					qos->rate_limits[i].limit = SPDK_BDEV_QOS_LIMIT_NOT_DEFINED;
-				}
-			}
+			bdev_qos_limits_init(qos->rate_limits);
 			bdev_qos_update_max_quota_per_timeslice(qos);
 			qos->timeslice_size =
 				SPDK_BDEV_QOS_TIMESLICE_IN_USEC * spdk_get_ticks_hz() / SPDK_SEC_TO_USEC;
 			qos->last_timeslice = spdk_get_ticks();
+			qos->latency_window_start = qos->last_timeslice;
 			qos->poller = SPDK_POLLER_REGISTER(bdev_channel_poll_qos,
 							   bdev,
 							   SPDK_BDEV_QOS_TIMESLICE_IN_USEC);
 		}
 
 		ch->flags |= BDEV_CH_QOS_ENABLED;
+		ch->latency_target_ticks = qos->latency_target_ticks;
 	}
 }
 
@@ -4023,6 +4829,7 @@ bdev_channel_create(void *io_device, void *ctx_buf)
 	struct spdk_bdev_mgmt_channel	*mgmt_ch;
 	struct spdk_bdev_shared_resource *shared_resource;
 	struct lba_range		*range;
+	struct spdk_bdev_merge_opts	merge_opts;
 
 	ch->bdev = bdev;
 	ch->channel = bdev->fn_table->get_io_channel(bdev->ctxt);
@@ -4045,6 +4852,13 @@ bdev_channel_create(void *io_device, void *ctx_buf)
 		if (ch->histogram == NULL) {
 			SPDK_ERRLOG("Could not allocate histogram\n");
 		}
+		if (bdev->internal.histogram_opts.breakdown) {
+			ch->histogram_breakdown = bdev_histogram_breakdown_alloc(
+							  &bdev->internal.histogram_opts);
+			if (ch->histogram_breakdown == NULL) {
+				SPDK_ERRLOG("Could not allocate histogram breakdown\n");
+			}
+		}
 	}
 
 	mgmt_io_ch = spdk_get_io_channel(&g_bdev_mgr);
@@ -4140,8 +4954,13 @@ bdev_channel_create(void *io_device, void *ctx_buf)
 		TAILQ_INSERT_TAIL(&ch->locked_ranges, new_range, tailq);
 	}
 
+	merge_opts = bdev->internal.merge_opts;
 	spdk_spin_unlock(&bdev->internal.spinlock);
 
+	if (bdev_channel_set_merge(ch, &merge_opts) != 0) {
+		SPDK_ERRLOG("Could not enable merging on channel %p of bdev %s\n", ch, bdev->name);
+	}
+
 	return 0;
 }
 
@@ -4486,16 +5305,44 @@ spdk_bdev_dump_io_stat_json(struct spdk_bdev_io_stat *stat, struct spdk_json_wri
 	}
 }
 
+/* Abort the reads and writes held back for merging */
+static void
+bdev_ch_merge_abort(struct spdk_bdev_channel *ch)
+{
+	struct bdev_channel_merge *merge = ch->merge;
+	bdev_io_tailq_t tmp_queued;
+
+	if (merge == NULL) {
+		return;
+	}
+
+	TAILQ_INIT(&tmp_queued);
+	TAILQ_SWAP(&merge->ios, &tmp_queued, spdk_bdev_io, internal.link);
+	merge->num_ios = 0;
+	merge->iovcnt = 0;
+	merge->num_blocks = 0;
+
+	bdev_abort_all_queued_io(&tmp_queued, ch);
+}
+
 static void
 bdev_channel_abort_queued_ios(struct spdk_bdev_channel *ch)
 {
 	struct spdk_bdev_shared_resource *shared_resource = ch->shared_resource;
 	struct spdk_bdev_mgmt_channel *mgmt_ch = shared_resource->mgmt_ch;
 
+	bdev_ch_merge_abort(ch);
 	bdev_abort_all_queued_io(&shared_resource->nomem_io, ch);
 	bdev_abort_all_buf_io(mgmt_ch, ch);
 }
 
+static void
+bdev_channel_io_pool_free(struct bdev_channel_io_pool *pool)
+{
+	spdk_free(pool->ios);
+	free(pool);
+}
+
 static void
 bdev_channel_destroy(void *io_device, void *ctx_buf)
 {
@@ -4519,6 +5366,12 @@ bdev_channel_destroy(void *io_device, void *ctx_buf)
 	if (ch->histogram) {
 		spdk_histogram_data_free(ch->histogram);
 	}
+	bdev_histogram_breakdown_free(ch->histogram_breakdown);
+
+	if (ch->io_pool != NULL) {
+		assert(ch->io_pool->num_free_ios == ch->io_pool->num_ios);
+		bdev_channel_io_pool_free(ch->io_pool);
+	}
 
 	bdev_channel_destroy_resource(ch);
 }
@@ -4694,6 +5547,12 @@ spdk_bdev_get_write_unit_size(const struct spdk_bdev *bdev)
 	return bdev->write_unit_size;
 }
 
+int32_t
+spdk_bdev_get_numa_id(const struct spdk_bdev *bdev)
+{
+	return bdev->numa.id_valid ? bdev->numa.id : SPDK_ENV_SOCKET_ID_ANY;
+}
+
 uint64_t
 spdk_bdev_get_num_blocks(const struct spdk_bdev *bdev)
 {
@@ -4706,27 +5565,46 @@ spdk_bdev_get_qos_rpc_type(enum spdk_bdev_qos_rate_limit_type type)
 	return qos_rpc_type[type];
 }
 
-void
-spdk_bdev_get_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits)
+static void
+bdev_qos_limits_get(const struct spdk_bdev_qos_limit *rate_limits, uint64_t *limits)
 {
 	int i;
 
+	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+		if (rate_limits[i].limit != SPDK_BDEV_QOS_LIMIT_NOT_DEFINED) {
+			limits[i] = rate_limits[i].limit;
+			if (bdev_qos_is_iops_rate_limit(i) == false) {
+				/* Change from Byte to Megabyte which is user visible. */
+				limits[i] = limits[i] / 1024 / 1024;
+			}
+		}
+	}
+}
+
+void
+spdk_bdev_get_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits)
+{
 	memset(limits, 0, sizeof(*limits) * SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES);
 
 	spdk_spin_lock(&bdev->internal.spinlock);
 	if (bdev->internal.qos) {
-		for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
-			if (bdev->internal.qos->rate_limits[i].limit !=
-			    SPDK_BDEV_QOS_LIMIT_NOT_DEFINED) {
-				limits[i] = bdev->internal.qos->rate_limits[i].limit;
-				if (bdev_qos_is_iops_rate_limit(i) == false) {
-					/* Change from Byte to Megabyte which is user visible. */
-					limits[i] = limits[i] / 1024 / 1024;
-				}
-			}
-		}
+		bdev_qos_limits_get(bdev->internal.qos->rate_limits, limits);
+	}
+	spdk_spin_unlock(&bdev->internal.spinlock);
+}
+
+const char *
+spdk_bdev_get_qos_group(struct spdk_bdev *bdev)
+{
+	const char *name = NULL;
+
+	spdk_spin_lock(&bdev->internal.spinlock);
+	if (bdev->internal.qos && bdev->internal.qos->group) {
+		name = bdev->internal.qos->group->name;
 	}
 	spdk_spin_unlock(&bdev->internal.spinlock);
+
+	return name;
 }
 
 size_t
@@ -5486,6 +6364,7 @@ bdev_write_blocks_with_md(struct spdk_bdev_desc *desc, struct spdk_io_channel *c
 	bdev_io->u.bdev.memory_domain = NULL;
 	bdev_io->u.bdev.memory_domain_ctx = NULL;
 	bdev_io->u.bdev.accel_sequence = NULL;
+	bdev_io->u.bdev.placement_hint = 0;
 	bdev_io_init(bdev_io, bdev, cb_arg, cb);
 
 	bdev_io_submit(bdev_io);
@@ -5542,7 +6421,7 @@ bdev_writev_blocks_with_md(struct spdk_bdev_desc *desc, struct spdk_io_channel *
 			   struct iovec *iov, int iovcnt, void *md_buf,
 			   uint64_t offset_blocks, uint64_t num_blocks,
 			   struct spdk_memory_domain *domain, void *domain_ctx,
-			   struct spdk_accel_sequence *seq,
+			   struct spdk_accel_sequence *seq, uint16_t placement_hint,
 			   spdk_bdev_io_completion_cb cb, void *cb_arg)
 {
 	struct spdk_bdev *bdev = spdk_bdev_desc_get_bdev(desc);
@@ -5578,6 +6457,7 @@ bdev_writev_blocks_with_md(struct spdk_bdev_desc *desc, struct spdk_io_channel *
 	bdev_io->u.bdev.memory_domain = domain;
 	bdev_io->u.bdev.memory_domain_ctx = domain_ctx;
 	bdev_io->u.bdev.accel_sequence = seq;
+	bdev_io->u.bdev.placement_hint = placement_hint;
 
 	_bdev_io_submit_ext(desc, bdev_io);
 
@@ -5607,7 +6487,7 @@ spdk_bdev_writev_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
 			spdk_bdev_io_completion_cb cb, void *cb_arg)
 {
 	return bdev_writev_blocks_with_md(desc, ch, iov, iovcnt, NULL, offset_blocks,
-					  num_blocks, NULL, NULL, NULL, cb, cb_arg);
+					  num_blocks, NULL, NULL, NULL, 0, cb, cb_arg);
 }
 
 int
@@ -5625,7 +6505,57 @@ spdk_bdev_writev_blocks_with_md(struct spdk_bdev_desc *desc, struct spdk_io_chan
 	}
 
 	return bdev_writev_blocks_with_md(desc, ch, iov, iovcnt, md_buf, offset_blocks,
-					  num_blocks, NULL, NULL, NULL, cb, cb_arg);
+					  num_blocks, NULL, NULL, NULL, 0, cb, cb_arg);
+}
+
+int
+spdk_bdev_submit_batch(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		       struct spdk_bdev_batch_io *ios, uint32_t num_ios)
+{
+	struct spdk_bdev *bdev = spdk_bdev_desc_get_bdev(desc);
+	struct spdk_bdev_channel *channel = __io_ch_to_bdev_ch(ch);
+	struct spdk_bdev_io *batch_ios[BDEV_CH_BATCH_MAX_IOS];
+	struct spdk_bdev_batch_io *io;
+	bool batching = false;
+	uint32_t i;
+	int rc = 0;
+
+	/* Nested batches are simply merged into the outer one */
+	if (bdev->fn_table->submit_request_batch != NULL && channel->batch_ios == NULL) {
+		channel->batch_ios = batch_ios;
+		batching = true;
+	}
+
+	for (i = 0; i < num_ios; i++) {
+		io = &ios[i];
+
+		switch (io->type) {
+		case SPDK_BDEV_IO_TYPE_READ:
+			rc = spdk_bdev_readv_blocks_with_md(desc, ch, io->iovs, io->iovcnt, io->md_buf,
+							    io->offset_blocks, io->num_blocks,
+							    io->cb, io->cb_arg);
+			break;
+		case SPDK_BDEV_IO_TYPE_WRITE:
+			rc = spdk_bdev_writev_blocks_with_md(desc, ch, io->iovs, io->iovcnt, io->md_buf,
+							     io->offset_blocks, io->num_blocks,
+							     io->cb, io->cb_arg);
+			break;
+		default:
+			rc = -EINVAL;
+			break;
+		}
+
+		if (spdk_unlikely(rc != 0)) {
+			break;
+		}
+	}
+
+	if (batching) {
+		bdev_ch_submit_batch(channel);
+		channel->batch_ios = NULL;
+	}
+
+	return i > 0 ? (int)i : rc;
 }
 
 int
@@ -5658,6 +6588,7 @@ spdk_bdev_writev_blocks_ext(struct spdk_bdev_desc *desc, struct spdk_io_channel
 					  bdev_get_ext_io_opt(opts, memory_domain, NULL),
 					  bdev_get_ext_io_opt(opts, memory_domain_ctx, NULL),
 					  bdev_get_ext_io_opt(opts, accel_sequence, NULL),
+					  bdev_get_ext_io_opt(opts, placement_hint, 0),
 					  cb, cb_arg);
 }
 
@@ -6392,6 +7323,7 @@ bdev_reset_freeze_channel(struct spdk_bdev_channel_iter *i, struct spdk_bdev *bd
 		TAILQ_SWAP(&channel->qos_queued_io, &tmp_queued, spdk_bdev_io, internal.link);
 	}
 
+	bdev_ch_merge_abort(channel);
 	bdev_abort_all_queued_io(&shared_resource->nomem_io, channel);
 	bdev_abort_all_buf_io(mgmt_channel, channel);
 	bdev_abort_all_queued_io(&tmp_queued, channel);
@@ -7169,9 +8101,25 @@ bdev_io_complete(void *ctx)
 
 	TAILQ_REMOVE(&bdev_ch->io_submitted, bdev_io, internal.ch_link);
 
+	if (spdk_unlikely(bdev_io->internal.cb == bdev_ch_merge_done)) {
+		/* Accounted for through the original I/O, see bdev_ch_merge_done() */
+		_bdev_io_complete(bdev_io);
+		return;
+	}
+
 	if (bdev_io->internal.ch->histogram) {
 		spdk_histogram_data_tally(bdev_io->internal.ch->histogram, tsc_diff);
 	}
+	if (spdk_unlikely(bdev_ch->histogram_breakdown != NULL)) {
+		bdev_histogram_breakdown_tally(bdev_ch->histogram_breakdown, bdev_io, tsc_diff);
+	}
+
+	if (spdk_unlikely(bdev_ch->latency_target_ticks != 0) && bdev_qos_io_to_limit(bdev_io)) {
+		bdev_ch->latency_ios++;
+		if (tsc_diff > bdev_ch->latency_target_ticks) {
+			bdev_ch->latency_misses++;
+		}
+	}
 
 	bdev_io_update_io_stat(bdev_io, tsc_diff);
 	_bdev_io_complete(bdev_io);
@@ -7571,6 +8519,7 @@ bdev_register(struct spdk_bdev *bdev)
 	memset(&bdev->internal.claim, 0, sizeof(bdev->internal.claim));
 	bdev->internal.qd_poller = NULL;
 	bdev->internal.qos = NULL;
+	spdk_bdev_merge_opts_init(&bdev->internal.merge_opts, sizeof(bdev->internal.merge_opts));
 
 	TAILQ_INIT(&bdev->internal.open_descs);
 	TAILQ_INIT(&bdev->internal.locked_ranges);
@@ -7670,6 +8619,9 @@ bdev_destroy_cb(void *io_device)
 	cb_arg = bdev->internal.unregister_ctx;
 
 	spdk_spin_destroy(&bdev->internal.spinlock);
+	if (bdev->internal.qos != NULL && bdev->internal.qos->group != NULL) {
+		bdev_qos_group_put(bdev->internal.qos->group);
+	}
 	free(bdev->internal.qos);
 	bdev_free_io_stat(bdev->internal.stat);
 
@@ -9057,6 +10009,10 @@ bdev_disable_qos_done(void *cb_arg)
 		spdk_poller_unregister(&qos->poller);
 	}
 
+	if (qos->group != NULL) {
+		bdev_qos_group_put(qos->group);
+	}
+
 	free(qos);
 
 	bdev_set_qos_limit_done(ctx, 0);
@@ -9087,6 +10043,9 @@ bdev_disable_qos_msg(struct spdk_bdev_channel_iter *i, struct spdk_bdev *bdev,
 	struct spdk_bdev_io *bdev_io;
 
 	bdev_ch->flags &= ~BDEV_CH_QOS_ENABLED;
+	bdev_ch->latency_target_ticks = 0;
+	bdev_ch->latency_ios = 0;
+	bdev_ch->latency_misses = 0;
 
 	while (!TAILQ_EMPTY(&bdev_ch->qos_queued_io)) {
 		/* Re-submit the queued I/O. */
@@ -9132,29 +10091,52 @@ bdev_enable_qos_done(struct spdk_bdev *bdev, void *_ctx, int status)
 }
 
 static void
-bdev_set_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits)
+bdev_qos_limits_set(struct spdk_bdev_qos_limit *rate_limits, uint64_t *limits)
 {
 	int i;
 
-	assert(bdev->internal.qos != NULL);
-
 	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
 		if (limits[i] != SPDK_BDEV_QOS_LIMIT_NOT_DEFINED) {
-			bdev->internal.qos->rate_limits[i].limit = limits[i];
+			rate_limits[i].limit = limits[i];
 
 			if (limits[i] == 0) {
-				bdev->internal.qos->rate_limits[i].limit =
-					SPDK_BDEV_QOS_LIMIT_NOT_DEFINED;
+				rate_limits[i].limit = SPDK_BDEV_QOS_LIMIT_NOT_DEFINED;
 			}
 		}
 	}
 }
 
-void
-spdk_bdev_set_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits,
-			      void (*cb_fn)(void *cb_arg, int status), void *cb_arg)
+static void
+bdev_set_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits)
+{
+	assert(bdev->internal.qos != NULL);
+
+	bdev_qos_limits_set(bdev->internal.qos->rate_limits, limits);
+}
+
+static bool
+bdev_qos_has_rate_limits(struct spdk_bdev_qos *qos)
+{
+	int i;
+
+	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+		if (qos->rate_limits[i].limit > 0 &&
+		    qos->rate_limits[i].limit != SPDK_BDEV_QOS_LIMIT_NOT_DEFINED) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * Convert user visible limits (IOPS and megabytes per second) to the internal
+ * representation and round them up to the supported granularity.
+ * Returns true if none of the defined limits is non-zero.
+ */
+static bool
+bdev_qos_convert_limits(uint64_t *limits)
 {
-	struct set_qos_limit_ctx	*ctx;
 	uint32_t			limit_set_complement;
 	uint64_t			min_limit_per_sec;
 	int				i;
@@ -9191,6 +10173,19 @@ spdk_bdev_set_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits,
 		}
 	}
 
+	return disable_rate_limit;
+}
+
+void
+spdk_bdev_set_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits,
+			      void (*cb_fn)(void *cb_arg, int status), void *cb_arg)
+{
+	struct set_qos_limit_ctx	*ctx;
+	int				i;
+	bool				disable_rate_limit;
+
+	disable_rate_limit = bdev_qos_convert_limits(limits);
+
 	ctx = calloc(1, sizeof(*ctx));
 	if (ctx == NULL) {
 		cb_fn(cb_arg, -ENOMEM);
@@ -9211,6 +10206,12 @@ spdk_bdev_set_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits,
 	bdev->internal.qos_mod_in_progress = true;
 
 	if (disable_rate_limit == true && bdev->internal.qos) {
+		/* QoS must stay enabled as long as the bdev belongs to a QoS group
+		 * or has a latency target */
+		if (bdev->internal.qos->group != NULL || bdev->internal.qos->latency_target_us != 0) {
+			disable_rate_limit = false;
+		}
+
 		for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
 			if (limits[i] == SPDK_BDEV_QOS_LIMIT_NOT_DEFINED &&
 			    (bdev->internal.qos->rate_limits[i].limit > 0 &&
@@ -9263,44 +10264,691 @@ spdk_bdev_set_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits,
 	spdk_spin_unlock(&bdev->internal.spinlock);
 }
 
-struct spdk_bdev_histogram_ctx {
-	spdk_bdev_histogram_status_cb cb_fn;
-	void *cb_arg;
-	struct spdk_bdev *bdev;
-	int status;
-};
-
-static void
-bdev_histogram_disable_channel_cb(struct spdk_bdev *bdev, void *_ctx, int status)
+static struct spdk_bdev_qos_group *
+bdev_qos_group_find(const char *name)
 {
-	struct spdk_bdev_histogram_ctx *ctx = _ctx;
-
-	spdk_spin_lock(&ctx->bdev->internal.spinlock);
-	ctx->bdev->internal.histogram_in_progress = false;
-	spdk_spin_unlock(&ctx->bdev->internal.spinlock);
-	ctx->cb_fn(ctx->cb_arg, ctx->status);
-	free(ctx);
-}
+	struct spdk_bdev_qos_group *group;
 
-static void
-bdev_histogram_disable_channel(struct spdk_bdev_channel_iter *i, struct spdk_bdev *bdev,
-			       struct spdk_io_channel *_ch, void *_ctx)
-{
-	struct spdk_bdev_channel *ch = __io_ch_to_bdev_ch(_ch);
+	assert(spdk_spin_held(&g_bdev_mgr.spinlock));
 
-	if (ch->histogram != NULL) {
-		spdk_histogram_data_free(ch->histogram);
-		ch->histogram = NULL;
+	TAILQ_FOREACH(group, &g_bdev_mgr.qos_groups, link) {
+		if (strcmp(group->name, name) == 0) {
+			return group;
+		}
 	}
-	spdk_bdev_for_each_channel_continue(i, 0);
+
+	return NULL;
 }
 
-static void
-bdev_histogram_enable_channel_cb(struct spdk_bdev *bdev, void *_ctx, int status)
+static uint64_t
+bdev_qos_adjust_be_limit(uint64_t limit, uint64_t rate, uint64_t min_limit, bool missed)
 {
-	struct spdk_bdev_histogram_ctx *ctx = _ctx;
+	if (missed) {
+		if (rate == 0) {
+			/* Best-effort bdevs are idle, so they aren't the cause */
+			return limit;
+		}
 
-	if (status != 0) {
+		/* Back off multiplicatively from whatever is currently consumed */
+		if (limit == SPDK_BDEV_QOS_LIMIT_NOT_DEFINED || rate < limit) {
+			limit = rate;
+		}
+
+		return spdk_max(limit / 4 * 3, min_limit);
+	}
+
+	if (limit == SPDK_BDEV_QOS_LIMIT_NOT_DEFINED) {
+		return limit;
+	}
+
+	/* The limit isn't holding the best-effort bdevs back anymore, so drop it */
+	if (rate < limit / 2) {
+		return SPDK_BDEV_QOS_LIMIT_NOT_DEFINED;
+	}
+
+	return limit + limit / 8;
+}
+
+/*
+ * Called once every latency window. If any member with a latency target missed
+ * it, reduce the throughput allowed to the best-effort members. Otherwise give
+ * them back some headroom until the limit is no longer needed.
+ */
+static void
+bdev_qos_group_adjust_be_limits(struct spdk_bdev_qos_group *group)
+{
+	struct spdk_bdev_qos_limit *iops = &group->be_limits[SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT];
+	struct spdk_bdev_qos_limit *bps = &group->be_limits[SPDK_BDEV_QOS_RW_BPS_RATE_LIMIT];
+	uint64_t ios, bytes;
+	bool missed;
+
+	missed = __atomic_exchange_n(&group->latency_missed, false, __ATOMIC_RELAXED);
+	ios = __atomic_exchange_n(&group->be_ios, 0, __ATOMIC_RELAXED);
+	bytes = __atomic_exchange_n(&group->be_bytes, 0, __ATOMIC_RELAXED);
+
+	if (!missed && iops->limit == SPDK_BDEV_QOS_LIMIT_NOT_DEFINED &&
+	    bps->limit == SPDK_BDEV_QOS_LIMIT_NOT_DEFINED) {
+		return;
+	}
+
+	ios = ios * SPDK_SEC_TO_USEC / SPDK_BDEV_QOS_LATENCY_WINDOW_IN_USEC;
+	bytes = bytes * SPDK_SEC_TO_USEC / SPDK_BDEV_QOS_LATENCY_WINDOW_IN_USEC;
+
+	iops->limit = bdev_qos_adjust_be_limit(iops->limit, ios, SPDK_BDEV_QOS_MIN_IOS_PER_SEC, missed);
+	bps->limit = bdev_qos_adjust_be_limit(bps->limit, bytes, SPDK_BDEV_QOS_MIN_BYTES_PER_SEC, missed);
+
+	SPDK_DEBUGLOG(bdev, "QoS group %s best-effort limits: %" PRIu64 " IO/s, %" PRIu64 " B/s\n",
+		      group->name, iops->limit, bps->limit);
+
+	bdev_qos_limits_update_max_quota_per_timeslice(group->be_limits);
+}
+
+static int
+bdev_qos_group_poll(void *arg)
+{
+	struct spdk_bdev_qos_group *group = arg;
+	uint64_t now = spdk_get_ticks();
+	uint64_t last_timeslice;
+
+	if (now < (group->last_timeslice + group->timeslice_size)) {
+		return SPDK_POLLER_IDLE;
+	}
+
+	/* Both sets of limits share the timeslices, so refill the best-effort ones
+	 * before last_timeslice is advanced. */
+	last_timeslice = group->last_timeslice;
+	bdev_qos_limits_refill(group->be_limits, &last_timeslice, group->timeslice_size, now);
+	/* The member bdevs pick up the new quota from their own QoS pollers. */
+	bdev_qos_limits_refill(group->rate_limits, &group->last_timeslice, group->timeslice_size, now);
+
+	if (now >= group->latency_window_start +
+	    SPDK_BDEV_QOS_LATENCY_WINDOW_IN_USEC * spdk_get_ticks_hz() / SPDK_SEC_TO_USEC) {
+		group->latency_window_start = now;
+		bdev_qos_group_adjust_be_limits(group);
+	}
+
+	return SPDK_POLLER_BUSY;
+}
+
+static void
+bdev_qos_group_free(void *ctx)
+{
+	struct spdk_bdev_qos_group *group = ctx;
+
+	spdk_poller_unregister(&group->poller);
+	free(group->name);
+	free(group);
+}
+
+static void
+bdev_qos_group_release(struct spdk_bdev_qos_group *group)
+{
+	if (group->thread != spdk_get_thread()) {
+		spdk_thread_send_msg(group->thread, bdev_qos_group_free, group);
+	} else {
+		bdev_qos_group_free(group);
+	}
+}
+
+static void
+bdev_qos_group_put(struct spdk_bdev_qos_group *group)
+{
+	spdk_spin_lock(&g_bdev_mgr.spinlock);
+	assert(group->num_bdevs > 0);
+	group->num_bdevs--;
+	spdk_spin_unlock(&g_bdev_mgr.spinlock);
+}
+
+static void
+bdev_qos_groups_free(void)
+{
+	struct spdk_bdev_qos_group *group;
+
+	while (!TAILQ_EMPTY(&g_bdev_mgr.qos_groups)) {
+		group = TAILQ_FIRST(&g_bdev_mgr.qos_groups);
+		TAILQ_REMOVE(&g_bdev_mgr.qos_groups, group, link);
+		assert(group->num_bdevs == 0);
+		bdev_qos_group_release(group);
+	}
+}
+
+int
+spdk_bdev_qos_group_create(const char *name, uint64_t *limits)
+{
+	struct spdk_bdev_qos_group *group;
+	int i;
+
+	if (name == NULL || spdk_get_thread() == NULL) {
+		return -EINVAL;
+	}
+
+	group = calloc(1, sizeof(*group));
+	if (group == NULL) {
+		return -ENOMEM;
+	}
+
+	group->name = strdup(name);
+	if (group->name == NULL) {
+		free(group);
+		return -ENOMEM;
+	}
+
+	bdev_qos_convert_limits(limits);
+	bdev_qos_limits_set(group->rate_limits, limits);
+	bdev_qos_limits_init(group->rate_limits);
+	bdev_qos_limits_update_max_quota_per_timeslice(group->rate_limits);
+	/* Undefined limits have no quota per timeslice, which disables them. This lets
+	 * the ops be set once, as the limits are read from many threads. */
+	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+		bdev_qos_limit_set_ops(&group->rate_limits[i], i);
+		bdev_qos_limit_set_ops(&group->be_limits[i], i);
+	}
+	bdev_qos_limits_init(group->be_limits);
+	bdev_qos_limits_update_max_quota_per_timeslice(group->be_limits);
+
+	group->thread = spdk_get_thread();
+	group->timeslice_size = SPDK_BDEV_QOS_TIMESLICE_IN_USEC * spdk_get_ticks_hz() / SPDK_SEC_TO_USEC;
+	group->last_timeslice = spdk_get_ticks();
+	group->latency_window_start = group->last_timeslice;
+
+	spdk_spin_lock(&g_bdev_mgr.spinlock);
+	if (bdev_qos_group_find(name) != NULL) {
+		spdk_spin_unlock(&g_bdev_mgr.spinlock);
+		SPDK_ERRLOG("QoS group %s already exists\n", name);
+		free(group->name);
+		free(group);
+		return -EEXIST;
+	}
+	TAILQ_INSERT_TAIL(&g_bdev_mgr.qos_groups, group, link);
+	spdk_spin_unlock(&g_bdev_mgr.spinlock);
+
+	group->poller = SPDK_POLLER_REGISTER(bdev_qos_group_poll, group,
+					     SPDK_BDEV_QOS_TIMESLICE_IN_USEC);
+
+	return 0;
+}
+
+int
+spdk_bdev_qos_group_delete(const char *name)
+{
+	struct spdk_bdev_qos_group *group;
+
+	spdk_spin_lock(&g_bdev_mgr.spinlock);
+	group = bdev_qos_group_find(name);
+	if (group == NULL) {
+		spdk_spin_unlock(&g_bdev_mgr.spinlock);
+		return -ENOENT;
+	}
+
+	if (group->num_bdevs > 0) {
+		spdk_spin_unlock(&g_bdev_mgr.spinlock);
+		SPDK_ERRLOG("QoS group %s still has %" PRIu32 " bdev(s)\n", name, group->num_bdevs);
+		return -EBUSY;
+	}
+
+	TAILQ_REMOVE(&g_bdev_mgr.qos_groups, group, link);
+	spdk_spin_unlock(&g_bdev_mgr.spinlock);
+
+	bdev_qos_group_release(group);
+
+	return 0;
+}
+
+int
+spdk_bdev_qos_group_set_rate_limits(const char *name, uint64_t *limits)
+{
+	struct spdk_bdev_qos_group *group;
+
+	bdev_qos_convert_limits(limits);
+
+	spdk_spin_lock(&g_bdev_mgr.spinlock);
+	group = bdev_qos_group_find(name);
+	if (group == NULL) {
+		spdk_spin_unlock(&g_bdev_mgr.spinlock);
+		return -ENOENT;
+	}
+
+	bdev_qos_limits_set(group->rate_limits, limits);
+	bdev_qos_limits_update_max_quota_per_timeslice(group->rate_limits);
+	spdk_spin_unlock(&g_bdev_mgr.spinlock);
+
+	return 0;
+}
+
+int
+spdk_bdev_qos_group_get_rate_limits(const char *name, uint64_t *limits)
+{
+	struct spdk_bdev_qos_group *group;
+
+	memset(limits, 0, sizeof(*limits) * SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES);
+
+	spdk_spin_lock(&g_bdev_mgr.spinlock);
+	group = bdev_qos_group_find(name);
+	if (group == NULL) {
+		spdk_spin_unlock(&g_bdev_mgr.spinlock);
+		return -ENOENT;
+	}
+
+	bdev_qos_limits_get(group->rate_limits, limits);
+	spdk_spin_unlock(&g_bdev_mgr.spinlock);
+
+	return 0;
+}
+
+static void
+bdev_set_qos_group_msg(void *cb_arg)
+{
+	struct set_qos_limit_ctx *ctx = cb_arg;
+	struct spdk_bdev *bdev = ctx->bdev;
+	struct spdk_bdev_qos_group *old_group;
+
+	spdk_spin_lock(&bdev->internal.spinlock);
+	old_group = bdev->internal.qos->group;
+	bdev->internal.qos->group = ctx->group;
+	spdk_spin_unlock(&bdev->internal.spinlock);
+
+	if (old_group != NULL) {
+		bdev_qos_group_put(old_group);
+	}
+
+	bdev_set_qos_limit_done(ctx, 0);
+}
+
+void
+spdk_bdev_set_qos_group(struct spdk_bdev *bdev, const char *group_name,
+			void (*cb_fn)(void *cb_arg, int status), void *cb_arg)
+{
+	struct set_qos_limit_ctx	*ctx;
+	struct spdk_bdev_qos_group	*group = NULL;
+	struct spdk_bdev_qos		*qos, *new_qos = NULL;
+	int				rc;
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		cb_fn(cb_arg, -ENOMEM);
+		return;
+	}
+
+	ctx->cb_fn = cb_fn;
+	ctx->cb_arg = cb_arg;
+	ctx->bdev = bdev;
+
+	if (group_name != NULL) {
+		new_qos = calloc(1, sizeof(*new_qos));
+		if (new_qos == NULL) {
+			free(ctx);
+			cb_fn(cb_arg, -ENOMEM);
+			return;
+		}
+	}
+
+	spdk_spin_lock(&g_bdev_mgr.spinlock);
+	if (group_name != NULL) {
+		group = bdev_qos_group_find(group_name);
+		if (group == NULL) {
+			rc = -ENOENT;
+			goto err;
+		}
+	}
+
+	spdk_spin_lock(&bdev->internal.spinlock);
+	if (bdev->internal.qos_mod_in_progress) {
+		spdk_spin_unlock(&bdev->internal.spinlock);
+		rc = -EAGAIN;
+		goto err;
+	}
+
+	qos = bdev->internal.qos;
+	if (group == NULL && (qos == NULL || qos->group == NULL)) {
+		/* Not a member of any group, nothing to do */
+		spdk_spin_unlock(&bdev->internal.spinlock);
+		rc = 0;
+		goto err;
+	}
+
+	if (group != NULL && qos != NULL && qos->group != NULL) {
+		spdk_spin_unlock(&bdev->internal.spinlock);
+		rc = qos->group == group ? 0 : -EBUSY;
+		goto err;
+	}
+
+	bdev->internal.qos_mod_in_progress = true;
+	if (group != NULL) {
+		group->num_bdevs++;
+	}
+	spdk_spin_unlock(&g_bdev_mgr.spinlock);
+
+	if (group != NULL) {
+		if (qos == NULL) {
+			qos = new_qos;
+			new_qos = NULL;
+			bdev->internal.qos = qos;
+		}
+
+		if (qos->thread == NULL) {
+			/* Enabling */
+			qos->group = group;
+			spdk_bdev_for_each_channel(bdev, bdev_enable_qos_msg, ctx,
+						   bdev_enable_qos_done);
+		} else {
+			/* Updating */
+			ctx->group = group;
+			spdk_thread_send_msg(qos->thread, bdev_set_qos_group_msg, ctx);
+		}
+	} else if (!bdev_qos_has_rate_limits(qos) && qos->latency_target_us == 0) {
+		/* The group was the only reason for QoS to be enabled, so disable it */
+		spdk_bdev_for_each_channel(bdev, bdev_disable_qos_msg, ctx,
+					   bdev_disable_qos_msg_done);
+	} else if (qos->thread != NULL) {
+		spdk_thread_send_msg(qos->thread, bdev_set_qos_group_msg, ctx);
+	} else {
+		group = qos->group;
+		qos->group = NULL;
+		spdk_spin_unlock(&bdev->internal.spinlock);
+
+		bdev_qos_group_put(group);
+		bdev_set_qos_limit_done(ctx, 0);
+		return;
+	}
+
+	spdk_spin_unlock(&bdev->internal.spinlock);
+	free(new_qos);
+	return;
+
+err:
+	spdk_spin_unlock(&g_bdev_mgr.spinlock);
+	free(new_qos);
+	free(ctx);
+	cb_fn(cb_arg, rc);
+}
+
+void
+spdk_bdev_set_qos_latency_target(struct spdk_bdev *bdev, uint64_t latency_target_us,
+				 void (*cb_fn)(void *cb_arg, int status), void *cb_arg)
+{
+	struct set_qos_limit_ctx	*ctx;
+	struct spdk_bdev_qos		*qos;
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		cb_fn(cb_arg, -ENOMEM);
+		return;
+	}
+
+	ctx->cb_fn = cb_fn;
+	ctx->cb_arg = cb_arg;
+	ctx->bdev = bdev;
+
+	spdk_spin_lock(&bdev->internal.spinlock);
+	if (bdev->internal.qos_mod_in_progress) {
+		spdk_spin_unlock(&bdev->internal.spinlock);
+		free(ctx);
+		cb_fn(cb_arg, -EAGAIN);
+		return;
+	}
+
+	qos = bdev->internal.qos;
+	if (latency_target_us == 0 && (qos == NULL || qos->latency_target_us == 0)) {
+		spdk_spin_unlock(&bdev->internal.spinlock);
+		free(ctx);
+		cb_fn(cb_arg, 0);
+		return;
+	}
+
+	if (qos == NULL) {
+		qos = calloc(1, sizeof(*qos));
+		if (qos == NULL) {
+			spdk_spin_unlock(&bdev->internal.spinlock);
+			SPDK_ERRLOG("Unable to allocate memory for QoS tracking\n");
+			free(ctx);
+			cb_fn(cb_arg, -ENOMEM);
+			return;
+		}
+		bdev->internal.qos = qos;
+	}
+
+	bdev->internal.qos_mod_in_progress = true;
+	qos->latency_target_us = latency_target_us;
+	qos->latency_target_ticks = latency_target_us * spdk_get_ticks_hz() / SPDK_SEC_TO_USEC;
+
+	if (latency_target_us == 0 && qos->group == NULL && !bdev_qos_has_rate_limits(qos)) {
+		/* The latency target was the only reason for QoS to be enabled */
+		spdk_bdev_for_each_channel(bdev, bdev_disable_qos_msg, ctx,
+					   bdev_disable_qos_msg_done);
+	} else {
+		/* Enable QoS if needed and pass the new target to all channels */
+		spdk_bdev_for_each_channel(bdev, bdev_enable_qos_msg, ctx,
+					   bdev_enable_qos_done);
+	}
+
+	spdk_spin_unlock(&bdev->internal.spinlock);
+}
+
+uint64_t
+spdk_bdev_get_qos_latency_target(struct spdk_bdev *bdev)
+{
+	uint64_t latency_target_us = 0;
+
+	spdk_spin_lock(&bdev->internal.spinlock);
+	if (bdev->internal.qos != NULL) {
+		latency_target_us = bdev->internal.qos->latency_target_us;
+	}
+	spdk_spin_unlock(&bdev->internal.spinlock);
+
+	return latency_target_us;
+}
+
+void
+spdk_bdev_merge_opts_init(struct spdk_bdev_merge_opts *opts, size_t size)
+{
+	assert(opts);
+	assert(size);
+
+	memset(opts, 0, size);
+	opts->size = size;
+
+	if (offsetof(struct spdk_bdev_merge_opts, max_ios) + sizeof(opts->max_ios) <= size) {
+		opts->max_ios = BDEV_CH_MERGE_MAX_IOS;
+	}
+}
+
+static void
+bdev_merge_opts_copy(struct spdk_bdev_merge_opts *opts,
+		     const struct spdk_bdev_merge_opts *opts_src, size_t size)
+{
+#define SET_FIELD(field) \
+	if (offsetof(struct spdk_bdev_merge_opts, field) + sizeof(opts->field) <= size) { \
+		opts->field = opts_src->field; \
+	} \
+
+	SET_FIELD(window_us);
+	SET_FIELD(max_ios);
+	SET_FIELD(max_blocks);
+
+	/* Do not remove this statement, you should always update this statement when you adding a new field,
+	 * and do not forget to add the SET_FIELD statement for your added field. */
+	SPDK_STATIC_ASSERT(sizeof(struct spdk_bdev_merge_opts) == 24, "Incorrect size");
+
+#undef SET_FIELD
+}
+
+struct set_merge_opts_ctx {
+	void (*cb_fn)(void *cb_arg, int status);
+	void *cb_arg;
+};
+
+static void
+bdev_set_merge_opts_channel(struct spdk_bdev_channel_iter *i, struct spdk_bdev *bdev,
+			    struct spdk_io_channel *_ch, void *_ctx)
+{
+	struct spdk_bdev_channel *ch = __io_ch_to_bdev_ch(_ch);
+	struct spdk_bdev_merge_opts opts;
+
+	/* Always apply the latest options, in case they were changed again meanwhile */
+	spdk_spin_lock(&bdev->internal.spinlock);
+	opts = bdev->internal.merge_opts;
+	spdk_spin_unlock(&bdev->internal.spinlock);
+
+	spdk_bdev_for_each_channel_continue(i, bdev_channel_set_merge(ch, &opts));
+}
+
+static void
+bdev_set_merge_opts_done(struct spdk_bdev *bdev, void *_ctx, int status)
+{
+	struct set_merge_opts_ctx *ctx = _ctx;
+
+	ctx->cb_fn(ctx->cb_arg, status);
+	free(ctx);
+}
+
+void
+spdk_bdev_set_merge_opts(struct spdk_bdev *bdev, const struct spdk_bdev_merge_opts *_opts,
+			 void (*cb_fn)(void *cb_arg, int status), void *cb_arg)
+{
+	struct spdk_bdev_merge_opts opts;
+	struct set_merge_opts_ctx *ctx;
+
+	spdk_bdev_merge_opts_init(&opts, sizeof(opts));
+	bdev_merge_opts_copy(&opts, _opts, _opts->size);
+
+	if (opts.window_us != 0 && (opts.max_ios < 2 || opts.max_ios > BDEV_CH_MERGE_MAX_IOS)) {
+		SPDK_ERRLOG("Number of merged I/O must be between 2 and %u\n", BDEV_CH_MERGE_MAX_IOS);
+		cb_fn(cb_arg, -EINVAL);
+		return;
+	}
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		cb_fn(cb_arg, -ENOMEM);
+		return;
+	}
+
+	ctx->cb_fn = cb_fn;
+	ctx->cb_arg = cb_arg;
+
+	spdk_spin_lock(&bdev->internal.spinlock);
+	bdev->internal.merge_opts = opts;
+	spdk_spin_unlock(&bdev->internal.spinlock);
+
+	spdk_bdev_for_each_channel(bdev, bdev_set_merge_opts_channel, ctx, bdev_set_merge_opts_done);
+}
+
+void
+spdk_bdev_get_merge_opts(struct spdk_bdev *bdev, struct spdk_bdev_merge_opts *opts, size_t size)
+{
+	struct spdk_bdev_merge_opts merge_opts;
+
+	spdk_spin_lock(&bdev->internal.spinlock);
+	merge_opts = bdev->internal.merge_opts;
+	spdk_spin_unlock(&bdev->internal.spinlock);
+
+	spdk_bdev_merge_opts_init(opts, size);
+	bdev_merge_opts_copy(opts, &merge_opts, size);
+}
+
+static void
+bdev_qos_group_bdevs_json(struct spdk_bdev_qos_group *group, struct spdk_json_write_ctx *w)
+{
+	struct spdk_bdev *bdev;
+
+	spdk_json_write_named_array_begin(w, "bdevs");
+	TAILQ_FOREACH(bdev, &g_bdev_mgr.bdevs, internal.link) {
+		spdk_spin_lock(&bdev->internal.spinlock);
+		if (bdev->internal.qos != NULL && bdev->internal.qos->group == group) {
+			spdk_json_write_string(w, bdev->name);
+		}
+		spdk_spin_unlock(&bdev->internal.spinlock);
+	}
+	spdk_json_write_array_end(w);
+}
+
+int
+bdev_qos_groups_info_json(const char *name, struct spdk_json_write_ctx *w)
+{
+	struct spdk_bdev_qos_group *group;
+	uint64_t limits[SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES];
+	int i;
+
+	spdk_spin_lock(&g_bdev_mgr.spinlock);
+	if (name != NULL && bdev_qos_group_find(name) == NULL) {
+		spdk_spin_unlock(&g_bdev_mgr.spinlock);
+		return -ENOENT;
+	}
+
+	spdk_json_write_array_begin(w);
+	TAILQ_FOREACH(group, &g_bdev_mgr.qos_groups, link) {
+		if (name != NULL && strcmp(group->name, name) != 0) {
+			continue;
+		}
+
+		memset(limits, 0, sizeof(limits));
+		bdev_qos_limits_get(group->rate_limits, limits);
+
+		spdk_json_write_object_begin(w);
+		spdk_json_write_named_string(w, "name", group->name);
+		spdk_json_write_named_object_begin(w, "rate_limits");
+		for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+			spdk_json_write_named_uint64(w, qos_rpc_type[i], limits[i]);
+		}
+		spdk_json_write_object_end(w);
+
+		memset(limits, 0, sizeof(limits));
+		bdev_qos_limits_get(group->be_limits, limits);
+		spdk_json_write_named_object_begin(w, "best_effort_limits");
+		spdk_json_write_named_uint64(w, qos_rpc_type[SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT],
+					     limits[SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT]);
+		spdk_json_write_named_uint64(w, qos_rpc_type[SPDK_BDEV_QOS_RW_BPS_RATE_LIMIT],
+					     limits[SPDK_BDEV_QOS_RW_BPS_RATE_LIMIT]);
+		spdk_json_write_object_end(w);
+		bdev_qos_group_bdevs_json(group, w);
+		spdk_json_write_object_end(w);
+	}
+	spdk_json_write_array_end(w);
+	spdk_spin_unlock(&g_bdev_mgr.spinlock);
+
+	return 0;
+}
+
+struct spdk_bdev_histogram_ctx {
+	spdk_bdev_histogram_status_cb cb_fn;
+	void *cb_arg;
+	struct spdk_bdev *bdev;
+	int status;
+};
+
+static void
+bdev_histogram_disable_channel_cb(struct spdk_bdev *bdev, void *_ctx, int status)
+{
+	struct spdk_bdev_histogram_ctx *ctx = _ctx;
+
+	spdk_spin_lock(&ctx->bdev->internal.spinlock);
+	ctx->bdev->internal.histogram_in_progress = false;
+	spdk_spin_unlock(&ctx->bdev->internal.spinlock);
+	ctx->cb_fn(ctx->cb_arg, ctx->status);
+	free(ctx);
+}
+
+static void
+bdev_histogram_disable_channel(struct spdk_bdev_channel_iter *i, struct spdk_bdev *bdev,
+			       struct spdk_io_channel *_ch, void *_ctx)
+{
+	struct spdk_bdev_channel *ch = __io_ch_to_bdev_ch(_ch);
+
+	if (ch->histogram != NULL) {
+		spdk_histogram_data_free(ch->histogram);
+		ch->histogram = NULL;
+	}
+	bdev_histogram_breakdown_free(ch->histogram_breakdown);
+	ch->histogram_breakdown = NULL;
+	spdk_bdev_for_each_channel_continue(i, 0);
+}
+
+static void
+bdev_histogram_enable_channel_cb(struct spdk_bdev *bdev, void *_ctx, int status)
+{
+	struct spdk_bdev_histogram_ctx *ctx = _ctx;
+
+	if (status != 0) {
 		ctx->status = status;
 		ctx->bdev->internal.histogram_enabled = false;
 		spdk_bdev_for_each_channel(ctx->bdev, bdev_histogram_disable_channel, ctx,
@@ -9319,6 +10967,8 @@ bdev_histogram_enable_channel(struct spdk_bdev_channel_iter *i, struct spdk_bdev
 			      struct spdk_io_channel *_ch, void *_ctx)
 {
 	struct spdk_bdev_channel *ch = __io_ch_to_bdev_ch(_ch);
+	struct spdk_bdev_enable_histogram_opts *opts = &bdev->internal.histogram_opts;
+	struct spdk_bdev_histogram_breakdown *breakdown = ch->histogram_breakdown;
 	int status = 0;
 
 	if (ch->histogram == NULL) {
@@ -9328,15 +10978,105 @@ bdev_histogram_enable_channel(struct spdk_bdev_channel_iter *i, struct spdk_bdev
 		}
 	}
 
+	/* Keep the breakdown collected so far, unless its size classes changed */
+	if (breakdown != NULL && !bdev_histogram_breakdown_matches(breakdown, opts)) {
+		bdev_histogram_breakdown_free(breakdown);
+		ch->histogram_breakdown = NULL;
+	}
+
+	if (opts->breakdown && ch->histogram_breakdown == NULL) {
+		ch->histogram_breakdown = bdev_histogram_breakdown_alloc(opts);
+		if (ch->histogram_breakdown == NULL) {
+			status = -ENOMEM;
+		}
+	}
+
 	spdk_bdev_for_each_channel_continue(i, status);
 }
 
+void
+spdk_bdev_enable_histogram_opts_init(struct spdk_bdev_enable_histogram_opts *opts, size_t size)
+{
+	assert(opts);
+	assert(size);
+
+	memset(opts, 0, size);
+	opts->size = size;
+}
+
+static void
+bdev_enable_histogram_opts_copy(struct spdk_bdev_enable_histogram_opts *opts,
+				const struct spdk_bdev_enable_histogram_opts *opts_src)
+{
+	spdk_bdev_enable_histogram_opts_init(opts, sizeof(*opts));
+
+#define SET_FIELD(field) \
+	if (offsetof(struct spdk_bdev_enable_histogram_opts, field) + sizeof(opts->field) <= opts_src->size) { \
+		opts->field = opts_src->field; \
+	} \
+
+	SET_FIELD(breakdown);
+	SET_FIELD(num_size_class_bounds);
+
+	if (offsetof(struct spdk_bdev_enable_histogram_opts, size_class_bounds) +
+	    sizeof(opts->size_class_bounds) <= opts_src->size) {
+		memcpy(opts->size_class_bounds, opts_src->size_class_bounds,
+		       sizeof(opts->size_class_bounds));
+	}
+
+	/* Do not remove this statement, you should always update this statement when you adding a new field,
+	 * and do not forget to add the SET_FIELD statement for your added field. */
+	SPDK_STATIC_ASSERT(sizeof(struct spdk_bdev_enable_histogram_opts) == 72, "Incorrect size");
+
+#undef SET_FIELD
+}
+
+static bool
+bdev_enable_histogram_opts_valid(const struct spdk_bdev_enable_histogram_opts *opts)
+{
+	uint32_t i;
+
+	if (opts->num_size_class_bounds >= SPDK_BDEV_HISTOGRAM_MAX_SIZE_CLASSES) {
+		SPDK_ERRLOG("Too many histogram size classes: %" PRIu32 "\n",
+			    opts->num_size_class_bounds + 1);
+		return false;
+	}
+
+	for (i = 1; i < opts->num_size_class_bounds; i++) {
+		if (opts->size_class_bounds[i] <= opts->size_class_bounds[i - 1]) {
+			SPDK_ERRLOG("Histogram size class bounds must be ascending\n");
+			return false;
+		}
+	}
+
+	return true;
+}
+
 void
 spdk_bdev_histogram_enable(struct spdk_bdev *bdev, spdk_bdev_histogram_status_cb cb_fn,
 			   void *cb_arg, bool enable)
 {
+	spdk_bdev_histogram_enable_ext(bdev, cb_fn, cb_arg, enable, NULL);
+}
+
+void
+spdk_bdev_histogram_enable_ext(struct spdk_bdev *bdev, spdk_bdev_histogram_status_cb cb_fn,
+			       void *cb_arg, bool enable, struct spdk_bdev_enable_histogram_opts *_opts)
+{
+	struct spdk_bdev_enable_histogram_opts opts;
 	struct spdk_bdev_histogram_ctx *ctx;
 
+	if (_opts != NULL) {
+		bdev_enable_histogram_opts_copy(&opts, _opts);
+	} else {
+		spdk_bdev_enable_histogram_opts_init(&opts, sizeof(opts));
+	}
+
+	if (enable && !bdev_enable_histogram_opts_valid(&opts)) {
+		cb_fn(cb_arg, -EINVAL);
+		return;
+	}
+
 	ctx = calloc(1, sizeof(struct spdk_bdev_histogram_ctx));
 	if (ctx == NULL) {
 		cb_fn(cb_arg, -ENOMEM);
@@ -9362,6 +11102,7 @@ spdk_bdev_histogram_enable(struct spdk_bdev *bdev, spdk_bdev_histogram_status_cb
 	bdev->internal.histogram_enabled = enable;
 
 	if (enable) {
+		bdev->internal.histogram_opts = opts;
 		/* Allocate histogram for each channel */
 		spdk_bdev_for_each_channel(bdev, bdev_histogram_enable_channel, ctx,
 					   bdev_histogram_enable_channel_cb);
@@ -9428,6 +11169,100 @@ spdk_bdev_histogram_get(struct spdk_bdev *bdev, struct spdk_histogram_data *hist
 				   bdev_histogram_get_channel_cb);
 }
 
+struct spdk_bdev_histogram_breakdown_ctx {
+	spdk_bdev_histogram_breakdown_cb cb_fn;
+	void *cb_arg;
+	/** merged breakdown from all channels */
+	struct spdk_bdev_histogram_breakdown *breakdown;
+};
+
+static void
+bdev_histogram_get_breakdown_channel_cb(struct spdk_bdev *bdev, void *_ctx, int status)
+{
+	struct spdk_bdev_histogram_breakdown_ctx *ctx = _ctx;
+
+	ctx->cb_fn(ctx->cb_arg, status, status == 0 ? ctx->breakdown : NULL);
+	bdev_histogram_breakdown_free(ctx->breakdown);
+	free(ctx);
+}
+
+static void
+bdev_histogram_get_breakdown_channel(struct spdk_bdev_channel_iter *i, struct spdk_bdev *bdev,
+				     struct spdk_io_channel *_ch, void *_ctx)
+{
+	struct spdk_bdev_channel *ch = __io_ch_to_bdev_ch(_ch);
+	struct spdk_bdev_histogram_breakdown_ctx *ctx = _ctx;
+	struct spdk_bdev_histogram_breakdown *src = ch->histogram_breakdown;
+	struct spdk_bdev_histogram_breakdown *dst = ctx->breakdown;
+	uint32_t type, j;
+	int status = 0;
+
+	if (src == NULL) {
+		status = -EFAULT;
+		goto out;
+	}
+
+	if (src->num_size_classes != dst->num_size_classes ||
+	    memcmp(src->size_class_bounds, dst->size_class_bounds,
+		   sizeof(src->size_class_bounds)) != 0) {
+		/* The histograms were enabled again with different size classes meanwhile */
+		status = -EAGAIN;
+		goto out;
+	}
+
+	for (type = 0; type < SPDK_BDEV_NUM_IO_TYPES; type++) {
+		for (j = 0; j < src->num_size_classes; j++) {
+			if (src->histogram[type][j] == NULL) {
+				continue;
+			}
+
+			if (dst->histogram[type][j] == NULL) {
+				dst->histogram[type][j] = spdk_histogram_data_alloc();
+				if (dst->histogram[type][j] == NULL) {
+					status = -ENOMEM;
+					goto out;
+				}
+			}
+
+			spdk_histogram_data_merge(dst->histogram[type][j], src->histogram[type][j]);
+		}
+	}
+
+out:
+	spdk_bdev_for_each_channel_continue(i, status);
+}
+
+void
+spdk_bdev_histogram_get_breakdown(struct spdk_bdev *bdev, spdk_bdev_histogram_breakdown_cb cb_fn,
+				  void *cb_arg)
+{
+	struct spdk_bdev_histogram_breakdown_ctx *ctx;
+
+	if (!bdev->internal.histogram_enabled || !bdev->internal.histogram_opts.breakdown) {
+		cb_fn(cb_arg, -EFAULT, NULL);
+		return;
+	}
+
+	ctx = calloc(1, sizeof(struct spdk_bdev_histogram_breakdown_ctx));
+	if (ctx == NULL) {
+		cb_fn(cb_arg, -ENOMEM, NULL);
+		return;
+	}
+
+	ctx->breakdown = bdev_histogram_breakdown_alloc(&bdev->internal.histogram_opts);
+	if (ctx->breakdown == NULL) {
+		free(ctx);
+		cb_fn(cb_arg, -ENOMEM, NULL);
+		return;
+	}
+
+	ctx->cb_fn = cb_fn;
+	ctx->cb_arg = cb_arg;
+
+	spdk_bdev_for_each_channel(bdev, bdev_histogram_get_breakdown_channel, ctx,
+				   bdev_histogram_get_breakdown_channel_cb);
+}
+
 void
 spdk_bdev_channel_get_histogram(struct spdk_io_channel *ch, spdk_bdev_histogram_data_cb cb_fn,
 				void *cb_arg)
@@ -9443,6 +11278,199 @@ spdk_bdev_channel_get_histogram(struct spdk_io_channel *ch, spdk_bdev_histogram_
 	cb_fn(cb_arg, status, bdev_ch->histogram);
 }
 
+static const char *g_io_type_strings[] = {
+	[SPDK_BDEV_IO_TYPE_READ] = "read",
+	[SPDK_BDEV_IO_TYPE_WRITE] = "write",
+	[SPDK_BDEV_IO_TYPE_UNMAP] = "unmap",
+	[SPDK_BDEV_IO_TYPE_FLUSH] = "flush",
+	[SPDK_BDEV_IO_TYPE_RESET] = "reset",
+	[SPDK_BDEV_IO_TYPE_NVME_ADMIN] = "nvme_admin",
+	[SPDK_BDEV_IO_TYPE_NVME_IO] = "nvme_io",
+	[SPDK_BDEV_IO_TYPE_NVME_IO_MD] = "nvme_io_md",
+	[SPDK_BDEV_IO_TYPE_WRITE_ZEROES] = "write_zeroes",
+	[SPDK_BDEV_IO_TYPE_ZCOPY] = "zcopy",
+	[SPDK_BDEV_IO_TYPE_GET_ZONE_INFO] = "get_zone_info",
+	[SPDK_BDEV_IO_TYPE_ZONE_MANAGEMENT] = "zone_management",
+	[SPDK_BDEV_IO_TYPE_ZONE_APPEND] = "zone_append",
+	[SPDK_BDEV_IO_TYPE_COMPARE] = "compare",
+	[SPDK_BDEV_IO_TYPE_COMPARE_AND_WRITE] = "compare_and_write",
+	[SPDK_BDEV_IO_TYPE_ABORT] = "abort",
+	[SPDK_BDEV_IO_TYPE_SEEK_HOLE] = "seek_hole",
+	[SPDK_BDEV_IO_TYPE_SEEK_DATA] = "seek_data",
+	[SPDK_BDEV_IO_TYPE_COPY] = "copy",
+	[SPDK_BDEV_IO_TYPE_NVME_IOV_MD] = "nvme_iov_md",
+};
+SPDK_STATIC_ASSERT(SPDK_COUNTOF(g_io_type_strings) == SPDK_BDEV_NUM_IO_TYPES,
+		   "Missing I/O type name");
+
+void
+spdk_bdev_channel_io_pool_opts_init(struct spdk_bdev_channel_io_pool_opts *opts, size_t size)
+{
+	assert(opts);
+	assert(size);
+
+	memset(opts, 0, size);
+	opts->size = size;
+}
+
+static void
+bdev_channel_io_pool_opts_copy(struct spdk_bdev_channel_io_pool_opts *opts,
+			       const struct spdk_bdev_channel_io_pool_opts *opts_src)
+{
+	spdk_bdev_channel_io_pool_opts_init(opts, sizeof(*opts));
+
+#define SET_FIELD(field) \
+	if (offsetof(struct spdk_bdev_channel_io_pool_opts, field) + sizeof(opts->field) <= opts_src->size) { \
+		opts->field = opts_src->field; \
+	} \
+
+	SET_FIELD(num_bdev_ios);
+	SET_FIELD(buf_size);
+	SET_FIELD(buf_pool);
+	SET_FIELD(num_bufs);
+
+	/* Do not remove this statement, you should always update this statement when you adding a new field,
+	 * and do not forget to add the SET_FIELD statement for your added field. */
+	SPDK_STATIC_ASSERT(sizeof(struct spdk_bdev_channel_io_pool_opts) == 32, "Incorrect size");
+
+#undef SET_FIELD
+}
+
+int
+spdk_bdev_channel_register_io_pool(struct spdk_io_channel *_ch,
+				   const struct spdk_bdev_channel_io_pool_opts *_opts)
+{
+	struct spdk_bdev_channel *ch = __io_ch_to_bdev_ch(_ch);
+	struct spdk_bdev_channel_io_pool_opts opts;
+	struct bdev_channel_io_pool *pool;
+	uintptr_t alignment = spdk_bdev_get_buf_align(ch->bdev);
+	struct spdk_bdev_io *bdev_io;
+	uint32_t i;
+	void *buf;
+
+	if (_opts == NULL || _opts->size == 0) {
+		SPDK_ERRLOG("Invalid I/O pool options\n");
+		return -EINVAL;
+	}
+
+	bdev_channel_io_pool_opts_copy(&opts, _opts);
+
+	if (opts.buf_pool != NULL &&
+	    (opts.num_bufs == 0 || opts.buf_size < sizeof(void *) ||
+	     ((uintptr_t)opts.buf_pool & (alignment - 1)) != 0 ||
+	     (opts.buf_size & (alignment - 1)) != 0)) {
+		SPDK_ERRLOG("Buffer pool %p of %" PRIu32 " buffers of %" PRIu32 " bytes doesn't match "
+			    "alignment %" PRIuPTR " of bdev %s\n", opts.buf_pool, opts.num_bufs,
+			    opts.buf_size, alignment, ch->bdev->name);
+		return -EINVAL;
+	}
+
+	if (ch->io_pool != NULL) {
+		return -EEXIST;
+	}
+
+	pool = calloc(1, sizeof(*pool));
+	if (pool == NULL) {
+		return -ENOMEM;
+	}
+
+	STAILQ_INIT(&pool->free_ios);
+	pool->io_size = SPDK_ALIGN_CEIL(sizeof(struct spdk_bdev_io) + bdev_module_get_max_ctx_size(),
+					SPDK_CACHE_LINE_SIZE);
+	if (opts.num_bdev_ios > 0) {
+		pool->ios = spdk_zmalloc(pool->io_size * opts.num_bdev_ios, SPDK_CACHE_LINE_SIZE, NULL,
+					 SPDK_ENV_LCORE_ID_ANY, SPDK_MALLOC_DMA);
+		if (pool->ios == NULL) {
+			free(pool);
+			return -ENOMEM;
+		}
+	}
+
+	for (i = 0; i < opts.num_bdev_ios; i++) {
+		bdev_io = (struct spdk_bdev_io *)((uint8_t *)pool->ios + i * pool->io_size);
+		STAILQ_INSERT_TAIL(&pool->free_ios, bdev_io, internal.buf_link);
+	}
+	pool->num_ios = pool->num_free_ios = opts.num_bdev_ios;
+
+	if (opts.buf_pool != NULL) {
+		pool->bufs = opts.buf_pool;
+		pool->buf_size = opts.buf_size;
+		pool->num_bufs = pool->num_free_bufs = opts.num_bufs;
+		/* Link the free buffers in address order */
+		for (i = opts.num_bufs; i > 0; i--) {
+			buf = (uint8_t *)pool->bufs + (uint64_t)(i - 1) * pool->buf_size;
+			*(void **)buf = pool->free_bufs;
+			pool->free_bufs = buf;
+		}
+		ch->bufs_aligned = true;
+	}
+
+	ch->io_pool = pool;
+
+	return 0;
+}
+
+int
+spdk_bdev_channel_unregister_io_pool(struct spdk_io_channel *_ch)
+{
+	struct spdk_bdev_channel *ch = __io_ch_to_bdev_ch(_ch);
+	struct bdev_channel_io_pool *pool = ch->io_pool;
+
+	if (pool == NULL) {
+		return -ENOENT;
+	}
+
+	if (pool->num_free_ios != pool->num_ios || pool->num_free_bufs != pool->num_bufs) {
+		return -EBUSY;
+	}
+
+	ch->bufs_aligned = false;
+	ch->io_pool = NULL;
+	bdev_channel_io_pool_free(pool);
+
+	return 0;
+}
+
+void *
+spdk_bdev_channel_get_pool_buf(struct spdk_io_channel *_ch)
+{
+	struct bdev_channel_io_pool *pool = __io_ch_to_bdev_ch(_ch)->io_pool;
+	void *buf;
+
+	if (spdk_unlikely(pool == NULL || pool->free_bufs == NULL)) {
+		return NULL;
+	}
+
+	buf = pool->free_bufs;
+	pool->free_bufs = *(void **)buf;
+	pool->num_free_bufs--;
+
+	return buf;
+}
+
+void
+spdk_bdev_channel_put_pool_buf(struct spdk_io_channel *_ch, void *buf)
+{
+	struct bdev_channel_io_pool *pool = __io_ch_to_bdev_ch(_ch)->io_pool;
+
+	assert(pool != NULL);
+	assert((uintptr_t)buf - (uintptr_t)pool->bufs < (uintptr_t)pool->num_bufs * pool->buf_size);
+
+	*(void **)buf = pool->free_bufs;
+	pool->free_bufs = buf;
+	pool->num_free_bufs++;
+}
+
+const char *
+spdk_bdev_get_io_type_name(enum spdk_bdev_io_type io_type)
+{
+	if (io_type <= SPDK_BDEV_IO_TYPE_INVALID || io_type >= SPDK_BDEV_NUM_IO_TYPES) {
+		return NULL;
+	}
+
+	return g_io_type_strings[io_type];
+}
+
 size_t
 spdk_bdev_get_media_events(struct spdk_bdev_desc *desc, struct spdk_bdev_media_event *events,
 			   size_t max_events)
@@ -31,4 +31,9 @@ typedef void (*bdev_reset_device_stat_cb)(struct spdk_bdev *bdev, void *cb_arg,
 void bdev_reset_device_stat(struct spdk_bdev *bdev, enum spdk_bdev_reset_stat_mode mode,
 			    bdev_reset_device_stat_cb cb, void *cb_arg);
 
+struct spdk_json_write_ctx;
+
+/* Write an array describing QoS groups. All groups are listed if name is NULL. */
+int bdev_qos_groups_info_json(const char *name, struct spdk_json_write_ctx *w);
+
 #endif /* SPDK_BDEV_INTERNAL_H */
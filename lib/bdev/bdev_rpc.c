@@ -652,6 +652,10 @@ rpc_dump_bdev_info(void *ctx, struct spdk_bdev *bdev)
 	spdk_json_write_named_uint64(w, "num_blocks", spdk_bdev_get_num_blocks(bdev));
 	spdk_json_write_named_uuid(w, "uuid", &bdev->uuid);
 
+	if (spdk_bdev_get_numa_id(bdev) != SPDK_ENV_SOCKET_ID_ANY) {
+		spdk_json_write_named_int32(w, "numa_id", spdk_bdev_get_numa_id(bdev));
+	}
+
 	if (spdk_bdev_get_md_size(bdev) != 0) {
 		spdk_json_write_named_uint32(w, "md_size", spdk_bdev_get_md_size(bdev));
 		spdk_json_write_named_bool(w, "md_interleave", spdk_bdev_is_md_interleaved(bdev));
@@ -676,6 +680,15 @@ rpc_dump_bdev_info(void *ctx, struct spdk_bdev *bdev)
 	}
 	spdk_json_write_object_end(w);
 
+	if (spdk_bdev_get_qos_group(bdev) != NULL) {
+		spdk_json_write_named_string(w, "qos_group", spdk_bdev_get_qos_group(bdev));
+	}
+
+	if (spdk_bdev_get_qos_latency_target(bdev) != 0) {
+		spdk_json_write_named_uint64(w, "qos_latency_target_us",
+					     spdk_bdev_get_qos_latency_target(bdev));
+	}
+
 	spdk_json_write_named_bool(w, "claimed",
 				   (bdev->internal.claim_type != SPDK_BDEV_CLAIM_NONE));
 	if (bdev->internal.claim_type != SPDK_BDEV_CLAIM_NONE) {
@@ -989,11 +1002,392 @@ cleanup:
 
 SPDK_RPC_REGISTER("bdev_set_qos_limit", rpc_bdev_set_qos_limit, SPDK_RPC_RUNTIME)
 
+static void
+rpc_bdev_qos_group_create(struct spdk_jsonrpc_request *request,
+			  const struct spdk_json_val *params)
+{
+	struct rpc_bdev_set_qos_limit req = {NULL, {UINT64_MAX, UINT64_MAX, UINT64_MAX, UINT64_MAX}};
+	int rc;
+
+	if (spdk_json_decode_object(params, rpc_bdev_set_qos_limit_decoders,
+				    SPDK_COUNTOF(rpc_bdev_set_qos_limit_decoders),
+				    &req)) {
+		SPDK_ERRLOG("spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	rc = spdk_bdev_qos_group_create(req.name, req.limits);
+	if (rc != 0) {
+		spdk_jsonrpc_send_error_response_fmt(request, rc, "Failed to create QoS group %s: %s",
+						     req.name, spdk_strerror(-rc));
+		goto cleanup;
+	}
+
+	spdk_jsonrpc_send_bool_response(request, true);
+
+cleanup:
+	free_rpc_bdev_set_qos_limit(&req);
+}
+SPDK_RPC_REGISTER("bdev_qos_group_create", rpc_bdev_qos_group_create, SPDK_RPC_RUNTIME)
+
+static void
+rpc_bdev_qos_group_set_limit(struct spdk_jsonrpc_request *request,
+			     const struct spdk_json_val *params)
+{
+	struct rpc_bdev_set_qos_limit req = {NULL, {UINT64_MAX, UINT64_MAX, UINT64_MAX, UINT64_MAX}};
+	int i, rc;
+
+	if (spdk_json_decode_object(params, rpc_bdev_set_qos_limit_decoders,
+				    SPDK_COUNTOF(rpc_bdev_set_qos_limit_decoders),
+				    &req)) {
+		SPDK_ERRLOG("spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+		if (req.limits[i] != UINT64_MAX) {
+			break;
+		}
+	}
+	if (i == SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES) {
+		SPDK_ERRLOG("no rate limits specified\n");
+		spdk_jsonrpc_send_error_response(request, -EINVAL, "No rate limits specified");
+		goto cleanup;
+	}
+
+	rc = spdk_bdev_qos_group_set_rate_limits(req.name, req.limits);
+	if (rc != 0) {
+		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
+		goto cleanup;
+	}
+
+	spdk_jsonrpc_send_bool_response(request, true);
+
+cleanup:
+	free_rpc_bdev_set_qos_limit(&req);
+}
+SPDK_RPC_REGISTER("bdev_qos_group_set_limit", rpc_bdev_qos_group_set_limit, SPDK_RPC_RUNTIME)
+
+struct rpc_bdev_qos_group_name {
+	char *name;
+};
+
+static const struct spdk_json_object_decoder rpc_bdev_qos_group_name_decoders[] = {
+	{"name", offsetof(struct rpc_bdev_qos_group_name, name), spdk_json_decode_string},
+};
+
+static void
+rpc_bdev_qos_group_delete(struct spdk_jsonrpc_request *request,
+			  const struct spdk_json_val *params)
+{
+	struct rpc_bdev_qos_group_name req = {};
+	int rc;
+
+	if (spdk_json_decode_object(params, rpc_bdev_qos_group_name_decoders,
+				    SPDK_COUNTOF(rpc_bdev_qos_group_name_decoders),
+				    &req)) {
+		SPDK_ERRLOG("spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	rc = spdk_bdev_qos_group_delete(req.name);
+	if (rc != 0) {
+		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
+		goto cleanup;
+	}
+
+	spdk_jsonrpc_send_bool_response(request, true);
+
+cleanup:
+	free(req.name);
+}
+SPDK_RPC_REGISTER("bdev_qos_group_delete", rpc_bdev_qos_group_delete, SPDK_RPC_RUNTIME)
+
+static void
+rpc_bdev_get_qos_groups(struct spdk_jsonrpc_request *request,
+			const struct spdk_json_val *params)
+{
+	struct rpc_bdev_qos_group_name req = {};
+	struct spdk_json_write_ctx *w;
+	uint64_t limits[SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES];
+
+	if (params && spdk_json_decode_object(params, rpc_bdev_qos_group_name_decoders,
+					      SPDK_COUNTOF(rpc_bdev_qos_group_name_decoders),
+					      &req)) {
+		SPDK_ERRLOG("spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	if (req.name != NULL && spdk_bdev_qos_group_get_rate_limits(req.name, limits) != 0) {
+		spdk_jsonrpc_send_error_response(request, -ENOENT, spdk_strerror(ENOENT));
+		goto cleanup;
+	}
+
+	w = spdk_jsonrpc_begin_result(request);
+	if (bdev_qos_groups_info_json(req.name, w) != 0) {
+		/* The group was deleted in the meantime, report an empty list */
+		spdk_json_write_array_begin(w);
+		spdk_json_write_array_end(w);
+	}
+	spdk_jsonrpc_end_result(request, w);
+
+cleanup:
+	free(req.name);
+}
+SPDK_RPC_REGISTER("bdev_get_qos_groups", rpc_bdev_get_qos_groups, SPDK_RPC_RUNTIME)
+
+struct rpc_bdev_qos_group_bdev {
+	char *name;
+	char *bdev_name;
+};
+
+static void
+free_rpc_bdev_qos_group_bdev(struct rpc_bdev_qos_group_bdev *r)
+{
+	free(r->name);
+	free(r->bdev_name);
+}
+
+static const struct spdk_json_object_decoder rpc_bdev_qos_group_bdev_decoders[] = {
+	{"name", offsetof(struct rpc_bdev_qos_group_bdev, name), spdk_json_decode_string},
+	{"bdev_name", offsetof(struct rpc_bdev_qos_group_bdev, bdev_name), spdk_json_decode_string},
+};
+
+static void
+rpc_bdev_qos_group_bdev_complete(void *cb_arg, int status)
+{
+	struct spdk_jsonrpc_request *request = cb_arg;
+
+	if (status != 0) {
+		spdk_jsonrpc_send_error_response_fmt(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
+						     "Failed to update QoS group: %s",
+						     spdk_strerror(-status));
+		return;
+	}
+
+	spdk_jsonrpc_send_bool_response(request, true);
+}
+
+static void
+rpc_bdev_qos_group_update_bdev(struct spdk_jsonrpc_request *request,
+			       const struct spdk_json_val *params, bool add)
+{
+	struct rpc_bdev_qos_group_bdev req = {};
+	struct spdk_bdev_desc *desc;
+	struct spdk_bdev *bdev;
+	const char *group_name;
+	int rc;
+
+	if (spdk_json_decode_object(params, rpc_bdev_qos_group_bdev_decoders,
+				    SPDK_COUNTOF(rpc_bdev_qos_group_bdev_decoders),
+				    &req)) {
+		SPDK_ERRLOG("spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	rc = spdk_bdev_open_ext(req.bdev_name, false, dummy_bdev_event_cb, NULL, &desc);
+	if (rc != 0) {
+		SPDK_ERRLOG("Failed to open bdev '%s': %d\n", req.bdev_name, rc);
+		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
+		goto cleanup;
+	}
+
+	bdev = spdk_bdev_desc_get_bdev(desc);
+	if (!add) {
+		group_name = spdk_bdev_get_qos_group(bdev);
+		if (group_name == NULL || strcmp(group_name, req.name) != 0) {
+			spdk_bdev_close(desc);
+			spdk_jsonrpc_send_error_response_fmt(request, -EINVAL,
+							     "Bdev %s is not a member of QoS group %s",
+							     req.bdev_name, req.name);
+			goto cleanup;
+		}
+	}
+
+	spdk_bdev_set_qos_group(bdev, add ? req.name : NULL,
+				rpc_bdev_qos_group_bdev_complete, request);
+
+	spdk_bdev_close(desc);
+
+cleanup:
+	free_rpc_bdev_qos_group_bdev(&req);
+}
+
+static void
+rpc_bdev_qos_group_add_bdev(struct spdk_jsonrpc_request *request,
+			    const struct spdk_json_val *params)
+{
+	rpc_bdev_qos_group_update_bdev(request, params, true);
+}
+SPDK_RPC_REGISTER("bdev_qos_group_add_bdev", rpc_bdev_qos_group_add_bdev, SPDK_RPC_RUNTIME)
+
+static void
+rpc_bdev_qos_group_remove_bdev(struct spdk_jsonrpc_request *request,
+			       const struct spdk_json_val *params)
+{
+	rpc_bdev_qos_group_update_bdev(request, params, false);
+}
+SPDK_RPC_REGISTER("bdev_qos_group_remove_bdev", rpc_bdev_qos_group_remove_bdev, SPDK_RPC_RUNTIME)
+
+struct rpc_bdev_set_qos_latency_target {
+	char *name;
+	uint64_t latency_target_us;
+};
+
+static void
+free_rpc_bdev_set_qos_latency_target(struct rpc_bdev_set_qos_latency_target *r)
+{
+	free(r->name);
+}
+
+static const struct spdk_json_object_decoder rpc_bdev_set_qos_latency_target_decoders[] = {
+	{"name", offsetof(struct rpc_bdev_set_qos_latency_target, name), spdk_json_decode_string},
+	{
+		"latency_target_us", offsetof(struct rpc_bdev_set_qos_latency_target, latency_target_us),
+		spdk_json_decode_uint64
+	},
+};
+
+static void
+rpc_bdev_set_qos_latency_target_complete(void *cb_arg, int status)
+{
+	struct spdk_jsonrpc_request *request = cb_arg;
+
+	if (status != 0) {
+		spdk_jsonrpc_send_error_response_fmt(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
+						     "Failed to set QoS latency target: %s",
+						     spdk_strerror(-status));
+		return;
+	}
+
+	spdk_jsonrpc_send_bool_response(request, true);
+}
+
+static void
+rpc_bdev_set_qos_latency_target(struct spdk_jsonrpc_request *request,
+				const struct spdk_json_val *params)
+{
+	struct rpc_bdev_set_qos_latency_target req = {};
+	struct spdk_bdev_desc *desc;
+	int rc;
+
+	if (spdk_json_decode_object(params, rpc_bdev_set_qos_latency_target_decoders,
+				    SPDK_COUNTOF(rpc_bdev_set_qos_latency_target_decoders),
+				    &req)) {
+		SPDK_ERRLOG("spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	rc = spdk_bdev_open_ext(req.name, false, dummy_bdev_event_cb, NULL, &desc);
+	if (rc != 0) {
+		SPDK_ERRLOG("Failed to open bdev '%s': %d\n", req.name, rc);
+		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
+		goto cleanup;
+	}
+
+	spdk_bdev_set_qos_latency_target(spdk_bdev_desc_get_bdev(desc), req.latency_target_us,
+					 rpc_bdev_set_qos_latency_target_complete, request);
+
+	spdk_bdev_close(desc);
+
+cleanup:
+	free_rpc_bdev_set_qos_latency_target(&req);
+}
+SPDK_RPC_REGISTER("bdev_set_qos_latency_target", rpc_bdev_set_qos_latency_target, SPDK_RPC_RUNTIME)
+
+struct rpc_bdev_set_merge_opts {
+	char *name;
+	struct spdk_bdev_merge_opts opts;
+};
+
+static void
+free_rpc_bdev_set_merge_opts(struct rpc_bdev_set_merge_opts *r)
+{
+	free(r->name);
+}
+
+static const struct spdk_json_object_decoder rpc_bdev_set_merge_opts_decoders[] = {
+	{"name", offsetof(struct rpc_bdev_set_merge_opts, name), spdk_json_decode_string},
+	{"window_us", offsetof(struct rpc_bdev_set_merge_opts, opts.window_us), spdk_json_decode_uint32},
+	{"max_ios", offsetof(struct rpc_bdev_set_merge_opts, opts.max_ios), spdk_json_decode_uint32, true},
+	{"max_blocks", offsetof(struct rpc_bdev_set_merge_opts, opts.max_blocks), spdk_json_decode_uint64, true},
+};
+
+static void
+rpc_bdev_set_merge_opts_complete(void *cb_arg, int status)
+{
+	struct spdk_jsonrpc_request *request = cb_arg;
+
+	if (status != 0) {
+		spdk_jsonrpc_send_error_response_fmt(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
+						     "Failed to set merge options: %s",
+						     spdk_strerror(-status));
+		return;
+	}
+
+	spdk_jsonrpc_send_bool_response(request, true);
+}
+
+static void
+rpc_bdev_set_merge_opts(struct spdk_jsonrpc_request *request,
+			const struct spdk_json_val *params)
+{
+	struct rpc_bdev_set_merge_opts req = {};
+	struct spdk_bdev_desc *desc;
+	int rc;
+
+	spdk_bdev_merge_opts_init(&req.opts, sizeof(req.opts));
+
+	if (spdk_json_decode_object(params, rpc_bdev_set_merge_opts_decoders,
+				    SPDK_COUNTOF(rpc_bdev_set_merge_opts_decoders),
+				    &req)) {
+		SPDK_ERRLOG("spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	rc = spdk_bdev_open_ext(req.name, false, dummy_bdev_event_cb, NULL, &desc);
+	if (rc != 0) {
+		SPDK_ERRLOG("Failed to open bdev '%s': %d\n", req.name, rc);
+		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
+		goto cleanup;
+	}
+
+	spdk_bdev_set_merge_opts(spdk_bdev_desc_get_bdev(desc), &req.opts,
+				 rpc_bdev_set_merge_opts_complete, request);
+
+	spdk_bdev_close(desc);
+
+cleanup:
+	free_rpc_bdev_set_merge_opts(&req);
+}
+SPDK_RPC_REGISTER("bdev_set_merge_opts", rpc_bdev_set_merge_opts, SPDK_RPC_RUNTIME)
+
 /* SPDK_RPC_ENABLE_BDEV_HISTOGRAM */
 
+struct rpc_bdev_histogram_size_class_bounds {
+	size_t num_bounds;
+	uint64_t bounds[SPDK_BDEV_HISTOGRAM_MAX_SIZE_CLASSES - 1];
+};
+
 struct rpc_bdev_enable_histogram_request {
 	char *name;
 	bool enable;
+	bool breakdown;
+	struct rpc_bdev_histogram_size_class_bounds size_class_bounds;
 };
 
 static void
@@ -1002,9 +1396,21 @@ free_rpc_bdev_enable_histogram_request(struct rpc_bdev_enable_histogram_request
 	free(r->name);
 }
 
+static int
+decode_size_class_bounds(const struct spdk_json_val *val, void *out)
+{
+	struct rpc_bdev_histogram_size_class_bounds *size_class_bounds = out;
+
+	return spdk_json_decode_array(val, spdk_json_decode_uint64, size_class_bounds->bounds,
+				      SPDK_COUNTOF(size_class_bounds->bounds),
+				      &size_class_bounds->num_bounds, sizeof(uint64_t));
+}
+
 static const struct spdk_json_object_decoder rpc_bdev_enable_histogram_request_decoders[] = {
 	{"name", offsetof(struct rpc_bdev_enable_histogram_request, name), spdk_json_decode_string},
 	{"enable", offsetof(struct rpc_bdev_enable_histogram_request, enable), spdk_json_decode_bool},
+	{"breakdown", offsetof(struct rpc_bdev_enable_histogram_request, breakdown), spdk_json_decode_bool, true},
+	{"size_class_bounds", offsetof(struct rpc_bdev_enable_histogram_request, size_class_bounds), decode_size_class_bounds, true},
 };
 
 static void
@@ -1024,6 +1430,7 @@ rpc_bdev_enable_histogram(struct spdk_jsonrpc_request *request,
 			  const struct spdk_json_val *params)
 {
 	struct rpc_bdev_enable_histogram_request req = {NULL};
+	struct spdk_bdev_enable_histogram_opts opts;
 	struct spdk_bdev_desc *desc;
 	int rc;
 
@@ -1042,8 +1449,15 @@ rpc_bdev_enable_histogram(struct spdk_jsonrpc_request *request,
 		goto cleanup;
 	}
 
-	spdk_bdev_histogram_enable(spdk_bdev_desc_get_bdev(desc), bdev_histogram_status_cb,
-				   request, req.enable);
+	spdk_bdev_enable_histogram_opts_init(&opts, sizeof(opts));
+	/* Size classes only make sense with the breakdown */
+	opts.breakdown = req.breakdown || req.size_class_bounds.num_bounds > 0;
+	opts.num_size_class_bounds = req.size_class_bounds.num_bounds;
+	memcpy(opts.size_class_bounds, req.size_class_bounds.bounds,
+	       sizeof(req.size_class_bounds.bounds));
+
+	spdk_bdev_histogram_enable_ext(spdk_bdev_desc_get_bdev(desc), bdev_histogram_status_cb,
+				       request, req.enable, &opts);
 
 	spdk_bdev_close(desc);
 
@@ -1057,10 +1471,12 @@ SPDK_RPC_REGISTER("bdev_enable_histogram", rpc_bdev_enable_histogram, SPDK_RPC_R
 
 struct rpc_bdev_get_histogram_request {
 	char *name;
+	bool breakdown;
 };
 
 static const struct spdk_json_object_decoder rpc_bdev_get_histogram_request_decoders[] = {
-	{"name", offsetof(struct rpc_bdev_get_histogram_request, name), spdk_json_decode_string}
+	{"name", offsetof(struct rpc_bdev_get_histogram_request, name), spdk_json_decode_string},
+	{"breakdown", offsetof(struct rpc_bdev_get_histogram_request, breakdown), spdk_json_decode_bool, true},
 };
 
 static void
@@ -1069,51 +1485,125 @@ free_rpc_bdev_get_histogram_request(struct rpc_bdev_get_histogram_request *r)
 	free(r->name);
 }
 
+struct rpc_bdev_get_histogram_ctx {
+	struct spdk_jsonrpc_request *request;
+	struct spdk_bdev_desc *desc;
+	struct spdk_histogram_data *histogram;
+	bool breakdown;
+	/* Buffer big enough for any of the histograms encoded in base64 */
+	char *encoded_histogram;
+};
+
 static void
-_rpc_bdev_histogram_data_cb(void *cb_arg, int status, struct spdk_histogram_data *histogram)
+free_rpc_bdev_get_histogram_ctx(struct rpc_bdev_get_histogram_ctx *ctx)
 {
-	struct spdk_jsonrpc_request *request = cb_arg;
+	spdk_bdev_close(ctx->desc);
+	spdk_histogram_data_free(ctx->histogram);
+	free(ctx->encoded_histogram);
+	free(ctx);
+}
+
+static int
+rpc_bdev_write_histogram(struct spdk_json_write_ctx *w, struct rpc_bdev_get_histogram_ctx *ctx,
+			 struct spdk_histogram_data *histogram)
+{
+	int rc;
+
+	rc = spdk_base64_encode(ctx->encoded_histogram, histogram->bucket,
+				SPDK_HISTOGRAM_NUM_BUCKETS(histogram) * sizeof(uint64_t));
+	if (rc != 0) {
+		return rc;
+	}
+
+	spdk_json_write_named_string(w, "histogram", ctx->encoded_histogram);
+
+	return 0;
+}
+
+static void
+rpc_bdev_get_histogram_done(struct rpc_bdev_get_histogram_ctx *ctx,
+			    struct spdk_bdev_histogram_breakdown *breakdown)
+{
+	struct spdk_histogram_data *histogram = ctx->histogram;
 	struct spdk_json_write_ctx *w;
+	uint32_t type, i;
 	int rc;
-	char *encoded_histogram;
-	size_t src_len, dst_len;
 
+	w = spdk_jsonrpc_begin_result(ctx->request);
+	spdk_json_write_object_begin(w);
+	rc = rpc_bdev_write_histogram(w, ctx, histogram);
+	spdk_json_write_named_int64(w, "bucket_shift", histogram->bucket_shift);
+	spdk_json_write_named_int64(w, "tsc_rate", spdk_get_ticks_hz());
+
+	if (breakdown != NULL) {
+		spdk_json_write_named_array_begin(w, "breakdown");
+		for (type = 0; type < SPDK_BDEV_NUM_IO_TYPES && rc == 0; type++) {
+			for (i = 0; i < breakdown->num_size_classes && rc == 0; i++) {
+				if (breakdown->histogram[type][i] == NULL) {
+					continue;
+				}
+
+				spdk_json_write_object_begin(w);
+				spdk_json_write_named_string(w, "io_type", spdk_bdev_get_io_type_name(type));
+				if (i > 0) {
+					spdk_json_write_named_uint64(w, "min_size",
+								     breakdown->size_class_bounds[i - 1] + 1);
+				}
+				if (i < breakdown->num_size_classes - 1) {
+					spdk_json_write_named_uint64(w, "max_size", breakdown->size_class_bounds[i]);
+				}
+				rc = rpc_bdev_write_histogram(w, ctx, breakdown->histogram[type][i]);
+				spdk_json_write_object_end(w);
+			}
+		}
+		spdk_json_write_array_end(w);
+	}
+
+	spdk_json_write_object_end(w);
+	spdk_jsonrpc_end_result(ctx->request, w);
+
+	if (rc != 0) {
+		SPDK_ERRLOG("Failed to encode histogram: %s\n", spdk_strerror(-rc));
+	}
+
+	free_rpc_bdev_get_histogram_ctx(ctx);
+}
+
+static void
+_rpc_bdev_histogram_breakdown_cb(void *cb_arg, int status,
+				 struct spdk_bdev_histogram_breakdown *breakdown)
+{
+	struct rpc_bdev_get_histogram_ctx *ctx = cb_arg;
 
 	if (status != 0) {
-		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+		spdk_jsonrpc_send_error_response(ctx->request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
 						 spdk_strerror(-status));
-		goto invalid;
+		free_rpc_bdev_get_histogram_ctx(ctx);
+		return;
 	}
 
-	src_len = SPDK_HISTOGRAM_NUM_BUCKETS(histogram) * sizeof(uint64_t);
-	dst_len = spdk_base64_get_encoded_strlen(src_len) + 1;
+	rpc_bdev_get_histogram_done(ctx, breakdown);
+}
 
-	encoded_histogram = malloc(dst_len);
-	if (encoded_histogram == NULL) {
-		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
-						 spdk_strerror(ENOMEM));
-		goto invalid;
-	}
+static void
+_rpc_bdev_histogram_data_cb(void *cb_arg, int status, struct spdk_histogram_data *histogram)
+{
+	struct rpc_bdev_get_histogram_ctx *ctx = cb_arg;
 
-	rc = spdk_base64_encode(encoded_histogram, histogram->bucket, src_len);
-	if (rc != 0) {
-		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
-						 spdk_strerror(-rc));
-		goto free_encoded_histogram;
+	if (status != 0) {
+		spdk_jsonrpc_send_error_response(ctx->request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 spdk_strerror(-status));
+		free_rpc_bdev_get_histogram_ctx(ctx);
+		return;
 	}
 
-	w = spdk_jsonrpc_begin_result(request);
-	spdk_json_write_object_begin(w);
-	spdk_json_write_named_string(w, "histogram", encoded_histogram);
-	spdk_json_write_named_int64(w, "bucket_shift", histogram->bucket_shift);
-	spdk_json_write_named_int64(w, "tsc_rate", spdk_get_ticks_hz());
-	spdk_json_write_object_end(w);
-	spdk_jsonrpc_end_result(request, w);
+	if (ctx->breakdown) {
+		spdk_bdev_histogram_get_breakdown(spdk_bdev_desc_get_bdev(ctx->desc),
+						  _rpc_bdev_histogram_breakdown_cb, ctx);
+		return;
+	}
 
-free_encoded_histogram:
-	free(encoded_histogram);
-invalid:
-	spdk_histogram_data_free(histogram);
+	rpc_bdev_get_histogram_done(ctx, NULL);
 }
 
 static void
@@ -1121,7 +1611,7 @@ rpc_bdev_get_histogram(struct spdk_jsonrpc_request *request,
 		       const struct spdk_json_val *params)
 {
 	struct rpc_bdev_get_histogram_request req = {NULL};
-	struct spdk_histogram_data *histogram;
+	struct rpc_bdev_get_histogram_ctx *ctx;
 	struct spdk_bdev_desc *desc;
 	int rc;
 
@@ -1140,20 +1630,271 @@ rpc_bdev_get_histogram(struct spdk_jsonrpc_request *request,
 		goto cleanup;
 	}
 
-	histogram = spdk_histogram_data_alloc();
-	if (histogram == NULL) {
+	ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
 		spdk_bdev_close(desc);
 		spdk_jsonrpc_send_error_response(request, -ENOMEM, spdk_strerror(ENOMEM));
 		goto cleanup;
 	}
 
-	spdk_bdev_histogram_get(spdk_bdev_desc_get_bdev(desc), histogram,
-				_rpc_bdev_histogram_data_cb, request);
+	ctx->request = request;
+	ctx->desc = desc;
+	ctx->breakdown = req.breakdown;
+	ctx->histogram = spdk_histogram_data_alloc();
+	if (ctx->histogram != NULL) {
+		ctx->encoded_histogram = malloc(spdk_base64_get_encoded_strlen(
+				SPDK_HISTOGRAM_NUM_BUCKETS(ctx->histogram) * sizeof(uint64_t)) + 1);
+	}
+	if (ctx->encoded_histogram == NULL) {
+		free_rpc_bdev_get_histogram_ctx(ctx);
+		spdk_jsonrpc_send_error_response(request, -ENOMEM, spdk_strerror(ENOMEM));
+		goto cleanup;
+	}
 
-	spdk_bdev_close(desc);
+	spdk_bdev_histogram_get(spdk_bdev_desc_get_bdev(desc), ctx->histogram,
+				_rpc_bdev_histogram_data_cb, ctx);
 
 cleanup:
 	free_rpc_bdev_get_histogram_request(&req);
 }
 
 SPDK_RPC_REGISTER("bdev_get_histogram", rpc_bdev_get_histogram, SPDK_RPC_RUNTIME)
+
+struct rpc_bdev_get_allocation_map_request {
+	char *name;
+	uint64_t offset_blocks;
+	uint64_t num_blocks;
+	uint32_t max_extents;
+};
+
+static const struct spdk_json_object_decoder rpc_bdev_get_allocation_map_request_decoders[] = {
+	{"name", offsetof(struct rpc_bdev_get_allocation_map_request, name), spdk_json_decode_string},
+	{"offset_blocks", offsetof(struct rpc_bdev_get_allocation_map_request, offset_blocks), spdk_json_decode_uint64, true},
+	{"num_blocks", offsetof(struct rpc_bdev_get_allocation_map_request, num_blocks), spdk_json_decode_uint64, true},
+	{"max_extents", offsetof(struct rpc_bdev_get_allocation_map_request, max_extents), spdk_json_decode_uint32, true},
+};
+
+struct rpc_bdev_allocation_extent {
+	uint64_t offset_blocks;
+	uint64_t num_blocks;
+};
+
+struct rpc_bdev_get_allocation_map_ctx {
+	struct spdk_jsonrpc_request *request;
+	struct spdk_bdev_desc *desc;
+	struct spdk_io_channel *ch;
+	struct spdk_bdev_io_wait_entry bdev_io_wait;
+	/* Next offset to look for data at and the end of the range to map */
+	uint64_t offset_blocks;
+	uint64_t end_blocks;
+	/* Start of the extent being mapped, UINT64_MAX when looking for data */
+	uint64_t extent_offset_blocks;
+	uint32_t max_extents;
+	uint32_t num_extents;
+	uint32_t extents_size;
+	struct rpc_bdev_allocation_extent *extents;
+};
+
+static void rpc_bdev_get_allocation_map_next(void *arg);
+
+static void
+free_rpc_bdev_get_allocation_map_ctx(struct rpc_bdev_get_allocation_map_ctx *ctx)
+{
+	if (ctx->ch != NULL) {
+		spdk_put_io_channel(ctx->ch);
+	}
+	spdk_bdev_close(ctx->desc);
+	free(ctx->extents);
+	free(ctx);
+}
+
+static void
+rpc_bdev_get_allocation_map_done(struct rpc_bdev_get_allocation_map_ctx *ctx)
+{
+	struct spdk_bdev *bdev = spdk_bdev_desc_get_bdev(ctx->desc);
+	struct spdk_json_write_ctx *w;
+	uint64_t allocated_blocks = 0;
+	uint32_t i;
+
+	w = spdk_jsonrpc_begin_result(ctx->request);
+	spdk_json_write_object_begin(w);
+	spdk_json_write_named_uint32(w, "block_size", spdk_bdev_get_block_size(bdev));
+	spdk_json_write_named_array_begin(w, "extents");
+	for (i = 0; i < ctx->num_extents; i++) {
+		spdk_json_write_object_begin(w);
+		spdk_json_write_named_uint64(w, "offset_blocks", ctx->extents[i].offset_blocks);
+		spdk_json_write_named_uint64(w, "num_blocks", ctx->extents[i].num_blocks);
+		spdk_json_write_object_end(w);
+		allocated_blocks += ctx->extents[i].num_blocks;
+	}
+	spdk_json_write_array_end(w);
+	spdk_json_write_named_uint64(w, "allocated_blocks", allocated_blocks);
+	/* Let the caller continue from where the map was cut short by max_extents */
+	if (ctx->offset_blocks < ctx->end_blocks) {
+		spdk_json_write_named_uint64(w, "next_offset_blocks", ctx->offset_blocks);
+	}
+	spdk_json_write_object_end(w);
+	spdk_jsonrpc_end_result(ctx->request, w);
+
+	free_rpc_bdev_get_allocation_map_ctx(ctx);
+}
+
+static int
+rpc_bdev_get_allocation_map_add_extent(struct rpc_bdev_get_allocation_map_ctx *ctx,
+				       uint64_t offset_blocks, uint64_t num_blocks)
+{
+	struct rpc_bdev_allocation_extent *extents;
+	uint32_t size;
+
+	if (ctx->num_extents == ctx->extents_size) {
+		size = spdk_max(ctx->extents_size * 2, 64);
+		extents = realloc(ctx->extents, size * sizeof(*extents));
+		if (extents == NULL) {
+			return -ENOMEM;
+		}
+
+		ctx->extents = extents;
+		ctx->extents_size = size;
+	}
+
+	ctx->extents[ctx->num_extents].offset_blocks = offset_blocks;
+	ctx->extents[ctx->num_extents].num_blocks = num_blocks;
+	ctx->num_extents++;
+
+	return 0;
+}
+
+static void
+rpc_bdev_get_allocation_map_seek_cb(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct rpc_bdev_get_allocation_map_ctx *ctx = cb_arg;
+	uint64_t seek_offset = spdk_bdev_io_get_seek_offset(bdev_io);
+	int rc;
+
+	spdk_bdev_free_io(bdev_io);
+
+	if (!success) {
+		spdk_jsonrpc_send_error_response(ctx->request, -EIO, spdk_strerror(EIO));
+		free_rpc_bdev_get_allocation_map_ctx(ctx);
+		return;
+	}
+
+	if (ctx->extent_offset_blocks == UINT64_MAX) {
+		/* Looked for data, start an extent there unless there's no more data in the range */
+		if (seek_offset >= ctx->end_blocks) {
+			ctx->offset_blocks = ctx->end_blocks;
+			rpc_bdev_get_allocation_map_done(ctx);
+			return;
+		}
+
+		ctx->extent_offset_blocks = seek_offset;
+		ctx->offset_blocks = seek_offset;
+	} else {
+		/* Looked for a hole, it ends the extent */
+		ctx->offset_blocks = spdk_min(seek_offset, ctx->end_blocks);
+		rc = rpc_bdev_get_allocation_map_add_extent(ctx, ctx->extent_offset_blocks,
+				ctx->offset_blocks - ctx->extent_offset_blocks);
+		if (rc != 0) {
+			spdk_jsonrpc_send_error_response(ctx->request, rc, spdk_strerror(-rc));
+			free_rpc_bdev_get_allocation_map_ctx(ctx);
+			return;
+		}
+
+		ctx->extent_offset_blocks = UINT64_MAX;
+		if (ctx->offset_blocks == ctx->end_blocks || ctx->num_extents == ctx->max_extents) {
+			rpc_bdev_get_allocation_map_done(ctx);
+			return;
+		}
+	}
+
+	rpc_bdev_get_allocation_map_next(ctx);
+}
+
+static void
+rpc_bdev_get_allocation_map_next(void *arg)
+{
+	struct rpc_bdev_get_allocation_map_ctx *ctx = arg;
+	int rc;
+
+	if (ctx->extent_offset_blocks == UINT64_MAX) {
+		rc = spdk_bdev_seek_data(ctx->desc, ctx->ch, ctx->offset_blocks,
+					 rpc_bdev_get_allocation_map_seek_cb, ctx);
+	} else {
+		rc = spdk_bdev_seek_hole(ctx->desc, ctx->ch, ctx->offset_blocks,
+					 rpc_bdev_get_allocation_map_seek_cb, ctx);
+	}
+
+	if (rc == -ENOMEM) {
+		ctx->bdev_io_wait.bdev = spdk_bdev_desc_get_bdev(ctx->desc);
+		ctx->bdev_io_wait.cb_fn = rpc_bdev_get_allocation_map_next;
+		ctx->bdev_io_wait.cb_arg = ctx;
+		rc = spdk_bdev_queue_io_wait(ctx->bdev_io_wait.bdev, ctx->ch, &ctx->bdev_io_wait);
+	}
+
+	if (rc != 0) {
+		spdk_jsonrpc_send_error_response(ctx->request, rc, spdk_strerror(-rc));
+		free_rpc_bdev_get_allocation_map_ctx(ctx);
+	}
+}
+
+static void
+rpc_bdev_get_allocation_map(struct spdk_jsonrpc_request *request,
+			    const struct spdk_json_val *params)
+{
+	struct rpc_bdev_get_allocation_map_request req = {NULL};
+	struct rpc_bdev_get_allocation_map_ctx *ctx;
+	struct spdk_bdev_desc *desc;
+	struct spdk_bdev *bdev;
+	uint64_t num_blocks;
+	int rc;
+
+	if (spdk_json_decode_object(params, rpc_bdev_get_allocation_map_request_decoders,
+				    SPDK_COUNTOF(rpc_bdev_get_allocation_map_request_decoders),
+				    &req)) {
+		SPDK_ERRLOG("spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	rc = spdk_bdev_open_ext(req.name, false, dummy_bdev_event_cb, NULL, &desc);
+	if (rc != 0) {
+		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
+		goto cleanup;
+	}
+
+	bdev = spdk_bdev_desc_get_bdev(desc);
+	num_blocks = spdk_bdev_get_num_blocks(bdev);
+	if (req.offset_blocks >= num_blocks || req.num_blocks > num_blocks - req.offset_blocks) {
+		spdk_bdev_close(desc);
+		spdk_jsonrpc_send_error_response(request, -EINVAL, spdk_strerror(EINVAL));
+		goto cleanup;
+	}
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		spdk_bdev_close(desc);
+		spdk_jsonrpc_send_error_response(request, -ENOMEM, spdk_strerror(ENOMEM));
+		goto cleanup;
+	}
+
+	ctx->request = request;
+	ctx->desc = desc;
+	ctx->offset_blocks = req.offset_blocks;
+	ctx->end_blocks = req.num_blocks != 0 ? req.offset_blocks + req.num_blocks : num_blocks;
+	ctx->extent_offset_blocks = UINT64_MAX;
+	ctx->max_extents = req.max_extents != 0 ? req.max_extents : UINT32_MAX;
+	ctx->ch = spdk_bdev_get_io_channel(desc);
+	if (ctx->ch == NULL) {
+		free_rpc_bdev_get_allocation_map_ctx(ctx);
+		spdk_jsonrpc_send_error_response(request, -ENOMEM, spdk_strerror(ENOMEM));
+		goto cleanup;
+	}
+
+	rpc_bdev_get_allocation_map_next(ctx);
+
+cleanup:
+	free(req.name);
+}
+
+SPDK_RPC_REGISTER("bdev_get_allocation_map", rpc_bdev_get_allocation_map, SPDK_RPC_RUNTIME)
@@ -240,10 +240,24 @@ bdev_part_remap_dif(struct spdk_bdev_io *bdev_io, uint32_t offset,
 	return rc;
 }
 
+static uint64_t
+bdev_part_remap_seek_offset(struct spdk_bdev_part *part, uint64_t seek_offset)
+{
+	/* Report a data/hole offset found beyond the end of the part as not found */
+	if (seek_offset == UINT64_MAX ||
+	    seek_offset >= part->internal.offset_blocks + part->internal.bdev.blockcnt) {
+		return UINT64_MAX;
+	}
+
+	assert(seek_offset >= part->internal.offset_blocks);
+	return seek_offset - part->internal.offset_blocks;
+}
+
 static void
 bdev_part_complete_io(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
 {
 	struct spdk_bdev_io *part_io = cb_arg;
+	struct spdk_bdev_part *part;
 	uint32_t offset, remapped_offset;
 	spdk_bdev_io_completion_cb cb;
 	int rc, status;
@@ -264,6 +278,12 @@ bdev_part_complete_io(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
 		spdk_bdev_io_set_buf(part_io, bdev_io->u.bdev.iovs[0].iov_base,
 				     bdev_io->u.bdev.iovs[0].iov_len);
 		break;
+	case SPDK_BDEV_IO_TYPE_SEEK_DATA:
+	case SPDK_BDEV_IO_TYPE_SEEK_HOLE:
+		part = part_io->bdev->ctxt;
+		part_io->u.bdev.seek.offset = bdev_part_remap_seek_offset(part,
+					      spdk_bdev_io_get_seek_offset(bdev_io));
+		break;
 	default:
 		break;
 	}
@@ -289,6 +309,9 @@ bdev_part_init_ext_io_opts(struct spdk_bdev_io *bdev_io, struct spdk_bdev_ext_io
 	opts->memory_domain = bdev_io->u.bdev.memory_domain;
 	opts->memory_domain_ctx = bdev_io->u.bdev.memory_domain_ctx;
 	opts->metadata = bdev_io->u.bdev.md_buf;
+	if (bdev_io->type == SPDK_BDEV_IO_TYPE_WRITE) {
+		opts->placement_hint = bdev_io->u.bdev.placement_hint;
+	}
 }
 
 int
@@ -384,6 +407,14 @@ spdk_bdev_part_submit_request_ext(struct spdk_bdev_part_channel *ch, struct spdk
 					   bdev_io->u.bdev.num_blocks, bdev_part_complete_io,
 					   bdev_io);
 		break;
+	case SPDK_BDEV_IO_TYPE_SEEK_DATA:
+		rc = spdk_bdev_seek_data(base_desc, base_ch, remapped_offset,
+					 bdev_part_complete_io, bdev_io);
+		break;
+	case SPDK_BDEV_IO_TYPE_SEEK_HOLE:
+		rc = spdk_bdev_seek_hole(base_desc, base_ch, remapped_offset,
+					 bdev_part_complete_io, bdev_io);
+		break;
 	default:
 		SPDK_ERRLOG("unknown I/O type %d\n", bdev_io->type);
 		return SPDK_BDEV_IO_STATUS_FAILED;
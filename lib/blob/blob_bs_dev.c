@@ -148,6 +148,12 @@ blob_bs_translate_lba(struct spdk_bs_dev *dev, uint64_t lba, uint64_t *base_lba)
 		return true;
 	}
 
+	if (spdk_blob_is_esnap_clone(blob)) {
+		/* The external snapshot isn't on the blobstore's device, so its lbas can't be
+		 * used as a copy source there. */
+		return false;
+	}
+
 	assert(blob->back_bs_dev != NULL);
 	return blob->back_bs_dev->translate_lba(blob->back_bs_dev,
 						bs_io_unit_to_back_dev_lba(blob, lba),
@@ -6137,6 +6137,12 @@ struct spdk_clone_snapshot_ctx {
 	 * thin-provisioning. Otherwise only decouple parent and keep clone thin. */
 	bool allocate_all;
 
+	/* Extent page of the clusters claimed in memory by inflate, written out before
+	 * moving on to the clusters of another extent page. */
+	struct spdk_blob_md_page *extent_page;
+	uint64_t extent_page_cluster;
+	bool extent_page_dirty;
+
 	struct {
 		spdk_blob_id id;
 		struct spdk_blob *blob;
@@ -6178,6 +6184,7 @@ bs_clone_snapshot_cleanup_finish(void *cb_arg, int bserrno)
 		break;
 	}
 
+	spdk_free(ctx->extent_page);
 	free(ctx);
 }
 
@@ -6798,6 +6805,21 @@ bs_cluster_needs_allocation(struct spdk_blob *blob, uint64_t cluster, bool alloc
 	return (allocate_all || b->blob->active.clusters[cluster] != 0);
 }
 
+static void blob_write_extent_page(struct spdk_blob *blob, uint32_t extent, uint64_t cluster_num,
+				   struct spdk_blob_md_page *page, spdk_blob_op_complete cb_fn,
+				   void *cb_arg);
+
+/* Check if the backing device of the blob reads zeroes in place of the cluster */
+static inline bool
+bs_cluster_is_zeroes(struct spdk_blob *blob, uint64_t cluster)
+{
+	struct spdk_bs_dev *back_bs_dev = blob->back_bs_dev;
+
+	return back_bs_dev->is_zeroes(back_bs_dev,
+				      bs_dev_page_to_lba(back_bs_dev, bs_cluster_to_page(blob->bs, cluster)),
+				      bs_dev_byte_to_lba(back_bs_dev, blob->bs->cluster_sz));
+}
+
 static void
 bs_inflate_blob_touch_next(void *cb_arg, int bserrno)
 {
@@ -6805,7 +6827,9 @@ bs_inflate_blob_touch_next(void *cb_arg, int bserrno)
 	struct spdk_blob *_blob = ctx->original.blob;
 	struct spdk_bs_cpl cpl;
 	spdk_bs_user_op_t *op;
-	uint64_t offset;
+	uint64_t offset, new_cluster;
+	uint32_t lfmd = 0;
+	int rc;
 
 	if (bserrno != 0) {
 		bs_clone_snapshot_origblob_cleanup(ctx, bserrno);
@@ -6813,9 +6837,55 @@ bs_inflate_blob_touch_next(void *cb_arg, int bserrno)
 	}
 
 	for (; ctx->cluster < _blob->active.num_clusters; ctx->cluster++) {
-		if (bs_cluster_needs_allocation(_blob, ctx->cluster, ctx->allocate_all)) {
+		if (!bs_cluster_needs_allocation(_blob, ctx->cluster, ctx->allocate_all)) {
+			continue;
+		}
+
+		if (!bs_cluster_is_zeroes(_blob, ctx->cluster)) {
+			break;
+		}
+
+		if (ctx->extent_page_dirty &&
+		    bs_cluster_to_extent_table_id(ctx->cluster) !=
+		    bs_cluster_to_extent_table_id(ctx->extent_page_cluster)) {
 			break;
 		}
+
+		/* There's nothing to copy, so just claim the cluster in memory. The clusters
+		 * are persisted with one write of their extent page, or with the metadata sync
+		 * done at the end of the inflate, instead of one metadata update per cluster.
+		 */
+		spdk_spin_lock(&_blob->bs->used_lock);
+		rc = bs_allocate_cluster(_blob, ctx->cluster, &new_cluster, &lfmd, true);
+		spdk_spin_unlock(&_blob->bs->used_lock);
+		if (rc != 0) {
+			bs_clone_snapshot_origblob_cleanup(ctx, rc);
+			return;
+		}
+		_blob->state = SPDK_BLOB_STATE_DIRTY;
+
+		if (_blob->use_extent_table) {
+			ctx->extent_page_cluster = ctx->cluster;
+			ctx->extent_page_dirty = true;
+		}
+	}
+
+	if (ctx->extent_page_dirty) {
+		if (ctx->extent_page == NULL) {
+			ctx->extent_page = spdk_zmalloc(SPDK_BS_PAGE_SIZE, 0, NULL, SPDK_ENV_SOCKET_ID_ANY,
+							SPDK_MALLOC_DMA);
+			if (ctx->extent_page == NULL) {
+				bs_clone_snapshot_origblob_cleanup(ctx, -ENOMEM);
+				return;
+			}
+		}
+
+		memset(ctx->extent_page, 0, SPDK_BS_PAGE_SIZE);
+		ctx->extent_page_dirty = false;
+		blob_write_extent_page(_blob, *bs_cluster_to_extent_page(_blob, ctx->extent_page_cluster),
+				       ctx->extent_page_cluster, ctx->extent_page,
+				       bs_inflate_blob_touch_next, ctx);
+		return;
 	}
 
 	if (ctx->cluster < _blob->active.num_clusters) {
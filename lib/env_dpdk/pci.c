@@ -808,6 +808,41 @@ spdk_pci_device_get_interrupt_efd(struct spdk_pci_device *dev)
 	return dpdk_pci_device_get_interrupt_efd(dev->dev_handle);
 }
 
+int
+spdk_pci_device_enable_interrupts(struct spdk_pci_device *dev, uint32_t efd_count)
+{
+	int rc;
+
+	rc = dpdk_pci_device_create_interrupt_efds(dev->dev_handle, efd_count);
+	if (rc != 0) {
+		return rc;
+	}
+
+	rc = dpdk_pci_device_enable_interrupt(dev->dev_handle);
+	if (rc != 0) {
+		dpdk_pci_device_delete_interrupt_efds(dev->dev_handle);
+	}
+
+	return rc;
+}
+
+int
+spdk_pci_device_disable_interrupts(struct spdk_pci_device *dev)
+{
+	int rc;
+
+	rc = dpdk_pci_device_disable_interrupt(dev->dev_handle);
+	dpdk_pci_device_delete_interrupt_efds(dev->dev_handle);
+
+	return rc;
+}
+
+int
+spdk_pci_device_get_interrupt_efd_by_index(struct spdk_pci_device *dev, uint32_t index)
+{
+	return dpdk_pci_device_get_interrupt_efd_by_index(dev->dev_handle, index);
+}
+
 uint32_t
 spdk_pci_device_get_domain(struct spdk_pci_device *dev)
 {
@@ -238,6 +238,8 @@ spdk_nvme_ctrlr_get_default_ctrlr_opts(struct spdk_nvme_ctrlr_opts *opts, size_t
 		memset(opts->psk, 0, sizeof(opts->psk));
 	}
 
+	SET_FIELD(enable_interrupts, false);
+
 #undef FIELD_OK
 #undef SET_FIELD
 }
@@ -2630,23 +2632,11 @@ nvme_ctrlr_identify_ns_zns_specific_async_done(void *arg, const struct spdk_nvme
 }
 
 static int
-nvme_ctrlr_identify_ns_iocs_specific_async(struct spdk_nvme_ns *ns)
+nvme_ctrlr_identify_ns_zns_specific_async(struct spdk_nvme_ns *ns)
 {
 	struct spdk_nvme_ctrlr *ctrlr = ns->ctrlr;
 	int rc;
 
-	switch (ns->csi) {
-	case SPDK_NVME_CSI_ZNS:
-		break;
-	default:
-		/*
-		 * This switch must handle all cases for which
-		 * nvme_ns_has_supported_iocs_specific_data() returns true,
-		 * other cases should never happen.
-		 */
-		assert(0);
-	}
-
 	assert(!ns->nsdata_zns);
 	ns->nsdata_zns = spdk_zmalloc(sizeof(*ns->nsdata_zns), 64, NULL, SPDK_ENV_SOCKET_ID_ANY,
 				      SPDK_MALLOC_SHARE);
@@ -2666,6 +2656,65 @@ nvme_ctrlr_identify_ns_iocs_specific_async(struct spdk_nvme_ns *ns)
 	return rc;
 }
 
+static void
+nvme_ctrlr_identify_ns_kv_specific_async_done(void *arg, const struct spdk_nvme_cpl *cpl)
+{
+	struct spdk_nvme_ns *ns = (struct spdk_nvme_ns *)arg;
+	struct spdk_nvme_ctrlr *ctrlr = ns->ctrlr;
+
+	if (spdk_nvme_cpl_is_error(cpl)) {
+		nvme_ns_free_kv_specific_data(ns);
+		nvme_ctrlr_set_state(ctrlr, NVME_CTRLR_STATE_ERROR, NVME_TIMEOUT_INFINITE);
+		return;
+	}
+
+	nvme_ctrlr_identify_namespaces_iocs_specific_next(ctrlr, ns->id);
+}
+
+static int
+nvme_ctrlr_identify_ns_kv_specific_async(struct spdk_nvme_ns *ns)
+{
+	struct spdk_nvme_ctrlr *ctrlr = ns->ctrlr;
+	int rc;
+
+	assert(!ns->nsdata_kv);
+	ns->nsdata_kv = spdk_zmalloc(sizeof(*ns->nsdata_kv), 64, NULL, SPDK_ENV_SOCKET_ID_ANY,
+				     SPDK_MALLOC_SHARE);
+	if (!ns->nsdata_kv) {
+		return -ENOMEM;
+	}
+
+	nvme_ctrlr_set_state(ctrlr, NVME_CTRLR_STATE_WAIT_FOR_IDENTIFY_NS_IOCS_SPECIFIC,
+			     ctrlr->opts.admin_timeout_ms);
+	rc = nvme_ctrlr_cmd_identify(ns->ctrlr, SPDK_NVME_IDENTIFY_NS_IOCS, 0, ns->id, ns->csi,
+				     ns->nsdata_kv, sizeof(*ns->nsdata_kv),
+				     nvme_ctrlr_identify_ns_kv_specific_async_done, ns);
+	if (rc) {
+		nvme_ns_free_kv_specific_data(ns);
+	}
+
+	return rc;
+}
+
+static int
+nvme_ctrlr_identify_ns_iocs_specific_async(struct spdk_nvme_ns *ns)
+{
+	switch (ns->csi) {
+	case SPDK_NVME_CSI_ZNS:
+		return nvme_ctrlr_identify_ns_zns_specific_async(ns);
+	case SPDK_NVME_CSI_KV:
+		return nvme_ctrlr_identify_ns_kv_specific_async(ns);
+	default:
+		/*
+		 * This switch must handle all cases for which
+		 * nvme_ns_has_supported_iocs_specific_data() returns true,
+		 * other cases should never happen.
+		 */
+		assert(0);
+		return -EINVAL;
+	}
+}
+
 static int
 nvme_ctrlr_identify_namespaces_iocs_specific(struct spdk_nvme_ctrlr *ctrlr)
 {
@@ -4139,6 +4188,7 @@ nvme_ctrlr_construct(struct spdk_nvme_ctrlr *ctrlr)
 
 	ctrlr->flags = 0;
 	ctrlr->free_io_qids = NULL;
+	ctrlr->numa_id = SPDK_ENV_SOCKET_ID_ANY;
 	ctrlr->is_resetting = false;
 	ctrlr->is_failed = false;
 	ctrlr->is_destructed = false;
@@ -4569,6 +4619,12 @@ spdk_nvme_ctrlr_get_max_xfer_size(const struct spdk_nvme_ctrlr *ctrlr)
 	return ctrlr->max_xfer_size;
 }
 
+int32_t
+spdk_nvme_ctrlr_get_numa_id(const struct spdk_nvme_ctrlr *ctrlr)
+{
+	return ctrlr->numa_id;
+}
+
 void
 spdk_nvme_ctrlr_register_aer_callback(struct spdk_nvme_ctrlr *ctrlr,
 				      spdk_nvme_aer_cb aer_cb_fn,
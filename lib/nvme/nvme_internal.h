@@ -281,7 +281,12 @@ struct nvme_request {
 	 * True if the request is in the queued_req list.
 	 */
 	uint8_t				queued : 1;
-	uint8_t				reserved : 6;
+
+	/**
+	 * True if the request was borrowed from the poll group's shared pool.
+	 */
+	uint8_t				shared : 1;
+	uint8_t				reserved : 5;
 
 	/**
 	 * Number of children requests still outstanding for this
@@ -446,10 +451,18 @@ struct spdk_nvme_qpair {
 	/* The user is destroying qpair */
 	uint8_t					destroy_in_progress: 1;
 
+	/* Connected to a poll group in interrupt mode without an fd to wait on, so the poll
+	 * group keeps polling it.
+	 */
+	uint8_t					no_intr_fd: 1;
+
 	enum spdk_nvme_transport_type		trtype;
 
 	uint32_t				num_outstanding_reqs;
 
+	/* Number of outstanding requests borrowed from req_pool */
+	uint32_t				num_shared_reqs;
+
 	/* request object used only for this qpair's FABRICS/CONNECT command (if needed) */
 	struct nvme_request			*reserved_req;
 
@@ -468,6 +481,9 @@ struct spdk_nvme_qpair {
 
 	struct spdk_nvme_transport_poll_group	*poll_group;
 
+	/* Shared request pool of the poll group, used once free_req is empty */
+	struct nvme_request_pool		*req_pool;
+
 	void					*poll_group_tailq_head;
 
 	const struct spdk_nvme_transport	*transport;
@@ -487,11 +503,26 @@ struct spdk_nvme_qpair {
 	void					*req_buf;
 };
 
+struct nvme_request_pool {
+	STAILQ_HEAD(, nvme_request)	free_req;
+	uint32_t			num_requests;
+	uint32_t			num_outstanding_reqs;
+	void				*req_buf;
+};
+
 struct spdk_nvme_poll_group {
 	void						*ctx;
 	struct spdk_nvme_accel_fn_table			accel_fn_table;
+	struct nvme_request_pool			*req_pool;
 	STAILQ_HEAD(, spdk_nvme_transport_poll_group)	tgroups;
 	bool						in_process_completions;
+	bool						in_submit_batch;
+	bool						enable_interrupts;
+	bool						enable_interrupts_is_valid;
+	/* Only used in interrupt mode */
+	struct spdk_fd_group				*fgrp;
+	int						event_fd;
+	bool						event_pending;
 };
 
 struct spdk_nvme_transport_poll_group {
@@ -538,6 +569,13 @@ struct spdk_nvme_ns {
 	/* Zoned Namespace Command Set Specific Identify Namespace data. */
 	struct spdk_nvme_zns_ns_data	*nsdata_zns;
 
+	/* Key Value Command Set Specific Identify Namespace data. */
+	struct spdk_nvme_kv_ns_data	*nsdata_kv;
+
+	/* Flexible Data Placement placement identifiers */
+	uint16_t			*fdp_pids;
+	uint16_t			num_fdp_pids;
+
 	RB_ENTRY(spdk_nvme_ns)		node;
 };
 
@@ -976,6 +1014,9 @@ struct spdk_nvme_ctrlr {
 
 	uint64_t			quirks;
 
+	/* NUMA node the controller is attached to, SPDK_ENV_SOCKET_ID_ANY if unknown */
+	int32_t				numa_id;
+
 	/* Extra sleep time during controller initialization */
 	uint64_t			sleep_timeout_tsc;
 
@@ -1118,6 +1159,7 @@ nvme_robust_mutex_unlock(pthread_mutex_t *mtx)
 /* Poll group management functions. */
 int nvme_poll_group_connect_qpair(struct spdk_nvme_qpair *qpair);
 int nvme_poll_group_disconnect_qpair(struct spdk_nvme_qpair *qpair);
+void nvme_poll_group_kick(struct spdk_nvme_poll_group *group);
 
 /* Admin functions */
 int	nvme_ctrlr_cmd_identify(struct spdk_nvme_ctrlr *ctrlr,
@@ -1228,6 +1270,7 @@ int	nvme_ctrlr_identify_active_ns(struct spdk_nvme_ctrlr *ctrlr);
 void	nvme_ns_set_identify_data(struct spdk_nvme_ns *ns);
 void	nvme_ns_set_id_desc_list_data(struct spdk_nvme_ns *ns);
 void	nvme_ns_free_zns_specific_data(struct spdk_nvme_ns *ns);
+void	nvme_ns_free_kv_specific_data(struct spdk_nvme_ns *ns);
 void	nvme_ns_free_iocs_specific_data(struct spdk_nvme_ns *ns);
 bool	nvme_ns_has_supported_iocs_specific_data(struct spdk_nvme_ns *ns);
 int	nvme_ns_construct(struct spdk_nvme_ns *ns, uint32_t id,
@@ -1280,19 +1323,68 @@ int	nvme_ctrlr_parse_ana_log_page(struct spdk_nvme_ctrlr *ctrlr,
 		req->accel_sequence = NULL;		\
 	} while (0);
 
+static inline struct nvme_request *
+nvme_request_pool_get(struct spdk_nvme_qpair *qpair)
+{
+	struct nvme_request_pool *pool = qpair->req_pool;
+	struct nvme_request *req;
+
+	if (pool == NULL) {
+		return NULL;
+	}
+
+	req = STAILQ_FIRST(&pool->free_req);
+	if (req == NULL) {
+		return NULL;
+	}
+
+	STAILQ_REMOVE_HEAD(&pool->free_req, stailq);
+	pool->num_outstanding_reqs++;
+	qpair->num_shared_reqs++;
+	req->qpair = qpair;
+
+	return req;
+}
+
+static inline void
+nvme_request_pool_put(struct nvme_request *req, struct spdk_nvme_qpair *qpair)
+{
+	struct nvme_request_pool *pool = qpair->req_pool;
+
+	assert(pool != NULL);
+	assert(pool->num_outstanding_reqs > 0);
+	assert(qpair->num_shared_reqs > 0);
+
+	STAILQ_INSERT_HEAD(&pool->free_req, req, stailq);
+	pool->num_outstanding_reqs--;
+
+	/* A qpair removed from its poll group keeps the pool until it returned
+	 * everything it borrowed.
+	 */
+	if (--qpair->num_shared_reqs == 0 && qpair->poll_group == NULL) {
+		qpair->req_pool = NULL;
+	}
+}
+
 static inline struct nvme_request *
 nvme_allocate_request(struct spdk_nvme_qpair *qpair,
 		      const struct nvme_payload *payload, uint32_t payload_size, uint32_t md_size,
 		      spdk_nvme_cmd_cb cb_fn, void *cb_arg)
 {
 	struct nvme_request *req;
+	bool shared = false;
 
 	req = STAILQ_FIRST(&qpair->free_req);
-	if (req == NULL) {
-		return req;
+	if (spdk_likely(req != NULL)) {
+		STAILQ_REMOVE_HEAD(&qpair->free_req, stailq);
+	} else {
+		req = nvme_request_pool_get(qpair);
+		if (req == NULL) {
+			return req;
+		}
+		shared = true;
 	}
 
-	STAILQ_REMOVE_HEAD(&qpair->free_req, stailq);
 	qpair->num_outstanding_reqs++;
 
 	/*
@@ -1308,6 +1400,8 @@ nvme_allocate_request(struct spdk_nvme_qpair *qpair,
 	 */
 	memset(req, 0, offsetof(struct nvme_request, payload_size));
 
+	req->shared = shared;
+
 	NVME_INIT_REQUEST(req, cb_fn, cb_arg, *payload, payload_size, md_size);
 
 	return req;
@@ -1346,7 +1440,11 @@ _nvme_free_request(struct nvme_request *req, struct spdk_nvme_qpair *qpair)
 	 * saved only for use with a FABRICS/CONNECT command.
 	 */
 	if (spdk_likely(qpair->reserved_req != req)) {
-		STAILQ_INSERT_HEAD(&qpair->free_req, req, stailq);
+		if (spdk_likely(!req->shared)) {
+			STAILQ_INSERT_HEAD(&qpair->free_req, req, stailq);
+		} else {
+			nvme_request_pool_put(req, qpair);
+		}
 
 		assert(qpair->num_outstanding_reqs > 0);
 		qpair->num_outstanding_reqs--;
@@ -1577,6 +1675,7 @@ void nvme_transport_admin_qpair_abort_aers(struct spdk_nvme_qpair *qpair);
 int nvme_transport_qpair_iterate_requests(struct spdk_nvme_qpair *qpair,
 		int (*iter_fn)(struct nvme_request *req, void *arg),
 		void *arg);
+int nvme_transport_qpair_get_fd(struct spdk_nvme_qpair *qpair);
 
 struct spdk_nvme_transport_poll_group *nvme_transport_poll_group_create(
 	const struct spdk_nvme_transport *transport);
@@ -1596,6 +1695,7 @@ int nvme_transport_poll_group_get_stats(struct spdk_nvme_transport_poll_group *t
 					struct spdk_nvme_transport_poll_group_stat **stats);
 void nvme_transport_poll_group_free_stats(struct spdk_nvme_transport_poll_group *tgroup,
 		struct spdk_nvme_transport_poll_group_stat *stats);
+void nvme_transport_poll_group_submit_batch_end(struct spdk_nvme_transport_poll_group *tgroup);
 enum spdk_nvme_transport_type nvme_transport_get_trtype(const struct spdk_nvme_transport
 		*transport);
 /*
@@ -1618,4 +1718,25 @@ _is_page_aligned(uint64_t address, uint64_t page_size)
 	return (address & (page_size - 1)) == 0;
 }
 
+/*
+ * Allocate memory on the NUMA node of the controller, falling back to any node if that node
+ * is unknown or out of memory.
+ */
+static inline void *
+nvme_ctrlr_zmalloc_local(struct spdk_nvme_ctrlr *ctrlr, size_t size, size_t align,
+			 uint32_t flags)
+{
+	void *buf = NULL;
+
+	if (ctrlr->numa_id != SPDK_ENV_SOCKET_ID_ANY) {
+		buf = spdk_zmalloc(size, align, NULL, ctrlr->numa_id, flags);
+	}
+
+	if (buf == NULL) {
+		buf = spdk_zmalloc(size, align, NULL, SPDK_ENV_SOCKET_ID_ANY, flags);
+	}
+
+	return buf;
+}
+
 #endif /* __NVME_INTERNAL_H__ */
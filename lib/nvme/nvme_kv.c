@@ -0,0 +1,113 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 the SPDK authors.
+ */
+
+#include "spdk/nvme_kv.h"
+#include "nvme_internal.h"
+
+const struct spdk_nvme_kv_ns_data *
+spdk_nvme_kv_ns_get_data(struct spdk_nvme_ns *ns)
+{
+	return ns->nsdata_kv;
+}
+
+uint32_t
+spdk_nvme_kv_ns_get_max_key_len(struct spdk_nvme_ns *ns)
+{
+	const struct spdk_nvme_kv_ns_data *nsdata_kv = spdk_nvme_kv_ns_get_data(ns);
+
+	return nsdata_kv->kvf[0].kvkml;
+}
+
+uint32_t
+spdk_nvme_kv_ns_get_max_value_len(struct spdk_nvme_ns *ns)
+{
+	const struct spdk_nvme_kv_ns_data *nsdata_kv = spdk_nvme_kv_ns_get_data(ns);
+
+	return nsdata_kv->kvf[0].kvvml;
+}
+
+static int
+nvme_kv_cmd(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair, uint8_t opc,
+	    const void *key, uint32_t key_len, void *buffer, uint32_t buffer_size,
+	    uint8_t cmd_opts, spdk_nvme_cmd_cb cb_fn, void *cb_arg)
+{
+	struct nvme_request *req;
+	struct spdk_nvme_cmd *cmd;
+	uint8_t kv_key[SPDK_NVME_KV_KEY_MAX_LEN] = {};
+
+	if (key == NULL || key_len == 0 || key_len > SPDK_NVME_KV_KEY_MAX_LEN) {
+		return -EINVAL;
+	}
+
+	req = nvme_allocate_request_contig(qpair, buffer, buffer_size, cb_fn, cb_arg);
+	if (req == NULL) {
+		return -ENOMEM;
+	}
+
+	memcpy(kv_key, key, key_len);
+
+	cmd = &req->cmd;
+	cmd->opc = opc;
+	cmd->nsid = ns->id;
+
+	/* The first 8 bytes of the key go to dwords 2-3, and the last 8 bytes to dwords 14-15. */
+	memcpy(&cmd->rsvd2, &kv_key[0], 4);
+	memcpy(&cmd->rsvd3, &kv_key[4], 4);
+	memcpy(&cmd->cdw14, &kv_key[8], 4);
+	memcpy(&cmd->cdw15, &kv_key[12], 4);
+
+	cmd->cdw10 = buffer_size;
+	cmd->cdw11 = key_len | (uint32_t)cmd_opts << 8;
+
+	return nvme_qpair_submit_request(qpair, req);
+}
+
+int
+spdk_nvme_kv_store(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
+		   const void *key, uint32_t key_len, void *buffer, uint32_t buffer_size,
+		   uint32_t store_opts, spdk_nvme_cmd_cb cb_fn, void *cb_arg)
+{
+	if (store_opts & ~(SPDK_NVME_KV_STORE_MUST_EXIST | SPDK_NVME_KV_STORE_MUST_NOT_EXIST)) {
+		return -EINVAL;
+	}
+
+	return nvme_kv_cmd(ns, qpair, SPDK_NVME_OPC_KV_STORE, key, key_len, buffer, buffer_size,
+			   store_opts, cb_fn, cb_arg);
+}
+
+int
+spdk_nvme_kv_retrieve(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
+		      const void *key, uint32_t key_len, void *buffer, uint32_t buffer_size,
+		      spdk_nvme_cmd_cb cb_fn, void *cb_arg)
+{
+	return nvme_kv_cmd(ns, qpair, SPDK_NVME_OPC_KV_RETRIEVE, key, key_len, buffer, buffer_size,
+			   0, cb_fn, cb_arg);
+}
+
+int
+spdk_nvme_kv_delete(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
+		    const void *key, uint32_t key_len,
+		    spdk_nvme_cmd_cb cb_fn, void *cb_arg)
+{
+	return nvme_kv_cmd(ns, qpair, SPDK_NVME_OPC_KV_DELETE, key, key_len, NULL, 0,
+			   0, cb_fn, cb_arg);
+}
+
+int
+spdk_nvme_kv_exist(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
+		   const void *key, uint32_t key_len,
+		   spdk_nvme_cmd_cb cb_fn, void *cb_arg)
+{
+	return nvme_kv_cmd(ns, qpair, SPDK_NVME_OPC_KV_EXIST, key, key_len, NULL, 0,
+			   0, cb_fn, cb_arg);
+}
+
+int
+spdk_nvme_kv_list(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
+		  const void *key, uint32_t key_len, void *buffer, uint32_t buffer_size,
+		  spdk_nvme_cmd_cb cb_fn, void *cb_arg)
+{
+	return nvme_kv_cmd(ns, qpair, SPDK_NVME_OPC_KV_LIST, key, key_len, buffer, buffer_size,
+			   0, cb_fn, cb_arg);
+}
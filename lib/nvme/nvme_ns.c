@@ -132,11 +132,16 @@ nvme_ctrlr_identify_ns_iocs_specific(struct spdk_nvme_ns *ns)
 {
 	struct nvme_completion_poll_status *status;
 	struct spdk_nvme_ctrlr *ctrlr = ns->ctrlr;
-	struct spdk_nvme_zns_ns_data *nsdata_zns;
+	void *nsdata_iocs;
+	size_t nsdata_iocs_size;
 	int rc;
 
 	switch (ns->csi) {
 	case SPDK_NVME_CSI_ZNS:
+		nsdata_iocs_size = sizeof(struct spdk_nvme_zns_ns_data);
+		break;
+	case SPDK_NVME_CSI_KV:
+		nsdata_iocs_size = sizeof(struct spdk_nvme_kv_ns_data);
 		break;
 	default:
 		/*
@@ -145,42 +150,48 @@ nvme_ctrlr_identify_ns_iocs_specific(struct spdk_nvme_ns *ns)
 		 * other cases should never happen.
 		 */
 		assert(0);
+		return -EINVAL;
 	}
 
-	nvme_ns_free_zns_specific_data(ns);
+	nvme_ns_free_iocs_specific_data(ns);
 
-	nsdata_zns = spdk_zmalloc(sizeof(*nsdata_zns), 64, NULL, SPDK_ENV_SOCKET_ID_ANY,
-				  SPDK_MALLOC_SHARE);
-	if (!nsdata_zns) {
+	nsdata_iocs = spdk_zmalloc(nsdata_iocs_size, 64, NULL, SPDK_ENV_SOCKET_ID_ANY,
+				   SPDK_MALLOC_SHARE);
+	if (!nsdata_iocs) {
 		return -ENOMEM;
 	}
 
 	status = calloc(1, sizeof(*status));
 	if (!status) {
 		SPDK_ERRLOG("Failed to allocate status tracker\n");
-		spdk_free(nsdata_zns);
+		spdk_free(nsdata_iocs);
 		return -ENOMEM;
 	}
 
 	rc = nvme_ctrlr_cmd_identify(ctrlr, SPDK_NVME_IDENTIFY_NS_IOCS, 0, ns->id, ns->csi,
-				     nsdata_zns, sizeof(*nsdata_zns),
+				     nsdata_iocs, nsdata_iocs_size,
 				     nvme_completion_poll_cb, status);
 	if (rc != 0) {
-		spdk_free(nsdata_zns);
+		spdk_free(nsdata_iocs);
 		free(status);
 		return rc;
 	}
 
 	if (nvme_wait_for_completion_robust_lock(ctrlr->adminq, status, &ctrlr->ctrlr_lock)) {
 		SPDK_ERRLOG("Failed to retrieve Identify IOCS Specific Namespace Data Structure\n");
-		spdk_free(nsdata_zns);
+		spdk_free(nsdata_iocs);
 		if (!status->timed_out) {
 			free(status);
 		}
 		return -ENXIO;
 	}
 	free(status);
-	ns->nsdata_zns = nsdata_zns;
+
+	if (ns->csi == SPDK_NVME_CSI_ZNS) {
+		ns->nsdata_zns = nsdata_iocs;
+	} else {
+		ns->nsdata_kv = nsdata_iocs;
+	}
 
 	return 0;
 }
@@ -477,10 +488,24 @@ nvme_ns_free_zns_specific_data(struct spdk_nvme_ns *ns)
 	}
 }
 
+void
+nvme_ns_free_kv_specific_data(struct spdk_nvme_ns *ns)
+{
+	if (!ns->id) {
+		return;
+	}
+
+	if (ns->nsdata_kv) {
+		spdk_free(ns->nsdata_kv);
+		ns->nsdata_kv = NULL;
+	}
+}
+
 void
 nvme_ns_free_iocs_specific_data(struct spdk_nvme_ns *ns)
 {
 	nvme_ns_free_zns_specific_data(ns);
+	nvme_ns_free_kv_specific_data(ns);
 }
 
 bool
@@ -494,6 +519,7 @@ nvme_ns_has_supported_iocs_specific_data(struct spdk_nvme_ns *ns)
 		 */
 		return false;
 	case SPDK_NVME_CSI_ZNS:
+	case SPDK_NVME_CSI_KV:
 		return true;
 	default:
 		SPDK_WARNLOG("Unsupported CSI: %u for NSID: %u\n", ns->csi, ns->id);
@@ -512,6 +538,134 @@ spdk_nvme_ns_get_ana_state(const struct spdk_nvme_ns *ns) {
 	return ns->ana_state;
 }
 
+struct nvme_ns_placement_ids_ctx {
+	struct spdk_nvme_ns		*ns;
+	struct spdk_nvme_qpair		*qpair;
+	struct spdk_nvme_fdp_ruhs	*ruhs;
+	uint32_t			size;
+	spdk_nvme_ns_placement_ids_cb	cb_fn;
+	void				*cb_arg;
+};
+
+static void nvme_ns_get_ruhs_done(void *cb_arg, const struct spdk_nvme_cpl *cpl);
+
+static int
+nvme_ns_get_ruhs(struct nvme_ns_placement_ids_ctx *ctx, uint32_t size)
+{
+	free(ctx->ruhs);
+	ctx->ruhs = calloc(1, size);
+	if (ctx->ruhs == NULL) {
+		return -ENOMEM;
+	}
+	ctx->size = size;
+
+	return spdk_nvme_ns_cmd_io_mgmt_recv(ctx->ns, ctx->qpair, ctx->ruhs, size,
+					     SPDK_NVME_FDP_IO_MGMT_RECV_RUHS, 0,
+					     nvme_ns_get_ruhs_done, ctx);
+}
+
+static void
+nvme_ns_update_placement_ids_done(struct nvme_ns_placement_ids_ctx *ctx, int rc)
+{
+	if (rc != 0) {
+		SPDK_DEBUGLOG(nvme, "Failed to get the placement ids of ns %u: %d\n", ctx->ns->id, rc);
+	}
+
+	ctx->cb_fn(ctx->cb_arg, rc);
+	free(ctx->ruhs);
+	free(ctx);
+}
+
+static void
+nvme_ns_get_ruhs_done(void *cb_arg, const struct spdk_nvme_cpl *cpl)
+{
+	struct nvme_ns_placement_ids_ctx *ctx = cb_arg;
+	struct spdk_nvme_ns *ns = ctx->ns;
+	uint16_t *pids = NULL;
+	uint16_t i, nruhsd;
+	int rc;
+
+	if (spdk_nvme_cpl_is_error(cpl)) {
+		nvme_ns_update_placement_ids_done(ctx, -EIO);
+		return;
+	}
+
+	nruhsd = ctx->ruhs->nruhsd;
+	if (nruhsd != 0 && ctx->size == sizeof(*ctx->ruhs)) {
+		/* Only the header was read, now get the descriptors */
+		rc = nvme_ns_get_ruhs(ctx, sizeof(*ctx->ruhs) + nruhsd * sizeof(ctx->ruhs->ruhs_desc[0]));
+		if (rc != 0) {
+			nvme_ns_update_placement_ids_done(ctx, rc);
+		}
+		return;
+	}
+
+	/* The number of descriptors may have changed since the header was read */
+	nruhsd = spdk_min(nruhsd, (ctx->size - sizeof(*ctx->ruhs)) / sizeof(ctx->ruhs->ruhs_desc[0]));
+	if (nruhsd != 0) {
+		pids = calloc(nruhsd, sizeof(*pids));
+		if (pids == NULL) {
+			nvme_ns_update_placement_ids_done(ctx, -ENOMEM);
+			return;
+		}
+	}
+
+	for (i = 0; i < nruhsd; i++) {
+		pids[i] = ctx->ruhs->ruhs_desc[i].pid;
+	}
+
+	free(ns->fdp_pids);
+	ns->fdp_pids = pids;
+	ns->num_fdp_pids = nruhsd;
+
+	nvme_ns_update_placement_ids_done(ctx, 0);
+}
+
+int
+spdk_nvme_ns_update_placement_ids(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
+				  spdk_nvme_ns_placement_ids_cb cb_fn, void *cb_arg)
+{
+	struct nvme_ns_placement_ids_ctx *ctx;
+	int rc;
+
+	if (!ns->ctrlr->cdata.ctratt.fdps) {
+		return -ENOTSUP;
+	}
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		return -ENOMEM;
+	}
+
+	ctx->ns = ns;
+	ctx->qpair = qpair;
+	ctx->cb_fn = cb_fn;
+	ctx->cb_arg = cb_arg;
+
+	/* Read the header first to learn the number of reclaim unit handle status descriptors */
+	rc = nvme_ns_get_ruhs(ctx, sizeof(*ctx->ruhs));
+	if (rc != 0) {
+		free(ctx->ruhs);
+		free(ctx);
+	}
+
+	return rc;
+}
+
+uint16_t
+spdk_nvme_ns_get_num_placement_ids(const struct spdk_nvme_ns *ns)
+{
+	return ns->num_fdp_pids;
+}
+
+uint16_t
+spdk_nvme_ns_get_placement_id(const struct spdk_nvme_ns *ns, uint16_t index)
+{
+	assert(index < ns->num_fdp_pids);
+
+	return ns->fdp_pids[index];
+}
+
 int
 nvme_ns_construct(struct spdk_nvme_ns *ns, uint32_t id,
 		  struct spdk_nvme_ctrlr *ctrlr)
@@ -564,6 +718,9 @@ nvme_ns_destruct(struct spdk_nvme_ns *ns)
 	memset(nsdata, 0, sizeof(*nsdata));
 	memset(ns->id_desc_list, 0, sizeof(ns->id_desc_list));
 	nvme_ns_free_iocs_specific_data(ns);
+	free(ns->fdp_pids);
+	ns->fdp_pids = NULL;
+	ns->num_fdp_pids = 0;
 	ns->sector_size = 0;
 	ns->extended_lba_size = 0;
 	ns->md_size = 0;
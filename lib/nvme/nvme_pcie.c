@@ -15,6 +15,11 @@
 #include "nvme_internal.h"
 #include "nvme_pcie_internal.h"
 
+#define NVME_PCIE_STATUS_OFFSET		0x06
+#define NVME_PCIE_STATUS_CAP_LIST	0x10
+#define NVME_PCIE_CAP_PTR_OFFSET	0x34
+#define NVME_PCIE_CAP_ID_MSIX		0x11
+
 struct nvme_pcie_enum_ctx {
 	struct spdk_nvme_probe_ctx *probe_ctx;
 	struct spdk_pci_addr pci_addr;
@@ -886,6 +891,90 @@ nvme_pcie_ctrlr_scan(struct spdk_nvme_probe_ctx *probe_ctx,
 	}
 }
 
+static uint32_t
+nvme_pcie_ctrlr_get_msix_table_size(struct spdk_pci_device *pci_dev)
+{
+	uint16_t status, msgctl;
+	uint8_t pos, id;
+	int i;
+
+	spdk_pci_device_cfg_read16(pci_dev, &status, NVME_PCIE_STATUS_OFFSET);
+	if (!(status & NVME_PCIE_STATUS_CAP_LIST)) {
+		return 0;
+	}
+
+	spdk_pci_device_cfg_read8(pci_dev, &pos, NVME_PCIE_CAP_PTR_OFFSET);
+	/* Bound the walk in case of a malformed capability list */
+	for (i = 0; i < 48 && pos >= 0x40; i++) {
+		pos &= ~0x3;
+		spdk_pci_device_cfg_read8(pci_dev, &id, pos);
+		if (id == NVME_PCIE_CAP_ID_MSIX) {
+			spdk_pci_device_cfg_read16(pci_dev, &msgctl, pos + 2);
+			return (msgctl & 0x7ff) + 1;
+		}
+		spdk_pci_device_cfg_read8(pci_dev, &pos, pos + 1);
+	}
+
+	return 0;
+}
+
+/* Vector 0 stays with the admin queue, each I/O queue gets its own vector */
+static int
+nvme_pcie_ctrlr_enable_interrupts(struct nvme_pcie_ctrlr *pctrlr)
+{
+	uint32_t i, num_vectors;
+	int rc, efd;
+
+	num_vectors = nvme_pcie_ctrlr_get_msix_table_size(pctrlr->devhandle);
+	if (num_vectors < 2) {
+		SPDK_DEBUGLOG(nvme, "MSI-X isn't supported by %s\n", pctrlr->ctrlr.trid.traddr);
+		return -ENOTSUP;
+	}
+
+	num_vectors = spdk_min(num_vectors - 1, pctrlr->ctrlr.opts.num_io_queues);
+	pctrlr->intr_efds = calloc(num_vectors, sizeof(*pctrlr->intr_efds));
+	if (pctrlr->intr_efds == NULL) {
+		return -ENOMEM;
+	}
+
+	rc = spdk_pci_device_enable_interrupts(pctrlr->devhandle, num_vectors);
+	if (rc != 0) {
+		SPDK_ERRLOG("Failed to enable the interrupts of %s: %d\n", pctrlr->ctrlr.trid.traddr, rc);
+		goto err;
+	}
+
+	for (i = 0; i < num_vectors; i++) {
+		efd = spdk_pci_device_get_interrupt_efd_by_index(pctrlr->devhandle, i + 1);
+		if (efd < 0) {
+			rc = efd;
+			spdk_pci_device_disable_interrupts(pctrlr->devhandle);
+			goto err;
+		}
+		pctrlr->intr_efds[i] = efd;
+	}
+
+	pctrlr->num_intr_efds = num_vectors;
+
+	return 0;
+err:
+	free(pctrlr->intr_efds);
+	pctrlr->intr_efds = NULL;
+	return rc;
+}
+
+static void
+nvme_pcie_ctrlr_disable_interrupts(struct nvme_pcie_ctrlr *pctrlr)
+{
+	if (pctrlr->num_intr_efds == 0) {
+		return;
+	}
+
+	spdk_pci_device_disable_interrupts(pctrlr->devhandle);
+	free(pctrlr->intr_efds);
+	pctrlr->intr_efds = NULL;
+	pctrlr->num_intr_efds = 0;
+}
+
 static struct spdk_nvme_ctrlr *
 	nvme_pcie_ctrlr_construct(const struct spdk_nvme_transport_id *trid,
 			  const struct spdk_nvme_ctrlr_opts *opts,
@@ -930,6 +1019,8 @@ static struct spdk_nvme_ctrlr *
 		return NULL;
 	}
 
+	pctrlr->ctrlr.numa_id = spdk_pci_device_get_socket_id(pci_dev);
+
 	rc = nvme_pcie_ctrlr_allocate_bars(pctrlr);
 	if (rc != 0) {
 		spdk_pci_device_unclaim(pci_dev);
@@ -966,6 +1057,20 @@ static struct spdk_nvme_ctrlr *
 		return NULL;
 	}
 
+	if (pctrlr->ctrlr.opts.enable_interrupts) {
+		rc = nvme_pcie_ctrlr_enable_interrupts(pctrlr);
+		if (rc == -ENOMEM) {
+			nvme_ctrlr_destruct(&pctrlr->ctrlr);
+			return NULL;
+		}
+		if (rc != 0) {
+			/* E.g. no MSI-X or a uio driver, the I/O qpairs will be polled */
+			SPDK_NOTICELOG("Interrupts are not available for %s, polling its qpairs\n",
+				       pctrlr->ctrlr.trid.traddr);
+			pctrlr->ctrlr.opts.enable_interrupts = false;
+		}
+	}
+
 	if (g_sigset != true) {
 		spdk_pci_register_error_handler(nvme_sigbus_fault_sighandler,
 						NULL);
@@ -1021,6 +1126,8 @@ nvme_pcie_ctrlr_destruct(struct spdk_nvme_ctrlr *ctrlr)
 
 	nvme_pcie_ctrlr_free_bars(pctrlr);
 
+	nvme_pcie_ctrlr_disable_interrupts(pctrlr);
+
 	if (devhandle) {
 		spdk_pci_device_unclaim(devhandle);
 		spdk_pci_device_detach(devhandle);
@@ -1110,6 +1217,7 @@ const struct spdk_nvme_transport_ops pcie_ops = {
 	.qpair_submit_request = nvme_pcie_qpair_submit_request,
 	.qpair_process_completions = nvme_pcie_qpair_process_completions,
 	.qpair_iterate_requests = nvme_pcie_qpair_iterate_requests,
+	.qpair_get_fd = nvme_pcie_qpair_get_fd,
 	.admin_qpair_abort_aers = nvme_pcie_admin_qpair_abort_aers,
 
 	.poll_group_create = nvme_pcie_poll_group_create,
@@ -1120,7 +1228,8 @@ const struct spdk_nvme_transport_ops pcie_ops = {
 	.poll_group_process_completions = nvme_pcie_poll_group_process_completions,
 	.poll_group_destroy = nvme_pcie_poll_group_destroy,
 	.poll_group_get_stats = nvme_pcie_poll_group_get_stats,
-	.poll_group_free_stats = nvme_pcie_poll_group_free_stats
+	.poll_group_free_stats = nvme_pcie_poll_group_free_stats,
+	.poll_group_submit_batch_end = nvme_pcie_poll_group_submit_batch_end
 };
 
 SPDK_NVME_TRANSPORT_REGISTER(pcie, &pcie_ops);
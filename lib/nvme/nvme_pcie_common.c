@@ -158,7 +158,7 @@ nvme_pcie_qpair_construct(struct spdk_nvme_qpair *qpair,
 			 */
 			queue_len = pqpair->num_entries * sizeof(struct spdk_nvme_cmd);
 			queue_align = spdk_max(spdk_align32pow2(queue_len), page_align);
-			pqpair->cmd = spdk_zmalloc(queue_len, queue_align, NULL, SPDK_ENV_SOCKET_ID_ANY, flags);
+			pqpair->cmd = nvme_ctrlr_zmalloc_local(ctrlr, queue_len, queue_align, flags);
 			if (pqpair->cmd == NULL) {
 				SPDK_ERRLOG("alloc qpair_cmd failed\n");
 				return -ENOMEM;
@@ -181,7 +181,7 @@ nvme_pcie_qpair_construct(struct spdk_nvme_qpair *qpair,
 	} else {
 		queue_len = pqpair->num_entries * sizeof(struct spdk_nvme_cpl);
 		queue_align = spdk_max(spdk_align32pow2(queue_len), page_align);
-		pqpair->cpl = spdk_zmalloc(queue_len, queue_align, NULL, SPDK_ENV_SOCKET_ID_ANY, flags);
+		pqpair->cpl = nvme_ctrlr_zmalloc_local(ctrlr, queue_len, queue_align, flags);
 		if (pqpair->cpl == NULL) {
 			SPDK_ERRLOG("alloc qpair_cpl failed\n");
 			return -ENOMEM;
@@ -207,8 +207,8 @@ nvme_pcie_qpair_construct(struct spdk_nvme_qpair *qpair,
 	 *   This ensures the PRP list embedded in the nvme_tracker object will not span a
 	 *   4KB boundary, while allowing access to trackers in tr[] via normal array indexing.
 	 */
-	pqpair->tr = spdk_zmalloc(num_trackers * sizeof(*tr), sizeof(*tr), NULL,
-				  SPDK_ENV_SOCKET_ID_ANY, SPDK_MALLOC_SHARE);
+	pqpair->tr = nvme_ctrlr_zmalloc_local(ctrlr, num_trackers * sizeof(*tr), sizeof(*tr),
+					      SPDK_MALLOC_SHARE);
 	if (pqpair->tr == NULL) {
 		SPDK_ERRLOG("nvme_tr failed\n");
 		return -ENOMEM;
@@ -350,6 +350,11 @@ nvme_pcie_ctrlr_cmd_create_io_cq(struct spdk_nvme_ctrlr *ctrlr,
 	cmd->cdw10_bits.create_io_q.qsize = pqpair->num_entries - 1;
 
 	cmd->cdw11_bits.create_io_cq.pc = 1;
+	if (io_que->id <= nvme_pcie_ctrlr(ctrlr)->num_intr_efds) {
+		cmd->cdw11_bits.create_io_cq.ien = 1;
+		cmd->cdw11_bits.create_io_cq.iv = io_que->id;
+		pqpair->flags.intr_enabled = 1;
+	}
 	cmd->dptr.prp.prp1 = pqpair->cpl_bus_addr;
 
 	return nvme_ctrlr_submit_admin_request(ctrlr, req);
@@ -657,7 +662,7 @@ nvme_pcie_qpair_submit_tracker(struct spdk_nvme_qpair *qpair, struct nvme_tracke
 		SPDK_ERRLOG("sq_tail is passing sq_head!\n");
 	}
 
-	if (!pqpair->flags.delay_cmd_submit) {
+	if (!pqpair->flags.delay_cmd_submit && !nvme_pcie_qpair_in_submit_batch(qpair)) {
 		nvme_pcie_qpair_ring_sq_doorbell(qpair);
 	}
 }
@@ -821,6 +826,32 @@ nvme_pcie_qpair_check_timeout(struct spdk_nvme_qpair *qpair)
 	}
 }
 
+static void
+nvme_pcie_qpair_clear_interrupt(struct spdk_nvme_qpair *qpair)
+{
+	struct nvme_pcie_ctrlr *pctrlr = nvme_pcie_ctrlr(qpair->ctrlr);
+	uint64_t count;
+
+	assert(qpair->id > 0 && qpair->id <= pctrlr->num_intr_efds);
+	/* The event fds are non-blocking, EAGAIN just means that no interrupt was raised */
+	if (read(pctrlr->intr_efds[qpair->id - 1], &count, sizeof(count)) < 0 && errno != EAGAIN) {
+		SPDK_ERRLOG("Failed to clear the interrupt of qpair %u: %s\n", qpair->id,
+			    spdk_strerror(errno));
+	}
+}
+
+int
+nvme_pcie_qpair_get_fd(struct spdk_nvme_qpair *qpair)
+{
+	struct nvme_pcie_ctrlr *pctrlr = nvme_pcie_ctrlr(qpair->ctrlr);
+
+	if (nvme_qpair_is_admin_queue(qpair) || qpair->id > pctrlr->num_intr_efds) {
+		return -ENOTSUP;
+	}
+
+	return pctrlr->intr_efds[qpair->id - 1];
+}
+
 int32_t
 nvme_pcie_qpair_process_completions(struct spdk_nvme_qpair *qpair, uint32_t max_completions)
 {
@@ -867,6 +898,10 @@ nvme_pcie_qpair_process_completions(struct spdk_nvme_qpair *qpair, uint32_t max_
 		nvme_robust_mutex_lock(&ctrlr->ctrlr_lock);
 	}
 
+	if (spdk_unlikely(pqpair->flags.intr_enabled)) {
+		nvme_pcie_qpair_clear_interrupt(qpair);
+	}
+
 	if (max_completions == 0 || max_completions > pqpair->max_completions_cap) {
 		/*
 		 * max_completions == 0 means unlimited, but complete at most
@@ -941,10 +976,15 @@ nvme_pcie_qpair_process_completions(struct spdk_nvme_qpair *qpair, uint32_t max_
 		pqpair->stat->idle_polls++;
 	}
 
-	if (pqpair->flags.delay_cmd_submit) {
+	if (spdk_unlikely(pqpair->flags.intr_enabled) && num_completions == max_completions &&
+	    qpair->poll_group != NULL) {
+		/* The interrupt was already cleared, come back for the remaining completions */
+		nvme_poll_group_kick(qpair->poll_group->group);
+	}
+
+	if (pqpair->flags.delay_cmd_submit && !nvme_pcie_qpair_in_submit_batch(qpair)) {
 		if (pqpair->last_sq_tail != pqpair->sq_tail) {
 			nvme_pcie_qpair_ring_sq_doorbell(qpair);
-			pqpair->last_sq_tail = pqpair->sq_tail;
 		}
 	}
 
@@ -1039,14 +1079,14 @@ nvme_pcie_ctrlr_create_io_qpair(struct spdk_nvme_ctrlr *ctrlr, uint16_t qid,
 
 	assert(ctrlr != NULL);
 
-	pqpair = spdk_zmalloc(sizeof(*pqpair), 64, NULL,
-			      SPDK_ENV_SOCKET_ID_ANY, SPDK_MALLOC_SHARE);
+	pqpair = nvme_ctrlr_zmalloc_local(ctrlr, sizeof(*pqpair), 64, SPDK_MALLOC_SHARE);
 	if (pqpair == NULL) {
 		return NULL;
 	}
 
 	pqpair->num_entries = opts->io_queue_size;
-	pqpair->flags.delay_cmd_submit = opts->delay_cmd_submit;
+	/* Nothing would ring the delayed doorbells while waiting for an interrupt */
+	pqpair->flags.delay_cmd_submit = opts->delay_cmd_submit && !ctrlr->opts.enable_interrupts;
 
 	qpair = &pqpair->qpair;
 
@@ -1768,6 +1808,20 @@ nvme_pcie_poll_group_process_completions(struct spdk_nvme_transport_poll_group *
 	return total_completions;
 }
 
+void
+nvme_pcie_poll_group_submit_batch_end(struct spdk_nvme_transport_poll_group *tgroup)
+{
+	struct spdk_nvme_qpair *qpair;
+	struct nvme_pcie_qpair *pqpair;
+
+	STAILQ_FOREACH(qpair, &tgroup->connected_qpairs, poll_group_stailq) {
+		pqpair = nvme_pcie_qpair(qpair);
+		if (pqpair->last_sq_tail != pqpair->sq_tail) {
+			nvme_pcie_qpair_ring_sq_doorbell(qpair);
+		}
+	}
+}
+
 int
 nvme_pcie_poll_group_destroy(struct spdk_nvme_transport_poll_group *tgroup)
 {
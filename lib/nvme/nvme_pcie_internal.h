@@ -75,6 +75,10 @@ struct nvme_pcie_ctrlr {
 	bool is_remapped;
 
 	volatile uint32_t *doorbell_base;
+
+	/* Event fds of the interrupt vectors 1 to num_intr_efds, vector N is used by I/O qpair N */
+	int *intr_efds;
+	uint32_t num_intr_efds;
 };
 
 extern __thread struct nvme_pcie_ctrlr *g_thread_mmio_ctrlr;
@@ -162,6 +166,7 @@ struct nvme_pcie_qpair {
 		uint8_t has_shadow_doorbell	: 1;
 		uint8_t has_pending_vtophys_failures : 1;
 		uint8_t defer_destruction	: 1;
+		uint8_t intr_enabled		: 1;
 	} flags;
 
 	/*
@@ -242,6 +247,12 @@ nvme_pcie_qpair_update_mmio_required(uint16_t value,
 	return true;
 }
 
+static inline bool
+nvme_pcie_qpair_in_submit_batch(struct spdk_nvme_qpair *qpair)
+{
+	return qpair->poll_group != NULL && qpair->poll_group->group->in_submit_batch;
+}
+
 static inline void
 nvme_pcie_qpair_ring_sq_doorbell(struct spdk_nvme_qpair *qpair)
 {
@@ -254,6 +265,8 @@ nvme_pcie_qpair_ring_sq_doorbell(struct spdk_nvme_qpair *qpair)
 		return;
 	}
 
+	pqpair->last_sq_tail = pqpair->sq_tail;
+
 	if (spdk_unlikely(pqpair->flags.has_shadow_doorbell)) {
 		pqpair->stat->sq_shadow_doorbell_updates++;
 		need_mmio = nvme_pcie_qpair_update_mmio_required(
@@ -322,6 +335,7 @@ void nvme_pcie_qpair_submit_tracker(struct spdk_nvme_qpair *qpair, struct nvme_t
 void nvme_pcie_admin_qpair_abort_aers(struct spdk_nvme_qpair *qpair);
 void nvme_pcie_admin_qpair_destroy(struct spdk_nvme_qpair *qpair);
 void nvme_pcie_qpair_abort_reqs(struct spdk_nvme_qpair *qpair, uint32_t dnr);
+int nvme_pcie_qpair_get_fd(struct spdk_nvme_qpair *qpair);
 int32_t nvme_pcie_qpair_process_completions(struct spdk_nvme_qpair *qpair,
 		uint32_t max_completions);
 int nvme_pcie_qpair_destroy(struct spdk_nvme_qpair *qpair);
@@ -345,5 +359,6 @@ int64_t nvme_pcie_poll_group_process_completions(struct spdk_nvme_transport_poll
 		uint32_t completions_per_qpair,
 		spdk_nvme_disconnected_qpair_cb disconnected_qpair_cb);
 int nvme_pcie_poll_group_destroy(struct spdk_nvme_transport_poll_group *tgroup);
+void nvme_pcie_poll_group_submit_batch_end(struct spdk_nvme_transport_poll_group *tgroup);
 
 #endif
@@ -6,6 +6,9 @@
 
 #include "nvme_internal.h"
 
+#include "spdk/fd_group.h"
+#include "spdk/string.h"
+
 struct spdk_nvme_poll_group *
 spdk_nvme_poll_group_create(void *ctx, struct spdk_nvme_accel_fn_table *table)
 {
@@ -56,11 +59,164 @@ spdk_nvme_poll_group_create(void *ctx, struct spdk_nvme_accel_fn_table *table)
 	}
 
 	group->ctx = ctx;
+	group->event_fd = -1;
 	STAILQ_INIT(&group->tgroups);
 
 	return group;
 }
 
+#ifdef __linux__
+static int
+nvme_poll_group_event(void *arg)
+{
+	struct spdk_nvme_poll_group *group = arg;
+	uint64_t notify;
+
+	/* Clear the level triggering, the work itself is done by
+	 * spdk_nvme_poll_group_process_completions() once spdk_nvme_poll_group_wait()
+	 * returns from the fd_group.
+	 */
+	group->event_pending = false;
+	if (read(group->event_fd, &notify, sizeof(notify)) < 0 && errno != EAGAIN) {
+		SPDK_ERRLOG("Failed to read the poll group eventfd: %s\n", spdk_strerror(errno));
+		return -errno;
+	}
+
+	return 0;
+}
+
+static int
+nvme_poll_group_qpair_event(void *arg)
+{
+	/* Transports drain their event sources while processing completions */
+	return 0;
+}
+
+static int
+nvme_poll_group_enable_interrupts(struct spdk_nvme_poll_group *group)
+{
+	int rc;
+
+	if (group->fgrp != NULL) {
+		return 0;
+	}
+
+	rc = spdk_fd_group_create(&group->fgrp);
+	if (rc != 0) {
+		return rc;
+	}
+
+	group->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (group->event_fd < 0) {
+		rc = -errno;
+		goto err;
+	}
+
+	rc = SPDK_FD_GROUP_ADD(group->fgrp, group->event_fd, nvme_poll_group_event, group);
+	if (rc != 0) {
+		close(group->event_fd);
+		goto err;
+	}
+
+	return 0;
+err:
+	spdk_fd_group_destroy(group->fgrp);
+	group->fgrp = NULL;
+	group->event_fd = -1;
+	return rc;
+}
+
+static void
+nvme_poll_group_disable_interrupts(struct spdk_nvme_poll_group *group)
+{
+	if (group->fgrp == NULL) {
+		return;
+	}
+
+	spdk_fd_group_remove(group->fgrp, group->event_fd);
+	close(group->event_fd);
+	spdk_fd_group_destroy(group->fgrp);
+	group->fgrp = NULL;
+	group->event_fd = -1;
+}
+
+void
+nvme_poll_group_kick(struct spdk_nvme_poll_group *group)
+{
+	uint64_t notify = 1;
+
+	if (!group->enable_interrupts || group->event_fd < 0 || group->event_pending) {
+		return;
+	}
+
+	group->event_pending = true;
+	if (write(group->event_fd, &notify, sizeof(notify)) < 0) {
+		SPDK_ERRLOG("Failed to write the poll group eventfd: %s\n", spdk_strerror(errno));
+	}
+}
+#else
+static int
+nvme_poll_group_qpair_event(void *arg)
+{
+	return 0;
+}
+
+static int
+nvme_poll_group_enable_interrupts(struct spdk_nvme_poll_group *group)
+{
+	return -ENOTSUP;
+}
+
+static void
+nvme_poll_group_disable_interrupts(struct spdk_nvme_poll_group *group)
+{
+}
+
+void
+nvme_poll_group_kick(struct spdk_nvme_poll_group *group)
+{
+}
+#endif
+
+int
+spdk_nvme_poll_group_get_fd(struct spdk_nvme_poll_group *group)
+{
+	int rc;
+
+	if (group->enable_interrupts_is_valid && !group->enable_interrupts) {
+		SPDK_ERRLOG("Poll group %p already holds qpairs added in polling mode\n", group);
+		return -EINVAL;
+	}
+
+	rc = nvme_poll_group_enable_interrupts(group);
+	if (rc != 0) {
+		return rc;
+	}
+
+	group->enable_interrupts = true;
+	group->enable_interrupts_is_valid = true;
+
+	return spdk_fd_group_get_fd(group->fgrp);
+}
+
+int64_t
+spdk_nvme_poll_group_wait(struct spdk_nvme_poll_group *group,
+			  spdk_nvme_disconnected_qpair_cb disconnected_qpair_cb)
+{
+	int rc;
+
+	if (!group->enable_interrupts || group->fgrp == NULL) {
+		return -EINVAL;
+	}
+
+	rc = spdk_fd_group_wait(group->fgrp, 0);
+	if (rc < 0) {
+		return rc;
+	}
+
+	return spdk_nvme_poll_group_process_completions(group, 0, disconnected_qpair_cb);
+}
+
 struct spdk_nvme_poll_group *
 spdk_nvme_qpair_get_optimal_poll_group(struct spdk_nvme_qpair *qpair)
 {
@@ -80,11 +236,17 @@ spdk_nvme_poll_group_add(struct spdk_nvme_poll_group *group, struct spdk_nvme_qp
 {
 	struct spdk_nvme_transport_poll_group *tgroup;
 	const struct spdk_nvme_transport *transport;
+	int rc;
 
 	if (nvme_qpair_get_state(qpair) != NVME_QPAIR_DISCONNECTED) {
 		return -EINVAL;
 	}
 
+	/* The qpair still holds requests of the pool of a previous poll group. */
+	if (qpair->num_shared_reqs != 0 && qpair->req_pool != group->req_pool) {
+		return -EBUSY;
+	}
+
 	STAILQ_FOREACH(tgroup, &group->tgroups, link) {
 		if (tgroup->transport == qpair->transport) {
 			break;
@@ -108,17 +270,33 @@ spdk_nvme_poll_group_add(struct spdk_nvme_poll_group *group, struct spdk_nvme_qp
 		}
 	}
 
-	return tgroup ? nvme_transport_poll_group_add(tgroup, qpair) : -ENODEV;
+	if (!tgroup) {
+		return -ENODEV;
+	}
+
+	rc = nvme_transport_poll_group_add(tgroup, qpair);
+	if (rc == 0) {
+		/* The poll group can't switch to interrupt mode anymore */
+		group->enable_interrupts_is_valid = true;
+		qpair->req_pool = group->req_pool;
+	}
+
+	return rc;
 }
 
 int
 spdk_nvme_poll_group_remove(struct spdk_nvme_poll_group *group, struct spdk_nvme_qpair *qpair)
 {
 	struct spdk_nvme_transport_poll_group *tgroup;
+	int rc;
 
 	STAILQ_FOREACH(tgroup, &group->tgroups, link) {
 		if (tgroup->transport == qpair->transport) {
-			return nvme_transport_poll_group_remove(tgroup, qpair);
+			rc = nvme_transport_poll_group_remove(tgroup, qpair);
+			if (rc == 0 && qpair->num_shared_reqs == 0) {
+				qpair->req_pool = NULL;
+			}
+			return rc;
 		}
 	}
 
@@ -128,15 +306,95 @@ spdk_nvme_poll_group_remove(struct spdk_nvme_poll_group *group, struct spdk_nvme
 int
 nvme_poll_group_connect_qpair(struct spdk_nvme_qpair *qpair)
 {
-	return nvme_transport_poll_group_connect_qpair(qpair);
+	struct spdk_nvme_transport_poll_group *tgroup = qpair->poll_group;
+	struct spdk_nvme_poll_group *group = tgroup->group;
+	bool connected = qpair->poll_group_tailq_head == &tgroup->connected_qpairs;
+	int fd, rc;
+
+	rc = nvme_transport_poll_group_connect_qpair(qpair);
+	if (rc != 0 || connected || qpair->poll_group_tailq_head != &tgroup->connected_qpairs ||
+	    !group->enable_interrupts) {
+		return rc;
+	}
+
+	/* The controller may not use interrupts, e.g. RDMA or PCIe without MSI-X */
+	fd = qpair->ctrlr->opts.enable_interrupts ? nvme_transport_qpair_get_fd(qpair) : -ENOTSUP;
+	if (fd == -ENOTSUP) {
+		/* Nothing to wait on, e.g. with uring sockets or for more qpairs than MSI-X
+		 * vectors, so keep polling the qpair instead.
+		 */
+		qpair->no_intr_fd = 1;
+		nvme_poll_group_kick(group);
+		return 0;
+	}
+	if (fd < 0) {
+		SPDK_ERRLOG("Failed to get the interrupt fd of qpair %p: %s\n", qpair, spdk_strerror(-fd));
+		nvme_transport_poll_group_disconnect_qpair(qpair);
+		return fd;
+	}
+
+	rc = SPDK_FD_GROUP_ADD(group->fgrp, fd, nvme_poll_group_qpair_event, qpair);
+	if (rc != 0) {
+		SPDK_ERRLOG("Failed to add qpair %p to the fd group: %s\n", qpair, spdk_strerror(-rc));
+		nvme_transport_poll_group_disconnect_qpair(qpair);
+		return rc;
+	}
+
+	/* Completions may have been posted before the fd was added */
+	nvme_poll_group_kick(group);
+
+	return 0;
 }
 
 int
 nvme_poll_group_disconnect_qpair(struct spdk_nvme_qpair *qpair)
 {
+	struct spdk_nvme_transport_poll_group *tgroup = qpair->poll_group;
+	struct spdk_nvme_poll_group *group = tgroup->group;
+	int fd;
+
+	if (group->enable_interrupts && qpair->poll_group_tailq_head == &tgroup->connected_qpairs) {
+		if (qpair->no_intr_fd) {
+			qpair->no_intr_fd = 0;
+		} else {
+			fd = nvme_transport_qpair_get_fd(qpair);
+			if (fd >= 0) {
+				spdk_fd_group_remove(group->fgrp, fd);
+			}
+		}
+		/* Make sure the disconnected qpair gets reported to the user */
+		nvme_poll_group_kick(group);
+	}
+
 	return nvme_transport_poll_group_disconnect_qpair(qpair);
 }
 
+/* Qpairs don't raise any event while they're being connected or while they're waiting for
+ * their outstanding requests to be aborted, so keep the poll group awake until they're done.
+ * The same goes for the qpairs without an fd, for as long as they're connected.
+ */
+static void
+nvme_poll_group_kick_unsignaled(struct spdk_nvme_poll_group *group)
+{
+	struct spdk_nvme_transport_poll_group *tgroup;
+	struct spdk_nvme_qpair *qpair;
+
+	STAILQ_FOREACH(tgroup, &group->tgroups, link) {
+		STAILQ_FOREACH(qpair, &tgroup->connected_qpairs, poll_group_stailq) {
+			if (nvme_qpair_get_state(qpair) == NVME_QPAIR_CONNECTING || qpair->no_intr_fd) {
+				nvme_poll_group_kick(group);
+				return;
+			}
+		}
+		STAILQ_FOREACH(qpair, &tgroup->disconnected_qpairs, poll_group_stailq) {
+			if (nvme_qpair_get_state(qpair) == NVME_QPAIR_DISCONNECTING) {
+				nvme_poll_group_kick(group);
+				return;
+			}
+		}
+	}
+}
+
 int64_t
 spdk_nvme_poll_group_process_completions(struct spdk_nvme_poll_group *group,
 		uint32_t completions_per_qpair, spdk_nvme_disconnected_qpair_cb disconnected_qpair_cb)
@@ -166,9 +424,31 @@ spdk_nvme_poll_group_process_completions(struct spdk_nvme_poll_group *group,
 	}
 	group->in_process_completions = false;
 
+	if (group->enable_interrupts) {
+		nvme_poll_group_kick_unsignaled(group);
+	}
+
 	return error_reason ? error_reason : num_completions;
 }
 
+void
+spdk_nvme_poll_group_submit_batch_begin(struct spdk_nvme_poll_group *group)
+{
+	group->in_submit_batch = true;
+}
+
+void
+spdk_nvme_poll_group_submit_batch_end(struct spdk_nvme_poll_group *group)
+{
+	struct spdk_nvme_transport_poll_group *tgroup;
+
+	group->in_submit_batch = false;
+
+	STAILQ_FOREACH(tgroup, &group->tgroups, link) {
+		nvme_transport_poll_group_submit_batch_end(tgroup);
+	}
+}
+
 int
 spdk_nvme_poll_group_all_connected(struct spdk_nvme_poll_group *group)
 {
@@ -205,11 +485,78 @@ spdk_nvme_poll_group_get_ctx(struct spdk_nvme_poll_group *group)
 	return group->ctx;
 }
 
+int
+spdk_nvme_poll_group_set_shared_requests(struct spdk_nvme_poll_group *group,
+		uint32_t num_requests)
+{
+	struct spdk_nvme_transport_poll_group *tgroup;
+	struct nvme_request_pool *pool;
+	struct nvme_request *req;
+	size_t req_size_padded;
+	int32_t numa_id;
+	uint32_t i;
+
+	if (num_requests == 0) {
+		return -EINVAL;
+	}
+
+	if (group->req_pool != NULL) {
+		return -EBUSY;
+	}
+
+	STAILQ_FOREACH(tgroup, &group->tgroups, link) {
+		if (!STAILQ_EMPTY(&tgroup->connected_qpairs) ||
+		    !STAILQ_EMPTY(&tgroup->disconnected_qpairs)) {
+			return -EBUSY;
+		}
+	}
+
+	pool = calloc(1, sizeof(*pool));
+	if (pool == NULL) {
+		return -ENOMEM;
+	}
+
+	req_size_padded = (sizeof(struct nvme_request) + 63) & ~(size_t)63;
+
+	/* Requests are built and completed on the poll group's thread, so keep them on its node */
+	numa_id = (int32_t)spdk_env_get_socket_id(spdk_env_get_current_core());
+	if (numa_id != SPDK_ENV_SOCKET_ID_ANY) {
+		pool->req_buf = spdk_zmalloc(req_size_padded * num_requests, 64, NULL,
+					     numa_id, SPDK_MALLOC_SHARE);
+	}
+	if (pool->req_buf == NULL) {
+		pool->req_buf = spdk_zmalloc(req_size_padded * num_requests, 64, NULL,
+					     SPDK_ENV_SOCKET_ID_ANY, SPDK_MALLOC_SHARE);
+	}
+	if (pool->req_buf == NULL) {
+		SPDK_ERRLOG("no memory to allocate poll group %p shared pool with %u requests\n",
+			    group, num_requests);
+		free(pool);
+		return -ENOMEM;
+	}
+
+	STAILQ_INIT(&pool->free_req);
+	for (i = 0; i < num_requests; i++) {
+		req = (void *)((uintptr_t)pool->req_buf + i * req_size_padded);
+		STAILQ_INSERT_HEAD(&pool->free_req, req, stailq);
+	}
+	pool->num_requests = num_requests;
+
+	group->req_pool = pool;
+
+	return 0;
+}
+
 int
 spdk_nvme_poll_group_destroy(struct spdk_nvme_poll_group *group)
 {
 	struct spdk_nvme_transport_poll_group *tgroup, *tmp_tgroup;
 
+	/* qpairs removed from the group may still hold requests of its pool. */
+	if (group->req_pool != NULL && group->req_pool->num_outstanding_reqs != 0) {
+		return -EBUSY;
+	}
+
 	STAILQ_FOREACH_SAFE(tgroup, &group->tgroups, link, tmp_tgroup) {
 		STAILQ_REMOVE(&group->tgroups, tgroup, spdk_nvme_transport_poll_group, link);
 		if (nvme_transport_poll_group_destroy(tgroup) != 0) {
@@ -219,6 +566,13 @@ spdk_nvme_poll_group_destroy(struct spdk_nvme_poll_group *group)
 
 	}
 
+	nvme_poll_group_disable_interrupts(group);
+
+	if (group->req_pool != NULL) {
+		spdk_free(group->req_pool->req_buf);
+		free(group->req_pool);
+	}
+
 	free(group);
 
 	return 0;
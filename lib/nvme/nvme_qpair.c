@@ -873,6 +873,8 @@ nvme_qpair_init(struct spdk_nvme_qpair *qpair, uint16_t id,
 	qpair->async = async;
 	qpair->poll_status = NULL;
 	qpair->num_outstanding_reqs = 0;
+	qpair->num_shared_reqs = 0;
+	qpair->req_pool = NULL;
 
 	STAILQ_INIT(&qpair->free_req);
 	STAILQ_INIT(&qpair->queued_req);
@@ -885,8 +887,8 @@ nvme_qpair_init(struct spdk_nvme_qpair *qpair, uint16_t id,
 	/* Add one for the reserved_req */
 	num_requests++;
 
-	qpair->req_buf = spdk_zmalloc(req_size_padded * num_requests, 64, NULL,
-				      SPDK_ENV_SOCKET_ID_ANY, SPDK_MALLOC_SHARE);
+	qpair->req_buf = nvme_ctrlr_zmalloc_local(ctrlr, req_size_padded * num_requests, 64,
+			 SPDK_MALLOC_SHARE);
 	if (qpair->req_buf == NULL) {
 		SPDK_ERRLOG("no memory to allocate qpair(cntlid:0x%x sqid:%d) req_buf with %d request\n",
 			    ctrlr->cntlid, qpair->id, num_requests);
@@ -86,7 +86,8 @@ struct nvme_tcp_qpair {
 		uint16_t host_ddgst_enable: 1;
 		uint16_t icreq_send_ack: 1;
 		uint16_t in_connect_poll: 1;
-		uint16_t reserved: 12;
+		uint16_t intr_enabled: 1;
+		uint16_t reserved: 11;
 	} flags;
 
 	/** Specifies the maximum number of PDU-Data bytes per H2C Data Transfer PDU */
@@ -179,6 +180,17 @@ nvme_tcp_poll_group(struct spdk_nvme_transport_poll_group *group)
 	return SPDK_CONTAINEROF(group, struct nvme_tcp_poll_group, group);
 }
 
+/* In interrupt mode, nothing polls the socket group unless an event is raised, so make sure
+ * that queued PDUs get flushed and requests that need polling get processed.
+ */
+static inline void
+nvme_tcp_qpair_kick(struct nvme_tcp_qpair *tqpair)
+{
+	if (spdk_unlikely(tqpair->flags.intr_enabled) && tqpair->qpair.poll_group != NULL) {
+		nvme_poll_group_kick(tqpair->qpair.poll_group->group);
+	}
+}
+
 static inline struct nvme_tcp_ctrlr *
 nvme_tcp_ctrlr(struct spdk_nvme_ctrlr *ctrlr)
 {
@@ -488,6 +500,7 @@ _tcp_write_pdu(struct nvme_tcp_pdu *pdu)
 	pdu->sock_req.cb_arg = pdu;
 	tqpair->stats->submitted_requests++;
 	spdk_sock_writev_async(tqpair->sock, &pdu->sock_req);
+	nvme_tcp_qpair_kick(tqpair);
 }
 
 static void
@@ -1211,6 +1224,7 @@ nvme_tcp_recv_payload_seq_cb(void *cb_arg, int status)
 		group = nvme_tcp_poll_group(tqpair->qpair.poll_group);
 		TAILQ_INSERT_TAIL(&group->needs_poll, tqpair, link);
 		tqpair->needs_poll = true;
+		nvme_tcp_qpair_kick(tqpair);
 	}
 
 	req->accel_sequence = NULL;
@@ -1347,6 +1361,7 @@ nvme_tcp_accel_recv_compute_crc32_done(void *cb_arg, int status)
 		pgroup = nvme_tcp_poll_group(tqpair->qpair.poll_group);
 		TAILQ_INSERT_TAIL(&pgroup->needs_poll, tqpair, link);
 		tqpair->needs_poll = true;
+		nvme_tcp_qpair_kick(tqpair);
 	}
 
 	if (spdk_unlikely(status)) {
@@ -2114,7 +2129,10 @@ nvme_tcp_qpair_process_completions(struct spdk_nvme_qpair *qpair, uint32_t max_c
 		}
 	}
 
-	if (max_completions == 0) {
+	if (tqpair->flags.intr_enabled && qpair->poll_group != NULL) {
+		/* The data buffered by the socket doesn't raise any event, so drain it */
+		max_completions = UINT32_MAX;
+	} else if (max_completions == 0) {
 		max_completions = spdk_max(tqpair->num_entries, 1);
 	} else {
 		max_completions = spdk_min(max_completions, tqpair->num_entries);
@@ -2435,6 +2453,7 @@ nvme_tcp_ctrlr_create_qpair(struct spdk_nvme_ctrlr *ctrlr,
 	 * one slot shall always remain empty.
 	 */
 	tqpair->num_entries = qsize - 1;
+	tqpair->flags.intr_enabled = ctrlr->opts.enable_interrupts;
 	qpair = &tqpair->qpair;
 	rc = nvme_qpair_init(qpair, qid, ctrlr, qprio, num_requests, async);
 	if (rc != 0) {
@@ -2807,6 +2826,16 @@ nvme_tcp_poll_group_process_completions(struct spdk_nvme_transport_poll_group *t
 		nvme_tcp_qpair_sock_cb(&tqpair->qpair, group->sock_group, tqpair->sock);
 	}
 
+	if (tgroup->group->enable_interrupts) {
+		/* Keep polling until the PDUs that couldn't be sent right away are flushed */
+		STAILQ_FOREACH(qpair, &tgroup->connected_qpairs, poll_group_stailq) {
+			if (!TAILQ_EMPTY(&nvme_tcp_qpair(qpair)->send_queue)) {
+				nvme_poll_group_kick(tgroup->group);
+				break;
+			}
+		}
+	}
+
 	if (spdk_unlikely(num_events < 0)) {
 		return num_events;
 	}
@@ -2817,6 +2846,18 @@ nvme_tcp_poll_group_process_completions(struct spdk_nvme_transport_poll_group *t
 	return group->num_completions;
 }
 
+static int
+nvme_tcp_qpair_get_fd(struct spdk_nvme_qpair *qpair)
+{
+	struct nvme_tcp_qpair *tqpair = nvme_tcp_qpair(qpair);
+
+	if (tqpair->sock == NULL) {
+		return -ENOTCONN;
+	}
+
+	return spdk_sock_get_interrupt_fd(tqpair->sock);
+}
+
 static int
 nvme_tcp_poll_group_destroy(struct spdk_nvme_transport_poll_group *tgroup)
 {
@@ -2914,6 +2955,7 @@ const struct spdk_nvme_transport_ops tcp_ops = {
 	.poll_group_destroy = nvme_tcp_poll_group_destroy,
 	.poll_group_get_stats = nvme_tcp_poll_group_get_stats,
 	.poll_group_free_stats = nvme_tcp_poll_group_free_stats,
+	.qpair_get_fd = nvme_tcp_qpair_get_fd,
 };
 
 SPDK_NVME_TRANSPORT_REGISTER(tcp, &tcp_ops);
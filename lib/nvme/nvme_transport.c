@@ -110,6 +110,11 @@ struct spdk_nvme_ctrlr *nvme_transport_ctrlr_construct(const struct spdk_nvme_tr
 	}
 
 	ctrlr = transport->ops.ctrlr_construct(trid, opts, devhandle);
+	if (ctrlr != NULL && ctrlr->opts.enable_interrupts && transport->ops.qpair_get_fd == NULL) {
+		SPDK_NOTICELOG("Transport %s doesn't support interrupts, polling the qpairs of %s\n",
+			       trid->trstring, trid->traddr);
+		ctrlr->opts.enable_interrupts = false;
+	}
 
 	return ctrlr;
 }
@@ -631,6 +636,16 @@ nvme_transport_qpair_iterate_requests(struct spdk_nvme_qpair *qpair,
 	return transport->ops.qpair_iterate_requests(qpair, iter_fn, arg);
 }
 
+int
+nvme_transport_qpair_get_fd(struct spdk_nvme_qpair *qpair)
+{
+	if (qpair->transport->ops.qpair_get_fd == NULL) {
+		return -ENOTSUP;
+	}
+
+	return qpair->transport->ops.qpair_get_fd(qpair);
+}
+
 void
 nvme_transport_admin_qpair_abort_aers(struct spdk_nvme_qpair *qpair)
 {
@@ -796,6 +811,14 @@ nvme_transport_poll_group_free_stats(struct spdk_nvme_transport_poll_group *tgro
 	}
 }
 
+void
+nvme_transport_poll_group_submit_batch_end(struct spdk_nvme_transport_poll_group *tgroup)
+{
+	if (tgroup->transport->ops.poll_group_submit_batch_end) {
+		tgroup->transport->ops.poll_group_submit_batch_end(tgroup);
+	}
+}
+
 spdk_nvme_transport_type_t
 nvme_transport_get_trtype(const struct spdk_nvme_transport *transport)
 {
@@ -141,6 +141,71 @@ nvme_vfio_setup_bar0(struct nvme_vfio_ctrlr *vctrlr)
 	return 0;
 }
 
+/* Vector 0 stays with the admin queue, each I/O queue gets its own vector */
+static int
+nvme_vfio_ctrlr_enable_interrupts(struct nvme_vfio_ctrlr *vctrlr)
+{
+	struct nvme_pcie_ctrlr *pctrlr = &vctrlr->pctrlr;
+	uint32_t i, num_vectors;
+	int rc;
+
+	rc = spdk_vfio_user_get_msix_count(vctrlr->dev);
+	if (rc < 2) {
+		SPDK_DEBUGLOG(nvme_vfio, "MSI-X isn't supported by %s\n", pctrlr->ctrlr.trid.traddr);
+		return rc < 0 ? rc : -ENOTSUP;
+	}
+
+	num_vectors = spdk_min((uint32_t)rc - 1, pctrlr->ctrlr.opts.num_io_queues);
+	pctrlr->intr_efds = calloc(num_vectors, sizeof(*pctrlr->intr_efds));
+	if (pctrlr->intr_efds == NULL) {
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < num_vectors; i++) {
+		pctrlr->intr_efds[i] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (pctrlr->intr_efds[i] < 0) {
+			rc = -errno;
+			goto err;
+		}
+	}
+
+	rc = spdk_vfio_user_set_msix_efds(vctrlr->dev, 1, pctrlr->intr_efds, num_vectors);
+	if (rc != 0) {
+		SPDK_ERRLOG("Failed to set the MSI-X vectors of %s: %d\n", pctrlr->ctrlr.trid.traddr, rc);
+		goto err;
+	}
+
+	pctrlr->num_intr_efds = num_vectors;
+
+	return 0;
+err:
+	while (i > 0) {
+		close(pctrlr->intr_efds[--i]);
+	}
+	free(pctrlr->intr_efds);
+	pctrlr->intr_efds = NULL;
+	return rc;
+}
+
+static void
+nvme_vfio_ctrlr_disable_interrupts(struct nvme_vfio_ctrlr *vctrlr)
+{
+	struct nvme_pcie_ctrlr *pctrlr = &vctrlr->pctrlr;
+	uint32_t i;
+
+	if (pctrlr->num_intr_efds == 0) {
+		return;
+	}
+
+	spdk_vfio_user_set_msix_efds(vctrlr->dev, 1, NULL, 0);
+	for (i = 0; i < pctrlr->num_intr_efds; i++) {
+		close(pctrlr->intr_efds[i]);
+	}
+	free(pctrlr->intr_efds);
+	pctrlr->intr_efds = NULL;
+	pctrlr->num_intr_efds = 0;
+}
+
 static struct spdk_nvme_ctrlr *
 	nvme_vfio_ctrlr_construct(const struct spdk_nvme_transport_id *trid,
 			  const struct spdk_nvme_ctrlr_opts *opts,
@@ -232,6 +297,19 @@ static struct spdk_nvme_ctrlr *
 		goto exit;
 	}
 
+	if (pctrlr->ctrlr.opts.enable_interrupts) {
+		ret = nvme_vfio_ctrlr_enable_interrupts(vctrlr);
+		if (ret == -ENOMEM) {
+			nvme_ctrlr_destruct(&pctrlr->ctrlr);
+			goto exit;
+		}
+		if (ret != 0) {
+			SPDK_NOTICELOG("Interrupts are not available for %s, polling its qpairs\n",
+				       pctrlr->ctrlr.trid.traddr);
+			pctrlr->ctrlr.opts.enable_interrupts = false;
+		}
+	}
+
 	return &pctrlr->ctrlr;
 
 exit:
@@ -303,6 +381,8 @@ nvme_vfio_ctrlr_destruct(struct spdk_nvme_ctrlr *ctrlr)
 
 	nvme_ctrlr_free_processes(ctrlr);
 
+	nvme_vfio_ctrlr_disable_interrupts(vctrlr);
+
 	spdk_vfio_user_release(vctrlr->dev);
 	free(vctrlr);
 
@@ -348,6 +428,7 @@ const struct spdk_nvme_transport_ops vfio_ops = {
 	.qpair_abort_reqs = nvme_pcie_qpair_abort_reqs,
 	.qpair_submit_request = nvme_pcie_qpair_submit_request,
 	.qpair_process_completions = nvme_pcie_qpair_process_completions,
+	.qpair_get_fd = nvme_pcie_qpair_get_fd,
 
 	.poll_group_create = nvme_pcie_poll_group_create,
 	.poll_group_connect_qpair = nvme_pcie_poll_group_connect_qpair,
@@ -357,7 +438,8 @@ const struct spdk_nvme_transport_ops vfio_ops = {
 	.poll_group_process_completions = nvme_pcie_poll_group_process_completions,
 	.poll_group_destroy = nvme_pcie_poll_group_destroy,
 	.poll_group_get_stats = nvme_pcie_poll_group_get_stats,
-	.poll_group_free_stats = nvme_pcie_poll_group_free_stats
+	.poll_group_free_stats = nvme_pcie_poll_group_free_stats,
+	.poll_group_submit_batch_end = nvme_pcie_poll_group_submit_batch_end
 };
 
 SPDK_NVME_TRANSPORT_REGISTER(vfio, &vfio_ops);
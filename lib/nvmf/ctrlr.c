@@ -54,6 +54,7 @@ struct spdk_nvmf_custom_admin_cmd {
 static struct spdk_nvmf_custom_admin_cmd g_nvmf_custom_admin_cmd_hdlrs[SPDK_NVME_MAX_OPC + 1];
 
 static void _nvmf_request_complete(void *ctx);
+static bool nvmf_qpair_abort_fq_request(struct spdk_nvmf_qpair *qpair, uint16_t cid);
 int nvmf_passthru_admin_cmd_for_ctrlr(struct spdk_nvmf_request *req, struct spdk_nvmf_ctrlr *ctrlr);
 
 static inline void
@@ -3270,6 +3271,15 @@ nvmf_qpair_abort_request(struct spdk_nvmf_qpair *qpair, struct spdk_nvmf_request
 		return;
 	}
 
+	if (nvmf_qpair_abort_fq_request(qpair, cid)) {
+		SPDK_DEBUGLOG(nvmf, "abort ctrlr=%p sqid=%u cid=%u successful\n",
+			      qpair->ctrlr, qpair->qid, cid);
+		req->rsp->nvme_cpl.cdw0 &= ~1U; /* Command successfully aborted */
+
+		spdk_nvmf_request_complete(req);
+		return;
+	}
+
 	nvmf_transport_qpair_abort_request(qpair, req);
 }
 
@@ -4246,6 +4256,322 @@ spdk_nvmf_request_zcopy_end(struct spdk_nvmf_request *req, bool commit)
 	nvmf_bdev_ctrlr_zcopy_end(req, commit);
 }
 
+/* Cost of a command on top of its transfer length, so that small I/O isn't free */
+#define NVMF_FQ_CMD_COST	4096
+#define NVMF_FQ_COST_SCALE	((uint64_t)SPDK_NVMF_FQ_MAX_WEIGHT * SPDK_NVMF_FQ_MAX_WEIGHT)
+
+static inline bool
+nvmf_fq_tag_before(uint64_t tag1, uint64_t tag2)
+{
+	/* Finish tags only grow, compare them so that they can wrap around */
+	return (int64_t)(tag1 - tag2) < 0;
+}
+
+static uint32_t
+nvmf_qpair_get_host_weight(struct spdk_nvmf_qpair *qpair)
+{
+	struct spdk_nvmf_subsystem *subsystem = qpair->ctrlr->subsys;
+	uint32_t gen;
+
+	gen = __atomic_load_n(&subsystem->fq_weight_gen, __ATOMIC_ACQUIRE);
+	if (spdk_unlikely(qpair->fq_host_weight == 0 || qpair->fq_weight_gen != gen)) {
+		qpair->fq_host_weight = nvmf_subsystem_get_host_weight(subsystem,
+					qpair->ctrlr->hostnqn);
+		qpair->fq_weight_gen = gen;
+	}
+
+	return qpair->fq_host_weight;
+}
+
+static struct spdk_nvmf_fq_flow *
+nvmf_fq_get_flow(struct spdk_nvmf_subsystem_poll_group *sgroup, const char *hostnqn,
+		 uint32_t nsid)
+{
+	struct spdk_nvmf_fq_flow *flow;
+
+	TAILQ_FOREACH(flow, &sgroup->fq_flows, link) {
+		if (flow->nsid == nsid && strcmp(flow->hostnqn, hostnqn) == 0) {
+			return flow;
+		}
+	}
+
+	flow = calloc(1, sizeof(*flow));
+	if (spdk_unlikely(flow == NULL)) {
+		return NULL;
+	}
+
+	snprintf(flow->hostnqn, sizeof(flow->hostnqn), "%s", hostnqn);
+	flow->nsid = nsid;
+	flow->finish_tag = sgroup->fq_vtime;
+	STAILQ_INIT(&flow->queued);
+	TAILQ_INSERT_TAIL(&sgroup->fq_flows, flow, link);
+
+	return flow;
+}
+
+static void
+nvmf_fq_remove(struct spdk_nvmf_subsystem_poll_group *sgroup, struct spdk_nvmf_fq_flow *flow,
+	       struct spdk_nvmf_request *req)
+{
+	STAILQ_REMOVE(&flow->queued, req, spdk_nvmf_request, fq_link);
+	assert(sgroup->fq_queued > 0);
+	sgroup->fq_queued--;
+
+	if (STAILQ_EMPTY(&flow->queued)) {
+		TAILQ_REMOVE(&sgroup->fq_flows, flow, link);
+		free(flow);
+	}
+}
+
+/* Returns true if the request got queued, false if it should be executed right away. */
+static bool
+nvmf_ctrlr_fq_enqueue(struct spdk_nvmf_subsystem_poll_group *sgroup, struct spdk_nvmf_ns *ns,
+		      struct spdk_nvmf_request *req)
+{
+	struct spdk_nvmf_qpair *qpair = req->qpair;
+	struct spdk_nvmf_fq_flow *flow;
+	uint32_t max_inflight;
+	uint64_t weight;
+
+	max_inflight = __atomic_load_n(&ns->subsystem->fq_max_inflight, __ATOMIC_RELAXED);
+	if (spdk_likely(max_inflight == 0)) {
+		return false;
+	}
+
+	if (sgroup->fq_queued == 0 && sgroup->fq_inflight < max_inflight) {
+		goto run;
+	}
+
+	flow = nvmf_fq_get_flow(sgroup, qpair->ctrlr->hostnqn, ns->nsid);
+	if (spdk_unlikely(flow == NULL)) {
+		/* Rather run the command unfairly than fail it */
+		goto run;
+	}
+
+	weight = __atomic_load_n(&ns->weight, __ATOMIC_RELAXED);
+	weight *= nvmf_qpair_get_host_weight(qpair);
+	if (nvmf_fq_tag_before(flow->finish_tag, sgroup->fq_vtime)) {
+		flow->finish_tag = sgroup->fq_vtime;
+	}
+	flow->finish_tag += ((uint64_t)req->length + NVMF_FQ_CMD_COST) * NVMF_FQ_COST_SCALE /
+			    weight;
+	req->fq_finish_tag = flow->finish_tag;
+
+	STAILQ_INSERT_TAIL(&flow->queued, req, fq_link);
+	sgroup->fq_queued++;
+
+	return true;
+run:
+	sgroup->fq_inflight++;
+	req->fq_tracked = true;
+
+	return false;
+}
+
+static struct spdk_nvmf_request *
+nvmf_fq_dequeue(struct spdk_nvmf_subsystem_poll_group *sgroup)
+{
+	struct spdk_nvmf_fq_flow *flow, *next = NULL;
+	struct spdk_nvmf_request *req;
+
+	/* Pick the queued request with the earliest virtual finish time */
+	TAILQ_FOREACH(flow, &sgroup->fq_flows, link) {
+		if (next == NULL ||
+		    nvmf_fq_tag_before(STAILQ_FIRST(&flow->queued)->fq_finish_tag,
+				       STAILQ_FIRST(&next->queued)->fq_finish_tag)) {
+			next = flow;
+		}
+	}
+
+	assert(next != NULL);
+	req = STAILQ_FIRST(&next->queued);
+	sgroup->fq_vtime = req->fq_finish_tag;
+	nvmf_fq_remove(sgroup, next, req);
+
+	return req;
+}
+
+/*
+ * The LBAs of a command passed through aren't translated, but the device transfers as many
+ * blocks as the command says, so the range still has to fit the namespace and the request.
+ */
+static int
+nvmf_ctrlr_passthru_io(struct spdk_bdev *bdev, struct spdk_bdev_desc *desc,
+		       struct spdk_io_channel *ch, struct spdk_nvmf_request *req)
+{
+	struct spdk_nvme_cmd *cmd = &req->cmd->nvme_cmd;
+	struct spdk_nvme_cpl *rsp = &req->rsp->nvme_cpl;
+	uint32_t block_size = spdk_bdev_get_block_size(bdev);
+	uint64_t start_lba, num_blocks;
+
+	switch (cmd->opc) {
+	case SPDK_NVME_OPC_READ:
+	case SPDK_NVME_OPC_WRITE:
+	case SPDK_NVME_OPC_COMPARE:
+		break;
+	default:
+		return nvmf_bdev_ctrlr_nvme_passthru_io(bdev, desc, ch, req);
+	}
+
+	/* SLBA: CDW10 and CDW11, NLB: CDW12 bits 15:00, 0's based */
+	start_lba = from_le64(&cmd->cdw10);
+	num_blocks = (from_le32(&cmd->cdw12) & 0xFFFFu) + 1;
+
+	if (spdk_unlikely(start_lba + num_blocks > spdk_bdev_get_num_blocks(bdev) ||
+			  start_lba + num_blocks < start_lba)) {
+		SPDK_ERRLOG("end of media\n");
+		rsp->status.sct = SPDK_NVME_SCT_GENERIC;
+		rsp->status.sc = SPDK_NVME_SC_LBA_OUT_OF_RANGE;
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+	}
+
+	if (spdk_unlikely(num_blocks * block_size != req->length)) {
+		SPDK_ERRLOG("NLB %" PRIu64 " * block size %" PRIu32 " != SGL length %" PRIu32 "\n",
+			    num_blocks, block_size, req->length);
+		rsp->status.sct = SPDK_NVME_SCT_GENERIC;
+		rsp->status.sc = SPDK_NVME_SC_DATA_SGL_LENGTH_INVALID;
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+	}
+
+	return nvmf_bdev_ctrlr_nvme_passthru_io(bdev, desc, ch, req);
+}
+
+static void
+nvmf_ctrlr_fq_exec(struct spdk_nvmf_request *req)
+{
+	struct spdk_nvmf_qpair *qpair = req->qpair;
+	struct spdk_nvme_cmd *cmd = &req->cmd->nvme_cmd;
+	struct spdk_nvme_cpl *response = &req->rsp->nvme_cpl;
+	struct spdk_nvmf_subsystem *subsystem;
+	struct spdk_nvmf_ns *ns;
+	struct spdk_io_channel *ch;
+	int status;
+
+	if (spdk_unlikely(qpair->state != SPDK_NVMF_QPAIR_ACTIVE)) {
+		response->status.sct = SPDK_NVME_SCT_GENERIC;
+		response->status.sc = SPDK_NVME_SC_ABORTED_SQ_DELETION;
+		_nvmf_request_complete(req);
+		return;
+	}
+
+	/* Queued requests count as outstanding, so the namespace can't be removed under them */
+	subsystem = qpair->ctrlr->subsys;
+	ns = _nvmf_subsystem_get_ns(subsystem, cmd->nsid);
+	assert(ns != NULL && ns->bdev != NULL);
+	ch = qpair->group->sgroups[subsystem->id].ns_info[cmd->nsid - 1].channel;
+
+	if (ns->passthru_io) {
+		status = nvmf_ctrlr_passthru_io(ns->bdev, ns->desc, ch, req);
+	} else if (cmd->opc == SPDK_NVME_OPC_READ) {
+		status = nvmf_bdev_ctrlr_read_cmd(ns->bdev, ns->desc, ch, req);
+	} else {
+		status = nvmf_bdev_ctrlr_write_cmd(ns->bdev, ns->desc, ch, req);
+	}
+
+	if (status == SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE) {
+		_nvmf_request_complete(req);
+	}
+}
+
+static void
+nvmf_ctrlr_fq_dispatch(struct spdk_nvmf_subsystem *subsystem,
+		       struct spdk_nvmf_subsystem_poll_group *sgroup)
+{
+	struct spdk_nvmf_request *req;
+	uint32_t max_inflight;
+
+	/* Requests failing right away complete from within the loop below */
+	if (sgroup->fq_dispatching) {
+		return;
+	}
+
+	sgroup->fq_dispatching = true;
+	while (sgroup->fq_queued > 0) {
+		/* Queued requests still get dispatched after fair queuing is disabled */
+		max_inflight = __atomic_load_n(&subsystem->fq_max_inflight, __ATOMIC_RELAXED);
+		if (max_inflight != 0 && sgroup->fq_inflight >= max_inflight) {
+			break;
+		}
+
+		req = nvmf_fq_dequeue(sgroup);
+		sgroup->fq_inflight++;
+		req->fq_tracked = true;
+		nvmf_ctrlr_fq_exec(req);
+	}
+	sgroup->fq_dispatching = false;
+}
+
+static bool
+nvmf_qpair_abort_fq_request(struct spdk_nvmf_qpair *qpair, uint16_t cid)
+{
+	struct spdk_nvmf_subsystem_poll_group *sgroup;
+	struct spdk_nvmf_fq_flow *flow;
+	struct spdk_nvmf_request *req;
+
+	sgroup = &qpair->group->sgroups[qpair->ctrlr->subsys->id];
+	TAILQ_FOREACH(flow, &sgroup->fq_flows, link) {
+		STAILQ_FOREACH(req, &flow->queued, fq_link) {
+			if (req->qpair == qpair && req->cmd->nvme_cmd.cid == cid) {
+				nvmf_fq_remove(sgroup, flow, req);
+				req->rsp->nvme_cpl.status.sct = SPDK_NVME_SCT_GENERIC;
+				req->rsp->nvme_cpl.status.sc = SPDK_NVME_SC_ABORTED_BY_REQUEST;
+				_nvmf_request_complete(req);
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+void
+nvmf_qpair_abort_fq_reqs(struct spdk_nvmf_qpair *qpair)
+{
+	struct spdk_nvmf_subsystem_poll_group *sgroup;
+	struct spdk_nvmf_fq_flow *flow, *tmp_flow;
+	struct spdk_nvmf_request *req, *tmp;
+	STAILQ_HEAD(, spdk_nvmf_request) aborted = STAILQ_HEAD_INITIALIZER(aborted);
+
+	if (qpair->ctrlr == NULL || qpair->qid == 0) {
+		return;
+	}
+
+	sgroup = &qpair->group->sgroups[qpair->ctrlr->subsys->id];
+	if (sgroup->fq_queued == 0) {
+		return;
+	}
+
+	TAILQ_FOREACH_SAFE(flow, &sgroup->fq_flows, link, tmp_flow) {
+		STAILQ_FOREACH_SAFE(req, &flow->queued, fq_link, tmp) {
+			if (req->qpair == qpair) {
+				nvmf_fq_remove(sgroup, flow, req);
+				STAILQ_INSERT_TAIL(&aborted, req, fq_link);
+			}
+		}
+	}
+
+	/* Complete them only now, as completions may dispatch other requests */
+	STAILQ_FOREACH_SAFE(req, &aborted, fq_link, tmp) {
+		req->rsp->nvme_cpl.status.sct = SPDK_NVME_SCT_GENERIC;
+		req->rsp->nvme_cpl.status.sc = SPDK_NVME_SC_ABORTED_SQ_DELETION;
+		_nvmf_request_complete(req);
+	}
+}
+
+static inline bool
+nvmf_ctrlr_is_reservation_cmd(uint8_t opc)
+{
+	switch (opc) {
+	case SPDK_NVME_OPC_RESERVATION_REGISTER:
+	case SPDK_NVME_OPC_RESERVATION_ACQUIRE:
+	case SPDK_NVME_OPC_RESERVATION_RELEASE:
+	case SPDK_NVME_OPC_RESERVATION_REPORT:
+		return true;
+	default:
+		return false;
+	}
+}
+
 int
 nvmf_ctrlr_process_io_cmd(struct spdk_nvmf_request *req)
 {
@@ -4330,6 +4656,19 @@ nvmf_ctrlr_process_io_cmd(struct spdk_nvmf_request *req)
 		req->qpair->first_fused_req = NULL;
 	}
 
+	/* Fused commands returned above already, they and zero-copy ones bypass fair queuing */
+	if ((cmd->opc == SPDK_NVME_OPC_READ || cmd->opc == SPDK_NVME_OPC_WRITE) &&
+	    !(cmd->fuse & SPDK_NVME_CMD_FUSE_MASK) &&
+	    !spdk_nvmf_request_using_zcopy(req) &&
+	    nvmf_ctrlr_fq_enqueue(&group->sgroups[ctrlr->subsys->id], ns, req)) {
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS;
+	}
+
+	/* The target keeps handling the reservations, as it holds their state */
+	if (ns->passthru_io && !nvmf_ctrlr_is_reservation_cmd(cmd->opc)) {
+		return nvmf_ctrlr_passthru_io(bdev, desc, ch, req);
+	}
+
 	if (spdk_nvmf_request_using_zcopy(req)) {
 		assert(req->zcopy_phase == NVMF_ZCOPY_PHASE_INIT);
 		return nvmf_bdev_ctrlr_zcopy_start(bdev, desc, ch, req);
@@ -4397,6 +4736,7 @@ _nvmf_request_complete(void *ctx)
 	struct spdk_nvmf_subsystem_poll_group *sgroup = NULL;
 	struct spdk_nvmf_subsystem_pg_ns_info *ns_info;
 	bool is_aer = false;
+	bool fq_tracked;
 	uint32_t nsid;
 	bool paused;
 	uint8_t opcode;
@@ -4406,6 +4746,8 @@ _nvmf_request_complete(void *ctx)
 	rsp->cid = req->cmd->nvme_cmd.cid;
 	nsid = req->cmd->nvme_cmd.nsid;
 	opcode = req->cmd->nvmf_cmd.opcode;
+	fq_tracked = req->fq_tracked;
+	req->fq_tracked = false;
 
 	qpair = req->qpair;
 	if (spdk_likely(qpair->ctrlr)) {
@@ -4414,6 +4756,7 @@ _nvmf_request_complete(void *ctx)
 		is_aer = req->cmd->nvme_cmd.opc == SPDK_NVME_OPC_ASYNC_EVENT_REQUEST;
 		if (spdk_likely(qpair->qid != 0)) {
 			qpair->group->stat.completed_nvme_io++;
+			qpair->completed_nvme_io++;
 		}
 
 		/*
@@ -4478,6 +4821,14 @@ _nvmf_request_complete(void *ctx)
 					sgroup->ns_info[nsid - 1].io_outstanding--;
 				}
 			}
+
+			if (fq_tracked) {
+				assert(sgroup->fq_inflight > 0);
+				sgroup->fq_inflight--;
+				if (sgroup->fq_queued > 0) {
+					nvmf_ctrlr_fq_dispatch(qpair->ctrlr->subsys, sgroup);
+				}
+			}
 		}
 
 		if (spdk_unlikely(sgroup->state == SPDK_NVMF_SUBSYSTEM_PAUSING &&
@@ -4661,7 +5012,7 @@ nvmf_ctrlr_get_dif_ctx(struct spdk_nvmf_ctrlr *ctrlr, struct spdk_nvme_cmd *cmd,
 	}
 
 	ns = _nvmf_subsystem_get_ns(ctrlr->subsys, cmd->nsid);
-	if (ns == NULL || ns->bdev == NULL) {
+	if (ns == NULL || ns->bdev == NULL || ns->passthru_io) {
 		return false;
 	}
 
@@ -22,6 +22,13 @@ SPDK_LOG_REGISTER_COMPONENT(nvmf)
 
 #define SPDK_NVMF_DEFAULT_MAX_SUBSYSTEMS 1024
 
+/* Minimum load difference between the busiest and the idlest poll groups, in percent
+ * of the busiest poll group load, for a rebalancing pass to move a qpair */
+#define NVMF_REBALANCE_MIN_IMBALANCE_PCT 20
+
+/* Time given to a qpair being moved to complete its requests in flight */
+#define NVMF_QPAIR_MOVE_TIMEOUT_SEC 10
+
 static TAILQ_HEAD(, spdk_nvmf_tgt) g_nvmf_tgts = TAILQ_HEAD_INITIALIZER(g_nvmf_tgts);
 
 typedef void (*nvmf_qpair_disconnect_cpl)(void *ctx, int status);
@@ -167,6 +174,40 @@ nvmf_poll_group_poll(void *ctx)
 	return count > 0 ? SPDK_POLLER_BUSY : SPDK_POLLER_IDLE;
 }
 
+/*
+ * Register the poller of the poll group and let the transports set up their own way
+ * of getting it polled, e.g. interrupts, on top of it.
+ */
+static void
+nvmf_poll_group_register_poller(struct spdk_nvmf_poll_group *group)
+{
+	struct spdk_nvmf_transport_poll_group *tgroup;
+	int rc;
+
+	assert(group->poller == NULL);
+	group->poller = SPDK_POLLER_REGISTER(nvmf_poll_group_poll, group, 0);
+
+	TAILQ_FOREACH(tgroup, &group->tgroups, link) {
+		rc = nvmf_transport_poll_group_resume(tgroup);
+		if (rc != 0) {
+			SPDK_ERRLOG("Failed to resume %s poll group of group=%p: %s\n",
+				    tgroup->transport->ops->name, group, spdk_strerror(-rc));
+		}
+	}
+}
+
+static void
+nvmf_poll_group_unregister_poller(struct spdk_nvmf_poll_group *group)
+{
+	struct spdk_nvmf_transport_poll_group *tgroup;
+
+	TAILQ_FOREACH(tgroup, &group->tgroups, link) {
+		nvmf_transport_poll_group_pause(tgroup);
+	}
+
+	spdk_poller_unregister(&group->poller);
+}
+
 /*
  * Reset and clean up the poll group (I/O channel code will actually free the
  * group).
@@ -270,7 +311,8 @@ nvmf_tgt_create_poll_group(void *io_device, void *ctx_buf)
 	group->thread = thread;
 	pthread_mutex_init(&group->mutex, NULL);
 
-	group->poller = SPDK_POLLER_REGISTER(nvmf_poll_group_poll, group, 0);
+	/* No transport poll group to resume yet, they set themselves up when created */
+	nvmf_poll_group_register_poller(group);
 
 	SPDK_DTRACE_PROBE1_TICKS(nvmf_create_poll_group, spdk_thread_get_id(thread));
 
@@ -586,6 +628,19 @@ nvmf_write_nvme_subsystem_config(struct spdk_json_write_ctx *w,
 	/* } */
 	spdk_json_write_object_end(w);
 
+	if (spdk_nvmf_subsystem_get_fair_queuing(subsystem) != 0) {
+		spdk_json_write_object_begin(w);
+		spdk_json_write_named_string(w, "method", "nvmf_subsystem_set_fair_queuing");
+
+		spdk_json_write_named_object_begin(w, "params");
+		spdk_json_write_named_string(w, "nqn", spdk_nvmf_subsystem_get_nqn(subsystem));
+		spdk_json_write_named_uint32(w, "max_inflight",
+					     spdk_nvmf_subsystem_get_fair_queuing(subsystem));
+		spdk_json_write_object_end(w);
+
+		spdk_json_write_object_end(w);
+	}
+
 	for (host = spdk_nvmf_subsystem_get_first_host(subsystem); host != NULL;
 	     host = spdk_nvmf_subsystem_get_next_host(subsystem, host)) {
 
@@ -609,6 +664,19 @@ nvmf_write_nvme_subsystem_config(struct spdk_json_write_ctx *w,
 
 		/* } */
 		spdk_json_write_object_end(w);
+
+		if (host->weight != 1) {
+			spdk_json_write_object_begin(w);
+			spdk_json_write_named_string(w, "method", "nvmf_subsystem_set_host_weight");
+
+			spdk_json_write_named_object_begin(w, "params");
+			spdk_json_write_named_string(w, "nqn", subsystem->subnqn);
+			spdk_json_write_named_string(w, "host", host->nqn);
+			spdk_json_write_named_uint32(w, "weight", host->weight);
+			spdk_json_write_object_end(w);
+
+			spdk_json_write_object_end(w);
+		}
 	}
 
 	for (ns = spdk_nvmf_subsystem_get_first_ns(subsystem); ns != NULL;
@@ -652,6 +720,10 @@ nvmf_write_nvme_subsystem_config(struct spdk_json_write_ctx *w,
 			spdk_json_write_named_uint32(w, "anagrpid", ns_opts.anagrpid);
 		}
 
+		if (ns_opts.passthru_io) {
+			spdk_json_write_named_bool(w, "passthru_io", true);
+		}
+
 		/*     "namespace" */
 		spdk_json_write_object_end(w);
 
@@ -660,6 +732,19 @@ nvmf_write_nvme_subsystem_config(struct spdk_json_write_ctx *w,
 
 		/* } */
 		spdk_json_write_object_end(w);
+
+		if (spdk_nvmf_ns_get_weight(ns) != 1) {
+			spdk_json_write_object_begin(w);
+			spdk_json_write_named_string(w, "method", "nvmf_subsystem_set_ns_weight");
+
+			spdk_json_write_named_object_begin(w, "params");
+			spdk_json_write_named_string(w, "nqn", subsystem->subnqn);
+			spdk_json_write_named_uint32(w, "nsid", spdk_nvmf_ns_get_id(ns));
+			spdk_json_write_named_uint32(w, "weight", spdk_nvmf_ns_get_weight(ns));
+			spdk_json_write_object_end(w);
+
+			spdk_json_write_object_end(w);
+		}
 	}
 }
 
@@ -974,7 +1059,7 @@ _nvmf_tgt_pause_polling(struct spdk_io_channel_iter *i)
 	struct spdk_io_channel *ch = spdk_io_channel_iter_get_channel(i);
 	struct spdk_nvmf_poll_group *group = spdk_io_channel_get_ctx(ch);
 
-	spdk_poller_unregister(&group->poller);
+	nvmf_poll_group_unregister_poller(group);
 
 	spdk_for_each_channel_continue(i, 0);
 }
@@ -1033,8 +1118,7 @@ _nvmf_tgt_resume_polling(struct spdk_io_channel_iter *i)
 	struct spdk_io_channel *ch = spdk_io_channel_iter_get_channel(i);
 	struct spdk_nvmf_poll_group *group = spdk_io_channel_get_ctx(ch);
 
-	assert(group->poller == NULL);
-	group->poller = SPDK_POLLER_REGISTER(nvmf_poll_group_poll, group, 0);
+	nvmf_poll_group_register_poller(group);
 
 	spdk_for_each_channel_continue(i, 0);
 }
@@ -1365,6 +1449,312 @@ _nvmf_qpair_destroy(void *ctx, int status)
 	nvmf_transport_qpair_fini(qpair, _nvmf_transport_qpair_fini_complete, qpair_ctx);
 }
 
+struct spdk_nvmf_qpair_move_ctx {
+	struct spdk_nvmf_qpair			*qpair;
+	struct spdk_nvmf_transport_poll_group	*src_tgroup;
+	struct spdk_nvmf_transport_poll_group	*dst_tgroup;
+	struct spdk_poller			*poller;
+	uint64_t				timeout_tsc;
+	struct spdk_thread			*thread;
+	spdk_nvmf_qpair_move_done_fn		cb_fn;
+	void					*cb_arg;
+	int					status;
+	/* Set once the qpair left the source poll group */
+	bool					detached;
+};
+
+static struct spdk_nvmf_transport_poll_group *
+nvmf_poll_group_get_tgroup(struct spdk_nvmf_poll_group *group,
+			   struct spdk_nvmf_transport *transport)
+{
+	struct spdk_nvmf_transport_poll_group *tgroup;
+
+	TAILQ_FOREACH(tgroup, &group->tgroups, link) {
+		if (tgroup->transport == transport) {
+			return tgroup;
+		}
+	}
+
+	return NULL;
+}
+
+static void
+_nvmf_qpair_move_done(void *_ctx)
+{
+	struct spdk_nvmf_qpair_move_ctx *ctx = _ctx;
+
+	if (ctx->cb_fn) {
+		ctx->cb_fn(ctx->cb_arg, ctx->status);
+	}
+	free(ctx);
+}
+
+static void
+nvmf_qpair_move_abort(struct spdk_nvmf_qpair *qpair, int status)
+{
+	struct spdk_nvmf_qpair_move_ctx *ctx = qpair->move_ctx;
+
+	assert(!ctx->detached);
+	spdk_poller_unregister(&ctx->poller);
+	nvmf_transport_poll_group_cancel_detach(ctx->src_tgroup, qpair);
+	qpair->move_ctx = NULL;
+	ctx->status = status;
+	_nvmf_qpair_move_done(ctx);
+}
+
+static void
+_nvmf_qpair_move_attach(void *_ctx)
+{
+	struct spdk_nvmf_qpair_move_ctx *ctx = _ctx;
+	struct spdk_nvmf_qpair *qpair = ctx->qpair;
+	struct spdk_nvmf_poll_group *group = ctx->dst_tgroup->group;
+	int rc;
+
+	assert(qpair->group == group);
+	rc = nvmf_transport_poll_group_attach(ctx->dst_tgroup, qpair);
+
+	/* The transport tracks the qpair even if the attach failed, so that it can be disconnected */
+	TAILQ_INSERT_TAIL(&group->qpairs, qpair, link);
+	group->stat.current_io_qpairs++;
+	qpair->move_ctx = NULL;
+
+	if (rc != 0) {
+		SPDK_ERRLOG("Unable to attach qpair=%p to the poll group, disconnecting it\n", qpair);
+		spdk_nvmf_qpair_disconnect(qpair, NULL, NULL);
+	}
+
+	ctx->status = rc;
+	spdk_thread_send_msg(ctx->thread, _nvmf_qpair_move_done, ctx);
+}
+
+static int
+nvmf_qpair_move_poll(void *_ctx)
+{
+	struct spdk_nvmf_qpair_move_ctx *ctx = _ctx;
+	struct spdk_nvmf_qpair *qpair = ctx->qpair;
+	struct spdk_nvmf_poll_group *group = qpair->group;
+	int rc;
+
+	rc = nvmf_transport_poll_group_detach(ctx->src_tgroup, qpair);
+	if (rc == -EAGAIN) {
+		if (spdk_get_ticks() < ctx->timeout_tsc) {
+			return SPDK_POLLER_IDLE;
+		}
+		rc = -ETIMEDOUT;
+	}
+
+	if (rc != 0) {
+		SPDK_ERRLOG("Unable to detach qpair=%p from the poll group: %s\n", qpair, spdk_strerror(-rc));
+		nvmf_qpair_move_abort(qpair, rc);
+		return SPDK_POLLER_BUSY;
+	}
+
+	assert(TAILQ_EMPTY(&qpair->outstanding));
+	spdk_poller_unregister(&ctx->poller);
+
+	TAILQ_REMOVE(&group->qpairs, qpair, link);
+	assert(group->stat.current_io_qpairs > 0);
+	group->stat.current_io_qpairs--;
+
+	ctx->detached = true;
+	qpair->group = ctx->dst_tgroup->group;
+	spdk_thread_send_msg(qpair->group->thread, _nvmf_qpair_move_attach, ctx);
+
+	return SPDK_POLLER_BUSY;
+}
+
+int
+spdk_nvmf_qpair_move(struct spdk_nvmf_qpair *qpair, struct spdk_nvmf_poll_group *group,
+		     spdk_nvmf_qpair_move_done_fn cb_fn, void *cb_arg)
+{
+	struct spdk_nvmf_qpair_move_ctx *ctx;
+	struct spdk_nvmf_transport_poll_group *src_tgroup, *dst_tgroup;
+
+	assert(qpair->group != NULL);
+	assert(spdk_get_thread() == qpair->group->thread);
+
+	if (qpair->qid == 0 || qpair->ctrlr == NULL || qpair->state != SPDK_NVMF_QPAIR_ACTIVE ||
+	    qpair->group == group) {
+		return -EINVAL;
+	}
+
+	if (qpair->move_ctx != NULL) {
+		return -EBUSY;
+	}
+
+	if (qpair->transport->ops->poll_group_detach == NULL ||
+	    qpair->transport->ops->poll_group_attach == NULL) {
+		return -ENOTSUP;
+	}
+
+	src_tgroup = nvmf_poll_group_get_tgroup(qpair->group, qpair->transport);
+	dst_tgroup = nvmf_poll_group_get_tgroup(group, qpair->transport);
+	if (src_tgroup == NULL || dst_tgroup == NULL) {
+		return -EINVAL;
+	}
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		return -ENOMEM;
+	}
+
+	ctx->qpair = qpair;
+	ctx->src_tgroup = src_tgroup;
+	ctx->dst_tgroup = dst_tgroup;
+	ctx->thread = spdk_get_thread();
+	ctx->cb_fn = cb_fn;
+	ctx->cb_arg = cb_arg;
+	ctx->timeout_tsc = spdk_get_ticks() + NVMF_QPAIR_MOVE_TIMEOUT_SEC * spdk_get_ticks_hz();
+
+	/* The qpair is quiesced by the poller, which keeps detaching it until no request is in flight */
+	ctx->poller = SPDK_POLLER_REGISTER(nvmf_qpair_move_poll, ctx, 0);
+	if (ctx->poller == NULL) {
+		free(ctx);
+		return -ENOMEM;
+	}
+
+	SPDK_DEBUGLOG(nvmf, "Moving qpair=%p (qid %u) to poll group=%p\n", qpair, qpair->qid, group);
+	qpair->move_ctx = ctx;
+
+	return 0;
+}
+
+struct nvmf_tgt_rebalance_ctx {
+	struct spdk_nvmf_poll_group	*busiest;
+	struct spdk_nvmf_poll_group	*idlest;
+	uint64_t			busiest_load;
+	uint64_t			idlest_load;
+	struct spdk_thread		*thread;
+	spdk_nvmf_tgt_rebalance_done_fn	cb_fn;
+	void				*cb_arg;
+	int				status;
+};
+
+static void
+_nvmf_tgt_rebalance_done(void *_ctx)
+{
+	struct nvmf_tgt_rebalance_ctx *ctx = _ctx;
+
+	if (ctx->cb_fn) {
+		ctx->cb_fn(ctx->cb_arg, ctx->status);
+	}
+	free(ctx);
+}
+
+static void
+nvmf_tgt_rebalance_move_done(void *_ctx, int status)
+{
+	struct nvmf_tgt_rebalance_ctx *ctx = _ctx;
+
+	ctx->status = status;
+	spdk_thread_send_msg(ctx->thread, _nvmf_tgt_rebalance_done, ctx);
+}
+
+static void
+_nvmf_tgt_rebalance_move(void *_ctx)
+{
+	struct nvmf_tgt_rebalance_ctx *ctx = _ctx;
+	struct spdk_nvmf_qpair *qpair, *best = NULL;
+	uint64_t diff, target, dist, best_dist = UINT64_MAX;
+	int rc;
+
+	diff = ctx->busiest_load - ctx->idlest_load;
+	target = diff / 2;
+
+	/* Pick the qpair whose load is the closest to half of the difference. A qpair carrying
+	 * the whole difference or more would only move the imbalance to the other poll group. */
+	TAILQ_FOREACH(qpair, &ctx->busiest->qpairs, link) {
+		if (qpair->qid == 0 || qpair->state != SPDK_NVMF_QPAIR_ACTIVE ||
+		    qpair->move_ctx != NULL || qpair->transport->ops->poll_group_detach == NULL ||
+		    qpair->last_period_nvme_io == 0 || qpair->last_period_nvme_io >= diff) {
+			continue;
+		}
+
+		dist = qpair->last_period_nvme_io > target ? qpair->last_period_nvme_io - target :
+		       target - qpair->last_period_nvme_io;
+		if (dist < best_dist) {
+			best = qpair;
+			best_dist = dist;
+		}
+	}
+
+	if (best == NULL) {
+		nvmf_tgt_rebalance_move_done(ctx, 0);
+		return;
+	}
+
+	rc = spdk_nvmf_qpair_move(best, ctx->idlest, nvmf_tgt_rebalance_move_done, ctx);
+	if (rc != 0) {
+		nvmf_tgt_rebalance_move_done(ctx, rc);
+	}
+}
+
+static void
+nvmf_tgt_rebalance_collect_done(struct spdk_io_channel_iter *i, int status)
+{
+	struct nvmf_tgt_rebalance_ctx *ctx = spdk_io_channel_iter_get_ctx(i);
+	uint64_t diff;
+
+	diff = ctx->busiest_load - ctx->idlest_load;
+	if (ctx->busiest == NULL || ctx->busiest == ctx->idlest ||
+	    diff * 100 < ctx->busiest_load * NVMF_REBALANCE_MIN_IMBALANCE_PCT) {
+		_nvmf_tgt_rebalance_done(ctx);
+		return;
+	}
+
+	SPDK_DEBUGLOG(nvmf, "Rebalancing poll group=%p (load %" PRIu64 ") to poll group=%p "
+		      "(load %" PRIu64 ")\n", ctx->busiest, ctx->busiest_load, ctx->idlest,
+		      ctx->idlest_load);
+	spdk_thread_send_msg(ctx->busiest->thread, _nvmf_tgt_rebalance_move, ctx);
+}
+
+static void
+nvmf_tgt_rebalance_collect(struct spdk_io_channel_iter *i)
+{
+	struct nvmf_tgt_rebalance_ctx *ctx = spdk_io_channel_iter_get_ctx(i);
+	struct spdk_io_channel *ch = spdk_io_channel_iter_get_channel(i);
+	struct spdk_nvmf_poll_group *group = spdk_io_channel_get_ctx(ch);
+	struct spdk_nvmf_qpair *qpair;
+	uint64_t load = 0;
+
+	TAILQ_FOREACH(qpair, &group->qpairs, link) {
+		qpair->last_period_nvme_io = qpair->completed_nvme_io;
+		qpair->completed_nvme_io = 0;
+		load += qpair->last_period_nvme_io;
+	}
+
+	if (ctx->busiest == NULL || load > ctx->busiest_load) {
+		ctx->busiest = group;
+		ctx->busiest_load = load;
+	}
+	if (ctx->idlest == NULL || load < ctx->idlest_load) {
+		ctx->idlest = group;
+		ctx->idlest_load = load;
+	}
+
+	spdk_for_each_channel_continue(i, 0);
+}
+
+int
+spdk_nvmf_tgt_rebalance_poll_groups(struct spdk_nvmf_tgt *tgt,
+				    spdk_nvmf_tgt_rebalance_done_fn cb_fn, void *cb_arg)
+{
+	struct nvmf_tgt_rebalance_ctx *ctx;
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		return -ENOMEM;
+	}
+
+	ctx->thread = spdk_get_thread();
+	ctx->cb_fn = cb_fn;
+	ctx->cb_arg = cb_arg;
+
+	spdk_for_each_channel(tgt, nvmf_tgt_rebalance_collect, ctx, nvmf_tgt_rebalance_collect_done);
+
+	return 0;
+}
+
 static void
 _nvmf_qpair_disconnect_msg(void *ctx)
 {
@@ -1417,8 +1807,33 @@ spdk_nvmf_qpair_disconnect(struct spdk_nvmf_qpair *qpair, nvmf_qpair_disconnect_
 		return 0;
 	}
 
+	if (spdk_unlikely(qpair->move_ctx != NULL)) {
+		if (qpair->move_ctx->detached) {
+			/* The qpair is on its way to this poll group, retry once it got attached */
+			__atomic_clear(&qpair->disconnect_started, __ATOMIC_RELAXED);
+			qpair_ctx = calloc(1, sizeof(struct nvmf_qpair_disconnect_ctx));
+			if (!qpair_ctx) {
+				SPDK_ERRLOG("Unable to allocate context for nvmf_qpair_disconnect\n");
+				return -ENOMEM;
+			}
+			qpair_ctx->qpair = qpair;
+			qpair_ctx->cb_fn = cb_fn;
+			qpair_ctx->thread = group->thread;
+			qpair_ctx->ctx = ctx;
+			spdk_thread_send_msg(group->thread, _nvmf_qpair_disconnect_msg, qpair_ctx);
+			return 0;
+		}
+
+		nvmf_qpair_move_abort(qpair, -ENOTCONN);
+	}
+
 	SPDK_DTRACE_PROBE2_TICKS(nvmf_qpair_disconnect, qpair, spdk_thread_get_id(group->thread));
 	assert(qpair->state == SPDK_NVMF_QPAIR_ACTIVE);
+
+	/* Requests waiting in the fair queuing stage would never get dispatched. Complete
+	 * them before the qpair starts waiting for its outstanding requests. */
+	nvmf_qpair_abort_fq_reqs(qpair);
+
 	nvmf_qpair_set_state(qpair, SPDK_NVMF_QPAIR_DEACTIVATING);
 
 	qpair_ctx = calloc(1, sizeof(struct nvmf_qpair_disconnect_ctx));
@@ -1656,6 +2071,10 @@ nvmf_poll_group_add_subsystem(struct spdk_nvmf_poll_group *group,
 	uint32_t i;
 
 	TAILQ_INIT(&sgroup->queued);
+	TAILQ_INIT(&sgroup->fq_flows);
+	sgroup->fq_vtime = 0;
+	sgroup->fq_queued = 0;
+	sgroup->fq_inflight = 0;
 
 	rc = poll_group_update_subsystem(group, subsystem);
 	if (rc) {
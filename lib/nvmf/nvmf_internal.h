@@ -81,6 +81,8 @@ struct spdk_nvmf_tgt {
 
 struct spdk_nvmf_host {
 	char				nqn[SPDK_NVMF_NQN_MAX_LEN + 1];
+	/* Fair queuing weight of this host's I/O */
+	uint32_t			weight;
 	TAILQ_ENTRY(spdk_nvmf_host)	link;
 };
 
@@ -123,6 +125,19 @@ struct spdk_nvmf_subsystem_pg_ns_info {
 	enum spdk_nvmf_subsystem_state	state;
 };
 
+/*
+ * I/O of a single host to a single namespace, queued by the weighted fair
+ * queuing stage of a subsystem poll group.
+ */
+struct spdk_nvmf_fq_flow {
+	char					hostnqn[SPDK_NVMF_NQN_MAX_LEN + 1];
+	uint32_t				nsid;
+	/* Virtual finish time of the last request queued to this flow */
+	uint64_t				finish_tag;
+	STAILQ_HEAD(, spdk_nvmf_request)	queued;
+	TAILQ_ENTRY(spdk_nvmf_fq_flow)		link;
+};
+
 typedef void(*spdk_nvmf_poll_group_mod_done)(void *cb_arg, int status);
 
 struct spdk_nvmf_subsystem_poll_group {
@@ -137,6 +152,14 @@ struct spdk_nvmf_subsystem_poll_group {
 	void					*cb_arg;
 
 	TAILQ_HEAD(, spdk_nvmf_request)		queued;
+
+	/* Weighted fair queuing of READ and WRITE commands. Only flows with
+	 * queued requests are kept on the list. */
+	TAILQ_HEAD(, spdk_nvmf_fq_flow)		fq_flows;
+	uint64_t				fq_vtime;
+	uint32_t				fq_queued;
+	uint32_t				fq_inflight;
+	bool					fq_dispatching;
 };
 
 struct spdk_nvmf_registrant {
@@ -171,8 +194,12 @@ struct spdk_nvmf_ns {
 	bool ptpl_activated;
 	/* ZCOPY supported on bdev device */
 	bool zcopy;
+	/* I/O commands are forwarded to the bdev as NVMe passthrough commands */
+	bool passthru_io;
 	/* Command Set Identifier */
 	enum spdk_nvme_csi csi;
+	/* Fair queuing weight of I/O to this namespace */
+	uint32_t weight;
 };
 
 /*
@@ -288,6 +315,12 @@ struct spdk_nvmf_subsystem {
 	uint64_t					max_discard_size_kib;
 	uint64_t					max_write_zeroes_size_kib;
 
+	/* Number of READ and WRITE commands each poll group runs at once before it starts
+	 * fair queuing them, 0 if fair queuing is disabled */
+	uint32_t					fq_max_inflight;
+	/* Incremented each time a host weight changes */
+	uint32_t					fq_weight_gen;
+
 	TAILQ_HEAD(, spdk_nvmf_ctrlr)			ctrlrs;
 
 	/* A mutex used to protect the hosts list and allow_any_host flag. Unlike the namespace
@@ -408,6 +441,8 @@ void nvmf_transport_listen_dump_trid(const struct spdk_nvme_transport_id *trid,
  */
 int nvmf_subsystem_set_cntlid_range(struct spdk_nvmf_subsystem *subsystem,
 				    uint16_t min_cntlid, uint16_t max_cntlid);
+uint32_t nvmf_subsystem_get_host_weight(struct spdk_nvmf_subsystem *subsystem,
+					const char *hostnqn);
 
 int nvmf_ctrlr_async_event_ns_notice(struct spdk_nvmf_ctrlr *ctrlr);
 int nvmf_ctrlr_async_event_ana_change_notice(struct spdk_nvmf_ctrlr *ctrlr);
@@ -429,6 +464,12 @@ bool nvmf_ns_is_ptpl_capable(const struct spdk_nvmf_ns *ns);
  */
 void nvmf_qpair_abort_pending_zcopy_reqs(struct spdk_nvmf_qpair *qpair);
 
+/*
+ * Abort the requests of a qpair that are waiting in the fair queuing stage of its poll group.
+ * They are completed with ABORTED - SQ DELETION status.
+ */
+void nvmf_qpair_abort_fq_reqs(struct spdk_nvmf_qpair *qpair);
+
 /*
  * Free aer simply frees the rdma resources for the aer without informing the host.
  * This function should be called when deleting a qpair when one wants to make sure
@@ -250,6 +250,10 @@ dump_nvmf_subsystem(struct spdk_json_write_ctx *w, struct spdk_nvmf_subsystem *s
 				spdk_json_write_named_uint32(w, "anagrpid", ns_opts.anagrpid);
 			}
 
+			if (ns_opts.passthru_io) {
+				spdk_json_write_named_bool(w, "passthru_io", true);
+			}
+
 			spdk_json_write_object_end(w);
 		}
 		spdk_json_write_array_end(w);
@@ -1377,6 +1381,7 @@ struct spdk_nvmf_ns_params {
 	char eui64[8];
 	struct spdk_uuid uuid;
 	uint32_t anagrpid;
+	bool passthru_io;
 };
 
 static const struct spdk_json_object_decoder rpc_ns_params_decoders[] = {
@@ -1387,6 +1392,7 @@ static const struct spdk_json_object_decoder rpc_ns_params_decoders[] = {
 	{"eui64", offsetof(struct spdk_nvmf_ns_params, eui64), decode_ns_eui64, true},
 	{"uuid", offsetof(struct spdk_nvmf_ns_params, uuid), spdk_json_decode_uuid, true},
 	{"anagrpid", offsetof(struct spdk_nvmf_ns_params, anagrpid), spdk_json_decode_uint32, true},
+	{"passthru_io", offsetof(struct spdk_nvmf_ns_params, passthru_io), spdk_json_decode_bool, true},
 };
 
 static int
@@ -1505,6 +1511,7 @@ nvmf_rpc_ns_paused(struct spdk_nvmf_subsystem *subsystem,
 	}
 
 	ns_opts.anagrpid = ctx->ns_params.anagrpid;
+	ns_opts.passthru_io = ctx->ns_params.passthru_io;
 
 	ctx->ns_params.nsid = spdk_nvmf_subsystem_add_ns_ext(subsystem, ctx->ns_params.bdev_name,
 			      &ns_opts, sizeof(ns_opts),
@@ -1903,6 +1910,185 @@ rpc_nvmf_subsystem_allow_any_host(struct spdk_jsonrpc_request *request,
 SPDK_RPC_REGISTER("nvmf_subsystem_allow_any_host", rpc_nvmf_subsystem_allow_any_host,
 		  SPDK_RPC_RUNTIME)
 
+struct nvmf_rpc_fq_ctx {
+	char *nqn;
+	char *host;
+	char *tgt_name;
+	uint32_t nsid;
+	uint32_t weight;
+	uint32_t max_inflight;
+};
+
+static const struct spdk_json_object_decoder nvmf_rpc_subsystem_fair_queuing_decoder[] = {
+	{"nqn", offsetof(struct nvmf_rpc_fq_ctx, nqn), spdk_json_decode_string},
+	{"max_inflight", offsetof(struct nvmf_rpc_fq_ctx, max_inflight), spdk_json_decode_uint32},
+	{"tgt_name", offsetof(struct nvmf_rpc_fq_ctx, tgt_name), spdk_json_decode_string, true},
+};
+
+static const struct spdk_json_object_decoder nvmf_rpc_subsystem_host_weight_decoder[] = {
+	{"nqn", offsetof(struct nvmf_rpc_fq_ctx, nqn), spdk_json_decode_string},
+	{"host", offsetof(struct nvmf_rpc_fq_ctx, host), spdk_json_decode_string},
+	{"weight", offsetof(struct nvmf_rpc_fq_ctx, weight), spdk_json_decode_uint32},
+	{"tgt_name", offsetof(struct nvmf_rpc_fq_ctx, tgt_name), spdk_json_decode_string, true},
+};
+
+static const struct spdk_json_object_decoder nvmf_rpc_subsystem_ns_weight_decoder[] = {
+	{"nqn", offsetof(struct nvmf_rpc_fq_ctx, nqn), spdk_json_decode_string},
+	{"nsid", offsetof(struct nvmf_rpc_fq_ctx, nsid), spdk_json_decode_uint32},
+	{"weight", offsetof(struct nvmf_rpc_fq_ctx, weight), spdk_json_decode_uint32},
+	{"tgt_name", offsetof(struct nvmf_rpc_fq_ctx, tgt_name), spdk_json_decode_string, true},
+};
+
+static void
+nvmf_rpc_fq_ctx_free(struct nvmf_rpc_fq_ctx *ctx)
+{
+	free(ctx->nqn);
+	free(ctx->host);
+	free(ctx->tgt_name);
+}
+
+static struct spdk_nvmf_subsystem *
+nvmf_rpc_fq_find_subsystem(struct spdk_jsonrpc_request *request, struct nvmf_rpc_fq_ctx *ctx)
+{
+	struct spdk_nvmf_subsystem *subsystem;
+	struct spdk_nvmf_tgt *tgt;
+
+	tgt = spdk_nvmf_get_tgt(ctx->tgt_name);
+	if (!tgt) {
+		SPDK_ERRLOG("Unable to find a target object.\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "Unable to find a target.");
+		return NULL;
+	}
+
+	subsystem = spdk_nvmf_tgt_find_subsystem(tgt, ctx->nqn);
+	if (!subsystem) {
+		SPDK_ERRLOG("Unable to find subsystem with NQN %s\n", ctx->nqn);
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS, "Invalid parameters");
+		return NULL;
+	}
+
+	return subsystem;
+}
+
+static void
+rpc_nvmf_subsystem_set_fair_queuing(struct spdk_jsonrpc_request *request,
+				    const struct spdk_json_val *params)
+{
+	struct nvmf_rpc_fq_ctx ctx = {};
+	struct spdk_nvmf_subsystem *subsystem;
+	int rc;
+
+	if (spdk_json_decode_object(params, nvmf_rpc_subsystem_fair_queuing_decoder,
+				    SPDK_COUNTOF(nvmf_rpc_subsystem_fair_queuing_decoder),
+				    &ctx)) {
+		SPDK_ERRLOG("spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS, "Invalid parameters");
+		nvmf_rpc_fq_ctx_free(&ctx);
+		return;
+	}
+
+	subsystem = nvmf_rpc_fq_find_subsystem(request, &ctx);
+	if (!subsystem) {
+		nvmf_rpc_fq_ctx_free(&ctx);
+		return;
+	}
+
+	rc = spdk_nvmf_subsystem_set_fair_queuing(subsystem, ctx.max_inflight);
+	if (rc != 0) {
+		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
+		nvmf_rpc_fq_ctx_free(&ctx);
+		return;
+	}
+
+	spdk_jsonrpc_send_bool_response(request, true);
+	nvmf_rpc_fq_ctx_free(&ctx);
+}
+SPDK_RPC_REGISTER("nvmf_subsystem_set_fair_queuing", rpc_nvmf_subsystem_set_fair_queuing,
+		  SPDK_RPC_RUNTIME)
+
+static void
+rpc_nvmf_subsystem_set_host_weight(struct spdk_jsonrpc_request *request,
+				   const struct spdk_json_val *params)
+{
+	struct nvmf_rpc_fq_ctx ctx = {};
+	struct spdk_nvmf_subsystem *subsystem;
+	int rc;
+
+	if (spdk_json_decode_object(params, nvmf_rpc_subsystem_host_weight_decoder,
+				    SPDK_COUNTOF(nvmf_rpc_subsystem_host_weight_decoder),
+				    &ctx)) {
+		SPDK_ERRLOG("spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS, "Invalid parameters");
+		nvmf_rpc_fq_ctx_free(&ctx);
+		return;
+	}
+
+	subsystem = nvmf_rpc_fq_find_subsystem(request, &ctx);
+	if (!subsystem) {
+		nvmf_rpc_fq_ctx_free(&ctx);
+		return;
+	}
+
+	rc = spdk_nvmf_subsystem_set_host_weight(subsystem, ctx.host, ctx.weight);
+	if (rc != 0) {
+		SPDK_ERRLOG("Unable to set weight of host %s: %s\n", ctx.host, spdk_strerror(-rc));
+		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
+		nvmf_rpc_fq_ctx_free(&ctx);
+		return;
+	}
+
+	spdk_jsonrpc_send_bool_response(request, true);
+	nvmf_rpc_fq_ctx_free(&ctx);
+}
+SPDK_RPC_REGISTER("nvmf_subsystem_set_host_weight", rpc_nvmf_subsystem_set_host_weight,
+		  SPDK_RPC_RUNTIME)
+
+static void
+rpc_nvmf_subsystem_set_ns_weight(struct spdk_jsonrpc_request *request,
+				 const struct spdk_json_val *params)
+{
+	struct nvmf_rpc_fq_ctx ctx = {};
+	struct spdk_nvmf_subsystem *subsystem;
+	struct spdk_nvmf_ns *ns;
+	int rc;
+
+	if (spdk_json_decode_object(params, nvmf_rpc_subsystem_ns_weight_decoder,
+				    SPDK_COUNTOF(nvmf_rpc_subsystem_ns_weight_decoder),
+				    &ctx)) {
+		SPDK_ERRLOG("spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS, "Invalid parameters");
+		nvmf_rpc_fq_ctx_free(&ctx);
+		return;
+	}
+
+	subsystem = nvmf_rpc_fq_find_subsystem(request, &ctx);
+	if (!subsystem) {
+		nvmf_rpc_fq_ctx_free(&ctx);
+		return;
+	}
+
+	ns = spdk_nvmf_subsystem_get_ns(subsystem, ctx.nsid);
+	if (!ns) {
+		SPDK_ERRLOG("Unable to find namespace %u in subsystem %s\n", ctx.nsid, ctx.nqn);
+		spdk_jsonrpc_send_error_response(request, -ENOENT, spdk_strerror(ENOENT));
+		nvmf_rpc_fq_ctx_free(&ctx);
+		return;
+	}
+
+	rc = spdk_nvmf_ns_set_weight(ns, ctx.weight);
+	if (rc != 0) {
+		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
+		nvmf_rpc_fq_ctx_free(&ctx);
+		return;
+	}
+
+	spdk_jsonrpc_send_bool_response(request, true);
+	nvmf_rpc_fq_ctx_free(&ctx);
+}
+SPDK_RPC_REGISTER("nvmf_subsystem_set_ns_weight", rpc_nvmf_subsystem_set_ns_weight,
+		  SPDK_RPC_RUNTIME)
+
 struct nvmf_rpc_target_ctx {
 	char *name;
 	uint32_t max_subsystems;
@@ -823,6 +823,7 @@ spdk_nvmf_subsystem_add_host(struct spdk_nvmf_subsystem *subsystem, const char *
 	}
 
 	snprintf(host->nqn, sizeof(host->nqn), "%s", hostnqn);
+	host->weight = 1;
 
 	SPDK_DTRACE_PROBE2(nvmf_subsystem_add_host, subsystem->subnqn, host->nqn);
 
@@ -885,6 +886,63 @@ spdk_nvmf_subsystem_remove_host(struct spdk_nvmf_subsystem *subsystem, const cha
 	return 0;
 }
 
+int
+spdk_nvmf_subsystem_set_host_weight(struct spdk_nvmf_subsystem *subsystem, const char *hostnqn,
+				    uint32_t weight)
+{
+	struct spdk_nvmf_host *host;
+
+	if (weight == 0 || weight > SPDK_NVMF_FQ_MAX_WEIGHT) {
+		return -EINVAL;
+	}
+
+	pthread_mutex_lock(&subsystem->mutex);
+
+	host = nvmf_subsystem_find_host(subsystem, hostnqn);
+	if (host == NULL) {
+		pthread_mutex_unlock(&subsystem->mutex);
+		return -ENOENT;
+	}
+
+	host->weight = weight;
+	/* Make the poll groups pick up the new weight */
+	__atomic_fetch_add(&subsystem->fq_weight_gen, 1, __ATOMIC_RELEASE);
+
+	pthread_mutex_unlock(&subsystem->mutex);
+
+	return 0;
+}
+
+uint32_t
+nvmf_subsystem_get_host_weight(struct spdk_nvmf_subsystem *subsystem, const char *hostnqn)
+{
+	struct spdk_nvmf_host *host;
+	uint32_t weight = 1;
+
+	pthread_mutex_lock(&subsystem->mutex);
+	host = nvmf_subsystem_find_host(subsystem, hostnqn);
+	if (host != NULL) {
+		weight = host->weight;
+	}
+	pthread_mutex_unlock(&subsystem->mutex);
+
+	return weight;
+}
+
+int
+spdk_nvmf_subsystem_set_fair_queuing(struct spdk_nvmf_subsystem *subsystem, uint32_t max_inflight)
+{
+	__atomic_store_n(&subsystem->fq_max_inflight, max_inflight, __ATOMIC_RELAXED);
+
+	return 0;
+}
+
+uint32_t
+spdk_nvmf_subsystem_get_fair_queuing(const struct spdk_nvmf_subsystem *subsystem)
+{
+	return __atomic_load_n(&subsystem->fq_max_inflight, __ATOMIC_RELAXED);
+}
+
 struct nvmf_subsystem_disconnect_host_ctx {
 	struct spdk_nvmf_subsystem		*subsystem;
 	char					*hostnqn;
@@ -1654,6 +1712,7 @@ spdk_nvmf_ns_opts_get_defaults(struct spdk_nvmf_ns_opts *opts, size_t opts_size)
 		spdk_uuid_set_null(&opts->uuid);
 	}
 	SET_FIELD(anagrpid, 0);
+	SET_FIELD(passthru_io, false);
 
 #undef FIELD_OK
 #undef SET_FIELD
@@ -1683,6 +1742,7 @@ nvmf_ns_opts_copy(struct spdk_nvmf_ns_opts *opts,
 		spdk_uuid_copy(&opts->uuid, &user_opts->uuid);
 	}
 	SET_FIELD(anagrpid);
+	SET_FIELD(passthru_io);
 
 	opts->opts_size = user_opts->opts_size;
 
@@ -1811,6 +1871,23 @@ spdk_nvmf_subsystem_add_ns_ext(struct spdk_nvmf_subsystem *subsystem, const char
 	/* Cache the zcopy capability of the bdev device */
 	ns->zcopy = spdk_bdev_io_type_supported(ns->bdev, SPDK_BDEV_IO_TYPE_ZCOPY);
 
+	if (opts.passthru_io) {
+		if (!spdk_bdev_io_type_supported(ns->bdev, SPDK_BDEV_IO_TYPE_NVME_IO)) {
+			SPDK_ERRLOG("Subsystem %s: bdev %s doesn't support NVMe passthrough I/O\n",
+				    subsystem->subnqn, bdev_name);
+			spdk_bdev_module_release_bdev(ns->bdev);
+			spdk_bdev_close(ns->desc);
+			free(ns);
+			return 0;
+		}
+
+		/* The commands are passed to the bdev as they are */
+		ns->passthru_io = true;
+		ns->zcopy = false;
+	}
+
+	ns->weight = 1;
+
 	if (spdk_uuid_is_null(&opts.uuid)) {
 		opts.uuid = *spdk_bdev_get_uuid(ns->bdev);
 	}
@@ -1966,6 +2043,24 @@ spdk_nvmf_ns_get_opts(const struct spdk_nvmf_ns *ns, struct spdk_nvmf_ns_opts *o
 	memcpy(opts, &ns->opts, spdk_min(sizeof(ns->opts), opts_size));
 }
 
+int
+spdk_nvmf_ns_set_weight(struct spdk_nvmf_ns *ns, uint32_t weight)
+{
+	if (weight == 0 || weight > SPDK_NVMF_FQ_MAX_WEIGHT) {
+		return -EINVAL;
+	}
+
+	__atomic_store_n(&ns->weight, weight, __ATOMIC_RELAXED);
+
+	return 0;
+}
+
+uint32_t
+spdk_nvmf_ns_get_weight(const struct spdk_nvmf_ns *ns)
+{
+	return __atomic_load_n(&ns->weight, __ATOMIC_RELAXED);
+}
+
 const char *
 spdk_nvmf_subsystem_get_sn(const struct spdk_nvmf_subsystem *subsystem)
 {
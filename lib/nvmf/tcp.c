@@ -29,6 +29,7 @@
 #define SPDK_NVMF_TCP_DEFAULT_SOCK_PRIORITY 0
 #define SPDK_NVMF_TCP_DEFAULT_CONTROL_MSG_NUM 32
 #define SPDK_NVMF_TCP_DEFAULT_SUCCESS_OPTIMIZATION true
+#define SPDK_NVMF_TCP_DEFAULT_RECV_BATCH_SIZE (64 * 1024)
 
 #define SPDK_NVMF_TCP_MIN_IO_QUEUE_DEPTH 2
 #define SPDK_NVMF_TCP_MAX_IO_QUEUE_DEPTH 65535
@@ -48,6 +49,10 @@
 
 #define TCP_PSK_INVALID_PERMISSIONS 0177
 
+/* Number of consecutive idle polls after which a poll group in interrupt mode stops
+ * busy polling and waits for socket events again */
+#define NVMF_TCP_POLL_GROUP_MAX_IDLE_POLLS 64
+
 const struct spdk_nvmf_transport_ops spdk_nvmf_transport_tcp;
 static bool g_tls_log = false;
 
@@ -290,6 +295,14 @@ struct spdk_nvmf_tcp_qpair {
 	uint32_t				resource_count;
 	uint32_t				recv_buf_size;
 
+	/* Data received from the socket in a batch but not parsed yet. It points to the poll
+	 * group's batch buffer while the qpair is processed, and to recv_stash otherwise.
+	 */
+	uint8_t					*recv_data;
+	uint32_t				recv_data_len;
+	uint8_t					*recv_stash;
+	uint32_t				recv_stash_size;
+
 	struct spdk_nvmf_tcp_port		*port;
 
 	/* IP address */
@@ -303,6 +316,11 @@ struct spdk_nvmf_tcp_qpair {
 	/* Wait until the host terminates the connection (e.g. after sending C2HTermReq) */
 	bool					wait_terminate;
 
+	/* Don't start new requests, the qpair is being moved to another poll group */
+	bool					detaching;
+	/* The socket is not part of the poll group's sock group */
+	bool					sock_detached;
+
 	/* Timer used to destroy qpair after detecting transport error issue if initiator does
 	 *  not close the connection.
 	 */
@@ -312,6 +330,7 @@ struct spdk_nvmf_tcp_qpair {
 	void					*fini_cb_arg;
 
 	TAILQ_ENTRY(spdk_nvmf_tcp_qpair)	link;
+	TAILQ_ENTRY(spdk_nvmf_tcp_qpair)	recv_link;
 };
 
 struct spdk_nvmf_tcp_control_msg {
@@ -329,10 +348,28 @@ struct spdk_nvmf_tcp_poll_group {
 
 	TAILQ_HEAD(, spdk_nvmf_tcp_qpair)	qpairs;
 	TAILQ_HEAD(, spdk_nvmf_tcp_qpair)	await_req;
+	/* qpairs holding received data they couldn't parse yet, e.g. waiting for a request */
+	TAILQ_HEAD(, spdk_nvmf_tcp_qpair)	recv_pending;
+
+	/* The sockets of all the qpairs are read into this buffer in large batches, so that
+	 * several PDUs are received with a single call.
+	 */
+	uint8_t					*recv_buf;
+	uint32_t				recv_buf_size;
 
 	struct spdk_io_channel			*accel_channel;
 	struct spdk_nvmf_tcp_control_msg_list	*control_msg_list;
 
+	/* Interrupt mode: sock_intr wakes the group up on socket events, while busy_intr
+	 * keeps it polling for as long as there is work in progress.
+	 */
+	struct spdk_interrupt			*sock_intr;
+	struct spdk_interrupt			*busy_intr;
+	int					busy_efd;
+	bool					in_interrupt;
+	bool					busy;
+	uint32_t				idle_polls;
+
 	TAILQ_ENTRY(spdk_nvmf_tcp_poll_group)	link;
 };
 
@@ -346,6 +383,7 @@ struct tcp_transport_opts {
 	bool		c2h_success;
 	uint16_t	control_msg_num;
 	uint32_t	sock_priority;
+	uint32_t	recv_batch_size;
 };
 
 struct tcp_psk_entry {
@@ -388,6 +426,10 @@ static const struct spdk_json_object_decoder tcp_transport_opts_decoder[] = {
 		"sock_priority", offsetof(struct tcp_transport_opts, sock_priority),
 		spdk_json_decode_uint32, true
 	},
+	{
+		"recv_batch_size", offsetof(struct tcp_transport_opts, recv_batch_size),
+		spdk_json_decode_uint32, true
+	},
 };
 
 static bool nvmf_tcp_req_process(struct spdk_nvmf_tcp_transport *ttransport,
@@ -570,6 +612,7 @@ _nvmf_tcp_qpair_destroy(void *_tqpair)
 	spdk_dma_free(tqpair->pdus);
 	free(tqpair->reqs);
 	spdk_free(tqpair->bufs);
+	free(tqpair->recv_stash);
 	free(tqpair);
 
 	if (cb_fn != NULL) {
@@ -598,6 +641,7 @@ nvmf_tcp_dump_opts(struct spdk_nvmf_transport *transport, struct spdk_json_write
 	ttransport = SPDK_CONTAINEROF(transport, struct spdk_nvmf_tcp_transport, transport);
 	spdk_json_write_named_bool(w, "c2h_success", ttransport->tcp_opts.c2h_success);
 	spdk_json_write_named_uint32(w, "sock_priority", ttransport->tcp_opts.sock_priority);
+	spdk_json_write_named_uint32(w, "recv_batch_size", ttransport->tcp_opts.recv_batch_size);
 }
 
 static int
@@ -647,6 +691,7 @@ nvmf_tcp_create(struct spdk_nvmf_transport_opts *opts)
 	ttransport->tcp_opts.c2h_success = SPDK_NVMF_TCP_DEFAULT_SUCCESS_OPTIMIZATION;
 	ttransport->tcp_opts.sock_priority = SPDK_NVMF_TCP_DEFAULT_SOCK_PRIORITY;
 	ttransport->tcp_opts.control_msg_num = SPDK_NVMF_TCP_DEFAULT_CONTROL_MSG_NUM;
+	ttransport->tcp_opts.recv_batch_size = SPDK_NVMF_TCP_DEFAULT_RECV_BATCH_SIZE;
 	if (opts->transport_specific != NULL &&
 	    spdk_json_decode_object_relaxed(opts->transport_specific, tcp_transport_opts_decoder,
 					    SPDK_COUNTOF(tcp_transport_opts_decoder),
@@ -664,7 +709,8 @@ nvmf_tcp_create(struct spdk_nvmf_transport_opts *opts)
 		     "  in_capsule_data_size=%d, max_aq_depth=%d\n"
 		     "  num_shared_buffers=%d, c2h_success=%d,\n"
 		     "  dif_insert_or_strip=%d, sock_priority=%d\n"
-		     "  abort_timeout_sec=%d, control_msg_num=%hu\n",
+		     "  abort_timeout_sec=%d, control_msg_num=%hu\n"
+		     "  recv_batch_size=%u\n",
 		     opts->max_queue_depth,
 		     opts->max_io_size,
 		     opts->max_qpairs_per_ctrlr - 1,
@@ -676,7 +722,8 @@ nvmf_tcp_create(struct spdk_nvmf_transport_opts *opts)
 		     opts->dif_insert_or_strip,
 		     ttransport->tcp_opts.sock_priority,
 		     opts->abort_timeout_sec,
-		     ttransport->tcp_opts.control_msg_num);
+		     ttransport->tcp_opts.control_msg_num,
+		     ttransport->tcp_opts.recv_batch_size);
 
 	if (ttransport->tcp_opts.sock_priority > SPDK_NVMF_TCP_DEFAULT_MAX_SOCK_PRIORITY) {
 		SPDK_ERRLOG("Unsupported socket_priority=%d, the current range is: 0 to %d\n"
@@ -1049,6 +1096,45 @@ _pdu_write_done(struct nvme_tcp_pdu *pdu, int err)
 	pdu->sock_req.cb_fn(pdu->sock_req.cb_arg, err);
 }
 
+static void
+nvmf_tcp_poll_group_set_busy(struct spdk_nvmf_tcp_poll_group *tgroup, bool busy)
+{
+	uint64_t notify = 1;
+	ssize_t rc;
+
+	tgroup->idle_polls = 0;
+	if (tgroup->busy == busy) {
+		return;
+	}
+
+	if (busy) {
+		/* Write without read on eventfd will get it repeatedly triggered. */
+		rc = write(tgroup->busy_efd, &notify, sizeof(notify));
+	} else {
+		/* Read on eventfd will clear its level triggering. */
+		rc = read(tgroup->busy_efd, &notify, sizeof(notify));
+	}
+
+	if (rc < 0) {
+		SPDK_ERRLOG("Failed to %s busy polling of tgroup=%p: %s\n",
+			    busy ? "start" : "stop", tgroup, spdk_strerror(errno));
+		return;
+	}
+
+	tgroup->busy = busy;
+}
+
+/* Make sure a poll group waiting for interrupts gets polled, e.g. to flush the responses
+ * queued outside of its poller.
+ */
+static inline void
+nvmf_tcp_poll_group_kick(struct spdk_nvmf_tcp_poll_group *tgroup)
+{
+	if (tgroup != NULL && spdk_unlikely(tgroup->in_interrupt) && !tgroup->busy) {
+		nvmf_tcp_poll_group_set_busy(tgroup, true);
+	}
+}
+
 static void
 _tcp_write_pdu(struct nvme_tcp_pdu *pdu)
 {
@@ -1059,6 +1145,7 @@ _tcp_write_pdu(struct nvme_tcp_pdu *pdu)
 	pdu->sock_req.iovcnt = nvme_tcp_build_iovs(pdu->iov, SPDK_COUNTOF(pdu->iov), pdu,
 			       tqpair->host_hdgst_enable, tqpair->host_ddgst_enable, &mapped_length);
 	spdk_sock_writev_async(tqpair->sock, &pdu->sock_req);
+	nvmf_tcp_poll_group_kick(tqpair->group);
 
 	if (pdu->hdr.common.pdu_type == SPDK_NVME_TCP_PDU_TYPE_IC_RESP ||
 	    pdu->hdr.common.pdu_type == SPDK_NVME_TCP_PDU_TYPE_C2H_TERM_REQ) {
@@ -1442,6 +1529,159 @@ nvmf_tcp_control_msg_list_free(struct spdk_nvmf_tcp_control_msg_list *list)
 	free(list);
 }
 
+static int nvmf_tcp_poll_group_poll(struct spdk_nvmf_transport_poll_group *group);
+
+static bool
+nvmf_tcp_poll_group_has_pending_work(struct spdk_nvmf_tcp_poll_group *tgroup)
+{
+	struct spdk_nvmf_tcp_qpair *tqpair;
+
+	if (!STAILQ_EMPTY(&tgroup->group.pending_buf_queue) || !TAILQ_EMPTY(&tgroup->await_req) ||
+	    !TAILQ_EMPTY(&tgroup->recv_pending)) {
+		return true;
+	}
+
+	/* Queued writes are only flushed by polling the sock group, there's no event for them */
+	TAILQ_FOREACH(tqpair, &tgroup->qpairs, link) {
+		if (tqpair->state_cntr[TCP_REQUEST_STATE_TRANSFERRING_CONTROLLER_TO_HOST] > 0 ||
+		    tqpair->state_cntr[TCP_REQUEST_STATE_AWAITING_R2T_ACK] > 0) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static int
+nvmf_tcp_poll_group_intr(void *ctx)
+{
+	struct spdk_nvmf_tcp_poll_group *tgroup = ctx;
+	int rc;
+
+	rc = nvmf_tcp_poll_group_poll(&tgroup->group);
+
+	if (rc > 0 || nvmf_tcp_poll_group_has_pending_work(tgroup)) {
+		/* Busy poll while the group has work to do rather than waking up for each event */
+		nvmf_tcp_poll_group_set_busy(tgroup, true);
+	} else if (tgroup->busy && ++tgroup->idle_polls >= NVMF_TCP_POLL_GROUP_MAX_IDLE_POLLS) {
+		nvmf_tcp_poll_group_set_busy(tgroup, false);
+	}
+
+	return rc > 0 ? SPDK_POLLER_BUSY : SPDK_POLLER_IDLE;
+}
+
+static void
+nvmf_tcp_poll_group_set_interrupt_mode(struct spdk_poller *poller, void *cb_arg,
+				       bool interrupt_mode)
+{
+	struct spdk_nvmf_tcp_poll_group *tgroup = cb_arg;
+
+	tgroup->in_interrupt = interrupt_mode;
+	/* Poll once after switching to interrupt mode to catch up with the pending work,
+	 * the busy eventfd isn't waited on in poll mode.
+	 */
+	nvmf_tcp_poll_group_set_busy(tgroup, interrupt_mode);
+}
+
+static int
+nvmf_tcp_poll_group_intr_init(struct spdk_nvmf_tcp_poll_group *tgroup,
+			      struct spdk_nvmf_poll_group *group)
+{
+	int fd;
+
+	fd = spdk_sock_group_get_interrupt_fd(tgroup->sock_group);
+	if (fd == -ENOTSUP) {
+		/* Some sock modules, e.g. uring, have no fd to wait on, keep polling the group */
+		SPDK_NOTICELOG("Sock group of tgroup=%p has no interrupt fd, polling it instead\n",
+			       tgroup);
+		return 0;
+	}
+	if (fd < 0) {
+		SPDK_ERRLOG("Interrupt mode is not supported by the sock group: %s\n",
+			    spdk_strerror(-fd));
+		return fd;
+	}
+
+	tgroup->sock_intr = SPDK_INTERRUPT_REGISTER(fd, nvmf_tcp_poll_group_intr, tgroup);
+	if (tgroup->sock_intr == NULL) {
+		return -ENOMEM;
+	}
+
+	tgroup->busy_efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (tgroup->busy_efd < 0) {
+		return -errno;
+	}
+
+	tgroup->busy_intr = SPDK_INTERRUPT_REGISTER(tgroup->busy_efd, nvmf_tcp_poll_group_intr,
+			    tgroup);
+	if (tgroup->busy_intr == NULL) {
+		return -ENOMEM;
+	}
+
+	/* The poll group's poller doesn't have to run in interrupt mode, the interrupts
+	 * above poll the transport instead.
+	 */
+	spdk_poller_register_interrupt(group->poller, nvmf_tcp_poll_group_set_interrupt_mode,
+				       tgroup);
+
+	return 0;
+}
+
+static void
+nvmf_tcp_poll_group_set_interrupt_mode_noop(struct spdk_poller *poller, void *cb_arg,
+		bool interrupt_mode)
+{
+}
+
+static void
+nvmf_tcp_poll_group_intr_fini(struct spdk_nvmf_tcp_poll_group *tgroup)
+{
+	struct spdk_nvmf_poll_group *group = tgroup->group.group;
+
+	if (tgroup->busy_intr != NULL && group != NULL && group->poller != NULL) {
+		/* The poller may outlive the transport poll group */
+		spdk_poller_register_interrupt(group->poller,
+					       nvmf_tcp_poll_group_set_interrupt_mode_noop, NULL);
+	}
+
+	spdk_interrupt_unregister(&tgroup->busy_intr);
+	if (tgroup->busy_efd >= 0) {
+		close(tgroup->busy_efd);
+		tgroup->busy_efd = -1;
+	}
+	spdk_interrupt_unregister(&tgroup->sock_intr);
+	tgroup->in_interrupt = false;
+	tgroup->busy = false;
+}
+
+static void
+nvmf_tcp_poll_group_pause(struct spdk_nvmf_transport_poll_group *group)
+{
+	struct spdk_nvmf_tcp_poll_group *tgroup;
+
+	tgroup = SPDK_CONTAINEROF(group, struct spdk_nvmf_tcp_poll_group, group);
+	nvmf_tcp_poll_group_intr_fini(tgroup);
+}
+
+static int
+nvmf_tcp_poll_group_resume(struct spdk_nvmf_transport_poll_group *group)
+{
+	struct spdk_nvmf_tcp_poll_group *tgroup;
+	int rc;
+
+	if (!spdk_interrupt_mode_is_enabled()) {
+		return 0;
+	}
+
+	tgroup = SPDK_CONTAINEROF(group, struct spdk_nvmf_tcp_poll_group, group);
+	rc = nvmf_tcp_poll_group_intr_init(tgroup, group->group);
+	if (rc != 0) {
+		nvmf_tcp_poll_group_intr_fini(tgroup);
+	}
+
+	return rc;
+}
+
 static struct spdk_nvmf_transport_poll_group *
 nvmf_tcp_poll_group_create(struct spdk_nvmf_transport *transport,
 			   struct spdk_nvmf_poll_group *group)
@@ -1453,6 +1693,7 @@ nvmf_tcp_poll_group_create(struct spdk_nvmf_transport *transport,
 	if (!tgroup) {
 		return NULL;
 	}
+	tgroup->busy_efd = -1;
 
 	tgroup->sock_group = spdk_sock_group_create(&tgroup->group);
 	if (!tgroup->sock_group) {
@@ -1461,9 +1702,18 @@ nvmf_tcp_poll_group_create(struct spdk_nvmf_transport *transport,
 
 	TAILQ_INIT(&tgroup->qpairs);
 	TAILQ_INIT(&tgroup->await_req);
+	TAILQ_INIT(&tgroup->recv_pending);
 
 	ttransport = SPDK_CONTAINEROF(transport, struct spdk_nvmf_tcp_transport, transport);
 
+	if (ttransport->tcp_opts.recv_batch_size != 0) {
+		tgroup->recv_buf = malloc(ttransport->tcp_opts.recv_batch_size);
+		if (!tgroup->recv_buf) {
+			goto cleanup;
+		}
+		tgroup->recv_buf_size = ttransport->tcp_opts.recv_batch_size;
+	}
+
 	if (transport->opts.in_capsule_data_size < SPDK_NVME_TCP_IN_CAPSULE_DATA_MAX_SIZE) {
 		SPDK_DEBUGLOG(nvmf_tcp, "ICD %u is less than min required for admin/fabric commands (%u). "
 			      "Creating control messages list\n", transport->opts.in_capsule_data_size,
@@ -1480,6 +1730,13 @@ nvmf_tcp_poll_group_create(struct spdk_nvmf_transport *transport,
 		goto cleanup;
 	}
 
+	if (spdk_interrupt_mode_is_enabled()) {
+		if (nvmf_tcp_poll_group_intr_init(tgroup, group) != 0) {
+			SPDK_ERRLOG("Cannot set up interrupts for tgroup=%p\n", tgroup);
+			goto cleanup;
+		}
+	}
+
 	TAILQ_INSERT_TAIL(&ttransport->poll_groups, tgroup, link);
 	if (ttransport->next_pg == NULL) {
 		ttransport->next_pg = tgroup;
@@ -1536,6 +1793,7 @@ nvmf_tcp_poll_group_destroy(struct spdk_nvmf_transport_poll_group *group)
 	struct spdk_nvmf_tcp_transport *ttransport;
 
 	tgroup = SPDK_CONTAINEROF(group, struct spdk_nvmf_tcp_poll_group, group);
+	nvmf_tcp_poll_group_intr_fini(tgroup);
 	spdk_sock_group_close(&tgroup->sock_group);
 	if (tgroup->control_msg_list) {
 		nvmf_tcp_control_msg_list_free(tgroup->control_msg_list);
@@ -1545,6 +1803,8 @@ nvmf_tcp_poll_group_destroy(struct spdk_nvmf_transport_poll_group *group)
 		spdk_put_io_channel(tgroup->accel_channel);
 	}
 
+	free(tgroup->recv_buf);
+
 	if (tgroup->group.transport == NULL) {
 		/* Transport can be NULL when nvmf_tcp_poll_group_create()
 		 * calls this function directly in a failure path. */
@@ -1672,6 +1932,11 @@ nvmf_tcp_capsule_cmd_hdr_handle(struct spdk_nvmf_tcp_transport *ttransport,
 	assert(pdu->psh_valid_bytes == pdu->psh_len);
 	assert(pdu->hdr.common.pdu_type == SPDK_NVME_TCP_PDU_TYPE_CAPSULE_CMD);
 
+	if (spdk_unlikely(tqpair->detaching)) {
+		/* Leave the command pending until the qpair is attached to its new poll group */
+		return;
+	}
+
 	tcp_req = nvmf_tcp_req_get(tqpair);
 	if (!tcp_req) {
 		/* Directly return and make the allocation retry again.  This can happen if we're
@@ -2292,8 +2557,128 @@ err:
 	nvmf_tcp_send_c2h_term_req(tqpair, pdu, fes, error_offset);
 }
 
+static inline bool
+nvmf_tcp_qpair_recv_batched(struct spdk_nvmf_tcp_qpair *tqpair)
+{
+	return tqpair->group != NULL && tqpair->group->recv_buf != NULL;
+}
+
+static inline void
+nvmf_tcp_qpair_consume_recv_data(struct spdk_nvmf_tcp_qpair *tqpair, uint32_t len)
+{
+	assert(len <= tqpair->recv_data_len);
+	tqpair->recv_data += len;
+	tqpair->recv_data_len -= len;
+}
+
+/* Receive as much data as the poll group's batch buffer can hold */
 static int
-nvmf_tcp_sock_process(struct spdk_nvmf_tcp_qpair *tqpair)
+nvmf_tcp_qpair_recv_batch(struct spdk_nvmf_tcp_qpair *tqpair)
+{
+	struct spdk_nvmf_tcp_poll_group *tgroup = tqpair->group;
+	int rc;
+
+	assert(tqpair->recv_data_len == 0);
+
+	rc = nvme_tcp_read_data(tqpair->sock, tgroup->recv_buf_size, tgroup->recv_buf);
+	if (rc > 0) {
+		tqpair->recv_data = tgroup->recv_buf;
+		tqpair->recv_data_len = rc;
+	}
+
+	return rc;
+}
+
+static int
+nvmf_tcp_qpair_read_data(struct spdk_nvmf_tcp_qpair *tqpair, uint32_t len, void *buf)
+{
+	int rc;
+
+	if (tqpair->recv_data_len == 0) {
+		if (!nvmf_tcp_qpair_recv_batched(tqpair)) {
+			return nvme_tcp_read_data(tqpair->sock, len, buf);
+		}
+
+		rc = nvmf_tcp_qpair_recv_batch(tqpair);
+		if (rc <= 0) {
+			return rc;
+		}
+	}
+
+	len = spdk_min(len, tqpair->recv_data_len);
+	memcpy(buf, tqpair->recv_data, len);
+	nvmf_tcp_qpair_consume_recv_data(tqpair, len);
+
+	return len;
+}
+
+static int
+nvmf_tcp_qpair_read_payload_data(struct spdk_nvmf_tcp_qpair *tqpair, struct nvme_tcp_pdu *pdu)
+{
+	struct iovec iov[NVME_TCP_MAX_SGL_DESCRIPTORS + 1];
+	uint32_t mapped_length = 0, len;
+	int iovcnt, rc;
+
+	if (tqpair->recv_data_len == 0 && !nvmf_tcp_qpair_recv_batched(tqpair)) {
+		return nvme_tcp_read_payload_data(tqpair->sock, pdu);
+	}
+
+	iovcnt = nvme_tcp_build_payload_iovs(iov, SPDK_COUNTOF(iov), pdu, pdu->ddgst_enable,
+					     &mapped_length);
+	assert(iovcnt >= 0);
+
+	if (tqpair->recv_data_len == 0) {
+		/* Batching doesn't pay off for a payload that fills the batch buffer on its own, so
+		 * receive it directly to the request's buffers.
+		 */
+		if (mapped_length >= tqpair->group->recv_buf_size) {
+			return nvme_tcp_readv_data(tqpair->sock, iov, iovcnt);
+		}
+
+		rc = nvmf_tcp_qpair_recv_batch(tqpair);
+		if (rc <= 0) {
+			return rc;
+		}
+	}
+
+	len = spdk_min(mapped_length, tqpair->recv_data_len);
+	spdk_copy_buf_to_iovs(iov, iovcnt, tqpair->recv_data, len);
+	nvmf_tcp_qpair_consume_recv_data(tqpair, len);
+
+	return len;
+}
+
+/* Move the data that is left in the poll group's batch buffer to the qpair's own buffer, the
+ * batch buffer is reused for the next qpair.
+ */
+static int
+nvmf_tcp_qpair_stash_recv_data(struct spdk_nvmf_tcp_qpair *tqpair)
+{
+	uint8_t *stash;
+
+	if (tqpair->recv_data >= tqpair->recv_stash &&
+	    tqpair->recv_data < tqpair->recv_stash + tqpair->recv_stash_size) {
+		/* Already stashed */
+		return 0;
+	}
+
+	if (tqpair->recv_stash_size < tqpair->recv_data_len) {
+		stash = realloc(tqpair->recv_stash, tqpair->recv_data_len);
+		if (!stash) {
+			return -ENOMEM;
+		}
+		tqpair->recv_stash = stash;
+		tqpair->recv_stash_size = tqpair->recv_data_len;
+	}
+
+	memcpy(tqpair->recv_stash, tqpair->recv_data, tqpair->recv_data_len);
+	tqpair->recv_data = tqpair->recv_stash;
+
+	return 0;
+}
+
+static int
+_nvmf_tcp_sock_process(struct spdk_nvmf_tcp_qpair *tqpair)
 {
 	int rc = 0;
 	struct nvme_tcp_pdu *pdu;
@@ -2333,9 +2718,9 @@ nvmf_tcp_sock_process(struct spdk_nvmf_tcp_qpair *tqpair)
 				return rc;
 			}
 
-			rc = nvme_tcp_read_data(tqpair->sock,
-						sizeof(struct spdk_nvme_tcp_common_pdu_hdr) - pdu->ch_valid_bytes,
-						(void *)&pdu->hdr.common + pdu->ch_valid_bytes);
+			rc = nvmf_tcp_qpair_read_data(tqpair,
+						      sizeof(struct spdk_nvme_tcp_common_pdu_hdr) - pdu->ch_valid_bytes,
+						      (void *)&pdu->hdr.common + pdu->ch_valid_bytes);
 			if (rc < 0) {
 				SPDK_DEBUGLOG(nvmf_tcp, "will disconnect tqpair=%p\n", tqpair);
 				nvmf_tcp_qpair_set_recv_state(tqpair, NVME_TCP_PDU_RECV_STATE_QUIESCING);
@@ -2354,9 +2739,9 @@ nvmf_tcp_sock_process(struct spdk_nvmf_tcp_qpair *tqpair)
 			break;
 		/* Wait for the pdu specific header  */
 		case NVME_TCP_PDU_RECV_STATE_AWAIT_PDU_PSH:
-			rc = nvme_tcp_read_data(tqpair->sock,
-						pdu->psh_len - pdu->psh_valid_bytes,
-						(void *)&pdu->hdr.raw + sizeof(struct spdk_nvme_tcp_common_pdu_hdr) + pdu->psh_valid_bytes);
+			rc = nvmf_tcp_qpair_read_data(tqpair,
+						      pdu->psh_len - pdu->psh_valid_bytes,
+						      (void *)&pdu->hdr.raw + sizeof(struct spdk_nvme_tcp_common_pdu_hdr) + pdu->psh_valid_bytes);
 			if (rc < 0) {
 				nvmf_tcp_qpair_set_recv_state(tqpair, NVME_TCP_PDU_RECV_STATE_QUIESCING);
 				break;
@@ -2390,7 +2775,7 @@ nvmf_tcp_sock_process(struct spdk_nvmf_tcp_qpair *tqpair)
 				pdu->ddgst_enable = true;
 			}
 
-			rc = nvme_tcp_read_payload_data(tqpair->sock, pdu);
+			rc = nvmf_tcp_qpair_read_payload_data(tqpair, pdu);
 			if (rc < 0) {
 				nvmf_tcp_qpair_set_recv_state(tqpair, NVME_TCP_PDU_RECV_STATE_QUIESCING);
 				break;
@@ -2434,6 +2819,37 @@ nvmf_tcp_sock_process(struct spdk_nvmf_tcp_qpair *tqpair)
 	return rc;
 }
 
+static int
+nvmf_tcp_sock_process(struct spdk_nvmf_tcp_qpair *tqpair)
+{
+	bool pending = tqpair->recv_data_len > 0;
+	int rc;
+
+	rc = _nvmf_tcp_sock_process(tqpair);
+
+	if (spdk_unlikely(tqpair->recv_state == NVME_TCP_PDU_RECV_STATE_QUIESCING ||
+			  tqpair->recv_state == NVME_TCP_PDU_RECV_STATE_ERROR)) {
+		/* Nothing received after a fatal error is parsed anymore */
+		tqpair->recv_data_len = 0;
+	} else if (tqpair->recv_data_len > 0 && nvmf_tcp_qpair_stash_recv_data(tqpair) != 0) {
+		SPDK_ERRLOG("Cannot keep the received data of tqpair=%p\n", tqpair);
+		nvmf_tcp_qpair_set_recv_state(tqpair, NVME_TCP_PDU_RECV_STATE_QUIESCING);
+		tqpair->recv_data_len = 0;
+		rc = NVME_TCP_PDU_FATAL;
+	}
+
+	/* The socket won't report the data that is already received, so the poll group has to
+	 * process the qpair again once it can make progress.
+	 */
+	if (tqpair->recv_data_len > 0 && !pending) {
+		TAILQ_INSERT_TAIL(&tqpair->group->recv_pending, tqpair, recv_link);
+	} else if (tqpair->recv_data_len == 0 && pending) {
+		TAILQ_REMOVE(&tqpair->group->recv_pending, tqpair, recv_link);
+	}
+
+	return rc;
+}
+
 static inline void *
 nvmf_tcp_control_msg_get(struct spdk_nvmf_tcp_control_msg_list *list)
 {
@@ -3271,6 +3687,15 @@ nvmf_tcp_poll_group_remove(struct spdk_nvmf_transport_poll_group *group,
 		nvmf_tcp_qpair_set_recv_state(tqpair, NVME_TCP_PDU_RECV_STATE_QUIESCING);
 	}
 	TAILQ_REMOVE(&tgroup->qpairs, tqpair, link);
+	if (tqpair->recv_data_len > 0) {
+		TAILQ_REMOVE(&tgroup->recv_pending, tqpair, recv_link);
+		tqpair->recv_data_len = 0;
+	}
+
+	if (spdk_unlikely(tqpair->sock_detached)) {
+		/* The socket couldn't be added to the sock group after moving the qpair */
+		return 0;
+	}
 
 	rc = spdk_sock_group_remove_sock(tgroup->sock_group, tqpair->sock);
 	if (rc != 0) {
@@ -3281,6 +3706,116 @@ nvmf_tcp_poll_group_remove(struct spdk_nvmf_transport_poll_group *group,
 	return rc;
 }
 
+static int
+nvmf_tcp_poll_group_detach(struct spdk_nvmf_transport_poll_group *group,
+			   struct spdk_nvmf_qpair *qpair)
+{
+	struct spdk_nvmf_tcp_poll_group	*tgroup;
+	struct spdk_nvmf_tcp_qpair		*tqpair;
+	int				rc;
+
+	tgroup = SPDK_CONTAINEROF(group, struct spdk_nvmf_tcp_poll_group, group);
+	tqpair = SPDK_CONTAINEROF(qpair, struct spdk_nvmf_tcp_qpair, qpair);
+
+	assert(tqpair->group == tgroup);
+	tqpair->detaching = true;
+
+	if (tqpair->recv_state == NVME_TCP_PDU_RECV_STATE_QUIESCING ||
+	    tqpair->recv_state == NVME_TCP_PDU_RECV_STATE_ERROR) {
+		return -ENOTCONN;
+	}
+
+	/* A request is freed only once its response has been written to the socket, so nothing
+	 * is left in the socket's send queue either when all the requests are free. */
+	if (tqpair->state_cntr[TCP_REQUEST_STATE_FREE] != tqpair->resource_count) {
+		return -EAGAIN;
+	}
+
+	rc = spdk_sock_group_remove_sock(tgroup->sock_group, tqpair->sock);
+	if (rc != 0) {
+		SPDK_ERRLOG("Could not remove sock from sock_group: %s (%d)\n",
+			    spdk_strerror(errno), errno);
+		tqpair->detaching = false;
+		return -errno;
+	}
+
+	SPDK_DEBUGLOG(nvmf_tcp, "detach tqpair=%p from the tgroup=%p\n", tqpair, tgroup);
+	if (tqpair->recv_state == NVME_TCP_PDU_RECV_STATE_AWAIT_REQ) {
+		TAILQ_REMOVE(&tgroup->await_req, tqpair, link);
+	} else {
+		TAILQ_REMOVE(&tgroup->qpairs, tqpair, link);
+	}
+	/* The data already received from the socket stays stashed in the qpair and is parsed
+	 * once it got attached to its new poll group */
+	if (tqpair->recv_data_len > 0) {
+		TAILQ_REMOVE(&tgroup->recv_pending, tqpair, recv_link);
+	}
+	tqpair->group = NULL;
+	tqpair->sock_detached = true;
+
+	return 0;
+}
+
+static int
+nvmf_tcp_poll_group_attach(struct spdk_nvmf_transport_poll_group *group,
+			   struct spdk_nvmf_qpair *qpair)
+{
+	struct spdk_nvmf_tcp_poll_group	*tgroup;
+	struct spdk_nvmf_tcp_qpair		*tqpair;
+	int				rc;
+
+	tgroup = SPDK_CONTAINEROF(group, struct spdk_nvmf_tcp_poll_group, group);
+	tqpair = SPDK_CONTAINEROF(qpair, struct spdk_nvmf_tcp_qpair, qpair);
+
+	assert(tqpair->group == NULL);
+	assert(tqpair->detaching);
+
+	SPDK_DEBUGLOG(nvmf_tcp, "attach tqpair=%p to the tgroup=%p\n", tqpair, tgroup);
+	tqpair->group = tgroup;
+	tqpair->detaching = false;
+
+	/* A command received during the move waits for a request in the await_req list */
+	if (tqpair->recv_state == NVME_TCP_PDU_RECV_STATE_AWAIT_REQ) {
+		TAILQ_INSERT_TAIL(&tgroup->await_req, tqpair, link);
+	} else {
+		TAILQ_INSERT_TAIL(&tgroup->qpairs, tqpair, link);
+	}
+	if (tqpair->recv_data_len > 0) {
+		TAILQ_INSERT_TAIL(&tgroup->recv_pending, tqpair, recv_link);
+	}
+
+	rc = spdk_sock_group_add_sock(tgroup->sock_group, tqpair->sock,
+				      nvmf_tcp_sock_cb, tqpair);
+	if (rc != 0) {
+		SPDK_ERRLOG("Could not add sock to sock_group: %s (%d)\n",
+			    spdk_strerror(errno), errno);
+		return -errno;
+	}
+	tqpair->sock_detached = false;
+	/* Neither the data the socket has already buffered nor the stashed data trigger an interrupt */
+	nvmf_tcp_poll_group_kick(tgroup);
+
+	return 0;
+}
+
+static void
+nvmf_tcp_poll_group_cancel_detach(struct spdk_nvmf_transport_poll_group *group,
+				  struct spdk_nvmf_qpair *qpair)
+{
+	struct spdk_nvmf_tcp_poll_group	*tgroup;
+	struct spdk_nvmf_tcp_qpair		*tqpair;
+
+	tgroup = SPDK_CONTAINEROF(group, struct spdk_nvmf_tcp_poll_group, group);
+	tqpair = SPDK_CONTAINEROF(qpair, struct spdk_nvmf_tcp_qpair, qpair);
+
+	assert(tqpair->group == tgroup);
+
+	SPDK_DEBUGLOG(nvmf_tcp, "cancel detach of tqpair=%p from the tgroup=%p\n", tqpair, tgroup);
+	tqpair->detaching = false;
+	/* A command parked while detaching is picked up again from the await_req list */
+	nvmf_tcp_poll_group_kick(tgroup);
+}
+
 static int
 nvmf_tcp_req_complete(struct spdk_nvmf_request *req)
 {
@@ -3367,6 +3902,14 @@ nvmf_tcp_poll_group_poll(struct spdk_nvmf_transport_poll_group *group)
 		}
 	}
 
+	TAILQ_FOREACH_SAFE(tqpair, &tgroup->recv_pending, recv_link, tqpair_tmp) {
+		rc = nvmf_tcp_sock_process(tqpair);
+
+		if (rc < 0) {
+			nvmf_tcp_qpair_disconnect(tqpair);
+		}
+	}
+
 	return rc;
 }
 
@@ -3800,6 +4343,11 @@ const struct spdk_nvmf_transport_ops spdk_nvmf_transport_tcp = {
 	.poll_group_destroy = nvmf_tcp_poll_group_destroy,
 	.poll_group_add = nvmf_tcp_poll_group_add,
 	.poll_group_remove = nvmf_tcp_poll_group_remove,
+	.poll_group_detach = nvmf_tcp_poll_group_detach,
+	.poll_group_attach = nvmf_tcp_poll_group_attach,
+	.poll_group_cancel_detach = nvmf_tcp_poll_group_cancel_detach,
+	.poll_group_pause = nvmf_tcp_poll_group_pause,
+	.poll_group_resume = nvmf_tcp_poll_group_resume,
 	.poll_group_poll = nvmf_tcp_poll_group_poll,
 
 	.req_free = nvmf_tcp_req_free,
@@ -718,6 +718,58 @@ nvmf_transport_poll_group_remove(struct spdk_nvmf_transport_poll_group *group,
 	return rc;
 }
 
+int
+nvmf_transport_poll_group_detach(struct spdk_nvmf_transport_poll_group *group,
+				 struct spdk_nvmf_qpair *qpair)
+{
+	assert(qpair->transport == group->transport);
+	if (group->transport->ops->poll_group_detach == NULL) {
+		return -ENOTSUP;
+	}
+
+	return group->transport->ops->poll_group_detach(group, qpair);
+}
+
+int
+nvmf_transport_poll_group_attach(struct spdk_nvmf_transport_poll_group *group,
+				 struct spdk_nvmf_qpair *qpair)
+{
+	assert(qpair->transport == group->transport);
+	if (group->transport->ops->poll_group_attach == NULL) {
+		return -ENOTSUP;
+	}
+
+	return group->transport->ops->poll_group_attach(group, qpair);
+}
+
+void
+nvmf_transport_poll_group_cancel_detach(struct spdk_nvmf_transport_poll_group *group,
+					struct spdk_nvmf_qpair *qpair)
+{
+	assert(qpair->transport == group->transport);
+	if (group->transport->ops->poll_group_cancel_detach != NULL) {
+		group->transport->ops->poll_group_cancel_detach(group, qpair);
+	}
+}
+
+void
+nvmf_transport_poll_group_pause(struct spdk_nvmf_transport_poll_group *group)
+{
+	if (group->transport->ops->poll_group_pause != NULL) {
+		group->transport->ops->poll_group_pause(group);
+	}
+}
+
+int
+nvmf_transport_poll_group_resume(struct spdk_nvmf_transport_poll_group *group)
+{
+	if (group->transport->ops->poll_group_resume == NULL) {
+		return 0;
+	}
+
+	return group->transport->ops->poll_group_resume(group);
+}
+
 int
 nvmf_transport_poll_group_poll(struct spdk_nvmf_transport_poll_group *group)
 {
@@ -11,6 +11,8 @@
 #include "spdk/log.h"
 #include "spdk/env.h"
 #include "spdk/util.h"
+#include "spdk/fd_group.h"
+#include "spdk/string.h"
 
 #define SPDK_SOCK_DEFAULT_PRIORITY 0
 #define SPDK_SOCK_DEFAULT_ZCOPY true
@@ -562,6 +564,16 @@ spdk_sock_is_connected(struct spdk_sock *sock)
 	return sock->net_impl->is_connected(sock);
 }
 
+int
+spdk_sock_get_interrupt_fd(struct spdk_sock *sock)
+{
+	if (sock->net_impl->get_interrupt_fd == NULL) {
+		return -ENOTSUP;
+	}
+
+	return sock->net_impl->get_interrupt_fd(sock);
+}
+
 struct spdk_sock_group *
 spdk_sock_group_create(void *ctx)
 {
@@ -762,6 +774,74 @@ spdk_sock_group_poll_count(struct spdk_sock_group *group, int max_events)
 	return num_events;
 }
 
+static int
+sock_group_impl_interrupt(void *ctx)
+{
+	/* Nothing to do, the events are consumed by spdk_sock_group_poll() */
+	return 0;
+}
+
+static void
+sock_group_remove_interrupt_fds(struct spdk_sock_group *group,
+				struct spdk_sock_group_impl *last_impl)
+{
+	struct spdk_sock_group_impl *group_impl;
+	int fd;
+
+	STAILQ_FOREACH(group_impl, &group->group_impls, link) {
+		if (group_impl == last_impl) {
+			break;
+		}
+
+		fd = group_impl->net_impl->group_impl_get_interrupt_fd(group_impl);
+		spdk_fd_group_remove(group->fgrp, fd);
+	}
+
+	spdk_fd_group_destroy(group->fgrp);
+	group->fgrp = NULL;
+}
+
+int
+spdk_sock_group_get_interrupt_fd(struct spdk_sock_group *group)
+{
+	struct spdk_sock_group_impl *group_impl;
+	int fd, rc;
+
+	if (group->fgrp != NULL) {
+		return spdk_fd_group_get_fd(group->fgrp);
+	}
+
+	STAILQ_FOREACH(group_impl, &group->group_impls, link) {
+		if (group_impl->net_impl->group_impl_get_interrupt_fd == NULL) {
+			return -ENOTSUP;
+		}
+	}
+
+	rc = spdk_fd_group_create(&group->fgrp);
+	if (rc != 0) {
+		return rc;
+	}
+
+	/* Each implementation has its own fd, so nest them all in a single one */
+	STAILQ_FOREACH(group_impl, &group->group_impls, link) {
+		fd = group_impl->net_impl->group_impl_get_interrupt_fd(group_impl);
+		if (fd < 0) {
+			rc = fd;
+		} else {
+			rc = spdk_fd_group_add(group->fgrp, fd, sock_group_impl_interrupt,
+					       group_impl, group_impl->net_impl->name);
+		}
+		if (rc != 0) {
+			SPDK_ERRLOG("Failed to get interrupt fd for net(%s): %s\n",
+				    group_impl->net_impl->name, spdk_strerror(-rc));
+			sock_group_remove_interrupt_fds(group, group_impl);
+			return rc;
+		}
+	}
+
+	return spdk_fd_group_get_fd(group->fgrp);
+}
+
 int
 spdk_sock_group_close(struct spdk_sock_group **group)
 {
@@ -780,6 +860,10 @@ spdk_sock_group_close(struct spdk_sock_group **group)
 		}
 	}
 
+	if ((*group)->fgrp != NULL) {
+		sock_group_remove_interrupt_fds(*group, NULL);
+	}
+
 	STAILQ_FOREACH_SAFE(group_impl, &(*group)->group_impls, link, tmp) {
 		rc = group_impl->net_impl->group_impl_close(group_impl);
 		if (rc != 0) {
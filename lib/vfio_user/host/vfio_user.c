@@ -175,7 +175,8 @@ vfio_user_dev_send_request(struct vfio_device *dev, enum vfio_user_command comma
 	req.hdr.msg_size = sizeof(struct vfio_user_header) + arg_len;
 	memcpy(req.payload, arg, arg_len);
 
-	if (command == VFIO_USER_DMA_MAP || command == VFIO_USER_DMA_UNMAP) {
+	if (command == VFIO_USER_DMA_MAP || command == VFIO_USER_DMA_UNMAP ||
+	    command == VFIO_USER_DEVICE_SET_IRQS) {
 		fds_write = true;
 	}
 
@@ -265,6 +266,52 @@ vfio_user_get_dev_info(struct vfio_device *dev, struct vfio_user_device_info *de
 					  dev_info, dev_info->argsz, buf_len, NULL, 0);
 }
 
+int
+vfio_user_get_dev_irq_info(struct vfio_device *dev, struct vfio_irq_info *irq_info)
+{
+	irq_info->argsz = sizeof(struct vfio_irq_info);
+	return vfio_user_dev_send_request(dev, VFIO_USER_DEVICE_GET_IRQ_INFO,
+					  irq_info, irq_info->argsz, sizeof(*irq_info), NULL, 0);
+}
+
+int
+vfio_user_dev_set_irqs(struct vfio_device *dev, uint32_t index, uint32_t start,
+		       int *fds, uint32_t count)
+{
+	struct vfio_irq_set irq_set = {};
+	uint32_t num;
+	int ret;
+
+	irq_set.argsz = sizeof(irq_set);
+	irq_set.index = index;
+
+	if (count == 0) {
+		irq_set.flags = VFIO_IRQ_SET_DATA_NONE | VFIO_IRQ_SET_ACTION_TRIGGER;
+		irq_set.start = start;
+		return vfio_user_dev_send_request(dev, VFIO_USER_DEVICE_SET_IRQS,
+						  &irq_set, sizeof(irq_set), sizeof(irq_set), NULL, 0);
+	}
+
+	/* Only so many fds can be passed in a single message */
+	irq_set.flags = VFIO_IRQ_SET_DATA_EVENTFD | VFIO_IRQ_SET_ACTION_TRIGGER;
+	while (count > 0) {
+		num = spdk_min(count, VFIO_MAXIMUM_SPARSE_MMAP_REGIONS);
+		irq_set.start = start;
+		irq_set.count = num;
+		ret = vfio_user_dev_send_request(dev, VFIO_USER_DEVICE_SET_IRQS,
+						 &irq_set, sizeof(irq_set), sizeof(irq_set), fds, num);
+		if (ret != 0) {
+			return ret;
+		}
+
+		start += num;
+		fds += num;
+		count -= num;
+	}
+
+	return 0;
+}
+
 int
 vfio_user_dev_dma_map_unmap(struct vfio_device *dev, struct vfio_memory_region *mr, bool map)
 {
@@ -62,6 +62,9 @@ int vfio_user_get_dev_info(struct vfio_device *dev, struct vfio_user_device_info
 			   size_t buf_len);
 int vfio_user_get_dev_region_info(struct vfio_device *dev, struct vfio_region_info *region_info,
 				  size_t buf_len, int *fds, int num_fds);
+int vfio_user_get_dev_irq_info(struct vfio_device *dev, struct vfio_irq_info *irq_info);
+int vfio_user_dev_set_irqs(struct vfio_device *dev, uint32_t index, uint32_t start,
+			   int *fds, uint32_t count);
 int vfio_user_dev_dma_map_unmap(struct vfio_device *dev, struct vfio_memory_region *mr, bool map);
 int vfio_user_dev_mmio_access(struct vfio_device *dev, uint32_t index, uint64_t offset, size_t len,
 			      void *buf, bool is_write);
@@ -427,6 +427,29 @@ spdk_vfio_user_get_bar_addr(struct vfio_device *dev, uint32_t index, uint64_t of
 	return NULL;
 }
 
+int
+spdk_vfio_user_get_msix_count(struct vfio_device *dev)
+{
+	struct vfio_irq_info irq_info = {};
+	int ret;
+
+	irq_info.index = VFIO_PCI_MSIX_IRQ_INDEX;
+	ret = vfio_user_get_dev_irq_info(dev, &irq_info);
+	if (ret != 0) {
+		return ret;
+	}
+
+	return irq_info.count;
+}
+
+int
+spdk_vfio_user_set_msix_efds(struct vfio_device *dev, uint32_t start, int *efds, uint32_t count)
+{
+	SPDK_DEBUGLOG(vfio_pci, "Set %u MSI-X vectors from %u of %s\n", count, start, dev->path);
+
+	return vfio_user_dev_set_irqs(dev, VFIO_PCI_MSIX_IRQ_INDEX, start, efds, count);
+}
+
 /* For fuzzing only */
 int
 spdk_vfio_user_dev_send_request(struct vfio_device *dev, enum vfio_user_command command,
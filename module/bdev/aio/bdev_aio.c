@@ -27,12 +27,18 @@
 #include <libaio.h>
 #endif
 
+/* Maximum number of iocbs submitted by a single io_submit() for a batch of I/O */
+#define AIO_BATCH_MAX_IOCBS	32
+
 struct bdev_aio_io_channel {
 	uint64_t				io_inflight;
 #ifdef __FreeBSD__
 	int					kqfd;
 #else
 	io_context_t				io_ctx;
+	/* iocbs collected while a batch of I/O is submitted, NULL otherwise */
+	struct iocb				**batch_iocbs;
+	int					batch_num_iocbs;
 #endif
 	struct bdev_aio_group_channel		*group_ch;
 	TAILQ_ENTRY(bdev_aio_io_channel)	link;
@@ -179,6 +185,35 @@ bdev_aio_submit_io(enum spdk_bdev_io_type type, struct file_disk *fdisk,
 	return aio_writev(aiocb);
 }
 #else
+static void
+bdev_aio_submit_batch_iocbs(struct bdev_aio_io_channel *aio_ch)
+{
+	struct iocb **iocbs = aio_ch->batch_iocbs;
+	struct spdk_bdev_io *bdev_io;
+	int i = 0, rc, num_iocbs = aio_ch->batch_num_iocbs;
+
+	aio_ch->batch_num_iocbs = 0;
+
+	while (i < num_iocbs) {
+		rc = io_submit(aio_ch->io_ctx, num_iocbs - i, &iocbs[i]);
+		if (rc > 0) {
+			i += rc;
+			continue;
+		}
+
+		/* The iocb at index i was rejected, fail it and go on with the rest */
+		bdev_io = spdk_bdev_io_from_ctx(iocbs[i]->data);
+		aio_ch->io_inflight--;
+		if (rc == -EAGAIN || rc == 0) {
+			spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_NOMEM);
+		} else {
+			spdk_bdev_io_complete_aio_status(bdev_io, rc);
+			SPDK_ERRLOG("%s: io_submit returned %d\n", __func__, rc);
+		}
+		i++;
+	}
+}
+
 static int
 bdev_aio_submit_io(enum spdk_bdev_io_type type, struct file_disk *fdisk,
 		   struct spdk_io_channel *ch, struct bdev_aio_task *aio_task,
@@ -200,6 +235,15 @@ bdev_aio_submit_io(enum spdk_bdev_io_type type, struct file_disk *fdisk,
 	aio_task->len = nbytes;
 	aio_task->ch = aio_ch;
 
+	if (aio_ch->batch_iocbs != NULL) {
+		/* Submitted along with the rest of the batch */
+		if (aio_ch->batch_num_iocbs == AIO_BATCH_MAX_IOCBS) {
+			bdev_aio_submit_batch_iocbs(aio_ch);
+		}
+		aio_ch->batch_iocbs[aio_ch->batch_num_iocbs++] = iocb;
+		return 0;
+	}
+
 	return io_submit(aio_ch->io_ctx, 1, &iocb);
 }
 #endif
@@ -590,6 +634,26 @@ bdev_aio_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io
 	}
 }
 
+#ifndef __FreeBSD__
+static void
+bdev_aio_submit_request_batch(struct spdk_io_channel *ch, struct spdk_bdev_io **bdev_ios,
+			      uint32_t num_ios)
+{
+	struct bdev_aio_io_channel *aio_ch = spdk_io_channel_get_ctx(ch);
+	struct iocb *iocbs[AIO_BATCH_MAX_IOCBS];
+	uint32_t i;
+
+	aio_ch->batch_iocbs = iocbs;
+
+	for (i = 0; i < num_ios; i++) {
+		bdev_aio_submit_request(ch, bdev_ios[i]);
+	}
+
+	bdev_aio_submit_batch_iocbs(aio_ch);
+	aio_ch->batch_iocbs = NULL;
+}
+#endif
+
 static bool
 bdev_aio_io_type_supported(void *ctx, enum spdk_bdev_io_type io_type)
 {
@@ -728,6 +792,9 @@ static const struct spdk_bdev_fn_table aio_fn_table = {
 	.get_io_channel		= bdev_aio_get_io_channel,
 	.dump_info_json		= bdev_aio_dump_info_json,
 	.write_config_json	= bdev_aio_write_json_config,
+#ifndef __FreeBSD__
+	.submit_request_batch	= bdev_aio_submit_request_batch,
+#endif
 };
 
 static void
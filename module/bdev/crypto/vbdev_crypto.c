@@ -108,6 +108,7 @@ crypto_write(struct crypto_io_channel *crypto_ch, struct spdk_bdev_io *bdev_io)
 	opts.accel_sequence = crypto_io->seq;
 	opts.memory_domain = crypto_io->aux_domain;
 	opts.memory_domain_ctx = crypto_io->aux_domain_ctx;
+	opts.placement_hint = bdev_io->u.bdev.placement_hint;
 
 	/* Write the encrypted data. */
 	rc = spdk_bdev_writev_blocks_ext(crypto_bdev->base_desc, crypto_ch->base_ch,
@@ -191,6 +192,20 @@ _complete_internal_io(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
 	spdk_bdev_free_io(bdev_io);
 }
 
+static void
+_complete_seek_io(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct spdk_bdev_io *orig_io = cb_arg;
+	int status = success ? SPDK_BDEV_IO_STATUS_SUCCESS : SPDK_BDEV_IO_STATUS_FAILED;
+
+	/* Encryption doesn't change the layout of the blocks, so the allocation state
+	 * reported by the base bdev applies to the crypto bdev as well.
+	 */
+	orig_io->u.bdev.seek.offset = spdk_bdev_io_get_seek_offset(bdev_io);
+	spdk_bdev_io_complete(orig_io, status);
+	spdk_bdev_free_io(bdev_io);
+}
+
 static void crypto_read(struct crypto_io_channel *crypto_ch, struct spdk_bdev_io *bdev_io);
 
 static void
@@ -357,6 +372,16 @@ vbdev_crypto_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bde
 		rc = spdk_bdev_reset(crypto_bdev->base_desc, crypto_ch->base_ch,
 				     _complete_internal_io, bdev_io);
 		break;
+	case SPDK_BDEV_IO_TYPE_SEEK_DATA:
+		rc = spdk_bdev_seek_data(crypto_bdev->base_desc, crypto_ch->base_ch,
+					 bdev_io->u.bdev.offset_blocks,
+					 _complete_seek_io, bdev_io);
+		break;
+	case SPDK_BDEV_IO_TYPE_SEEK_HOLE:
+		rc = spdk_bdev_seek_hole(crypto_bdev->base_desc, crypto_ch->base_ch,
+					 bdev_io->u.bdev.offset_blocks,
+					 _complete_seek_io, bdev_io);
+		break;
 	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
 	default:
 		SPDK_ERRLOG("crypto: unknown I/O type %d\n", bdev_io->type);
@@ -390,6 +415,8 @@ vbdev_crypto_io_type_supported(void *ctx, enum spdk_bdev_io_type io_type)
 	case SPDK_BDEV_IO_TYPE_RESET:
 	case SPDK_BDEV_IO_TYPE_READ:
 	case SPDK_BDEV_IO_TYPE_FLUSH:
+	case SPDK_BDEV_IO_TYPE_SEEK_DATA:
+	case SPDK_BDEV_IO_TYPE_SEEK_HOLE:
 		return spdk_bdev_io_type_supported(crypto_bdev->base_bdev, io_type);
 	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
 	/* Force the bdev layer to issue actual writes of zeroes so we can
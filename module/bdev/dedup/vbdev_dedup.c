@@ -0,0 +1,1738 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 the SPDK authors.
+ *   All rights reserved.
+ */
+
+/*
+ * A virtual block device deduplicating the data written to its base bdev.
+ *
+ * The bdev is made of fixed-size chunks, which are also its blocks. Each logical chunk is
+ * mapped to a physical chunk of the base bdev and the physical chunks are shared by all
+ * logical chunks holding the same data, counting their references. Chunks of zeroes aren't
+ * mapped at all.
+ *
+ * Each write is fingerprinted through the accel framework, so that it can be offloaded. The
+ * fingerprint is looked up in an in-memory index and the candidate chunks are read back and
+ * compared with the written data before they're shared, so that a fingerprint collision
+ * never corrupts the data. Data that isn't found is written to a free physical chunk.
+ *
+ * The base bdev holds a superblock followed by the map of the logical chunks, the
+ * fingerprints of the physical chunks and the physical chunks themselves. The map is
+ * persisted before a write is completed, and the physical chunk that was replaced is only
+ * reused after that, so the map on disk never points to a chunk that was overwritten. The
+ * fingerprints are only hints and are persisted in the background. The reference counts and
+ * the index are rebuilt from the map when the bdev is created.
+ *
+ * All of the dedup state is owned by the thread that created the bdev. I/O submitted on
+ * other threads is forwarded to it and completed back on the submitting thread.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "vbdev_dedup.h"
+#include "spdk/accel.h"
+#include "spdk/crc32.h"
+#include "spdk/env.h"
+#include "spdk/string.h"
+#include "spdk/thread.h"
+#include "spdk/tree.h"
+#include "spdk/util.h"
+
+#include "spdk/bdev_module.h"
+#include "spdk/log.h"
+
+/* This namespace UUID was generated using uuid_generate() method. */
+#define BDEV_DEDUP_NAMESPACE_UUID	"8e3f4b62-1d9a-4c57-a0e6-7b2d5c9f3a18"
+
+#define DEDUP_SB_MAGIC			"SPDKDDP"
+#define DEDUP_SB_VERSION		1
+#define DEDUP_DEFAULT_CHUNK_SIZE	4096
+/* Physical chunk index that doesn't point to any chunk */
+#define DEDUP_CHUNK_NONE		UINT32_MAX
+/* Number of buffers to read the candidate chunks into */
+#define DEDUP_NUM_CMP_BUFS		32
+/* Maximum number of chunks unmapped at once */
+#define DEDUP_MAX_UNMAP_CHUNKS		64
+/* Size of the I/Os loading and formatting the metadata */
+#define DEDUP_REGION_IO_KB		1024
+
+struct dedup_sb {
+	char			magic[8];
+	uint32_t		version;
+	uint32_t		crc;
+	uint32_t		chunk_size;
+	uint32_t		reserved;
+	/* Geometry, in chunks of the base bdev */
+	uint64_t		num_logical;
+	uint64_t		num_physical;
+	uint64_t		map_offset;
+	uint64_t		fp_offset;
+	uint64_t		data_offset;
+};
+SPDK_STATIC_ASSERT(sizeof(struct dedup_sb) <= 512, "Incorrect size");
+
+struct vbdev_dedup;
+struct dedup_req;
+
+typedef void (*dedup_req_cb)(struct dedup_req *req, bool success);
+
+/* A single I/O to the base bdev */
+struct dedup_req {
+	struct spdk_bdev_desc		*desc;
+	struct spdk_io_channel		*ch;
+	enum spdk_bdev_io_type		type;
+	struct iovec			*iovs;
+	int				iovcnt;
+	uint64_t			offset_blocks;
+	uint64_t			num_blocks;
+	dedup_req_cb			cb_fn;
+	void				*cb_arg;
+	struct spdk_bdev_io_wait_entry	bdev_io_wait;
+};
+
+struct dedup_bdev_io {
+	enum spdk_bdev_io_status	status;
+	/* Logical chunk being written or unmapped, and the end of the unmapped range */
+	uint64_t			lchunk;
+	uint64_t			end;
+	uint32_t			crc;
+	/* Physical chunk being read, written or compared with */
+	uint32_t			pchunk;
+	/* Physical chunks to release once the map is persisted */
+	uint32_t			num_old;
+	uint32_t			old[DEDUP_MAX_UNMAP_CHUNKS];
+	struct iovec			cmp_iov;
+	/* Waiting for a compare buffer or for the map to be persisted */
+	TAILQ_ENTRY(dedup_bdev_io)	link;
+	struct dedup_req		req;
+};
+
+/* A chunk of the map or of the fingerprints being written */
+struct dedup_md_write {
+	struct vbdev_dedup		*dedup;
+	uint64_t			chunk;
+	/* Updated since the write in progress was submitted */
+	bool				dirty;
+	/* I/O waiting for the write in progress and for the next one */
+	TAILQ_HEAD(, dedup_bdev_io)	waiters;
+	TAILQ_HEAD(, dedup_bdev_io)	next_waiters;
+	struct iovec			iov;
+	struct dedup_req		req;
+	RB_ENTRY(dedup_md_write)	node;
+};
+
+/* A metadata region loaded or formatted on creation */
+struct dedup_region_io {
+	enum spdk_bdev_io_type		type;
+	uint64_t			offset;
+	uint64_t			end;
+	uint8_t				*buf;
+	void				(*cb_fn)(struct vbdev_dedup *node, bool success);
+	struct iovec			iov;
+	struct dedup_req		req;
+};
+
+/* Associative list to be used in examine */
+struct bdev_association {
+	char				*vbdev_name;
+	char				*base_bdev_name;
+	uint32_t			chunk_size;
+	uint64_t			size_mb;
+	struct spdk_uuid		uuid;
+	/* The bdev is being created or exists */
+	bool				active;
+	TAILQ_ENTRY(bdev_association)	link;
+};
+static TAILQ_HEAD(, bdev_association) g_bdev_associations = TAILQ_HEAD_INITIALIZER(
+			g_bdev_associations);
+
+RB_HEAD(dedup_md_tree, dedup_md_write);
+
+struct vbdev_dedup {
+	struct spdk_bdev		dedup_bdev;
+	struct spdk_bdev		*base_bdev;
+	struct spdk_bdev_desc		*base_desc;
+	struct spdk_io_channel		*base_ch;
+	struct spdk_io_channel		*accel_ch;
+	struct bdev_association		*assoc;
+	/* Thread owning the dedup state */
+	struct spdk_thread		*thread;
+
+	/* Geometry, in chunks of the base bdev */
+	uint32_t			chunk_size;
+	uint32_t			blocks_per_chunk;
+	uint64_t			num_logical;
+	uint64_t			num_physical;
+	uint64_t			map_offset;
+	uint64_t			fp_offset;
+	uint64_t			data_offset;
+
+	/* Physical chunk plus one of each logical chunk, 0 if it's unmapped */
+	uint32_t			*map;
+	/* Fingerprint of each physical chunk */
+	uint32_t			*fps;
+	/* References to each physical chunk, from the map and from the I/O in progress */
+	uint32_t			*refcnt;
+	/* Chunks in use are chained in the buckets of the fingerprint index, free ones in the
+	 * free list, both through next.
+	 */
+	uint32_t			*buckets;
+	uint32_t			*next;
+	uint32_t			bucket_mask;
+	uint32_t			free_head;
+	uint64_t			num_free;
+	uint64_t			num_mapped;
+	uint32_t			zero_crc;
+
+	struct dedup_md_tree		md_writes;
+
+	void				*cmp_bufs;
+	void				**free_cmp_bufs;
+	uint32_t			num_free_cmp_bufs;
+	TAILQ_HEAD(, dedup_bdev_io)	cmp_waiters;
+
+	struct dedup_sb			*sb;
+	struct dedup_req		sb_req;
+	struct iovec			sb_iov;
+	struct dedup_region_io		region;
+
+	bool				destructing;
+	bdev_dedup_create_cb		create_cb;
+	void				*create_cb_arg;
+	TAILQ_ENTRY(vbdev_dedup)	link;
+};
+static TAILQ_HEAD(, vbdev_dedup) g_dedup_nodes = TAILQ_HEAD_INITIALIZER(g_dedup_nodes);
+
+static int vbdev_dedup_init(void);
+static int vbdev_dedup_get_ctx_size(void);
+static void vbdev_dedup_examine(struct spdk_bdev *bdev);
+static void vbdev_dedup_finish(void);
+static int vbdev_dedup_config_json(struct spdk_json_write_ctx *w);
+
+static struct spdk_bdev_module dedup_if = {
+	.name = "dedup",
+	.module_init = vbdev_dedup_init,
+	.get_ctx_size = vbdev_dedup_get_ctx_size,
+	.examine_config = vbdev_dedup_examine,
+	.module_fini = vbdev_dedup_finish,
+	.config_json = vbdev_dedup_config_json
+};
+
+SPDK_BDEV_MODULE_REGISTER(dedup, &dedup_if)
+
+static void dedup_write_lookup(struct vbdev_dedup *node, struct spdk_bdev_io *bdev_io);
+static void dedup_write_cmp_read(struct vbdev_dedup *node, struct spdk_bdev_io *bdev_io);
+static void dedup_unmap(struct vbdev_dedup *node, struct spdk_bdev_io *bdev_io);
+static void dedup_destruct_done(struct vbdev_dedup *node);
+static void vbdev_dedup_free_association(struct bdev_association *assoc);
+
+static int
+dedup_md_write_cmp(struct dedup_md_write *mw1, struct dedup_md_write *mw2)
+{
+	return mw1->chunk < mw2->chunk ? -1 : mw1->chunk > mw2->chunk;
+}
+
+RB_GENERATE_STATIC(dedup_md_tree, dedup_md_write, node, dedup_md_write_cmp);
+
+static void
+_dedup_req_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct dedup_req *req = cb_arg;
+
+	spdk_bdev_free_io(bdev_io);
+	req->cb_fn(req, success);
+}
+
+static void
+dedup_req_submit(void *arg)
+{
+	struct dedup_req *req = arg;
+	int rc;
+
+	switch (req->type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+		rc = spdk_bdev_readv_blocks(req->desc, req->ch, req->iovs, req->iovcnt,
+					    req->offset_blocks, req->num_blocks,
+					    _dedup_req_done, req);
+		break;
+	case SPDK_BDEV_IO_TYPE_WRITE:
+		rc = spdk_bdev_writev_blocks(req->desc, req->ch, req->iovs, req->iovcnt,
+					     req->offset_blocks, req->num_blocks,
+					     _dedup_req_done, req);
+		break;
+	case SPDK_BDEV_IO_TYPE_FLUSH:
+		rc = spdk_bdev_flush_blocks(req->desc, req->ch, req->offset_blocks,
+					    req->num_blocks, _dedup_req_done, req);
+		break;
+	case SPDK_BDEV_IO_TYPE_RESET:
+		rc = spdk_bdev_reset(req->desc, req->ch, _dedup_req_done, req);
+		break;
+	default:
+		assert(false);
+		rc = -EINVAL;
+		break;
+	}
+
+	if (rc == -ENOMEM) {
+		req->bdev_io_wait.bdev = spdk_bdev_desc_get_bdev(req->desc);
+		req->bdev_io_wait.cb_fn = dedup_req_submit;
+		req->bdev_io_wait.cb_arg = req;
+		rc = spdk_bdev_queue_io_wait(req->bdev_io_wait.bdev, req->ch, &req->bdev_io_wait);
+	}
+
+	if (rc != 0) {
+		SPDK_ERRLOG("Failed to submit I/O to %s: %s\n",
+			    spdk_bdev_get_name(spdk_bdev_desc_get_bdev(req->desc)), spdk_strerror(-rc));
+		req->cb_fn(req, false);
+	}
+}
+
+static void
+dedup_req_init(struct dedup_req *req, struct vbdev_dedup *node, enum spdk_bdev_io_type type,
+	       uint64_t offset_blocks, uint64_t num_blocks, dedup_req_cb cb_fn, void *cb_arg)
+{
+	req->desc = node->base_desc;
+	req->ch = node->base_ch;
+	req->type = type;
+	req->offset_blocks = offset_blocks;
+	req->num_blocks = num_blocks;
+	req->cb_fn = cb_fn;
+	req->cb_arg = cb_arg;
+}
+
+/* Submit an I/O of a whole chunk of the base bdev. */
+static void
+dedup_chunk_io(struct vbdev_dedup *node, struct dedup_req *req, enum spdk_bdev_io_type type,
+	       uint64_t chunk, struct iovec *iovs, int iovcnt, dedup_req_cb cb_fn, void *cb_arg)
+{
+	req->iovs = iovs;
+	req->iovcnt = iovcnt;
+	dedup_req_init(req, node, type, chunk * node->blocks_per_chunk, node->blocks_per_chunk,
+		       cb_fn, cb_arg);
+	dedup_req_submit(req);
+}
+
+static bool
+dedup_iovs_all_zero(const struct iovec *iovs, int iovcnt)
+{
+	const uint8_t *buf;
+	int i;
+
+	for (i = 0; i < iovcnt; i++) {
+		buf = iovs[i].iov_base;
+		if (iovs[i].iov_len > 0 &&
+		    (buf[0] != 0 || memcmp(buf, buf + 1, iovs[i].iov_len - 1) != 0)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static int
+dedup_iovs_cmp(const struct iovec *iovs, int iovcnt, const uint8_t *buf)
+{
+	int i, rc;
+
+	for (i = 0; i < iovcnt; i++) {
+		rc = memcmp(iovs[i].iov_base, buf, iovs[i].iov_len);
+		if (rc != 0) {
+			return rc;
+		}
+		buf += iovs[i].iov_len;
+	}
+
+	return 0;
+}
+
+static void
+_dedup_io_complete(void *ctx)
+{
+	struct spdk_bdev_io *bdev_io = ctx;
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)bdev_io->driver_ctx;
+
+	spdk_bdev_io_complete(bdev_io, io_ctx->status);
+}
+
+/* Complete the I/O on the thread it was submitted on. */
+static void
+dedup_io_complete(struct spdk_bdev_io *bdev_io, enum spdk_bdev_io_status status)
+{
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)bdev_io->driver_ctx;
+	struct spdk_thread *thread = spdk_bdev_io_get_thread(bdev_io);
+
+	io_ctx->status = status;
+	if (thread == spdk_get_thread()) {
+		_dedup_io_complete(bdev_io);
+	} else {
+		spdk_thread_send_msg(thread, _dedup_io_complete, bdev_io);
+	}
+}
+
+static void
+dedup_index_insert(struct vbdev_dedup *node, uint32_t pchunk)
+{
+	uint32_t *bucket = &node->buckets[node->fps[pchunk] & node->bucket_mask];
+
+	node->next[pchunk] = *bucket;
+	*bucket = pchunk;
+}
+
+static void
+dedup_index_remove(struct vbdev_dedup *node, uint32_t pchunk)
+{
+	uint32_t *link = &node->buckets[node->fps[pchunk] & node->bucket_mask];
+
+	/* Chunks whose data failed to be written were never inserted */
+	while (*link != DEDUP_CHUNK_NONE) {
+		if (*link == pchunk) {
+			*link = node->next[pchunk];
+			return;
+		}
+		link = &node->next[*link];
+	}
+}
+
+static uint32_t
+dedup_chunk_alloc(struct vbdev_dedup *node)
+{
+	uint32_t pchunk = node->free_head;
+
+	if (pchunk != DEDUP_CHUNK_NONE) {
+		node->free_head = node->next[pchunk];
+		node->num_free--;
+		node->refcnt[pchunk] = 1;
+	}
+
+	return pchunk;
+}
+
+static void
+dedup_chunk_get(struct vbdev_dedup *node, uint32_t pchunk)
+{
+	node->refcnt[pchunk]++;
+}
+
+static void
+dedup_chunk_put(struct vbdev_dedup *node, uint32_t pchunk)
+{
+	assert(node->refcnt[pchunk] > 0);
+	if (--node->refcnt[pchunk] > 0) {
+		return;
+	}
+
+	dedup_index_remove(node, pchunk);
+	node->next[pchunk] = node->free_head;
+	node->free_head = pchunk;
+	node->num_free++;
+}
+
+static uint64_t
+dedup_map_md_chunk(struct vbdev_dedup *node, uint64_t lchunk)
+{
+	return node->map_offset + lchunk * sizeof(uint32_t) / node->chunk_size;
+}
+
+static uint64_t
+dedup_fp_md_chunk(struct vbdev_dedup *node, uint32_t pchunk)
+{
+	return node->fp_offset + (uint64_t)pchunk * sizeof(uint32_t) / node->chunk_size;
+}
+
+static void *
+dedup_md_buf(struct vbdev_dedup *node, uint64_t chunk)
+{
+	if (chunk < node->fp_offset) {
+		return (uint8_t *)node->map + (chunk - node->map_offset) * node->chunk_size;
+	}
+
+	return (uint8_t *)node->fps + (chunk - node->fp_offset) * node->chunk_size;
+}
+
+static void
+dedup_map_set(struct vbdev_dedup *node, uint64_t lchunk, uint32_t mapped)
+{
+	node->num_mapped += (mapped != 0) - (node->map[lchunk] != 0);
+	node->map[lchunk] = mapped;
+}
+
+static struct dedup_md_write *
+dedup_md_write_find(struct vbdev_dedup *node, uint64_t chunk)
+{
+	struct dedup_md_write find = { .chunk = chunk };
+
+	return RB_FIND(dedup_md_tree, &node->md_writes, &find);
+}
+
+/* Called once the map update of an I/O is persisted. */
+static void
+dedup_map_persisted(struct dedup_bdev_io *io_ctx, bool success)
+{
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(io_ctx);
+	struct vbdev_dedup *node = SPDK_CONTAINEROF(bdev_io->bdev, struct vbdev_dedup, dedup_bdev);
+	uint32_t i;
+
+	if (!success) {
+		/* The map on disk may still point to the replaced chunks, so they're leaked
+		 * until the bdev is created again.
+		 */
+		dedup_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		return;
+	}
+
+	for (i = 0; i < io_ctx->num_old; i++) {
+		dedup_chunk_put(node, io_ctx->old[i]);
+	}
+	io_ctx->num_old = 0;
+
+	if (bdev_io->type != SPDK_BDEV_IO_TYPE_WRITE && io_ctx->lchunk < io_ctx->end) {
+		dedup_unmap(node, bdev_io);
+		return;
+	}
+
+	dedup_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_SUCCESS);
+}
+
+static void dedup_md_write_submit(struct vbdev_dedup *node, struct dedup_md_write *mw);
+
+static void
+dedup_md_write_done(struct dedup_req *req, bool success)
+{
+	struct dedup_md_write *mw = req->cb_arg;
+	struct vbdev_dedup *node = mw->dedup;
+	struct dedup_bdev_io *io_ctx;
+	TAILQ_HEAD(, dedup_bdev_io) waiters = TAILQ_HEAD_INITIALIZER(waiters);
+
+	if (!success) {
+		SPDK_ERRLOG("Failed to write metadata chunk %" PRIu64 " of %s\n", mw->chunk,
+			    node->dedup_bdev.name);
+	}
+
+	TAILQ_SWAP(&waiters, &mw->waiters, dedup_bdev_io, link);
+	if (mw->dirty) {
+		mw->dirty = false;
+		TAILQ_SWAP(&mw->waiters, &mw->next_waiters, dedup_bdev_io, link);
+		dedup_md_write_submit(node, mw);
+	} else {
+		RB_REMOVE(dedup_md_tree, &node->md_writes, mw);
+		free(mw);
+	}
+
+	while ((io_ctx = TAILQ_FIRST(&waiters))) {
+		TAILQ_REMOVE(&waiters, io_ctx, link);
+		dedup_map_persisted(io_ctx, success);
+	}
+
+	if (node->destructing && RB_EMPTY(&node->md_writes)) {
+		dedup_destruct_done(node);
+	}
+}
+
+static void
+dedup_md_write_submit(struct vbdev_dedup *node, struct dedup_md_write *mw)
+{
+	mw->iov.iov_base = dedup_md_buf(node, mw->chunk);
+	mw->iov.iov_len = node->chunk_size;
+	dedup_chunk_io(node, &mw->req, SPDK_BDEV_IO_TYPE_WRITE, mw->chunk, &mw->iov, 1,
+		       dedup_md_write_done, mw);
+}
+
+/*
+ * Persist a chunk of the metadata. Updates of the same chunk are coalesced, if the chunk is
+ * being written already it's written again once that write is done. io_ctx, if any, is
+ * notified once the chunk is persisted.
+ */
+static void
+dedup_md_write(struct vbdev_dedup *node, uint64_t chunk, struct dedup_bdev_io *io_ctx)
+{
+	struct dedup_md_write *mw;
+
+	mw = dedup_md_write_find(node, chunk);
+	if (mw != NULL) {
+		mw->dirty = true;
+		if (io_ctx != NULL) {
+			TAILQ_INSERT_TAIL(&mw->next_waiters, io_ctx, link);
+		}
+		return;
+	}
+
+	mw = calloc(1, sizeof(*mw));
+	if (mw == NULL) {
+		SPDK_ERRLOG("could not allocate metadata write\n");
+		if (io_ctx != NULL) {
+			dedup_map_persisted(io_ctx, false);
+		}
+		return;
+	}
+
+	mw->dedup = node;
+	mw->chunk = chunk;
+	TAILQ_INIT(&mw->waiters);
+	TAILQ_INIT(&mw->next_waiters);
+	if (io_ctx != NULL) {
+		TAILQ_INSERT_TAIL(&mw->waiters, io_ctx, link);
+	}
+	RB_INSERT(dedup_md_tree, &node->md_writes, mw);
+	dedup_md_write_submit(node, mw);
+}
+
+/* Map the logical chunk of a write to a physical chunk, or unmap it if mapped is 0. */
+static void
+dedup_map_update(struct vbdev_dedup *node, struct spdk_bdev_io *bdev_io, uint32_t mapped)
+{
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)bdev_io->driver_ctx;
+	uint64_t md_chunk = dedup_map_md_chunk(node, io_ctx->lchunk);
+	uint32_t old = node->map[io_ctx->lchunk];
+
+	if (old == mapped && dedup_md_write_find(node, md_chunk) == NULL) {
+		/* The chunk was rewritten with the data it already holds */
+		if (mapped != 0) {
+			dedup_chunk_put(node, mapped - 1);
+		}
+		dedup_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_SUCCESS);
+		return;
+	}
+
+	io_ctx->num_old = 0;
+	if (old != 0) {
+		io_ctx->old[io_ctx->num_old++] = old - 1;
+	}
+	dedup_map_set(node, io_ctx->lchunk, mapped);
+	dedup_md_write(node, md_chunk, io_ctx);
+}
+
+static void
+dedup_write_new_done(struct dedup_req *req, bool success)
+{
+	struct spdk_bdev_io *bdev_io = req->cb_arg;
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)bdev_io->driver_ctx;
+	struct vbdev_dedup *node = SPDK_CONTAINEROF(bdev_io->bdev, struct vbdev_dedup, dedup_bdev);
+	uint32_t pchunk = io_ctx->pchunk;
+
+	if (!success) {
+		dedup_chunk_put(node, pchunk);
+		dedup_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		return;
+	}
+
+	node->fps[pchunk] = io_ctx->crc;
+	dedup_index_insert(node, pchunk);
+	dedup_md_write(node, dedup_fp_md_chunk(node, pchunk), NULL);
+	dedup_map_update(node, bdev_io, pchunk + 1);
+}
+
+/* The data wasn't found, write it to a free chunk. */
+static void
+dedup_write_new(struct vbdev_dedup *node, struct spdk_bdev_io *bdev_io)
+{
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)bdev_io->driver_ctx;
+
+	io_ctx->pchunk = dedup_chunk_alloc(node);
+	if (io_ctx->pchunk == DEDUP_CHUNK_NONE) {
+		SPDK_ERRLOG("dedup bdev %s is out of space\n", node->dedup_bdev.name);
+		dedup_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		return;
+	}
+
+	dedup_chunk_io(node, &io_ctx->req, SPDK_BDEV_IO_TYPE_WRITE,
+		       node->data_offset + io_ctx->pchunk, bdev_io->u.bdev.iovs,
+		       bdev_io->u.bdev.iovcnt, dedup_write_new_done, bdev_io);
+}
+
+static void
+dedup_cmp_buf_put(struct vbdev_dedup *node, void *buf)
+{
+	struct dedup_bdev_io *io_ctx;
+
+	node->free_cmp_bufs[node->num_free_cmp_bufs++] = buf;
+
+	io_ctx = TAILQ_FIRST(&node->cmp_waiters);
+	if (io_ctx != NULL) {
+		TAILQ_REMOVE(&node->cmp_waiters, io_ctx, link);
+		dedup_write_cmp_read(node, spdk_bdev_io_from_ctx(io_ctx));
+	}
+}
+
+static void
+dedup_write_cmp_done(void *cb_arg, int status)
+{
+	struct spdk_bdev_io *bdev_io = cb_arg;
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)bdev_io->driver_ctx;
+	struct vbdev_dedup *node = SPDK_CONTAINEROF(bdev_io->bdev, struct vbdev_dedup, dedup_bdev);
+	uint32_t pchunk = io_ctx->pchunk;
+
+	dedup_cmp_buf_put(node, io_ctx->cmp_iov.iov_base);
+
+	if (status == 0) {
+		/* Share the chunk, the reference taken for the compare is the map's now */
+		dedup_map_update(node, bdev_io, pchunk + 1);
+		return;
+	}
+
+	/* Just a fingerprint collision, go on with the rest of the bucket. The chunk is still
+	 * in the index while it's referenced, so its successor is valid.
+	 */
+	io_ctx->pchunk = node->next[pchunk];
+	dedup_chunk_put(node, pchunk);
+	dedup_write_lookup(node, bdev_io);
+}
+
+static void
+dedup_write_cmp_read_done(struct dedup_req *req, bool success)
+{
+	struct spdk_bdev_io *bdev_io = req->cb_arg;
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)bdev_io->driver_ctx;
+	struct vbdev_dedup *node = SPDK_CONTAINEROF(bdev_io->bdev, struct vbdev_dedup, dedup_bdev);
+	int rc;
+
+	if (!success) {
+		/* Don't share a chunk that can't be read */
+		dedup_write_cmp_done(bdev_io, -EIO);
+		return;
+	}
+
+	if (bdev_io->u.bdev.iovcnt == 1) {
+		rc = spdk_accel_submit_compare(node->accel_ch, bdev_io->u.bdev.iovs[0].iov_base,
+					       io_ctx->cmp_iov.iov_base, node->chunk_size,
+					       dedup_write_cmp_done, bdev_io);
+		if (rc == 0) {
+			return;
+		}
+	}
+
+	dedup_write_cmp_done(bdev_io, dedup_iovs_cmp(bdev_io->u.bdev.iovs, bdev_io->u.bdev.iovcnt,
+			     io_ctx->cmp_iov.iov_base) ? -EILSEQ : 0);
+}
+
+/* Read the candidate chunk to compare it with the written data. */
+static void
+dedup_write_cmp_read(struct vbdev_dedup *node, struct spdk_bdev_io *bdev_io)
+{
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)bdev_io->driver_ctx;
+
+	if (node->num_free_cmp_bufs == 0) {
+		TAILQ_INSERT_TAIL(&node->cmp_waiters, io_ctx, link);
+		return;
+	}
+
+	io_ctx->cmp_iov.iov_base = node->free_cmp_bufs[--node->num_free_cmp_bufs];
+	io_ctx->cmp_iov.iov_len = node->chunk_size;
+	dedup_chunk_io(node, &io_ctx->req, SPDK_BDEV_IO_TYPE_READ,
+		       node->data_offset + io_ctx->pchunk, &io_ctx->cmp_iov, 1,
+		       dedup_write_cmp_read_done, bdev_io);
+}
+
+/* Find the next chunk in the bucket starting at io_ctx->pchunk with the written data's
+ * fingerprint.
+ */
+static void
+dedup_write_lookup(struct vbdev_dedup *node, struct spdk_bdev_io *bdev_io)
+{
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)bdev_io->driver_ctx;
+	uint32_t pchunk = io_ctx->pchunk;
+
+	while (pchunk != DEDUP_CHUNK_NONE && node->fps[pchunk] != io_ctx->crc) {
+		pchunk = node->next[pchunk];
+	}
+
+	if (pchunk == DEDUP_CHUNK_NONE) {
+		dedup_write_new(node, bdev_io);
+		return;
+	}
+
+	/* Keep the chunk from being reused while it's compared */
+	dedup_chunk_get(node, pchunk);
+	io_ctx->pchunk = pchunk;
+	dedup_write_cmp_read(node, bdev_io);
+}
+
+static void
+dedup_write_crc_done(void *cb_arg, int status)
+{
+	struct spdk_bdev_io *bdev_io = cb_arg;
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)bdev_io->driver_ctx;
+	struct vbdev_dedup *node = SPDK_CONTAINEROF(bdev_io->bdev, struct vbdev_dedup, dedup_bdev);
+
+	if (status != 0) {
+		SPDK_ERRLOG("Failed to fingerprint write to %s: %s\n", node->dedup_bdev.name,
+			    spdk_strerror(-status));
+		dedup_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		return;
+	}
+
+	if (io_ctx->crc == node->zero_crc &&
+	    dedup_iovs_all_zero(bdev_io->u.bdev.iovs, bdev_io->u.bdev.iovcnt)) {
+		dedup_map_update(node, bdev_io, 0);
+		return;
+	}
+
+	io_ctx->pchunk = node->buckets[io_ctx->crc & node->bucket_mask];
+	dedup_write_lookup(node, bdev_io);
+}
+
+static void
+dedup_write(struct vbdev_dedup *node, struct spdk_bdev_io *bdev_io)
+{
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)bdev_io->driver_ctx;
+	int rc;
+
+	/* Writes are split on chunk boundaries */
+	assert(bdev_io->u.bdev.num_blocks == 1);
+	io_ctx->lchunk = bdev_io->u.bdev.offset_blocks;
+	rc = spdk_accel_submit_crc32cv(node->accel_ch, &io_ctx->crc, bdev_io->u.bdev.iovs,
+				       bdev_io->u.bdev.iovcnt, 0, dedup_write_crc_done, bdev_io);
+	if (rc != 0) {
+		dedup_io_complete(bdev_io, rc == -ENOMEM ? SPDK_BDEV_IO_STATUS_NOMEM :
+				  SPDK_BDEV_IO_STATUS_FAILED);
+	}
+}
+
+/* Unmap the chunks from io_ctx->lchunk on, one chunk of the map at a time. */
+static void
+dedup_unmap(struct vbdev_dedup *node, struct spdk_bdev_io *bdev_io)
+{
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)bdev_io->driver_ctx;
+	uint64_t entries_per_chunk = node->chunk_size / sizeof(uint32_t);
+	uint64_t md_chunk, num_chunks, i;
+
+	while (io_ctx->lchunk < io_ctx->end) {
+		num_chunks = spdk_min(io_ctx->end - io_ctx->lchunk,
+				      entries_per_chunk - io_ctx->lchunk % entries_per_chunk);
+		num_chunks = spdk_min(num_chunks, DEDUP_MAX_UNMAP_CHUNKS);
+		md_chunk = dedup_map_md_chunk(node, io_ctx->lchunk);
+
+		io_ctx->num_old = 0;
+		for (i = 0; i < num_chunks; i++) {
+			if (node->map[io_ctx->lchunk + i] != 0) {
+				io_ctx->old[io_ctx->num_old++] = node->map[io_ctx->lchunk + i] - 1;
+				dedup_map_set(node, io_ctx->lchunk + i, 0);
+			}
+		}
+		io_ctx->lchunk += num_chunks;
+
+		/* Wait for the chunks unmapped by earlier I/O too */
+		if (io_ctx->num_old > 0 || dedup_md_write_find(node, md_chunk) != NULL) {
+			dedup_md_write(node, md_chunk, io_ctx);
+			return;
+		}
+	}
+
+	dedup_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_SUCCESS);
+}
+
+static void
+dedup_read_done(struct dedup_req *req, bool success)
+{
+	struct spdk_bdev_io *bdev_io = req->cb_arg;
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)bdev_io->driver_ctx;
+	struct vbdev_dedup *node = SPDK_CONTAINEROF(bdev_io->bdev, struct vbdev_dedup, dedup_bdev);
+
+	dedup_chunk_put(node, io_ctx->pchunk);
+	dedup_io_complete(bdev_io, success ? SPDK_BDEV_IO_STATUS_SUCCESS : SPDK_BDEV_IO_STATUS_FAILED);
+}
+
+static void
+dedup_read(struct vbdev_dedup *node, struct spdk_bdev_io *bdev_io)
+{
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)bdev_io->driver_ctx;
+	uint32_t mapped;
+
+	/* Reads are split on chunk boundaries */
+	assert(bdev_io->u.bdev.num_blocks == 1);
+	mapped = node->map[bdev_io->u.bdev.offset_blocks];
+	if (mapped == 0) {
+		spdk_iov_memset(bdev_io->u.bdev.iovs, bdev_io->u.bdev.iovcnt, 0);
+		dedup_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_SUCCESS);
+		return;
+	}
+
+	/* Keep the chunk from being reused while it's read */
+	io_ctx->pchunk = mapped - 1;
+	dedup_chunk_get(node, io_ctx->pchunk);
+	dedup_chunk_io(node, &io_ctx->req, SPDK_BDEV_IO_TYPE_READ,
+		       node->data_offset + io_ctx->pchunk, bdev_io->u.bdev.iovs,
+		       bdev_io->u.bdev.iovcnt, dedup_read_done, bdev_io);
+}
+
+/* Unmapped chunks read as zeroes, so they're reported as holes. */
+static void
+dedup_seek(struct vbdev_dedup *node, struct spdk_bdev_io *bdev_io)
+{
+	bool data = bdev_io->type == SPDK_BDEV_IO_TYPE_SEEK_DATA;
+	uint64_t lchunk;
+
+	bdev_io->u.bdev.seek.offset = UINT64_MAX;
+	for (lchunk = bdev_io->u.bdev.offset_blocks; lchunk < node->num_logical; lchunk++) {
+		if ((node->map[lchunk] != 0) == data) {
+			bdev_io->u.bdev.seek.offset = lchunk;
+			break;
+		}
+	}
+
+	dedup_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_SUCCESS);
+}
+
+static void
+dedup_passthru_done(struct dedup_req *req, bool success)
+{
+	dedup_io_complete(req->cb_arg, success ? SPDK_BDEV_IO_STATUS_SUCCESS :
+			  SPDK_BDEV_IO_STATUS_FAILED);
+}
+
+static void
+_dedup_submit_request(void *ctx)
+{
+	struct spdk_bdev_io *bdev_io = ctx;
+	struct vbdev_dedup *node = SPDK_CONTAINEROF(bdev_io->bdev, struct vbdev_dedup, dedup_bdev);
+	struct dedup_bdev_io *io_ctx = (struct dedup_bdev_io *)bdev_io->driver_ctx;
+
+	io_ctx->num_old = 0;
+
+	switch (bdev_io->type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+		dedup_read(node, bdev_io);
+		break;
+	case SPDK_BDEV_IO_TYPE_WRITE:
+		dedup_write(node, bdev_io);
+		break;
+	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
+	case SPDK_BDEV_IO_TYPE_UNMAP:
+		io_ctx->lchunk = bdev_io->u.bdev.offset_blocks;
+		io_ctx->end = bdev_io->u.bdev.offset_blocks + bdev_io->u.bdev.num_blocks;
+		dedup_unmap(node, bdev_io);
+		break;
+	case SPDK_BDEV_IO_TYPE_FLUSH:
+		/* The map of acknowledged writes is persisted, only the data has to be flushed */
+		dedup_req_init(&io_ctx->req, node, SPDK_BDEV_IO_TYPE_FLUSH, 0,
+			       node->base_bdev->blockcnt, dedup_passthru_done, bdev_io);
+		dedup_req_submit(&io_ctx->req);
+		break;
+	case SPDK_BDEV_IO_TYPE_RESET:
+		dedup_req_init(&io_ctx->req, node, SPDK_BDEV_IO_TYPE_RESET, 0, 0,
+			       dedup_passthru_done, bdev_io);
+		dedup_req_submit(&io_ctx->req);
+		break;
+	case SPDK_BDEV_IO_TYPE_SEEK_DATA:
+	case SPDK_BDEV_IO_TYPE_SEEK_HOLE:
+		dedup_seek(node, bdev_io);
+		break;
+	default:
+		SPDK_ERRLOG("dedup: unknown I/O type %d\n", bdev_io->type);
+		dedup_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		break;
+	}
+}
+
+static void
+dedup_forward_request(struct vbdev_dedup *node, struct spdk_bdev_io *bdev_io)
+{
+	if (node->thread == spdk_get_thread()) {
+		_dedup_submit_request(bdev_io);
+	} else {
+		spdk_thread_send_msg(node->thread, _dedup_submit_request, bdev_io);
+	}
+}
+
+static void
+dedup_read_get_buf_cb(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io, bool success)
+{
+	struct vbdev_dedup *node = SPDK_CONTAINEROF(bdev_io->bdev, struct vbdev_dedup, dedup_bdev);
+
+	if (!success) {
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		return;
+	}
+
+	dedup_forward_request(node, bdev_io);
+}
+
+static void
+vbdev_dedup_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io)
+{
+	struct vbdev_dedup *node = SPDK_CONTAINEROF(bdev_io->bdev, struct vbdev_dedup, dedup_bdev);
+
+	if (bdev_io->type == SPDK_BDEV_IO_TYPE_READ) {
+		spdk_bdev_io_get_buf(bdev_io, dedup_read_get_buf_cb,
+				     bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen);
+		return;
+	}
+
+	dedup_forward_request(node, bdev_io);
+}
+
+static bool
+vbdev_dedup_io_type_supported(void *ctx, enum spdk_bdev_io_type io_type)
+{
+	switch (io_type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+	case SPDK_BDEV_IO_TYPE_WRITE:
+	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
+	case SPDK_BDEV_IO_TYPE_UNMAP:
+	case SPDK_BDEV_IO_TYPE_FLUSH:
+	case SPDK_BDEV_IO_TYPE_RESET:
+	case SPDK_BDEV_IO_TYPE_SEEK_DATA:
+	case SPDK_BDEV_IO_TYPE_SEEK_HOLE:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static int
+dedup_ch_create_cb(void *io_device, void *ctx_buf)
+{
+	return 0;
+}
+
+static void
+dedup_ch_destroy_cb(void *io_device, void *ctx_buf)
+{
+}
+
+static struct spdk_io_channel *
+vbdev_dedup_get_io_channel(void *ctx)
+{
+	struct vbdev_dedup *node = (struct vbdev_dedup *)ctx;
+
+	return spdk_get_io_channel(node);
+}
+
+static void
+_dedup_write_conf_values(struct vbdev_dedup *node, struct spdk_json_write_ctx *w)
+{
+	spdk_json_write_named_string(w, "name", spdk_bdev_get_name(&node->dedup_bdev));
+	spdk_json_write_named_string(w, "base_bdev_name", spdk_bdev_get_name(node->base_bdev));
+	spdk_json_write_named_uint32(w, "chunk_size", node->chunk_size);
+}
+
+static int
+vbdev_dedup_dump_info_json(void *ctx, struct spdk_json_write_ctx *w)
+{
+	struct vbdev_dedup *node = (struct vbdev_dedup *)ctx;
+
+	spdk_json_write_name(w, "dedup");
+	spdk_json_write_object_begin(w);
+	_dedup_write_conf_values(node, w);
+	spdk_json_write_named_uint64(w, "logical_chunks", node->num_logical);
+	spdk_json_write_named_uint64(w, "mapped_logical_chunks", node->num_mapped);
+	spdk_json_write_named_uint64(w, "physical_chunks", node->num_physical);
+	spdk_json_write_named_uint64(w, "used_physical_chunks", node->num_physical - node->num_free);
+	spdk_json_write_object_end(w);
+
+	return 0;
+}
+
+/* This is used to generate JSON that can configure this module to its current state. */
+static int
+vbdev_dedup_config_json(struct spdk_json_write_ctx *w)
+{
+	struct vbdev_dedup *node;
+
+	TAILQ_FOREACH(node, &g_dedup_nodes, link) {
+		spdk_json_write_object_begin(w);
+		spdk_json_write_named_string(w, "method", "bdev_dedup_create");
+		spdk_json_write_named_object_begin(w, "params");
+		_dedup_write_conf_values(node, w);
+		spdk_json_write_named_uint64(w, "size_mb", node->assoc->size_mb);
+		spdk_json_write_named_uuid(w, "uuid", &node->dedup_bdev.uuid);
+		spdk_json_write_object_end(w);
+		spdk_json_write_object_end(w);
+	}
+	return 0;
+}
+
+static void
+vbdev_dedup_write_config_json(struct spdk_bdev *bdev, struct spdk_json_write_ctx *w)
+{
+	/* No config per bdev needed */
+}
+
+static void
+_device_unregister_cb(void *io_device)
+{
+	struct vbdev_dedup *node = io_device;
+
+	assert(RB_EMPTY(&node->md_writes));
+
+	spdk_free(node->map);
+	spdk_free(node->fps);
+	spdk_free(node->cmp_bufs);
+	spdk_free(node->sb);
+	free(node->refcnt);
+	free(node->buckets);
+	free(node->next);
+	free(node->free_cmp_bufs);
+	free(node->dedup_bdev.name);
+	free(node);
+}
+
+/* Release everything acquired when the bdev was created. */
+static void
+dedup_node_free(struct vbdev_dedup *node)
+{
+	if (node->base_ch != NULL) {
+		spdk_put_io_channel(node->base_ch);
+	}
+	if (node->accel_ch != NULL) {
+		spdk_put_io_channel(node->accel_ch);
+	}
+	if (node->base_desc != NULL) {
+		spdk_bdev_module_release_bdev(node->base_bdev);
+		spdk_bdev_close(node->base_desc);
+	}
+	if (node->assoc != NULL) {
+		node->assoc->active = false;
+	}
+
+	spdk_io_device_unregister(node, _device_unregister_cb);
+}
+
+static void
+dedup_destruct_done(struct vbdev_dedup *node)
+{
+	struct spdk_bdev *bdev = &node->dedup_bdev;
+
+	dedup_node_free(node);
+	spdk_bdev_destruct_done(bdev, 0);
+}
+
+static void
+_vbdev_dedup_destruct(void *ctx)
+{
+	struct vbdev_dedup *node = ctx;
+
+	node->destructing = true;
+	if (RB_EMPTY(&node->md_writes)) {
+		dedup_destruct_done(node);
+	}
+}
+
+static int
+vbdev_dedup_destruct(void *ctx)
+{
+	struct vbdev_dedup *node = (struct vbdev_dedup *)ctx;
+
+	TAILQ_REMOVE(&g_dedup_nodes, node, link);
+
+	/* Wait for the fingerprints written in the background on the thread owning them. */
+	spdk_thread_send_msg(node->thread, _vbdev_dedup_destruct, node);
+
+	return 1;
+}
+
+/* When we register our bdev this is how we specify our entry points. */
+static const struct spdk_bdev_fn_table vbdev_dedup_fn_table = {
+	.destruct		= vbdev_dedup_destruct,
+	.submit_request		= vbdev_dedup_submit_request,
+	.io_type_supported	= vbdev_dedup_io_type_supported,
+	.get_io_channel		= vbdev_dedup_get_io_channel,
+	.dump_info_json		= vbdev_dedup_dump_info_json,
+	.write_config_json	= vbdev_dedup_write_config_json,
+};
+
+static void
+dedup_load_done(struct vbdev_dedup *node, int rc)
+{
+	bdev_dedup_create_cb cb_fn = node->create_cb;
+	void *cb_arg = node->create_cb_arg;
+	struct bdev_association *assoc;
+
+	if (rc == 0) {
+		TAILQ_INSERT_TAIL(&g_dedup_nodes, node, link);
+		rc = spdk_bdev_register(&node->dedup_bdev);
+		if (rc != 0) {
+			SPDK_ERRLOG("could not register dedup bdev\n");
+			TAILQ_REMOVE(&g_dedup_nodes, node, link);
+		}
+	}
+
+	if (rc != 0) {
+		SPDK_ERRLOG("Failed to create dedup bdev %s: %s\n", node->dedup_bdev.name,
+			    spdk_strerror(-rc));
+		assoc = node->assoc;
+		dedup_node_free(node);
+		if (cb_fn != NULL) {
+			/* Creation was requested directly, don't retry it on examine */
+			vbdev_dedup_free_association(assoc);
+		}
+	} else {
+		SPDK_NOTICELOG("Created dedup bdev %s on %s with %" PRIu64 " of %" PRIu64
+			       " physical chunks in use\n", node->dedup_bdev.name, node->base_bdev->name,
+			       node->num_physical - node->num_free, node->num_physical);
+	}
+
+	if (cb_fn != NULL) {
+		cb_fn(cb_arg, rc);
+	}
+}
+
+static void dedup_region_io_continue(struct vbdev_dedup *node);
+
+static void
+dedup_region_io_done(struct dedup_req *req, bool success)
+{
+	struct vbdev_dedup *node = req->cb_arg;
+	struct dedup_region_io *region = &node->region;
+
+	if (!success) {
+		SPDK_ERRLOG("Failed to %s metadata of %s\n",
+			    region->type == SPDK_BDEV_IO_TYPE_READ ? "read" : "write",
+			    node->base_bdev->name);
+		region->cb_fn(node, false);
+		return;
+	}
+
+	region->offset += req->num_blocks / node->blocks_per_chunk;
+	region->buf += req->num_blocks * node->base_bdev->blocklen;
+	dedup_region_io_continue(node);
+}
+
+static void
+dedup_region_io_continue(struct vbdev_dedup *node)
+{
+	struct dedup_region_io *region = &node->region;
+	uint64_t num_chunks;
+
+	if (region->offset == region->end) {
+		region->cb_fn(node, true);
+		return;
+	}
+
+	num_chunks = spdk_max(DEDUP_REGION_IO_KB * 1024 / node->chunk_size, 1);
+	num_chunks = spdk_min(num_chunks, region->end - region->offset);
+	region->iov.iov_base = region->buf;
+	region->iov.iov_len = num_chunks * node->chunk_size;
+	region->req.iovs = &region->iov;
+	region->req.iovcnt = 1;
+	dedup_req_init(&region->req, node, region->type, region->offset * node->blocks_per_chunk,
+		       num_chunks * node->blocks_per_chunk, dedup_region_io_done, node);
+	dedup_req_submit(&region->req);
+}
+
+/* Read or write a metadata region of the base bdev in pieces. */
+static void
+dedup_region_io(struct vbdev_dedup *node, enum spdk_bdev_io_type type, uint64_t offset,
+		uint64_t num_chunks, void *buf, void (*cb_fn)(struct vbdev_dedup *node, bool success))
+{
+	struct dedup_region_io *region = &node->region;
+
+	region->type = type;
+	region->offset = offset;
+	region->end = offset + num_chunks;
+	region->buf = buf;
+	region->cb_fn = cb_fn;
+	dedup_region_io_continue(node);
+}
+
+/* Rebuild the reference counts, the fingerprint index and the free list from the map. */
+static int
+dedup_rebuild(struct vbdev_dedup *node)
+{
+	uint64_t i;
+	uint32_t pchunk;
+
+	for (i = 0; i < node->num_logical; i++) {
+		if (node->map[i] == 0) {
+			continue;
+		}
+		if (node->map[i] > node->num_physical) {
+			SPDK_ERRLOG("Map of %s is corrupted at chunk %" PRIu64 "\n",
+				    node->base_bdev->name, i);
+			return -EILSEQ;
+		}
+		node->refcnt[node->map[i] - 1]++;
+		node->num_mapped++;
+	}
+
+	/* Allocate the chunks in order */
+	for (i = node->num_physical; i > 0; i--) {
+		pchunk = i - 1;
+		if (node->refcnt[pchunk] > 0) {
+			dedup_index_insert(node, pchunk);
+		} else {
+			node->next[pchunk] = node->free_head;
+			node->free_head = pchunk;
+			node->num_free++;
+		}
+	}
+
+	return 0;
+}
+
+static void
+dedup_format_sb_done(struct dedup_req *req, bool success)
+{
+	struct vbdev_dedup *node = req->cb_arg;
+
+	dedup_load_done(node, success ? dedup_rebuild(node) : -EIO);
+}
+
+static void
+dedup_format_map_done(struct vbdev_dedup *node, bool success)
+{
+	struct dedup_sb *sb = node->sb;
+
+	if (!success) {
+		dedup_load_done(node, -EIO);
+		return;
+	}
+
+	/* The superblock goes last, so that the bdev is formatted again if this fails */
+	memset(sb, 0, node->chunk_size);
+	memcpy(sb->magic, DEDUP_SB_MAGIC, sizeof(sb->magic));
+	sb->version = DEDUP_SB_VERSION;
+	sb->chunk_size = node->chunk_size;
+	sb->num_logical = node->num_logical;
+	sb->num_physical = node->num_physical;
+	sb->map_offset = node->map_offset;
+	sb->fp_offset = node->fp_offset;
+	sb->data_offset = node->data_offset;
+	sb->crc = spdk_crc32c_update(sb, sizeof(*sb), ~0u);
+
+	dedup_chunk_io(node, &node->sb_req, SPDK_BDEV_IO_TYPE_WRITE, 0, &node->sb_iov, 1,
+		       dedup_format_sb_done, node);
+}
+
+static void
+dedup_load_fps_done(struct vbdev_dedup *node, bool success)
+{
+	dedup_load_done(node, success ? dedup_rebuild(node) : -EIO);
+}
+
+static void
+dedup_load_map_done(struct vbdev_dedup *node, bool success)
+{
+	if (!success) {
+		dedup_load_done(node, -EIO);
+		return;
+	}
+
+	dedup_region_io(node, SPDK_BDEV_IO_TYPE_READ, node->fp_offset,
+			node->data_offset - node->fp_offset, node->fps, dedup_load_fps_done);
+}
+
+static void
+dedup_load_sb_done(struct dedup_req *req, bool success)
+{
+	struct vbdev_dedup *node = req->cb_arg;
+	struct dedup_sb *sb = node->sb;
+	uint32_t crc = sb->crc;
+
+	if (!success) {
+		SPDK_ERRLOG("Failed to read superblock of %s\n", node->base_bdev->name);
+		dedup_load_done(node, -EIO);
+		return;
+	}
+
+	sb->crc = 0;
+	if (memcmp(sb->magic, DEDUP_SB_MAGIC, sizeof(sb->magic)) != 0 ||
+	    spdk_crc32c_update(sb, sizeof(*sb), ~0u) != crc) {
+		SPDK_NOTICELOG("No dedup metadata found on %s, initializing\n", node->base_bdev->name);
+		dedup_region_io(node, SPDK_BDEV_IO_TYPE_WRITE, node->map_offset,
+				node->fp_offset - node->map_offset, node->map, dedup_format_map_done);
+		return;
+	}
+	sb->crc = crc;
+
+	if (sb->version != DEDUP_SB_VERSION || sb->chunk_size != node->chunk_size ||
+	    sb->num_logical != node->num_logical || sb->num_physical != node->num_physical ||
+	    sb->map_offset != node->map_offset || sb->fp_offset != node->fp_offset ||
+	    sb->data_offset != node->data_offset) {
+		SPDK_ERRLOG("Dedup metadata on %s is not compatible\n", node->base_bdev->name);
+		dedup_load_done(node, -EINVAL);
+		return;
+	}
+
+	dedup_region_io(node, SPDK_BDEV_IO_TYPE_READ, node->map_offset,
+			node->fp_offset - node->map_offset, node->map, dedup_load_map_done);
+}
+
+static void
+dedup_load(struct vbdev_dedup *node)
+{
+	node->sb_iov.iov_base = node->sb;
+	node->sb_iov.iov_len = node->chunk_size;
+	dedup_chunk_io(node, &node->sb_req, SPDK_BDEV_IO_TYPE_READ, 0, &node->sb_iov, 1,
+		       dedup_load_sb_done, node);
+}
+
+static void
+vbdev_dedup_base_bdev_hotremove_cb(struct spdk_bdev *bdev_find)
+{
+	struct vbdev_dedup *node, *tmp;
+
+	TAILQ_FOREACH_SAFE(node, &g_dedup_nodes, link, tmp) {
+		if (bdev_find == node->base_bdev) {
+			spdk_bdev_unregister(&node->dedup_bdev, NULL, NULL);
+		}
+	}
+}
+
+/* Called when the underlying base bdev triggers asynchronous event such as bdev removal. */
+static void
+vbdev_dedup_base_bdev_event_cb(enum spdk_bdev_event_type type, struct spdk_bdev *bdev,
+			       void *event_ctx)
+{
+	switch (type) {
+	case SPDK_BDEV_EVENT_REMOVE:
+		vbdev_dedup_base_bdev_hotremove_cb(bdev);
+		break;
+	default:
+		SPDK_NOTICELOG("Unsupported bdev event: type %d\n", type);
+		break;
+	}
+}
+
+static int
+dedup_open_base_bdev(struct vbdev_dedup *node, const char *bdev_name)
+{
+	int rc;
+
+	rc = spdk_bdev_open_ext(bdev_name, true, vbdev_dedup_base_bdev_event_cb, NULL,
+				&node->base_desc);
+	if (rc != 0) {
+		SPDK_ERRLOG("could not open bdev %s\n", bdev_name);
+		node->base_desc = NULL;
+		return rc;
+	}
+
+	node->base_bdev = spdk_bdev_desc_get_bdev(node->base_desc);
+	rc = spdk_bdev_module_claim_bdev(node->base_bdev, node->base_desc, &dedup_if);
+	if (rc != 0) {
+		SPDK_ERRLOG("could not claim bdev %s\n", bdev_name);
+		spdk_bdev_close(node->base_desc);
+		node->base_desc = NULL;
+		return rc;
+	}
+
+	node->base_ch = spdk_bdev_get_io_channel(node->base_desc);
+	node->accel_ch = spdk_accel_get_io_channel();
+	if (node->base_ch == NULL || node->accel_ch == NULL) {
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
+static bool
+dedup_geometry_fits(uint64_t total, uint64_t num_logical, uint64_t num_physical,
+		    uint64_t entries_per_chunk)
+{
+	return 1 + spdk_divide_round_up(num_logical, entries_per_chunk) +
+	       spdk_divide_round_up(num_physical, entries_per_chunk) + num_physical <= total;
+}
+
+/* Lay the metadata and the data out on the base bdev and allocate the buffers. */
+static int
+dedup_init_geometry(struct vbdev_dedup *node, const struct bdev_association *assoc)
+{
+	struct spdk_bdev *base = node->base_bdev;
+	uint64_t entries_per_chunk, total, num_logical, num_physical, map_chunks;
+	uint32_t i;
+
+	node->chunk_size = assoc->chunk_size ? assoc->chunk_size : DEDUP_DEFAULT_CHUNK_SIZE;
+	if (base->md_len != 0 || !spdk_u32_is_pow2(node->chunk_size) ||
+	    node->chunk_size < base->blocklen || node->chunk_size % base->blocklen != 0) {
+		SPDK_ERRLOG("Chunk size %" PRIu32 " is not supported on %s\n", node->chunk_size,
+			    base->name);
+		return -EINVAL;
+	}
+
+	node->blocks_per_chunk = node->chunk_size / base->blocklen;
+	entries_per_chunk = node->chunk_size / sizeof(uint32_t);
+	total = base->blockcnt / node->blocks_per_chunk;
+
+	if (assoc->size_mb == 0) {
+		/* Without overprovisioning, every logical chunk can hold unique data */
+		num_physical = total > 1 ? (total - 1) * entries_per_chunk / (entries_per_chunk + 2) : 0;
+		num_physical = spdk_min(num_physical, DEDUP_CHUNK_NONE - 1);
+		while (num_physical > 0 &&
+		       !dedup_geometry_fits(total, num_physical, num_physical, entries_per_chunk)) {
+			num_physical--;
+		}
+		num_logical = num_physical;
+	} else {
+		num_logical = assoc->size_mb * 1024 * 1024 / node->chunk_size;
+		map_chunks = spdk_divide_round_up(num_logical, entries_per_chunk);
+		num_physical = total > map_chunks + 1 ?
+			       (total - map_chunks - 1) * entries_per_chunk / (entries_per_chunk + 1) : 0;
+		num_physical = spdk_min(num_physical, DEDUP_CHUNK_NONE - 1);
+		while (num_physical > 0 &&
+		       !dedup_geometry_fits(total, num_logical, num_physical, entries_per_chunk)) {
+			num_physical--;
+		}
+	}
+
+	if (num_physical == 0 || num_logical == 0) {
+		SPDK_ERRLOG("Bdev %s is too small\n", base->name);
+		return -EINVAL;
+	}
+
+	node->num_logical = num_logical;
+	node->num_physical = num_physical;
+	node->map_offset = 1;
+	node->fp_offset = node->map_offset + spdk_divide_round_up(num_logical, entries_per_chunk);
+	node->data_offset = node->fp_offset + spdk_divide_round_up(num_physical, entries_per_chunk);
+	node->bucket_mask = spdk_align64pow2(num_physical) - 1;
+
+	node->map = spdk_zmalloc((node->fp_offset - node->map_offset) * node->chunk_size, 0x1000,
+				 NULL, SPDK_ENV_LCORE_ID_ANY, SPDK_MALLOC_DMA);
+	node->fps = spdk_zmalloc((node->data_offset - node->fp_offset) * node->chunk_size, 0x1000,
+				 NULL, SPDK_ENV_LCORE_ID_ANY, SPDK_MALLOC_DMA);
+	node->sb = spdk_zmalloc(node->chunk_size, 0x1000, NULL, SPDK_ENV_LCORE_ID_ANY,
+				SPDK_MALLOC_DMA);
+	node->cmp_bufs = spdk_zmalloc((size_t)DEDUP_NUM_CMP_BUFS * node->chunk_size, 0x1000, NULL,
+				      SPDK_ENV_LCORE_ID_ANY, SPDK_MALLOC_DMA);
+	node->refcnt = calloc(num_physical, sizeof(*node->refcnt));
+	node->next = calloc(num_physical, sizeof(*node->next));
+	node->buckets = malloc(((uint64_t)node->bucket_mask + 1) * sizeof(*node->buckets));
+	node->free_cmp_bufs = calloc(DEDUP_NUM_CMP_BUFS, sizeof(*node->free_cmp_bufs));
+	if (node->map == NULL || node->fps == NULL || node->sb == NULL || node->cmp_bufs == NULL ||
+	    node->refcnt == NULL || node->next == NULL || node->buckets == NULL ||
+	    node->free_cmp_bufs == NULL) {
+		return -ENOMEM;
+	}
+
+	memset(node->buckets, 0xff, ((uint64_t)node->bucket_mask + 1) * sizeof(*node->buckets));
+	node->free_head = DEDUP_CHUNK_NONE;
+	/* Writes of zeroes are told apart by their fingerprint first */
+	node->zero_crc = spdk_crc32c_update(node->cmp_bufs, node->chunk_size, ~0u);
+
+	for (i = 0; i < DEDUP_NUM_CMP_BUFS; i++) {
+		node->free_cmp_bufs[i] = (uint8_t *)node->cmp_bufs + (size_t)i * node->chunk_size;
+	}
+	node->num_free_cmp_bufs = DEDUP_NUM_CMP_BUFS;
+
+	return 0;
+}
+
+/* Create the dedup bdev once its base bdev exists. */
+static int
+vbdev_dedup_register(struct bdev_association *assoc, bdev_dedup_create_cb cb_fn, void *cb_arg)
+{
+	struct vbdev_dedup *node;
+	struct spdk_uuid ns_uuid;
+	int rc;
+
+	if (assoc->active || spdk_bdev_get_by_name(assoc->base_bdev_name) == NULL) {
+		return -ENODEV;
+	}
+
+	node = calloc(1, sizeof(struct vbdev_dedup));
+	if (!node) {
+		SPDK_ERRLOG("could not allocate dedup node\n");
+		return -ENOMEM;
+	}
+
+	node->dedup_bdev.name = strdup(assoc->vbdev_name);
+	if (!node->dedup_bdev.name) {
+		SPDK_ERRLOG("could not allocate dedup bdev name\n");
+		free(node);
+		return -ENOMEM;
+	}
+
+	RB_INIT(&node->md_writes);
+	TAILQ_INIT(&node->cmp_waiters);
+	node->thread = spdk_get_thread();
+	node->create_cb = cb_fn;
+	node->create_cb_arg = cb_arg;
+	spdk_io_device_register(node, dedup_ch_create_cb, dedup_ch_destroy_cb, 0,
+				assoc->vbdev_name);
+
+	rc = dedup_open_base_bdev(node, assoc->base_bdev_name);
+	if (rc == 0) {
+		rc = dedup_init_geometry(node, assoc);
+	}
+	if (rc != 0) {
+		dedup_node_free(node);
+		return rc;
+	}
+
+	if (!spdk_uuid_is_null(&assoc->uuid)) {
+		spdk_uuid_copy(&node->dedup_bdev.uuid, &assoc->uuid);
+	} else {
+		/* Generate UUID based on namespace UUID + base bdev UUID. */
+		spdk_uuid_parse(&ns_uuid, BDEV_DEDUP_NAMESPACE_UUID);
+		rc = spdk_uuid_generate_sha1(&node->dedup_bdev.uuid, &ns_uuid,
+					     (const char *)&node->base_bdev->uuid, sizeof(struct spdk_uuid));
+		if (rc) {
+			SPDK_ERRLOG("Unable to generate new UUID for dedup bdev\n");
+			dedup_node_free(node);
+			return rc;
+		}
+	}
+
+	node->dedup_bdev.product_name = "dedup";
+	node->dedup_bdev.write_cache = node->base_bdev->write_cache;
+	node->dedup_bdev.required_alignment = node->base_bdev->required_alignment;
+	/* Every read and write is a single chunk */
+	node->dedup_bdev.optimal_io_boundary = 1;
+	node->dedup_bdev.split_on_optimal_io_boundary = true;
+	node->dedup_bdev.blocklen = node->chunk_size;
+	node->dedup_bdev.blockcnt = node->num_logical;
+	node->dedup_bdev.ctxt = node;
+	node->dedup_bdev.fn_table = &vbdev_dedup_fn_table;
+	node->dedup_bdev.module = &dedup_if;
+
+	node->assoc = assoc;
+	assoc->active = true;
+	dedup_load(node);
+
+	return 0;
+}
+
+static struct bdev_association *
+vbdev_dedup_find_association(const char *vbdev_name)
+{
+	struct bdev_association *assoc;
+
+	TAILQ_FOREACH(assoc, &g_bdev_associations, link) {
+		if (strcmp(vbdev_name, assoc->vbdev_name) == 0) {
+			return assoc;
+		}
+	}
+
+	return NULL;
+}
+
+static void
+vbdev_dedup_free_association(struct bdev_association *assoc)
+{
+	TAILQ_REMOVE(&g_bdev_associations, assoc, link);
+	free(assoc->base_bdev_name);
+	free(assoc->vbdev_name);
+	free(assoc);
+}
+
+static int
+vbdev_dedup_insert_association(const struct vbdev_dedup_opts *opts,
+			       struct bdev_association **_assoc)
+{
+	struct bdev_association *assoc;
+
+	if (vbdev_dedup_find_association(opts->name) != NULL) {
+		SPDK_ERRLOG("dedup bdev %s already exists\n", opts->name);
+		return -EEXIST;
+	}
+
+	assoc = calloc(1, sizeof(struct bdev_association));
+	if (!assoc) {
+		SPDK_ERRLOG("could not allocate bdev_association\n");
+		return -ENOMEM;
+	}
+
+	assoc->vbdev_name = strdup(opts->name);
+	assoc->base_bdev_name = strdup(opts->base_bdev_name);
+	if (!assoc->vbdev_name || !assoc->base_bdev_name) {
+		SPDK_ERRLOG("could not allocate bdev_association names\n");
+		free(assoc->vbdev_name);
+		free(assoc->base_bdev_name);
+		free(assoc);
+		return -ENOMEM;
+	}
+
+	assoc->chunk_size = opts->chunk_size;
+	assoc->size_mb = opts->size_mb;
+	spdk_uuid_copy(&assoc->uuid, &opts->uuid);
+	TAILQ_INSERT_TAIL(&g_bdev_associations, assoc, link);
+	*_assoc = assoc;
+
+	return 0;
+}
+
+int
+bdev_dedup_create_disk(const struct vbdev_dedup_opts *opts, bdev_dedup_create_cb cb_fn,
+		       void *cb_arg)
+{
+	struct bdev_association *assoc;
+	int rc;
+
+	if (opts->name == NULL || opts->base_bdev_name == NULL) {
+		return -EINVAL;
+	}
+
+	if (opts->chunk_size != 0 && !spdk_u32_is_pow2(opts->chunk_size)) {
+		SPDK_ERRLOG("Chunk size must be a power of 2\n");
+		return -EINVAL;
+	}
+
+	/* Insert the bdev names into our global list even if they don't exist yet,
+	 * they may show up soon...
+	 */
+	rc = vbdev_dedup_insert_association(opts, &assoc);
+	if (rc) {
+		return rc;
+	}
+
+	rc = vbdev_dedup_register(assoc, cb_fn, cb_arg);
+	if (rc == -ENODEV) {
+		/* This is not an error, we tracked the names above and they still
+		 * may show up later.
+		 */
+		SPDK_NOTICELOG("vbdev creation deferred pending base bdev arrival\n");
+		cb_fn(cb_arg, 0);
+		rc = 0;
+	} else if (rc != 0) {
+		vbdev_dedup_free_association(assoc);
+	}
+
+	return rc;
+}
+
+void
+bdev_dedup_delete_disk(const char *bdev_name, spdk_bdev_unregister_cb cb_fn, void *cb_arg)
+{
+	struct bdev_association *assoc;
+	int rc;
+
+	rc = spdk_bdev_unregister_by_name(bdev_name, &dedup_if, cb_fn, cb_arg);
+	if (rc == 0) {
+		/* Remove the association so that the vbdev does not get re-created if the same
+		 * bdev is constructed at some other time, unless it was hot-removed.
+		 */
+		assoc = vbdev_dedup_find_association(bdev_name);
+		if (assoc != NULL) {
+			vbdev_dedup_free_association(assoc);
+		}
+	} else {
+		cb_fn(cb_arg, rc);
+	}
+}
+
+static int
+vbdev_dedup_init(void)
+{
+	return 0;
+}
+
+static void
+vbdev_dedup_finish(void)
+{
+	struct bdev_association *assoc;
+
+	while ((assoc = TAILQ_FIRST(&g_bdev_associations))) {
+		vbdev_dedup_free_association(assoc);
+	}
+}
+
+static int
+vbdev_dedup_get_ctx_size(void)
+{
+	return sizeof(struct dedup_bdev_io);
+}
+
+static void
+vbdev_dedup_examine(struct spdk_bdev *bdev)
+{
+	struct bdev_association *assoc;
+
+	TAILQ_FOREACH(assoc, &g_bdev_associations, link) {
+		if (strcmp(assoc->base_bdev_name, bdev->name) == 0) {
+			vbdev_dedup_register(assoc, NULL, NULL);
+		}
+	}
+
+	spdk_bdev_module_examine_done(&dedup_if);
+}
+
+SPDK_LOG_REGISTER_COMPONENT(vbdev_dedup)
@@ -0,0 +1,60 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 the SPDK authors.
+ *   All rights reserved.
+ */
+
+#ifndef SPDK_VBDEV_DEDUP_H
+#define SPDK_VBDEV_DEDUP_H
+
+#include "spdk/stdinc.h"
+
+#include "spdk/bdev.h"
+#include "spdk/bdev_module.h"
+
+struct vbdev_dedup_opts {
+	/* Name of the dedup bdev */
+	const char		*name;
+
+	/* Name of the bdev holding the deduplicated data */
+	const char		*base_bdev_name;
+
+	/* Size of the deduplicated chunks in bytes, 0 for the default of 4KiB. It's also
+	 * the block size of the dedup bdev.
+	 */
+	uint32_t		chunk_size;
+
+	/* Size of the dedup bdev in MiB, 0 to match the data capacity of the base bdev */
+	uint64_t		size_mb;
+
+	/* Optional UUID of the dedup bdev */
+	struct spdk_uuid	uuid;
+};
+
+typedef void (*bdev_dedup_create_cb)(void *cb_arg, int bdeverrno);
+
+/**
+ * Create new dedup bdev.
+ *
+ * If the base bdev holds the metadata of a previous instance, the map of the chunks and the
+ * fingerprint index are loaded from it before the new bdev is registered. Otherwise the
+ * metadata is initialized. If the base bdev doesn't exist yet, creation is deferred until
+ * it shows up and cb_fn is called right away.
+ *
+ * \param opts Options of the dedup bdev.
+ * \param cb_fn Function to call once the bdev is created.
+ * \param cb_arg Argument to pass to cb_fn.
+ * \return 0 if creation was started, negative errno otherwise. cb_fn is only called on success.
+ */
+int bdev_dedup_create_disk(const struct vbdev_dedup_opts *opts, bdev_dedup_create_cb cb_fn,
+			   void *cb_arg);
+
+/**
+ * Delete dedup bdev. Its metadata is kept on the base bdev.
+ *
+ * \param bdev_name Name of the dedup bdev.
+ * \param cb_fn Function to call after deletion.
+ * \param cb_arg Argument to pass to cb_fn.
+ */
+void bdev_dedup_delete_disk(const char *bdev_name, spdk_bdev_unregister_cb cb_fn, void *cb_arg);
+
+#endif /* SPDK_VBDEV_DEDUP_H */
@@ -0,0 +1,148 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 the SPDK authors.
+ *   All rights reserved.
+ */
+
+#include "vbdev_dedup.h"
+#include "spdk/rpc.h"
+#include "spdk/util.h"
+#include "spdk/string.h"
+#include "spdk/log.h"
+
+/* Structure to hold the parameters for this RPC method. */
+struct rpc_bdev_dedup_create {
+	char *base_bdev_name;
+	char *name;
+	uint32_t chunk_size;
+	uint64_t size_mb;
+	struct spdk_uuid uuid;
+	struct spdk_jsonrpc_request *request;
+};
+
+/* Free the allocated memory resource after the RPC handling. */
+static void
+free_rpc_bdev_dedup_create(struct rpc_bdev_dedup_create *r)
+{
+	free(r->base_bdev_name);
+	free(r->name);
+	free(r);
+}
+
+/* Structure to decode the input parameters for this RPC method. */
+static const struct spdk_json_object_decoder rpc_bdev_dedup_create_decoders[] = {
+	{"base_bdev_name", offsetof(struct rpc_bdev_dedup_create, base_bdev_name), spdk_json_decode_string},
+	{"name", offsetof(struct rpc_bdev_dedup_create, name), spdk_json_decode_string},
+	{"chunk_size", offsetof(struct rpc_bdev_dedup_create, chunk_size), spdk_json_decode_uint32, true},
+	{"size_mb", offsetof(struct rpc_bdev_dedup_create, size_mb), spdk_json_decode_uint64, true},
+	{"uuid", offsetof(struct rpc_bdev_dedup_create, uuid), spdk_json_decode_uuid, true},
+};
+
+static void
+rpc_bdev_dedup_create_cb(void *cb_arg, int bdeverrno)
+{
+	struct rpc_bdev_dedup_create *req = cb_arg;
+	struct spdk_json_write_ctx *w;
+
+	if (bdeverrno != 0) {
+		spdk_jsonrpc_send_error_response(req->request, bdeverrno, spdk_strerror(-bdeverrno));
+	} else {
+		w = spdk_jsonrpc_begin_result(req->request);
+		spdk_json_write_string(w, req->name);
+		spdk_jsonrpc_end_result(req->request, w);
+	}
+
+	free_rpc_bdev_dedup_create(req);
+}
+
+/* Decode the parameters for this RPC method and properly construct the dedup device.
+ * The response is sent once the metadata on the base bdev is loaded.
+ */
+static void
+rpc_bdev_dedup_create(struct spdk_jsonrpc_request *request,
+		      const struct spdk_json_val *params)
+{
+	struct rpc_bdev_dedup_create *req;
+	struct vbdev_dedup_opts opts = {};
+	int rc;
+
+	req = calloc(1, sizeof(*req));
+	if (req == NULL) {
+		spdk_jsonrpc_send_error_response(request, -ENOMEM, spdk_strerror(ENOMEM));
+		return;
+	}
+
+	if (spdk_json_decode_object(params, rpc_bdev_dedup_create_decoders,
+				    SPDK_COUNTOF(rpc_bdev_dedup_create_decoders),
+				    req)) {
+		SPDK_DEBUGLOG(vbdev_dedup, "spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	req->request = request;
+	opts.name = req->name;
+	opts.base_bdev_name = req->base_bdev_name;
+	opts.chunk_size = req->chunk_size;
+	opts.size_mb = req->size_mb;
+	spdk_uuid_copy(&opts.uuid, &req->uuid);
+
+	rc = bdev_dedup_create_disk(&opts, rpc_bdev_dedup_create_cb, req);
+	if (rc != 0) {
+		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
+		goto cleanup;
+	}
+
+	return;
+
+cleanup:
+	free_rpc_bdev_dedup_create(req);
+}
+SPDK_RPC_REGISTER("bdev_dedup_create", rpc_bdev_dedup_create, SPDK_RPC_RUNTIME)
+
+struct rpc_bdev_dedup_delete {
+	char *name;
+};
+
+static void
+free_rpc_bdev_dedup_delete(struct rpc_bdev_dedup_delete *req)
+{
+	free(req->name);
+}
+
+static const struct spdk_json_object_decoder rpc_bdev_dedup_delete_decoders[] = {
+	{"name", offsetof(struct rpc_bdev_dedup_delete, name), spdk_json_decode_string},
+};
+
+static void
+rpc_bdev_dedup_delete_cb(void *cb_arg, int bdeverrno)
+{
+	struct spdk_jsonrpc_request *request = cb_arg;
+
+	if (bdeverrno == 0) {
+		spdk_jsonrpc_send_bool_response(request, true);
+	} else {
+		spdk_jsonrpc_send_error_response(request, bdeverrno, spdk_strerror(-bdeverrno));
+	}
+}
+
+static void
+rpc_bdev_dedup_delete(struct spdk_jsonrpc_request *request,
+		      const struct spdk_json_val *params)
+{
+	struct rpc_bdev_dedup_delete req = {NULL};
+
+	if (spdk_json_decode_object(params, rpc_bdev_dedup_delete_decoders,
+				    SPDK_COUNTOF(rpc_bdev_dedup_delete_decoders),
+				    &req)) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	bdev_dedup_delete_disk(req.name, rpc_bdev_dedup_delete_cb, request);
+
+cleanup:
+	free_rpc_bdev_dedup_delete(&req);
+}
+SPDK_RPC_REGISTER("bdev_dedup_delete", rpc_bdev_dedup_delete, SPDK_RPC_RUNTIME)
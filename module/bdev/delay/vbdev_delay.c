@@ -196,6 +196,11 @@ _delay_complete_io(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
 
 	io_ctx->status = success ? SPDK_BDEV_IO_STATUS_SUCCESS : SPDK_BDEV_IO_STATUS_FAILED;
 
+	if (bdev_io->type == SPDK_BDEV_IO_TYPE_SEEK_DATA ||
+	    bdev_io->type == SPDK_BDEV_IO_TYPE_SEEK_HOLE) {
+		orig_io->u.bdev.seek.offset = spdk_bdev_io_get_seek_offset(bdev_io);
+	}
+
 	if (bdev_io->type == SPDK_BDEV_IO_TYPE_ZCOPY && bdev_io->u.bdev.zcopy.start && success) {
 		io_ctx->zcopy_bdev_io = bdev_io;
 	} else {
@@ -264,6 +269,9 @@ delay_init_ext_io_opts(struct spdk_bdev_io *bdev_io, struct spdk_bdev_ext_io_opt
 	opts->memory_domain = bdev_io->u.bdev.memory_domain;
 	opts->memory_domain_ctx = bdev_io->u.bdev.memory_domain_ctx;
 	opts->metadata = bdev_io->u.bdev.md_buf;
+	if (bdev_io->type == SPDK_BDEV_IO_TYPE_WRITE) {
+		opts->placement_hint = bdev_io->u.bdev.placement_hint;
+	}
 }
 
 static void
@@ -468,6 +476,16 @@ vbdev_delay_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev
 						 _delay_complete_io, bdev_io);
 		}
 		break;
+	case SPDK_BDEV_IO_TYPE_SEEK_DATA:
+		rc = spdk_bdev_seek_data(delay_node->base_desc, delay_ch->base_ch,
+					 bdev_io->u.bdev.offset_blocks,
+					 _delay_complete_io, bdev_io);
+		break;
+	case SPDK_BDEV_IO_TYPE_SEEK_HOLE:
+		rc = spdk_bdev_seek_hole(delay_node->base_desc, delay_ch->base_ch,
+					 bdev_io->u.bdev.offset_blocks,
+					 _delay_complete_io, bdev_io);
+		break;
 	default:
 		SPDK_ERRLOG("delay: unknown I/O type %d\n", bdev_io->type);
 		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
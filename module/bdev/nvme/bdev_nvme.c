@@ -12,6 +12,7 @@
 #include "spdk/accel.h"
 #include "spdk/config.h"
 #include "spdk/endian.h"
+#include "spdk/env.h"
 #include "spdk/bdev.h"
 #include "spdk/json.h"
 #include "spdk/likely.h"
@@ -94,6 +95,9 @@ struct nvme_bdev_io {
 
 	/* Current tsc at submit time. */
 	uint64_t submit_tsc;
+
+	/* Tsc at submission to the qpair, used by the latency selector. */
+	uint64_t qpair_submit_tsc;
 };
 
 struct nvme_probe_skip_entry {
@@ -129,6 +133,10 @@ static struct spdk_bdev_nvme_opts g_opts = {
 	.nvme_error_stat = false,
 	.io_path_stat = false,
 	.allow_accel_sequence = false,
+	.prefer_numa_local_path = false,
+	.poll_group_requests = 0,
+	.poll_group_submit_batch = false,
+	.fast_failover = false,
 };
 
 #define NVME_HOTPLUG_POLL_PERIOD_MAX			10000000ULL
@@ -161,7 +169,7 @@ static int bdev_nvme_no_pi_readv(struct nvme_bdev_io *bio, struct iovec *iov, in
 static int bdev_nvme_writev(struct nvme_bdev_io *bio, struct iovec *iov, int iovcnt,
 			    void *md, uint64_t lba_count, uint64_t lba,
 			    uint32_t flags, struct spdk_memory_domain *domain, void *domain_ctx,
-			    struct spdk_accel_sequence *seq);
+			    struct spdk_accel_sequence *seq, uint16_t placement_hint);
 static int bdev_nvme_zone_appendv(struct nvme_bdev_io *bio, struct iovec *iov, int iovcnt,
 				  void *md, uint64_t lba_count,
 				  uint64_t zslba, uint32_t flags);
@@ -633,6 +641,24 @@ nvme_io_path_free(struct nvme_io_path *io_path)
 	free(io_path);
 }
 
+/* Return true if the calling thread runs on the NUMA node of the controller, or if either
+ * of them is unknown.
+ */
+static bool
+nvme_ctrlr_is_numa_local(struct nvme_ctrlr *nvme_ctrlr)
+{
+	int32_t numa_id;
+	uint32_t core;
+
+	numa_id = spdk_nvme_ctrlr_get_numa_id(nvme_ctrlr->ctrlr);
+	core = spdk_env_get_current_core();
+	if (numa_id == SPDK_ENV_SOCKET_ID_ANY || core == SPDK_ENV_LCORE_ID_ANY) {
+		return true;
+	}
+
+	return spdk_env_get_socket_id(core) == (uint32_t)numa_id;
+}
+
 static int
 _bdev_nvme_add_io_path(struct nvme_bdev_channel *nbdev_ch, struct nvme_ns *nvme_ns)
 {
@@ -663,6 +689,10 @@ _bdev_nvme_add_io_path(struct nvme_bdev_channel *nbdev_ch, struct nvme_ns *nvme_
 	io_path->qpair = nvme_qpair;
 	TAILQ_INSERT_TAIL(&nvme_qpair->io_path_list, io_path, tailq);
 
+	/* Without a locality preference, all paths are considered local. */
+	io_path->numa_local = !g_opts.prefer_numa_local_path ||
+			      nvme_ctrlr_is_numa_local(nvme_ns->ctrlr);
+
 	io_path->nbdev_ch = nbdev_ch;
 	STAILQ_INSERT_TAIL(&nbdev_ch->io_path_list, io_path, stailq);
 
@@ -931,10 +961,19 @@ nvme_io_path_get_next(struct nvme_bdev_channel *nbdev_ch, struct nvme_io_path *p
 	return STAILQ_FIRST(&nbdev_ch->io_path_list);
 }
 
+/* Locality only matters to load balancing. The active-passive policy keeps using the
+ * preferred path.
+ */
+static inline bool
+nvme_io_path_is_numa_preferred(struct nvme_bdev_channel *nbdev_ch, struct nvme_io_path *io_path)
+{
+	return io_path->numa_local || nbdev_ch->mp_policy == BDEV_NVME_MP_POLICY_ACTIVE_PASSIVE;
+}
+
 static struct nvme_io_path *
 _bdev_nvme_find_io_path(struct nvme_bdev_channel *nbdev_ch)
 {
-	struct nvme_io_path *io_path, *start, *non_optimized = NULL;
+	struct nvme_io_path *io_path, *start, *optimized = NULL, *non_optimized = NULL;
 
 	start = nvme_io_path_get_next(nbdev_ch, nbdev_ch->current_io_path);
 
@@ -944,10 +983,18 @@ _bdev_nvme_find_io_path(struct nvme_bdev_channel *nbdev_ch)
 				!io_path->nvme_ns->ana_state_updating)) {
 			switch (io_path->nvme_ns->ana_state) {
 			case SPDK_NVME_ANA_OPTIMIZED_STATE:
-				nbdev_ch->current_io_path = io_path;
-				return io_path;
+				if (nvme_io_path_is_numa_preferred(nbdev_ch, io_path)) {
+					nbdev_ch->current_io_path = io_path;
+					return io_path;
+				}
+				if (optimized == NULL) {
+					optimized = io_path;
+				}
+				break;
 			case SPDK_NVME_ANA_NON_OPTIMIZED_STATE:
-				if (non_optimized == NULL) {
+				if (non_optimized == NULL ||
+				    (!nvme_io_path_is_numa_preferred(nbdev_ch, non_optimized) &&
+				     nvme_io_path_is_numa_preferred(nbdev_ch, io_path))) {
 					non_optimized = io_path;
 				}
 				break;
@@ -958,6 +1005,12 @@ _bdev_nvme_find_io_path(struct nvme_bdev_channel *nbdev_ch)
 		io_path = nvme_io_path_get_next(nbdev_ch, io_path);
 	} while (io_path != start);
 
+	if (optimized != NULL) {
+		/* Only optimized paths on a remote NUMA node are left. */
+		nbdev_ch->current_io_path = optimized;
+		return optimized;
+	}
+
 	if (nbdev_ch->mp_policy == BDEV_NVME_MP_POLICY_ACTIVE_ACTIVE) {
 		/* We come here only if there is no optimized path. Cache even non_optimized
 		 * path for load balance across multiple non_optimized paths.
@@ -975,6 +1028,7 @@ _bdev_nvme_find_io_path_min_qd(struct nvme_bdev_channel *nbdev_ch)
 	struct nvme_io_path *optimized = NULL, *non_optimized = NULL;
 	uint32_t opt_min_qd = UINT32_MAX, non_opt_min_qd = UINT32_MAX;
 	uint32_t num_outstanding_reqs;
+	bool opt_local = false, non_opt_local = false, local;
 
 	STAILQ_FOREACH(io_path, &nbdev_ch->io_path_list, stailq) {
 		if (spdk_unlikely(!nvme_qpair_is_connected(io_path->qpair))) {
@@ -986,17 +1040,25 @@ _bdev_nvme_find_io_path_min_qd(struct nvme_bdev_channel *nbdev_ch)
 			continue;
 		}
 
+		/* Within each ANA state, local paths win over remote ones regardless of their
+		 * queue depth.
+		 */
 		num_outstanding_reqs = spdk_nvme_qpair_get_num_outstanding_reqs(io_path->qpair->qpair);
+		local = io_path->numa_local;
 		switch (io_path->nvme_ns->ana_state) {
 		case SPDK_NVME_ANA_OPTIMIZED_STATE:
-			if (num_outstanding_reqs < opt_min_qd) {
+			if ((local && !opt_local) ||
+			    (local == opt_local && num_outstanding_reqs < opt_min_qd)) {
 				opt_min_qd = num_outstanding_reqs;
+				opt_local = local;
 				optimized = io_path;
 			}
 			break;
 		case SPDK_NVME_ANA_NON_OPTIMIZED_STATE:
-			if (num_outstanding_reqs < non_opt_min_qd) {
+			if ((local && !non_opt_local) ||
+			    (local == non_opt_local && num_outstanding_reqs < non_opt_min_qd)) {
 				non_opt_min_qd = num_outstanding_reqs;
+				non_opt_local = local;
 				non_optimized = io_path;
 			}
 			break;
@@ -1013,6 +1075,77 @@ _bdev_nvme_find_io_path_min_qd(struct nvme_bdev_channel *nbdev_ch)
 	return non_optimized;
 }
 
+/* Every this many I/O, the latency selector sends one I/O to the optimized path it has
+ * the oldest latency sample of, so that paths which got faster are noticed.
+ */
+#define BDEV_NVME_LATENCY_PROBE_INTERVAL	64
+
+static struct nvme_io_path *
+_bdev_nvme_find_io_path_min_latency(struct nvme_bdev_channel *nbdev_ch)
+{
+	struct nvme_io_path *io_path;
+	struct nvme_io_path *optimized = NULL, *non_optimized = NULL, *stalest = NULL;
+	uint64_t opt_min_latency = UINT64_MAX, non_opt_min_latency = UINT64_MAX, latency;
+	bool opt_local = false, non_opt_local = false, stalest_local = false, local, probe;
+
+	probe = ++nbdev_ch->latency_probe_counter >= BDEV_NVME_LATENCY_PROBE_INTERVAL;
+	if (probe) {
+		nbdev_ch->latency_probe_counter = 0;
+	}
+
+	STAILQ_FOREACH(io_path, &nbdev_ch->io_path_list, stailq) {
+		if (spdk_unlikely(!nvme_qpair_is_connected(io_path->qpair))) {
+			continue;
+		}
+
+		if (spdk_unlikely(io_path->nvme_ns->ana_state_updating)) {
+			continue;
+		}
+
+		/* A path without any sample yet is tried first, but only with a single I/O at a
+		 * time, so that a burst doesn't all go to a path which may turn out to be slow.
+		 */
+		latency = io_path->latency_ewma_ticks;
+		if (latency == 0 && spdk_nvme_qpair_get_num_outstanding_reqs(io_path->qpair->qpair) != 0) {
+			latency = UINT64_MAX;
+		}
+
+		local = io_path->numa_local;
+		switch (io_path->nvme_ns->ana_state) {
+		case SPDK_NVME_ANA_OPTIMIZED_STATE:
+			if (optimized == NULL || (local && !opt_local) ||
+			    (local == opt_local && latency < opt_min_latency)) {
+				opt_min_latency = latency;
+				opt_local = local;
+				optimized = io_path;
+			}
+			if (stalest == NULL || (local && !stalest_local) ||
+			    (local == stalest_local &&
+			     io_path->last_completion_tsc < stalest->last_completion_tsc)) {
+				stalest_local = local;
+				stalest = io_path;
+			}
+			break;
+		case SPDK_NVME_ANA_NON_OPTIMIZED_STATE:
+			if (non_optimized == NULL || (local && !non_opt_local) ||
+			    (local == non_opt_local && latency < non_opt_min_latency)) {
+				non_opt_min_latency = latency;
+				non_opt_local = local;
+				non_optimized = io_path;
+			}
+			break;
+		default:
+			break;
+		}
+	}
+
+	if (optimized != NULL) {
+		return probe ? stalest : optimized;
+	}
+
+	return non_optimized;
+}
+
 static inline struct nvme_io_path *
 bdev_nvme_find_io_path(struct nvme_bdev_channel *nbdev_ch)
 {
@@ -1030,6 +1163,8 @@ bdev_nvme_find_io_path(struct nvme_bdev_channel *nbdev_ch)
 	if (nbdev_ch->mp_policy == BDEV_NVME_MP_POLICY_ACTIVE_PASSIVE ||
 	    nbdev_ch->mp_selector == BDEV_NVME_MP_SELECTOR_ROUND_ROBIN) {
 		return _bdev_nvme_find_io_path(nbdev_ch);
+	} else if (nbdev_ch->mp_selector == BDEV_NVME_MP_SELECTOR_LATENCY) {
+		return _bdev_nvme_find_io_path_min_latency(nbdev_ch);
 	} else {
 		return _bdev_nvme_find_io_path_min_qd(nbdev_ch);
 	}
@@ -1065,6 +1200,53 @@ any_io_path_may_become_available(struct nvme_bdev_channel *nbdev_ch)
 	return false;
 }
 
+/* A persistent reservation is held by a host identifier. Hence an I/O can fail over
+ * to another path without reservation conflicts only if both controllers were
+ * connected with the same host identifier.
+ */
+static bool
+nvme_ctrlr_has_same_host_id(struct nvme_ctrlr *nvme_ctrlr1, struct nvme_ctrlr *nvme_ctrlr2)
+{
+	const struct spdk_nvme_ctrlr_opts *opts1, *opts2;
+
+	opts1 = spdk_nvme_ctrlr_get_opts(nvme_ctrlr1->ctrlr);
+	opts2 = spdk_nvme_ctrlr_get_opts(nvme_ctrlr2->ctrlr);
+
+	return memcmp(opts1->host_id, opts2->host_id, sizeof(opts1->host_id)) == 0 &&
+	       memcmp(opts1->extended_host_id, opts2->extended_host_id,
+		      sizeof(opts1->extended_host_id)) == 0;
+}
+
+/* Find an io_path other than the failed one which can take an I/O right now.
+ * An optimized path is preferred to a non-optimized one.
+ */
+static struct nvme_io_path *
+bdev_nvme_find_failover_io_path(struct nvme_bdev_channel *nbdev_ch,
+				struct nvme_io_path *failed_io_path)
+{
+	struct nvme_io_path *io_path, *non_optimized = NULL;
+
+	STAILQ_FOREACH(io_path, &nbdev_ch->io_path_list, stailq) {
+		if (io_path == failed_io_path ||
+		    io_path->nvme_ns->ana_state_updating ||
+		    !nvme_io_path_is_available(io_path) ||
+		    !nvme_ctrlr_is_available(io_path->qpair->ctrlr) ||
+		    !nvme_ctrlr_has_same_host_id(io_path->qpair->ctrlr, failed_io_path->qpair->ctrlr)) {
+			continue;
+		}
+
+		if (io_path->nvme_ns->ana_state == SPDK_NVME_ANA_OPTIMIZED_STATE) {
+			return io_path;
+		}
+
+		if (non_optimized == NULL) {
+			non_optimized = io_path;
+		}
+	}
+
+	return non_optimized;
+}
+
 static void
 bdev_nvme_retry_io(struct nvme_bdev_channel *nbdev_ch, struct spdk_bdev_io *bdev_io)
 {
@@ -1301,6 +1483,55 @@ bdev_nvme_update_io_path_stat(struct nvme_bdev_io *bio)
 	}
 }
 
+/* Weight of a new sample in the latency moving average is 1 / 2^BDEV_NVME_LATENCY_EWMA_SHIFT */
+#define BDEV_NVME_LATENCY_EWMA_SHIFT	3
+
+static inline bool
+bdev_nvme_io_path_tracks_latency(struct nvme_io_path *io_path)
+{
+	return io_path->nbdev_ch != NULL &&
+	       io_path->nbdev_ch->mp_selector == BDEV_NVME_MP_SELECTOR_LATENCY;
+}
+
+/* Called right before a read or write is submitted to the qpair of its path */
+static inline void
+bdev_nvme_set_qpair_submit_tsc(struct nvme_bdev_io *bio)
+{
+	if (bdev_nvme_io_path_tracks_latency(bio->io_path)) {
+		bio->qpair_submit_tsc = spdk_get_ticks();
+	}
+}
+
+static inline void
+bdev_nvme_update_io_path_latency(struct nvme_bdev_io *bio)
+{
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(bio);
+	struct nvme_io_path *io_path = bio->io_path;
+	uint64_t now, tsc_diff;
+
+	if (!bdev_nvme_io_path_tracks_latency(io_path)) {
+		return;
+	}
+
+	/* Only reads and writes take their timestamp when they are submitted to the qpair, so
+	 * that the time spent waiting for a buffer or for a retry isn't accounted.
+	 */
+	if (bdev_io->type != SPDK_BDEV_IO_TYPE_READ && bdev_io->type != SPDK_BDEV_IO_TYPE_WRITE) {
+		return;
+	}
+
+	now = spdk_get_ticks();
+	tsc_diff = spdk_max(now - bio->qpair_submit_tsc, 1);
+
+	if (io_path->latency_ewma_ticks == 0) {
+		io_path->latency_ewma_ticks = tsc_diff;
+	} else {
+		io_path->latency_ewma_ticks -= io_path->latency_ewma_ticks >> BDEV_NVME_LATENCY_EWMA_SHIFT;
+		io_path->latency_ewma_ticks += tsc_diff >> BDEV_NVME_LATENCY_EWMA_SHIFT;
+	}
+	io_path->last_completion_tsc = now;
+}
+
 static bool
 bdev_nvme_check_retry_io(struct nvme_bdev_io *bio,
 			 const struct spdk_nvme_cpl *cpl,
@@ -1353,6 +1584,7 @@ bdev_nvme_io_complete_nvme_status(struct nvme_bdev_io *bio,
 
 	if (spdk_likely(spdk_nvme_cpl_is_success(cpl))) {
 		bdev_nvme_update_io_path_stat(bio);
+		bdev_nvme_update_io_path_latency(bio);
 		goto complete;
 	}
 
@@ -1391,6 +1623,7 @@ bdev_nvme_io_complete(struct nvme_bdev_io *bio, int rc)
 {
 	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(bio);
 	struct nvme_bdev_channel *nbdev_ch;
+	struct nvme_io_path *failover_io_path;
 	enum spdk_bdev_io_status io_status;
 
 	assert(!bdev_nvme_io_type_is_admin(bdev_io->type));
@@ -1407,6 +1640,23 @@ bdev_nvme_io_complete(struct nvme_bdev_io *bio, int rc)
 			nbdev_ch = spdk_io_channel_get_ctx(spdk_bdev_io_get_io_channel(bdev_io));
 
 			bdev_nvme_clear_current_io_path(nbdev_ch);
+
+			/* The qpair failed while the I/O was submitted to it. If fast failover is
+			 * enabled and another path is usable now, switch the cache to it and retry
+			 * there immediately instead of waiting for the failed path to recover.
+			 * The retry counts, so that paths failing in turn cannot loop forever.
+			 */
+			if (g_opts.fast_failover && bio->io_path != NULL) {
+				failover_io_path = bdev_nvme_find_failover_io_path(nbdev_ch, bio->io_path);
+				if (failover_io_path != NULL) {
+					nbdev_ch->current_io_path = failover_io_path;
+					bio->io_path = failover_io_path;
+					bio->retry_count++;
+					bdev_nvme_queue_retry_io(nbdev_ch, bio, 0);
+					return;
+				}
+			}
+
 			bio->io_path = NULL;
 
 			if (any_io_path_may_become_available(nbdev_ch)) {
@@ -1612,6 +1862,15 @@ bdev_nvme_poll(void *arg)
 
 	num_completions = spdk_nvme_poll_group_process_completions(group->group, 0,
 			  bdev_nvme_disconnected_qpair_cb);
+
+	if (group->submit_batch) {
+		/* Flush everything submitted since the last poll, including the I/O
+		 * resubmitted from the completion callbacks above, and start a new batch.
+		 */
+		spdk_nvme_poll_group_submit_batch_end(group->group);
+		spdk_nvme_poll_group_submit_batch_begin(group->group);
+	}
+
 	if (group->collect_spin_stat) {
 		if (num_completions > 0) {
 			if (group->end_ticks != 0) {
@@ -1631,6 +1890,20 @@ bdev_nvme_poll(void *arg)
 	return num_completions > 0 ? SPDK_POLLER_BUSY : SPDK_POLLER_IDLE;
 }
 
+static int
+bdev_nvme_poll_group_interrupt(void *arg)
+{
+	struct nvme_poll_group *group = arg;
+	int64_t num_completions;
+
+	num_completions = spdk_nvme_poll_group_wait(group->group, bdev_nvme_disconnected_qpair_cb);
+	if (spdk_unlikely(num_completions < 0)) {
+		bdev_nvme_check_io_qpairs(group);
+	}
+
+	return num_completions > 0 ? SPDK_POLLER_BUSY : SPDK_POLLER_IDLE;
+}
+
 static int bdev_nvme_poll_adminq(void *arg);
 
 static void
@@ -1716,6 +1989,11 @@ bdev_nvme_destruct(void *ctx)
 	return 0;
 }
 
+/* Requests each I/O qpair preallocates when the poll group has a shared pool
+ * and io_queue_requests is not set.
+ */
+#define BDEV_NVME_SHARED_POOL_QPAIR_REQUESTS	32
+
 static int
 bdev_nvme_create_qpair(struct nvme_qpair *nvme_qpair)
 {
@@ -1730,8 +2008,14 @@ bdev_nvme_create_qpair(struct nvme_qpair *nvme_qpair)
 	opts.delay_cmd_submit = g_opts.delay_cmd_submit;
 	opts.create_only = true;
 	opts.async_mode = true;
-	opts.io_queue_requests = spdk_max(g_opts.io_queue_requests, opts.io_queue_requests);
-	g_opts.io_queue_requests = opts.io_queue_requests;
+	if (g_opts.poll_group_requests != 0) {
+		/* Requests beyond this floor are borrowed from the poll group's shared pool. */
+		opts.io_queue_requests = g_opts.io_queue_requests != 0 ? g_opts.io_queue_requests :
+					 BDEV_NVME_SHARED_POOL_QPAIR_REQUESTS;
+	} else {
+		opts.io_queue_requests = spdk_max(g_opts.io_queue_requests, opts.io_queue_requests);
+		g_opts.io_queue_requests = opts.io_queue_requests;
+	}
 
 	qpair = spdk_nvme_ctrlr_alloc_io_qpair(nvme_ctrlr->ctrlr, &opts, sizeof(opts));
 	if (qpair == NULL) {
@@ -2951,7 +3235,8 @@ _bdev_nvme_submit_request(struct nvme_bdev_channel *nbdev_ch, struct spdk_bdev_i
 				      bdev->dif_check_flags,
 				      bdev_io->u.bdev.memory_domain,
 				      bdev_io->u.bdev.memory_domain_ctx,
-				      bdev_io->u.bdev.accel_sequence);
+				      bdev_io->u.bdev.accel_sequence,
+				      bdev_io->u.bdev.placement_hint);
 		break;
 	case SPDK_BDEV_IO_TYPE_COMPARE:
 		rc = bdev_nvme_comparev(nbdev_io,
@@ -3179,6 +3464,12 @@ nvme_qpair_create(struct nvme_ctrlr *nvme_ctrlr, struct nvme_ctrlr_channel *ctrl
 	nvme_qpair->ctrlr = nvme_ctrlr;
 	nvme_qpair->ctrlr_ch = ctrlr_ch;
 
+	if (!nvme_ctrlr_is_numa_local(nvme_ctrlr)) {
+		SPDK_DEBUGLOG(bdev_nvme, "I/O qpair of %s is polled on core %u, remote to NUMA node %d\n",
+			      nvme_ctrlr->nbdev_ctrlr->name, spdk_env_get_current_core(),
+			      spdk_nvme_ctrlr_get_numa_id(nvme_ctrlr->ctrlr));
+	}
+
 	pg_ch = spdk_get_io_channel(&g_nvme_bdev_ctrlrs);
 	if (!pg_ch) {
 		free(nvme_qpair);
@@ -3382,6 +3673,7 @@ static int
 bdev_nvme_create_poll_group_cb(void *io_device, void *ctx_buf)
 {
 	struct nvme_poll_group *group = ctx_buf;
+	int fd, rc;
 
 	TAILQ_INIT(&group->qpair_list);
 
@@ -3390,6 +3682,32 @@ bdev_nvme_create_poll_group_cb(void *io_device, void *ctx_buf)
 		return -1;
 	}
 
+	if (g_opts.poll_group_requests != 0) {
+		rc = spdk_nvme_poll_group_set_shared_requests(group->group, g_opts.poll_group_requests);
+		if (rc != 0) {
+			SPDK_ERRLOG("Failed to create a shared request pool: %s\n", spdk_strerror(-rc));
+			spdk_nvme_poll_group_destroy(group->group);
+			return -1;
+		}
+	}
+
+	if (spdk_interrupt_mode_is_enabled()) {
+		fd = spdk_nvme_poll_group_get_fd(group->group);
+		if (fd >= 0) {
+			group->intr = SPDK_INTERRUPT_REGISTER(fd, bdev_nvme_poll_group_interrupt, group);
+			if (group->intr == NULL) {
+				spdk_nvme_poll_group_destroy(group->group);
+				return -1;
+			}
+
+			return 0;
+		}
+
+		/* E.g. no fd groups on this platform, keep polling the group */
+		SPDK_NOTICELOG("Poll group %p has no interrupt fd, polling it instead: %s\n",
+			       group, spdk_strerror(-fd));
+	}
+
 	group->poller = SPDK_POLLER_REGISTER(bdev_nvme_poll, group, g_opts.nvme_ioq_poll_period_us);
 
 	if (group->poller == NULL) {
@@ -3397,6 +3715,11 @@ bdev_nvme_create_poll_group_cb(void *io_device, void *ctx_buf)
 		return -1;
 	}
 
+	if (g_opts.poll_group_submit_batch) {
+		spdk_nvme_poll_group_submit_batch_begin(group->group);
+		group->submit_batch = true;
+	}
+
 	return 0;
 }
 
@@ -3412,6 +3735,7 @@ bdev_nvme_destroy_poll_group_cb(void *io_device, void *ctx_buf)
 	}
 
 	spdk_poller_unregister(&group->poller);
+	spdk_interrupt_unregister(&group->intr);
 	if (spdk_nvme_poll_group_destroy(group->group)) {
 		SPDK_ERRLOG("Unable to destroy a poll group for the NVMe bdev module.\n");
 		assert(false);
@@ -3555,6 +3879,10 @@ nvme_ctrlr_info_json(struct spdk_json_write_ctx *w, struct nvme_ctrlr *nvme_ctrl
 	cdata = spdk_nvme_ctrlr_get_data(nvme_ctrlr->ctrlr);
 	spdk_json_write_named_uint16(w, "cntlid", cdata->cntlid);
 
+	if (spdk_nvme_ctrlr_get_numa_id(nvme_ctrlr->ctrlr) != SPDK_ENV_SOCKET_ID_ANY) {
+		spdk_json_write_named_int32(w, "numa_id", spdk_nvme_ctrlr_get_numa_id(nvme_ctrlr->ctrlr));
+	}
+
 	opts = spdk_nvme_ctrlr_get_opts(nvme_ctrlr->ctrlr);
 	spdk_json_write_named_object_begin(w, "host");
 	spdk_json_write_named_string(w, "nqn", opts->hostnqn);
@@ -3667,6 +3995,10 @@ nvme_namespace_info_json(struct spdk_json_write_ctx *w,
 
 	spdk_json_write_named_bool(w, "can_share", nsdata->nmic.can_share);
 
+	if (spdk_nvme_ns_get_num_placement_ids(ns) != 0) {
+		spdk_json_write_named_uint32(w, "fdp_placement_ids", spdk_nvme_ns_get_num_placement_ids(ns));
+	}
+
 	spdk_json_write_object_end(w);
 
 	if (cdata->oacs.security) {
@@ -4045,6 +4377,11 @@ nvme_disk_create(struct spdk_bdev *disk, const char *base_name,
 	}
 	disk->optimal_io_boundary = spdk_nvme_ns_get_optimal_io_boundary(ns);
 
+	if (spdk_nvme_ctrlr_get_numa_id(ctrlr) != SPDK_ENV_SOCKET_ID_ANY) {
+		disk->numa.id_valid = true;
+		disk->numa.id = spdk_nvme_ctrlr_get_numa_id(ctrlr);
+	}
+
 	nguid = spdk_nvme_ns_get_nguid(ns);
 	if (!nguid) {
 		uuid = spdk_nvme_ns_get_uuid(ns);
@@ -4226,6 +4563,7 @@ hotplug_probe_cb(void *cb_ctx, const struct spdk_nvme_transport_id *trid,
 	opts->medium_priority_weight = (uint8_t)g_opts.medium_priority_weight;
 	opts->high_priority_weight = (uint8_t)g_opts.high_priority_weight;
 	opts->disable_read_ana_log_page = true;
+	opts->enable_interrupts = spdk_interrupt_mode_is_enabled();
 
 	SPDK_DEBUGLOG(bdev_nvme, "Attaching to %s\n", trid->traddr);
 
@@ -4455,18 +4793,149 @@ nvme_bdev_add_ns(struct nvme_bdev *bdev, struct nvme_ns *nvme_ns)
 	return 0;
 }
 
+static void
+nvme_ns_populate_bdev(struct nvme_ns *nvme_ns)
+{
+	struct nvme_ctrlr *nvme_ctrlr = nvme_ns->ctrlr;
+	struct nvme_bdev *bdev;
+	int rc;
+
+	bdev = nvme_bdev_ctrlr_get_bdev(nvme_ctrlr->nbdev_ctrlr, nvme_ns->id);
+	if (bdev == NULL) {
+		rc = nvme_bdev_create(nvme_ctrlr, nvme_ns);
+	} else {
+		rc = nvme_bdev_add_ns(bdev, nvme_ns);
+		if (rc == 0) {
+			return;
+		}
+	}
+
+	nvme_ctrlr_populate_namespace_done(nvme_ns, rc);
+}
+
+struct nvme_ns_placement_ids_ctx {
+	struct nvme_ns		*nvme_ns;
+	struct spdk_nvme_qpair	*qpair;
+	struct spdk_poller	*poller;
+	uint64_t		timeout_tick;
+	bool			done;
+	int			rc;
+};
+
+static void
+nvme_ns_update_placement_ids_done(void *cb_arg, int rc)
+{
+	struct nvme_ns_placement_ids_ctx *ctx = cb_arg;
+
+	if (!ctx->done) {
+		ctx->done = true;
+		ctx->rc = rc;
+	}
+}
+
+static void
+nvme_ns_update_placement_ids_finish(struct nvme_ns_placement_ids_ctx *ctx)
+{
+	struct nvme_ns *nvme_ns = ctx->nvme_ns;
+
+	spdk_poller_unregister(&ctx->poller);
+	/* Aborts the commands still outstanding after a timeout */
+	spdk_nvme_ctrlr_free_io_qpair(ctx->qpair);
+
+	if (ctx->rc != 0) {
+		/* Without placement identifiers, placement hints of writes are ignored. */
+		SPDK_NOTICELOG("Failed to get FDP placement ids of NS %u, rc %d\n", nvme_ns->id, ctx->rc);
+	}
+	free(ctx);
+
+	nvme_ns_populate_bdev(nvme_ns);
+}
+
+static int
+nvme_ns_update_placement_ids_poll(void *arg)
+{
+	struct nvme_ns_placement_ids_ctx *ctx = arg;
+	int32_t num_completions;
+
+	/* This also connects the qpair */
+	num_completions = spdk_nvme_qpair_process_completions(ctx->qpair, 0);
+	if (num_completions < 0) {
+		nvme_ns_update_placement_ids_done(ctx, num_completions);
+	} else if (spdk_get_ticks() > ctx->timeout_tick) {
+		nvme_ns_update_placement_ids_done(ctx, -ETIMEDOUT);
+	}
+
+	if (ctx->done) {
+		nvme_ns_update_placement_ids_finish(ctx);
+	}
+
+	return num_completions > 0 ? SPDK_POLLER_BUSY : SPDK_POLLER_IDLE;
+}
+
+/* bdev_nvme has no I/O qpair of its own before channels are created, so get the placement
+ * identifiers on a short-lived qpair, connected and polled without blocking the thread.
+ */
+static void
+nvme_ns_update_placement_ids(struct nvme_ns *nvme_ns)
+{
+	struct spdk_nvme_ctrlr *ctrlr = nvme_ns->ctrlr->ctrlr;
+	struct nvme_ns_placement_ids_ctx *ctx;
+	struct spdk_nvme_io_qpair_opts opts;
+	int rc;
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		rc = -ENOMEM;
+		goto err;
+	}
+	ctx->nvme_ns = nvme_ns;
+
+	spdk_nvme_ctrlr_get_default_io_qpair_opts(ctrlr, &opts, sizeof(opts));
+	opts.async_mode = true;
+	ctx->qpair = spdk_nvme_ctrlr_alloc_io_qpair(ctrlr, &opts, sizeof(opts));
+	if (ctx->qpair == NULL) {
+		rc = -ENXIO;
+		goto err;
+	}
+
+	ctx->poller = SPDK_POLLER_REGISTER(nvme_ns_update_placement_ids_poll, ctx, 0);
+	if (ctx->poller == NULL) {
+		rc = -ENOMEM;
+		goto err;
+	}
+
+	/* Submitted once the qpair is connected */
+	ctx->timeout_tick = spdk_get_ticks() + spdk_nvme_ctrlr_get_opts(ctrlr)->admin_timeout_ms *
+			    spdk_get_ticks_hz() / 1000ULL;
+	rc = spdk_nvme_ns_update_placement_ids(nvme_ns->ns, ctx->qpair,
+					       nvme_ns_update_placement_ids_done, ctx);
+	if (rc != 0) {
+		goto err;
+	}
+
+	return;
+err:
+	if (ctx != NULL) {
+		spdk_poller_unregister(&ctx->poller);
+		if (ctx->qpair != NULL) {
+			spdk_nvme_ctrlr_free_io_qpair(ctx->qpair);
+		}
+		free(ctx);
+	}
+	SPDK_NOTICELOG("Failed to get FDP placement ids of NS %u, rc %d\n", nvme_ns->id, rc);
+	nvme_ns_populate_bdev(nvme_ns);
+}
+
 static void
 nvme_ctrlr_populate_namespace(struct nvme_ctrlr *nvme_ctrlr, struct nvme_ns *nvme_ns)
 {
 	struct spdk_nvme_ns	*ns;
-	struct nvme_bdev	*bdev;
-	int			rc = 0;
 
 	ns = spdk_nvme_ctrlr_get_ns(nvme_ctrlr->ctrlr, nvme_ns->id);
 	if (!ns) {
 		SPDK_DEBUGLOG(bdev_nvme, "Invalid NS %d\n", nvme_ns->id);
-		rc = -EINVAL;
-		goto done;
+		nvme_ctrlr_populate_namespace_done(nvme_ns, -EINVAL);
+		return;
 	}
 
 	nvme_ns->ns = ns;
@@ -4476,17 +4945,11 @@ nvme_ctrlr_populate_namespace(struct nvme_ctrlr *nvme_ctrlr, struct nvme_ns *nvm
 		bdev_nvme_parse_ana_log_page(nvme_ctrlr, nvme_ns_set_ana_state, nvme_ns);
 	}
 
-	bdev = nvme_bdev_ctrlr_get_bdev(nvme_ctrlr->nbdev_ctrlr, nvme_ns->id);
-	if (bdev == NULL) {
-		rc = nvme_bdev_create(nvme_ctrlr, nvme_ns);
+	if (spdk_nvme_ctrlr_get_data(nvme_ctrlr->ctrlr)->ctratt.fdps) {
+		nvme_ns_update_placement_ids(nvme_ns);
 	} else {
-		rc = nvme_bdev_add_ns(bdev, nvme_ns);
-		if (rc == 0) {
-			return;
-		}
+		nvme_ns_populate_bdev(nvme_ns);
 	}
-done:
-	nvme_ctrlr_populate_namespace_done(nvme_ns, rc);
 }
 
 static void
@@ -4991,6 +5454,7 @@ _bdev_nvme_set_multipath_policy(struct spdk_io_channel_iter *i)
 	nbdev_ch->mp_policy = nbdev->mp_policy;
 	nbdev_ch->mp_selector = nbdev->mp_selector;
 	nbdev_ch->rr_min_io = nbdev->rr_min_io;
+	nbdev_ch->latency_probe_counter = 0;
 	bdev_nvme_clear_current_io_path(nbdev_ch);
 
 	spdk_for_each_channel_continue(i, 0);
@@ -5973,6 +6437,8 @@ bdev_nvme_create(struct spdk_nvme_transport_id *trid,
 	ctx->drv_opts.keep_alive_timeout_ms = g_opts.keep_alive_timeout_ms;
 	ctx->drv_opts.disable_read_ana_log_page = true;
 	ctx->drv_opts.transport_tos = g_opts.transport_tos;
+	/* Cleared by the driver for the controllers that can't provide interrupts */
+	ctx->drv_opts.enable_interrupts = spdk_interrupt_mode_is_enabled();
 
 	if (nvme_bdev_ctrlr_get_by_name(base_name) == NULL || multipath) {
 		attach_cb = connect_attach_cb;
@@ -7494,6 +7960,8 @@ bdev_nvme_readv(struct nvme_bdev_io *bio, struct iovec *iov, int iovcnt,
 	bio->iovpos = 0;
 	bio->iov_offset = 0;
 
+	bdev_nvme_set_qpair_submit_tsc(bio);
+
 	if (domain != NULL || seq != NULL) {
 		bio->ext_opts.size = SPDK_SIZEOF(&bio->ext_opts, accel_sequence);
 		bio->ext_opts.memory_domain = domain;
@@ -7528,10 +7996,12 @@ static int
 bdev_nvme_writev(struct nvme_bdev_io *bio, struct iovec *iov, int iovcnt,
 		 void *md, uint64_t lba_count, uint64_t lba, uint32_t flags,
 		 struct spdk_memory_domain *domain, void *domain_ctx,
-		 struct spdk_accel_sequence *seq)
+		 struct spdk_accel_sequence *seq, uint16_t placement_hint)
 {
 	struct spdk_nvme_ns *ns = bio->io_path->nvme_ns->ns;
 	struct spdk_nvme_qpair *qpair = bio->io_path->qpair->qpair;
+	uint16_t num_pids;
+	uint32_t cdw13 = 0;
 	int rc;
 
 	SPDK_DEBUGLOG(bdev_nvme, "write %" PRIu64 " blocks with offset %#" PRIx64 "\n",
@@ -7542,12 +8012,26 @@ bdev_nvme_writev(struct nvme_bdev_io *bio, struct iovec *iov, int iovcnt,
 	bio->iovpos = 0;
 	bio->iov_offset = 0;
 
-	if (domain != NULL || seq != NULL) {
+	/* Map the placement hint onto one of the FDP placement identifiers of the namespace.
+	 * Hints are opaque to us, so spread them over the available identifiers.
+	 */
+	num_pids = spdk_nvme_ns_get_num_placement_ids(ns);
+	if (placement_hint != 0 && num_pids != 0) {
+		flags |= SPDK_NVME_IO_FLAGS_DATA_PLACEMENT_DIRECTIVE;
+		cdw13 = (uint32_t)spdk_nvme_ns_get_placement_id(ns, (placement_hint - 1) % num_pids) << 16;
+	}
+
+	bdev_nvme_set_qpair_submit_tsc(bio);
+
+	if (domain != NULL || seq != NULL || (flags & SPDK_NVME_IO_FLAGS_DATA_PLACEMENT_DIRECTIVE)) {
 		bio->ext_opts.size = SPDK_SIZEOF(&bio->ext_opts, accel_sequence);
 		bio->ext_opts.memory_domain = domain;
 		bio->ext_opts.memory_domain_ctx = domain_ctx;
 		bio->ext_opts.io_flags = flags;
 		bio->ext_opts.metadata = md;
+		bio->ext_opts.apptag_mask = 0;
+		bio->ext_opts.apptag = 0;
+		bio->ext_opts.cdw13 = cdw13;
 		bio->ext_opts.accel_sequence = seq;
 
 		rc = spdk_nvme_ns_cmd_writev_ext(ns, qpair, lba, lba_count,
@@ -8040,6 +8524,10 @@ bdev_nvme_opts_config_json(struct spdk_json_write_ctx *w)
 	spdk_json_write_named_uint8(w, "transport_tos", g_opts.transport_tos);
 	spdk_json_write_named_bool(w, "io_path_stat", g_opts.io_path_stat);
 	spdk_json_write_named_bool(w, "allow_accel_sequence", g_opts.allow_accel_sequence);
+	spdk_json_write_named_bool(w, "prefer_numa_local_path", g_opts.prefer_numa_local_path);
+	spdk_json_write_named_uint32(w, "poll_group_requests", g_opts.poll_group_requests);
+	spdk_json_write_named_bool(w, "poll_group_submit_batch", g_opts.poll_group_submit_batch);
+	spdk_json_write_named_bool(w, "fast_failover", g_opts.fast_failover);
 	spdk_json_write_object_end(w);
 
 	spdk_json_write_object_end(w);
@@ -8233,6 +8721,10 @@ nvme_io_path_info_json(struct spdk_json_write_ctx *w, struct nvme_io_path *io_pa
 				   io_path == io_path->nbdev_ch->current_io_path);
 	spdk_json_write_named_bool(w, "connected", nvme_qpair_is_connected(io_path->qpair));
 	spdk_json_write_named_bool(w, "accessible", nvme_ns_is_accessible(nvme_ns));
+	if (io_path->latency_ewma_ticks != 0) {
+		spdk_json_write_named_uint64(w, "latency_ewma_us",
+					     io_path->latency_ewma_ticks * SPDK_SEC_TO_USEC / spdk_get_ticks_hz());
+	}
 
 	spdk_json_write_named_object_begin(w, "transport");
 	spdk_json_write_named_string(w, "trtype", trid->trstring);
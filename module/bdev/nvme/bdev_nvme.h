@@ -31,6 +31,7 @@ enum bdev_nvme_multipath_policy {
 enum bdev_nvme_multipath_selector {
 	BDEV_NVME_MP_SELECTOR_ROUND_ROBIN = 1,
 	BDEV_NVME_MP_SELECTOR_QUEUE_DEPTH,
+	BDEV_NVME_MP_SELECTOR_LATENCY,
 };
 
 typedef void (*spdk_bdev_create_nvme_fn)(void *ctx, size_t bdev_count, int rc);
@@ -210,6 +211,15 @@ struct nvme_io_path {
 	struct nvme_qpair		*qpair;
 	STAILQ_ENTRY(nvme_io_path)	stailq;
 
+	/* True if the controller of the path is on the NUMA node of the channel's thread. */
+	bool				numa_local;
+
+	/* Used by the latency selector: moving average of the I/O latency on this path,
+	 * 0 until the first completion, and time of the last completion.
+	 */
+	uint64_t			latency_ewma_ticks;
+	uint64_t			last_completion_tsc;
+
 	/* The following are used to update io_path cache of the nvme_bdev_channel. */
 	struct nvme_bdev_channel	*nbdev_ch;
 	TAILQ_ENTRY(nvme_io_path)	tailq;
@@ -224,6 +234,7 @@ struct nvme_bdev_channel {
 	enum bdev_nvme_multipath_selector	mp_selector;
 	uint32_t				rr_min_io;
 	uint32_t				rr_counter;
+	uint32_t				latency_probe_counter;
 	STAILQ_HEAD(, nvme_io_path)		io_path_list;
 	TAILQ_HEAD(retry_io_head, spdk_bdev_io)	retry_io_list;
 	struct spdk_poller			*retry_io_poller;
@@ -233,10 +244,12 @@ struct nvme_poll_group {
 	struct spdk_nvme_poll_group		*group;
 	struct spdk_io_channel			*accel_channel;
 	struct spdk_poller			*poller;
+	struct spdk_interrupt			*intr;
 	bool					collect_spin_stat;
 	uint64_t				spin_ticks;
 	uint64_t				start_ticks;
 	uint64_t				end_ticks;
+	bool					submit_batch;
 	TAILQ_HEAD(, nvme_qpair)		qpair_list;
 };
 
@@ -298,6 +311,14 @@ struct spdk_bdev_nvme_opts {
 	bool io_path_stat;
 	bool allow_accel_sequence;
 	uint32_t rdma_max_cq_size;
+	/* Prefer multipath I/O paths on the NUMA node of the submitting thread. */
+	bool prefer_numa_local_path;
+	/* Size of the NVMe request pool shared by the I/O qpairs of each poll group. 0 disables it. */
+	uint32_t poll_group_requests;
+	/* Ring the doorbells of all the I/O qpairs of a poll group once per poll. */
+	bool poll_group_submit_batch;
+	/* Retry an I/O which failed to submit to a failed qpair on another path immediately. */
+	bool fast_failover;
 };
 
 struct spdk_nvme_qpair *bdev_nvme_get_io_qpair(struct spdk_io_channel *ctrlr_io_ch);
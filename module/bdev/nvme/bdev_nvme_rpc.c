@@ -72,6 +72,10 @@ static const struct spdk_json_object_decoder rpc_bdev_nvme_options_decoders[] =
 	{"io_path_stat", offsetof(struct spdk_bdev_nvme_opts, io_path_stat), spdk_json_decode_bool, true},
 	{"allow_accel_sequence", offsetof(struct spdk_bdev_nvme_opts, allow_accel_sequence), spdk_json_decode_bool, true},
 	{"rdma_max_cq_size", offsetof(struct spdk_bdev_nvme_opts, rdma_max_cq_size), spdk_json_decode_uint32, true},
+	{"prefer_numa_local_path", offsetof(struct spdk_bdev_nvme_opts, prefer_numa_local_path), spdk_json_decode_bool, true},
+	{"poll_group_requests", offsetof(struct spdk_bdev_nvme_opts, poll_group_requests), spdk_json_decode_uint32, true},
+	{"poll_group_submit_batch", offsetof(struct spdk_bdev_nvme_opts, poll_group_submit_batch), spdk_json_decode_bool, true},
+	{"fast_failover", offsetof(struct spdk_bdev_nvme_opts, fast_failover), spdk_json_decode_bool, true},
 };
 
 static void
@@ -2291,6 +2295,8 @@ rpc_decode_mp_selector(const struct spdk_json_val *val, void *out)
 		*selector = BDEV_NVME_MP_SELECTOR_ROUND_ROBIN;
 	} else if (spdk_json_strequal(val, "queue_depth") == true) {
 		*selector = BDEV_NVME_MP_SELECTOR_QUEUE_DEPTH;
+	} else if (spdk_json_strequal(val, "latency") == true) {
+		*selector = BDEV_NVME_MP_SELECTOR_LATENCY;
 	} else {
 		SPDK_NOTICELOG("Invalid parameter value: selector\n");
 		return -EINVAL;
@@ -188,6 +188,20 @@ _pt_complete_zcopy_io(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
 	spdk_bdev_free_io(bdev_io);
 }
 
+static void
+_pt_complete_seek_io(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct spdk_bdev_io *orig_io = cb_arg;
+	int status = success ? SPDK_BDEV_IO_STATUS_SUCCESS : SPDK_BDEV_IO_STATUS_FAILED;
+
+	/* The passthru bdev maps its blocks 1:1 to the base bdev, so the offset of the next
+	 * data/hole found by the base bdev can be returned as is.
+	 */
+	orig_io->u.bdev.seek.offset = spdk_bdev_io_get_seek_offset(bdev_io);
+	spdk_bdev_io_complete(orig_io, status);
+	spdk_bdev_free_io(bdev_io);
+}
+
 static void
 vbdev_passthru_resubmit_io(void *arg)
 {
@@ -224,6 +238,9 @@ pt_init_ext_io_opts(struct spdk_bdev_io *bdev_io, struct spdk_bdev_ext_io_opts *
 	opts->memory_domain = bdev_io->u.bdev.memory_domain;
 	opts->memory_domain_ctx = bdev_io->u.bdev.memory_domain_ctx;
 	opts->metadata = bdev_io->u.bdev.md_buf;
+	if (bdev_io->type == SPDK_BDEV_IO_TYPE_WRITE) {
+		opts->placement_hint = bdev_io->u.bdev.placement_hint;
+	}
 }
 
 /* Callback for getting a buf from the bdev pool in the event that the caller passed
@@ -333,6 +350,16 @@ vbdev_passthru_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *b
 					   bdev_io->u.bdev.num_blocks,
 					   _pt_complete_io, bdev_io);
 		break;
+	case SPDK_BDEV_IO_TYPE_SEEK_DATA:
+		rc = spdk_bdev_seek_data(pt_node->base_desc, pt_ch->base_ch,
+					 bdev_io->u.bdev.offset_blocks,
+					 _pt_complete_seek_io, bdev_io);
+		break;
+	case SPDK_BDEV_IO_TYPE_SEEK_HOLE:
+		rc = spdk_bdev_seek_hole(pt_node->base_desc, pt_ch->base_ch,
+					 bdev_io->u.bdev.offset_blocks,
+					 _pt_complete_seek_io, bdev_io);
+		break;
 	default:
 		SPDK_ERRLOG("passthru: unknown I/O type %d\n", bdev_io->type);
 		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
@@ -0,0 +1,1136 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 the SPDK authors.
+ *   All rights reserved.
+ */
+
+/*
+ * A virtual block device that keeps recently read blocks of its base bdev in
+ * memory. Each thread owns a shard of the cache, so looking up and filling
+ * lines never takes a lock. Writes to the base bdev are seen by all shards
+ * through a table of write generations shared by the shards: a cached line is
+ * only used as long as the generation it was filled with is still current.
+ *
+ * Lines are evicted using a segmented LRU. Newly filled lines are put on the
+ * probation list and are only moved to the protected list when they're hit, so
+ * a scan of the base bdev can only evict lines that were never read twice.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "vbdev_read_cache.h"
+#include "spdk/env.h"
+#include "spdk/likely.h"
+#include "spdk/string.h"
+#include "spdk/thread.h"
+#include "spdk/util.h"
+
+#include "spdk/bdev_module.h"
+#include "spdk/log.h"
+
+/* This namespace UUID was generated using uuid_generate() method. */
+#define BDEV_READ_CACHE_NAMESPACE_UUID "0c9e3b5a-4f06-4e57-9a35-8d1b6f1f2a63"
+
+#define READ_CACHE_DEFAULT_LINE_SIZE_KB	64
+#define READ_CACHE_MAX_LINE_SIZE_KB	1024
+/* Share of the lines of a shard that may be held by lines hit more than once */
+#define READ_CACHE_PROTECTED_PERCENT	80
+#define READ_CACHE_MIN_GENERATIONS	1024
+#define READ_CACHE_MAX_GENERATIONS	(1u << 22)
+#define READ_CACHE_BUF_ALIGN		0x1000
+
+static int vbdev_read_cache_init(void);
+static int vbdev_read_cache_get_ctx_size(void);
+static void vbdev_read_cache_examine(struct spdk_bdev *bdev);
+static void vbdev_read_cache_finish(void);
+static int vbdev_read_cache_config_json(struct spdk_json_write_ctx *w);
+
+static struct spdk_bdev_module read_cache_if = {
+	.name = "read_cache",
+	.module_init = vbdev_read_cache_init,
+	.get_ctx_size = vbdev_read_cache_get_ctx_size,
+	.examine_config = vbdev_read_cache_examine,
+	.module_fini = vbdev_read_cache_finish,
+	.config_json = vbdev_read_cache_config_json
+};
+
+SPDK_BDEV_MODULE_REGISTER(read_cache, &read_cache_if)
+
+/* Associative list to be used in examine */
+struct bdev_association {
+	char			*vbdev_name;
+	char			*bdev_name;
+	struct spdk_uuid	uuid;
+	uint64_t		cache_size_mb;
+	uint32_t		line_size_kb;
+	TAILQ_ENTRY(bdev_association)	link;
+};
+static TAILQ_HEAD(, bdev_association) g_bdev_associations = TAILQ_HEAD_INITIALIZER(
+			g_bdev_associations);
+
+struct vbdev_read_cache {
+	struct spdk_bdev		*base_bdev; /* the thing we're attaching to */
+	struct spdk_bdev_desc		*base_desc; /* its descriptor we get from open */
+	struct spdk_bdev		cache_bdev; /* the read cache virtual bdev */
+	uint64_t			cache_size_mb;
+	uint32_t			line_size_kb;
+	uint32_t			line_blocks; /* number of blocks in a line */
+	uint32_t			line_stride; /* distance between line buffers in bytes */
+	uint32_t			shard_lines; /* number of lines in each shard */
+
+	/* Write generations shared by all shards, indexed by line number & generation_mask.
+	 * A write increments the generations of the lines it covers both when it's
+	 * submitted and when it completes. Writes covering more lines than there are
+	 * generations increment the epoch instead. */
+	uint32_t			*generations;
+	uint32_t			generation_mask;
+	uint32_t			epoch;
+
+	TAILQ_ENTRY(vbdev_read_cache)	link;
+	struct spdk_thread		*thread;    /* thread where base device is opened */
+};
+static TAILQ_HEAD(, vbdev_read_cache) g_read_cache_nodes = TAILQ_HEAD_INITIALIZER(
+			g_read_cache_nodes);
+
+struct read_cache_line {
+	uint64_t			index;      /* line number within the bdev */
+	uint32_t			generation; /* generation the line was filled with */
+	uint32_t			epoch;      /* epoch the line was filled in */
+	bool				protected;
+	void				*buf;
+	TAILQ_ENTRY(read_cache_line)	lru_link;
+	LIST_ENTRY(read_cache_line)	hash_link;
+};
+
+LIST_HEAD(read_cache_hash_head, read_cache_line);
+
+/* The channel is the shard of the cache owned by a thread. */
+struct read_cache_io_channel {
+	struct spdk_io_channel		*base_ch; /* IO channel of base device */
+	struct read_cache_line		*lines;
+	void				*buf;
+	struct read_cache_hash_head	*hash;
+	uint32_t			hash_mask;
+	/* Lines that are neither cached nor being filled */
+	TAILQ_HEAD(, read_cache_line)	free_lines;
+	/* Lines that were filled but not hit since, LRU first */
+	TAILQ_HEAD(, read_cache_line)	probation;
+	/* Lines that were hit at least once, LRU first */
+	TAILQ_HEAD(, read_cache_line)	protected;
+	uint32_t			num_protected;
+	uint32_t			max_protected;
+	uint64_t			hits;
+	uint64_t			misses;
+};
+
+struct read_cache_bdev_io {
+	/* Line filled by this I/O, if any */
+	struct read_cache_line		*line;
+
+	struct spdk_io_channel		*ch;
+
+	/* for bdev_io_wait */
+	struct spdk_bdev_io_wait_entry	bdev_io_wait;
+};
+
+static void vbdev_read_cache_submit_request(struct spdk_io_channel *ch,
+		struct spdk_bdev_io *bdev_io);
+
+static inline uint32_t *
+read_cache_generation(struct vbdev_read_cache *node, uint64_t index)
+{
+	return &node->generations[index & node->generation_mask];
+}
+
+/* Make all cached copies of the given range stale in every shard. */
+static void
+read_cache_invalidate(struct vbdev_read_cache *node, uint64_t offset_blocks, uint64_t num_blocks)
+{
+	uint64_t first, last, index;
+
+	if (num_blocks == 0) {
+		return;
+	}
+
+	first = offset_blocks / node->line_blocks;
+	last = (offset_blocks + num_blocks - 1) / node->line_blocks;
+
+	if (last - first > node->generation_mask) {
+		__atomic_add_fetch(&node->epoch, 1, __ATOMIC_RELEASE);
+		return;
+	}
+
+	for (index = first; index <= last; index++) {
+		__atomic_add_fetch(read_cache_generation(node, index), 1, __ATOMIC_RELEASE);
+	}
+}
+
+static inline bool
+read_cache_line_is_current(struct vbdev_read_cache *node, struct read_cache_line *line)
+{
+	return line->generation == __atomic_load_n(read_cache_generation(node, line->index),
+			__ATOMIC_ACQUIRE) &&
+	       line->epoch == __atomic_load_n(&node->epoch, __ATOMIC_ACQUIRE);
+}
+
+static inline struct read_cache_hash_head *
+read_cache_hash_bucket(struct read_cache_io_channel *ch, uint64_t index)
+{
+	return &ch->hash[index & ch->hash_mask];
+}
+
+static void
+read_cache_line_remove(struct read_cache_io_channel *ch, struct read_cache_line *line)
+{
+	LIST_REMOVE(line, hash_link);
+	if (line->protected) {
+		TAILQ_REMOVE(&ch->protected, line, lru_link);
+		ch->num_protected--;
+	} else {
+		TAILQ_REMOVE(&ch->probation, line, lru_link);
+	}
+}
+
+static struct read_cache_line *
+read_cache_line_find(struct read_cache_io_channel *ch, uint64_t index)
+{
+	struct read_cache_line *line;
+
+	LIST_FOREACH(line, read_cache_hash_bucket(ch, index), hash_link) {
+		if (line->index == index) {
+			return line;
+		}
+	}
+
+	return NULL;
+}
+
+/* Look up a line and return it only if its contents are still current. Stale
+ * lines are released on the way. */
+static struct read_cache_line *
+read_cache_line_lookup(struct vbdev_read_cache *node, struct read_cache_io_channel *ch,
+		       uint64_t index)
+{
+	struct read_cache_line *line;
+
+	line = read_cache_line_find(ch, index);
+	if (line == NULL) {
+		return NULL;
+	}
+
+	if (!read_cache_line_is_current(node, line)) {
+		read_cache_line_remove(ch, line);
+		TAILQ_INSERT_TAIL(&ch->free_lines, line, lru_link);
+		return NULL;
+	}
+
+	return line;
+}
+
+static void
+read_cache_line_touch(struct read_cache_io_channel *ch, struct read_cache_line *line)
+{
+	struct read_cache_line *demoted;
+
+	if (line->protected) {
+		TAILQ_REMOVE(&ch->protected, line, lru_link);
+		TAILQ_INSERT_TAIL(&ch->protected, line, lru_link);
+		return;
+	}
+
+	/* Second hit, promote the line out of probation */
+	TAILQ_REMOVE(&ch->probation, line, lru_link);
+	TAILQ_INSERT_TAIL(&ch->protected, line, lru_link);
+	line->protected = true;
+	ch->num_protected++;
+
+	if (ch->num_protected > ch->max_protected) {
+		demoted = TAILQ_FIRST(&ch->protected);
+		TAILQ_REMOVE(&ch->protected, demoted, lru_link);
+		TAILQ_INSERT_TAIL(&ch->probation, demoted, lru_link);
+		demoted->protected = false;
+		ch->num_protected--;
+	}
+}
+
+/* Get a line to fill, evicting the least recently used one if needed. */
+static struct read_cache_line *
+read_cache_line_get(struct read_cache_io_channel *ch)
+{
+	struct read_cache_line *line;
+
+	line = TAILQ_FIRST(&ch->free_lines);
+	if (line != NULL) {
+		TAILQ_REMOVE(&ch->free_lines, line, lru_link);
+		return line;
+	}
+
+	line = TAILQ_FIRST(&ch->probation);
+	if (line == NULL) {
+		line = TAILQ_FIRST(&ch->protected);
+		if (line == NULL) {
+			/* All lines are being filled */
+			return NULL;
+		}
+	}
+
+	read_cache_line_remove(ch, line);
+
+	return line;
+}
+
+static void
+read_cache_line_put(struct read_cache_io_channel *ch, struct read_cache_line *line)
+{
+	TAILQ_INSERT_TAIL(&ch->free_lines, line, lru_link);
+}
+
+static void
+read_cache_line_insert(struct vbdev_read_cache *node, struct read_cache_io_channel *ch,
+		       struct read_cache_line *line)
+{
+	/* Don't insert a line if a write raced with the fill or the same line was
+	 * filled by another I/O in the meantime. */
+	if (!read_cache_line_is_current(node, line) ||
+	    read_cache_line_find(ch, line->index) != NULL) {
+		read_cache_line_put(ch, line);
+		return;
+	}
+
+	line->protected = false;
+	LIST_INSERT_HEAD(read_cache_hash_bucket(ch, line->index), line, hash_link);
+	TAILQ_INSERT_TAIL(&ch->probation, line, lru_link);
+}
+
+/* Copy len bytes from buf to the iovs, starting at offset bytes into the iovs. */
+static void
+read_cache_copy_to_iovs(struct iovec *iovs, int iovcnt, size_t offset, const void *buf,
+			size_t len)
+{
+	size_t copy;
+	int i;
+
+	for (i = 0; i < iovcnt && len > 0; i++) {
+		if (offset >= iovs[i].iov_len) {
+			offset -= iovs[i].iov_len;
+			continue;
+		}
+
+		copy = spdk_min(iovs[i].iov_len - offset, len);
+		memcpy((uint8_t *)iovs[i].iov_base + offset, buf, copy);
+		buf = (const uint8_t *)buf + copy;
+		len -= copy;
+		offset = 0;
+	}
+}
+
+/* Copy the part of a line that overlaps the I/O into the I/O's buffers. */
+static void
+read_cache_copy_line(struct vbdev_read_cache *node, struct spdk_bdev_io *bdev_io,
+		     struct read_cache_line *line)
+{
+	uint64_t line_offset = line->index * node->line_blocks;
+	uint64_t io_start = bdev_io->u.bdev.offset_blocks;
+	uint64_t io_end = io_start + bdev_io->u.bdev.num_blocks;
+	uint64_t start = spdk_max(io_start, line_offset);
+	uint64_t end = spdk_min(io_end, line_offset + node->line_blocks);
+	uint32_t blocklen = node->cache_bdev.blocklen;
+
+	read_cache_copy_to_iovs(bdev_io->u.bdev.iovs, bdev_io->u.bdev.iovcnt,
+				(start - io_start) * blocklen,
+				(uint8_t *)line->buf + (start - line_offset) * blocklen,
+				(end - start) * blocklen);
+}
+
+/* Serve the I/O from the cache if all of its lines are cached. */
+static bool
+read_cache_try_hit(struct vbdev_read_cache *node, struct read_cache_io_channel *ch,
+		   struct spdk_bdev_io *bdev_io)
+{
+	uint64_t first, last, index;
+	struct read_cache_line *line;
+
+	first = bdev_io->u.bdev.offset_blocks / node->line_blocks;
+	last = (bdev_io->u.bdev.offset_blocks + bdev_io->u.bdev.num_blocks - 1) / node->line_blocks;
+
+	for (index = first; index <= last; index++) {
+		if (read_cache_line_lookup(node, ch, index) == NULL) {
+			return false;
+		}
+	}
+
+	for (index = first; index <= last; index++) {
+		line = read_cache_line_find(ch, index);
+		read_cache_copy_line(node, bdev_io, line);
+		read_cache_line_touch(ch, line);
+	}
+
+	return true;
+}
+
+/* Callback for unregistering the IO device. */
+static void
+_device_unregister_cb(void *io_device)
+{
+	struct vbdev_read_cache *node = io_device;
+
+	/* Done with this node. */
+	free(node->generations);
+	free(node->cache_bdev.name);
+	free(node);
+}
+
+static void
+_vbdev_read_cache_destruct(void *ctx)
+{
+	struct spdk_bdev_desc *desc = ctx;
+
+	spdk_bdev_close(desc);
+}
+
+static int
+vbdev_read_cache_destruct(void *ctx)
+{
+	struct vbdev_read_cache *node = (struct vbdev_read_cache *)ctx;
+
+	TAILQ_REMOVE(&g_read_cache_nodes, node, link);
+
+	/* Unclaim the underlying bdev. */
+	spdk_bdev_module_release_bdev(node->base_bdev);
+
+	/* Close the underlying bdev on its same opened thread. */
+	if (node->thread && node->thread != spdk_get_thread()) {
+		spdk_thread_send_msg(node->thread, _vbdev_read_cache_destruct, node->base_desc);
+	} else {
+		spdk_bdev_close(node->base_desc);
+	}
+
+	/* Unregister the io_device. */
+	spdk_io_device_unregister(node, _device_unregister_cb);
+
+	return 0;
+}
+
+static void
+_read_cache_complete_io(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct spdk_bdev_io *orig_io = cb_arg;
+	int status = success ? SPDK_BDEV_IO_STATUS_SUCCESS : SPDK_BDEV_IO_STATUS_FAILED;
+
+	spdk_bdev_io_complete(orig_io, status);
+	spdk_bdev_free_io(bdev_io);
+}
+
+static void
+_read_cache_complete_write(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct spdk_bdev_io *orig_io = cb_arg;
+	struct vbdev_read_cache *node = SPDK_CONTAINEROF(orig_io->bdev, struct vbdev_read_cache,
+					cache_bdev);
+
+	/* Lines filled while the write was in flight may hold old data */
+	read_cache_invalidate(node, orig_io->u.bdev.offset_blocks, orig_io->u.bdev.num_blocks);
+
+	_read_cache_complete_io(bdev_io, success, cb_arg);
+}
+
+static void
+_read_cache_complete_fill(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct spdk_bdev_io *orig_io = cb_arg;
+	struct vbdev_read_cache *node = SPDK_CONTAINEROF(orig_io->bdev, struct vbdev_read_cache,
+					cache_bdev);
+	struct read_cache_bdev_io *io_ctx = (struct read_cache_bdev_io *)orig_io->driver_ctx;
+	struct read_cache_io_channel *ch = spdk_io_channel_get_ctx(io_ctx->ch);
+	struct read_cache_line *line = io_ctx->line;
+
+	io_ctx->line = NULL;
+	spdk_bdev_free_io(bdev_io);
+
+	if (!success) {
+		read_cache_line_put(ch, line);
+		spdk_bdev_io_complete(orig_io, SPDK_BDEV_IO_STATUS_FAILED);
+		return;
+	}
+
+	read_cache_copy_line(node, orig_io, line);
+	read_cache_line_insert(node, ch, line);
+
+	spdk_bdev_io_complete(orig_io, SPDK_BDEV_IO_STATUS_SUCCESS);
+}
+
+static void
+vbdev_read_cache_resubmit_io(void *arg)
+{
+	struct spdk_bdev_io *bdev_io = (struct spdk_bdev_io *)arg;
+	struct read_cache_bdev_io *io_ctx = (struct read_cache_bdev_io *)bdev_io->driver_ctx;
+
+	vbdev_read_cache_submit_request(io_ctx->ch, bdev_io);
+}
+
+static void
+vbdev_read_cache_queue_io(struct spdk_bdev_io *bdev_io)
+{
+	struct read_cache_bdev_io *io_ctx = (struct read_cache_bdev_io *)bdev_io->driver_ctx;
+	struct read_cache_io_channel *ch = spdk_io_channel_get_ctx(io_ctx->ch);
+	int rc;
+
+	io_ctx->bdev_io_wait.bdev = bdev_io->bdev;
+	io_ctx->bdev_io_wait.cb_fn = vbdev_read_cache_resubmit_io;
+	io_ctx->bdev_io_wait.cb_arg = bdev_io;
+
+	/* Queue the IO using the channel of the base device. */
+	rc = spdk_bdev_queue_io_wait(bdev_io->bdev, ch->base_ch, &io_ctx->bdev_io_wait);
+	if (rc != 0) {
+		SPDK_ERRLOG("Queue io failed in vbdev_read_cache_queue_io, rc=%d.\n", rc);
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+	}
+}
+
+static int
+read_cache_fill(struct vbdev_read_cache *node, struct read_cache_io_channel *ch,
+		struct spdk_bdev_io *bdev_io)
+{
+	struct read_cache_bdev_io *io_ctx = (struct read_cache_bdev_io *)bdev_io->driver_ctx;
+	struct read_cache_line *line;
+	uint64_t offset_blocks;
+	int rc;
+
+	line = read_cache_line_get(ch);
+	if (line == NULL) {
+		return -EAGAIN;
+	}
+
+	line->index = bdev_io->u.bdev.offset_blocks / node->line_blocks;
+	/* Take the generation before reading, so that a write that starts while the
+	 * line is filled prevents its insertion. */
+	line->generation = __atomic_load_n(read_cache_generation(node, line->index), __ATOMIC_ACQUIRE);
+	line->epoch = __atomic_load_n(&node->epoch, __ATOMIC_ACQUIRE);
+	io_ctx->line = line;
+
+	offset_blocks = line->index * node->line_blocks;
+	rc = spdk_bdev_read_blocks(node->base_desc, ch->base_ch, line->buf, offset_blocks,
+				   spdk_min(node->line_blocks, node->cache_bdev.blockcnt - offset_blocks),
+				   _read_cache_complete_fill, bdev_io);
+	if (rc != 0) {
+		io_ctx->line = NULL;
+		read_cache_line_put(ch, line);
+	}
+
+	return rc;
+}
+
+static void
+read_cache_read_get_buf_cb(struct spdk_io_channel *_ch, struct spdk_bdev_io *bdev_io,
+			   bool success)
+{
+	struct vbdev_read_cache *node = SPDK_CONTAINEROF(bdev_io->bdev, struct vbdev_read_cache,
+					cache_bdev);
+	struct read_cache_io_channel *ch = spdk_io_channel_get_ctx(_ch);
+	struct read_cache_bdev_io *io_ctx = (struct read_cache_bdev_io *)bdev_io->driver_ctx;
+	uint64_t offset_blocks = bdev_io->u.bdev.offset_blocks;
+	uint64_t num_blocks = bdev_io->u.bdev.num_blocks;
+	int rc;
+
+	if (!success) {
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		return;
+	}
+
+	if (read_cache_try_hit(node, ch, bdev_io)) {
+		ch->hits++;
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_SUCCESS);
+		return;
+	}
+
+	ch->misses++;
+	io_ctx->ch = _ch;
+
+	/* Only reads within a single line populate the cache. Larger reads are most
+	 * likely sequential and would just push out the lines worth keeping. */
+	rc = -EAGAIN;
+	if (offset_blocks / node->line_blocks ==
+	    (offset_blocks + num_blocks - 1) / node->line_blocks) {
+		rc = read_cache_fill(node, ch, bdev_io);
+	}
+
+	if (rc == -EAGAIN) {
+		rc = spdk_bdev_readv_blocks(node->base_desc, ch->base_ch, bdev_io->u.bdev.iovs,
+					    bdev_io->u.bdev.iovcnt, offset_blocks, num_blocks,
+					    _read_cache_complete_io, bdev_io);
+	}
+
+	if (rc != 0) {
+		if (rc == -ENOMEM) {
+			SPDK_ERRLOG("No memory, start to queue io for read_cache.\n");
+			vbdev_read_cache_queue_io(bdev_io);
+		} else {
+			SPDK_ERRLOG("ERROR on bdev_io submission!\n");
+			spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		}
+	}
+}
+
+static void
+vbdev_read_cache_submit_request(struct spdk_io_channel *_ch, struct spdk_bdev_io *bdev_io)
+{
+	struct vbdev_read_cache *node = SPDK_CONTAINEROF(bdev_io->bdev, struct vbdev_read_cache,
+					cache_bdev);
+	struct read_cache_io_channel *ch = spdk_io_channel_get_ctx(_ch);
+	struct read_cache_bdev_io *io_ctx = (struct read_cache_bdev_io *)bdev_io->driver_ctx;
+	int rc = 0;
+
+	io_ctx->line = NULL;
+
+	switch (bdev_io->type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+		spdk_bdev_io_get_buf(bdev_io, read_cache_read_get_buf_cb,
+				     bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen);
+		return;
+	case SPDK_BDEV_IO_TYPE_WRITE:
+		read_cache_invalidate(node, bdev_io->u.bdev.offset_blocks, bdev_io->u.bdev.num_blocks);
+		rc = spdk_bdev_writev_blocks(node->base_desc, ch->base_ch, bdev_io->u.bdev.iovs,
+					     bdev_io->u.bdev.iovcnt, bdev_io->u.bdev.offset_blocks,
+					     bdev_io->u.bdev.num_blocks, _read_cache_complete_write,
+					     bdev_io);
+		break;
+	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
+		read_cache_invalidate(node, bdev_io->u.bdev.offset_blocks, bdev_io->u.bdev.num_blocks);
+		rc = spdk_bdev_write_zeroes_blocks(node->base_desc, ch->base_ch,
+						   bdev_io->u.bdev.offset_blocks,
+						   bdev_io->u.bdev.num_blocks,
+						   _read_cache_complete_write, bdev_io);
+		break;
+	case SPDK_BDEV_IO_TYPE_UNMAP:
+		read_cache_invalidate(node, bdev_io->u.bdev.offset_blocks, bdev_io->u.bdev.num_blocks);
+		rc = spdk_bdev_unmap_blocks(node->base_desc, ch->base_ch,
+					    bdev_io->u.bdev.offset_blocks,
+					    bdev_io->u.bdev.num_blocks,
+					    _read_cache_complete_write, bdev_io);
+		break;
+	case SPDK_BDEV_IO_TYPE_COPY:
+		read_cache_invalidate(node, bdev_io->u.bdev.offset_blocks, bdev_io->u.bdev.num_blocks);
+		rc = spdk_bdev_copy_blocks(node->base_desc, ch->base_ch,
+					   bdev_io->u.bdev.offset_blocks,
+					   bdev_io->u.bdev.copy.src_offset_blocks,
+					   bdev_io->u.bdev.num_blocks,
+					   _read_cache_complete_write, bdev_io);
+		break;
+	case SPDK_BDEV_IO_TYPE_FLUSH:
+		rc = spdk_bdev_flush_blocks(node->base_desc, ch->base_ch,
+					    bdev_io->u.bdev.offset_blocks,
+					    bdev_io->u.bdev.num_blocks,
+					    _read_cache_complete_io, bdev_io);
+		break;
+	case SPDK_BDEV_IO_TYPE_RESET:
+		rc = spdk_bdev_reset(node->base_desc, ch->base_ch,
+				     _read_cache_complete_io, bdev_io);
+		break;
+	default:
+		SPDK_ERRLOG("read_cache: unknown I/O type %d\n", bdev_io->type);
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		return;
+	}
+
+	if (rc != 0) {
+		if (rc == -ENOMEM) {
+			SPDK_ERRLOG("No memory, start to queue io for read_cache.\n");
+			io_ctx->ch = _ch;
+			vbdev_read_cache_queue_io(bdev_io);
+		} else {
+			SPDK_ERRLOG("ERROR on bdev_io submission!\n");
+			spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		}
+	}
+}
+
+static bool
+vbdev_read_cache_io_type_supported(void *ctx, enum spdk_bdev_io_type io_type)
+{
+	struct vbdev_read_cache *node = (struct vbdev_read_cache *)ctx;
+
+	switch (io_type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+	case SPDK_BDEV_IO_TYPE_WRITE:
+	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
+	case SPDK_BDEV_IO_TYPE_UNMAP:
+	case SPDK_BDEV_IO_TYPE_COPY:
+	case SPDK_BDEV_IO_TYPE_FLUSH:
+	case SPDK_BDEV_IO_TYPE_RESET:
+		return spdk_bdev_io_type_supported(node->base_bdev, io_type);
+	default:
+		/* Anything else could modify the data behind the cache's back */
+		return false;
+	}
+}
+
+static struct spdk_io_channel *
+vbdev_read_cache_get_io_channel(void *ctx)
+{
+	struct vbdev_read_cache *node = (struct vbdev_read_cache *)ctx;
+
+	return spdk_get_io_channel(node);
+}
+
+static void
+_read_cache_write_conf_values(struct vbdev_read_cache *node, struct spdk_json_write_ctx *w)
+{
+	spdk_json_write_named_string(w, "name", spdk_bdev_get_name(&node->cache_bdev));
+	spdk_json_write_named_string(w, "base_bdev_name", spdk_bdev_get_name(node->base_bdev));
+	spdk_json_write_named_uint64(w, "cache_size_mb", node->cache_size_mb);
+	spdk_json_write_named_uint32(w, "line_size_kb", node->line_size_kb);
+}
+
+static int
+vbdev_read_cache_dump_info_json(void *ctx, struct spdk_json_write_ctx *w)
+{
+	struct vbdev_read_cache *node = (struct vbdev_read_cache *)ctx;
+
+	spdk_json_write_name(w, "read_cache");
+	spdk_json_write_object_begin(w);
+	_read_cache_write_conf_values(node, w);
+	spdk_json_write_named_uint32(w, "lines_per_thread", node->shard_lines);
+	spdk_json_write_object_end(w);
+
+	return 0;
+}
+
+/* This is used to generate JSON that can configure this module to its current state. */
+static int
+vbdev_read_cache_config_json(struct spdk_json_write_ctx *w)
+{
+	struct vbdev_read_cache *node;
+
+	TAILQ_FOREACH(node, &g_read_cache_nodes, link) {
+		const struct spdk_uuid *uuid = spdk_bdev_get_uuid(&node->cache_bdev);
+
+		spdk_json_write_object_begin(w);
+		spdk_json_write_named_string(w, "method", "bdev_read_cache_create");
+		spdk_json_write_named_object_begin(w, "params");
+		_read_cache_write_conf_values(node, w);
+		if (!spdk_uuid_is_null(uuid)) {
+			spdk_json_write_named_uuid(w, "uuid", uuid);
+		}
+		spdk_json_write_object_end(w);
+		spdk_json_write_object_end(w);
+	}
+	return 0;
+}
+
+static void
+read_cache_ch_free(struct read_cache_io_channel *ch)
+{
+	spdk_free(ch->buf);
+	free(ch->lines);
+	free(ch->hash);
+}
+
+static int
+read_cache_ch_create_cb(void *io_device, void *ctx_buf)
+{
+	struct read_cache_io_channel *ch = ctx_buf;
+	struct vbdev_read_cache *node = io_device;
+	uint32_t i;
+
+	TAILQ_INIT(&ch->free_lines);
+	TAILQ_INIT(&ch->probation);
+	TAILQ_INIT(&ch->protected);
+	ch->max_protected = (uint64_t)node->shard_lines * READ_CACHE_PROTECTED_PERCENT / 100;
+	ch->hash_mask = spdk_align32pow2(node->shard_lines) - 1;
+
+	ch->lines = calloc(node->shard_lines, sizeof(*ch->lines));
+	ch->hash = calloc(ch->hash_mask + 1, sizeof(*ch->hash));
+	ch->buf = spdk_zmalloc((size_t)node->shard_lines * node->line_stride, READ_CACHE_BUF_ALIGN,
+			       NULL, SPDK_ENV_LCORE_ID_ANY, SPDK_MALLOC_DMA);
+	if (ch->lines == NULL || ch->hash == NULL || ch->buf == NULL) {
+		SPDK_ERRLOG("Could not allocate read cache shard for %s\n", node->cache_bdev.name);
+		read_cache_ch_free(ch);
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < node->shard_lines; i++) {
+		ch->lines[i].buf = (uint8_t *)ch->buf + (size_t)i * node->line_stride;
+		TAILQ_INSERT_TAIL(&ch->free_lines, &ch->lines[i], lru_link);
+	}
+
+	ch->base_ch = spdk_bdev_get_io_channel(node->base_desc);
+	if (ch->base_ch == NULL) {
+		read_cache_ch_free(ch);
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
+static void
+read_cache_ch_destroy_cb(void *io_device, void *ctx_buf)
+{
+	struct read_cache_io_channel *ch = ctx_buf;
+
+	spdk_put_io_channel(ch->base_ch);
+	read_cache_ch_free(ch);
+}
+
+/* Create the read cache association from the bdev and vbdev name and insert
+ * on the global list. */
+static int
+vbdev_read_cache_insert_association(const struct vbdev_read_cache_opts *opts)
+{
+	struct bdev_association *assoc;
+
+	TAILQ_FOREACH(assoc, &g_bdev_associations, link) {
+		if (strcmp(opts->name, assoc->vbdev_name) == 0) {
+			SPDK_ERRLOG("read cache bdev %s already exists\n", opts->name);
+			return -EEXIST;
+		}
+	}
+
+	assoc = calloc(1, sizeof(struct bdev_association));
+	if (!assoc) {
+		SPDK_ERRLOG("could not allocate bdev_association\n");
+		return -ENOMEM;
+	}
+
+	assoc->bdev_name = strdup(opts->base_bdev_name);
+	if (!assoc->bdev_name) {
+		SPDK_ERRLOG("could not allocate assoc->bdev_name\n");
+		free(assoc);
+		return -ENOMEM;
+	}
+
+	assoc->vbdev_name = strdup(opts->name);
+	if (!assoc->vbdev_name) {
+		SPDK_ERRLOG("could not allocate assoc->vbdev_name\n");
+		free(assoc->bdev_name);
+		free(assoc);
+		return -ENOMEM;
+	}
+
+	spdk_uuid_copy(&assoc->uuid, &opts->uuid);
+	assoc->cache_size_mb = opts->cache_size_mb;
+	assoc->line_size_kb = opts->line_size_kb;
+	TAILQ_INSERT_TAIL(&g_bdev_associations, assoc, link);
+
+	return 0;
+}
+
+static void
+vbdev_read_cache_free_association(struct bdev_association *assoc)
+{
+	TAILQ_REMOVE(&g_bdev_associations, assoc, link);
+	free(assoc->bdev_name);
+	free(assoc->vbdev_name);
+	free(assoc);
+}
+
+static int
+vbdev_read_cache_init(void)
+{
+	return 0;
+}
+
+static void
+vbdev_read_cache_finish(void)
+{
+	struct bdev_association *assoc;
+
+	while ((assoc = TAILQ_FIRST(&g_bdev_associations))) {
+		vbdev_read_cache_free_association(assoc);
+	}
+}
+
+static int
+vbdev_read_cache_get_ctx_size(void)
+{
+	return sizeof(struct read_cache_bdev_io);
+}
+
+static void
+vbdev_read_cache_write_config_json(struct spdk_bdev *bdev, struct spdk_json_write_ctx *w)
+{
+	/* No config per bdev needed */
+}
+
+/* When we register our bdev this is how we specify our entry points. */
+static const struct spdk_bdev_fn_table vbdev_read_cache_fn_table = {
+	.destruct		= vbdev_read_cache_destruct,
+	.submit_request		= vbdev_read_cache_submit_request,
+	.io_type_supported	= vbdev_read_cache_io_type_supported,
+	.get_io_channel		= vbdev_read_cache_get_io_channel,
+	.dump_info_json		= vbdev_read_cache_dump_info_json,
+	.write_config_json	= vbdev_read_cache_write_config_json,
+};
+
+static void
+vbdev_read_cache_base_bdev_hotremove_cb(struct spdk_bdev *bdev_find)
+{
+	struct vbdev_read_cache *node, *tmp;
+
+	TAILQ_FOREACH_SAFE(node, &g_read_cache_nodes, link, tmp) {
+		if (bdev_find == node->base_bdev) {
+			spdk_bdev_unregister(&node->cache_bdev, NULL, NULL);
+		}
+	}
+}
+
+/* Called when the underlying base bdev triggers asynchronous event such as bdev removal. */
+static void
+vbdev_read_cache_base_bdev_event_cb(enum spdk_bdev_event_type type, struct spdk_bdev *bdev,
+				    void *event_ctx)
+{
+	switch (type) {
+	case SPDK_BDEV_EVENT_REMOVE:
+		vbdev_read_cache_base_bdev_hotremove_cb(bdev);
+		break;
+	default:
+		SPDK_NOTICELOG("Unsupported bdev event: type %d\n", type);
+		break;
+	}
+}
+
+/* Size the shards and the generation table of a new read cache bdev. */
+static int
+vbdev_read_cache_init_geometry(struct vbdev_read_cache *node, struct bdev_association *assoc)
+{
+	struct spdk_bdev *bdev = node->base_bdev;
+	uint64_t line_size, total_lines;
+
+	node->cache_size_mb = assoc->cache_size_mb;
+	node->line_size_kb = assoc->line_size_kb;
+	node->line_blocks = spdk_max(node->line_size_kb * 1024 / bdev->blocklen, 1);
+	line_size = (uint64_t)node->line_blocks * bdev->blocklen;
+	node->line_stride = SPDK_ALIGN_CEIL(line_size, READ_CACHE_BUF_ALIGN);
+
+	total_lines = node->cache_size_mb * 1024 * 1024 / node->line_stride;
+	node->shard_lines = spdk_min(total_lines / spdk_env_get_core_count(), UINT32_MAX / 2);
+	if (node->shard_lines == 0) {
+		SPDK_ERRLOG("Cache of %" PRIu64 "MiB is too small for %" PRIu32 " threads\n",
+			    node->cache_size_mb, spdk_env_get_core_count());
+		return -EINVAL;
+	}
+
+	node->generation_mask = spdk_align32pow2(spdk_max(spdk_min(total_lines,
+							 READ_CACHE_MAX_GENERATIONS),
+							 READ_CACHE_MIN_GENERATIONS)) - 1;
+	node->generations = calloc(node->generation_mask + 1, sizeof(*node->generations));
+	if (node->generations == NULL) {
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
+/* Create and register the read cache vbdev if we find it in our list of bdev names.
+ * This can be called either by the examine path or RPC method.
+ */
+static int
+vbdev_read_cache_register(const char *bdev_name)
+{
+	struct bdev_association *assoc;
+	struct vbdev_read_cache *node;
+	struct spdk_bdev *bdev;
+	struct spdk_uuid ns_uuid;
+	int rc = 0;
+
+	spdk_uuid_parse(&ns_uuid, BDEV_READ_CACHE_NAMESPACE_UUID);
+
+	TAILQ_FOREACH(assoc, &g_bdev_associations, link) {
+		if (strcmp(assoc->bdev_name, bdev_name) != 0) {
+			continue;
+		}
+
+		node = calloc(1, sizeof(struct vbdev_read_cache));
+		if (!node) {
+			rc = -ENOMEM;
+			SPDK_ERRLOG("could not allocate read cache node\n");
+			break;
+		}
+
+		node->cache_bdev.name = strdup(assoc->vbdev_name);
+		if (!node->cache_bdev.name) {
+			rc = -ENOMEM;
+			SPDK_ERRLOG("could not allocate read cache bdev name\n");
+			free(node);
+			break;
+		}
+		node->cache_bdev.product_name = "read_cache";
+
+		/* The base bdev that we're attaching to. */
+		rc = spdk_bdev_open_ext(bdev_name, true, vbdev_read_cache_base_bdev_event_cb,
+					NULL, &node->base_desc);
+		if (rc) {
+			if (rc != -ENODEV) {
+				SPDK_ERRLOG("could not open bdev %s\n", bdev_name);
+			}
+			free(node->cache_bdev.name);
+			free(node);
+			break;
+		}
+
+		bdev = spdk_bdev_desc_get_bdev(node->base_desc);
+		node->base_bdev = bdev;
+
+		if (spdk_bdev_is_md_separate(bdev)) {
+			SPDK_ERRLOG("read cache doesn't support bdev %s with separate metadata\n", bdev_name);
+			rc = -ENOTSUP;
+		} else {
+			rc = vbdev_read_cache_init_geometry(node, assoc);
+		}
+		if (rc) {
+			spdk_bdev_close(node->base_desc);
+			free(node->cache_bdev.name);
+			free(node);
+			break;
+		}
+
+		if (!spdk_uuid_is_null(&assoc->uuid)) {
+			spdk_uuid_copy(&node->cache_bdev.uuid, &assoc->uuid);
+		} else {
+			/* Generate UUID based on namespace UUID + base bdev UUID. */
+			rc = spdk_uuid_generate_sha1(&node->cache_bdev.uuid, &ns_uuid,
+						     (const char *)&bdev->uuid, sizeof(struct spdk_uuid));
+			if (rc) {
+				SPDK_ERRLOG("Unable to generate new UUID for read cache bdev\n");
+				spdk_bdev_close(node->base_desc);
+				free(node->generations);
+				free(node->cache_bdev.name);
+				free(node);
+				break;
+			}
+		}
+
+		/* Copy some properties from the underlying base bdev. */
+		node->cache_bdev.write_cache = bdev->write_cache;
+		node->cache_bdev.required_alignment = bdev->required_alignment;
+		node->cache_bdev.optimal_io_boundary = bdev->optimal_io_boundary;
+		node->cache_bdev.blocklen = bdev->blocklen;
+		node->cache_bdev.blockcnt = bdev->blockcnt;
+
+		node->cache_bdev.md_interleave = bdev->md_interleave;
+		node->cache_bdev.md_len = bdev->md_len;
+		node->cache_bdev.dif_type = bdev->dif_type;
+		node->cache_bdev.dif_is_head_of_md = bdev->dif_is_head_of_md;
+		node->cache_bdev.dif_check_flags = bdev->dif_check_flags;
+
+		node->cache_bdev.ctxt = node;
+		node->cache_bdev.fn_table = &vbdev_read_cache_fn_table;
+		node->cache_bdev.module = &read_cache_if;
+		TAILQ_INSERT_TAIL(&g_read_cache_nodes, node, link);
+
+		spdk_io_device_register(node, read_cache_ch_create_cb, read_cache_ch_destroy_cb,
+					sizeof(struct read_cache_io_channel),
+					assoc->vbdev_name);
+
+		/* Save the thread where the base device is opened */
+		node->thread = spdk_get_thread();
+
+		rc = spdk_bdev_module_claim_bdev(bdev, node->base_desc, node->cache_bdev.module);
+		if (rc) {
+			SPDK_ERRLOG("could not claim bdev %s\n", bdev_name);
+			spdk_bdev_close(node->base_desc);
+			TAILQ_REMOVE(&g_read_cache_nodes, node, link);
+			spdk_io_device_unregister(node, _device_unregister_cb);
+			break;
+		}
+
+		rc = spdk_bdev_register(&node->cache_bdev);
+		if (rc) {
+			SPDK_ERRLOG("could not register read cache bdev\n");
+			spdk_bdev_module_release_bdev(node->base_bdev);
+			spdk_bdev_close(node->base_desc);
+			TAILQ_REMOVE(&g_read_cache_nodes, node, link);
+			spdk_io_device_unregister(node, _device_unregister_cb);
+			break;
+		}
+
+		SPDK_NOTICELOG("Created read cache bdev %s on %s with %" PRIu32 " lines of %" PRIu32
+			       " blocks per thread\n", assoc->vbdev_name, bdev_name, node->shard_lines,
+			       node->line_blocks);
+	}
+
+	return rc;
+}
+
+int
+bdev_read_cache_create_disk(const struct vbdev_read_cache_opts *opts)
+{
+	struct vbdev_read_cache_opts _opts = *opts;
+	struct bdev_association *assoc;
+	int rc;
+
+	if (_opts.name == NULL || _opts.base_bdev_name == NULL) {
+		return -EINVAL;
+	}
+
+	if (_opts.cache_size_mb == 0) {
+		SPDK_ERRLOG("Cache size must be greater than 0\n");
+		return -EINVAL;
+	}
+
+	if (_opts.line_size_kb == 0) {
+		_opts.line_size_kb = READ_CACHE_DEFAULT_LINE_SIZE_KB;
+	}
+
+	if (_opts.line_size_kb > READ_CACHE_MAX_LINE_SIZE_KB) {
+		SPDK_ERRLOG("Line size must not exceed %u KiB\n", READ_CACHE_MAX_LINE_SIZE_KB);
+		return -EINVAL;
+	}
+
+	/* Insert the bdev name into our global name list even if it doesn't exist yet,
+	 * it may show up soon...
+	 */
+	rc = vbdev_read_cache_insert_association(&_opts);
+	if (rc) {
+		return rc;
+	}
+
+	rc = vbdev_read_cache_register(_opts.base_bdev_name);
+	if (rc == -ENODEV) {
+		/* This is not an error, we tracked the name above and it still
+		 * may show up later.
+		 */
+		SPDK_NOTICELOG("vbdev creation deferred pending base bdev arrival\n");
+		rc = 0;
+	} else if (rc != 0) {
+		TAILQ_FOREACH(assoc, &g_bdev_associations, link) {
+			if (strcmp(assoc->vbdev_name, _opts.name) == 0) {
+				vbdev_read_cache_free_association(assoc);
+				break;
+			}
+		}
+	}
+
+	return rc;
+}
+
+void
+bdev_read_cache_delete_disk(const char *bdev_name, spdk_bdev_unregister_cb cb_fn, void *cb_arg)
+{
+	struct bdev_association *assoc;
+	int rc;
+
+	rc = spdk_bdev_unregister_by_name(bdev_name, &read_cache_if, cb_fn, cb_arg);
+	if (rc == 0) {
+		/* Remove the association (vbdev, bdev) from g_bdev_associations. This is required so
+		 * that the vbdev does not get re-created if the same bdev is constructed at some
+		 * other time, unless the underlying bdev was hot-removed.
+		 */
+		TAILQ_FOREACH(assoc, &g_bdev_associations, link) {
+			if (strcmp(assoc->vbdev_name, bdev_name) == 0) {
+				vbdev_read_cache_free_association(assoc);
+				break;
+			}
+		}
+	} else {
+		cb_fn(cb_arg, rc);
+	}
+}
+
+static void
+vbdev_read_cache_examine(struct spdk_bdev *bdev)
+{
+	vbdev_read_cache_register(bdev->name);
+
+	spdk_bdev_module_examine_done(&read_cache_if);
+}
+
+SPDK_LOG_REGISTER_COMPONENT(vbdev_read_cache)
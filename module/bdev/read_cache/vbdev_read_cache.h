@@ -0,0 +1,49 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 the SPDK authors.
+ *   All rights reserved.
+ */
+
+#ifndef SPDK_VBDEV_READ_CACHE_H
+#define SPDK_VBDEV_READ_CACHE_H
+
+#include "spdk/stdinc.h"
+
+#include "spdk/bdev.h"
+#include "spdk/bdev_module.h"
+
+struct vbdev_read_cache_opts {
+	/* Name of the read cache bdev */
+	const char		*name;
+
+	/* Name of the bdev to cache */
+	const char		*base_bdev_name;
+
+	/* Optional UUID of the read cache bdev */
+	struct spdk_uuid	uuid;
+
+	/* Memory used for caching, split evenly among the threads */
+	uint64_t		cache_size_mb;
+
+	/* Caching granularity. Misses read whole lines from the base bdev. */
+	uint32_t		line_size_kb;
+};
+
+/**
+ * Create new read cache bdev.
+ *
+ * \param opts Options of the read cache bdev.
+ * \return 0 on success, other on failure.
+ */
+int bdev_read_cache_create_disk(const struct vbdev_read_cache_opts *opts);
+
+/**
+ * Delete read cache bdev.
+ *
+ * \param bdev_name Name of the read cache bdev.
+ * \param cb_fn Function to call after deletion.
+ * \param cb_arg Argument to pass to cb_fn.
+ */
+void bdev_read_cache_delete_disk(const char *bdev_name, spdk_bdev_unregister_cb cb_fn,
+				 void *cb_arg);
+
+#endif /* SPDK_VBDEV_READ_CACHE_H */
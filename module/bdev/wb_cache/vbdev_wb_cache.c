@@ -0,0 +1,2157 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 the SPDK authors.
+ *   All rights reserved.
+ */
+
+/*
+ * A virtual block device caching the writes to its base bdev on a faster cache bdev.
+ *
+ * The cache bdev holds a superblock followed by a circular log. Each write is appended to
+ * the log as a single I/O carrying a header block followed by the data, and is completed
+ * as soon as that I/O completes. Writes are acknowledged in log order, so that the log
+ * never has a gap before an acknowledged entry. A map of the acknowledged data that
+ * wasn't destaged yet redirects reads to the log.
+ *
+ * Dirty data is destaged in batches sorted by their base bdev LBA, coalescing adjacent
+ * ranges. Once a batch is written and flushed to the base bdev, the superblock records the
+ * new head of the log and the space of the destaged entries is reused.
+ *
+ * When an existing log is found on creation, it's scanned from the head recorded in the
+ * superblock and replayed to the base bdev before the bdev is registered.
+ *
+ * All of the cache state is owned by the thread that created the bdev. I/O submitted on
+ * other threads is forwarded to it and completed back on the submitting thread.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "vbdev_wb_cache.h"
+#include "spdk/crc32.h"
+#include "spdk/env.h"
+#include "spdk/likely.h"
+#include "spdk/string.h"
+#include "spdk/thread.h"
+#include "spdk/tree.h"
+#include "spdk/util.h"
+
+#include "spdk/bdev_module.h"
+#include "spdk/log.h"
+
+/* This namespace UUID was generated using uuid_generate() method. */
+#define BDEV_WB_CACHE_NAMESPACE_UUID "5b0d5e0a-7f53-4c1e-b2d8-3c6a2e9f4d17"
+
+#define WB_CACHE_SB_MAGIC		"SPDKWBC"
+#define WB_CACHE_SB_VERSION		1
+#define WB_CACHE_ENTRY_MAGIC		0x45434257 /* "WBCE" */
+/* The superblock takes the first block of the cache bdev, the log takes the rest */
+#define WB_CACHE_LOG_OFFSET		1
+#define WB_CACHE_MAX_ENTRY_KB		128
+/* The log has to fit at least this many entries of maximum size */
+#define WB_CACHE_MIN_LOG_ENTRIES	8
+#define WB_CACHE_MAX_WRITES_IN_FLIGHT	128
+#define WB_CACHE_DESTAGE_MAX_ITEMS	256
+#define WB_CACHE_DESTAGE_BUF_KB		4096
+/* Dirty data is destaged once it takes this much of the log, or when the bdev is idle */
+#define WB_CACHE_DESTAGE_THRESHOLD	50
+#define WB_CACHE_DESTAGE_PERIOD_US	10000
+
+struct wb_cache_sb {
+	char			magic[8];
+	uint32_t		version;
+	uint32_t		crc;
+	uint32_t		block_size;
+	uint32_t		reserved;
+	/* Identifies the entries written since the log was formatted */
+	uint64_t		nonce;
+	struct spdk_uuid	base_uuid;
+	uint64_t		log_blocks;
+	/* Oldest entry that may not be destaged yet */
+	uint64_t		head_offset;
+	uint64_t		head_seq;
+};
+SPDK_STATIC_ASSERT(sizeof(struct wb_cache_sb) <= 512, "Incorrect size");
+
+enum wb_cache_entry_type {
+	WB_CACHE_ENTRY_DATA,
+	WB_CACHE_ENTRY_ZEROES,
+	WB_CACHE_ENTRY_UNMAP,
+	/* Entry whose write failed, only its header is valid */
+	WB_CACHE_ENTRY_HOLE,
+};
+
+struct wb_cache_entry_hdr {
+	uint32_t		magic;
+	uint32_t		crc;
+	uint64_t		nonce;
+	uint64_t		seq;
+	uint64_t		base_offset;
+	uint64_t		num_blocks;
+	/* Number of blocks taken in the log, including the header */
+	uint64_t		log_blocks;
+	uint32_t		type;
+	uint32_t		data_crc;
+};
+SPDK_STATIC_ASSERT(sizeof(struct wb_cache_entry_hdr) <= 512, "Incorrect size");
+
+enum wb_cache_entry_state {
+	/* Being written to the log */
+	WB_CACHE_ENTRY_WRITING,
+	/* Written to the log, waiting for the preceding entries to be acknowledged */
+	WB_CACHE_ENTRY_WRITTEN,
+	/* Write failed and the entry was turned into a hole */
+	WB_CACHE_ENTRY_FAILED,
+	/* Write failed and so did writing the hole, the log is broken from here on */
+	WB_CACHE_ENTRY_BROKEN,
+	/* Acknowledged, waiting for destage */
+	WB_CACHE_ENTRY_DIRTY,
+	/* Destaged, its space can be reused once the superblock points past it */
+	WB_CACHE_ENTRY_CLEAN,
+};
+
+struct vbdev_wb_cache;
+struct wb_cache_req;
+
+typedef void (*wb_cache_req_cb)(struct wb_cache_req *req, bool success);
+
+/* A single I/O to the base or the cache bdev */
+struct wb_cache_req {
+	struct spdk_bdev_desc		*desc;
+	struct spdk_io_channel		*ch;
+	enum spdk_bdev_io_type		type;
+	struct iovec			*iovs;
+	int				iovcnt;
+	uint64_t			offset_blocks;
+	uint64_t			num_blocks;
+	wb_cache_req_cb			cb_fn;
+	void				*cb_arg;
+	struct spdk_bdev_io_wait_entry	bdev_io_wait;
+};
+
+struct wb_cache_extent {
+	uint64_t				base_offset;
+	uint64_t				num_blocks;
+	/* Log block holding base_offset */
+	uint64_t				cache_offset;
+	struct wb_cache_entry			*entry;
+	RB_ENTRY(wb_cache_extent)		node;
+	TAILQ_ENTRY(wb_cache_extent)		link;
+};
+
+struct wb_cache_entry {
+	uint64_t			seq;
+	/* Log block of the header */
+	uint64_t			offset;
+	/* Blocks taken in the log, including the padding skipped when wrapping */
+	uint64_t			log_blocks;
+	uint64_t			base_offset;
+	uint64_t			num_blocks;
+	enum wb_cache_entry_type	type;
+	enum wb_cache_entry_state	state;
+	/* Number of reads from the log of this entry's data */
+	uint32_t			num_reads;
+	/* Live parts of the entry's data */
+	TAILQ_HEAD(, wb_cache_extent)	extents;
+	TAILQ_ENTRY(wb_cache_entry)	link;
+
+	/* Valid while the entry is written */
+	struct spdk_bdev_io		*bdev_io;
+	struct wb_cache_entry_hdr	*hdr;
+	struct wb_cache_req		req;
+	int				iovcnt;
+	struct iovec			iovs[];
+};
+
+struct wb_cache_destage_item {
+	uint64_t			base_offset;
+	uint64_t			num_blocks;
+	uint64_t			cache_offset;
+	struct wb_cache_entry		*entry;
+	struct iovec			iov;
+	struct wb_cache_req		req;
+};
+
+struct wb_cache_destage {
+	struct wb_cache_destage_item	*items;
+	uint32_t			num_items;
+	uint32_t			remaining;
+	bool				failed;
+	bool				in_progress;
+	void				*buf;
+	uint64_t			buf_blocks;
+	struct wb_cache_req		req;
+};
+
+/* Associative list to be used in examine */
+struct bdev_association {
+	char				*vbdev_name;
+	char				*base_bdev_name;
+	char				*cache_bdev_name;
+	struct spdk_uuid		uuid;
+	/* The bdev is being created or exists */
+	bool				active;
+	TAILQ_ENTRY(bdev_association)	link;
+};
+static TAILQ_HEAD(, bdev_association) g_bdev_associations = TAILQ_HEAD_INITIALIZER(
+			g_bdev_associations);
+
+RB_HEAD(wb_cache_extent_tree, wb_cache_extent);
+
+struct vbdev_wb_cache {
+	struct spdk_bdev		wb_bdev;
+	struct spdk_bdev		*base_bdev;
+	struct spdk_bdev_desc		*base_desc;
+	struct spdk_io_channel		*base_ch;
+	struct spdk_bdev		*cache_bdev;
+	struct spdk_bdev_desc		*cache_desc;
+	struct spdk_io_channel		*cache_ch;
+	struct bdev_association		*assoc;
+	/* Thread owning the cache state */
+	struct spdk_thread		*thread;
+	struct spdk_poller		*destage_poller;
+
+	/* Log geometry, in blocks relative to WB_CACHE_LOG_OFFSET */
+	uint64_t			log_blocks;
+	uint64_t			tail;
+	uint64_t			used_blocks;
+	uint32_t			max_entry_blocks;
+
+	uint64_t			nonce;
+	uint64_t			next_seq;
+	/* Head sequence number recorded in the superblock */
+	uint64_t			persisted_seq;
+
+	/* All entries in log order */
+	TAILQ_HEAD(wb_cache_entries, wb_cache_entry) entries;
+	/* Oldest entry that wasn't acknowledged yet */
+	struct wb_cache_entry		*ack_next;
+	struct wb_cache_extent_tree	extents;
+	/* Writes waiting for space in the log */
+	TAILQ_HEAD(, wb_cache_bdev_io)	pending_writes;
+	bool				writes_continuing;
+	uint64_t			writes_since_poll;
+
+	void				*hdr_bufs;
+	void				**free_hdrs;
+	uint32_t			num_free_hdrs;
+
+	struct wb_cache_sb		*sb;
+	struct wb_cache_req		sb_req;
+	struct iovec			sb_iov;
+	struct wb_cache_destage		destage;
+
+	/* Log scan on creation */
+	uint64_t			scan_offset;
+	bool				scan_wrapped;
+	struct wb_cache_req		scan_req;
+	struct iovec			scan_iov;
+
+	bool				loading;
+	bool				failed;
+	bool				destructing;
+	bdev_wb_cache_create_cb		create_cb;
+	void				*create_cb_arg;
+	TAILQ_ENTRY(vbdev_wb_cache)	link;
+};
+static TAILQ_HEAD(, vbdev_wb_cache) g_wb_cache_nodes = TAILQ_HEAD_INITIALIZER(g_wb_cache_nodes);
+
+struct wb_cache_bdev_io {
+	enum spdk_bdev_io_status	status;
+	/* Number of outstanding parts of the I/O, plus one while it's being submitted */
+	uint32_t			remaining;
+	/* For writes, first block that wasn't put in the log yet */
+	uint64_t			next_block;
+	TAILQ_ENTRY(wb_cache_bdev_io)	link;
+	struct wb_cache_req		req;
+};
+
+static int vbdev_wb_cache_init(void);
+static int vbdev_wb_cache_get_ctx_size(void);
+static void vbdev_wb_cache_examine(struct spdk_bdev *bdev);
+static void vbdev_wb_cache_finish(void);
+static int vbdev_wb_cache_config_json(struct spdk_json_write_ctx *w);
+
+static struct spdk_bdev_module wb_cache_if = {
+	.name = "wb_cache",
+	.module_init = vbdev_wb_cache_init,
+	.get_ctx_size = vbdev_wb_cache_get_ctx_size,
+	.examine_config = vbdev_wb_cache_examine,
+	.module_fini = vbdev_wb_cache_finish,
+	.config_json = vbdev_wb_cache_config_json
+};
+
+SPDK_BDEV_MODULE_REGISTER(wb_cache, &wb_cache_if)
+
+static void wb_cache_write_continue(struct vbdev_wb_cache *node);
+static void wb_cache_destage(struct vbdev_wb_cache *node);
+static void wb_cache_load_scan(struct vbdev_wb_cache *node);
+static void wb_cache_load_done(struct vbdev_wb_cache *node, int rc);
+static void wb_cache_destruct_done(struct vbdev_wb_cache *node);
+static void vbdev_wb_cache_free_association(struct bdev_association *assoc);
+
+static int
+wb_cache_extent_cmp(struct wb_cache_extent *ext1, struct wb_cache_extent *ext2)
+{
+	return ext1->base_offset < ext2->base_offset ? -1 : ext1->base_offset > ext2->base_offset;
+}
+
+RB_GENERATE_STATIC(wb_cache_extent_tree, wb_cache_extent, node, wb_cache_extent_cmp);
+
+static void
+_wb_cache_req_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct wb_cache_req *req = cb_arg;
+
+	spdk_bdev_free_io(bdev_io);
+	req->cb_fn(req, success);
+}
+
+static void
+wb_cache_req_submit(void *arg)
+{
+	struct wb_cache_req *req = arg;
+	int rc;
+
+	switch (req->type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+		rc = spdk_bdev_readv_blocks(req->desc, req->ch, req->iovs, req->iovcnt,
+					    req->offset_blocks, req->num_blocks,
+					    _wb_cache_req_done, req);
+		break;
+	case SPDK_BDEV_IO_TYPE_WRITE:
+		rc = spdk_bdev_writev_blocks(req->desc, req->ch, req->iovs, req->iovcnt,
+					     req->offset_blocks, req->num_blocks,
+					     _wb_cache_req_done, req);
+		break;
+	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
+		rc = spdk_bdev_write_zeroes_blocks(req->desc, req->ch, req->offset_blocks,
+						   req->num_blocks, _wb_cache_req_done, req);
+		break;
+	case SPDK_BDEV_IO_TYPE_UNMAP:
+		rc = spdk_bdev_unmap_blocks(req->desc, req->ch, req->offset_blocks,
+					    req->num_blocks, _wb_cache_req_done, req);
+		break;
+	case SPDK_BDEV_IO_TYPE_FLUSH:
+		rc = spdk_bdev_flush_blocks(req->desc, req->ch, req->offset_blocks,
+					    req->num_blocks, _wb_cache_req_done, req);
+		break;
+	case SPDK_BDEV_IO_TYPE_RESET:
+		rc = spdk_bdev_reset(req->desc, req->ch, _wb_cache_req_done, req);
+		break;
+	default:
+		assert(false);
+		rc = -EINVAL;
+		break;
+	}
+
+	if (rc == -ENOMEM) {
+		req->bdev_io_wait.bdev = spdk_bdev_desc_get_bdev(req->desc);
+		req->bdev_io_wait.cb_fn = wb_cache_req_submit;
+		req->bdev_io_wait.cb_arg = req;
+		rc = spdk_bdev_queue_io_wait(req->bdev_io_wait.bdev, req->ch, &req->bdev_io_wait);
+	}
+
+	if (rc != 0) {
+		SPDK_ERRLOG("Failed to submit I/O to %s: %s\n",
+			    spdk_bdev_get_name(spdk_bdev_desc_get_bdev(req->desc)), spdk_strerror(-rc));
+		req->cb_fn(req, false);
+	}
+}
+
+static void
+wb_cache_req_init(struct wb_cache_req *req, struct spdk_bdev_desc *desc,
+		  struct spdk_io_channel *ch, enum spdk_bdev_io_type type,
+		  uint64_t offset_blocks, uint64_t num_blocks, wb_cache_req_cb cb_fn, void *cb_arg)
+{
+	req->desc = desc;
+	req->ch = ch;
+	req->type = type;
+	req->offset_blocks = offset_blocks;
+	req->num_blocks = num_blocks;
+	req->cb_fn = cb_fn;
+	req->cb_arg = cb_arg;
+}
+
+/* Point dst at len bytes of src, starting offset bytes in. Returns the number of iovs used. */
+static int
+wb_cache_iov_slice(struct iovec *dst, const struct iovec *src, int srccnt, size_t offset,
+		   size_t len)
+{
+	int i, dstcnt = 0;
+	size_t n;
+
+	for (i = 0; i < srccnt && len > 0; i++) {
+		if (offset >= src[i].iov_len) {
+			offset -= src[i].iov_len;
+			continue;
+		}
+
+		n = spdk_min(src[i].iov_len - offset, len);
+		dst[dstcnt].iov_base = (uint8_t *)src[i].iov_base + offset;
+		dst[dstcnt].iov_len = n;
+		dstcnt++;
+		len -= n;
+		offset = 0;
+	}
+
+	return dstcnt;
+}
+
+static void
+_wb_cache_io_complete(void *ctx)
+{
+	struct spdk_bdev_io *bdev_io = ctx;
+	struct wb_cache_bdev_io *io_ctx = (struct wb_cache_bdev_io *)bdev_io->driver_ctx;
+
+	spdk_bdev_io_complete(bdev_io, io_ctx->status);
+}
+
+/* Complete the I/O on the thread it was submitted on. */
+static void
+wb_cache_io_complete(struct spdk_bdev_io *bdev_io, enum spdk_bdev_io_status status)
+{
+	struct wb_cache_bdev_io *io_ctx = (struct wb_cache_bdev_io *)bdev_io->driver_ctx;
+	struct spdk_thread *thread = spdk_bdev_io_get_thread(bdev_io);
+
+	io_ctx->status = status;
+	if (thread == spdk_get_thread()) {
+		_wb_cache_io_complete(bdev_io);
+	} else {
+		spdk_thread_send_msg(thread, _wb_cache_io_complete, bdev_io);
+	}
+}
+
+/* Release one part of the I/O, completing it when it was the last one. */
+static void
+wb_cache_io_put(struct spdk_bdev_io *bdev_io, bool success)
+{
+	struct wb_cache_bdev_io *io_ctx = (struct wb_cache_bdev_io *)bdev_io->driver_ctx;
+
+	if (!success) {
+		io_ctx->status = SPDK_BDEV_IO_STATUS_FAILED;
+	}
+
+	assert(io_ctx->remaining > 0);
+	if (--io_ctx->remaining == 0) {
+		wb_cache_io_complete(bdev_io, io_ctx->status);
+	}
+}
+
+/* Find the first extent ending after offset_blocks. */
+static struct wb_cache_extent *
+wb_cache_extent_find(struct vbdev_wb_cache *node, uint64_t offset_blocks)
+{
+	struct wb_cache_extent find = { .base_offset = offset_blocks };
+	struct wb_cache_extent *ext, *prev;
+
+	ext = RB_NFIND(wb_cache_extent_tree, &node->extents, &find);
+	prev = ext ? RB_PREV(wb_cache_extent_tree, &node->extents, ext) :
+	       RB_MAX(wb_cache_extent_tree, &node->extents);
+	if (prev != NULL && prev->base_offset + prev->num_blocks > offset_blocks) {
+		return prev;
+	}
+
+	return ext;
+}
+
+static void
+wb_cache_extent_free(struct vbdev_wb_cache *node, struct wb_cache_extent *ext)
+{
+	RB_REMOVE(wb_cache_extent_tree, &node->extents, ext);
+	TAILQ_REMOVE(&ext->entry->extents, ext, link);
+	free(ext);
+}
+
+static void
+wb_cache_extent_add(struct vbdev_wb_cache *node, struct wb_cache_extent *ext,
+		    struct wb_cache_entry *entry, uint64_t base_offset, uint64_t num_blocks,
+		    uint64_t cache_offset)
+{
+	ext->base_offset = base_offset;
+	ext->num_blocks = num_blocks;
+	ext->cache_offset = cache_offset;
+	ext->entry = entry;
+	RB_INSERT(wb_cache_extent_tree, &node->extents, ext);
+	TAILQ_INSERT_TAIL(&entry->extents, ext, link);
+}
+
+/*
+ * Remove a range from the map. If owner is set, only the extents of that entry are
+ * removed. Splitting an extent in two needs the spare extent, which is consumed then.
+ */
+static void
+wb_cache_map_remove(struct vbdev_wb_cache *node, uint64_t offset_blocks, uint64_t num_blocks,
+		    struct wb_cache_entry *owner, struct wb_cache_extent **spare)
+{
+	uint64_t end = offset_blocks + num_blocks, ext_end;
+	struct wb_cache_extent *ext, *next;
+
+	ext = wb_cache_extent_find(node, offset_blocks);
+	while (ext != NULL && ext->base_offset < end) {
+		next = RB_NEXT(wb_cache_extent_tree, &node->extents, ext);
+		ext_end = ext->base_offset + ext->num_blocks;
+
+		if (owner != NULL && ext->entry != owner) {
+			ext = next;
+			continue;
+		}
+
+		if (ext->base_offset < offset_blocks) {
+			if (ext_end > end) {
+				assert(spare != NULL && *spare != NULL);
+				wb_cache_extent_add(node, *spare, ext->entry, end, ext_end - end,
+						    ext->cache_offset + (end - ext->base_offset));
+				*spare = NULL;
+			}
+			ext->num_blocks = offset_blocks - ext->base_offset;
+		} else if (ext_end > end) {
+			/* The order of the extents doesn't change, so the key can be updated in place */
+			ext->cache_offset += end - ext->base_offset;
+			ext->num_blocks = ext_end - end;
+			ext->base_offset = end;
+		} else {
+			wb_cache_extent_free(node, ext);
+		}
+
+		ext = next;
+	}
+}
+
+/* Make the map point at an acknowledged entry's data. */
+static int
+wb_cache_map_insert(struct vbdev_wb_cache *node, struct wb_cache_entry *entry)
+{
+	struct wb_cache_extent *ext, *spare;
+
+	ext = calloc(1, sizeof(*ext));
+	spare = calloc(1, sizeof(*spare));
+	if (ext == NULL || spare == NULL) {
+		free(ext);
+		free(spare);
+		return -ENOMEM;
+	}
+
+	wb_cache_map_remove(node, entry->base_offset, entry->num_blocks, NULL, &spare);
+	wb_cache_extent_add(node, ext, entry, entry->base_offset, entry->num_blocks,
+			    entry->offset + 1);
+	free(spare);
+
+	return 0;
+}
+
+/* Reserve space for an entry at the tail of the log. */
+static bool
+wb_cache_log_alloc(struct vbdev_wb_cache *node, uint64_t num_blocks, uint64_t *offset,
+		   uint64_t *log_blocks)
+{
+	uint64_t free_blocks = node->log_blocks - node->used_blocks;
+
+	if (node->tail + num_blocks <= node->log_blocks) {
+		if (num_blocks > free_blocks) {
+			return false;
+		}
+		*offset = node->tail;
+		*log_blocks = num_blocks;
+	} else {
+		/* Skip the end of the log and wrap around */
+		if (num_blocks + node->log_blocks - node->tail > free_blocks) {
+			return false;
+		}
+		*offset = 0;
+		*log_blocks = num_blocks + node->log_blocks - node->tail;
+	}
+
+	node->tail = *offset + num_blocks;
+	node->used_blocks += *log_blocks;
+
+	return true;
+}
+
+/*
+ * Returns -EAGAIN if the log has no room for the entry until it gets destaged, or -ENOMEM if
+ * the entry can't be allocated.
+ */
+static int
+wb_cache_entry_alloc(struct vbdev_wb_cache *node, enum wb_cache_entry_type type,
+		     uint64_t base_offset, uint64_t num_blocks, int iovcnt,
+		     struct wb_cache_entry **_entry)
+{
+	struct wb_cache_entry *entry;
+	uint64_t data_blocks = type == WB_CACHE_ENTRY_DATA ? num_blocks : 0;
+
+	if (node->num_free_hdrs == 0) {
+		return -EAGAIN;
+	}
+
+	entry = calloc(1, sizeof(*entry) + (iovcnt + 1) * sizeof(struct iovec));
+	if (entry == NULL) {
+		return -ENOMEM;
+	}
+
+	if (!wb_cache_log_alloc(node, 1 + data_blocks, &entry->offset, &entry->log_blocks)) {
+		free(entry);
+		return -EAGAIN;
+	}
+
+	entry->hdr = node->free_hdrs[--node->num_free_hdrs];
+	entry->seq = node->next_seq++;
+	entry->base_offset = base_offset;
+	entry->num_blocks = num_blocks;
+	entry->type = type;
+	entry->state = WB_CACHE_ENTRY_WRITING;
+	TAILQ_INIT(&entry->extents);
+	TAILQ_INSERT_TAIL(&node->entries, entry, link);
+	if (node->ack_next == NULL) {
+		node->ack_next = entry;
+	}
+
+	*_entry = entry;
+	return 0;
+}
+
+static void
+wb_cache_entry_hdr_init(struct vbdev_wb_cache *node, struct wb_cache_entry *entry,
+			uint64_t log_blocks)
+{
+	struct wb_cache_entry_hdr *hdr = entry->hdr;
+
+	memset(hdr, 0, node->cache_bdev->blocklen);
+	hdr->magic = WB_CACHE_ENTRY_MAGIC;
+	hdr->nonce = node->nonce;
+	hdr->seq = entry->seq;
+	hdr->base_offset = entry->base_offset;
+	hdr->num_blocks = entry->num_blocks;
+	hdr->log_blocks = log_blocks;
+	hdr->type = entry->type;
+	if (entry->type == WB_CACHE_ENTRY_DATA) {
+		hdr->data_crc = spdk_crc32c_iov_update(&entry->iovs[1], entry->iovcnt - 1, ~0u);
+	}
+	hdr->crc = spdk_crc32c_update(hdr, sizeof(*hdr), ~0u);
+}
+
+/* Acknowledge the entries that were written, in log order. */
+static void
+wb_cache_entries_ack(struct vbdev_wb_cache *node)
+{
+	struct wb_cache_entry *entry;
+	bool success;
+
+	while ((entry = node->ack_next) != NULL && entry->state != WB_CACHE_ENTRY_WRITING) {
+		node->ack_next = TAILQ_NEXT(entry, link);
+
+		if (entry->state == WB_CACHE_ENTRY_BROKEN && !node->failed) {
+			SPDK_ERRLOG("Log of %s is broken, failing all further writes\n",
+				    node->wb_bdev.name);
+			node->failed = true;
+		}
+
+		success = entry->state == WB_CACHE_ENTRY_WRITTEN && !node->failed;
+		if (success && wb_cache_map_insert(node, entry) != 0) {
+			SPDK_ERRLOG("Failed to allocate map extent\n");
+			success = false;
+		}
+
+		entry->state = WB_CACHE_ENTRY_DIRTY;
+		node->free_hdrs[node->num_free_hdrs++] = entry->hdr;
+		entry->hdr = NULL;
+		wb_cache_io_put(entry->bdev_io, success);
+		entry->bdev_io = NULL;
+	}
+
+	wb_cache_write_continue(node);
+}
+
+static void
+wb_cache_entry_write_done(struct wb_cache_req *req, bool success)
+{
+	struct wb_cache_entry *entry = SPDK_CONTAINEROF(req, struct wb_cache_entry, req);
+	struct vbdev_wb_cache *node = req->cb_arg;
+
+	if (success) {
+		entry->state = entry->type == WB_CACHE_ENTRY_HOLE ? WB_CACHE_ENTRY_FAILED :
+			       WB_CACHE_ENTRY_WRITTEN;
+	} else if (entry->type != WB_CACHE_ENTRY_HOLE) {
+		/* Replace the entry with a hole, so that the entries following it can be found
+		 * when the log is scanned. */
+		SPDK_ERRLOG("Failed to write log entry %" PRIu64 " of %s\n", entry->seq,
+			    node->wb_bdev.name);
+		entry->type = WB_CACHE_ENTRY_HOLE;
+		entry->num_blocks = 0;
+		wb_cache_entry_hdr_init(node, entry, req->num_blocks);
+		req->iovcnt = 1;
+		req->num_blocks = 1;
+		wb_cache_req_submit(req);
+		return;
+	} else {
+		entry->state = WB_CACHE_ENTRY_BROKEN;
+	}
+
+	wb_cache_entries_ack(node);
+}
+
+static void
+wb_cache_entry_write(struct vbdev_wb_cache *node, struct wb_cache_entry *entry)
+{
+	entry->iovs[0].iov_base = entry->hdr;
+	entry->iovs[0].iov_len = node->cache_bdev->blocklen;
+	wb_cache_entry_hdr_init(node, entry,
+				1 + (entry->type == WB_CACHE_ENTRY_DATA ? entry->num_blocks : 0));
+
+	entry->req.iovs = entry->iovs;
+	entry->req.iovcnt = entry->iovcnt;
+	wb_cache_req_init(&entry->req, node->cache_desc, node->cache_ch, SPDK_BDEV_IO_TYPE_WRITE,
+			  WB_CACHE_LOG_OFFSET + entry->offset, entry->hdr->log_blocks,
+			  wb_cache_entry_write_done, node);
+	wb_cache_req_submit(&entry->req);
+}
+
+/* Put the next part of a write in the log. */
+static int
+wb_cache_write_chunk(struct vbdev_wb_cache *node, struct spdk_bdev_io *bdev_io)
+{
+	struct wb_cache_bdev_io *io_ctx = (struct wb_cache_bdev_io *)bdev_io->driver_ctx;
+	uint64_t num_blocks = bdev_io->u.bdev.offset_blocks + bdev_io->u.bdev.num_blocks -
+			      io_ctx->next_block;
+	uint32_t blocklen = node->wb_bdev.blocklen;
+	enum wb_cache_entry_type type;
+	struct wb_cache_entry *entry;
+	int rc;
+
+	switch (bdev_io->type) {
+	case SPDK_BDEV_IO_TYPE_WRITE:
+		type = WB_CACHE_ENTRY_DATA;
+		num_blocks = spdk_min(num_blocks, node->max_entry_blocks);
+		break;
+	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
+		type = WB_CACHE_ENTRY_ZEROES;
+		break;
+	case SPDK_BDEV_IO_TYPE_UNMAP:
+		type = WB_CACHE_ENTRY_UNMAP;
+		break;
+	default:
+		assert(false);
+		return -EINVAL;
+	}
+
+	rc = wb_cache_entry_alloc(node, type, io_ctx->next_block, num_blocks,
+				  type == WB_CACHE_ENTRY_DATA ? bdev_io->u.bdev.iovcnt : 0, &entry);
+	if (rc != 0) {
+		return rc;
+	}
+
+	entry->iovcnt = 1;
+	if (type == WB_CACHE_ENTRY_DATA) {
+		entry->iovcnt += wb_cache_iov_slice(&entry->iovs[1], bdev_io->u.bdev.iovs,
+						    bdev_io->u.bdev.iovcnt,
+						    (io_ctx->next_block - bdev_io->u.bdev.offset_blocks) * blocklen,
+						    num_blocks * blocklen);
+	}
+
+	entry->bdev_io = bdev_io;
+	io_ctx->next_block += num_blocks;
+	io_ctx->remaining++;
+	node->writes_since_poll++;
+	wb_cache_entry_write(node, entry);
+
+	return 0;
+}
+
+/* Put the pending writes in the log, as long as there's space for them. */
+static void
+wb_cache_write_continue(struct vbdev_wb_cache *node)
+{
+	struct wb_cache_bdev_io *io_ctx;
+	struct spdk_bdev_io *bdev_io;
+	int rc;
+
+	/* Writes failing right away get here again through the acknowledgement */
+	if (node->writes_continuing) {
+		return;
+	}
+
+	node->writes_continuing = true;
+	while ((io_ctx = TAILQ_FIRST(&node->pending_writes)) != NULL) {
+		bdev_io = spdk_bdev_io_from_ctx(io_ctx);
+
+		while (io_ctx->next_block < bdev_io->u.bdev.offset_blocks + bdev_io->u.bdev.num_blocks) {
+			if (node->failed) {
+				io_ctx->status = SPDK_BDEV_IO_STATUS_FAILED;
+				break;
+			}
+
+			rc = wb_cache_write_chunk(node, bdev_io);
+			if (rc == -EAGAIN) {
+				/* Wait for the log to be destaged */
+				node->writes_continuing = false;
+				wb_cache_destage(node);
+				return;
+			} else if (rc != 0) {
+				/* Nothing might be in flight to retry it on, so fail the rest of the write */
+				io_ctx->status = SPDK_BDEV_IO_STATUS_FAILED;
+				break;
+			}
+		}
+
+		TAILQ_REMOVE(&node->pending_writes, io_ctx, link);
+		wb_cache_io_put(bdev_io, true);
+	}
+	node->writes_continuing = false;
+}
+
+static void
+wb_cache_write(struct vbdev_wb_cache *node, struct spdk_bdev_io *bdev_io)
+{
+	struct wb_cache_bdev_io *io_ctx = (struct wb_cache_bdev_io *)bdev_io->driver_ctx;
+
+	if (spdk_unlikely(node->failed)) {
+		wb_cache_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		return;
+	}
+
+	io_ctx->next_block = bdev_io->u.bdev.offset_blocks;
+	TAILQ_INSERT_TAIL(&node->pending_writes, io_ctx, link);
+	if (TAILQ_FIRST(&node->pending_writes) == io_ctx) {
+		wb_cache_write_continue(node);
+	}
+}
+
+static void
+wb_cache_reclaim(struct vbdev_wb_cache *node)
+{
+	struct wb_cache_entry *entry;
+	bool reclaimed = false;
+
+	while ((entry = TAILQ_FIRST(&node->entries)) != NULL) {
+		if (entry->state != WB_CACHE_ENTRY_CLEAN || entry->seq >= node->persisted_seq ||
+		    entry->num_reads > 0) {
+			break;
+		}
+
+		TAILQ_REMOVE(&node->entries, entry, link);
+		node->used_blocks -= entry->log_blocks;
+		free(entry);
+		reclaimed = true;
+	}
+
+	if (reclaimed) {
+		wb_cache_write_continue(node);
+	}
+}
+
+struct wb_cache_read_piece {
+	struct spdk_bdev_io		*bdev_io;
+	struct wb_cache_entry		*entry;
+	struct wb_cache_req		req;
+	struct iovec			iovs[];
+};
+
+static void
+wb_cache_read_piece_done(struct wb_cache_req *req, bool success)
+{
+	struct wb_cache_read_piece *piece = req->cb_arg;
+	struct spdk_bdev_io *bdev_io = piece->bdev_io;
+	struct vbdev_wb_cache *node = SPDK_CONTAINEROF(bdev_io->bdev, struct vbdev_wb_cache,
+				      wb_bdev);
+
+	if (piece->entry != NULL) {
+		assert(piece->entry->num_reads > 0);
+		if (--piece->entry->num_reads == 0 && piece->entry->state == WB_CACHE_ENTRY_CLEAN) {
+			wb_cache_reclaim(node);
+		}
+	}
+
+	free(piece);
+	wb_cache_io_put(bdev_io, success);
+}
+
+static void
+wb_cache_read_piece(struct vbdev_wb_cache *node, struct spdk_bdev_io *bdev_io,
+		    uint64_t offset_blocks, uint64_t num_blocks, struct wb_cache_extent *ext)
+{
+	struct wb_cache_bdev_io *io_ctx = (struct wb_cache_bdev_io *)bdev_io->driver_ctx;
+	uint32_t blocklen = node->wb_bdev.blocklen;
+	struct wb_cache_read_piece *piece;
+	struct iovec *iovs = bdev_io->u.bdev.iovs;
+	int iovcnt = bdev_io->u.bdev.iovcnt;
+	size_t offset = (offset_blocks - bdev_io->u.bdev.offset_blocks) * blocklen;
+
+	piece = calloc(1, sizeof(*piece) + iovcnt * sizeof(struct iovec));
+	if (piece == NULL) {
+		io_ctx->status = SPDK_BDEV_IO_STATUS_FAILED;
+		return;
+	}
+
+	piece->bdev_io = bdev_io;
+	piece->req.iovs = piece->iovs;
+	piece->req.iovcnt = wb_cache_iov_slice(piece->iovs, iovs, iovcnt, offset,
+					       num_blocks * blocklen);
+
+	if (ext == NULL) {
+		wb_cache_req_init(&piece->req, node->base_desc, node->base_ch, SPDK_BDEV_IO_TYPE_READ,
+				  offset_blocks, num_blocks, wb_cache_read_piece_done, piece);
+	} else if (ext->entry->type == WB_CACHE_ENTRY_DATA) {
+		piece->entry = ext->entry;
+		piece->entry->num_reads++;
+		wb_cache_req_init(&piece->req, node->cache_desc, node->cache_ch, SPDK_BDEV_IO_TYPE_READ,
+				  WB_CACHE_LOG_OFFSET + ext->cache_offset + offset_blocks - ext->base_offset,
+				  num_blocks, wb_cache_read_piece_done, piece);
+	} else {
+		/* Zeroed or unmapped range */
+		spdk_iov_memset(piece->req.iovs, piece->req.iovcnt, 0);
+		free(piece);
+		return;
+	}
+
+	io_ctx->remaining++;
+	wb_cache_req_submit(&piece->req);
+}
+
+static void
+wb_cache_read_done(struct wb_cache_req *req, bool success)
+{
+	wb_cache_io_put(req->cb_arg, success);
+}
+
+static void
+wb_cache_read(struct vbdev_wb_cache *node, struct spdk_bdev_io *bdev_io)
+{
+	struct wb_cache_bdev_io *io_ctx = (struct wb_cache_bdev_io *)bdev_io->driver_ctx;
+	uint64_t offset = bdev_io->u.bdev.offset_blocks;
+	uint64_t end = offset + bdev_io->u.bdev.num_blocks;
+	struct wb_cache_extent *ext;
+	uint64_t piece_end;
+
+	io_ctx->remaining = 1;
+	ext = wb_cache_extent_find(node, offset);
+	if (ext == NULL || ext->base_offset >= end) {
+		/* Nothing cached, read everything from the base bdev */
+		io_ctx->req.iovs = bdev_io->u.bdev.iovs;
+		io_ctx->req.iovcnt = bdev_io->u.bdev.iovcnt;
+		wb_cache_req_init(&io_ctx->req, node->base_desc, node->base_ch, SPDK_BDEV_IO_TYPE_READ,
+				  offset, bdev_io->u.bdev.num_blocks, wb_cache_read_done, bdev_io);
+		wb_cache_req_submit(&io_ctx->req);
+		return;
+	}
+
+	while (offset < end) {
+		if (ext == NULL || ext->base_offset >= end) {
+			wb_cache_read_piece(node, bdev_io, offset, end - offset, NULL);
+			break;
+		}
+
+		if (ext->base_offset > offset) {
+			wb_cache_read_piece(node, bdev_io, offset, ext->base_offset - offset, NULL);
+			offset = ext->base_offset;
+		}
+
+		piece_end = spdk_min(ext->base_offset + ext->num_blocks, end);
+		wb_cache_read_piece(node, bdev_io, offset, piece_end - offset, ext);
+		offset = piece_end;
+		ext = RB_NEXT(wb_cache_extent_tree, &node->extents, ext);
+	}
+
+	wb_cache_io_put(bdev_io, true);
+}
+
+static void
+wb_cache_passthru_done(struct wb_cache_req *req, bool success)
+{
+	wb_cache_io_put(req->cb_arg, success);
+}
+
+static void
+_wb_cache_submit_request(void *ctx)
+{
+	struct spdk_bdev_io *bdev_io = ctx;
+	struct vbdev_wb_cache *node = SPDK_CONTAINEROF(bdev_io->bdev, struct vbdev_wb_cache,
+				      wb_bdev);
+	struct wb_cache_bdev_io *io_ctx = (struct wb_cache_bdev_io *)bdev_io->driver_ctx;
+
+	io_ctx->status = SPDK_BDEV_IO_STATUS_SUCCESS;
+	io_ctx->remaining = 1;
+
+	switch (bdev_io->type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+		wb_cache_read(node, bdev_io);
+		break;
+	case SPDK_BDEV_IO_TYPE_WRITE:
+	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
+	case SPDK_BDEV_IO_TYPE_UNMAP:
+		wb_cache_write(node, bdev_io);
+		break;
+	case SPDK_BDEV_IO_TYPE_FLUSH:
+		/* Acknowledged writes are in the log, make sure the log is persistent */
+		wb_cache_req_init(&io_ctx->req, node->cache_desc, node->cache_ch, SPDK_BDEV_IO_TYPE_FLUSH,
+				  0, node->cache_bdev->blockcnt, wb_cache_passthru_done, bdev_io);
+		wb_cache_req_submit(&io_ctx->req);
+		break;
+	case SPDK_BDEV_IO_TYPE_RESET:
+		wb_cache_req_init(&io_ctx->req, node->base_desc, node->base_ch, SPDK_BDEV_IO_TYPE_RESET,
+				  0, 0, wb_cache_passthru_done, bdev_io);
+		wb_cache_req_submit(&io_ctx->req);
+		break;
+	default:
+		SPDK_ERRLOG("wb_cache: unknown I/O type %d\n", bdev_io->type);
+		wb_cache_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		break;
+	}
+}
+
+static void
+wb_cache_forward_request(struct vbdev_wb_cache *node, struct spdk_bdev_io *bdev_io)
+{
+	if (node->thread == spdk_get_thread()) {
+		_wb_cache_submit_request(bdev_io);
+	} else {
+		spdk_thread_send_msg(node->thread, _wb_cache_submit_request, bdev_io);
+	}
+}
+
+static void
+wb_cache_read_get_buf_cb(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io,
+			 bool success)
+{
+	struct vbdev_wb_cache *node = SPDK_CONTAINEROF(bdev_io->bdev, struct vbdev_wb_cache,
+				      wb_bdev);
+
+	if (!success) {
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		return;
+	}
+
+	wb_cache_forward_request(node, bdev_io);
+}
+
+static void
+vbdev_wb_cache_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io)
+{
+	struct vbdev_wb_cache *node = SPDK_CONTAINEROF(bdev_io->bdev, struct vbdev_wb_cache,
+				      wb_bdev);
+
+	if (bdev_io->type == SPDK_BDEV_IO_TYPE_READ) {
+		spdk_bdev_io_get_buf(bdev_io, wb_cache_read_get_buf_cb,
+				     bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen);
+		return;
+	}
+
+	wb_cache_forward_request(node, bdev_io);
+}
+
+static int
+wb_cache_destage_item_cmp(const void *_item1, const void *_item2)
+{
+	const struct wb_cache_destage_item *item1 = _item1, *item2 = _item2;
+
+	return item1->base_offset < item2->base_offset ? -1 :
+	       item1->base_offset > item2->base_offset;
+}
+
+static void
+wb_cache_destage_done(struct vbdev_wb_cache *node)
+{
+	node->destage.in_progress = false;
+
+	if (node->destructing) {
+		wb_cache_destruct_done(node);
+	} else if (node->loading) {
+		if (node->destage.failed) {
+			wb_cache_load_done(node, -EIO);
+		} else {
+			wb_cache_load_scan(node);
+		}
+	} else if (!TAILQ_EMPTY(&node->pending_writes) && !node->destage.failed) {
+		wb_cache_write_continue(node);
+	}
+}
+
+static void
+wb_cache_destage_sb_done(struct wb_cache_req *req, bool success)
+{
+	struct vbdev_wb_cache *node = req->cb_arg;
+
+	if (!success) {
+		SPDK_ERRLOG("Failed to write superblock of %s\n", node->wb_bdev.name);
+		node->destage.failed = true;
+	} else {
+		node->persisted_seq = node->sb->head_seq;
+		wb_cache_reclaim(node);
+	}
+
+	wb_cache_destage_done(node);
+}
+
+static void
+wb_cache_sb_write(struct vbdev_wb_cache *node, wb_cache_req_cb cb_fn)
+{
+	struct wb_cache_entry *entry;
+
+	TAILQ_FOREACH(entry, &node->entries, link) {
+		if (entry->state != WB_CACHE_ENTRY_CLEAN) {
+			break;
+		}
+	}
+
+	node->sb->head_offset = entry ? entry->offset : node->tail;
+	node->sb->head_seq = entry ? entry->seq : node->next_seq;
+	node->sb->crc = 0;
+	node->sb->crc = spdk_crc32c_update(node->sb, sizeof(*node->sb), ~0u);
+
+	node->sb_iov.iov_base = node->sb;
+	node->sb_iov.iov_len = node->cache_bdev->blocklen;
+	node->sb_req.iovs = &node->sb_iov;
+	node->sb_req.iovcnt = 1;
+	wb_cache_req_init(&node->sb_req, node->cache_desc, node->cache_ch, SPDK_BDEV_IO_TYPE_WRITE,
+			  0, 1, cb_fn, node);
+	wb_cache_req_submit(&node->sb_req);
+}
+
+/* The batch is on the base bdev, drop it from the map and move the head of the log. */
+static void
+wb_cache_destage_finish(struct vbdev_wb_cache *node)
+{
+	struct wb_cache_destage *destage = &node->destage;
+	struct wb_cache_destage_item *item;
+	struct wb_cache_entry *entry;
+	uint32_t i;
+
+	for (i = 0; i < destage->num_items; i++) {
+		item = &destage->items[i];
+		wb_cache_map_remove(node, item->base_offset, item->num_blocks, item->entry, NULL);
+	}
+
+	TAILQ_FOREACH(entry, &node->entries, link) {
+		if (entry->state == WB_CACHE_ENTRY_CLEAN) {
+			continue;
+		}
+		if (entry->state != WB_CACHE_ENTRY_DIRTY || !TAILQ_EMPTY(&entry->extents)) {
+			break;
+		}
+		entry->state = WB_CACHE_ENTRY_CLEAN;
+	}
+
+	if ((entry ? entry->seq : node->next_seq) == node->persisted_seq) {
+		/* Nothing was destaged */
+		wb_cache_destage_done(node);
+		return;
+	}
+
+	wb_cache_sb_write(node, wb_cache_destage_sb_done);
+}
+
+static void
+wb_cache_destage_flush_done(struct wb_cache_req *req, bool success)
+{
+	struct vbdev_wb_cache *node = req->cb_arg;
+
+	if (!success) {
+		SPDK_ERRLOG("Failed to flush %s\n", node->base_bdev->name);
+		node->destage.failed = true;
+		wb_cache_destage_done(node);
+		return;
+	}
+
+	wb_cache_destage_finish(node);
+}
+
+static void
+wb_cache_destage_put(struct vbdev_wb_cache *node, bool success,
+		     void (*next_fn)(struct vbdev_wb_cache *node))
+{
+	struct wb_cache_destage *destage = &node->destage;
+
+	if (!success) {
+		destage->failed = true;
+	}
+
+	assert(destage->remaining > 0);
+	if (--destage->remaining > 0) {
+		return;
+	}
+
+	if (destage->failed) {
+		SPDK_ERRLOG("Failed to destage %s\n", node->wb_bdev.name);
+		wb_cache_destage_done(node);
+		return;
+	}
+
+	next_fn(node);
+}
+
+static void
+wb_cache_destage_flush(struct vbdev_wb_cache *node)
+{
+	struct wb_cache_destage *destage = &node->destage;
+
+	if (!spdk_bdev_io_type_supported(node->base_bdev, SPDK_BDEV_IO_TYPE_FLUSH)) {
+		wb_cache_destage_finish(node);
+		return;
+	}
+
+	wb_cache_req_init(&destage->req, node->base_desc, node->base_ch, SPDK_BDEV_IO_TYPE_FLUSH,
+			  0, node->base_bdev->blockcnt, wb_cache_destage_flush_done, node);
+	wb_cache_req_submit(&destage->req);
+}
+
+static void
+wb_cache_destage_write_done(struct wb_cache_req *req, bool success)
+{
+	wb_cache_destage_put(req->cb_arg, success, wb_cache_destage_flush);
+}
+
+/* Write the batch to the base bdev in LBA order, merging adjacent items. */
+static void
+wb_cache_destage_write(struct vbdev_wb_cache *node)
+{
+	struct wb_cache_destage *destage = &node->destage;
+	struct wb_cache_destage_item *item, *next;
+	enum spdk_bdev_io_type type;
+	uint32_t i;
+
+	destage->remaining = 1;
+	for (i = 0; i < destage->num_items; i++) {
+		item = &destage->items[i];
+		switch (item->entry->type) {
+		case WB_CACHE_ENTRY_DATA:
+			type = SPDK_BDEV_IO_TYPE_WRITE;
+			break;
+		case WB_CACHE_ENTRY_ZEROES:
+			type = SPDK_BDEV_IO_TYPE_WRITE_ZEROES;
+			break;
+		case WB_CACHE_ENTRY_UNMAP:
+			type = SPDK_BDEV_IO_TYPE_UNMAP;
+			break;
+		default:
+			assert(false);
+			continue;
+		}
+
+		item->req.iovs = &item->iov;
+		item->req.iovcnt = 1;
+		wb_cache_req_init(&item->req, node->base_desc, node->base_ch, type,
+				  item->base_offset, item->num_blocks, wb_cache_destage_write_done, node);
+
+		/* Items are laid out in the buffer in LBA order, so adjacent ones are contiguous */
+		while (type == SPDK_BDEV_IO_TYPE_WRITE && i + 1 < destage->num_items) {
+			next = &destage->items[i + 1];
+			if (next->entry->type != WB_CACHE_ENTRY_DATA ||
+			    next->base_offset != item->base_offset + item->req.num_blocks) {
+				break;
+			}
+			item->req.num_blocks += next->num_blocks;
+			item->iov.iov_len += next->iov.iov_len;
+			i++;
+		}
+
+		destage->remaining++;
+		wb_cache_req_submit(&item->req);
+	}
+
+	wb_cache_destage_put(node, true, wb_cache_destage_flush);
+}
+
+static void
+wb_cache_destage_read_done(struct wb_cache_req *req, bool success)
+{
+	wb_cache_destage_put(req->cb_arg, success, wb_cache_destage_write);
+}
+
+/* Pick the live data of the oldest dirty entries. */
+static void
+wb_cache_destage_collect(struct vbdev_wb_cache *node)
+{
+	struct wb_cache_destage *destage = &node->destage;
+	struct wb_cache_destage_item *item;
+	struct wb_cache_entry *entry;
+	struct wb_cache_extent *ext;
+	uint64_t buf_blocks = 0;
+
+	destage->num_items = 0;
+	TAILQ_FOREACH(entry, &node->entries, link) {
+		if (entry->state == WB_CACHE_ENTRY_CLEAN) {
+			continue;
+		}
+		if (entry->state != WB_CACHE_ENTRY_DIRTY) {
+			break;
+		}
+
+		TAILQ_FOREACH(ext, &entry->extents, link) {
+			if (destage->num_items == WB_CACHE_DESTAGE_MAX_ITEMS ||
+			    (entry->type == WB_CACHE_ENTRY_DATA &&
+			     buf_blocks + ext->num_blocks > destage->buf_blocks)) {
+				return;
+			}
+
+			item = &destage->items[destage->num_items++];
+			item->base_offset = ext->base_offset;
+			item->num_blocks = ext->num_blocks;
+			item->cache_offset = ext->cache_offset;
+			item->entry = entry;
+			if (entry->type == WB_CACHE_ENTRY_DATA) {
+				buf_blocks += ext->num_blocks;
+			}
+		}
+	}
+}
+
+static void
+wb_cache_destage(struct vbdev_wb_cache *node)
+{
+	struct wb_cache_destage *destage = &node->destage;
+	struct wb_cache_destage_item *item;
+	uint32_t blocklen = node->wb_bdev.blocklen;
+	uint8_t *buf = destage->buf;
+	uint32_t i;
+
+	if (destage->in_progress || node->destructing) {
+		return;
+	}
+
+	destage->in_progress = true;
+	destage->failed = false;
+	wb_cache_destage_collect(node);
+	if (destage->num_items == 0) {
+		wb_cache_destage_finish(node);
+		return;
+	}
+
+	qsort(destage->items, destage->num_items, sizeof(*destage->items),
+	      wb_cache_destage_item_cmp);
+
+	destage->remaining = 1;
+	for (i = 0; i < destage->num_items; i++) {
+		item = &destage->items[i];
+		if (item->entry->type != WB_CACHE_ENTRY_DATA) {
+			continue;
+		}
+
+		item->iov.iov_base = buf;
+		item->iov.iov_len = item->num_blocks * blocklen;
+		buf += item->iov.iov_len;
+
+		item->req.iovs = &item->iov;
+		item->req.iovcnt = 1;
+		wb_cache_req_init(&item->req, node->cache_desc, node->cache_ch, SPDK_BDEV_IO_TYPE_READ,
+				  WB_CACHE_LOG_OFFSET + item->cache_offset, item->num_blocks,
+				  wb_cache_destage_read_done, node);
+		destage->remaining++;
+		wb_cache_req_submit(&item->req);
+	}
+
+	wb_cache_destage_put(node, true, wb_cache_destage_write);
+}
+
+static int
+wb_cache_destage_poll(void *arg)
+{
+	struct vbdev_wb_cache *node = arg;
+	bool idle = node->writes_since_poll == 0;
+
+	node->writes_since_poll = 0;
+	if (node->used_blocks == 0 || node->destage.in_progress) {
+		return SPDK_POLLER_IDLE;
+	}
+
+	if (idle || !TAILQ_EMPTY(&node->pending_writes) ||
+	    node->used_blocks * 100 >= node->log_blocks * WB_CACHE_DESTAGE_THRESHOLD) {
+		wb_cache_destage(node);
+		return SPDK_POLLER_BUSY;
+	}
+
+	return SPDK_POLLER_IDLE;
+}
+
+static bool
+vbdev_wb_cache_io_type_supported(void *ctx, enum spdk_bdev_io_type io_type)
+{
+	struct vbdev_wb_cache *node = (struct vbdev_wb_cache *)ctx;
+
+	switch (io_type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+	case SPDK_BDEV_IO_TYPE_WRITE:
+	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
+	case SPDK_BDEV_IO_TYPE_FLUSH:
+	case SPDK_BDEV_IO_TYPE_RESET:
+		return true;
+	case SPDK_BDEV_IO_TYPE_UNMAP:
+		return spdk_bdev_io_type_supported(node->base_bdev, io_type);
+	default:
+		return false;
+	}
+}
+
+static int
+wb_cache_ch_create_cb(void *io_device, void *ctx_buf)
+{
+	return 0;
+}
+
+static void
+wb_cache_ch_destroy_cb(void *io_device, void *ctx_buf)
+{
+}
+
+static struct spdk_io_channel *
+vbdev_wb_cache_get_io_channel(void *ctx)
+{
+	struct vbdev_wb_cache *node = (struct vbdev_wb_cache *)ctx;
+
+	return spdk_get_io_channel(node);
+}
+
+static void
+_wb_cache_write_conf_values(struct vbdev_wb_cache *node, struct spdk_json_write_ctx *w)
+{
+	spdk_json_write_named_string(w, "name", spdk_bdev_get_name(&node->wb_bdev));
+	spdk_json_write_named_string(w, "base_bdev_name", spdk_bdev_get_name(node->base_bdev));
+	spdk_json_write_named_string(w, "cache_bdev_name", spdk_bdev_get_name(node->cache_bdev));
+}
+
+static int
+vbdev_wb_cache_dump_info_json(void *ctx, struct spdk_json_write_ctx *w)
+{
+	struct vbdev_wb_cache *node = (struct vbdev_wb_cache *)ctx;
+
+	spdk_json_write_name(w, "wb_cache");
+	spdk_json_write_object_begin(w);
+	_wb_cache_write_conf_values(node, w);
+	spdk_json_write_named_uint64(w, "log_blocks", node->log_blocks);
+	spdk_json_write_named_uint64(w, "used_blocks", node->used_blocks);
+	spdk_json_write_named_bool(w, "failed", node->failed);
+	spdk_json_write_object_end(w);
+
+	return 0;
+}
+
+/* This is used to generate JSON that can configure this module to its current state. */
+static int
+vbdev_wb_cache_config_json(struct spdk_json_write_ctx *w)
+{
+	struct vbdev_wb_cache *node;
+
+	TAILQ_FOREACH(node, &g_wb_cache_nodes, link) {
+		spdk_json_write_object_begin(w);
+		spdk_json_write_named_string(w, "method", "bdev_wb_cache_create");
+		spdk_json_write_named_object_begin(w, "params");
+		_wb_cache_write_conf_values(node, w);
+		spdk_json_write_named_uuid(w, "uuid", &node->wb_bdev.uuid);
+		spdk_json_write_object_end(w);
+		spdk_json_write_object_end(w);
+	}
+	return 0;
+}
+
+static void
+vbdev_wb_cache_write_config_json(struct spdk_bdev *bdev, struct spdk_json_write_ctx *w)
+{
+	/* No config per bdev needed */
+}
+
+static void
+_device_unregister_cb(void *io_device)
+{
+	struct vbdev_wb_cache *node = io_device;
+	struct wb_cache_entry *entry;
+	struct wb_cache_extent *ext, *tmp;
+
+	RB_FOREACH_SAFE(ext, wb_cache_extent_tree, &node->extents, tmp) {
+		wb_cache_extent_free(node, ext);
+	}
+
+	while ((entry = TAILQ_FIRST(&node->entries)) != NULL) {
+		TAILQ_REMOVE(&node->entries, entry, link);
+		free(entry);
+	}
+
+	spdk_free(node->hdr_bufs);
+	spdk_free(node->destage.buf);
+	spdk_free(node->sb);
+	free(node->free_hdrs);
+	free(node->destage.items);
+	free(node->wb_bdev.name);
+	free(node);
+}
+
+/* Release everything acquired when the bdev was created. */
+static void
+wb_cache_node_free(struct vbdev_wb_cache *node)
+{
+	spdk_poller_unregister(&node->destage_poller);
+
+	if (node->base_ch != NULL) {
+		spdk_put_io_channel(node->base_ch);
+	}
+	if (node->cache_ch != NULL) {
+		spdk_put_io_channel(node->cache_ch);
+	}
+	if (node->base_desc != NULL) {
+		spdk_bdev_module_release_bdev(node->base_bdev);
+		spdk_bdev_close(node->base_desc);
+	}
+	if (node->cache_desc != NULL) {
+		spdk_bdev_module_release_bdev(node->cache_bdev);
+		spdk_bdev_close(node->cache_desc);
+	}
+	if (node->assoc != NULL) {
+		node->assoc->active = false;
+	}
+
+	spdk_io_device_unregister(node, _device_unregister_cb);
+}
+
+static void
+wb_cache_destruct_done(struct vbdev_wb_cache *node)
+{
+	struct spdk_bdev *bdev = &node->wb_bdev;
+
+	wb_cache_node_free(node);
+	spdk_bdev_destruct_done(bdev, 0);
+}
+
+static void
+_vbdev_wb_cache_destruct(void *ctx)
+{
+	struct vbdev_wb_cache *node = ctx;
+
+	node->destructing = true;
+	if (!node->destage.in_progress) {
+		wb_cache_destruct_done(node);
+	}
+}
+
+static int
+vbdev_wb_cache_destruct(void *ctx)
+{
+	struct vbdev_wb_cache *node = (struct vbdev_wb_cache *)ctx;
+
+	TAILQ_REMOVE(&g_wb_cache_nodes, node, link);
+
+	/* Wait for the destage in progress on the thread owning the cache. */
+	spdk_thread_send_msg(node->thread, _vbdev_wb_cache_destruct, node);
+
+	return 1;
+}
+
+/* When we register our bdev this is how we specify our entry points. */
+static const struct spdk_bdev_fn_table vbdev_wb_cache_fn_table = {
+	.destruct		= vbdev_wb_cache_destruct,
+	.submit_request		= vbdev_wb_cache_submit_request,
+	.io_type_supported	= vbdev_wb_cache_io_type_supported,
+	.get_io_channel		= vbdev_wb_cache_get_io_channel,
+	.dump_info_json		= vbdev_wb_cache_dump_info_json,
+	.write_config_json	= vbdev_wb_cache_write_config_json,
+};
+
+static void
+wb_cache_load_done(struct vbdev_wb_cache *node, int rc)
+{
+	bdev_wb_cache_create_cb cb_fn = node->create_cb;
+	void *cb_arg = node->create_cb_arg;
+	struct bdev_association *assoc;
+
+	node->loading = false;
+	if (rc == 0) {
+		node->destage_poller = SPDK_POLLER_REGISTER(wb_cache_destage_poll, node,
+					WB_CACHE_DESTAGE_PERIOD_US);
+		TAILQ_INSERT_TAIL(&g_wb_cache_nodes, node, link);
+		rc = spdk_bdev_register(&node->wb_bdev);
+		if (rc != 0) {
+			SPDK_ERRLOG("could not register write-back cache bdev\n");
+			TAILQ_REMOVE(&g_wb_cache_nodes, node, link);
+		}
+	}
+
+	if (rc != 0) {
+		SPDK_ERRLOG("Failed to create write-back cache bdev %s: %s\n", node->wb_bdev.name,
+			    spdk_strerror(-rc));
+		assoc = node->assoc;
+		wb_cache_node_free(node);
+		if (cb_fn != NULL) {
+			/* Creation was requested directly, don't retry it on examine */
+			vbdev_wb_cache_free_association(assoc);
+		}
+	} else {
+		SPDK_NOTICELOG("Created write-back cache bdev %s on %s with a log of %" PRIu64
+			       " blocks on %s\n", node->wb_bdev.name, node->base_bdev->name,
+			       node->log_blocks, node->cache_bdev->name);
+	}
+
+	if (cb_fn != NULL) {
+		cb_fn(cb_arg, rc);
+	}
+}
+
+static void
+wb_cache_format_done(struct wb_cache_req *req, bool success)
+{
+	struct vbdev_wb_cache *node = req->cb_arg;
+
+	node->persisted_seq = node->next_seq;
+	wb_cache_load_done(node, success ? 0 : -EIO);
+}
+
+/* Start a new, empty log. Entries of previous logs are told apart by their nonce. */
+static void
+wb_cache_format(struct vbdev_wb_cache *node)
+{
+	struct wb_cache_sb *sb = node->sb;
+	struct spdk_uuid nonce;
+
+	assert(TAILQ_EMPTY(&node->entries));
+
+	spdk_uuid_generate(&nonce);
+	memcpy(&node->nonce, &nonce, sizeof(node->nonce));
+	node->tail = 0;
+	node->used_blocks = 0;
+	node->next_seq = 1;
+
+	memset(sb, 0, node->cache_bdev->blocklen);
+	memcpy(sb->magic, WB_CACHE_SB_MAGIC, sizeof(sb->magic));
+	sb->version = WB_CACHE_SB_VERSION;
+	sb->block_size = node->cache_bdev->blocklen;
+	sb->nonce = node->nonce;
+	spdk_uuid_copy(&sb->base_uuid, &node->base_bdev->uuid);
+	sb->log_blocks = node->log_blocks;
+
+	wb_cache_sb_write(node, wb_cache_format_done);
+}
+
+static bool
+wb_cache_entry_hdr_valid(struct vbdev_wb_cache *node, struct wb_cache_entry_hdr *hdr,
+			 uint64_t offset)
+{
+	uint32_t crc = hdr->crc;
+	bool valid;
+
+	if (hdr->magic != WB_CACHE_ENTRY_MAGIC || hdr->nonce != node->nonce ||
+	    hdr->seq != node->next_seq) {
+		return false;
+	}
+
+	hdr->crc = 0;
+	valid = spdk_crc32c_update(hdr, sizeof(*hdr), ~0u) == crc;
+	hdr->crc = crc;
+	if (!valid || hdr->log_blocks == 0 || hdr->log_blocks > 1 + node->max_entry_blocks ||
+	    offset + hdr->log_blocks > node->log_blocks ||
+	    hdr->base_offset + hdr->num_blocks > node->base_bdev->blockcnt) {
+		return false;
+	}
+
+	switch (hdr->type) {
+	case WB_CACHE_ENTRY_DATA:
+		return hdr->log_blocks == 1 + hdr->num_blocks &&
+		       spdk_crc32c_update((uint8_t *)hdr + node->cache_bdev->blocklen,
+					  hdr->num_blocks * node->cache_bdev->blocklen, ~0u) == hdr->data_crc;
+	case WB_CACHE_ENTRY_ZEROES:
+	case WB_CACHE_ENTRY_UNMAP:
+		return hdr->log_blocks == 1;
+	case WB_CACHE_ENTRY_HOLE:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/* Replay the log found on the cache bdev, then start a new one. */
+static void
+wb_cache_load_replay(struct vbdev_wb_cache *node)
+{
+	if (!TAILQ_EMPTY(&node->entries)) {
+		wb_cache_destage(node);
+		return;
+	}
+
+	wb_cache_format(node);
+}
+
+static void
+wb_cache_load_scan_done(struct wb_cache_req *req, bool success)
+{
+	struct vbdev_wb_cache *node = req->cb_arg;
+	struct wb_cache_entry_hdr *hdr = node->destage.buf;
+	struct wb_cache_entry *entry;
+	int rc;
+
+	if (!success) {
+		SPDK_ERRLOG("Failed to read the log of %s\n", node->wb_bdev.name);
+		wb_cache_load_done(node, -EIO);
+		return;
+	}
+
+	if (!wb_cache_entry_hdr_valid(node, hdr, node->scan_offset)) {
+		if (node->scan_offset != 0 && !node->scan_wrapped) {
+			/* The entry may have been written at the start of the log */
+			node->scan_wrapped = true;
+			node->scan_offset = 0;
+			wb_cache_load_scan(node);
+		} else {
+			/* End of the log */
+			SPDK_NOTICELOG("Replaying %" PRIu64 " entries of the log of %s\n",
+				       node->next_seq - node->persisted_seq, node->wb_bdev.name);
+			node->scan_offset = UINT64_MAX;
+			wb_cache_load_replay(node);
+		}
+		return;
+	}
+
+	entry = calloc(1, sizeof(*entry) + sizeof(struct iovec));
+	if (entry == NULL) {
+		wb_cache_load_done(node, -ENOMEM);
+		return;
+	}
+
+	entry->seq = hdr->seq;
+	entry->offset = node->scan_offset;
+	entry->log_blocks = hdr->log_blocks;
+	if (node->scan_wrapped) {
+		entry->log_blocks += node->log_blocks - node->tail;
+	}
+	entry->base_offset = hdr->base_offset;
+	entry->num_blocks = hdr->num_blocks;
+	entry->type = hdr->type;
+	entry->state = WB_CACHE_ENTRY_DIRTY;
+	TAILQ_INIT(&entry->extents);
+	TAILQ_INSERT_TAIL(&node->entries, entry, link);
+
+	node->next_seq++;
+	node->used_blocks += entry->log_blocks;
+	node->tail = node->scan_offset + hdr->log_blocks;
+	node->scan_offset = node->tail;
+	node->scan_wrapped = false;
+
+	if (entry->type != WB_CACHE_ENTRY_HOLE) {
+		rc = wb_cache_map_insert(node, entry);
+		if (rc != 0) {
+			wb_cache_load_done(node, rc);
+			return;
+		}
+	}
+
+	wb_cache_load_scan(node);
+}
+
+static void
+wb_cache_load_scan(struct vbdev_wb_cache *node)
+{
+	if (node->scan_offset == UINT64_MAX) {
+		/* Scan is done, destaging the entries found */
+		wb_cache_load_replay(node);
+		return;
+	}
+
+	if (node->scan_offset >= node->log_blocks) {
+		node->scan_wrapped = true;
+		node->scan_offset = 0;
+	}
+
+	node->scan_iov.iov_base = node->destage.buf;
+	node->scan_iov.iov_len = spdk_min(1 + node->max_entry_blocks,
+					  node->log_blocks - node->scan_offset) * node->cache_bdev->blocklen;
+	node->scan_req.iovs = &node->scan_iov;
+	node->scan_req.iovcnt = 1;
+	wb_cache_req_init(&node->scan_req, node->cache_desc, node->cache_ch, SPDK_BDEV_IO_TYPE_READ,
+			  WB_CACHE_LOG_OFFSET + node->scan_offset,
+			  node->scan_iov.iov_len / node->cache_bdev->blocklen,
+			  wb_cache_load_scan_done, node);
+	wb_cache_req_submit(&node->scan_req);
+}
+
+static void
+wb_cache_load_sb_done(struct wb_cache_req *req, bool success)
+{
+	struct vbdev_wb_cache *node = req->cb_arg;
+	struct wb_cache_sb *sb = node->sb;
+	uint32_t crc = sb->crc;
+
+	if (!success) {
+		SPDK_ERRLOG("Failed to read superblock of %s\n", node->cache_bdev->name);
+		wb_cache_load_done(node, -EIO);
+		return;
+	}
+
+	sb->crc = 0;
+	if (memcmp(sb->magic, WB_CACHE_SB_MAGIC, sizeof(sb->magic)) != 0 ||
+	    spdk_crc32c_update(sb, sizeof(*sb), ~0u) != crc) {
+		SPDK_NOTICELOG("No write-back cache log found on %s, initializing\n",
+			       node->cache_bdev->name);
+		wb_cache_format(node);
+		return;
+	}
+	sb->crc = crc;
+
+	if (sb->version != WB_CACHE_SB_VERSION || sb->block_size != node->cache_bdev->blocklen ||
+	    sb->log_blocks != node->log_blocks || sb->head_offset > node->log_blocks) {
+		SPDK_ERRLOG("Write-back cache log on %s is not compatible\n", node->cache_bdev->name);
+		wb_cache_load_done(node, -EINVAL);
+		return;
+	}
+
+	if (spdk_uuid_compare(&sb->base_uuid, &node->base_bdev->uuid) != 0) {
+		SPDK_ERRLOG("Write-back cache log on %s belongs to a different base bdev\n",
+			    node->cache_bdev->name);
+		wb_cache_load_done(node, -EINVAL);
+		return;
+	}
+
+	node->nonce = sb->nonce;
+	node->next_seq = sb->head_seq;
+	node->persisted_seq = sb->head_seq;
+	node->tail = sb->head_offset;
+	node->scan_offset = sb->head_offset;
+	node->scan_wrapped = false;
+	wb_cache_load_scan(node);
+}
+
+static void
+wb_cache_load(struct vbdev_wb_cache *node)
+{
+	node->loading = true;
+	node->sb_iov.iov_base = node->sb;
+	node->sb_iov.iov_len = node->cache_bdev->blocklen;
+	node->sb_req.iovs = &node->sb_iov;
+	node->sb_req.iovcnt = 1;
+	wb_cache_req_init(&node->sb_req, node->cache_desc, node->cache_ch, SPDK_BDEV_IO_TYPE_READ,
+			  0, 1, wb_cache_load_sb_done, node);
+	wb_cache_req_submit(&node->sb_req);
+}
+
+static void
+vbdev_wb_cache_base_bdev_hotremove_cb(struct spdk_bdev *bdev_find)
+{
+	struct vbdev_wb_cache *node, *tmp;
+
+	TAILQ_FOREACH_SAFE(node, &g_wb_cache_nodes, link, tmp) {
+		if (bdev_find == node->base_bdev || bdev_find == node->cache_bdev) {
+			spdk_bdev_unregister(&node->wb_bdev, NULL, NULL);
+		}
+	}
+}
+
+/* Called when the underlying base or cache bdev triggers asynchronous event such as
+ * bdev removal. */
+static void
+vbdev_wb_cache_base_bdev_event_cb(enum spdk_bdev_event_type type, struct spdk_bdev *bdev,
+				  void *event_ctx)
+{
+	switch (type) {
+	case SPDK_BDEV_EVENT_REMOVE:
+		vbdev_wb_cache_base_bdev_hotremove_cb(bdev);
+		break;
+	default:
+		SPDK_NOTICELOG("Unsupported bdev event: type %d\n", type);
+		break;
+	}
+}
+
+static int
+wb_cache_open_bdev(struct vbdev_wb_cache *node, const char *bdev_name,
+		   struct spdk_bdev_desc **desc, struct spdk_bdev **bdev, struct spdk_io_channel **ch)
+{
+	int rc;
+
+	rc = spdk_bdev_open_ext(bdev_name, true, vbdev_wb_cache_base_bdev_event_cb, NULL, desc);
+	if (rc != 0) {
+		SPDK_ERRLOG("could not open bdev %s\n", bdev_name);
+		*desc = NULL;
+		return rc;
+	}
+
+	*bdev = spdk_bdev_desc_get_bdev(*desc);
+	rc = spdk_bdev_module_claim_bdev(*bdev, *desc, &wb_cache_if);
+	if (rc != 0) {
+		SPDK_ERRLOG("could not claim bdev %s\n", bdev_name);
+		spdk_bdev_close(*desc);
+		*desc = NULL;
+		return rc;
+	}
+
+	*ch = spdk_bdev_get_io_channel(*desc);
+	if (*ch == NULL) {
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
+/* Size the log and allocate the buffers. */
+static int
+wb_cache_init_geometry(struct vbdev_wb_cache *node)
+{
+	uint32_t blocklen = node->cache_bdev->blocklen;
+	uint32_t i;
+
+	if (node->cache_bdev->blocklen != node->base_bdev->blocklen ||
+	    node->base_bdev->md_len != 0 || node->cache_bdev->md_len != 0) {
+		SPDK_ERRLOG("Cache bdev %s must have the block size of %s and no metadata\n",
+			    node->cache_bdev->name, node->base_bdev->name);
+		return -EINVAL;
+	}
+
+	node->log_blocks = node->cache_bdev->blockcnt - WB_CACHE_LOG_OFFSET;
+	node->max_entry_blocks = spdk_min(WB_CACHE_MAX_ENTRY_KB * 1024 / blocklen,
+					  node->log_blocks / WB_CACHE_MIN_LOG_ENTRIES);
+	if (node->max_entry_blocks < 2) {
+		SPDK_ERRLOG("Cache bdev %s is too small\n", node->cache_bdev->name);
+		return -EINVAL;
+	}
+	node->max_entry_blocks--;
+
+	node->sb = spdk_zmalloc(blocklen, 0x1000, NULL, SPDK_ENV_LCORE_ID_ANY, SPDK_MALLOC_DMA);
+	node->hdr_bufs = spdk_zmalloc((size_t)WB_CACHE_MAX_WRITES_IN_FLIGHT * blocklen, 0x1000,
+				      NULL, SPDK_ENV_LCORE_ID_ANY, SPDK_MALLOC_DMA);
+	node->free_hdrs = calloc(WB_CACHE_MAX_WRITES_IN_FLIGHT, sizeof(*node->free_hdrs));
+	node->destage.buf_blocks = spdk_max(WB_CACHE_DESTAGE_BUF_KB * 1024 / blocklen,
+					    1 + node->max_entry_blocks);
+	node->destage.buf = spdk_zmalloc(node->destage.buf_blocks * blocklen, 0x1000, NULL,
+					 SPDK_ENV_LCORE_ID_ANY, SPDK_MALLOC_DMA);
+	node->destage.items = calloc(WB_CACHE_DESTAGE_MAX_ITEMS, sizeof(*node->destage.items));
+	if (node->sb == NULL || node->hdr_bufs == NULL || node->free_hdrs == NULL ||
+	    node->destage.buf == NULL || node->destage.items == NULL) {
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < WB_CACHE_MAX_WRITES_IN_FLIGHT; i++) {
+		node->free_hdrs[i] = (uint8_t *)node->hdr_bufs + (size_t)i * blocklen;
+	}
+	node->num_free_hdrs = WB_CACHE_MAX_WRITES_IN_FLIGHT;
+
+	return 0;
+}
+
+/* Create the write-back cache bdev once both its base and cache bdevs exist. */
+static int
+vbdev_wb_cache_register(struct bdev_association *assoc, bdev_wb_cache_create_cb cb_fn,
+			void *cb_arg)
+{
+	struct vbdev_wb_cache *node;
+	struct spdk_uuid ns_uuid;
+	int rc;
+
+	if (assoc->active || spdk_bdev_get_by_name(assoc->base_bdev_name) == NULL ||
+	    spdk_bdev_get_by_name(assoc->cache_bdev_name) == NULL) {
+		return -ENODEV;
+	}
+
+	node = calloc(1, sizeof(struct vbdev_wb_cache));
+	if (!node) {
+		SPDK_ERRLOG("could not allocate write-back cache node\n");
+		return -ENOMEM;
+	}
+
+	node->wb_bdev.name = strdup(assoc->vbdev_name);
+	if (!node->wb_bdev.name) {
+		SPDK_ERRLOG("could not allocate write-back cache bdev name\n");
+		free(node);
+		return -ENOMEM;
+	}
+
+	TAILQ_INIT(&node->entries);
+	TAILQ_INIT(&node->pending_writes);
+	RB_INIT(&node->extents);
+	node->thread = spdk_get_thread();
+	node->create_cb = cb_fn;
+	node->create_cb_arg = cb_arg;
+	spdk_io_device_register(node, wb_cache_ch_create_cb, wb_cache_ch_destroy_cb, 0,
+				assoc->vbdev_name);
+
+	rc = wb_cache_open_bdev(node, assoc->base_bdev_name, &node->base_desc, &node->base_bdev,
+				&node->base_ch);
+	if (rc == 0) {
+		rc = wb_cache_open_bdev(node, assoc->cache_bdev_name, &node->cache_desc,
+					&node->cache_bdev, &node->cache_ch);
+	}
+	if (rc == 0) {
+		rc = wb_cache_init_geometry(node);
+	}
+	if (rc != 0) {
+		wb_cache_node_free(node);
+		return rc;
+	}
+
+	if (!spdk_uuid_is_null(&assoc->uuid)) {
+		spdk_uuid_copy(&node->wb_bdev.uuid, &assoc->uuid);
+	} else {
+		/* Generate UUID based on namespace UUID + base bdev UUID. */
+		spdk_uuid_parse(&ns_uuid, BDEV_WB_CACHE_NAMESPACE_UUID);
+		rc = spdk_uuid_generate_sha1(&node->wb_bdev.uuid, &ns_uuid,
+					     (const char *)&node->base_bdev->uuid, sizeof(struct spdk_uuid));
+		if (rc) {
+			SPDK_ERRLOG("Unable to generate new UUID for write-back cache bdev\n");
+			wb_cache_node_free(node);
+			return rc;
+		}
+	}
+
+	node->wb_bdev.product_name = "wb_cache";
+	node->wb_bdev.write_cache = node->cache_bdev->write_cache;
+	node->wb_bdev.required_alignment = spdk_max(node->base_bdev->required_alignment,
+					   node->cache_bdev->required_alignment);
+	node->wb_bdev.optimal_io_boundary = node->base_bdev->optimal_io_boundary;
+	node->wb_bdev.blocklen = node->base_bdev->blocklen;
+	node->wb_bdev.blockcnt = node->base_bdev->blockcnt;
+	node->wb_bdev.ctxt = node;
+	node->wb_bdev.fn_table = &vbdev_wb_cache_fn_table;
+	node->wb_bdev.module = &wb_cache_if;
+
+	node->assoc = assoc;
+	assoc->active = true;
+	wb_cache_load(node);
+
+	return 0;
+}
+
+static struct bdev_association *
+vbdev_wb_cache_find_association(const char *vbdev_name)
+{
+	struct bdev_association *assoc;
+
+	TAILQ_FOREACH(assoc, &g_bdev_associations, link) {
+		if (strcmp(vbdev_name, assoc->vbdev_name) == 0) {
+			return assoc;
+		}
+	}
+
+	return NULL;
+}
+
+static void
+vbdev_wb_cache_free_association(struct bdev_association *assoc)
+{
+	TAILQ_REMOVE(&g_bdev_associations, assoc, link);
+	free(assoc->base_bdev_name);
+	free(assoc->cache_bdev_name);
+	free(assoc->vbdev_name);
+	free(assoc);
+}
+
+static int
+vbdev_wb_cache_insert_association(const struct vbdev_wb_cache_opts *opts,
+				  struct bdev_association **_assoc)
+{
+	struct bdev_association *assoc;
+
+	if (vbdev_wb_cache_find_association(opts->name) != NULL) {
+		SPDK_ERRLOG("write-back cache bdev %s already exists\n", opts->name);
+		return -EEXIST;
+	}
+
+	assoc = calloc(1, sizeof(struct bdev_association));
+	if (!assoc) {
+		SPDK_ERRLOG("could not allocate bdev_association\n");
+		return -ENOMEM;
+	}
+
+	assoc->vbdev_name = strdup(opts->name);
+	assoc->base_bdev_name = strdup(opts->base_bdev_name);
+	assoc->cache_bdev_name = strdup(opts->cache_bdev_name);
+	if (!assoc->vbdev_name || !assoc->base_bdev_name || !assoc->cache_bdev_name) {
+		SPDK_ERRLOG("could not allocate bdev_association names\n");
+		free(assoc->vbdev_name);
+		free(assoc->base_bdev_name);
+		free(assoc->cache_bdev_name);
+		free(assoc);
+		return -ENOMEM;
+	}
+
+	spdk_uuid_copy(&assoc->uuid, &opts->uuid);
+	TAILQ_INSERT_TAIL(&g_bdev_associations, assoc, link);
+	*_assoc = assoc;
+
+	return 0;
+}
+
+int
+bdev_wb_cache_create_disk(const struct vbdev_wb_cache_opts *opts,
+			  bdev_wb_cache_create_cb cb_fn, void *cb_arg)
+{
+	struct bdev_association *assoc;
+	int rc;
+
+	if (opts->name == NULL || opts->base_bdev_name == NULL || opts->cache_bdev_name == NULL) {
+		return -EINVAL;
+	}
+
+	if (strcmp(opts->base_bdev_name, opts->cache_bdev_name) == 0) {
+		SPDK_ERRLOG("Base and cache bdevs must be different\n");
+		return -EINVAL;
+	}
+
+	/* Insert the bdev names into our global list even if they don't exist yet,
+	 * they may show up soon...
+	 */
+	rc = vbdev_wb_cache_insert_association(opts, &assoc);
+	if (rc) {
+		return rc;
+	}
+
+	rc = vbdev_wb_cache_register(assoc, cb_fn, cb_arg);
+	if (rc == -ENODEV) {
+		/* This is not an error, we tracked the names above and they still
+		 * may show up later.
+		 */
+		SPDK_NOTICELOG("vbdev creation deferred pending base or cache bdev arrival\n");
+		cb_fn(cb_arg, 0);
+		rc = 0;
+	} else if (rc != 0) {
+		vbdev_wb_cache_free_association(assoc);
+	}
+
+	return rc;
+}
+
+void
+bdev_wb_cache_delete_disk(const char *bdev_name, spdk_bdev_unregister_cb cb_fn, void *cb_arg)
+{
+	struct bdev_association *assoc;
+	int rc;
+
+	rc = spdk_bdev_unregister_by_name(bdev_name, &wb_cache_if, cb_fn, cb_arg);
+	if (rc == 0) {
+		/* Remove the association so that the vbdev does not get re-created if the same
+		 * bdevs are constructed at some other time, unless they were hot-removed.
+		 */
+		assoc = vbdev_wb_cache_find_association(bdev_name);
+		if (assoc != NULL) {
+			vbdev_wb_cache_free_association(assoc);
+		}
+	} else {
+		cb_fn(cb_arg, rc);
+	}
+}
+
+static int
+vbdev_wb_cache_init(void)
+{
+	return 0;
+}
+
+static void
+vbdev_wb_cache_finish(void)
+{
+	struct bdev_association *assoc;
+
+	while ((assoc = TAILQ_FIRST(&g_bdev_associations))) {
+		vbdev_wb_cache_free_association(assoc);
+	}
+}
+
+static int
+vbdev_wb_cache_get_ctx_size(void)
+{
+	return sizeof(struct wb_cache_bdev_io);
+}
+
+static void
+vbdev_wb_cache_examine(struct spdk_bdev *bdev)
+{
+	struct bdev_association *assoc;
+
+	TAILQ_FOREACH(assoc, &g_bdev_associations, link) {
+		if (strcmp(assoc->base_bdev_name, bdev->name) == 0 ||
+		    strcmp(assoc->cache_bdev_name, bdev->name) == 0) {
+			vbdev_wb_cache_register(assoc, NULL, NULL);
+		}
+	}
+
+	spdk_bdev_module_examine_done(&wb_cache_if);
+}
+
+SPDK_LOG_REGISTER_COMPONENT(vbdev_wb_cache)
@@ -0,0 +1,57 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 the SPDK authors.
+ *   All rights reserved.
+ */
+
+#ifndef SPDK_VBDEV_WB_CACHE_H
+#define SPDK_VBDEV_WB_CACHE_H
+
+#include "spdk/stdinc.h"
+
+#include "spdk/bdev.h"
+#include "spdk/bdev_module.h"
+
+struct vbdev_wb_cache_opts {
+	/* Name of the write-back cache bdev */
+	const char		*name;
+
+	/* Name of the bdev to cache */
+	const char		*base_bdev_name;
+
+	/* Name of the bdev holding the write log */
+	const char		*cache_bdev_name;
+
+	/* Optional UUID of the write-back cache bdev */
+	struct spdk_uuid	uuid;
+};
+
+typedef void (*bdev_wb_cache_create_cb)(void *cb_arg, int bdeverrno);
+
+/**
+ * Create new write-back cache bdev.
+ *
+ * If the cache bdev holds the log of a previous instance for the same base bdev, the writes
+ * that weren't destaged yet are written to the base bdev before the new bdev is registered.
+ * If either of the bdevs doesn't exist yet, creation is deferred until both show up and
+ * cb_fn is called right away.
+ *
+ * \param opts Options of the write-back cache bdev.
+ * \param cb_fn Function to call once the bdev is created.
+ * \param cb_arg Argument to pass to cb_fn.
+ * \return 0 if creation was started, negative errno otherwise. cb_fn is only called on success.
+ */
+int bdev_wb_cache_create_disk(const struct vbdev_wb_cache_opts *opts,
+			      bdev_wb_cache_create_cb cb_fn, void *cb_arg);
+
+/**
+ * Delete write-back cache bdev. Writes that weren't destaged yet are kept in the log on
+ * the cache bdev.
+ *
+ * \param bdev_name Name of the write-back cache bdev.
+ * \param cb_fn Function to call after deletion.
+ * \param cb_arg Argument to pass to cb_fn.
+ */
+void bdev_wb_cache_delete_disk(const char *bdev_name, spdk_bdev_unregister_cb cb_fn,
+			       void *cb_arg);
+
+#endif /* SPDK_VBDEV_WB_CACHE_H */
@@ -22,6 +22,7 @@ struct spdk_nvmf_admin_passthru_conf {
 struct spdk_nvmf_tgt_conf {
 	struct spdk_nvmf_admin_passthru_conf admin_passthru;
 	enum spdk_nvmf_tgt_discovery_filter discovery_filter;
+	uint64_t qpair_rebalance_period_us;
 };
 
 extern struct spdk_nvmf_tgt_conf g_spdk_nvmf_tgt_conf;
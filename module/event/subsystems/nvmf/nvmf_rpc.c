@@ -162,7 +162,8 @@ nvmf_decode_poll_groups_mask(const struct spdk_json_val *val, void *out)
 static const struct spdk_json_object_decoder nvmf_rpc_subsystem_tgt_conf_decoder[] = {
 	{"admin_cmd_passthru", offsetof(struct spdk_nvmf_tgt_conf, admin_passthru), decode_admin_passthru, true},
 	{"poll_groups_mask", 0, nvmf_decode_poll_groups_mask, true},
-	{"discovery_filter", offsetof(struct spdk_nvmf_tgt_conf, discovery_filter), decode_discovery_filter, true}
+	{"discovery_filter", offsetof(struct spdk_nvmf_tgt_conf, discovery_filter), decode_discovery_filter, true},
+	{"qpair_rebalance_period_us", offsetof(struct spdk_nvmf_tgt_conf, qpair_rebalance_period_us), spdk_json_decode_uint64, true}
 };
 
 static void
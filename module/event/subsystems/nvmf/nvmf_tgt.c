@@ -10,6 +10,7 @@
 #include "spdk/thread.h"
 #include "spdk/log.h"
 #include "spdk/nvme.h"
+#include "spdk/string.h"
 #include "spdk/nvmf_cmd.h"
 #include "spdk_internal/usdt.h"
 
@@ -50,6 +51,9 @@ static struct spdk_thread *g_tgt_fini_thread = NULL;
 static TAILQ_HEAD(, nvmf_tgt_poll_group) g_poll_groups = TAILQ_HEAD_INITIALIZER(g_poll_groups);
 static size_t g_num_poll_groups = 0;
 
+static struct spdk_poller *g_rebalance_poller = NULL;
+static bool g_rebalance_in_progress = false;
+
 static void nvmf_tgt_advance_state(void);
 
 static void
@@ -398,6 +402,31 @@ nvmf_custom_identify_hdlr(struct spdk_nvmf_request *req)
 	return spdk_nvmf_bdev_ctrlr_nvme_passthru_admin(bdev, desc, ch, req, fixup_identify_ctrlr);
 }
 
+static void
+nvmf_tgt_rebalance_done(void *cb_arg, int status)
+{
+	if (status != 0) {
+		SPDK_NOTICELOG("Unable to rebalance the poll groups: %s\n", spdk_strerror(-status));
+	}
+
+	g_rebalance_in_progress = false;
+}
+
+static int
+nvmf_tgt_rebalance_poll(void *arg)
+{
+	if (g_rebalance_in_progress) {
+		return SPDK_POLLER_IDLE;
+	}
+
+	if (spdk_nvmf_tgt_rebalance_poll_groups(g_spdk_nvmf_tgt, nvmf_tgt_rebalance_done, NULL) != 0) {
+		return SPDK_POLLER_IDLE;
+	}
+
+	g_rebalance_in_progress = true;
+	return SPDK_POLLER_BUSY;
+}
+
 static void
 nvmf_tgt_advance_state(void)
 {
@@ -445,11 +474,17 @@ nvmf_tgt_advance_state(void)
 			break;
 		}
 		case NVMF_TGT_RUNNING:
+			if (g_spdk_nvmf_tgt_conf.qpair_rebalance_period_us != 0) {
+				g_rebalance_poller = SPDK_POLLER_REGISTER(nvmf_tgt_rebalance_poll, NULL,
+						     g_spdk_nvmf_tgt_conf.qpair_rebalance_period_us);
+			}
 			spdk_subsystem_init_next(0);
 			break;
 		case NVMF_TGT_FINI_STOP_SUBSYSTEMS: {
 			struct spdk_nvmf_subsystem *subsystem;
 
+			spdk_poller_unregister(&g_rebalance_poller);
+
 			subsystem = spdk_nvmf_subsystem_get_first(g_spdk_nvmf_tgt);
 
 			if (subsystem) {
@@ -534,6 +569,8 @@ nvmf_subsystem_write_config_json(struct spdk_json_write_ctx *w)
 	if (g_poll_groups_mask) {
 		spdk_json_write_named_string(w, "poll_groups_mask", spdk_cpuset_fmt(g_poll_groups_mask));
 	}
+	spdk_json_write_named_uint64(w, "qpair_rebalance_period_us",
+				     g_spdk_nvmf_tgt_conf.qpair_rebalance_period_us);
 	spdk_json_write_object_end(w);
 	spdk_json_write_object_end(w);
 
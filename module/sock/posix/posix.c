@@ -1547,7 +1547,9 @@ posix_sock_readv(struct spdk_sock *_sock, struct iovec *iov, int iovcnt)
 {
 	struct spdk_posix_sock *sock = __posix_sock(_sock);
 	struct spdk_posix_sock_group_impl *group = __posix_group_impl(sock->base.group_impl);
-	int rc, i;
+	struct iovec diov[IOV_BATCH_SIZE];
+	ssize_t rc, bytes;
+	int i, diovcnt;
 	size_t len;
 
 	if (sock->recv_pipe == NULL) {
@@ -1563,16 +1565,16 @@ posix_sock_readv(struct spdk_sock *_sock, struct iovec *iov, int iovcnt)
 		}
 	}
 
+	len = 0;
+	for (i = 0; i < iovcnt; i++) {
+		len += iov[i].iov_len;
+	}
+
 	/* If the socket is not in a group, we must assume it always has
 	 * data waiting for us because it is not epolled */
 	if (!sock->pipe_has_data && (group == NULL || sock->socket_has_data)) {
 		/* If the user is receiving a sufficiently large amount of data,
 		 * receive directly to their buffers. */
-		len = 0;
-		for (i = 0; i < iovcnt; i++) {
-			len += iov[i].iov_len;
-		}
-
 		if (len >= MIN_SOCK_PIPE_SIZE) {
 			/* TODO: Should this detect if kernel socket is drained? */
 			if (sock->ssl) {
@@ -1589,7 +1591,30 @@ posix_sock_readv(struct spdk_sock *_sock, struct iovec *iov, int iovcnt)
 		}
 	}
 
-	return posix_sock_recv_from_pipe(sock, iov, iovcnt);
+	rc = posix_sock_recv_from_pipe(sock, iov, iovcnt);
+	if (rc <= 0 || sock->pipe_has_data || len - rc < MIN_SOCK_PIPE_SIZE) {
+		return rc;
+	}
+
+	if (group != NULL && !sock->socket_has_data) {
+		return rc;
+	}
+
+	/* The pipe only held the beginning of a large read, typically the start of a big
+	 * PDU payload. Receive the rest directly to the user's buffers, in the same call. */
+	diovcnt = spdk_sock_iov_skip(iov, iovcnt, rc, diov, SPDK_COUNTOF(diov));
+	if (sock->ssl) {
+		bytes = SSL_readv(sock->ssl, diov, diovcnt);
+	} else {
+		bytes = readv(sock->fd, diov, diovcnt);
+	}
+
+	/* Errors are reported by the next call, once the data received so far is consumed */
+	if (bytes > 0) {
+		rc += bytes;
+	}
+
+	return rc;
 }
 
 static ssize_t
@@ -1756,6 +1781,14 @@ posix_sock_is_connected(struct spdk_sock *_sock)
 	return true;
 }
 
+static int
+posix_sock_get_interrupt_fd(struct spdk_sock *_sock)
+{
+	struct spdk_posix_sock *sock = __posix_sock(_sock);
+
+	return sock->fd;
+}
+
 static struct spdk_sock_group_impl *
 posix_sock_group_impl_get_optimal(struct spdk_sock *_sock, struct spdk_sock_group_impl *hint)
 {
@@ -2169,6 +2202,14 @@ ssl_sock_group_impl_close(struct spdk_sock_group_impl *_group)
 	return _sock_group_impl_close(_group, g_ssl_impl_opts.enable_placement_id);
 }
 
+static int
+posix_sock_group_impl_get_interrupt_fd(struct spdk_sock_group_impl *_group)
+{
+	struct spdk_posix_sock_group_impl *group = __posix_group_impl(_group);
+
+	return group->fd;
+}
+
 static struct spdk_net_impl g_posix_net_impl = {
 	.name		= "posix",
 	.getaddr	= posix_sock_getaddr,
@@ -2188,12 +2229,14 @@ static struct spdk_net_impl g_posix_net_impl = {
 	.is_ipv6	= posix_sock_is_ipv6,
 	.is_ipv4	= posix_sock_is_ipv4,
 	.is_connected	= posix_sock_is_connected,
+	.get_interrupt_fd	= posix_sock_get_interrupt_fd,
 	.group_impl_get_optimal	= posix_sock_group_impl_get_optimal,
 	.group_impl_create	= posix_sock_group_impl_create,
 	.group_impl_add_sock	= posix_sock_group_impl_add_sock,
 	.group_impl_remove_sock = posix_sock_group_impl_remove_sock,
 	.group_impl_poll	= posix_sock_group_impl_poll,
 	.group_impl_close	= posix_sock_group_impl_close,
+	.group_impl_get_interrupt_fd	= posix_sock_group_impl_get_interrupt_fd,
 	.get_opts	= posix_sock_impl_get_opts,
 	.set_opts	= posix_sock_impl_set_opts,
 };
@@ -2237,12 +2280,14 @@ static struct spdk_net_impl g_ssl_net_impl = {
 	.is_ipv6	= posix_sock_is_ipv6,
 	.is_ipv4	= posix_sock_is_ipv4,
 	.is_connected	= posix_sock_is_connected,
+	.get_interrupt_fd	= posix_sock_get_interrupt_fd,
 	.group_impl_get_optimal	= posix_sock_group_impl_get_optimal,
 	.group_impl_create	= ssl_sock_group_impl_create,
 	.group_impl_add_sock	= posix_sock_group_impl_add_sock,
 	.group_impl_remove_sock = posix_sock_group_impl_remove_sock,
 	.group_impl_poll	= posix_sock_group_impl_poll,
 	.group_impl_close	= ssl_sock_group_impl_close,
+	.group_impl_get_interrupt_fd	= posix_sock_group_impl_get_interrupt_fd,
 	.get_opts	= ssl_sock_impl_get_opts,
 	.set_opts	= ssl_sock_impl_set_opts,
 };
@@ -957,7 +957,9 @@ static ssize_t
 uring_sock_readv(struct spdk_sock *_sock, struct iovec *iov, int iovcnt)
 {
 	struct spdk_uring_sock *sock = __uring_sock(_sock);
-	int rc, i;
+	struct iovec diov[IOV_BATCH_SIZE];
+	ssize_t rc, bytes;
+	int i, diovcnt;
 	size_t len;
 
 	if (sock->connection_status < 0) {
@@ -988,7 +990,21 @@ uring_sock_readv(struct spdk_sock *_sock, struct iovec *iov, int iovcnt)
 		}
 	}
 
-	return uring_sock_recv_from_pipe(sock, iov, iovcnt);
+	rc = uring_sock_recv_from_pipe(sock, iov, iovcnt);
+	if (rc <= 0 || spdk_pipe_reader_bytes_available(sock->recv_pipe) > 0 ||
+	    len - rc < MIN_SOCK_PIPE_SIZE) {
+		return rc;
+	}
+
+	/* The pipe only held the beginning of a large read, receive the rest directly to
+	 * the user's buffers. Errors are reported by the next call. */
+	diovcnt = spdk_sock_iov_skip(iov, iovcnt, rc, diov, SPDK_COUNTOF(diov));
+	bytes = sock_readv(sock->fd, diov, diovcnt);
+	if (bytes > 0) {
+		rc += bytes;
+	}
+
+	return rc;
 }
 
 static ssize_t
@@ -601,7 +601,9 @@ def bdev_nvme_set_options(client, action_on_timeout=None, timeout_us=None, timeo
                           transport_ack_timeout=None, ctrlr_loss_timeout_sec=None, reconnect_delay_sec=None,
                           fast_io_fail_timeout_sec=None, disable_auto_failback=None, generate_uuids=None,
                           transport_tos=None, nvme_error_stat=None, rdma_srq_size=None, io_path_stat=None,
-                          allow_accel_sequence=None, rdma_max_cq_size=None):
+                          allow_accel_sequence=None, rdma_max_cq_size=None,
+                          prefer_numa_local_path=None, poll_group_requests=None,
+                          poll_group_submit_batch=None, fast_failover=None):
     """Set options for the bdev nvme. This is startup command.
 
     Args:
@@ -649,6 +651,14 @@ def bdev_nvme_set_options(client, action_on_timeout=None, timeout_us=None, timeo
         allow_accel_sequence: Allow NVMe bdevs to advertise support for accel sequences if the
         controller also supports them. (optional)
         rdma_max_cq_size: The maximum size of a rdma completion queue. Default: 0 (unlimited) (optional)
+        prefer_numa_local_path: Prefer I/O paths to controllers on the NUMA node of the submitting
+        thread in multipath load balancing. (optional)
+        poll_group_requests: The number of requests shared by the NVMe I/O queues of each poll group.
+        I/O queues then allocate only io_queue_requests requests each. Default: 0 (disabled) (optional)
+        poll_group_submit_batch: Ring the submission queue doorbells of all the NVMe I/O queues of a poll
+        group once per poll instead of per command. (optional)
+        fast_failover: Retry an I/O on another available path immediately if its path failed while it was
+        submitted, instead of after one second. (optional)
 
     """
     params = {}
@@ -735,6 +745,18 @@ def bdev_nvme_set_options(client, action_on_timeout=None, timeout_us=None, timeo
     if rdma_max_cq_size is not None:
         params['rdma_max_cq_size'] = rdma_max_cq_size
 
+    if prefer_numa_local_path is not None:
+        params['prefer_numa_local_path'] = prefer_numa_local_path
+
+    if poll_group_requests is not None:
+        params['poll_group_requests'] = poll_group_requests
+
+    if poll_group_submit_batch is not None:
+        params['poll_group_submit_batch'] = poll_group_submit_batch
+
+    if fast_failover is not None:
+        params['fast_failover'] = fast_failover
+
     return client.call('bdev_nvme_set_options', params)
 
 
@@ -1070,7 +1092,7 @@ def bdev_nvme_set_multipath_policy(client, name, policy, selector, rr_min_io):
     Args:
         name: NVMe bdev name
         policy: Multipath policy (active_passive or active_active)
-        selector: Multipath selector (round_robin, queue_depth)
+        selector: Multipath selector (round_robin, queue_depth, latency)
         rr_min_io: Number of IO to route to a path before switching to another one (optional)
     """
 
@@ -1420,6 +1442,109 @@ def bdev_passthru_delete(client, name):
     return client.call('bdev_passthru_delete', params)
 
 
+def bdev_read_cache_create(client, base_bdev_name, name, cache_size_mb, line_size_kb=None, uuid=None):
+    """Construct a read cache block device.
+
+    Args:
+        base_bdev_name: name of the existing bdev
+        name: name of block device
+        cache_size_mb: memory used for caching in MiB, split evenly among the threads
+        line_size_kb: caching granularity in KiB (optional)
+        uuid: UUID of block device (optional)
+
+    Returns:
+        Name of created block device.
+    """
+    params = {
+        'base_bdev_name': base_bdev_name,
+        'name': name,
+        'cache_size_mb': cache_size_mb,
+    }
+    if line_size_kb is not None:
+        params['line_size_kb'] = line_size_kb
+    if uuid:
+        params['uuid'] = uuid
+    return client.call('bdev_read_cache_create', params)
+
+
+def bdev_read_cache_delete(client, name):
+    """Remove read cache bdev from the system.
+
+    Args:
+        name: name of read cache bdev to delete
+    """
+    params = {'name': name}
+    return client.call('bdev_read_cache_delete', params)
+
+
+def bdev_wb_cache_create(client, base_bdev_name, cache_bdev_name, name, uuid=None):
+    """Construct a write-back cache block device.
+
+    Args:
+        base_bdev_name: name of the existing bdev to cache
+        cache_bdev_name: name of the existing bdev holding the write log
+        name: name of block device
+        uuid: UUID of block device (optional)
+
+    Returns:
+        Name of created block device.
+    """
+    params = {
+        'base_bdev_name': base_bdev_name,
+        'cache_bdev_name': cache_bdev_name,
+        'name': name,
+    }
+    if uuid:
+        params['uuid'] = uuid
+    return client.call('bdev_wb_cache_create', params)
+
+
+def bdev_wb_cache_delete(client, name):
+    """Remove write-back cache bdev from the system.
+
+    Args:
+        name: name of write-back cache bdev to delete
+    """
+    params = {'name': name}
+    return client.call('bdev_wb_cache_delete', params)
+
+
+def bdev_dedup_create(client, base_bdev_name, name, chunk_size=None, size_mb=None, uuid=None):
+    """Construct a deduplicating block device.
+
+    Args:
+        base_bdev_name: name of the existing bdev to store the data on
+        name: name of block device
+        chunk_size: size of the deduplicated chunks in bytes (optional)
+        size_mb: size of block device in MiB (optional)
+        uuid: UUID of block device (optional)
+
+    Returns:
+        Name of created block device.
+    """
+    params = {
+        'base_bdev_name': base_bdev_name,
+        'name': name,
+    }
+    if chunk_size:
+        params['chunk_size'] = chunk_size
+    if size_mb:
+        params['size_mb'] = size_mb
+    if uuid:
+        params['uuid'] = uuid
+    return client.call('bdev_dedup_create', params)
+
+
+def bdev_dedup_delete(client, name):
+    """Remove dedup bdev from the system.
+
+    Args:
+        name: name of dedup bdev to delete
+    """
+    params = {'name': name}
+    return client.call('bdev_dedup_delete', params)
+
+
 def bdev_opal_create(client, nvme_ctrlr_name, nsid, locking_range_id, range_start, range_length, password):
     """Create opal virtual block devices from a base nvme bdev.
 
@@ -1711,26 +1836,54 @@ def bdev_reset_iostat(client, name=None, mode=None):
     return client.call('bdev_reset_iostat', params)
 
 
-def bdev_enable_histogram(client, name, enable):
+def bdev_enable_histogram(client, name, enable, breakdown=None, size_class_bounds=None):
     """Control whether histogram is enabled for specified bdev.
 
     Args:
         bdev_name: name of bdev
+        breakdown: also collect histograms per I/O type and size class (optional)
+        size_class_bounds: list of inclusive upper bounds in bytes of the size classes (optional)
     """
     params = {'name': name, "enable": enable}
+    if breakdown is not None:
+        params['breakdown'] = breakdown
+    if size_class_bounds is not None:
+        params['size_class_bounds'] = size_class_bounds
     return client.call('bdev_enable_histogram', params)
 
 
-def bdev_get_histogram(client, name):
+def bdev_get_histogram(client, name, breakdown=None):
     """Get histogram for specified bdev.
 
     Args:
         bdev_name: name of bdev
+        breakdown: also get histograms per I/O type and size class (optional)
     """
     params = {'name': name}
+    if breakdown is not None:
+        params['breakdown'] = breakdown
     return client.call('bdev_get_histogram', params)
 
 
+def bdev_get_allocation_map(client, name, offset_blocks=None, num_blocks=None, max_extents=None):
+    """Get the allocated extents of a bdev.
+
+    Args:
+        name: name of bdev
+        offset_blocks: offset of the range to map, in blocks (optional)
+        num_blocks: length of the range to map, in blocks (optional)
+        max_extents: maximum number of extents to return (optional)
+    """
+    params = {'name': name}
+    if offset_blocks is not None:
+        params['offset_blocks'] = offset_blocks
+    if num_blocks is not None:
+        params['num_blocks'] = num_blocks
+    if max_extents is not None:
+        params['max_extents'] = max_extents
+    return client.call('bdev_get_allocation_map', params)
+
+
 def bdev_error_inject_error(client, name, io_type, error_type, num,
                             queue_depth, corrupt_offset, corrupt_value):
     """Inject an error via an error bdev.
@@ -1805,6 +1958,139 @@ def bdev_set_qos_limit(
     return client.call('bdev_set_qos_limit', params)
 
 
+def bdev_qos_group_create(
+        client,
+        name,
+        rw_ios_per_sec=None,
+        rw_mbytes_per_sec=None,
+        r_mbytes_per_sec=None,
+        w_mbytes_per_sec=None):
+    """Create a QoS group whose rate limits are shared by all of its bdevs.
+
+    Args:
+        name: name of the QoS group
+        rw_ios_per_sec: R/W IOs per second limit (>=1000, example: 20000). 0 means unlimited.
+        rw_mbytes_per_sec: R/W megabytes per second limit (>=10, example: 100). 0 means unlimited.
+        r_mbytes_per_sec: Read megabytes per second limit (>=10, example: 100). 0 means unlimited.
+        w_mbytes_per_sec: Write megabytes per second limit (>=10, example: 100). 0 means unlimited.
+    """
+    params = {}
+    params['name'] = name
+    if rw_ios_per_sec is not None:
+        params['rw_ios_per_sec'] = rw_ios_per_sec
+    if rw_mbytes_per_sec is not None:
+        params['rw_mbytes_per_sec'] = rw_mbytes_per_sec
+    if r_mbytes_per_sec is not None:
+        params['r_mbytes_per_sec'] = r_mbytes_per_sec
+    if w_mbytes_per_sec is not None:
+        params['w_mbytes_per_sec'] = w_mbytes_per_sec
+    return client.call('bdev_qos_group_create', params)
+
+
+def bdev_qos_group_delete(client, name):
+    """Delete a QoS group. The group must not have any bdevs.
+
+    Args:
+        name: name of the QoS group
+    """
+    params = {'name': name}
+    return client.call('bdev_qos_group_delete', params)
+
+
+def bdev_qos_group_set_limit(
+        client,
+        name,
+        rw_ios_per_sec=None,
+        rw_mbytes_per_sec=None,
+        r_mbytes_per_sec=None,
+        w_mbytes_per_sec=None):
+    """Set QoS rate limit on a QoS group.
+
+    Args:
+        name: name of the QoS group
+        rw_ios_per_sec: R/W IOs per second limit (>=1000, example: 20000). 0 means unlimited.
+        rw_mbytes_per_sec: R/W megabytes per second limit (>=10, example: 100). 0 means unlimited.
+        r_mbytes_per_sec: Read megabytes per second limit (>=10, example: 100). 0 means unlimited.
+        w_mbytes_per_sec: Write megabytes per second limit (>=10, example: 100). 0 means unlimited.
+    """
+    params = {}
+    params['name'] = name
+    if rw_ios_per_sec is not None:
+        params['rw_ios_per_sec'] = rw_ios_per_sec
+    if rw_mbytes_per_sec is not None:
+        params['rw_mbytes_per_sec'] = rw_mbytes_per_sec
+    if r_mbytes_per_sec is not None:
+        params['r_mbytes_per_sec'] = r_mbytes_per_sec
+    if w_mbytes_per_sec is not None:
+        params['w_mbytes_per_sec'] = w_mbytes_per_sec
+    return client.call('bdev_qos_group_set_limit', params)
+
+
+def bdev_qos_group_add_bdev(client, name, bdev_name):
+    """Add a bdev to a QoS group.
+
+    Args:
+        name: name of the QoS group
+        bdev_name: name of the bdev to add
+    """
+    params = {'name': name, 'bdev_name': bdev_name}
+    return client.call('bdev_qos_group_add_bdev', params)
+
+
+def bdev_qos_group_remove_bdev(client, name, bdev_name):
+    """Remove a bdev from a QoS group.
+
+    Args:
+        name: name of the QoS group
+        bdev_name: name of the bdev to remove
+    """
+    params = {'name': name, 'bdev_name': bdev_name}
+    return client.call('bdev_qos_group_remove_bdev', params)
+
+
+def bdev_set_qos_latency_target(client, name, latency_target_us):
+    """Set the 99th percentile latency target of a bdev.
+
+    Args:
+        name: name of the bdev
+        latency_target_us: latency target in microseconds (0 removes the target)
+    """
+    params = {'name': name, 'latency_target_us': latency_target_us}
+    return client.call('bdev_set_qos_latency_target', params)
+
+
+def bdev_set_merge_opts(client, name, window_us, max_ios=None, max_blocks=None):
+    """Set the options for merging contiguous reads and writes to a bdev.
+
+    Args:
+        name: name of the bdev
+        window_us: maximum time in microseconds an I/O is held back (0 disables merging)
+        max_ios: maximum number of I/O merged into one (optional)
+        max_blocks: maximum size of a merged I/O in blocks (optional)
+    """
+    params = {'name': name, 'window_us': window_us}
+    if max_ios is not None:
+        params['max_ios'] = max_ios
+    if max_blocks is not None:
+        params['max_blocks'] = max_blocks
+    return client.call('bdev_set_merge_opts', params)
+
+
+def bdev_get_qos_groups(client, name=None):
+    """Get information about QoS groups.
+
+    Args:
+        name: name of the QoS group to query (optional; if omitted, query all groups)
+
+    Returns:
+        List of QoS groups with their rate limits and member bdevs.
+    """
+    params = {}
+    if name:
+        params['name'] = name
+    return client.call('bdev_get_qos_groups', params)
+
+
 def bdev_nvme_apply_firmware(client, bdev_name, filename):
     """Download and commit firmware to NVMe device.
 
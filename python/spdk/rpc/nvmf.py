@@ -24,12 +24,15 @@ def nvmf_set_max_subsystems(client,
 def nvmf_set_config(client,
                     passthru_identify_ctrlr=None,
                     poll_groups_mask=None,
-                    discovery_filter=None):
+                    discovery_filter=None,
+                    qpair_rebalance_period_us=None):
     """Set NVMe-oF target subsystem configuration.
 
     Args:
         discovery_filter: Set discovery filter (optional), possible values are: `match_any` (default) or
          comma separated values: `transport`, `address`, `svcid`
+        qpair_rebalance_period_us: Period of moving I/O qpairs between poll groups to balance their load,
+         0 to disable (optional)
 
     Returns:
         True or False
@@ -44,6 +47,8 @@ def nvmf_set_config(client,
         params['poll_groups_mask'] = poll_groups_mask
     if discovery_filter:
         params['discovery_filter'] = discovery_filter
+    if qpair_rebalance_period_us is not None:
+        params['qpair_rebalance_period_us'] = qpair_rebalance_period_us
 
     return client.call('nvmf_set_config', params)
 
@@ -120,6 +125,7 @@ def nvmf_create_transport(client, **params):
         abort_timeout_sec: Abort execution timeout value, in seconds (optional)
         no_wr_batching: Boolean flag to disable work requests batching - RDMA specific (optional)
         control_msg_num: The number of control messages per poll group - TCP specific (optional)
+        recv_batch_size: The size of the per poll group receive buffer, 0 to disable batching - TCP specific (optional)
         disable_mappable_bar0: disable client mmap() of BAR0 - VFIO-USER specific (optional)
         disable_adaptive_irq: Disable adaptive interrupt feature - VFIO-USER specific (optional)
         disable_shadow_doorbells: disable shadow doorbell support - VFIO-USER specific (optional)
@@ -456,7 +462,8 @@ def nvmf_subsystem_add_ns(client,
                           nguid=None,
                           eui64=None,
                           uuid=None,
-                          anagrpid=None):
+                          anagrpid=None,
+                          passthru_io=None):
     """Add a namespace to a subsystem.
 
     Args:
@@ -468,6 +475,7 @@ def nvmf_subsystem_add_ns(client,
         eui64: 8-byte namespace EUI-64 in hexadecimal (e.g. "ABCDEF0123456789") (optional).
         uuid: Namespace UUID (optional).
         anagrpid: ANA group ID (optional).
+        passthru_io: Forward I/O commands unchanged to the bdev as NVMe passthrough commands (optional).
 
     Returns:
         The namespace ID
@@ -492,6 +500,9 @@ def nvmf_subsystem_add_ns(client,
     if anagrpid:
         ns['anagrpid'] = anagrpid
 
+    if passthru_io:
+        ns['passthru_io'] = passthru_io
+
     params = {'nqn': nqn,
               'namespace': ns}
 
@@ -583,6 +594,66 @@ def nvmf_subsystem_allow_any_host(client, nqn, disable, tgt_name=None):
     return client.call('nvmf_subsystem_allow_any_host', params)
 
 
+def nvmf_subsystem_set_fair_queuing(client, nqn, max_inflight, tgt_name=None):
+    """Configure weighted fair queuing of I/O in a subsystem.
+
+    Args:
+        nqn: Subsystem NQN.
+        max_inflight: Number of READ and WRITE commands each poll group runs at once before
+        it starts queuing them, 0 disables fair queuing.
+        tgt_name: name of the parent NVMe-oF target (optional).
+
+    Returns:
+        True or False
+    """
+    params = {'nqn': nqn, 'max_inflight': max_inflight}
+
+    if tgt_name:
+        params['tgt_name'] = tgt_name
+
+    return client.call('nvmf_subsystem_set_fair_queuing', params)
+
+
+def nvmf_subsystem_set_host_weight(client, nqn, host, weight, tgt_name=None):
+    """Set the fair queuing weight of a host allowed to connect to a subsystem.
+
+    Args:
+        nqn: Subsystem NQN.
+        host: Host NQN.
+        weight: Weight of the host, from 1 to 1000.
+        tgt_name: name of the parent NVMe-oF target (optional).
+
+    Returns:
+        True or False
+    """
+    params = {'nqn': nqn, 'host': host, 'weight': weight}
+
+    if tgt_name:
+        params['tgt_name'] = tgt_name
+
+    return client.call('nvmf_subsystem_set_host_weight', params)
+
+
+def nvmf_subsystem_set_ns_weight(client, nqn, nsid, weight, tgt_name=None):
+    """Set the fair queuing weight of a namespace.
+
+    Args:
+        nqn: Subsystem NQN.
+        nsid: Namespace ID.
+        weight: Weight of the namespace, from 1 to 1000.
+        tgt_name: name of the parent NVMe-oF target (optional).
+
+    Returns:
+        True or False
+    """
+    params = {'nqn': nqn, 'nsid': nsid, 'weight': weight}
+
+    if tgt_name:
+        params['tgt_name'] = tgt_name
+
+    return client.call('nvmf_subsystem_set_ns_weight', params)
+
+
 def nvmf_delete_subsystem(client, nqn, tgt_name=None):
     """Delete an existing NVMe-oF subsystem.
 
@@ -573,7 +573,11 @@ if __name__ == "__main__":
                                        rdma_srq_size=args.rdma_srq_size,
                                        io_path_stat=args.io_path_stat,
                                        allow_accel_sequence=args.allow_accel_sequence,
-                                       rdma_max_cq_size=args.rdma_max_cq_size)
+                                       rdma_max_cq_size=args.rdma_max_cq_size,
+                                       prefer_numa_local_path=args.prefer_numa_local_path,
+                                       poll_group_requests=args.poll_group_requests,
+                                       poll_group_submit_batch=args.poll_group_submit_batch,
+                                       fast_failover=args.fast_failover)
 
     p = subparsers.add_parser('bdev_nvme_set_options',
                               help='Set options for the bdev nvme type. This is startup command.')
@@ -656,6 +660,19 @@ if __name__ == "__main__":
                    controller also supports them.''', action='store_true')
     p.add_argument('--rdma-max-cq-size',
                    help='The maximum size of a rdma completion queue. Default: 0 (unlimited)', type=int)
+    p.add_argument('--prefer-numa-local-path',
+                   help='''Prefer I/O paths to controllers on the NUMA node of the submitting thread
+                   in multipath load balancing.''', action='store_true')
+    p.add_argument('--poll-group-requests',
+                   help='''The number of requests shared by the NVMe I/O queues of each poll group.
+                   I/O queues then allocate only io-queue-requests requests each. Default: 0 (disabled)''',
+                   type=int)
+    p.add_argument('--poll-group-submit-batch',
+                   help='''Ring the submission queue doorbells of all the NVMe I/O queues of a poll group
+                   once per poll instead of per command.''', action='store_true')
+    p.add_argument('--fast-failover',
+                   help='''Retry an I/O on another available path immediately if its path failed while
+                   it was submitted, instead of after one second.''', action='store_true')
 
     p.set_defaults(func=bdev_nvme_set_options)
 
@@ -916,7 +933,7 @@ if __name__ == "__main__":
                               help="""Set multipath policy of the NVMe bdev""")
     p.add_argument('-b', '--name', help='Name of the NVMe bdev', required=True)
     p.add_argument('-p', '--policy', help='Multipath policy (active_passive or active_active)', required=True)
-    p.add_argument('-s', '--selector', help='Multipath selector (round_robin, queue_depth)', required=False)
+    p.add_argument('-s', '--selector', help='Multipath selector (round_robin, queue_depth, latency)', required=False)
     p.add_argument('-r', '--rr-min-io',
                    help='Number of IO to route to a path before switching to another for round-robin',
                    type=int, required=False)
@@ -1181,6 +1198,80 @@ if __name__ == "__main__":
     p.add_argument('name', help='pass through bdev name')
     p.set_defaults(func=bdev_passthru_delete)
 
+    def bdev_read_cache_create(args):
+        print_json(rpc.bdev.bdev_read_cache_create(args.client,
+                                                   base_bdev_name=args.base_bdev_name,
+                                                   name=args.name,
+                                                   cache_size_mb=args.cache_size_mb,
+                                                   line_size_kb=args.line_size_kb,
+                                                   uuid=args.uuid))
+
+    p = subparsers.add_parser('bdev_read_cache_create', help='Add a read cache bdev on existing bdev')
+    p.add_argument('-b', '--base-bdev-name', help="Name of the existing bdev", required=True)
+    p.add_argument('-p', '--name', help="Name of the read cache bdev", required=True)
+    p.add_argument('-s', '--cache-size-mb', help="Memory used for caching in MiB, split evenly among the threads",
+                   type=int, required=True)
+    p.add_argument('-l', '--line-size-kb', help="Caching granularity in KiB (default: 64)", type=int)
+    p.add_argument('-u', '--uuid', help="UUID of the bdev")
+    p.set_defaults(func=bdev_read_cache_create)
+
+    def bdev_read_cache_delete(args):
+        rpc.bdev.bdev_read_cache_delete(args.client,
+                                        name=args.name)
+
+    p = subparsers.add_parser('bdev_read_cache_delete', help='Delete a read cache bdev')
+    p.add_argument('name', help='read cache bdev name')
+    p.set_defaults(func=bdev_read_cache_delete)
+
+    def bdev_wb_cache_create(args):
+        print_json(rpc.bdev.bdev_wb_cache_create(args.client,
+                                                 base_bdev_name=args.base_bdev_name,
+                                                 cache_bdev_name=args.cache_bdev_name,
+                                                 name=args.name,
+                                                 uuid=args.uuid))
+
+    p = subparsers.add_parser('bdev_wb_cache_create',
+                              help='Add a write-back cache bdev on existing bdev, logging writes to a cache bdev')
+    p.add_argument('-b', '--base-bdev-name', help="Name of the existing bdev to cache", required=True)
+    p.add_argument('-c', '--cache-bdev-name', help="Name of the existing bdev holding the write log", required=True)
+    p.add_argument('-p', '--name', help="Name of the write-back cache bdev", required=True)
+    p.add_argument('-u', '--uuid', help="UUID of the write-back cache bdev")
+    p.set_defaults(func=bdev_wb_cache_create)
+
+    def bdev_wb_cache_delete(args):
+        rpc.bdev.bdev_wb_cache_delete(args.client,
+                                      name=args.name)
+
+    p = subparsers.add_parser('bdev_wb_cache_delete', help='Delete a write-back cache bdev')
+    p.add_argument('name', help='write-back cache bdev name')
+    p.set_defaults(func=bdev_wb_cache_delete)
+
+    def bdev_dedup_create(args):
+        print_json(rpc.bdev.bdev_dedup_create(args.client,
+                                              base_bdev_name=args.base_bdev_name,
+                                              name=args.name,
+                                              chunk_size=args.chunk_size,
+                                              size_mb=args.size_mb,
+                                              uuid=args.uuid))
+
+    p = subparsers.add_parser('bdev_dedup_create',
+                              help='Add a deduplicating bdev on existing bdev')
+    p.add_argument('-b', '--base-bdev-name', help="Name of the existing bdev to store the data on", required=True)
+    p.add_argument('-p', '--name', help="Name of the dedup bdev", required=True)
+    p.add_argument('-c', '--chunk-size', help="Size of the deduplicated chunks in bytes (default: 4096)", type=int)
+    p.add_argument('-s', '--size-mb', help="Size of the dedup bdev in MiB (default: data capacity of the base bdev)",
+                   type=int)
+    p.add_argument('-u', '--uuid', help="UUID of the dedup bdev")
+    p.set_defaults(func=bdev_dedup_create)
+
+    def bdev_dedup_delete(args):
+        rpc.bdev.bdev_dedup_delete(args.client,
+                                   name=args.name)
+
+    p = subparsers.add_parser('bdev_dedup_delete', help='Delete a dedup bdev')
+    p.add_argument('name', help='dedup bdev name')
+    p.set_defaults(func=bdev_dedup_delete)
+
     def bdev_get_bdevs(args):
         print_dict(rpc.bdev.bdev_get_bdevs(args.client,
                                            name=args.name, timeout=args.timeout_ms))
@@ -1216,23 +1307,50 @@ if __name__ == "__main__":
     p.set_defaults(func=bdev_reset_iostat)
 
     def bdev_enable_histogram(args):
-        rpc.bdev.bdev_enable_histogram(args.client, name=args.name, enable=args.enable)
+        rpc.bdev.bdev_enable_histogram(args.client, name=args.name, enable=args.enable,
+                                       breakdown=args.breakdown,
+                                       size_class_bounds=args.size_class_bounds)
 
     p = subparsers.add_parser('bdev_enable_histogram',
                               help='Enable or disable histogram for specified bdev')
     p.add_argument('-e', '--enable', default=True, dest='enable', action='store_true', help='Enable histograms on specified device')
     p.add_argument('-d', '--disable', dest='enable', action='store_false', help='Disable histograms on specified device')
+    p.add_argument('--breakdown', action='store_true', default=None,
+                   help='Also collect histograms per I/O type and size class')
+    p.add_argument('-s', '--size-class-bounds', nargs='+', type=int,
+                   help="""Inclusive upper bounds in bytes of the size classes, in ascending order.
+                   Implies --breakdown. Example: '-s 4096 131072'""")
     p.add_argument('name', help='bdev name')
     p.set_defaults(func=bdev_enable_histogram)
 
     def bdev_get_histogram(args):
-        print_dict(rpc.bdev.bdev_get_histogram(args.client, name=args.name))
+        print_dict(rpc.bdev.bdev_get_histogram(args.client, name=args.name,
+                                               breakdown=args.breakdown))
 
     p = subparsers.add_parser('bdev_get_histogram',
                               help='Get histogram for specified bdev')
+    p.add_argument('--breakdown', action='store_true', default=None,
+                   help='Also get histograms per I/O type and size class')
     p.add_argument('name', help='bdev name')
     p.set_defaults(func=bdev_get_histogram)
 
+    def bdev_get_allocation_map(args):
+        print_dict(rpc.bdev.bdev_get_allocation_map(args.client, name=args.name,
+                                                    offset_blocks=args.offset_blocks,
+                                                    num_blocks=args.num_blocks,
+                                                    max_extents=args.max_extents))
+
+    p = subparsers.add_parser('bdev_get_allocation_map',
+                              help='Get the allocated extents of a bdev')
+    p.add_argument('-o', '--offset-blocks', type=int,
+                   help='Offset of the range to map, in blocks. Default: 0')
+    p.add_argument('-n', '--num-blocks', type=int,
+                   help='Length of the range to map, in blocks. Default: up to the end of the bdev')
+    p.add_argument('-m', '--max-extents', type=int,
+                   help='Maximum number of extents to return. Default: no limit')
+    p.add_argument('name', help='bdev name')
+    p.set_defaults(func=bdev_get_allocation_map)
+
     def bdev_set_qd_sampling_period(args):
         rpc.bdev.bdev_set_qd_sampling_period(args.client,
                                              name=args.name,
@@ -1271,6 +1389,114 @@ if __name__ == "__main__":
                    type=int, required=False)
     p.set_defaults(func=bdev_set_qos_limit)
 
+    def add_qos_limit_args(p):
+        p.add_argument('--rw-ios-per-sec',
+                       help='R/W IOs per second limit (>=1000, example: 20000). 0 means unlimited.',
+                       type=int, required=False)
+        p.add_argument('--rw-mbytes-per-sec',
+                       help="R/W megabytes per second limit (>=10, example: 100). 0 means unlimited.",
+                       type=int, required=False)
+        p.add_argument('--r-mbytes-per-sec',
+                       help="Read megabytes per second limit (>=10, example: 100). 0 means unlimited.",
+                       type=int, required=False)
+        p.add_argument('--w-mbytes-per-sec',
+                       help="Write megabytes per second limit (>=10, example: 100). 0 means unlimited.",
+                       type=int, required=False)
+
+    def bdev_qos_group_create(args):
+        rpc.bdev.bdev_qos_group_create(args.client,
+                                       name=args.name,
+                                       rw_ios_per_sec=args.rw_ios_per_sec,
+                                       rw_mbytes_per_sec=args.rw_mbytes_per_sec,
+                                       r_mbytes_per_sec=args.r_mbytes_per_sec,
+                                       w_mbytes_per_sec=args.w_mbytes_per_sec)
+
+    p = subparsers.add_parser('bdev_qos_group_create',
+                              help='Create a QoS group whose rate limits are shared by its bdevs')
+    p.add_argument('name', help='QoS group name. Example: tenant0')
+    add_qos_limit_args(p)
+    p.set_defaults(func=bdev_qos_group_create)
+
+    def bdev_qos_group_delete(args):
+        rpc.bdev.bdev_qos_group_delete(args.client,
+                                       name=args.name)
+
+    p = subparsers.add_parser('bdev_qos_group_delete',
+                              help='Delete a QoS group')
+    p.add_argument('name', help='QoS group name')
+    p.set_defaults(func=bdev_qos_group_delete)
+
+    def bdev_qos_group_set_limit(args):
+        rpc.bdev.bdev_qos_group_set_limit(args.client,
+                                          name=args.name,
+                                          rw_ios_per_sec=args.rw_ios_per_sec,
+                                          rw_mbytes_per_sec=args.rw_mbytes_per_sec,
+                                          r_mbytes_per_sec=args.r_mbytes_per_sec,
+                                          w_mbytes_per_sec=args.w_mbytes_per_sec)
+
+    p = subparsers.add_parser('bdev_qos_group_set_limit',
+                              help='Set QoS rate limit on a QoS group')
+    p.add_argument('name', help='QoS group name')
+    add_qos_limit_args(p)
+    p.set_defaults(func=bdev_qos_group_set_limit)
+
+    def bdev_qos_group_add_bdev(args):
+        rpc.bdev.bdev_qos_group_add_bdev(args.client,
+                                         name=args.name,
+                                         bdev_name=args.bdev_name)
+
+    p = subparsers.add_parser('bdev_qos_group_add_bdev',
+                              help='Add a bdev to a QoS group')
+    p.add_argument('name', help='QoS group name')
+    p.add_argument('bdev_name', help='Blockdev name. Example: Malloc0')
+    p.set_defaults(func=bdev_qos_group_add_bdev)
+
+    def bdev_qos_group_remove_bdev(args):
+        rpc.bdev.bdev_qos_group_remove_bdev(args.client,
+                                            name=args.name,
+                                            bdev_name=args.bdev_name)
+
+    p = subparsers.add_parser('bdev_qos_group_remove_bdev',
+                              help='Remove a bdev from a QoS group')
+    p.add_argument('name', help='QoS group name')
+    p.add_argument('bdev_name', help='Blockdev name. Example: Malloc0')
+    p.set_defaults(func=bdev_qos_group_remove_bdev)
+
+    def bdev_set_qos_latency_target(args):
+        rpc.bdev.bdev_set_qos_latency_target(args.client,
+                                             name=args.name,
+                                             latency_target_us=args.latency_target_us)
+
+    p = subparsers.add_parser('bdev_set_qos_latency_target',
+                              help='Set the p99 latency target of a bdev; best-effort bdevs in its QoS group are throttled to meet it')
+    p.add_argument('name', help='Blockdev name. Example: Malloc0')
+    p.add_argument('latency_target_us', help='Latency target in microseconds. 0 removes the target', type=int)
+    p.set_defaults(func=bdev_set_qos_latency_target)
+
+    def bdev_set_merge_opts(args):
+        rpc.bdev.bdev_set_merge_opts(args.client,
+                                     name=args.name,
+                                     window_us=args.window_us,
+                                     max_ios=args.max_ios,
+                                     max_blocks=args.max_blocks)
+
+    p = subparsers.add_parser('bdev_set_merge_opts',
+                              help='Merge contiguous reads and writes to a bdev into a single I/O')
+    p.add_argument('name', help='Blockdev name. Example: Nvme0n1')
+    p.add_argument('window_us', help='Maximum time in microseconds an I/O is held back. 0 disables merging', type=int)
+    p.add_argument('-i', '--max-ios', help='Maximum number of I/O merged into one (2-32)', type=int)
+    p.add_argument('-b', '--max-blocks', help='Maximum size of a merged I/O in blocks', type=int)
+    p.set_defaults(func=bdev_set_merge_opts)
+
+    def bdev_get_qos_groups(args):
+        print_dict(rpc.bdev.bdev_get_qos_groups(args.client,
+                                                name=args.name))
+
+    p = subparsers.add_parser('bdev_get_qos_groups',
+                              help='Display QoS groups with their rate limits and bdevs')
+    p.add_argument('-n', '--name', help='Name of the QoS group to query', required=False)
+    p.set_defaults(func=bdev_get_qos_groups)
+
     def bdev_error_inject_error(args):
         rpc.bdev.bdev_error_inject_error(args.client,
                                          name=args.name,
@@ -2434,7 +2660,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
         rpc.nvmf.nvmf_set_config(args.client,
                                  passthru_identify_ctrlr=args.passthru_identify_ctrlr,
                                  poll_groups_mask=args.poll_groups_mask,
-                                 discovery_filter=args.discovery_filter)
+                                 discovery_filter=args.discovery_filter,
+                                 qpair_rebalance_period_us=args.qpair_rebalance_period_us)
 
     p = subparsers.add_parser('nvmf_set_config', help='Set NVMf target config')
     p.add_argument('-i', '--passthru-identify-ctrlr', help="""Passthrough fields like serial number and model number
@@ -2442,6 +2669,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('-m', '--poll-groups-mask', help='Set cpumask for NVMf poll groups (optional)', type=str)
     p.add_argument('-d', '--discovery-filter', help="""Set discovery filter (optional), possible values are: `match_any` (default) or
          comma separated values: `transport`, `address`, `svcid`""", type=str)
+    p.add_argument('-r', '--qpair-rebalance-period-us', help="""Period of moving I/O qpairs between poll groups
+    to balance their load, 0 to disable (optional)""", type=int)
     p.set_defaults(func=nvmf_set_config)
 
     def nvmf_create_transport(args):
@@ -2472,6 +2701,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('-w', '--no-wr-batching', action='store_true', help='Disable work requests batching. Relevant only for RDMA transport')
     p.add_argument('-e', '--control-msg-num', help="""The number of control messages per poll group.
     Relevant only for TCP transport""", type=int)
+    p.add_argument('--recv-batch-size', help="""The size of the per poll group buffer sockets are read into
+    in batches, 0 to disable batching. Relevant only for TCP transport""", type=int)
     p.add_argument('-M', '--disable-mappable-bar0', action='store_true', help="""Disable mmap() of BAR0.
     Relevant only for VFIO-USER transport""")
     p.add_argument('-I', '--disable-adaptive-irq', action='store_true', help="""Disable adaptive interrupt feature.
@@ -2646,7 +2877,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
                                        nguid=args.nguid,
                                        eui64=args.eui64,
                                        uuid=args.uuid,
-                                       anagrpid=args.anagrpid)
+                                       anagrpid=args.anagrpid,
+                                       passthru_io=args.passthru_io)
 
     p = subparsers.add_parser('nvmf_subsystem_add_ns', help='Add a namespace to an NVMe-oF subsystem')
     p.add_argument('nqn', help='NVMe-oF subsystem NQN')
@@ -2658,6 +2890,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('-e', '--eui64', help='Namespace EUI-64 identifier (optional)')
     p.add_argument('-u', '--uuid', help='Namespace UUID (optional)')
     p.add_argument('-a', '--anagrpid', help='ANA group ID (optional)', type=int)
+    p.add_argument('--passthru-io', help="""Forward I/O commands unchanged to the bdev as NVMe
+    passthrough commands (optional)""", action='store_true')
     p.set_defaults(func=nvmf_subsystem_add_ns)
 
     def nvmf_subsystem_remove_ns(args):
@@ -2711,6 +2945,50 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('-t', '--tgt-name', help='The name of the parent NVMe-oF target (optional)', type=str)
     p.set_defaults(func=nvmf_subsystem_allow_any_host)
 
+    def nvmf_subsystem_set_fair_queuing(args):
+        rpc.nvmf.nvmf_subsystem_set_fair_queuing(args.client,
+                                                 nqn=args.nqn,
+                                                 max_inflight=args.max_inflight,
+                                                 tgt_name=args.tgt_name)
+
+    p = subparsers.add_parser('nvmf_subsystem_set_fair_queuing',
+                              help='Configure weighted fair queuing of I/O in a subsystem')
+    p.add_argument('nqn', help='NVMe-oF subsystem NQN')
+    p.add_argument('max_inflight', help='Number of READ and WRITE commands each poll group runs at once before '
+                   'it starts queuing them, 0 disables fair queuing', type=int)
+    p.add_argument('-t', '--tgt-name', help='The name of the parent NVMe-oF target (optional)', type=str)
+    p.set_defaults(func=nvmf_subsystem_set_fair_queuing)
+
+    def nvmf_subsystem_set_host_weight(args):
+        rpc.nvmf.nvmf_subsystem_set_host_weight(args.client,
+                                                nqn=args.nqn,
+                                                host=args.host,
+                                                weight=args.weight,
+                                                tgt_name=args.tgt_name)
+
+    p = subparsers.add_parser('nvmf_subsystem_set_host_weight',
+                              help='Set the fair queuing weight of a host of a subsystem')
+    p.add_argument('nqn', help='NVMe-oF subsystem NQN')
+    p.add_argument('host', help='Host NQN')
+    p.add_argument('weight', help='Weight of the host, from 1 to 1000', type=int)
+    p.add_argument('-t', '--tgt-name', help='The name of the parent NVMe-oF target (optional)', type=str)
+    p.set_defaults(func=nvmf_subsystem_set_host_weight)
+
+    def nvmf_subsystem_set_ns_weight(args):
+        rpc.nvmf.nvmf_subsystem_set_ns_weight(args.client,
+                                              nqn=args.nqn,
+                                              nsid=args.nsid,
+                                              weight=args.weight,
+                                              tgt_name=args.tgt_name)
+
+    p = subparsers.add_parser('nvmf_subsystem_set_ns_weight',
+                              help='Set the fair queuing weight of a namespace of a subsystem')
+    p.add_argument('nqn', help='NVMe-oF subsystem NQN')
+    p.add_argument('nsid', help='Namespace ID', type=int)
+    p.add_argument('weight', help='Weight of the namespace, from 1 to 1000', type=int)
+    p.add_argument('-t', '--tgt-name', help='The name of the parent NVMe-oF target (optional)', type=str)
+    p.set_defaults(func=nvmf_subsystem_set_ns_weight)
+
     def nvmf_subsystem_get_controllers(args):
         print_dict(rpc.nvmf.nvmf_subsystem_get_controllers(args.client,
                                                            nqn=args.nqn,
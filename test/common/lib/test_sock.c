@@ -40,6 +40,7 @@ DEFINE_STUB(spdk_sock_group_remove_sock, int, (struct spdk_sock_group *group,
 DEFINE_STUB(spdk_sock_group_poll, int, (struct spdk_sock_group *group), 0);
 DEFINE_STUB(spdk_sock_group_poll_count, int, (struct spdk_sock_group *group, int max_events), 0);
 DEFINE_STUB(spdk_sock_group_close, int, (struct spdk_sock_group **group), 0);
+DEFINE_STUB(spdk_sock_group_get_interrupt_fd, int, (struct spdk_sock_group *group), -ENOTSUP);
 DEFINE_STUB(spdk_sock_group_provide_buf, int, (struct spdk_sock_group *group, void *buf, size_t len,
 		void *ctx), 0);
 
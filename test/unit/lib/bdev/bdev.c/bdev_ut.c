@@ -3442,6 +3442,546 @@ bdev_io_alignment(void)
 	free(buf);
 }
 
+static void
+bdev_channel_io_pool(void)
+{
+	struct spdk_bdev *bdev;
+	struct spdk_bdev_desc *desc = NULL;
+	struct spdk_io_channel *io_ch;
+	struct spdk_bdev_channel *bdev_ch;
+	struct spdk_bdev_channel_io_pool_opts opts;
+	struct spdk_bdev_io *pool_io;
+	struct spdk_bdev_opts bdev_opts = {};
+	void *bufs = NULL, *buf0, *buf1;
+	int rc;
+
+	spdk_bdev_get_opts(&bdev_opts, sizeof(bdev_opts));
+	bdev_opts.bdev_io_pool_size = 20;
+	bdev_opts.bdev_io_cache_size = 2;
+	ut_init_bdev(&bdev_opts);
+
+	fn_table.submit_request = stub_submit_request_get_buf;
+	bdev = allocate_bdev("bdev0");
+	bdev->required_alignment = spdk_u32log2(512);
+
+	rc = spdk_bdev_open_ext("bdev0", true, bdev_ut_event_cb, NULL, &desc);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(desc != NULL);
+	io_ch = spdk_bdev_get_io_channel(desc);
+	SPDK_CU_ASSERT_FATAL(io_ch != NULL);
+	bdev_ch = spdk_io_channel_get_ctx(io_ch);
+
+	rc = posix_memalign(&bufs, 4096, 2 * 4096);
+	SPDK_CU_ASSERT_FATAL(rc == 0);
+
+	/* Nothing registered yet */
+	CU_ASSERT(spdk_bdev_channel_get_pool_buf(io_ch) == NULL);
+	CU_ASSERT(spdk_bdev_channel_unregister_io_pool(io_ch) == -ENOENT);
+
+	/* Buffer pool not aligned to the bdev's requirement */
+	spdk_bdev_channel_io_pool_opts_init(&opts, sizeof(opts));
+	opts.num_bdev_ios = 1;
+	opts.buf_pool = (uint8_t *)bufs + 4;
+	opts.buf_size = 4096;
+	opts.num_bufs = 1;
+	rc = spdk_bdev_channel_register_io_pool(io_ch, &opts);
+	CU_ASSERT(rc == -EINVAL);
+
+	opts.buf_pool = bufs;
+	opts.buf_size = 4096 + 4;
+	rc = spdk_bdev_channel_register_io_pool(io_ch, &opts);
+	CU_ASSERT(rc == -EINVAL);
+
+	opts.buf_size = 4096;
+	opts.num_bufs = 2;
+	rc = spdk_bdev_channel_register_io_pool(io_ch, &opts);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(bdev_ch->bufs_aligned);
+
+	rc = spdk_bdev_channel_register_io_pool(io_ch, &opts);
+	CU_ASSERT(rc == -EEXIST);
+
+	/* Buffers are handed out in address order and the pool runs dry */
+	buf0 = spdk_bdev_channel_get_pool_buf(io_ch);
+	buf1 = spdk_bdev_channel_get_pool_buf(io_ch);
+	CU_ASSERT(buf0 == bufs);
+	CU_ASSERT(buf1 == (uint8_t *)bufs + 4096);
+	CU_ASSERT(spdk_bdev_channel_get_pool_buf(io_ch) == NULL);
+
+	/* The first I/O takes its bdev_io from the pool */
+	rc = spdk_bdev_read_blocks(desc, io_ch, buf0, 0, 1, io_done, NULL);
+	CU_ASSERT(rc == 0);
+	pool_io = g_bdev_io;
+	CU_ASSERT(pool_io == bdev_ch->io_pool->ios);
+	CU_ASSERT(bdev_ch->io_pool->num_free_ios == 0);
+	CU_ASSERT(g_bdev_io->internal.orig_iovcnt == 0);
+	CU_ASSERT(g_bdev_io->u.bdev.iovs[0].iov_base == buf0);
+
+	/*
+	 * The second one falls back to the global pool. Buffers aren't checked for alignment
+	 * anymore, so even an unaligned one isn't bounced.
+	 */
+	rc = spdk_bdev_read_blocks(desc, io_ch, (uint8_t *)buf1 + 4, 0, 1, io_done, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_bdev_io != pool_io);
+	CU_ASSERT(g_bdev_io->internal.orig_iovcnt == 0);
+	CU_ASSERT(g_bdev_io->u.bdev.iovs[0].iov_base == (uint8_t *)buf1 + 4);
+
+	/* The pool can't go away while it's in use */
+	CU_ASSERT(spdk_bdev_channel_unregister_io_pool(io_ch) == -EBUSY);
+
+	stub_complete_io(2);
+	CU_ASSERT(bdev_ch->io_pool->num_free_ios == 1);
+	CU_ASSERT(spdk_bdev_channel_unregister_io_pool(io_ch) == -EBUSY);
+
+	spdk_bdev_channel_put_pool_buf(io_ch, buf1);
+	spdk_bdev_channel_put_pool_buf(io_ch, buf0);
+	CU_ASSERT(spdk_bdev_channel_get_pool_buf(io_ch) == buf0);
+	spdk_bdev_channel_put_pool_buf(io_ch, buf0);
+
+	CU_ASSERT(spdk_bdev_channel_unregister_io_pool(io_ch) == 0);
+	CU_ASSERT(bdev_ch->io_pool == NULL);
+	CU_ASSERT(!bdev_ch->bufs_aligned);
+
+	/* Without the buffer pool, unaligned buffers are bounced again */
+	rc = spdk_bdev_read_blocks(desc, io_ch, (uint8_t *)buf1 + 4, 0, 1, io_done, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_bdev_io->internal.orig_iovcnt == 1);
+	stub_complete_io(1);
+
+	/* A pool with bdev_ios only is released along with the channel */
+	spdk_bdev_channel_io_pool_opts_init(&opts, sizeof(opts));
+	opts.num_bdev_ios = 4;
+	rc = spdk_bdev_channel_register_io_pool(io_ch, &opts);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(!bdev_ch->bufs_aligned);
+
+	spdk_put_io_channel(io_ch);
+	spdk_bdev_close(desc);
+	free_bdev(bdev);
+	fn_table.submit_request = stub_submit_request;
+	ut_fini_bdev();
+
+	free(bufs);
+}
+
+static void
+bdev_channel_io_pool_io_wait(void)
+{
+	struct spdk_bdev *bdev;
+	struct spdk_bdev_desc *desc = NULL;
+	struct spdk_io_channel *io_ch;
+	struct spdk_bdev_channel *bdev_ch;
+	struct spdk_bdev_channel_io_pool_opts opts;
+	struct spdk_bdev_opts bdev_opts = {};
+	struct bdev_ut_io_wait_entry io_wait_entry;
+	int rc, i;
+
+	spdk_bdev_get_opts(&bdev_opts, sizeof(bdev_opts));
+	bdev_opts.bdev_io_pool_size = 4;
+	bdev_opts.bdev_io_cache_size = 2;
+	ut_init_bdev(&bdev_opts);
+
+	bdev = allocate_bdev("bdev0");
+
+	rc = spdk_bdev_open_ext("bdev0", true, bdev_ut_event_cb, NULL, &desc);
+	CU_ASSERT(rc == 0);
+	poll_threads();
+	SPDK_CU_ASSERT_FATAL(desc != NULL);
+	io_ch = spdk_bdev_get_io_channel(desc);
+	SPDK_CU_ASSERT_FATAL(io_ch != NULL);
+	bdev_ch = spdk_io_channel_get_ctx(io_ch);
+
+	spdk_bdev_channel_io_pool_opts_init(&opts, sizeof(opts));
+	opts.num_bdev_ios = 1;
+	rc = spdk_bdev_channel_register_io_pool(io_ch, &opts);
+	CU_ASSERT(rc == 0);
+
+	/* Use up the channel's pool first, then the global bdev_ios */
+	for (i = 0; i < 5; i++) {
+		rc = spdk_bdev_read_blocks(desc, io_ch, NULL, 0, 1, io_done, NULL);
+		CU_ASSERT(rc == 0);
+	}
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 5);
+	CU_ASSERT(bdev_ch->io_pool->num_free_ios == 0);
+
+	rc = spdk_bdev_read_blocks(desc, io_ch, NULL, 0, 1, io_done, NULL);
+	CU_ASSERT(rc == -ENOMEM);
+
+	io_wait_entry.entry.bdev = bdev;
+	io_wait_entry.entry.cb_fn = io_wait_cb;
+	io_wait_entry.entry.cb_arg = &io_wait_entry;
+	io_wait_entry.io_ch = io_ch;
+	io_wait_entry.desc = desc;
+	io_wait_entry.submitted = false;
+	rc = spdk_bdev_queue_io_wait(bdev, io_ch, &io_wait_entry.entry);
+	CU_ASSERT(rc == 0);
+
+	/* Returning the pool's bdev_io wakes up the waiter, which takes it again */
+	stub_complete_io(1);
+	CU_ASSERT(io_wait_entry.submitted == true);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 5);
+	CU_ASSERT(bdev_ch->io_pool->num_free_ios == 0);
+
+	stub_complete_io(5);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 0);
+	CU_ASSERT(bdev_ch->io_pool->num_free_ios == 1);
+
+	spdk_put_io_channel(io_ch);
+	spdk_bdev_close(desc);
+	free_bdev(bdev);
+	ut_fini_bdev();
+}
+
+static uint32_t g_batch_count;
+static uint32_t g_batch_num_ios;
+
+static void
+stub_submit_request_batch(struct spdk_io_channel *_ch, struct spdk_bdev_io **bdev_ios,
+			  uint32_t num_ios)
+{
+	uint32_t i;
+
+	g_batch_count++;
+	g_batch_num_ios = num_ios;
+
+	for (i = 0; i < num_ios; i++) {
+		CU_ASSERT(bdev_ios[i]->internal.in_submit_request == true);
+		stub_submit_request(_ch, bdev_ios[i]);
+	}
+}
+
+static void
+bdev_submit_batch(void)
+{
+	struct spdk_bdev *bdev;
+	struct spdk_bdev_desc *desc = NULL;
+	struct spdk_io_channel *io_ch;
+	struct spdk_bdev_opts bdev_opts = {};
+	struct spdk_bdev_batch_io ios[40] = {};
+	char buf[512];
+	struct iovec iov = { .iov_base = buf, .iov_len = sizeof(buf) };
+	uint32_t i;
+	int rc;
+
+	spdk_bdev_get_opts(&bdev_opts, sizeof(bdev_opts));
+	bdev_opts.bdev_io_pool_size = 64;
+	bdev_opts.bdev_io_cache_size = 2;
+	ut_init_bdev(&bdev_opts);
+
+	bdev = allocate_bdev("bdev0");
+
+	rc = spdk_bdev_open_ext("bdev0", true, bdev_ut_event_cb, NULL, &desc);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(desc != NULL);
+	io_ch = spdk_bdev_get_io_channel(desc);
+	SPDK_CU_ASSERT_FATAL(io_ch != NULL);
+
+	for (i = 0; i < SPDK_COUNTOF(ios); i++) {
+		ios[i].type = i % 2 ? SPDK_BDEV_IO_TYPE_WRITE : SPDK_BDEV_IO_TYPE_READ;
+		ios[i].iovs = &iov;
+		ios[i].iovcnt = 1;
+		ios[i].offset_blocks = i;
+		ios[i].num_blocks = 1;
+		ios[i].cb = io_done;
+	}
+
+	/* Without batch support in the module, I/O are submitted one by one */
+	g_batch_count = 0;
+	rc = spdk_bdev_submit_batch(desc, io_ch, ios, 3);
+	CU_ASSERT(rc == 3);
+	CU_ASSERT(g_batch_count == 0);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 3);
+	stub_complete_io(3);
+
+	/* The module gets the whole batch at once */
+	fn_table.submit_request_batch = stub_submit_request_batch;
+	rc = spdk_bdev_submit_batch(desc, io_ch, ios, 3);
+	CU_ASSERT(rc == 3);
+	CU_ASSERT(g_batch_count == 1);
+	CU_ASSERT(g_batch_num_ios == 3);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 3);
+	stub_complete_io(3);
+
+	/* Large batches are handed over in chunks */
+	g_batch_count = 0;
+	rc = spdk_bdev_submit_batch(desc, io_ch, ios, SPDK_COUNTOF(ios));
+	CU_ASSERT(rc == SPDK_COUNTOF(ios));
+	CU_ASSERT(g_batch_count == 2);
+	CU_ASSERT(g_batch_num_ios == SPDK_COUNTOF(ios) - 32);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == SPDK_COUNTOF(ios));
+	stub_complete_io(SPDK_COUNTOF(ios));
+
+	/* Submission stops at the first invalid I/O, the ones before it are still submitted */
+	g_batch_count = 0;
+	ios[2].offset_blocks = bdev->blockcnt;
+	rc = spdk_bdev_submit_batch(desc, io_ch, ios, 3);
+	CU_ASSERT(rc == 2);
+	CU_ASSERT(g_batch_count == 1);
+	CU_ASSERT(g_batch_num_ios == 2);
+	stub_complete_io(2);
+
+	g_batch_count = 0;
+	rc = spdk_bdev_submit_batch(desc, io_ch, &ios[2], 1);
+	CU_ASSERT(rc == -EINVAL);
+	CU_ASSERT(g_batch_count == 0);
+	ios[2].offset_blocks = 2;
+
+	ios[0].type = SPDK_BDEV_IO_TYPE_FLUSH;
+	rc = spdk_bdev_submit_batch(desc, io_ch, ios, 3);
+	CU_ASSERT(rc == -EINVAL);
+	CU_ASSERT(g_batch_count == 0);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 0);
+
+	fn_table.submit_request_batch = NULL;
+	spdk_put_io_channel(io_ch);
+	spdk_bdev_close(desc);
+	free_bdev(bdev);
+	ut_fini_bdev();
+}
+
+static uint32_t g_merge_num_done;
+static enum spdk_bdev_io_status g_merge_status;
+
+static void
+merge_io_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	g_merge_num_done++;
+	g_merge_status = bdev_io->internal.status;
+	spdk_bdev_free_io(bdev_io);
+}
+
+static void
+merge_opts_done(void *cb_arg, int status)
+{
+	g_status = status;
+}
+
+static void
+bdev_merge(void)
+{
+	struct spdk_bdev *bdev;
+	struct spdk_bdev_desc *desc = NULL;
+	struct spdk_io_channel *io_ch;
+	struct spdk_bdev_channel *bdev_ch;
+	struct spdk_bdev_merge_opts opts;
+	struct spdk_bdev_ext_io_opts ext_io_opts;
+	struct ut_expected_io *expected_io;
+	struct iovec iov[3];
+	char buf[8][512];
+	uint32_t i;
+	int rc;
+
+	ut_init_bdev(NULL);
+
+	bdev = allocate_bdev("bdev0");
+
+	rc = spdk_bdev_open_ext("bdev0", true, bdev_ut_event_cb, NULL, &desc);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(desc != NULL);
+	io_ch = spdk_bdev_get_io_channel(desc);
+	SPDK_CU_ASSERT_FATAL(io_ch != NULL);
+	bdev_ch = spdk_io_channel_get_ctx(io_ch);
+
+	spdk_bdev_get_merge_opts(bdev, &opts, sizeof(opts));
+	CU_ASSERT(opts.window_us == 0);
+	CU_ASSERT(opts.max_ios == 32);
+	CU_ASSERT(opts.max_blocks == 0);
+
+	/* Merging at most a single I/O is not allowed */
+	opts.window_us = 100;
+	opts.max_ios = 1;
+	g_status = 1;
+	spdk_bdev_set_merge_opts(bdev, &opts, merge_opts_done, NULL);
+	CU_ASSERT(g_status == -EINVAL);
+
+	opts.max_ios = 4;
+	g_status = 1;
+	spdk_bdev_set_merge_opts(bdev, &opts, merge_opts_done, NULL);
+	poll_threads();
+	CU_ASSERT(g_status == 0);
+
+	/* Contiguous writes are held back for the window and submitted as one */
+	g_merge_num_done = 0;
+	for (i = 0; i < 3; i++) {
+		rc = spdk_bdev_write_blocks(desc, io_ch, buf[i], i, 1, merge_io_done, NULL);
+		CU_ASSERT(rc == 0);
+	}
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 0);
+
+	expected_io = ut_alloc_expected_io(SPDK_BDEV_IO_TYPE_WRITE, 0, 3, 3);
+	for (i = 0; i < 3; i++) {
+		ut_expected_io_set_iov(expected_io, i, buf[i], sizeof(buf[i]));
+	}
+	TAILQ_INSERT_TAIL(&g_bdev_ut_channel->expected_io, expected_io, link);
+
+	spdk_delay_us(100);
+	poll_threads();
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 1);
+	CU_ASSERT(g_bdev_io->u.bdev.num_blocks == 3);
+	CU_ASSERT(g_merge_num_done == 0);
+
+	stub_complete_io(1);
+	poll_threads();
+	CU_ASSERT(g_merge_num_done == 3);
+	CU_ASSERT(g_merge_status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	/* The statistics count the original writes, not the merged one */
+	CU_ASSERT(bdev_ch->stat->num_write_ops == 3);
+	CU_ASSERT(bdev_ch->stat->bytes_written == 3 * bdev->blocklen);
+	CU_ASSERT(bdev_ch->io_outstanding == 0);
+
+	/* Reaching max_ios submits the merged I/O right away */
+	g_merge_num_done = 0;
+	for (i = 0; i < 4; i++) {
+		rc = spdk_bdev_read_blocks(desc, io_ch, buf[i], 8 + i, 1, merge_io_done, NULL);
+		CU_ASSERT(rc == 0);
+	}
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 1);
+	CU_ASSERT(g_bdev_io->type == SPDK_BDEV_IO_TYPE_READ);
+	CU_ASSERT(g_bdev_io->u.bdev.offset_blocks == 8);
+	CU_ASSERT(g_bdev_io->u.bdev.num_blocks == 4);
+	CU_ASSERT(g_bdev_io->u.bdev.iovcnt == 4);
+
+	stub_complete_io(1);
+	poll_threads();
+	CU_ASSERT(g_merge_num_done == 4);
+
+	/* A non-contiguous I/O or one of a different type submits the held back ones */
+	g_merge_num_done = 0;
+	rc = spdk_bdev_write_blocks(desc, io_ch, buf[0], 0, 1, merge_io_done, NULL);
+	CU_ASSERT(rc == 0);
+	rc = spdk_bdev_write_blocks(desc, io_ch, buf[1], 10, 1, merge_io_done, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 1);
+	rc = spdk_bdev_read_blocks(desc, io_ch, buf[2], 11, 1, merge_io_done, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 2);
+	rc = spdk_bdev_flush_blocks(desc, io_ch, 0, 1, merge_io_done, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 4);
+
+	stub_complete_io(4);
+	poll_threads();
+	CU_ASSERT(g_merge_num_done == 4);
+
+	/* Errors are reported to all original I/O */
+	g_merge_num_done = 0;
+	g_io_exp_status = SPDK_BDEV_IO_STATUS_FAILED;
+	for (i = 0; i < 2; i++) {
+		rc = spdk_bdev_write_blocks(desc, io_ch, buf[i], i, 1, merge_io_done, NULL);
+		CU_ASSERT(rc == 0);
+	}
+	spdk_delay_us(100);
+	poll_threads();
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 1);
+
+	stub_complete_io(1);
+	poll_threads();
+	CU_ASSERT(g_merge_num_done == 2);
+	CU_ASSERT(g_merge_status == SPDK_BDEV_IO_STATUS_FAILED);
+	g_io_exp_status = SPDK_BDEV_IO_STATUS_SUCCESS;
+
+	/* Only writes with the same placement hint are merged, and the hint is kept */
+	memset(&ext_io_opts, 0, sizeof(ext_io_opts));
+	ext_io_opts.size = sizeof(ext_io_opts);
+	g_merge_num_done = 0;
+	for (i = 0; i < 3; i++) {
+		iov[i].iov_base = buf[i];
+		iov[i].iov_len = sizeof(buf[i]);
+		ext_io_opts.placement_hint = i < 2 ? 1 : 2;
+		rc = spdk_bdev_writev_blocks_ext(desc, io_ch, &iov[i], 1, i, 1, merge_io_done, NULL,
+						 &ext_io_opts);
+		CU_ASSERT(rc == 0);
+	}
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 1);
+	CU_ASSERT(g_bdev_io->u.bdev.offset_blocks == 0);
+	CU_ASSERT(g_bdev_io->u.bdev.num_blocks == 2);
+	CU_ASSERT(g_bdev_io->u.bdev.placement_hint == 1);
+
+	spdk_delay_us(100);
+	poll_threads();
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 2);
+	CU_ASSERT(g_bdev_io->u.bdev.offset_blocks == 2);
+	CU_ASSERT(g_bdev_io->u.bdev.num_blocks == 1);
+	CU_ASSERT(g_bdev_io->u.bdev.placement_hint == 2);
+
+	stub_complete_io(2);
+	poll_threads();
+	CU_ASSERT(g_merge_num_done == 3);
+
+	/* Merged I/O don't cross the optimal I/O boundary */
+	bdev->optimal_io_boundary = 4;
+	bdev->split_on_optimal_io_boundary = true;
+	g_merge_num_done = 0;
+	for (i = 0; i < 3; i++) {
+		rc = spdk_bdev_write_blocks(desc, io_ch, buf[i], 2 + i, 1, merge_io_done, NULL);
+		CU_ASSERT(rc == 0);
+	}
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 1);
+	CU_ASSERT(g_bdev_io->u.bdev.offset_blocks == 2);
+	CU_ASSERT(g_bdev_io->u.bdev.num_blocks == 2);
+
+	spdk_delay_us(100);
+	poll_threads();
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 2);
+	CU_ASSERT(g_bdev_io->u.bdev.offset_blocks == 4);
+	CU_ASSERT(g_bdev_io->u.bdev.num_blocks == 1);
+
+	stub_complete_io(2);
+	poll_threads();
+	CU_ASSERT(g_merge_num_done == 3);
+	bdev->optimal_io_boundary = 0;
+	bdev->split_on_optimal_io_boundary = false;
+
+	/* A reset aborts the held back I/O */
+	g_merge_num_done = 0;
+	rc = spdk_bdev_write_blocks(desc, io_ch, buf[0], 0, 1, merge_io_done, NULL);
+	CU_ASSERT(rc == 0);
+	g_io_done = false;
+	rc = spdk_bdev_reset(desc, io_ch, io_done, NULL);
+	CU_ASSERT(rc == 0);
+	poll_threads();
+	CU_ASSERT(g_merge_num_done == 1);
+	CU_ASSERT(g_merge_status == SPDK_BDEV_IO_STATUS_ABORTED);
+	stub_complete_io(1);
+	poll_threads();
+	CU_ASSERT(g_io_done == true);
+
+	/* Channels created later merge too */
+	spdk_put_io_channel(io_ch);
+	poll_threads();
+	io_ch = spdk_bdev_get_io_channel(desc);
+	SPDK_CU_ASSERT_FATAL(io_ch != NULL);
+
+	g_merge_num_done = 0;
+	for (i = 0; i < 2; i++) {
+		rc = spdk_bdev_write_blocks(desc, io_ch, buf[i], i, 1, merge_io_done, NULL);
+		CU_ASSERT(rc == 0);
+	}
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 0);
+
+	/* Disabling merging submits the held back I/O */
+	opts.window_us = 0;
+	spdk_bdev_set_merge_opts(bdev, &opts, merge_opts_done, NULL);
+	poll_threads();
+	CU_ASSERT(g_status == 0);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 1);
+	CU_ASSERT(g_bdev_io->u.bdev.num_blocks == 2);
+
+	rc = spdk_bdev_write_blocks(desc, io_ch, buf[2], 2, 1, merge_io_done, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 2);
+
+	stub_complete_io(2);
+	poll_threads();
+	CU_ASSERT(g_merge_num_done == 3);
+
+	spdk_put_io_channel(io_ch);
+	spdk_bdev_close(desc);
+	free_bdev(bdev);
+	ut_fini_bdev();
+}
+
 static void
 bdev_io_alignment_with_boundary(void)
 {
@@ -3707,6 +4247,148 @@ bdev_histograms(void)
 	ut_fini_bdev();
 }
 
+static struct spdk_bdev_histogram_breakdown g_breakdown;
+
+static void
+histogram_breakdown_cb(void *cb_arg, int status, struct spdk_bdev_histogram_breakdown *breakdown)
+{
+	uint32_t type, i;
+
+	g_status = status;
+	memset(&g_breakdown, 0, sizeof(g_breakdown));
+	if (status != 0) {
+		return;
+	}
+
+	/* The breakdown is only valid within the callback, so save the counts instead */
+	g_breakdown.num_size_classes = breakdown->num_size_classes;
+	memcpy(g_breakdown.size_class_bounds, breakdown->size_class_bounds,
+	       sizeof(g_breakdown.size_class_bounds));
+	for (type = 0; type < SPDK_BDEV_NUM_IO_TYPES; type++) {
+		for (i = 0; i < breakdown->num_size_classes; i++) {
+			if (breakdown->histogram[type][i] == NULL) {
+				continue;
+			}
+			g_count = 0;
+			spdk_histogram_data_iterate(breakdown->histogram[type][i], histogram_io_count, NULL);
+			g_breakdown.histogram[type][i] = (void *)(uintptr_t)g_count;
+		}
+	}
+}
+
+static void
+bdev_histogram_breakdown(void)
+{
+	struct spdk_bdev *bdev;
+	struct spdk_bdev_desc *desc = NULL;
+	struct spdk_bdev_enable_histogram_opts opts;
+	struct spdk_io_channel *ch;
+	struct spdk_histogram_data *histogram;
+	uint8_t buf[8192];
+	int rc;
+
+	ut_init_bdev(NULL);
+
+	bdev = allocate_bdev("bdev");
+
+	rc = spdk_bdev_open_ext("bdev", true, bdev_ut_event_cb, NULL, &desc);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(desc != NULL);
+
+	ch = spdk_bdev_get_io_channel(desc);
+	CU_ASSERT(ch != NULL);
+
+	/* Plain histogram doesn't provide breakdown */
+	g_status = -1;
+	spdk_bdev_histogram_enable(bdev, histogram_status_cb, NULL, true);
+	poll_threads();
+	CU_ASSERT(g_status == 0);
+
+	spdk_bdev_histogram_get_breakdown(bdev, histogram_breakdown_cb, NULL);
+	poll_threads();
+	CU_ASSERT(g_status == -EFAULT);
+
+	/* Size class bounds have to be ascending */
+	spdk_bdev_enable_histogram_opts_init(&opts, sizeof(opts));
+	opts.breakdown = true;
+	opts.num_size_class_bounds = 2;
+	opts.size_class_bounds[0] = 4096;
+	opts.size_class_bounds[1] = 4096;
+	g_status = 0;
+	spdk_bdev_histogram_enable_ext(bdev, histogram_status_cb, NULL, true, &opts);
+	poll_threads();
+	CU_ASSERT(g_status == -EINVAL);
+
+	/* Enable breakdown with size classes: <= 4KiB and > 4KiB */
+	opts.num_size_class_bounds = 1;
+	g_status = -1;
+	spdk_bdev_histogram_enable_ext(bdev, histogram_status_cb, NULL, true, &opts);
+	poll_threads();
+	CU_ASSERT(g_status == 0);
+	CU_ASSERT(bdev->internal.histogram_enabled == true);
+
+	rc = spdk_bdev_write_blocks(desc, ch, buf, 0, 1, io_done, NULL);
+	CU_ASSERT(rc == 0);
+	spdk_delay_us(10);
+	stub_complete_io(1);
+	poll_threads();
+
+	rc = spdk_bdev_read_blocks(desc, ch, buf, 0, 1, io_done, NULL);
+	CU_ASSERT(rc == 0);
+	spdk_delay_us(10);
+	stub_complete_io(1);
+	poll_threads();
+
+	rc = spdk_bdev_read_blocks(desc, ch, buf, 0, 16, io_done, NULL);
+	CU_ASSERT(rc == 0);
+	spdk_delay_us(10);
+	stub_complete_io(1);
+	poll_threads();
+
+	spdk_bdev_histogram_get_breakdown(bdev, histogram_breakdown_cb, NULL);
+	poll_threads();
+	CU_ASSERT(g_status == 0);
+	CU_ASSERT(g_breakdown.num_size_classes == 2);
+	CU_ASSERT(g_breakdown.size_class_bounds[0] == 4096);
+	CU_ASSERT((uintptr_t)g_breakdown.histogram[SPDK_BDEV_IO_TYPE_WRITE][0] == 1);
+	CU_ASSERT(g_breakdown.histogram[SPDK_BDEV_IO_TYPE_WRITE][1] == NULL);
+	CU_ASSERT((uintptr_t)g_breakdown.histogram[SPDK_BDEV_IO_TYPE_READ][0] == 1);
+	CU_ASSERT((uintptr_t)g_breakdown.histogram[SPDK_BDEV_IO_TYPE_READ][1] == 1);
+	CU_ASSERT(g_breakdown.histogram[SPDK_BDEV_IO_TYPE_UNMAP][0] == NULL);
+
+	/* The aggregate histogram still counts everything */
+	histogram = spdk_histogram_data_alloc();
+	SPDK_CU_ASSERT_FATAL(histogram != NULL);
+	g_histogram = NULL;
+	spdk_bdev_histogram_get(bdev, histogram, histogram_data_cb, NULL);
+	poll_threads();
+	CU_ASSERT(g_status == 0);
+	SPDK_CU_ASSERT_FATAL(g_histogram != NULL);
+	g_count = 0;
+	spdk_histogram_data_iterate(g_histogram, histogram_io_count, NULL);
+	CU_ASSERT(g_count == 3);
+	spdk_histogram_data_free(histogram);
+
+	CU_ASSERT(strcmp(spdk_bdev_get_io_type_name(SPDK_BDEV_IO_TYPE_READ), "read") == 0);
+	CU_ASSERT(strcmp(spdk_bdev_get_io_type_name(SPDK_BDEV_IO_TYPE_WRITE_ZEROES),
+			 "write_zeroes") == 0);
+
+	/* Disable histogram */
+	spdk_bdev_histogram_enable(bdev, histogram_status_cb, NULL, false);
+	poll_threads();
+	CU_ASSERT(g_status == 0);
+	CU_ASSERT(bdev->internal.histogram_enabled == false);
+
+	spdk_bdev_histogram_get_breakdown(bdev, histogram_breakdown_cb, NULL);
+	poll_threads();
+	CU_ASSERT(g_status == -EFAULT);
+
+	spdk_put_io_channel(ch);
+	spdk_bdev_close(desc);
+	free_bdev(bdev);
+	ut_fini_bdev();
+}
+
 static void
 _bdev_compare(bool emulated)
 {
@@ -5927,6 +6609,7 @@ bdev_io_ext_split(void)
 	char io_buf[512];
 	struct iovec iov = { .iov_base = io_buf, .iov_len = 512 };
 	struct ut_expected_io *expected_io;
+	struct spdk_bdev_io *child_io;
 	struct spdk_bdev_ext_io_opts ext_io_opts = {
 		.metadata = (void *)0xFF000000,
 		.size = sizeof(ext_io_opts)
@@ -6004,6 +6687,31 @@ bdev_io_ext_split(void)
 	CU_ASSERT(g_io_done == true);
 	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 0);
 
+	/* write with a placement hint, the children keep it */
+	g_io_done = false;
+	ext_io_opts.placement_hint = 7;
+	expected_io = ut_alloc_expected_io(SPDK_BDEV_IO_TYPE_WRITE, 14, 2, 1);
+	expected_io->md_buf = ext_io_opts.metadata;
+	ut_expected_io_set_iov(expected_io, 0, (void *)0xF000, 2 * 512);
+	TAILQ_INSERT_TAIL(&g_bdev_ut_channel->expected_io, expected_io, link);
+
+	expected_io = ut_alloc_expected_io(SPDK_BDEV_IO_TYPE_WRITE, 16, 6, 1);
+	expected_io->md_buf = ext_io_opts.metadata + 2 * 8;
+	ut_expected_io_set_iov(expected_io, 0, (void *)(0xF000 + 2 * 512), 6 * 512);
+	TAILQ_INSERT_TAIL(&g_bdev_ut_channel->expected_io, expected_io, link);
+
+	rc = spdk_bdev_writev_blocks_ext(desc, io_ch, &iov, 1, 14, 8, io_done, NULL, &ext_io_opts);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_io_done == false);
+
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 2);
+	TAILQ_FOREACH(child_io, &g_bdev_ut_channel->outstanding_io, module_link) {
+		CU_ASSERT(child_io->u.bdev.placement_hint == 7);
+	}
+	stub_complete_io(2);
+	CU_ASSERT(g_io_done == true);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 0);
+
 	spdk_put_io_channel(io_ch);
 	spdk_bdev_close(desc);
 	free_bdev(bdev);
@@ -7424,7 +8132,12 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, bdev_io_write_unit_split_test);
 	CU_ADD_TEST(suite, bdev_io_alignment_with_boundary);
 	CU_ADD_TEST(suite, bdev_io_alignment);
+	CU_ADD_TEST(suite, bdev_channel_io_pool);
+	CU_ADD_TEST(suite, bdev_channel_io_pool_io_wait);
+	CU_ADD_TEST(suite, bdev_submit_batch);
+	CU_ADD_TEST(suite, bdev_merge);
 	CU_ADD_TEST(suite, bdev_histograms);
+	CU_ADD_TEST(suite, bdev_histogram_breakdown);
 	CU_ADD_TEST(suite, bdev_write_zeroes);
 	CU_ADD_TEST(suite, bdev_compare_and_write);
 	CU_ADD_TEST(suite, bdev_compare);
@@ -1845,6 +1845,375 @@ qos_dynamic_enable(void)
 	teardown_test();
 }
 
+static void
+qos_group(void)
+{
+	struct spdk_io_channel *io_ch[2];
+	struct spdk_bdev_channel *bdev_ch[2];
+	struct spdk_bdev *bdev;
+	enum spdk_bdev_io_status bdev_io_status;
+	uint64_t limits[SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES];
+	int status, rc, i;
+
+	setup_test();
+	MOCK_SET(spdk_get_ticks, 0);
+
+	bdev = &g_bdev.bdev;
+
+	set_thread(0);
+	io_ch[0] = spdk_bdev_get_io_channel(g_desc);
+	bdev_ch[0] = spdk_io_channel_get_ctx(io_ch[0]);
+	set_thread(1);
+	io_ch[1] = spdk_bdev_get_io_channel(g_desc);
+	bdev_ch[1] = spdk_io_channel_get_ctx(io_ch[1]);
+	set_thread(0);
+
+	/* Create a group allowing 10 I/O per timeslice */
+	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+		limits[i] = UINT64_MAX;
+	}
+	limits[SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT] = 10000;
+	rc = spdk_bdev_qos_group_create("group0", limits);
+	CU_ASSERT(rc == 0);
+	rc = spdk_bdev_qos_group_create("group0", limits);
+	CU_ASSERT(rc == -EEXIST);
+
+	/* Adding the bdev to a group that doesn't exist fails */
+	status = -1;
+	spdk_bdev_set_qos_group(bdev, "group1", qos_dynamic_enable_done, &status);
+	poll_threads();
+	CU_ASSERT(status == -ENOENT);
+	CU_ASSERT(spdk_bdev_get_qos_group(bdev) == NULL);
+
+	/* Adding the bdev enables QoS even though the bdev has no limits of its own */
+	status = -1;
+	spdk_bdev_set_qos_group(bdev, "group0", qos_dynamic_enable_done, &status);
+	poll_threads();
+	CU_ASSERT(status == 0);
+	CU_ASSERT((bdev_ch[0]->flags & BDEV_CH_QOS_ENABLED) != 0);
+	CU_ASSERT((bdev_ch[1]->flags & BDEV_CH_QOS_ENABLED) != 0);
+	SPDK_CU_ASSERT_FATAL(spdk_bdev_get_qos_group(bdev) != NULL);
+	CU_ASSERT(strcmp(spdk_bdev_get_qos_group(bdev), "group0") == 0);
+
+	/* The group can't be deleted while it has members */
+	rc = spdk_bdev_qos_group_delete("group0");
+	CU_ASSERT(rc == -EBUSY);
+
+	/* Use up the group's allotment for this timeslice */
+	for (i = 0; i < 10; i++) {
+		bdev_io_status = SPDK_BDEV_IO_STATUS_PENDING;
+		rc = spdk_bdev_read_blocks(g_desc, io_ch[0], NULL, 0, 1, io_during_io_done, &bdev_io_status);
+		CU_ASSERT(rc == 0);
+		poll_thread(0);
+		CU_ASSERT(stub_complete_io(g_bdev.io_target, 0) == 1);
+		poll_thread(0);
+		CU_ASSERT(bdev_io_status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	}
+
+	/* The next I/O is queued by the group limit */
+	bdev_io_status = SPDK_BDEV_IO_STATUS_PENDING;
+	rc = spdk_bdev_read_blocks(g_desc, io_ch[0], NULL, 0, 1, io_during_io_done, &bdev_io_status);
+	CU_ASSERT(rc == 0);
+	poll_threads();
+	CU_ASSERT(stub_complete_io(g_bdev.io_target, 0) == 0);
+	CU_ASSERT(bdev_io_status == SPDK_BDEV_IO_STATUS_PENDING);
+
+	/* It is submitted once the group quota is replenished */
+	spdk_delay_us(SPDK_BDEV_QOS_TIMESLICE_IN_USEC);
+	poll_threads();
+	CU_ASSERT(stub_complete_io(g_bdev.io_target, 0) == 1);
+	poll_threads();
+	CU_ASSERT(bdev_io_status == SPDK_BDEV_IO_STATUS_SUCCESS);
+
+	/* Update the group limits */
+	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+		limits[i] = UINT64_MAX;
+	}
+	limits[SPDK_BDEV_QOS_RW_BPS_RATE_LIMIT] = 100;
+	rc = spdk_bdev_qos_group_set_rate_limits("group0", limits);
+	CU_ASSERT(rc == 0);
+	rc = spdk_bdev_qos_group_get_rate_limits("group0", limits);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(limits[SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT] == 10000);
+	CU_ASSERT(limits[SPDK_BDEV_QOS_RW_BPS_RATE_LIMIT] == 100);
+	CU_ASSERT(limits[SPDK_BDEV_QOS_R_BPS_RATE_LIMIT] == 0);
+	rc = spdk_bdev_qos_group_set_rate_limits("group1", limits);
+	CU_ASSERT(rc == -ENOENT);
+
+	/* Removing the bdev keeps QoS enabled if the bdev has its own limits */
+	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+		limits[i] = UINT64_MAX;
+	}
+	limits[SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT] = 20000;
+	status = -1;
+	spdk_bdev_set_qos_rate_limits(bdev, limits, qos_dynamic_enable_done, &status);
+	poll_threads();
+	CU_ASSERT(status == 0);
+
+	status = -1;
+	spdk_bdev_set_qos_group(bdev, NULL, qos_dynamic_enable_done, &status);
+	poll_threads();
+	CU_ASSERT(status == 0);
+	CU_ASSERT(spdk_bdev_get_qos_group(bdev) == NULL);
+	CU_ASSERT((bdev_ch[0]->flags & BDEV_CH_QOS_ENABLED) != 0);
+	CU_ASSERT((bdev_ch[1]->flags & BDEV_CH_QOS_ENABLED) != 0);
+
+	/* Disabling the bdev limits while it is in a group leaves QoS enabled */
+	status = -1;
+	spdk_bdev_set_qos_group(bdev, "group0", qos_dynamic_enable_done, &status);
+	poll_threads();
+	CU_ASSERT(status == 0);
+
+	limits[SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT] = 0;
+	status = -1;
+	spdk_bdev_set_qos_rate_limits(bdev, limits, qos_dynamic_enable_done, &status);
+	poll_threads();
+	CU_ASSERT(status == 0);
+	CU_ASSERT((bdev_ch[0]->flags & BDEV_CH_QOS_ENABLED) != 0);
+	CU_ASSERT((bdev_ch[1]->flags & BDEV_CH_QOS_ENABLED) != 0);
+
+	/* Now removing the bdev from the group disables QoS */
+	status = -1;
+	spdk_bdev_set_qos_group(bdev, NULL, qos_dynamic_enable_done, &status);
+	poll_threads();
+	CU_ASSERT(status == 0);
+	CU_ASSERT(bdev->internal.qos == NULL);
+	CU_ASSERT((bdev_ch[0]->flags & BDEV_CH_QOS_ENABLED) == 0);
+	CU_ASSERT((bdev_ch[1]->flags & BDEV_CH_QOS_ENABLED) == 0);
+
+	rc = spdk_bdev_qos_group_delete("group0");
+	CU_ASSERT(rc == 0);
+	rc = spdk_bdev_qos_group_delete("group0");
+	CU_ASSERT(rc == -ENOENT);
+	poll_threads();
+
+	/* Tear down the channels */
+	set_thread(0);
+	spdk_put_io_channel(io_ch[0]);
+	set_thread(1);
+	spdk_put_io_channel(io_ch[1]);
+	poll_threads();
+
+	set_thread(0);
+	teardown_test();
+}
+
+static void
+qos_latency_be_io(struct spdk_bdev_desc *desc, struct spdk_io_channel *io_ch,
+		  void *io_target, int count)
+{
+	enum spdk_bdev_io_status bdev_io_status;
+	int i, rc;
+
+	for (i = 0; i < count; i++) {
+		bdev_io_status = SPDK_BDEV_IO_STATUS_PENDING;
+		rc = spdk_bdev_read_blocks(desc, io_ch, NULL, 0, 1, io_during_io_done, &bdev_io_status);
+		CU_ASSERT(rc == 0);
+		poll_thread(0);
+		CU_ASSERT(stub_complete_io(io_target, 0) == 1);
+		poll_thread(0);
+		CU_ASSERT(bdev_io_status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	}
+}
+
+static void
+qos_latency_target(void)
+{
+	struct spdk_io_channel *io_ch[2], *be_ch;
+	struct spdk_bdev_channel *bdev_ch[2];
+	struct spdk_bdev *bdev;
+	struct spdk_bdev_desc *be_desc = NULL;
+	struct spdk_bdev_qos_group *group;
+	struct ut_bdev *be_bdev;
+	enum spdk_bdev_io_status bdev_io_status;
+	uint64_t limits[SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES];
+	int be_io_device;
+	int status, rc, i;
+
+	setup_test();
+	MOCK_SET(spdk_get_ticks, 0);
+
+	bdev = &g_bdev.bdev;
+
+	/* Create a best-effort bdev with its own io_target */
+	spdk_io_device_register(&be_io_device, stub_create_ch, stub_destroy_ch,
+				sizeof(struct ut_bdev_channel), NULL);
+	be_bdev = calloc(1, sizeof(*be_bdev));
+	SPDK_CU_ASSERT_FATAL(be_bdev != NULL);
+	register_bdev(be_bdev, "ut_bdev2", &be_io_device);
+	spdk_bdev_open_ext("ut_bdev2", true, _bdev_event_cb, NULL, &be_desc);
+	SPDK_CU_ASSERT_FATAL(be_desc != NULL);
+
+	set_thread(0);
+	io_ch[0] = spdk_bdev_get_io_channel(g_desc);
+	bdev_ch[0] = spdk_io_channel_get_ctx(io_ch[0]);
+	be_ch = spdk_bdev_get_io_channel(be_desc);
+	set_thread(1);
+	io_ch[1] = spdk_bdev_get_io_channel(g_desc);
+	bdev_ch[1] = spdk_io_channel_get_ctx(io_ch[1]);
+	set_thread(0);
+
+	/* A group without limits of its own */
+	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+		limits[i] = UINT64_MAX;
+	}
+	rc = spdk_bdev_qos_group_create("group0", limits);
+	CU_ASSERT(rc == 0);
+
+	/* Setting a latency target enables QoS and latency tracking on all channels */
+	status = -1;
+	spdk_bdev_set_qos_latency_target(bdev, 100, qos_dynamic_enable_done, &status);
+	poll_threads();
+	CU_ASSERT(status == 0);
+	CU_ASSERT(spdk_bdev_get_qos_latency_target(bdev) == 100);
+	CU_ASSERT((bdev_ch[0]->flags & BDEV_CH_QOS_ENABLED) != 0);
+	CU_ASSERT((bdev_ch[1]->flags & BDEV_CH_QOS_ENABLED) != 0);
+	CU_ASSERT(bdev_ch[0]->latency_target_ticks == 100 * spdk_get_ticks_hz() / SPDK_SEC_TO_USEC);
+	CU_ASSERT(bdev_ch[1]->latency_target_ticks == bdev_ch[0]->latency_target_ticks);
+
+	status = -1;
+	spdk_bdev_set_qos_group(bdev, "group0", qos_dynamic_enable_done, &status);
+	poll_threads();
+	CU_ASSERT(status == 0);
+	status = -1;
+	spdk_bdev_set_qos_group(&be_bdev->bdev, "group0", qos_dynamic_enable_done, &status);
+	poll_threads();
+	CU_ASSERT(status == 0);
+	group = bdev->internal.qos->group;
+	SPDK_CU_ASSERT_FATAL(group != NULL);
+
+	/* An I/O that meets the target doesn't throttle anything */
+	bdev_io_status = SPDK_BDEV_IO_STATUS_PENDING;
+	rc = spdk_bdev_read_blocks(g_desc, io_ch[0], NULL, 0, 1, io_during_io_done, &bdev_io_status);
+	CU_ASSERT(rc == 0);
+	poll_threads();
+	spdk_delay_us(50);
+	CU_ASSERT(stub_complete_io(g_bdev.io_target, 0) == 1);
+	poll_threads();
+	CU_ASSERT(bdev_io_status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(bdev_ch[0]->latency_ios == 1);
+	CU_ASSERT(bdev_ch[0]->latency_misses == 0);
+
+	qos_latency_be_io(be_desc, be_ch, be_bdev->io_target, 1000);
+
+	spdk_delay_us(SPDK_BDEV_QOS_LATENCY_WINDOW_IN_USEC);
+	poll_threads();
+	CU_ASSERT(bdev_ch[0]->latency_ios == 0);
+	CU_ASSERT(group->be_limits[SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT].limit ==
+		  SPDK_BDEV_QOS_LIMIT_NOT_DEFINED);
+
+	/* Now miss the target. The miss is reported to the group when the samples are
+	 * collected at the end of the window and acted upon at the end of the next one. */
+	bdev_io_status = SPDK_BDEV_IO_STATUS_PENDING;
+	rc = spdk_bdev_read_blocks(g_desc, io_ch[0], NULL, 0, 1, io_during_io_done, &bdev_io_status);
+	CU_ASSERT(rc == 0);
+	poll_threads();
+	spdk_delay_us(200);
+	CU_ASSERT(stub_complete_io(g_bdev.io_target, 0) == 1);
+	poll_threads();
+	CU_ASSERT(bdev_io_status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(bdev_ch[0]->latency_misses == 1);
+
+	spdk_delay_us(SPDK_BDEV_QOS_LATENCY_WINDOW_IN_USEC - 200);
+	poll_threads();
+	CU_ASSERT(group->latency_missed == true);
+
+	/* 1000 I/O of 4KiB within a window is 10000 IOPS and 40960000 B/s */
+	qos_latency_be_io(be_desc, be_ch, be_bdev->io_target, 1000);
+
+	spdk_delay_us(SPDK_BDEV_QOS_LATENCY_WINDOW_IN_USEC);
+	poll_threads();
+	CU_ASSERT(group->latency_missed == false);
+	CU_ASSERT(group->be_limits[SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT].limit == 7500);
+	CU_ASSERT(group->be_limits[SPDK_BDEV_QOS_RW_BPS_RATE_LIMIT].limit == 30720000);
+
+	/* The best-effort bdev is throttled to 7 I/O per timeslice */
+	for (i = 0; i < 10; i++) {
+		rc = spdk_bdev_read_blocks(be_desc, be_ch, NULL, 0, 1, io_during_io_done, &bdev_io_status);
+		CU_ASSERT(rc == 0);
+	}
+	poll_threads();
+	CU_ASSERT(stub_complete_io(be_bdev->io_target, 0) == 7);
+
+	/* The bdev with the latency target is not */
+	for (i = 0; i < 10; i++) {
+		rc = spdk_bdev_read_blocks(g_desc, io_ch[0], NULL, 0, 1, io_during_io_done, &bdev_io_status);
+		CU_ASSERT(rc == 0);
+	}
+	poll_threads();
+	CU_ASSERT(stub_complete_io(g_bdev.io_target, 0) == 10);
+
+	spdk_delay_us(SPDK_BDEV_QOS_TIMESLICE_IN_USEC);
+	poll_threads();
+	CU_ASSERT(stub_complete_io(be_bdev->io_target, 0) == 3);
+	poll_threads();
+
+	/* Once the target is met again and the best-effort bdevs don't use the
+	 * throughput they are allowed, the limits are dropped */
+	spdk_delay_us(SPDK_BDEV_QOS_LATENCY_WINDOW_IN_USEC);
+	poll_threads();
+	spdk_delay_us(SPDK_BDEV_QOS_LATENCY_WINDOW_IN_USEC);
+	poll_threads();
+	CU_ASSERT(group->be_limits[SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT].limit ==
+		  SPDK_BDEV_QOS_LIMIT_NOT_DEFINED);
+	CU_ASSERT(group->be_limits[SPDK_BDEV_QOS_RW_BPS_RATE_LIMIT].limit ==
+		  SPDK_BDEV_QOS_LIMIT_NOT_DEFINED);
+
+	/* Removing the target keeps QoS enabled while the bdev is in a group */
+	status = -1;
+	spdk_bdev_set_qos_latency_target(bdev, 0, qos_dynamic_enable_done, &status);
+	poll_threads();
+	CU_ASSERT(status == 0);
+	CU_ASSERT(spdk_bdev_get_qos_latency_target(bdev) == 0);
+	CU_ASSERT((bdev_ch[0]->flags & BDEV_CH_QOS_ENABLED) != 0);
+	CU_ASSERT(bdev_ch[0]->latency_target_ticks == 0);
+	CU_ASSERT(bdev_ch[1]->latency_target_ticks == 0);
+
+	/* Setting the target again and removing the bdev from the group keeps QoS enabled */
+	status = -1;
+	spdk_bdev_set_qos_latency_target(bdev, 100, qos_dynamic_enable_done, &status);
+	poll_threads();
+	CU_ASSERT(status == 0);
+	status = -1;
+	spdk_bdev_set_qos_group(bdev, NULL, qos_dynamic_enable_done, &status);
+	poll_threads();
+	CU_ASSERT(status == 0);
+	CU_ASSERT((bdev_ch[0]->flags & BDEV_CH_QOS_ENABLED) != 0);
+
+	/* Removing the target now disables QoS */
+	status = -1;
+	spdk_bdev_set_qos_latency_target(bdev, 0, qos_dynamic_enable_done, &status);
+	poll_threads();
+	CU_ASSERT(status == 0);
+	CU_ASSERT(bdev->internal.qos == NULL);
+	CU_ASSERT((bdev_ch[0]->flags & BDEV_CH_QOS_ENABLED) == 0);
+	CU_ASSERT((bdev_ch[1]->flags & BDEV_CH_QOS_ENABLED) == 0);
+
+	status = -1;
+	spdk_bdev_set_qos_group(&be_bdev->bdev, NULL, qos_dynamic_enable_done, &status);
+	poll_threads();
+	CU_ASSERT(status == 0);
+	rc = spdk_bdev_qos_group_delete("group0");
+	CU_ASSERT(rc == 0);
+	poll_threads();
+
+	/* Tear down the channels */
+	set_thread(0);
+	spdk_put_io_channel(io_ch[0]);
+	spdk_put_io_channel(be_ch);
+	set_thread(1);
+	spdk_put_io_channel(io_ch[1]);
+	poll_threads();
+
+	set_thread(0);
+	spdk_bdev_close(be_desc);
+	unregister_bdev(be_bdev);
+	spdk_io_device_unregister(&be_io_device, NULL);
+	poll_threads();
+	free(be_bdev);
+	teardown_test();
+}
+
 static void
 histogram_status_cb(void *cb_arg, int status)
 {
@@ -2659,6 +3028,8 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, enomem_multi_bdev_unregister);
 	CU_ADD_TEST(suite, enomem_multi_io_target);
 	CU_ADD_TEST(suite, qos_dynamic_enable);
+	CU_ADD_TEST(suite, qos_group);
+	CU_ADD_TEST(suite, qos_latency_target);
 	CU_ADD_TEST(suite, bdev_histograms_mt);
 	CU_ADD_TEST(suite, bdev_set_io_timeout_mt);
 	CU_ADD_TEST(suite, lock_lba_range_then_submit_io);
@@ -108,6 +108,9 @@ DEFINE_STUB(spdk_nvme_ctrlr_get_opts, const struct spdk_nvme_ctrlr_opts *,
 DEFINE_STUB(spdk_nvme_ctrlr_get_max_xfer_size, uint32_t,
 	    (const struct spdk_nvme_ctrlr *ctrlr), 0);
 
+DEFINE_STUB(spdk_nvme_ctrlr_get_numa_id, int32_t, (const struct spdk_nvme_ctrlr *ctrlr),
+	    SPDK_ENV_SOCKET_ID_ANY);
+
 DEFINE_STUB(spdk_nvme_ctrlr_get_transport_id, const struct spdk_nvme_transport_id *,
 	    (struct spdk_nvme_ctrlr *ctrlr), NULL);
 
@@ -212,6 +215,8 @@ DEFINE_STUB(spdk_nvme_zns_reset_zone, int,
 
 DEFINE_STUB(spdk_nvme_ns_get_nguid, const uint8_t *, (const struct spdk_nvme_ns *ns), NULL);
 
+DEFINE_STUB(spdk_nvme_ns_get_num_placement_ids, uint16_t, (const struct spdk_nvme_ns *ns), 0);
+
 DEFINE_STUB(spdk_nvme_zns_offline_zone, int,
 	    (struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair, uint64_t slba,
 	     bool select_all, spdk_nvme_cmd_cb cb_fn, void *cb_arg), 0);
@@ -243,6 +248,13 @@ DEFINE_STUB_V(spdk_accel_sequence_finish,
 	      (struct spdk_accel_sequence *seq, spdk_accel_completion_cb cb_fn, void *cb_arg));
 DEFINE_STUB_V(spdk_accel_sequence_abort, (struct spdk_accel_sequence *seq));
 DEFINE_STUB_V(spdk_accel_sequence_reverse, (struct spdk_accel_sequence *seq));
+DEFINE_STUB(spdk_nvme_poll_group_get_fd, int, (struct spdk_nvme_poll_group *group), -ENOTSUP);
+DEFINE_STUB(spdk_nvme_poll_group_wait, int64_t, (struct spdk_nvme_poll_group *group,
+		spdk_nvme_disconnected_qpair_cb disconnected_qpair_cb), 0);
+DEFINE_STUB(spdk_nvme_poll_group_set_shared_requests, int,
+	    (struct spdk_nvme_poll_group *group, uint32_t num_requests), 0);
+DEFINE_STUB_V(spdk_nvme_poll_group_submit_batch_begin, (struct spdk_nvme_poll_group *group));
+DEFINE_STUB_V(spdk_nvme_poll_group_submit_batch_end, (struct spdk_nvme_poll_group *group));
 
 struct ut_nvme_req {
 	uint16_t			opc;
@@ -498,6 +510,10 @@ ut_submit_nvme_request(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
 {
 	struct ut_nvme_req *req;
 
+	if (!qpair->is_connected) {
+		return -ENXIO;
+	}
+
 	req = calloc(1, sizeof(*req));
 	if (req == NULL) {
 		return -ENOMEM;
@@ -1063,6 +1079,8 @@ spdk_nvme_ns_cmd_readv_ext(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpai
 }
 
 static bool g_ut_writev_ext_called;
+static uint32_t g_ut_writev_ext_io_flags;
+static uint32_t g_ut_writev_ext_cdw13;
 int
 spdk_nvme_ns_cmd_writev_ext(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
 			    uint64_t lba, uint32_t lba_count,
@@ -1072,9 +1090,34 @@ spdk_nvme_ns_cmd_writev_ext(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpa
 			    struct spdk_nvme_ns_cmd_ext_io_opts *opts)
 {
 	g_ut_writev_ext_called = true;
+	g_ut_writev_ext_io_flags = opts->io_flags;
+	g_ut_writev_ext_cdw13 = opts->cdw13;
 	return ut_submit_nvme_request(ns, qpair, SPDK_NVME_OPC_WRITE, cb_fn, cb_arg);
 }
 
+static int g_ut_placement_ids_rc = -ENOTSUP;
+static uint32_t g_ut_placement_ids_called;
+
+int
+spdk_nvme_ns_update_placement_ids(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
+				  spdk_nvme_ns_placement_ids_cb cb_fn, void *cb_arg)
+{
+	g_ut_placement_ids_called++;
+
+	if (g_ut_placement_ids_rc == -ENOTSUP) {
+		return -ENOTSUP;
+	}
+
+	cb_fn(cb_arg, g_ut_placement_ids_rc);
+	return 0;
+}
+
+uint16_t
+spdk_nvme_ns_get_placement_id(const struct spdk_nvme_ns *ns, uint16_t index)
+{
+	return 0x100 + index;
+}
+
 int
 spdk_nvme_ns_cmd_comparev_with_md(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
 				  uint64_t lba, uint32_t lba_count,
@@ -2402,6 +2445,36 @@ test_submit_nvme_cmd(void)
 	g_ut_readv_ext_called = false;
 	bdev_io->u.bdev.memory_domain = NULL;
 
+	/* Verify that a placement hint is ignored if the namespace has no placement ids */
+	bdev_io->u.bdev.placement_hint = 1;
+	g_ut_writev_ext_called = false;
+	ut_test_submit_nvme_cmd(ch, bdev_io, SPDK_BDEV_IO_TYPE_WRITE);
+	CU_ASSERT(g_ut_writev_ext_called == false);
+
+	/* Verify that hints are spread over the placement ids, and that the placement id
+	 * is sent with the data placement directive in the upper half of cdw13.
+	 */
+	MOCK_SET(spdk_nvme_ns_get_num_placement_ids, 3);
+	ut_test_submit_nvme_cmd(ch, bdev_io, SPDK_BDEV_IO_TYPE_WRITE);
+	CU_ASSERT(g_ut_writev_ext_called == true);
+	CU_ASSERT(g_ut_writev_ext_io_flags & SPDK_NVME_IO_FLAGS_DATA_PLACEMENT_DIRECTIVE);
+	CU_ASSERT(g_ut_writev_ext_cdw13 == 0x100u << 16);
+
+	bdev_io->u.bdev.placement_hint = 3;
+	ut_test_submit_nvme_cmd(ch, bdev_io, SPDK_BDEV_IO_TYPE_WRITE);
+	CU_ASSERT(g_ut_writev_ext_cdw13 == 0x102u << 16);
+
+	bdev_io->u.bdev.placement_hint = 5;
+	ut_test_submit_nvme_cmd(ch, bdev_io, SPDK_BDEV_IO_TYPE_WRITE);
+	CU_ASSERT(g_ut_writev_ext_cdw13 == 0x101u << 16);
+
+	/* Verify that writes without a hint are sent without a placement id */
+	bdev_io->u.bdev.placement_hint = 0;
+	g_ut_writev_ext_called = false;
+	ut_test_submit_nvme_cmd(ch, bdev_io, SPDK_BDEV_IO_TYPE_WRITE);
+	CU_ASSERT(g_ut_writev_ext_called == false);
+	MOCK_CLEAR(spdk_nvme_ns_get_num_placement_ids);
+
 	ut_test_submit_admin_cmd(ch, bdev_io, ctrlr);
 
 	free(bdev_io);
@@ -6067,6 +6140,167 @@ test_find_io_path_min_qd(void)
 	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path1);
 }
 
+static void
+test_find_io_path_min_latency(void)
+{
+	struct nvme_bdev_channel nbdev_ch = {
+		.io_path_list = STAILQ_HEAD_INITIALIZER(nbdev_ch.io_path_list),
+		.mp_policy = BDEV_NVME_MP_POLICY_ACTIVE_ACTIVE,
+		.mp_selector = BDEV_NVME_MP_SELECTOR_LATENCY,
+	};
+	struct spdk_nvme_qpair qpair1 = {}, qpair2 = {}, qpair3 = {};
+	struct spdk_nvme_ctrlr ctrlr1 = {}, ctrlr2 = {}, ctrlr3 = {};
+	struct nvme_ctrlr nvme_ctrlr1 = { .ctrlr = &ctrlr1, };
+	struct nvme_ctrlr nvme_ctrlr2 = { .ctrlr = &ctrlr2, };
+	struct nvme_ctrlr nvme_ctrlr3 = { .ctrlr = &ctrlr3, };
+	struct nvme_ctrlr_channel ctrlr_ch1 = {};
+	struct nvme_ctrlr_channel ctrlr_ch2 = {};
+	struct nvme_ctrlr_channel ctrlr_ch3 = {};
+	struct nvme_qpair nvme_qpair1 = { .ctrlr_ch = &ctrlr_ch1, .ctrlr = &nvme_ctrlr1, .qpair = &qpair1, };
+	struct nvme_qpair nvme_qpair2 = { .ctrlr_ch = &ctrlr_ch2, .ctrlr = &nvme_ctrlr2, .qpair = &qpair2, };
+	struct nvme_qpair nvme_qpair3 = { .ctrlr_ch = &ctrlr_ch3, .ctrlr = &nvme_ctrlr3, .qpair = &qpair3, };
+	struct nvme_ns nvme_ns1 = {}, nvme_ns2 = {}, nvme_ns3 = {};
+	struct nvme_io_path io_path1 = { .qpair = &nvme_qpair1, .nvme_ns = &nvme_ns1, .nbdev_ch = &nbdev_ch, };
+	struct nvme_io_path io_path2 = { .qpair = &nvme_qpair2, .nvme_ns = &nvme_ns2, .nbdev_ch = &nbdev_ch, };
+	struct nvme_io_path io_path3 = { .qpair = &nvme_qpair3, .nvme_ns = &nvme_ns3, .nbdev_ch = &nbdev_ch, };
+	struct nvme_bdev nbdev = {};
+	struct spdk_bdev_io *bdev_io;
+	struct nvme_bdev_io *bio;
+	int i;
+
+	STAILQ_INSERT_TAIL(&nbdev_ch.io_path_list, &io_path1, stailq);
+	STAILQ_INSERT_TAIL(&nbdev_ch.io_path_list, &io_path2, stailq);
+	STAILQ_INSERT_TAIL(&nbdev_ch.io_path_list, &io_path3, stailq);
+
+	nvme_ns1.ana_state = SPDK_NVME_ANA_OPTIMIZED_STATE;
+	nvme_ns2.ana_state = SPDK_NVME_ANA_OPTIMIZED_STATE;
+	nvme_ns3.ana_state = SPDK_NVME_ANA_NON_OPTIMIZED_STATE;
+
+	/* A path without any latency sample is tried first */
+	io_path1.latency_ewma_ticks = 100;
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path2);
+
+	/* but only with a single I/O at a time */
+	qpair2.num_outstanding_reqs = 1;
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path1);
+
+	/* If no path can take more I/O, one is still selected */
+	qpair1.num_outstanding_reqs = 1;
+	io_path1.latency_ewma_ticks = 0;
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path1);
+	qpair1.num_outstanding_reqs = 0;
+	qpair2.num_outstanding_reqs = 0;
+	io_path1.latency_ewma_ticks = 100;
+
+	/* Then the optimized path with the lowest latency is used, even if a non-optimized
+	 * path is faster
+	 */
+	io_path2.latency_ewma_ticks = 200;
+	io_path3.latency_ewma_ticks = 10;
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path1);
+
+	/* The optimized path with the oldest sample gets probed periodically */
+	io_path1.last_completion_tsc = 50;
+	io_path2.last_completion_tsc = 20;
+	nbdev_ch.latency_probe_counter = 0;
+	for (i = 0; i < BDEV_NVME_LATENCY_PROBE_INTERVAL - 1; i++) {
+		CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path1);
+	}
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path2);
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path1);
+
+	/* Only local paths are probed if there is any, as remote ones wouldn't be used */
+	io_path1.numa_local = true;
+	io_path3.numa_local = true;
+	nbdev_ch.latency_probe_counter = BDEV_NVME_LATENCY_PROBE_INTERVAL - 1;
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path1);
+	io_path1.numa_local = false;
+	io_path3.numa_local = false;
+
+	/* Completions update the moving average of the path, measured from the submission to
+	 * the qpair rather than to the bdev layer
+	 */
+	bdev_io = ut_alloc_bdev_io(SPDK_BDEV_IO_TYPE_READ, &nbdev, NULL);
+	bio = (struct nvme_bdev_io *)bdev_io->driver_ctx;
+	bio->io_path = &io_path2;
+	bio->submit_tsc = spdk_get_ticks();
+	spdk_delay_us(100);
+	bdev_nvme_set_qpair_submit_tsc(bio);
+	CU_ASSERT(bio->qpair_submit_tsc == spdk_get_ticks());
+	spdk_delay_us(8);
+
+	bdev_nvme_update_io_path_latency(bio);
+	CU_ASSERT(io_path2.latency_ewma_ticks == 200 - 200 / 8 + 8 / 8);
+	CU_ASSERT(io_path2.last_completion_tsc == spdk_get_ticks());
+
+	/* but not with other selectors */
+	nbdev_ch.mp_selector = BDEV_NVME_MP_SELECTOR_QUEUE_DEPTH;
+	io_path2.latency_ewma_ticks = 200;
+	bdev_nvme_update_io_path_latency(bio);
+	CU_ASSERT(io_path2.latency_ewma_ticks == 200);
+
+	free(bdev_io);
+}
+
+static void
+test_find_io_path_numa_local(void)
+{
+	struct nvme_bdev_channel nbdev_ch = {
+		.io_path_list = STAILQ_HEAD_INITIALIZER(nbdev_ch.io_path_list),
+		.mp_policy = BDEV_NVME_MP_POLICY_ACTIVE_ACTIVE,
+		.mp_selector = BDEV_NVME_MP_SELECTOR_QUEUE_DEPTH,
+	};
+	struct spdk_nvme_qpair qpair1 = {}, qpair2 = {}, qpair3 = {};
+	struct spdk_nvme_ctrlr ctrlr1 = {}, ctrlr2 = {}, ctrlr3 = {};
+	struct nvme_ctrlr nvme_ctrlr1 = { .ctrlr = &ctrlr1, };
+	struct nvme_ctrlr nvme_ctrlr2 = { .ctrlr = &ctrlr2, };
+	struct nvme_ctrlr nvme_ctrlr3 = { .ctrlr = &ctrlr3, };
+	struct nvme_ctrlr_channel ctrlr_ch1 = {};
+	struct nvme_ctrlr_channel ctrlr_ch2 = {};
+	struct nvme_ctrlr_channel ctrlr_ch3 = {};
+	struct nvme_qpair nvme_qpair1 = { .ctrlr_ch = &ctrlr_ch1, .ctrlr = &nvme_ctrlr1, .qpair = &qpair1, };
+	struct nvme_qpair nvme_qpair2 = { .ctrlr_ch = &ctrlr_ch2, .ctrlr = &nvme_ctrlr2, .qpair = &qpair2, };
+	struct nvme_qpair nvme_qpair3 = { .ctrlr_ch = &ctrlr_ch3, .ctrlr = &nvme_ctrlr3, .qpair = &qpair3, };
+	struct nvme_ns nvme_ns1 = {}, nvme_ns2 = {}, nvme_ns3 = {};
+	struct nvme_io_path io_path1 = { .qpair = &nvme_qpair1, .nvme_ns = &nvme_ns1, };
+	struct nvme_io_path io_path2 = { .qpair = &nvme_qpair2, .nvme_ns = &nvme_ns2, .numa_local = true, };
+	struct nvme_io_path io_path3 = { .qpair = &nvme_qpair3, .nvme_ns = &nvme_ns3, .numa_local = true, };
+
+	STAILQ_INSERT_TAIL(&nbdev_ch.io_path_list, &io_path1, stailq);
+	STAILQ_INSERT_TAIL(&nbdev_ch.io_path_list, &io_path2, stailq);
+	STAILQ_INSERT_TAIL(&nbdev_ch.io_path_list, &io_path3, stailq);
+
+	/* The local optimized path wins over a remote one with a lower queue depth */
+	qpair1.num_outstanding_reqs = 0;
+	qpair2.num_outstanding_reqs = 4;
+	qpair3.num_outstanding_reqs = 0;
+	nvme_ns1.ana_state = SPDK_NVME_ANA_OPTIMIZED_STATE;
+	nvme_ns2.ana_state = SPDK_NVME_ANA_OPTIMIZED_STATE;
+	nvme_ns3.ana_state = SPDK_NVME_ANA_NON_OPTIMIZED_STATE;
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path2);
+
+	/* But a remote optimized path still wins over a local non-optimized one */
+	nvme_ns2.ana_state = SPDK_NVME_ANA_INACCESSIBLE_STATE;
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path1);
+
+	/* Same with the round-robin selector */
+	nbdev_ch.mp_selector = BDEV_NVME_MP_SELECTOR_ROUND_ROBIN;
+	nbdev_ch.rr_min_io = 1;
+	nvme_ns2.ana_state = SPDK_NVME_ANA_OPTIMIZED_STATE;
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path2);
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path2);
+
+	nvme_ns2.ana_state = SPDK_NVME_ANA_INACCESSIBLE_STATE;
+	nbdev_ch.current_io_path = NULL;
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path1);
+
+	/* The active-passive policy ignores locality */
+	nbdev_ch.mp_policy = BDEV_NVME_MP_POLICY_ACTIVE_PASSIVE;
+	nbdev_ch.current_io_path = NULL;
+	nvme_ns2.ana_state = SPDK_NVME_ANA_OPTIMIZED_STATE;
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path1);
+}
+
 static void
 test_disable_auto_failback(void)
 {
@@ -6594,6 +6828,166 @@ test_retry_io_to_same_path(void)
  * failover is lost if fabric connect command gets timeout while
  * controller is being reset.
  */
+static void
+test_fast_failover(void)
+{
+	struct nvme_path_id path1 = {}, path2 = {};
+	struct spdk_nvme_ctrlr *ctrlr1, *ctrlr2;
+	struct nvme_bdev_ctrlr *nbdev_ctrlr;
+	struct nvme_ctrlr *nvme_ctrlr1, *nvme_ctrlr2;
+	const int STRING_SIZE = 32;
+	const char *attached_names[STRING_SIZE];
+	struct nvme_bdev *bdev;
+	struct spdk_bdev_io *bdev_io;
+	struct nvme_bdev_io *bio;
+	struct spdk_io_channel *ch;
+	struct nvme_bdev_channel *nbdev_ch;
+	struct nvme_io_path *io_path1, *io_path2;
+	struct spdk_nvme_ctrlr_opts opts = {};
+	struct spdk_uuid uuid1 = { .u.raw = { 0x1 } };
+	int rc;
+
+	memset(attached_names, 0, sizeof(char *) * STRING_SIZE);
+	ut_init_trid(&path1.trid);
+	ut_init_trid2(&path2.trid);
+	g_ut_attach_ctrlr_status = 0;
+	g_ut_attach_bdev_count = 1;
+
+	g_opts.bdev_retry_count = 1;
+	g_opts.fast_failover = true;
+	MOCK_SET(spdk_nvme_ctrlr_get_opts, &opts);
+
+	set_thread(0);
+
+	ctrlr1 = ut_attach_ctrlr(&path1.trid, 1, true, true);
+	SPDK_CU_ASSERT_FATAL(ctrlr1 != NULL);
+
+	ctrlr1->ns[0].uuid = &uuid1;
+
+	rc = bdev_nvme_create(&path1.trid, "nvme0", attached_names, STRING_SIZE,
+			      attach_ctrlr_done, NULL, NULL, NULL, true);
+	CU_ASSERT(rc == 0);
+
+	spdk_delay_us(1000);
+	poll_threads();
+	spdk_delay_us(g_opts.nvme_adminq_poll_period_us);
+	poll_threads();
+
+	ctrlr2 = ut_attach_ctrlr(&path2.trid, 1, true, true);
+	SPDK_CU_ASSERT_FATAL(ctrlr2 != NULL);
+
+	ctrlr2->ns[0].uuid = &uuid1;
+
+	rc = bdev_nvme_create(&path2.trid, "nvme0", attached_names, STRING_SIZE,
+			      attach_ctrlr_done, NULL, NULL, NULL, true);
+	CU_ASSERT(rc == 0);
+
+	spdk_delay_us(1000);
+	poll_threads();
+	spdk_delay_us(g_opts.nvme_adminq_poll_period_us);
+	poll_threads();
+
+	nbdev_ctrlr = nvme_bdev_ctrlr_get_by_name("nvme0");
+	SPDK_CU_ASSERT_FATAL(nbdev_ctrlr != NULL);
+
+	nvme_ctrlr1 = nvme_bdev_ctrlr_get_ctrlr(nbdev_ctrlr, &path1.trid);
+	SPDK_CU_ASSERT_FATAL(nvme_ctrlr1 != NULL);
+
+	nvme_ctrlr2 = nvme_bdev_ctrlr_get_ctrlr(nbdev_ctrlr, &path2.trid);
+	SPDK_CU_ASSERT_FATAL(nvme_ctrlr2 != NULL);
+
+	bdev = nvme_bdev_ctrlr_get_bdev(nbdev_ctrlr, 1);
+	SPDK_CU_ASSERT_FATAL(bdev != NULL);
+
+	ch = spdk_get_io_channel(bdev);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+	nbdev_ch = spdk_io_channel_get_ctx(ch);
+
+	bdev_io = ut_alloc_bdev_io(SPDK_BDEV_IO_TYPE_WRITE, bdev, ch);
+	ut_bdev_io_set_buf(bdev_io);
+
+	bio = (struct nvme_bdev_io *)bdev_io->driver_ctx;
+
+	io_path1 = ut_get_io_path_by_ctrlr(nbdev_ch, nvme_ctrlr1);
+	SPDK_CU_ASSERT_FATAL(io_path1 != NULL);
+
+	io_path2 = ut_get_io_path_by_ctrlr(nbdev_ch, nvme_ctrlr2);
+	SPDK_CU_ASSERT_FATAL(io_path2 != NULL);
+
+	/* The qpair of io_path1 failed but bdev_nvme has not noticed it yet.
+	 * The I/O fails to be submitted to io_path1, and should be retried on
+	 * io_path2 without any delay.
+	 */
+	io_path1->qpair->qpair->is_connected = false;
+
+	bdev_io->internal.in_submit_request = true;
+
+	bdev_nvme_submit_request(ch, bdev_io);
+
+	io_path1->qpair->qpair->is_connected = true;
+
+	CU_ASSERT(bdev_io->internal.in_submit_request == true);
+	CU_ASSERT(bdev_io == TAILQ_FIRST(&nbdev_ch->retry_io_list));
+	CU_ASSERT(bio->io_path == io_path2);
+	CU_ASSERT(nbdev_ch->current_io_path == io_path2);
+
+	poll_threads();
+
+	CU_ASSERT(bdev_io->internal.in_submit_request == false);
+	CU_ASSERT(bdev_io->internal.status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(bio->io_path == io_path2);
+	CU_ASSERT(TAILQ_EMPTY(&nbdev_ch->retry_io_list));
+
+	/* If fast failover is disabled, the I/O waits for one second before
+	 * it is retried.
+	 */
+	g_opts.fast_failover = false;
+
+	io_path2->qpair->qpair->is_connected = false;
+
+	bdev_io->internal.in_submit_request = true;
+
+	bdev_nvme_submit_request(ch, bdev_io);
+
+	io_path2->qpair->qpair->is_connected = true;
+
+	CU_ASSERT(bdev_io->internal.in_submit_request == true);
+	CU_ASSERT(bdev_io == TAILQ_FIRST(&nbdev_ch->retry_io_list));
+	CU_ASSERT(bio->io_path == NULL);
+	CU_ASSERT(nbdev_ch->current_io_path == NULL);
+
+	poll_threads();
+
+	CU_ASSERT(io_path1->qpair->qpair->num_outstanding_reqs == 0);
+	CU_ASSERT(io_path2->qpair->qpair->num_outstanding_reqs == 0);
+	CU_ASSERT(bdev_io == TAILQ_FIRST(&nbdev_ch->retry_io_list));
+
+	spdk_delay_us(1000000);
+	poll_threads();
+
+	CU_ASSERT(bdev_io->internal.in_submit_request == false);
+	CU_ASSERT(bdev_io->internal.status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(bio->io_path == io_path1);
+
+	free(bdev_io);
+
+	spdk_put_io_channel(ch);
+
+	poll_threads();
+
+	rc = bdev_nvme_delete("nvme0", &g_any_path, NULL, NULL);
+	CU_ASSERT(rc == 0);
+
+	poll_threads();
+	spdk_delay_us(1000);
+	poll_threads();
+
+	CU_ASSERT(nvme_bdev_ctrlr_get_by_name("nvme0") == NULL);
+
+	MOCK_CLEAR(spdk_nvme_ctrlr_get_opts);
+	g_opts.bdev_retry_count = 0;
+}
+
 static void
 test_race_between_reset_and_disconnected(void)
 {
@@ -7232,6 +7626,97 @@ test_delete_ctrlr_done(void)
 	CU_ASSERT(nvme_ctrlr_get_by_name("nvme0") == NULL);
 }
 
+static void
+test_populate_fdp_namespace(void)
+{
+	struct spdk_nvme_transport_id trid = {};
+	struct spdk_nvme_ctrlr_opts opts = {};
+	struct spdk_nvme_ctrlr *ctrlr;
+	struct nvme_ctrlr *nvme_ctrlr;
+	const int STRING_SIZE = 32;
+	const char *attached_names[STRING_SIZE];
+	int rc;
+
+	memset(attached_names, 0, sizeof(char *) * STRING_SIZE);
+	ut_init_trid(&trid);
+
+	opts.admin_timeout_ms = 1000;
+	MOCK_SET(spdk_nvme_ctrlr_get_opts, &opts);
+
+	set_thread(0);
+
+	/* Case 1: the placement ids are retrieved before the bdev is created. The temporary
+	 * qpair is freed afterwards.
+	 */
+	ctrlr = ut_attach_ctrlr(&trid, 1, false, false);
+	SPDK_CU_ASSERT_FATAL(ctrlr != NULL);
+	ctrlr->cdata.ctratt.fdps = 1;
+
+	g_ut_attach_ctrlr_status = 0;
+	g_ut_attach_bdev_count = 1;
+	g_ut_placement_ids_rc = 0;
+	g_ut_placement_ids_called = 0;
+
+	rc = bdev_nvme_create(&trid, "nvme0", attached_names, STRING_SIZE,
+			      attach_ctrlr_done, NULL, NULL, NULL, false);
+	CU_ASSERT(rc == 0);
+
+	spdk_delay_us(1000);
+	poll_threads();
+
+	CU_ASSERT(g_ut_placement_ids_called == 1);
+	CU_ASSERT(TAILQ_EMPTY(&ctrlr->active_io_qpairs));
+
+	nvme_ctrlr = nvme_ctrlr_get_by_name("nvme0");
+	SPDK_CU_ASSERT_FATAL(nvme_ctrlr != NULL);
+	CU_ASSERT(nvme_ctrlr_get_ns(nvme_ctrlr, 1)->bdev != NULL);
+
+	rc = bdev_nvme_delete("nvme0", &g_any_path, NULL, NULL);
+	CU_ASSERT(rc == 0);
+
+	poll_threads();
+	spdk_delay_us(1000);
+	poll_threads();
+
+	CU_ASSERT(nvme_ctrlr_get_by_name("nvme0") == NULL);
+
+	/* Case 2: failing to get the placement ids doesn't fail the bdev creation. */
+	ctrlr = ut_attach_ctrlr(&trid, 1, false, false);
+	SPDK_CU_ASSERT_FATAL(ctrlr != NULL);
+	ctrlr->cdata.ctratt.fdps = 1;
+
+	g_ut_attach_ctrlr_status = 0;
+	g_ut_attach_bdev_count = 1;
+	g_ut_placement_ids_rc = -EIO;
+	g_ut_placement_ids_called = 0;
+
+	rc = bdev_nvme_create(&trid, "nvme0", attached_names, STRING_SIZE,
+			      attach_ctrlr_done, NULL, NULL, NULL, false);
+	CU_ASSERT(rc == 0);
+
+	spdk_delay_us(1000);
+	poll_threads();
+
+	CU_ASSERT(g_ut_placement_ids_called == 1);
+	CU_ASSERT(TAILQ_EMPTY(&ctrlr->active_io_qpairs));
+
+	nvme_ctrlr = nvme_ctrlr_get_by_name("nvme0");
+	SPDK_CU_ASSERT_FATAL(nvme_ctrlr != NULL);
+	CU_ASSERT(nvme_ctrlr_get_ns(nvme_ctrlr, 1)->bdev != NULL);
+
+	rc = bdev_nvme_delete("nvme0", &g_any_path, NULL, NULL);
+	CU_ASSERT(rc == 0);
+
+	poll_threads();
+	spdk_delay_us(1000);
+	poll_threads();
+
+	CU_ASSERT(nvme_ctrlr_get_by_name("nvme0") == NULL);
+
+	g_ut_placement_ids_rc = -ENOTSUP;
+	MOCK_CLEAR(spdk_nvme_ctrlr_get_opts);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -7280,15 +7765,19 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_set_preferred_path);
 	CU_ADD_TEST(suite, test_find_next_io_path);
 	CU_ADD_TEST(suite, test_find_io_path_min_qd);
+	CU_ADD_TEST(suite, test_find_io_path_min_latency);
+	CU_ADD_TEST(suite, test_find_io_path_numa_local);
 	CU_ADD_TEST(suite, test_disable_auto_failback);
 	CU_ADD_TEST(suite, test_set_multipath_policy);
 	CU_ADD_TEST(suite, test_uuid_generation);
 	CU_ADD_TEST(suite, test_retry_io_to_same_path);
+	CU_ADD_TEST(suite, test_fast_failover);
 	CU_ADD_TEST(suite, test_race_between_reset_and_disconnected);
 	CU_ADD_TEST(suite, test_ctrlr_op_rpc);
 	CU_ADD_TEST(suite, test_bdev_ctrlr_op_rpc);
 	CU_ADD_TEST(suite, test_disable_enable_ctrlr);
 	CU_ADD_TEST(suite, test_delete_ctrlr_done);
+	CU_ADD_TEST(suite, test_populate_fdp_namespace);
 
 	allocate_threads(3);
 	set_thread(0);
@@ -444,6 +444,170 @@ part_construct_ext(void)
 	poll_threads();
 }
 
+/* Blocks [g_seek_data_start, g_seek_data_end) of the base bdev hold data, the rest is a hole */
+static uint64_t g_seek_data_start;
+static uint64_t g_seek_data_end;
+
+static void
+seek_base_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io)
+{
+	uint64_t offset = bdev_io->u.bdev.offset_blocks;
+	bool in_data = offset >= g_seek_data_start && offset < g_seek_data_end;
+
+	switch (bdev_io->type) {
+	case SPDK_BDEV_IO_TYPE_SEEK_DATA:
+		if (in_data) {
+			bdev_io->u.bdev.seek.offset = offset;
+		} else if (offset < g_seek_data_start) {
+			bdev_io->u.bdev.seek.offset = g_seek_data_start;
+		} else {
+			bdev_io->u.bdev.seek.offset = UINT64_MAX;
+		}
+		break;
+	case SPDK_BDEV_IO_TYPE_SEEK_HOLE:
+		bdev_io->u.bdev.seek.offset = in_data ? g_seek_data_end : offset;
+		break;
+	default:
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		return;
+	}
+
+	spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_SUCCESS);
+}
+
+static void
+seek_part_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io)
+{
+	int rc;
+
+	rc = spdk_bdev_part_submit_request(spdk_io_channel_get_ctx(ch), bdev_io);
+	if (rc != 0) {
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+	}
+}
+
+static struct spdk_bdev_fn_table seek_base_fn_table = {
+	.destruct		= __destruct,
+	.get_io_channel		= part_ut_get_io_channel,
+	.io_type_supported	= __io_type_supported,
+	.submit_request		= seek_base_submit_request,
+};
+static struct spdk_bdev_fn_table seek_part_fn_table = {
+	.destruct		= __destruct,
+	.io_type_supported	= __io_type_supported,
+	.submit_request		= seek_part_submit_request,
+};
+
+static void
+seek_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	uint64_t *seek_offset = cb_arg;
+
+	CU_ASSERT(success);
+	*seek_offset = spdk_bdev_io_get_seek_offset(bdev_io);
+	spdk_bdev_free_io(bdev_io);
+}
+
+static uint64_t
+part_seek(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch, uint64_t offset, bool data)
+{
+	uint64_t seek_offset = 0;
+	int rc;
+
+	if (data) {
+		rc = spdk_bdev_seek_data(desc, ch, offset, seek_done, &seek_offset);
+	} else {
+		rc = spdk_bdev_seek_hole(desc, ch, offset, seek_done, &seek_offset);
+	}
+	CU_ASSERT(rc == 0);
+	poll_threads();
+
+	return seek_offset;
+}
+
+static void
+part_seek_test(void)
+{
+	struct spdk_bdev_part_base	*base = NULL;
+	struct spdk_bdev_part		*part1, *part2;
+	struct spdk_bdev_desc		*desc1 = NULL, *desc2 = NULL;
+	struct spdk_io_channel		*ch1, *ch2;
+	struct spdk_bdev		bdev_base = {};
+	SPDK_BDEV_PART_TAILQ		tailq = TAILQ_HEAD_INITIALIZER(tailq);
+	int rc;
+
+	ut_init_bdev();
+	bdev_base.name = "base";
+	bdev_base.blocklen = 512;
+	bdev_base.blockcnt = 1024;
+	bdev_base.fn_table = &seek_base_fn_table;
+	bdev_base.module = &bdev_ut_if;
+	rc = spdk_bdev_register(&bdev_base);
+	CU_ASSERT(rc == 0);
+
+	rc = spdk_bdev_part_base_construct_ext("base", NULL, &vbdev_ut_if,
+					       &seek_part_fn_table, &tailq, NULL,
+					       NULL, sizeof(struct spdk_bdev_part_channel), NULL, NULL,
+					       &base);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(base != NULL);
+
+	part1 = calloc(1, sizeof(*part1));
+	SPDK_CU_ASSERT_FATAL(part1 != NULL);
+	rc = spdk_bdev_part_construct(part1, base, "test1", 100, 100, "test");
+	SPDK_CU_ASSERT_FATAL(rc == 0);
+	part2 = calloc(1, sizeof(*part2));
+	SPDK_CU_ASSERT_FATAL(part2 != NULL);
+	rc = spdk_bdev_part_construct(part2, base, "test2", 300, 100, "test");
+	SPDK_CU_ASSERT_FATAL(rc == 0);
+
+	rc = spdk_bdev_open_ext("test1", false, bdev_ut_event_cb, NULL, &desc1);
+	CU_ASSERT(rc == 0);
+	rc = spdk_bdev_open_ext("test2", false, bdev_ut_event_cb, NULL, &desc2);
+	CU_ASSERT(rc == 0);
+	ch1 = spdk_bdev_get_io_channel(desc1);
+	SPDK_CU_ASSERT_FATAL(ch1 != NULL);
+	ch2 = spdk_bdev_get_io_channel(desc2);
+	SPDK_CU_ASSERT_FATAL(ch2 != NULL);
+
+	/* Data starting within the first part and ending beyond it */
+	g_seek_data_start = 150;
+	g_seek_data_end = 250;
+	CU_ASSERT(part_seek(desc1, ch1, 0, true) == 50);
+	CU_ASSERT(part_seek(desc1, ch1, 60, true) == 60);
+	CU_ASSERT(part_seek(desc1, ch1, 0, false) == 0);
+	CU_ASSERT(part_seek(desc1, ch1, 50, false) == UINT64_MAX);
+
+	/* The data of the base bdev is outside of the second part */
+	CU_ASSERT(part_seek(desc2, ch2, 0, true) == UINT64_MAX);
+	CU_ASSERT(part_seek(desc2, ch2, 10, false) == 10);
+
+	/* Data beyond the end of the first part */
+	g_seek_data_start = 250;
+	g_seek_data_end = 350;
+	CU_ASSERT(part_seek(desc1, ch1, 0, true) == UINT64_MAX);
+	CU_ASSERT(part_seek(desc2, ch2, 0, true) == 0);
+	CU_ASSERT(part_seek(desc2, ch2, 0, false) == 50);
+
+	spdk_put_io_channel(ch1);
+	spdk_put_io_channel(ch2);
+	spdk_bdev_close(desc1);
+	spdk_bdev_close(desc2);
+	spdk_bdev_unregister(&part1->internal.bdev, NULL, NULL);
+	spdk_bdev_unregister(&part2->internal.bdev, NULL, NULL);
+	poll_threads();
+
+	rc = spdk_bdev_part_free(part1);
+	CU_ASSERT(rc == 1);
+	rc = spdk_bdev_part_free(part2);
+	CU_ASSERT(rc == 1);
+	poll_threads();
+	CU_ASSERT(TAILQ_EMPTY(&tailq));
+
+	spdk_bdev_unregister(&bdev_base, NULL, NULL);
+	ut_fini_bdev();
+}
+
 int
 main(int argc, char **argv)
 {
@@ -458,6 +622,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, part_free_test);
 	CU_ADD_TEST(suite, part_get_io_channel_test);
 	CU_ADD_TEST(suite, part_construct_ext);
+	CU_ADD_TEST(suite, part_seek_test);
 
 	allocate_cores(1);
 	allocate_threads(1);
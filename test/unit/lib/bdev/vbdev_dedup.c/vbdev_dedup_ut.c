@@ -0,0 +1,676 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 the SPDK authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+#include "spdk_internal/cunit.h"
+#include "spdk/env.h"
+#include "spdk_internal/mock.h"
+#include "thread/thread_internal.h"
+#include "common/lib/test_env.c"
+#include "bdev/dedup/vbdev_dedup.c"
+#include "unit/lib/json_mock.c"
+
+#define BLOCK_SIZE	512
+#define CHUNK_SIZE	4096
+#define BLOCKS_PER_CHUNK	(CHUNK_SIZE / BLOCK_SIZE)
+/* Superblock, map, fingerprints and 61 physical chunks */
+#define BASE_CHUNKS	64
+#define NUM_PHYSICAL	61
+
+struct ut_disk {
+	struct spdk_bdev	bdev;
+	uint8_t			*data;
+	uint32_t		num_writes;
+	bool			fail_writes;
+};
+
+struct ut_io {
+	spdk_bdev_io_completion_cb	cb;
+	spdk_accel_completion_cb	accel_cb;
+	void				*cb_arg;
+	bool				success;
+	int				status;
+	TAILQ_ENTRY(ut_io)		link;
+};
+
+static TAILQ_HEAD(, ut_io) g_ios = TAILQ_HEAD_INITIALIZER(g_ios);
+static struct ut_disk g_base = {
+	.bdev = { .name = "base", .blocklen = BLOCK_SIZE, .blockcnt = BASE_CHUNKS * BLOCKS_PER_CHUNK },
+};
+static struct spdk_thread *g_thread;
+static int g_accel_io_device;
+static int g_create_rc;
+static uint32_t g_num_completed;
+static enum spdk_bdev_io_status g_io_status;
+/* Fingerprint of all of the writes if set, to make them collide */
+static bool g_crc_collide;
+static uint32_t g_num_compares;
+
+DEFINE_STUB_V(spdk_bdev_module_list_add, (struct spdk_bdev_module *bdev_module));
+DEFINE_STUB_V(spdk_bdev_close, (struct spdk_bdev_desc *desc));
+DEFINE_STUB_V(spdk_bdev_module_examine_done, (struct spdk_bdev_module *module));
+DEFINE_STUB_V(spdk_bdev_module_release_bdev, (struct spdk_bdev *bdev));
+DEFINE_STUB_V(spdk_bdev_destruct_done, (struct spdk_bdev *bdev, int bdeverrno));
+DEFINE_STUB(spdk_bdev_module_claim_bdev, int, (struct spdk_bdev *bdev,
+		struct spdk_bdev_desc *desc, struct spdk_bdev_module *module), 0);
+DEFINE_STUB(spdk_bdev_register, int, (struct spdk_bdev *bdev), 0);
+DEFINE_STUB_V(spdk_bdev_unregister, (struct spdk_bdev *bdev, spdk_bdev_unregister_cb cb_fn,
+				     void *cb_arg));
+DEFINE_STUB(spdk_bdev_unregister_by_name, int, (const char *bdev_name,
+		struct spdk_bdev_module *module, spdk_bdev_unregister_cb cb_fn, void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_get_name, const char *, (const struct spdk_bdev *bdev), "ut");
+DEFINE_STUB(spdk_bdev_queue_io_wait, int, (struct spdk_bdev *bdev, struct spdk_io_channel *ch,
+		struct spdk_bdev_io_wait_entry *entry), 0);
+DEFINE_STUB(spdk_bdev_reset, int, (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+				   spdk_bdev_io_completion_cb cb, void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_flush_blocks, int, (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		uint64_t offset_blocks, uint64_t num_blocks, spdk_bdev_io_completion_cb cb,
+		void *cb_arg), 0);
+
+struct spdk_bdev *
+spdk_bdev_get_by_name(const char *bdev_name)
+{
+	return strcmp(bdev_name, g_base.bdev.name) == 0 ? &g_base.bdev : NULL;
+}
+
+int
+spdk_bdev_open_ext(const char *bdev_name, bool write, spdk_bdev_event_cb_t event_cb,
+		   void *event_ctx, struct spdk_bdev_desc **desc)
+{
+	*desc = (struct spdk_bdev_desc *)&g_base;
+
+	return strcmp(bdev_name, g_base.bdev.name) == 0 ? 0 : -ENODEV;
+}
+
+struct spdk_bdev *
+spdk_bdev_desc_get_bdev(struct spdk_bdev_desc *desc)
+{
+	return &((struct ut_disk *)desc)->bdev;
+}
+
+struct spdk_io_channel *
+spdk_bdev_get_io_channel(struct spdk_bdev_desc *desc)
+{
+	return spdk_get_io_channel(desc);
+}
+
+struct spdk_thread *
+spdk_bdev_io_get_thread(struct spdk_bdev_io *bdev_io)
+{
+	return g_thread;
+}
+
+void
+spdk_bdev_io_get_buf(struct spdk_bdev_io *bdev_io, spdk_bdev_io_get_buf_cb cb, uint64_t len)
+{
+	cb(NULL, bdev_io, true);
+}
+
+void
+spdk_bdev_io_complete(struct spdk_bdev_io *bdev_io, enum spdk_bdev_io_status status)
+{
+	g_io_status = status;
+	g_num_completed++;
+}
+
+void
+spdk_bdev_free_io(struct spdk_bdev_io *bdev_io)
+{
+	free(bdev_io);
+}
+
+static int
+ut_ch_create_cb(void *io_device, void *ctx_buf)
+{
+	return 0;
+}
+
+static void
+ut_ch_destroy_cb(void *io_device, void *ctx_buf)
+{
+}
+
+/* I/O and accel operations are done on submission, their completion is deferred until
+ * ut_complete_ios().
+ */
+static struct ut_io *
+ut_queue_io(spdk_bdev_io_completion_cb cb, void *cb_arg, bool success)
+{
+	struct ut_io *io;
+
+	io = calloc(1, sizeof(*io));
+	SPDK_CU_ASSERT_FATAL(io != NULL);
+	io->cb = cb;
+	io->cb_arg = cb_arg;
+	io->success = success;
+	TAILQ_INSERT_TAIL(&g_ios, io, link);
+
+	return io;
+}
+
+static void
+ut_queue_accel(spdk_accel_completion_cb cb, void *cb_arg, int status)
+{
+	struct ut_io *io = ut_queue_io(NULL, cb_arg, true);
+
+	io->accel_cb = cb;
+	io->status = status;
+}
+
+static void
+ut_complete_ios(void)
+{
+	struct spdk_bdev_io *bdev_io;
+	struct ut_io *io;
+
+	while ((io = TAILQ_FIRST(&g_ios))) {
+		TAILQ_REMOVE(&g_ios, io, link);
+		if (io->accel_cb != NULL) {
+			io->accel_cb(io->cb_arg, io->status);
+		} else {
+			bdev_io = calloc(1, sizeof(*bdev_io));
+			SPDK_CU_ASSERT_FATAL(bdev_io != NULL);
+			io->cb(bdev_io, io->success, io->cb_arg);
+		}
+		free(io);
+	}
+}
+
+static void
+ut_disk_io(struct spdk_io_channel *ch, struct iovec *iovs, int iovcnt, uint64_t offset_blocks,
+	   uint64_t num_blocks, bool write, spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	struct ut_disk *disk = spdk_io_channel_get_io_device(ch);
+	uint8_t *data = disk->data + offset_blocks * BLOCK_SIZE;
+	uint64_t len = 0;
+	int i;
+
+	SPDK_CU_ASSERT_FATAL(offset_blocks + num_blocks <= disk->bdev.blockcnt);
+	if (write && disk->fail_writes) {
+		ut_queue_io(cb, cb_arg, false);
+		return;
+	}
+
+	for (i = 0; i < iovcnt; i++) {
+		if (write) {
+			memcpy(data + len, iovs[i].iov_base, iovs[i].iov_len);
+		} else {
+			memcpy(iovs[i].iov_base, data + len, iovs[i].iov_len);
+		}
+		len += iovs[i].iov_len;
+	}
+	CU_ASSERT(len == num_blocks * BLOCK_SIZE);
+
+	disk->num_writes += write;
+	ut_queue_io(cb, cb_arg, true);
+}
+
+int
+spdk_bdev_readv_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		       struct iovec *iov, int iovcnt, uint64_t offset_blocks, uint64_t num_blocks,
+		       spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	ut_disk_io(ch, iov, iovcnt, offset_blocks, num_blocks, false, cb, cb_arg);
+
+	return 0;
+}
+
+int
+spdk_bdev_writev_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+			struct iovec *iov, int iovcnt, uint64_t offset_blocks, uint64_t num_blocks,
+			spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	ut_disk_io(ch, iov, iovcnt, offset_blocks, num_blocks, true, cb, cb_arg);
+
+	return 0;
+}
+
+struct spdk_io_channel *
+spdk_accel_get_io_channel(void)
+{
+	return spdk_get_io_channel(&g_accel_io_device);
+}
+
+int
+spdk_accel_submit_crc32cv(struct spdk_io_channel *ch, uint32_t *crc_dst, struct iovec *iovs,
+			  uint32_t iovcnt, uint32_t seed, spdk_accel_completion_cb cb_fn, void *cb_arg)
+{
+	*crc_dst = spdk_crc32c_iov_update(iovs, iovcnt, ~seed);
+	if (g_crc_collide && !dedup_iovs_all_zero(iovs, iovcnt)) {
+		*crc_dst = 0x12345678;
+	}
+	ut_queue_accel(cb_fn, cb_arg, 0);
+
+	return 0;
+}
+
+int
+spdk_accel_submit_compare(struct spdk_io_channel *ch, void *src1, void *src2, uint64_t nbytes,
+			  spdk_accel_completion_cb cb_fn, void *cb_arg)
+{
+	g_num_compares++;
+	ut_queue_accel(cb_fn, cb_arg, memcmp(src1, src2, nbytes) ? -EILSEQ : 0);
+
+	return 0;
+}
+
+static void
+ut_create_cb(void *cb_arg, int bdeverrno)
+{
+	g_create_rc = bdeverrno;
+}
+
+static struct vbdev_dedup *
+ut_node_create(uint32_t chunk_size, uint64_t size_mb, int expected_rc)
+{
+	struct vbdev_dedup_opts opts = {
+		.name = "dedup",
+		.base_bdev_name = "base",
+		.chunk_size = chunk_size,
+		.size_mb = size_mb,
+	};
+
+	g_create_rc = 1;
+	CU_ASSERT(bdev_dedup_create_disk(&opts, ut_create_cb, NULL) == 0);
+	ut_complete_ios();
+	CU_ASSERT(g_create_rc == expected_rc);
+	if (expected_rc != 0) {
+		return NULL;
+	}
+
+	SPDK_CU_ASSERT_FATAL(!TAILQ_EMPTY(&g_dedup_nodes));
+	return TAILQ_FIRST(&g_dedup_nodes);
+}
+
+static void
+ut_node_destroy(struct vbdev_dedup *node)
+{
+	struct bdev_association *assoc = node->assoc;
+
+	CU_ASSERT(vbdev_dedup_destruct(node) == 1);
+	while (spdk_thread_poll(g_thread, 0, 0) > 0) {
+	}
+	vbdev_dedup_free_association(assoc);
+	while (spdk_thread_poll(g_thread, 0, 0) > 0) {
+	}
+}
+
+static enum spdk_bdev_io_status
+ut_submit(struct vbdev_dedup *node, enum spdk_bdev_io_type type, void *buf, int iovcnt,
+	  uint64_t offset_blocks, uint64_t num_blocks)
+{
+	struct spdk_bdev_io *bdev_io;
+	size_t len = num_blocks * CHUNK_SIZE;
+	int i;
+
+	bdev_io = calloc(1, sizeof(*bdev_io) + sizeof(struct dedup_bdev_io) +
+			 iovcnt * sizeof(struct iovec));
+	SPDK_CU_ASSERT_FATAL(bdev_io != NULL);
+	bdev_io->bdev = &node->dedup_bdev;
+	bdev_io->type = type;
+	bdev_io->u.bdev.iovs = (struct iovec *)(bdev_io->driver_ctx + sizeof(struct dedup_bdev_io));
+	for (i = 0; i < iovcnt; i++) {
+		bdev_io->u.bdev.iovs[i].iov_base = (uint8_t *)buf + i * len / iovcnt;
+		bdev_io->u.bdev.iovs[i].iov_len = len / iovcnt;
+	}
+	bdev_io->u.bdev.iovcnt = iovcnt;
+	bdev_io->u.bdev.offset_blocks = offset_blocks;
+	bdev_io->u.bdev.num_blocks = num_blocks;
+
+	g_num_completed = 0;
+	g_io_status = SPDK_BDEV_IO_STATUS_PENDING;
+	vbdev_dedup_submit_request(NULL, bdev_io);
+	ut_complete_ios();
+	CU_ASSERT(g_num_completed == 1);
+	free(bdev_io);
+
+	return g_io_status;
+}
+
+static enum spdk_bdev_io_status
+ut_write(struct vbdev_dedup *node, uint64_t lchunk, uint8_t val, int iovcnt)
+{
+	uint8_t buf[CHUNK_SIZE];
+
+	memset(buf, val, sizeof(buf));
+	/* Tell the chunks apart when their fingerprints collide */
+	buf[CHUNK_SIZE - 1] = val == 0 ? 0 : 1;
+	return ut_submit(node, SPDK_BDEV_IO_TYPE_WRITE, buf, iovcnt, lchunk, 1);
+}
+
+static bool
+ut_read_check(struct vbdev_dedup *node, uint64_t lchunk, uint8_t val)
+{
+	uint8_t buf[CHUNK_SIZE], expected[CHUNK_SIZE];
+
+	memset(buf, 0xff, sizeof(buf));
+	memset(expected, val, sizeof(expected));
+	expected[CHUNK_SIZE - 1] = val == 0 ? 0 : 1;
+	if (ut_submit(node, SPDK_BDEV_IO_TYPE_READ, buf, 1, lchunk, 1) !=
+	    SPDK_BDEV_IO_STATUS_SUCCESS) {
+		return false;
+	}
+
+	return memcmp(buf, expected, sizeof(buf)) == 0;
+}
+
+static uint64_t
+ut_used(struct vbdev_dedup *node)
+{
+	return node->num_physical - node->num_free;
+}
+
+static void
+ut_disk_reset(void)
+{
+	memset(g_base.data, 0xee, BASE_CHUNKS * CHUNK_SIZE);
+	g_base.num_writes = 0;
+}
+
+static void
+test_geometry(void)
+{
+	struct vbdev_dedup_opts opts = { .name = "dedup", .base_bdev_name = "base" };
+	struct vbdev_dedup *node;
+
+	ut_disk_reset();
+	node = ut_node_create(0, 0, 0);
+	SPDK_CU_ASSERT_FATAL(node != NULL);
+	CU_ASSERT(node->chunk_size == CHUNK_SIZE);
+	CU_ASSERT(node->blocks_per_chunk == BLOCKS_PER_CHUNK);
+	CU_ASSERT(node->num_physical == NUM_PHYSICAL);
+	CU_ASSERT(node->num_logical == NUM_PHYSICAL);
+	CU_ASSERT(node->map_offset == 1 && node->fp_offset == 2 && node->data_offset == 3);
+	CU_ASSERT(node->dedup_bdev.blocklen == CHUNK_SIZE);
+	CU_ASSERT(node->dedup_bdev.blockcnt == NUM_PHYSICAL);
+	CU_ASSERT(node->num_free == NUM_PHYSICAL);
+	CU_ASSERT(node->free_head == 0);
+	ut_node_destroy(node);
+
+	/* Metadata of a different geometry is refused */
+	ut_node_create(2 * CHUNK_SIZE, 0, -EINVAL);
+	CU_ASSERT(TAILQ_EMPTY(&g_bdev_associations));
+
+	/* Overprovisioned, the map takes more space */
+	ut_disk_reset();
+	node = ut_node_create(0, 8, 0);
+	SPDK_CU_ASSERT_FATAL(node != NULL);
+	CU_ASSERT(node->num_logical == 2048);
+	CU_ASSERT(node->fp_offset == 3 && node->data_offset == 4);
+	CU_ASSERT(node->num_physical == BASE_CHUNKS - 4);
+	ut_node_destroy(node);
+
+	/* Chunks must be made of whole blocks */
+	opts.chunk_size = 256;
+	CU_ASSERT(bdev_dedup_create_disk(&opts, ut_create_cb, NULL) == -EINVAL);
+	CU_ASSERT(TAILQ_EMPTY(&g_bdev_associations));
+}
+
+static void
+test_write_read(void)
+{
+	struct vbdev_dedup *node;
+	uint32_t writes;
+
+	ut_disk_reset();
+	node = ut_node_create(0, 0, 0);
+	SPDK_CU_ASSERT_FATAL(node != NULL);
+
+	/* Duplicates share a physical chunk */
+	CU_ASSERT(ut_write(node, 0, 0xa0, 1) == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(ut_write(node, 1, 0xa0, 1) == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(ut_write(node, 2, 0xa1, 4) == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(ut_used(node) == 2);
+	CU_ASSERT(node->num_mapped == 3);
+	CU_ASSERT(node->map[0] == node->map[1]);
+	CU_ASSERT(node->refcnt[node->map[0] - 1] == 2);
+	CU_ASSERT(ut_read_check(node, 0, 0xa0));
+	CU_ASSERT(ut_read_check(node, 1, 0xa0));
+	CU_ASSERT(ut_read_check(node, 2, 0xa1));
+
+	/* Unmapped chunks and chunks of zeroes read as zeroes and take no space */
+	CU_ASSERT(ut_read_check(node, 10, 0));
+	CU_ASSERT(ut_write(node, 3, 0, 1) == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(node->map[3] == 0);
+	CU_ASSERT(ut_read_check(node, 3, 0));
+
+	/* Rewriting a chunk with the data it holds doesn't write anything */
+	writes = g_base.num_writes;
+	CU_ASSERT(ut_write(node, 2, 0xa1, 2) == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(g_base.num_writes == writes);
+
+	/* Overwritten chunks are released once no longer referenced */
+	CU_ASSERT(ut_write(node, 0, 0xa1, 1) == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(ut_used(node) == 2);
+	CU_ASSERT(ut_write(node, 1, 0xa2, 1) == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(ut_used(node) == 2);
+	CU_ASSERT(node->refcnt[node->map[0] - 1] == 2);
+	CU_ASSERT(ut_read_check(node, 0, 0xa1));
+	CU_ASSERT(ut_read_check(node, 1, 0xa2));
+
+	/* Writing the data of a released chunk finds nothing */
+	CU_ASSERT(ut_write(node, 4, 0xa0, 1) == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(ut_used(node) == 3);
+
+	/* Unmapping and writing zeroes release the chunks */
+	CU_ASSERT(ut_submit(node, SPDK_BDEV_IO_TYPE_UNMAP, NULL, 0, 0, 3) ==
+		  SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(ut_used(node) == 1);
+	CU_ASSERT(ut_submit(node, SPDK_BDEV_IO_TYPE_WRITE_ZEROES, NULL, 0, 4, 1) ==
+		  SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(ut_used(node) == 0);
+	CU_ASSERT(node->num_mapped == 0);
+	CU_ASSERT(ut_read_check(node, 0, 0));
+	CU_ASSERT(ut_read_check(node, 4, 0));
+
+	/* A failed write leaves the chunk as it was */
+	CU_ASSERT(ut_write(node, 5, 0xa3, 1) == SPDK_BDEV_IO_STATUS_SUCCESS);
+	g_base.fail_writes = true;
+	CU_ASSERT(ut_write(node, 5, 0xa4, 1) == SPDK_BDEV_IO_STATUS_FAILED);
+	g_base.fail_writes = false;
+	CU_ASSERT(ut_used(node) == 1);
+	CU_ASSERT(ut_read_check(node, 5, 0xa3));
+
+	ut_node_destroy(node);
+}
+
+static void
+test_collision(void)
+{
+	struct vbdev_dedup *node;
+	uint32_t i;
+
+	ut_disk_reset();
+	node = ut_node_create(0, 0, 0);
+	SPDK_CU_ASSERT_FATAL(node != NULL);
+
+	/* Chunks with the same fingerprint but different data are kept apart */
+	g_crc_collide = true;
+	g_num_compares = 0;
+	for (i = 0; i < 4; i++) {
+		CU_ASSERT(ut_write(node, i, 0xb0 + i, 1) == SPDK_BDEV_IO_STATUS_SUCCESS);
+	}
+	CU_ASSERT(ut_used(node) == 4);
+	CU_ASSERT(g_num_compares == 0 + 1 + 2 + 3);
+
+	/* The whole bucket is searched, through memcmp() for vectored writes */
+	CU_ASSERT(ut_write(node, 10, 0xb0, 2) == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(ut_write(node, 11, 0xb3, 1) == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(ut_used(node) == 4);
+	CU_ASSERT(node->map[10] == node->map[0]);
+	CU_ASSERT(node->map[11] == node->map[3]);
+	for (i = 0; i < 4; i++) {
+		CU_ASSERT(ut_read_check(node, i, 0xb0 + i));
+	}
+
+	/* Released chunks leave the bucket */
+	CU_ASSERT(ut_submit(node, SPDK_BDEV_IO_TYPE_UNMAP, NULL, 0, 1, 2) ==
+		  SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(ut_used(node) == 2);
+	g_num_compares = 0;
+	CU_ASSERT(ut_write(node, 12, 0xb1, 1) == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(g_num_compares == 2);
+	CU_ASSERT(ut_used(node) == 3);
+	g_crc_collide = false;
+
+	ut_node_destroy(node);
+}
+
+static void
+test_recovery(void)
+{
+	struct vbdev_dedup *node;
+	struct dedup_sb *sb;
+	uint32_t i;
+
+	ut_disk_reset();
+	node = ut_node_create(0, 8, 0);
+	SPDK_CU_ASSERT_FATAL(node != NULL);
+
+	/* Chunks mapped by different chunks of the map */
+	CU_ASSERT(ut_write(node, 0, 0xc0, 1) == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(ut_write(node, 1500, 0xc0, 1) == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(ut_write(node, 2047, 0xc1, 1) == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(ut_write(node, 5, 0xc2, 1) == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(ut_submit(node, SPDK_BDEV_IO_TYPE_UNMAP, NULL, 0, 5, 1) ==
+		  SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(ut_used(node) == 2);
+	ut_node_destroy(node);
+
+	/* The map and the index are loaded when the bdev is created again */
+	node = ut_node_create(0, 8, 0);
+	SPDK_CU_ASSERT_FATAL(node != NULL);
+	CU_ASSERT(ut_used(node) == 2);
+	CU_ASSERT(node->num_mapped == 3);
+	CU_ASSERT(node->refcnt[node->map[0] - 1] == 2);
+	CU_ASSERT(ut_read_check(node, 0, 0xc0));
+	CU_ASSERT(ut_read_check(node, 1500, 0xc0));
+	CU_ASSERT(ut_read_check(node, 2047, 0xc1));
+	CU_ASSERT(ut_read_check(node, 5, 0));
+
+	/* The fingerprints are loaded too */
+	CU_ASSERT(ut_write(node, 7, 0xc1, 1) == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(node->map[7] == node->map[2047]);
+	CU_ASSERT(ut_used(node) == 2);
+
+	/* The bdev runs out of space once all physical chunks are taken */
+	for (i = 0; ut_used(node) < node->num_physical; i++) {
+		CU_ASSERT(ut_write(node, 100 + i, (uint8_t)(0x10 + i), 1) ==
+			  SPDK_BDEV_IO_STATUS_SUCCESS);
+	}
+	CU_ASSERT(ut_write(node, 100 + i, 0xff, 1) == SPDK_BDEV_IO_STATUS_FAILED);
+	CU_ASSERT(ut_write(node, 100 + i, 0xc0, 1) == SPDK_BDEV_IO_STATUS_SUCCESS);
+	ut_node_destroy(node);
+
+	/* A corrupted superblock formats the bdev again */
+	sb = (struct dedup_sb *)g_base.data;
+	sb->crc++;
+	node = ut_node_create(0, 8, 0);
+	SPDK_CU_ASSERT_FATAL(node != NULL);
+	CU_ASSERT(ut_used(node) == 0);
+	CU_ASSERT(ut_read_check(node, 0, 0));
+	ut_node_destroy(node);
+}
+
+static uint64_t
+ut_seek(struct vbdev_dedup *node, uint64_t offset_blocks, bool data)
+{
+	struct spdk_bdev_io *bdev_io;
+	uint64_t seek_offset;
+
+	bdev_io = calloc(1, sizeof(*bdev_io) + sizeof(struct dedup_bdev_io));
+	SPDK_CU_ASSERT_FATAL(bdev_io != NULL);
+	bdev_io->bdev = &node->dedup_bdev;
+	bdev_io->type = data ? SPDK_BDEV_IO_TYPE_SEEK_DATA : SPDK_BDEV_IO_TYPE_SEEK_HOLE;
+	bdev_io->u.bdev.offset_blocks = offset_blocks;
+
+	g_num_completed = 0;
+	vbdev_dedup_submit_request(NULL, bdev_io);
+	ut_complete_ios();
+	CU_ASSERT(g_num_completed == 1);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	seek_offset = bdev_io->u.bdev.seek.offset;
+	free(bdev_io);
+
+	return seek_offset;
+}
+
+static void
+test_seek(void)
+{
+	struct vbdev_dedup *node;
+
+	ut_disk_reset();
+	node = ut_node_create(0, 0, 0);
+	SPDK_CU_ASSERT_FATAL(node != NULL);
+	CU_ASSERT(vbdev_dedup_io_type_supported(node, SPDK_BDEV_IO_TYPE_SEEK_DATA));
+	CU_ASSERT(vbdev_dedup_io_type_supported(node, SPDK_BDEV_IO_TYPE_SEEK_HOLE));
+
+	/* Nothing is mapped yet */
+	CU_ASSERT(ut_seek(node, 0, true) == UINT64_MAX);
+	CU_ASSERT(ut_seek(node, 0, false) == 0);
+
+	/* Mapped chunks are data, chunks of zeroes are holes */
+	CU_ASSERT(ut_write(node, 4, 0xd0, 1) == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(ut_write(node, 5, 0xd0, 1) == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(ut_write(node, 6, 0, 1) == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(ut_write(node, 9, 0xd1, 1) == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(ut_seek(node, 0, true) == 4);
+	CU_ASSERT(ut_seek(node, 4, false) == 6);
+	CU_ASSERT(ut_seek(node, 6, true) == 9);
+	CU_ASSERT(ut_seek(node, 9, false) == 10);
+	CU_ASSERT(ut_seek(node, 10, true) == UINT64_MAX);
+
+	/* The last chunk has no hole after it */
+	CU_ASSERT(ut_write(node, node->num_logical - 1, 0xd2, 1) == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(ut_seek(node, node->num_logical - 1, false) == UINT64_MAX);
+
+	/* Unmapped chunks become holes */
+	CU_ASSERT(ut_submit(node, SPDK_BDEV_IO_TYPE_UNMAP, NULL, 0, 4, 1) ==
+		  SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(ut_seek(node, 0, true) == 5);
+
+	ut_node_destroy(node);
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("dedup", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_geometry);
+	CU_ADD_TEST(suite, test_write_read);
+	CU_ADD_TEST(suite, test_collision);
+	CU_ADD_TEST(suite, test_recovery);
+	CU_ADD_TEST(suite, test_seek);
+
+	allocate_cores(1);
+	g_thread = spdk_thread_create("test", NULL);
+	spdk_set_thread(g_thread);
+	g_base.data = calloc(BASE_CHUNKS, CHUNK_SIZE);
+	spdk_io_device_register(&g_base, ut_ch_create_cb, ut_ch_destroy_cb, 0, "base");
+	spdk_io_device_register(&g_accel_io_device, ut_ch_create_cb, ut_ch_destroy_cb, 0, "accel");
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+
+	spdk_io_device_unregister(&g_base, NULL);
+	spdk_io_device_unregister(&g_accel_io_device, NULL);
+	free(g_base.data);
+	spdk_thread_exit(g_thread);
+	while (!spdk_thread_is_exited(g_thread)) {
+		spdk_thread_poll(g_thread, 0, 0);
+	}
+	spdk_thread_destroy(g_thread);
+	free_cores();
+
+	CU_cleanup_registry();
+
+	return num_failures;
+}
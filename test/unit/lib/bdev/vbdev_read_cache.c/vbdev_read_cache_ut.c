@@ -0,0 +1,460 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 the SPDK authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+#include "spdk_internal/cunit.h"
+#include "spdk/env.h"
+#include "spdk_internal/mock.h"
+#include "thread/thread_internal.h"
+#include "common/lib/test_env.c"
+#include "bdev/read_cache/vbdev_read_cache.c"
+#include "unit/lib/json_mock.c"
+
+#define BLOCK_SIZE	512
+#define BLOCK_CNT	1024
+#define LINE_SIZE_KB	4
+#define LINE_BLOCKS	(LINE_SIZE_KB * 1024 / BLOCK_SIZE)
+#define SHARD_LINES	4
+
+struct ut_base_io {
+	spdk_bdev_io_completion_cb	cb;
+	void				*cb_arg;
+	enum spdk_bdev_io_type		type;
+	uint64_t			offset_blocks;
+	uint64_t			num_blocks;
+	TAILQ_ENTRY(ut_base_io)		link;
+};
+
+static TAILQ_HEAD(ut_base_io_head, ut_base_io) g_base_ios = TAILQ_HEAD_INITIALIZER(g_base_ios);
+static uint32_t g_num_base_ios;
+static struct spdk_io_channel *g_ch;
+static int g_io_status;
+static struct spdk_thread *g_thread;
+
+DEFINE_STUB_V(spdk_bdev_module_list_add, (struct spdk_bdev_module *bdev_module));
+DEFINE_STUB_V(spdk_bdev_close, (struct spdk_bdev_desc *desc));
+DEFINE_STUB_V(spdk_bdev_module_examine_done, (struct spdk_bdev_module *module));
+DEFINE_STUB_V(spdk_bdev_module_release_bdev, (struct spdk_bdev *bdev));
+DEFINE_STUB(spdk_bdev_open_ext, int, (const char *bdev_name, bool write,
+				      spdk_bdev_event_cb_t event_cb, void *event_ctx,
+				      struct spdk_bdev_desc **_desc), -ENODEV);
+DEFINE_STUB(spdk_bdev_desc_get_bdev, struct spdk_bdev *, (struct spdk_bdev_desc *desc), NULL);
+DEFINE_STUB(spdk_bdev_is_md_separate, bool, (const struct spdk_bdev *bdev), false);
+DEFINE_STUB(spdk_bdev_module_claim_bdev, int, (struct spdk_bdev *bdev,
+		struct spdk_bdev_desc *desc, struct spdk_bdev_module *module), 0);
+DEFINE_STUB(spdk_bdev_register, int, (struct spdk_bdev *bdev), 0);
+DEFINE_STUB_V(spdk_bdev_unregister, (struct spdk_bdev *bdev, spdk_bdev_unregister_cb cb_fn,
+				     void *cb_arg));
+DEFINE_STUB(spdk_bdev_unregister_by_name, int, (const char *bdev_name,
+		struct spdk_bdev_module *module, spdk_bdev_unregister_cb cb_fn, void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_get_name, const char *, (const struct spdk_bdev *bdev), "ut");
+DEFINE_STUB(spdk_bdev_get_uuid, const struct spdk_uuid *, (const struct spdk_bdev *bdev), NULL);
+DEFINE_STUB(spdk_bdev_io_type_supported, bool, (struct spdk_bdev *bdev,
+		enum spdk_bdev_io_type io_type), true);
+DEFINE_STUB(spdk_bdev_get_io_channel, struct spdk_io_channel *, (struct spdk_bdev_desc *desc),
+	    (void *)1);
+DEFINE_STUB(spdk_bdev_queue_io_wait, int, (struct spdk_bdev *bdev, struct spdk_io_channel *ch,
+		struct spdk_bdev_io_wait_entry *entry), 0);
+DEFINE_STUB(spdk_bdev_write_zeroes_blocks, int, (struct spdk_bdev_desc *desc,
+		struct spdk_io_channel *ch, uint64_t offset_blocks, uint64_t num_blocks,
+		spdk_bdev_io_completion_cb cb, void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_unmap_blocks, int, (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		uint64_t offset_blocks, uint64_t num_blocks, spdk_bdev_io_completion_cb cb,
+		void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_copy_blocks, int, (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		uint64_t dst_offset_blocks, uint64_t src_offset_blocks, uint64_t num_blocks,
+		spdk_bdev_io_completion_cb cb, void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_flush_blocks, int, (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		uint64_t offset_blocks, uint64_t num_blocks, spdk_bdev_io_completion_cb cb,
+		void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_reset, int, (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+				   spdk_bdev_io_completion_cb cb, void *cb_arg), 0);
+
+/* The contents of the base bdev: every byte holds the number of its block. */
+static void
+ut_fill_pattern(void *buf, uint64_t offset_blocks, uint64_t num_blocks)
+{
+	uint64_t i;
+
+	for (i = 0; i < num_blocks; i++) {
+		memset((uint8_t *)buf + i * BLOCK_SIZE, (uint8_t)(offset_blocks + i), BLOCK_SIZE);
+	}
+}
+
+static bool
+ut_check_pattern(const void *buf, uint64_t offset_blocks, uint64_t num_blocks)
+{
+	uint8_t *expected;
+	bool rc;
+
+	expected = calloc(num_blocks, BLOCK_SIZE);
+	SPDK_CU_ASSERT_FATAL(expected != NULL);
+	ut_fill_pattern(expected, offset_blocks, num_blocks);
+	rc = memcmp(buf, expected, num_blocks * BLOCK_SIZE) == 0;
+	free(expected);
+
+	return rc;
+}
+
+static void
+ut_queue_base_io(enum spdk_bdev_io_type type, uint64_t offset_blocks, uint64_t num_blocks,
+		 spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	struct ut_base_io *io;
+
+	io = calloc(1, sizeof(*io));
+	SPDK_CU_ASSERT_FATAL(io != NULL);
+	io->type = type;
+	io->offset_blocks = offset_blocks;
+	io->num_blocks = num_blocks;
+	io->cb = cb;
+	io->cb_arg = cb_arg;
+	TAILQ_INSERT_TAIL(&g_base_ios, io, link);
+	g_num_base_ios++;
+}
+
+static void
+ut_complete_base_io(struct ut_base_io *io)
+{
+	struct spdk_bdev_io *bdev_io;
+
+	TAILQ_REMOVE(&g_base_ios, io, link);
+	bdev_io = calloc(1, sizeof(*bdev_io));
+	SPDK_CU_ASSERT_FATAL(bdev_io != NULL);
+	io->cb(bdev_io, true, io->cb_arg);
+	free(io);
+}
+
+static void
+ut_complete_base_ios(void)
+{
+	struct ut_base_io *io;
+
+	while ((io = TAILQ_FIRST(&g_base_ios))) {
+		ut_complete_base_io(io);
+	}
+}
+
+int
+spdk_bdev_read_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch, void *buf,
+		      uint64_t offset_blocks, uint64_t num_blocks,
+		      spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	ut_fill_pattern(buf, offset_blocks, num_blocks);
+	ut_queue_base_io(SPDK_BDEV_IO_TYPE_READ, offset_blocks, num_blocks, cb, cb_arg);
+
+	return 0;
+}
+
+int
+spdk_bdev_readv_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		       struct iovec *iov, int iovcnt, uint64_t offset_blocks, uint64_t num_blocks,
+		       spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	CU_ASSERT(iovcnt == 1);
+	ut_fill_pattern(iov[0].iov_base, offset_blocks, num_blocks);
+	ut_queue_base_io(SPDK_BDEV_IO_TYPE_READ, offset_blocks, num_blocks, cb, cb_arg);
+
+	return 0;
+}
+
+int
+spdk_bdev_writev_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+			struct iovec *iov, int iovcnt, uint64_t offset_blocks, uint64_t num_blocks,
+			spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	ut_queue_base_io(SPDK_BDEV_IO_TYPE_WRITE, offset_blocks, num_blocks, cb, cb_arg);
+
+	return 0;
+}
+
+void
+spdk_bdev_io_get_buf(struct spdk_bdev_io *bdev_io, spdk_bdev_io_get_buf_cb cb, uint64_t len)
+{
+	cb(g_ch, bdev_io, true);
+}
+
+void
+spdk_bdev_io_complete(struct spdk_bdev_io *bdev_io, enum spdk_bdev_io_status status)
+{
+	g_io_status = status;
+}
+
+void
+spdk_bdev_free_io(struct spdk_bdev_io *bdev_io)
+{
+	free(bdev_io);
+}
+
+static struct vbdev_read_cache *
+ut_node_create(void)
+{
+	struct bdev_association assoc = {
+		.cache_size_mb = 1,
+		.line_size_kb = LINE_SIZE_KB,
+	};
+	struct vbdev_read_cache *node;
+	struct spdk_bdev *base_bdev;
+
+	node = calloc(1, sizeof(*node));
+	base_bdev = calloc(1, sizeof(*base_bdev));
+	SPDK_CU_ASSERT_FATAL(node != NULL && base_bdev != NULL);
+
+	base_bdev->blocklen = BLOCK_SIZE;
+	base_bdev->blockcnt = BLOCK_CNT;
+	node->base_bdev = base_bdev;
+	node->cache_bdev.blocklen = BLOCK_SIZE;
+	node->cache_bdev.blockcnt = BLOCK_CNT;
+	node->cache_bdev.name = "ut_cache";
+
+	SPDK_CU_ASSERT_FATAL(vbdev_read_cache_init_geometry(node, &assoc) == 0);
+	CU_ASSERT(node->line_blocks == LINE_BLOCKS);
+	CU_ASSERT(node->line_stride == 0x1000);
+	CU_ASSERT(node->generation_mask == READ_CACHE_MIN_GENERATIONS - 1);
+
+	/* Use a small shard to exercise eviction */
+	node->shard_lines = SHARD_LINES;
+
+	g_ch = calloc(1, sizeof(struct spdk_io_channel) + sizeof(struct read_cache_io_channel));
+	SPDK_CU_ASSERT_FATAL(g_ch != NULL);
+	CU_ASSERT(read_cache_ch_create_cb(node, spdk_io_channel_get_ctx(g_ch)) == 0);
+
+	return node;
+}
+
+static void
+ut_node_destroy(struct vbdev_read_cache *node)
+{
+	read_cache_ch_free(spdk_io_channel_get_ctx(g_ch));
+	free(g_ch);
+	g_ch = NULL;
+	free(node->base_bdev);
+	free(node->generations);
+	free(node);
+}
+
+static struct spdk_bdev_io *
+ut_submit(struct vbdev_read_cache *node, enum spdk_bdev_io_type type, void *buf,
+	  uint64_t offset_blocks, uint64_t num_blocks, bool complete)
+{
+	struct spdk_bdev_io *bdev_io;
+
+	bdev_io = calloc(1, sizeof(*bdev_io) + sizeof(struct read_cache_bdev_io) + sizeof(struct iovec));
+	SPDK_CU_ASSERT_FATAL(bdev_io != NULL);
+	bdev_io->bdev = &node->cache_bdev;
+	bdev_io->type = type;
+	bdev_io->u.bdev.iovs = (struct iovec *)(bdev_io->driver_ctx + sizeof(struct read_cache_bdev_io));
+	bdev_io->u.bdev.iovs[0].iov_base = buf;
+	bdev_io->u.bdev.iovs[0].iov_len = num_blocks * BLOCK_SIZE;
+	bdev_io->u.bdev.iovcnt = 1;
+	bdev_io->u.bdev.offset_blocks = offset_blocks;
+	bdev_io->u.bdev.num_blocks = num_blocks;
+
+	g_io_status = SPDK_BDEV_IO_STATUS_PENDING;
+	vbdev_read_cache_submit_request(g_ch, bdev_io);
+	if (complete) {
+		ut_complete_base_ios();
+		CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_SUCCESS);
+		free(bdev_io);
+		bdev_io = NULL;
+	}
+
+	return bdev_io;
+}
+
+static void
+ut_read(struct vbdev_read_cache *node, uint64_t offset_blocks, uint64_t num_blocks,
+	uint32_t expected_base_ios)
+{
+	uint8_t buf[LINE_BLOCKS * BLOCK_SIZE * 2];
+
+	SPDK_CU_ASSERT_FATAL(num_blocks <= LINE_BLOCKS * 2);
+	memset(buf, 0xff, sizeof(buf));
+	g_num_base_ios = 0;
+	ut_submit(node, SPDK_BDEV_IO_TYPE_READ, buf, offset_blocks, num_blocks, true);
+	CU_ASSERT(g_num_base_ios == expected_base_ios);
+	CU_ASSERT(ut_check_pattern(buf, offset_blocks, num_blocks));
+}
+
+static void
+test_read_hit(void)
+{
+	struct vbdev_read_cache *node = ut_node_create();
+	struct read_cache_io_channel *ch = spdk_io_channel_get_ctx(g_ch);
+
+	/* The first read fills the whole line, the following ones hit */
+	ut_read(node, 3, 2, 1);
+	CU_ASSERT(ch->misses == 1);
+	ut_read(node, 0, LINE_BLOCKS, 0);
+	ut_read(node, 5, 3, 0);
+	CU_ASSERT(ch->hits == 2);
+
+	/* Reads crossing lines don't fill the cache */
+	ut_read(node, LINE_BLOCKS - 1, 2, 1);
+	ut_read(node, LINE_BLOCKS - 1, 2, 1);
+
+	/* But hit once all of their lines are cached */
+	ut_read(node, LINE_BLOCKS, 1, 1);
+	ut_read(node, LINE_BLOCKS - 1, 2, 0);
+	ut_read(node, 4, LINE_BLOCKS * 2 - 4, 0);
+
+	/* The last line is clamped to the end of the bdev */
+	node->cache_bdev.blockcnt = BLOCK_CNT - 3;
+	ut_read(node, BLOCK_CNT - LINE_BLOCKS, 1, 1);
+	ut_read(node, BLOCK_CNT - LINE_BLOCKS + 1, LINE_BLOCKS - 4, 0);
+
+	ut_node_destroy(node);
+}
+
+static void
+test_scan_resistance(void)
+{
+	struct vbdev_read_cache *node = ut_node_create();
+	struct read_cache_io_channel *ch = spdk_io_channel_get_ctx(g_ch);
+	uint64_t i;
+
+	CU_ASSERT(ch->max_protected == SHARD_LINES * READ_CACHE_PROTECTED_PERCENT / 100);
+
+	/* Read lines 0 and 1 twice, so that they get protected */
+	for (i = 0; i < 2; i++) {
+		ut_read(node, 0, 1, i == 0 ? 1 : 0);
+		ut_read(node, LINE_BLOCKS, 1, i == 0 ? 1 : 0);
+	}
+	CU_ASSERT(ch->num_protected == 2);
+
+	/* A scan much larger than the cache only recycles the probation lines */
+	for (i = 2; i < 32; i++) {
+		ut_read(node, i * LINE_BLOCKS, 1, 1);
+	}
+	CU_ASSERT(ch->num_protected == 2);
+	ut_read(node, 0, 1, 0);
+	ut_read(node, LINE_BLOCKS, 1, 0);
+
+	/* Protected lines beyond the limit are demoted back to probation, LRU first */
+	for (i = 2; i < 4; i++) {
+		ut_read(node, i * LINE_BLOCKS, 1, 1);
+		ut_read(node, i * LINE_BLOCKS, 1, 0);
+	}
+	CU_ASSERT(ch->num_protected == ch->max_protected);
+	CU_ASSERT(!read_cache_line_find(ch, 0)->protected);
+	CU_ASSERT(read_cache_line_find(ch, 1)->protected);
+
+	/* Evicting the demoted line */
+	ut_read(node, 5 * LINE_BLOCKS, 1, 1);
+	CU_ASSERT(read_cache_line_find(ch, 0) == NULL);
+	ut_read(node, 0, 1, 1);
+
+	ut_node_destroy(node);
+}
+
+static void
+test_invalidate(void)
+{
+	struct vbdev_read_cache *node = ut_node_create();
+	struct read_cache_io_channel *ch = spdk_io_channel_get_ctx(g_ch);
+	uint8_t buf[LINE_BLOCKS * BLOCK_SIZE];
+	struct spdk_bdev_io *read_io, *write_io;
+
+	/* A write makes the line it covers stale */
+	ut_read(node, 0, 1, 1);
+	ut_read(node, LINE_BLOCKS, 1, 1);
+	ut_submit(node, SPDK_BDEV_IO_TYPE_WRITE, buf, 1, 1, true);
+	ut_read(node, 0, 1, 1);
+	ut_read(node, LINE_BLOCKS, 1, 0);
+
+	CU_ASSERT(read_cache_line_find(ch, 0) != NULL);
+
+	/* A line filled while a write is in flight gets stale once the write completes */
+	write_io = ut_submit(node, SPDK_BDEV_IO_TYPE_WRITE, buf, 2 * LINE_BLOCKS, 1, false);
+	read_io = ut_submit(node, SPDK_BDEV_IO_TYPE_READ, buf, 2 * LINE_BLOCKS, 1, false);
+	ut_complete_base_io(TAILQ_LAST(&g_base_ios, ut_base_io_head));
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(read_cache_line_find(ch, 2) != NULL);
+	ut_complete_base_ios();
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	free(read_io);
+	free(write_io);
+	ut_read(node, 2 * LINE_BLOCKS, 1, 1);
+	ut_read(node, 2 * LINE_BLOCKS, 1, 0);
+
+	/* A line whose fill raced with a write is not inserted */
+	read_io = ut_submit(node, SPDK_BDEV_IO_TYPE_READ, buf, 3 * LINE_BLOCKS, 1, false);
+	read_cache_invalidate(node, 3 * LINE_BLOCKS, 1);
+	ut_complete_base_ios();
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(read_cache_line_find(ch, 3) == NULL);
+	free(read_io);
+
+	/* Ranges larger than the generation table invalidate everything */
+	ut_read(node, 0, 1, 0);
+	read_cache_invalidate(node, 0, (uint64_t)(node->generation_mask + 2) * LINE_BLOCKS);
+	CU_ASSERT(node->epoch == 1);
+	ut_read(node, 0, 1, 1);
+	ut_read(node, 0, 1, 0);
+
+	ut_node_destroy(node);
+}
+
+static void
+test_copy_to_iovs(void)
+{
+	uint8_t src[16], dst[16];
+	struct iovec iovs[3] = {
+		{ .iov_base = &dst[0], .iov_len = 4 },
+		{ .iov_base = &dst[4], .iov_len = 8 },
+		{ .iov_base = &dst[12], .iov_len = 4 },
+	};
+	int i;
+
+	for (i = 0; i < 16; i++) {
+		src[i] = i;
+	}
+
+	memset(dst, 0xff, sizeof(dst));
+	read_cache_copy_to_iovs(iovs, 3, 2, src, 12);
+	CU_ASSERT(dst[0] == 0xff && dst[1] == 0xff);
+	for (i = 0; i < 12; i++) {
+		CU_ASSERT(dst[i + 2] == i);
+	}
+	CU_ASSERT(dst[14] == 0xff && dst[15] == 0xff);
+
+	memset(dst, 0xff, sizeof(dst));
+	read_cache_copy_to_iovs(iovs, 3, 12, src, 4);
+	CU_ASSERT(memcmp(&dst[12], src, 4) == 0);
+	CU_ASSERT(dst[11] == 0xff);
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("read_cache", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_read_hit);
+	CU_ADD_TEST(suite, test_scan_resistance);
+	CU_ADD_TEST(suite, test_invalidate);
+	CU_ADD_TEST(suite, test_copy_to_iovs);
+
+	allocate_cores(1);
+	g_thread = spdk_thread_create("test", NULL);
+	spdk_set_thread(g_thread);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+
+	spdk_thread_exit(g_thread);
+	while (!spdk_thread_is_exited(g_thread)) {
+		spdk_thread_poll(g_thread, 0, 0);
+	}
+	spdk_thread_destroy(g_thread);
+	free_cores();
+
+	CU_cleanup_registry();
+
+	return num_failures;
+}
@@ -0,0 +1,680 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 the SPDK authors.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+#include "spdk_internal/cunit.h"
+#include "spdk/env.h"
+#include "spdk_internal/mock.h"
+#include "thread/thread_internal.h"
+#include "common/lib/test_env.c"
+#include "bdev/wb_cache/vbdev_wb_cache.c"
+#include "unit/lib/json_mock.c"
+
+#define BLOCK_SIZE	512
+#define BASE_BLOCKS	1024
+/* Superblock and a log of 64 blocks, so that entries hold at most 7 blocks of data */
+#define CACHE_BLOCKS	65
+#define MAX_IO_BLOCKS	32
+
+struct ut_disk {
+	struct spdk_bdev	bdev;
+	uint8_t			*data;
+	uint32_t		num_writes;
+	bool			fail_writes;
+};
+
+struct ut_io {
+	spdk_bdev_io_completion_cb	cb;
+	void				*cb_arg;
+	bool				success;
+	TAILQ_ENTRY(ut_io)		link;
+};
+
+static TAILQ_HEAD(, ut_io) g_ios = TAILQ_HEAD_INITIALIZER(g_ios);
+static struct ut_disk g_base = {
+	.bdev = { .name = "base", .blocklen = BLOCK_SIZE, .blockcnt = BASE_BLOCKS },
+};
+static struct ut_disk g_cache = {
+	.bdev = { .name = "cache", .blocklen = BLOCK_SIZE, .blockcnt = CACHE_BLOCKS },
+};
+static struct spdk_thread *g_thread;
+static int g_create_rc;
+static uint32_t g_num_completed;
+static enum spdk_bdev_io_status g_io_status;
+
+DEFINE_STUB_V(spdk_bdev_module_list_add, (struct spdk_bdev_module *bdev_module));
+DEFINE_STUB_V(spdk_bdev_close, (struct spdk_bdev_desc *desc));
+DEFINE_STUB_V(spdk_bdev_module_examine_done, (struct spdk_bdev_module *module));
+DEFINE_STUB_V(spdk_bdev_module_release_bdev, (struct spdk_bdev *bdev));
+DEFINE_STUB_V(spdk_bdev_destruct_done, (struct spdk_bdev *bdev, int bdeverrno));
+DEFINE_STUB(spdk_bdev_module_claim_bdev, int, (struct spdk_bdev *bdev,
+		struct spdk_bdev_desc *desc, struct spdk_bdev_module *module), 0);
+DEFINE_STUB(spdk_bdev_register, int, (struct spdk_bdev *bdev), 0);
+DEFINE_STUB_V(spdk_bdev_unregister, (struct spdk_bdev *bdev, spdk_bdev_unregister_cb cb_fn,
+				     void *cb_arg));
+DEFINE_STUB(spdk_bdev_unregister_by_name, int, (const char *bdev_name,
+		struct spdk_bdev_module *module, spdk_bdev_unregister_cb cb_fn, void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_get_name, const char *, (const struct spdk_bdev *bdev), "ut");
+DEFINE_STUB(spdk_bdev_io_type_supported, bool, (struct spdk_bdev *bdev,
+		enum spdk_bdev_io_type io_type), true);
+DEFINE_STUB(spdk_bdev_queue_io_wait, int, (struct spdk_bdev *bdev, struct spdk_io_channel *ch,
+		struct spdk_bdev_io_wait_entry *entry), 0);
+DEFINE_STUB(spdk_bdev_reset, int, (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+				   spdk_bdev_io_completion_cb cb, void *cb_arg), 0);
+
+/* Descriptors and channels of the fake bdevs point at the disks. */
+static struct ut_disk *
+ut_disk_get(const char *name)
+{
+	if (strcmp(name, g_base.bdev.name) == 0) {
+		return &g_base;
+	} else if (strcmp(name, g_cache.bdev.name) == 0) {
+		return &g_cache;
+	}
+
+	return NULL;
+}
+
+struct spdk_bdev *
+spdk_bdev_get_by_name(const char *bdev_name)
+{
+	struct ut_disk *disk = ut_disk_get(bdev_name);
+
+	return disk ? &disk->bdev : NULL;
+}
+
+int
+spdk_bdev_open_ext(const char *bdev_name, bool write, spdk_bdev_event_cb_t event_cb,
+		   void *event_ctx, struct spdk_bdev_desc **desc)
+{
+	struct ut_disk *disk = ut_disk_get(bdev_name);
+
+	*desc = (struct spdk_bdev_desc *)disk;
+
+	return disk ? 0 : -ENODEV;
+}
+
+struct spdk_bdev *
+spdk_bdev_desc_get_bdev(struct spdk_bdev_desc *desc)
+{
+	return &((struct ut_disk *)desc)->bdev;
+}
+
+struct spdk_io_channel *
+spdk_bdev_get_io_channel(struct spdk_bdev_desc *desc)
+{
+	return spdk_get_io_channel(desc);
+}
+
+struct spdk_thread *
+spdk_bdev_io_get_thread(struct spdk_bdev_io *bdev_io)
+{
+	return g_thread;
+}
+
+void
+spdk_bdev_io_get_buf(struct spdk_bdev_io *bdev_io, spdk_bdev_io_get_buf_cb cb, uint64_t len)
+{
+	cb(NULL, bdev_io, true);
+}
+
+void
+spdk_bdev_io_complete(struct spdk_bdev_io *bdev_io, enum spdk_bdev_io_status status)
+{
+	g_io_status = status;
+	g_num_completed++;
+}
+
+void
+spdk_bdev_free_io(struct spdk_bdev_io *bdev_io)
+{
+	free(bdev_io);
+}
+
+static int
+ut_ch_create_cb(void *io_device, void *ctx_buf)
+{
+	return 0;
+}
+
+static void
+ut_ch_destroy_cb(void *io_device, void *ctx_buf)
+{
+}
+
+/* I/O is done on submission, its completion is deferred until ut_complete_ios(). */
+static void
+ut_queue_io(spdk_bdev_io_completion_cb cb, void *cb_arg, bool success)
+{
+	struct ut_io *io;
+
+	io = calloc(1, sizeof(*io));
+	SPDK_CU_ASSERT_FATAL(io != NULL);
+	io->cb = cb;
+	io->cb_arg = cb_arg;
+	io->success = success;
+	TAILQ_INSERT_TAIL(&g_ios, io, link);
+}
+
+static void
+ut_complete_ios(void)
+{
+	struct spdk_bdev_io *bdev_io;
+	struct ut_io *io;
+
+	while ((io = TAILQ_FIRST(&g_ios))) {
+		TAILQ_REMOVE(&g_ios, io, link);
+		bdev_io = calloc(1, sizeof(*bdev_io));
+		SPDK_CU_ASSERT_FATAL(bdev_io != NULL);
+		io->cb(bdev_io, io->success, io->cb_arg);
+		free(io);
+	}
+}
+
+static void
+ut_disk_io(struct spdk_io_channel *ch, struct iovec *iovs, int iovcnt, uint64_t offset_blocks,
+	   uint64_t num_blocks, bool write, spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	struct ut_disk *disk = spdk_io_channel_get_io_device(ch);
+	uint8_t *data = disk->data + offset_blocks * BLOCK_SIZE;
+	uint64_t len = 0;
+	int i;
+
+	SPDK_CU_ASSERT_FATAL(offset_blocks + num_blocks <= disk->bdev.blockcnt);
+	if (write && disk->fail_writes) {
+		ut_queue_io(cb, cb_arg, false);
+		return;
+	}
+
+	for (i = 0; i < iovcnt; i++) {
+		if (iovs == NULL) {
+			memset(data + len, 0, num_blocks * BLOCK_SIZE);
+			len = num_blocks * BLOCK_SIZE;
+			break;
+		} else if (write) {
+			memcpy(data + len, iovs[i].iov_base, iovs[i].iov_len);
+		} else {
+			memcpy(iovs[i].iov_base, data + len, iovs[i].iov_len);
+		}
+		len += iovs[i].iov_len;
+	}
+	CU_ASSERT(len == num_blocks * BLOCK_SIZE);
+
+	disk->num_writes += write;
+	ut_queue_io(cb, cb_arg, true);
+}
+
+int
+spdk_bdev_readv_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		       struct iovec *iov, int iovcnt, uint64_t offset_blocks, uint64_t num_blocks,
+		       spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	ut_disk_io(ch, iov, iovcnt, offset_blocks, num_blocks, false, cb, cb_arg);
+
+	return 0;
+}
+
+int
+spdk_bdev_writev_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+			struct iovec *iov, int iovcnt, uint64_t offset_blocks, uint64_t num_blocks,
+			spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	ut_disk_io(ch, iov, iovcnt, offset_blocks, num_blocks, true, cb, cb_arg);
+
+	return 0;
+}
+
+int
+spdk_bdev_write_zeroes_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+			      uint64_t offset_blocks, uint64_t num_blocks,
+			      spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	ut_disk_io(ch, NULL, 1, offset_blocks, num_blocks, true, cb, cb_arg);
+
+	return 0;
+}
+
+int
+spdk_bdev_unmap_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		       uint64_t offset_blocks, uint64_t num_blocks,
+		       spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	ut_disk_io(ch, NULL, 1, offset_blocks, num_blocks, true, cb, cb_arg);
+
+	return 0;
+}
+
+int
+spdk_bdev_flush_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		       uint64_t offset_blocks, uint64_t num_blocks,
+		       spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	ut_queue_io(cb, cb_arg, true);
+
+	return 0;
+}
+
+static void
+ut_create_cb(void *cb_arg, int bdeverrno)
+{
+	g_create_rc = bdeverrno;
+}
+
+static struct vbdev_wb_cache *
+ut_node_create(int expected_rc)
+{
+	struct vbdev_wb_cache_opts opts = {
+		.name = "wbc",
+		.base_bdev_name = "base",
+		.cache_bdev_name = "cache",
+	};
+
+	g_create_rc = 1;
+	CU_ASSERT(bdev_wb_cache_create_disk(&opts, ut_create_cb, NULL) == 0);
+	ut_complete_ios();
+	CU_ASSERT(g_create_rc == expected_rc);
+	if (expected_rc != 0) {
+		return NULL;
+	}
+
+	SPDK_CU_ASSERT_FATAL(!TAILQ_EMPTY(&g_wb_cache_nodes));
+	return TAILQ_FIRST(&g_wb_cache_nodes);
+}
+
+static void
+ut_node_destroy(struct vbdev_wb_cache *node)
+{
+	struct bdev_association *assoc = node->assoc;
+
+	CU_ASSERT(vbdev_wb_cache_destruct(node) == 1);
+	while (spdk_thread_poll(g_thread, 0, 0) > 0) {
+	}
+	vbdev_wb_cache_free_association(assoc);
+	while (spdk_thread_poll(g_thread, 0, 0) > 0) {
+	}
+}
+
+static struct spdk_bdev_io *
+ut_bdev_io_alloc(struct vbdev_wb_cache *node, enum spdk_bdev_io_type type, void *buf,
+		 uint64_t offset_blocks, uint64_t num_blocks)
+{
+	struct spdk_bdev_io *bdev_io;
+
+	bdev_io = calloc(1, sizeof(*bdev_io) + sizeof(struct wb_cache_bdev_io) + sizeof(struct iovec));
+	SPDK_CU_ASSERT_FATAL(bdev_io != NULL);
+	bdev_io->bdev = &node->wb_bdev;
+	bdev_io->type = type;
+	bdev_io->u.bdev.iovs = (struct iovec *)(bdev_io->driver_ctx + sizeof(struct wb_cache_bdev_io));
+	bdev_io->u.bdev.iovs[0].iov_base = buf;
+	bdev_io->u.bdev.iovs[0].iov_len = num_blocks * BLOCK_SIZE;
+	bdev_io->u.bdev.iovcnt = 1;
+	bdev_io->u.bdev.offset_blocks = offset_blocks;
+	bdev_io->u.bdev.num_blocks = num_blocks;
+
+	return bdev_io;
+}
+
+static struct spdk_bdev_io *
+ut_submit(struct vbdev_wb_cache *node, enum spdk_bdev_io_type type, void *buf,
+	  uint64_t offset_blocks, uint64_t num_blocks, bool complete)
+{
+	struct spdk_bdev_io *bdev_io;
+
+	bdev_io = ut_bdev_io_alloc(node, type, buf, offset_blocks, num_blocks);
+
+	g_num_completed = 0;
+	g_io_status = SPDK_BDEV_IO_STATUS_PENDING;
+	vbdev_wb_cache_submit_request(NULL, bdev_io);
+	if (complete) {
+		ut_complete_ios();
+		CU_ASSERT(g_num_completed == 1);
+		CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_SUCCESS);
+		free(bdev_io);
+		bdev_io = NULL;
+	}
+
+	return bdev_io;
+}
+
+static void
+ut_write(struct vbdev_wb_cache *node, uint64_t offset_blocks, uint64_t num_blocks, uint8_t val)
+{
+	uint8_t buf[MAX_IO_BLOCKS * BLOCK_SIZE];
+
+	SPDK_CU_ASSERT_FATAL(num_blocks <= MAX_IO_BLOCKS);
+	memset(buf, val, num_blocks * BLOCK_SIZE);
+	ut_submit(node, SPDK_BDEV_IO_TYPE_WRITE, buf, offset_blocks, num_blocks, true);
+}
+
+/* Check that each of the blocks holds the value it's expected to. */
+static bool
+ut_check(const uint8_t *data, const uint8_t *expected, uint64_t offset_blocks,
+	 uint64_t num_blocks)
+{
+	uint64_t i, j;
+
+	for (i = 0; i < num_blocks; i++) {
+		for (j = 0; j < BLOCK_SIZE; j++) {
+			if (data[i * BLOCK_SIZE + j] != expected[offset_blocks + i]) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+static bool
+ut_read_check(struct vbdev_wb_cache *node, const uint8_t *expected, uint64_t offset_blocks,
+	      uint64_t num_blocks)
+{
+	uint8_t buf[MAX_IO_BLOCKS * BLOCK_SIZE];
+
+	SPDK_CU_ASSERT_FATAL(num_blocks <= MAX_IO_BLOCKS);
+	memset(buf, 0xff, sizeof(buf));
+	ut_submit(node, SPDK_BDEV_IO_TYPE_READ, buf, offset_blocks, num_blocks, true);
+
+	return ut_check(buf, expected, offset_blocks, num_blocks);
+}
+
+static void
+ut_destage_all(struct vbdev_wb_cache *node)
+{
+	while (node->used_blocks > 0) {
+		wb_cache_destage(node);
+		ut_complete_ios();
+		SPDK_CU_ASSERT_FATAL(!node->destage.failed);
+	}
+}
+
+static void
+ut_disks_reset(void)
+{
+	uint64_t i;
+
+	memset(g_cache.data, 0, CACHE_BLOCKS * BLOCK_SIZE);
+	for (i = 0; i < BASE_BLOCKS; i++) {
+		memset(g_base.data + i * BLOCK_SIZE, (uint8_t)i, BLOCK_SIZE);
+	}
+	g_base.num_writes = 0;
+	g_cache.num_writes = 0;
+}
+
+static void
+ut_expected_init(uint8_t *expected)
+{
+	uint64_t i;
+
+	for (i = 0; i < BASE_BLOCKS; i++) {
+		expected[i] = (uint8_t)i;
+	}
+}
+
+static void
+test_map(void)
+{
+	struct vbdev_wb_cache node = {};
+	struct wb_cache_entry entries[3] = {};
+	struct wb_cache_extent *ext, *spare;
+	int i;
+
+	RB_INIT(&node.extents);
+	for (i = 0; i < 3; i++) {
+		TAILQ_INIT(&entries[i].extents);
+		entries[i].offset = i * 10;
+	}
+
+	entries[0].base_offset = 0;
+	entries[0].num_blocks = 8;
+	CU_ASSERT(wb_cache_map_insert(&node, &entries[0]) == 0);
+
+	/* Overwriting the middle splits the older extent */
+	entries[1].base_offset = 2;
+	entries[1].num_blocks = 2;
+	CU_ASSERT(wb_cache_map_insert(&node, &entries[1]) == 0);
+
+	ext = wb_cache_extent_find(&node, 0);
+	CU_ASSERT(ext->entry == &entries[0] && ext->base_offset == 0 && ext->num_blocks == 2);
+	ext = wb_cache_extent_find(&node, 3);
+	CU_ASSERT(ext->entry == &entries[1] && ext->cache_offset == 11);
+	ext = wb_cache_extent_find(&node, 4);
+	CU_ASSERT(ext->entry == &entries[0] && ext->num_blocks == 4 && ext->cache_offset == 5);
+
+	/* Overlapping the ends trims both neighbours */
+	entries[2].base_offset = 1;
+	entries[2].num_blocks = 4;
+	CU_ASSERT(wb_cache_map_insert(&node, &entries[2]) == 0);
+	CU_ASSERT(TAILQ_EMPTY(&entries[1].extents));
+	ext = wb_cache_extent_find(&node, 0);
+	CU_ASSERT(ext->base_offset == 0 && ext->num_blocks == 1);
+	ext = RB_NEXT(wb_cache_extent_tree, &node.extents, ext);
+	CU_ASSERT(ext->entry == &entries[2] && ext->num_blocks == 4);
+	ext = RB_NEXT(wb_cache_extent_tree, &node.extents, ext);
+	CU_ASSERT(ext->entry == &entries[0] && ext->base_offset == 5 && ext->num_blocks == 3 &&
+		  ext->cache_offset == 6);
+	CU_ASSERT(wb_cache_extent_find(&node, 8) == NULL);
+
+	/* Removing only the extents of one entry */
+	wb_cache_map_remove(&node, 0, 8, &entries[0], NULL);
+	CU_ASSERT(TAILQ_EMPTY(&entries[0].extents));
+	CU_ASSERT(wb_cache_extent_find(&node, 0) == TAILQ_FIRST(&entries[2].extents));
+
+	spare = calloc(1, sizeof(*spare));
+	SPDK_CU_ASSERT_FATAL(spare != NULL);
+	wb_cache_map_remove(&node, 2, 1, NULL, &spare);
+	CU_ASSERT(spare == NULL);
+	wb_cache_map_remove(&node, 0, 8, NULL, NULL);
+	CU_ASSERT(RB_EMPTY(&node.extents));
+}
+
+static void
+test_log_alloc(void)
+{
+	struct vbdev_wb_cache node = { .log_blocks = 16 };
+	uint64_t offset, log_blocks;
+
+	CU_ASSERT(wb_cache_log_alloc(&node, 6, &offset, &log_blocks));
+	CU_ASSERT(offset == 0 && log_blocks == 6);
+	CU_ASSERT(wb_cache_log_alloc(&node, 6, &offset, &log_blocks));
+	CU_ASSERT(offset == 6 && log_blocks == 6);
+	CU_ASSERT(!wb_cache_log_alloc(&node, 6, &offset, &log_blocks));
+
+	/* The space skipped when wrapping is charged to the wrapping entry */
+	node.used_blocks -= 6;
+	CU_ASSERT(!wb_cache_log_alloc(&node, 8, &offset, &log_blocks));
+	CU_ASSERT(wb_cache_log_alloc(&node, 5, &offset, &log_blocks));
+	CU_ASSERT(offset == 0 && log_blocks == 9);
+	CU_ASSERT(node.used_blocks == 15 && node.tail == 5);
+	CU_ASSERT(wb_cache_log_alloc(&node, 1, &offset, &log_blocks));
+	CU_ASSERT(offset == 5 && log_blocks == 1);
+	CU_ASSERT(!wb_cache_log_alloc(&node, 1, &offset, &log_blocks));
+}
+
+static void
+test_write_read(void)
+{
+	static uint8_t expected[BASE_BLOCKS];
+	static uint8_t buf[MAX_IO_BLOCKS * BLOCK_SIZE];
+	struct vbdev_wb_cache *node;
+	struct spdk_bdev_io *bdev_io;
+
+	ut_disks_reset();
+	ut_expected_init(expected);
+	node = ut_node_create(0);
+	SPDK_CU_ASSERT_FATAL(node != NULL);
+	CU_ASSERT(node->log_blocks == CACHE_BLOCKS - 1);
+	CU_ASSERT(node->max_entry_blocks == 7);
+
+	/* Writes go to the log only, larger ones are split */
+	ut_write(node, 10, 20, 0xa0);
+	memset(&expected[10], 0xa0, 20);
+	ut_write(node, 14, 2, 0xa1);
+	memset(&expected[14], 0xa1, 2);
+	CU_ASSERT(g_base.num_writes == 0);
+	CU_ASSERT(node->used_blocks == 3 + 20 + 1 + 2);
+
+	/* Reads are split between the base bdev and the log */
+	CU_ASSERT(ut_read_check(node, expected, 5, 30));
+	CU_ASSERT(ut_read_check(node, expected, 15, 1));
+
+	ut_submit(node, SPDK_BDEV_IO_TYPE_WRITE_ZEROES, NULL, 20, 4, true);
+	memset(&expected[20], 0, 4);
+	CU_ASSERT(ut_read_check(node, expected, 16, 10));
+
+	/* Destaging writes back the latest data */
+	ut_destage_all(node);
+	CU_ASSERT(RB_EMPTY(&node->extents));
+	CU_ASSERT(TAILQ_EMPTY(&node->entries));
+	CU_ASSERT(ut_check(g_base.data, expected, 0, BASE_BLOCKS));
+	CU_ASSERT(ut_read_check(node, expected, 5, 30));
+
+	/* Writes wait for the log to be destaged once it's full */
+	ut_write(node, 100, 30, 0xb0);
+	ut_write(node, 200, 30, 0xb1);
+	memset(buf, 0xb2, sizeof(buf));
+	bdev_io = ut_submit(node, SPDK_BDEV_IO_TYPE_WRITE, buf, 300, 30, false);
+	CU_ASSERT(g_num_completed == 0);
+	CU_ASSERT(!TAILQ_EMPTY(&node->pending_writes));
+	memset(&expected[100], 0xb0, 30);
+	memset(&expected[200], 0xb1, 30);
+	while (g_num_completed == 0) {
+		ut_complete_ios();
+		wb_cache_destage(node);
+	}
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	free(bdev_io);
+	memset(&expected[300], 0xb2, 30);
+	ut_destage_all(node);
+	CU_ASSERT(ut_check(g_base.data, expected, 0, BASE_BLOCKS));
+
+	/* A write whose log entry can't be allocated fails rather than waiting for destage */
+	bdev_io = ut_bdev_io_alloc(node, SPDK_BDEV_IO_TYPE_WRITE, buf, 400, 2);
+	g_num_completed = 0;
+	g_io_status = SPDK_BDEV_IO_STATUS_PENDING;
+	MOCK_SET(calloc, NULL);
+	vbdev_wb_cache_submit_request(NULL, bdev_io);
+	MOCK_CLEAR(calloc);
+	ut_complete_ios();
+	CU_ASSERT(g_num_completed == 1);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_FAILED);
+	CU_ASSERT(TAILQ_EMPTY(&node->pending_writes));
+	CU_ASSERT(!node->failed);
+	free(bdev_io);
+
+	/* A failed write turns into a hole and fails the I/O */
+	g_cache.fail_writes = true;
+	bdev_io = ut_submit(node, SPDK_BDEV_IO_TYPE_WRITE, buf, 400, 2, false);
+	ut_complete_ios();
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_FAILED);
+	CU_ASSERT(node->failed);
+	free(bdev_io);
+	g_cache.fail_writes = false;
+
+	ut_node_destroy(node);
+}
+
+static void
+test_recovery(void)
+{
+	static uint8_t expected[BASE_BLOCKS];
+	struct vbdev_wb_cache *node;
+	struct wb_cache_sb *sb;
+
+	ut_disks_reset();
+	ut_expected_init(expected);
+	node = ut_node_create(0);
+	SPDK_CU_ASSERT_FATAL(node != NULL);
+
+	/* Fill the log so that it wraps around */
+	ut_write(node, 0, 7, 0xc0);
+	ut_write(node, 7, 7, 0xc1);
+	ut_write(node, 14, 7, 0xc2);
+	ut_write(node, 21, 7, 0xc3);
+	ut_destage_all(node);
+	memset(&expected[0], 0xc0, 7);
+	memset(&expected[7], 0xc1, 7);
+	memset(&expected[14], 0xc2, 7);
+	memset(&expected[21], 0xc3, 7);
+
+	ut_write(node, 50, 7, 0xc4);
+	ut_write(node, 60, 7, 0xc5);
+	ut_write(node, 70, 7, 0xc6);
+	ut_write(node, 90, 7, 0xc7);
+	ut_submit(node, SPDK_BDEV_IO_TYPE_UNMAP, NULL, 52, 10, true);
+	memset(&expected[50], 0xc4, 7);
+	memset(&expected[60], 0xc5, 7);
+	memset(&expected[70], 0xc6, 7);
+	memset(&expected[90], 0xc7, 7);
+	memset(&expected[52], 0, 10);
+	CU_ASSERT(TAILQ_FIRST(&node->entries)->offset == 32);
+	CU_ASSERT(TAILQ_LAST(&node->entries, wb_cache_entries)->offset < 32);
+	CU_ASSERT(g_base.data[50 * BLOCK_SIZE] == 50);
+
+	/* "Crash", the log is replayed when the bdev is created again */
+	ut_node_destroy(node);
+	node = ut_node_create(0);
+	SPDK_CU_ASSERT_FATAL(node != NULL);
+	CU_ASSERT(ut_check(g_base.data, expected, 0, BASE_BLOCKS));
+	CU_ASSERT(node->used_blocks == 0);
+	CU_ASSERT(TAILQ_EMPTY(&node->entries));
+
+	/* Entries of the replayed log are not found again */
+	ut_write(node, 80, 1, 0xc8);
+	expected[80] = 0xc8;
+	ut_node_destroy(node);
+	node = ut_node_create(0);
+	SPDK_CU_ASSERT_FATAL(node != NULL);
+	CU_ASSERT(ut_check(g_base.data, expected, 0, BASE_BLOCKS));
+	ut_node_destroy(node);
+
+	/* A log of another base bdev is refused */
+	sb = (struct wb_cache_sb *)g_cache.data;
+	sb->base_uuid.u.raw[0]++;
+	sb->crc = 0;
+	sb->crc = spdk_crc32c_update(sb, sizeof(*sb), ~0u);
+	ut_node_create(-EINVAL);
+	CU_ASSERT(TAILQ_EMPTY(&g_bdev_associations));
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("wb_cache", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_map);
+	CU_ADD_TEST(suite, test_log_alloc);
+	CU_ADD_TEST(suite, test_write_read);
+	CU_ADD_TEST(suite, test_recovery);
+
+	allocate_cores(1);
+	g_thread = spdk_thread_create("test", NULL);
+	spdk_set_thread(g_thread);
+	g_base.data = calloc(BASE_BLOCKS, BLOCK_SIZE);
+	g_cache.data = calloc(CACHE_BLOCKS, BLOCK_SIZE);
+	spdk_io_device_register(&g_base, ut_ch_create_cb, ut_ch_destroy_cb, 0, "base");
+	spdk_io_device_register(&g_cache, ut_ch_create_cb, ut_ch_destroy_cb, 0, "cache");
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+
+	spdk_io_device_unregister(&g_base, NULL);
+	spdk_io_device_unregister(&g_cache, NULL);
+	free(g_base.data);
+	free(g_cache.data);
+	spdk_thread_exit(g_thread);
+	while (!spdk_thread_is_exited(g_thread)) {
+		spdk_thread_poll(g_thread, 0, 0);
+	}
+	spdk_thread_destroy(g_thread);
+	free_cores();
+
+	CU_cleanup_registry();
+
+	return num_failures;
+}
@@ -1065,7 +1065,7 @@ _blob_inflate(bool decouple_parent)
 	struct spdk_blob *blob, *snapshot;
 	spdk_blob_id blobid, snapshotid;
 	struct spdk_io_channel *channel;
-	uint64_t free_clusters;
+	uint64_t free_clusters, write_bytes;
 
 	channel = spdk_bs_alloc_io_channel(bs);
 	SPDK_CU_ASSERT_FATAL(channel != NULL);
@@ -1089,10 +1089,13 @@ _blob_inflate(bool decouple_parent)
 		CU_ASSERT(g_bserrno != 0);
 	} else {
 		/* Inflate of thin blob with no parent should made it thick */
+		write_bytes = g_dev_write_bytes;
 		spdk_bs_inflate_blob(bs, channel, blobid, blob_op_complete, NULL);
 		poll_threads();
 		CU_ASSERT(g_bserrno == 0);
 		CU_ASSERT(spdk_blob_is_thin_provisioned(blob) == false);
+		/* Clusters of zeroes are claimed together, without a metadata update for each */
+		CU_ASSERT(g_dev_write_bytes - write_bytes < 10 * SPDK_BS_PAGE_SIZE);
 	}
 
 	spdk_bs_create_snapshot(bs, blobid, NULL, blob_op_with_id_complete, NULL);
@@ -8537,6 +8540,72 @@ blob_esnap_clone_snapshot(void)
 	ut_blob_close_and_delete(bs, blob);
 }
 
+static void
+blob_esnap_clone_snapshot_cow(void)
+{
+	/*
+	 * Write to a clone of a snapshot that is itself an esnap clone. The cluster that is
+	 * allocated by the first write must be filled from the external snapshot, which
+	 * isn't on the blobstore's device and thus can't be the source of a device copy.
+	 */
+	struct spdk_blob_store	*bs = g_bs;
+	const uint32_t		blocklen = bs->io_unit_size;
+	const uint64_t		cluster_blocks = bs->cluster_sz / blocklen;
+	struct spdk_blob_opts	opts;
+	struct ut_esnap_opts	esnap_opts;
+	struct ut_esnap_dev	*esnap_dev;
+	struct spdk_blob	*blob, *snap_blob;
+	struct spdk_io_channel	*channel;
+	uint8_t			buf[blocklen];
+	uint64_t		block;
+
+	channel = spdk_bs_alloc_io_channel(bs);
+	SPDK_CU_ASSERT_FATAL(channel != NULL);
+
+	/* Create an esnap clone and snapshot it */
+	ut_esnap_opts_init(blocklen, 2048, __func__, NULL, &esnap_opts);
+	ut_spdk_blob_opts_init(&opts);
+	opts.esnap_id = &esnap_opts;
+	opts.esnap_id_len = sizeof(esnap_opts);
+	opts.num_clusters = 1;
+	blob = ut_blob_create_and_open(bs, &opts);
+	SPDK_CU_ASSERT_FATAL(blob != NULL);
+
+	spdk_bs_create_snapshot(bs, blob->id, NULL, blob_op_with_id_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(g_blobid != SPDK_BLOBID_INVALID);
+
+	spdk_bs_open_blob(bs, g_blobid, blob_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_blob != NULL);
+	snap_blob = g_blob;
+	UT_ASSERT_IS_NOT_ESNAP_CLONE(blob);
+	UT_ASSERT_IS_ESNAP_CLONE(snap_blob, &esnap_opts, sizeof(esnap_opts));
+	esnap_dev = (struct ut_esnap_dev *)snap_blob->back_bs_dev;
+
+	/* Allocate the cluster with a write to its first block */
+	memset(buf, 0xa5, blocklen);
+	spdk_blob_io_write(blob, channel, buf, 0, 1, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	/* The rest of the cluster still has the content of the external snapshot */
+	for (block = 1; block < cluster_blocks; block++) {
+		spdk_blob_io_read(blob, channel, buf, block, 1, blob_op_complete, NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+		CU_ASSERT(ut_esnap_content_is_correct(buf, blocklen, esnap_dev->blob_id,
+						      block * blocklen, blocklen));
+	}
+
+	ut_blob_close_and_delete(bs, blob);
+	ut_blob_close_and_delete(bs, snap_blob);
+	spdk_bs_free_io_channel(channel);
+	poll_threads();
+}
+
 static uint64_t
 _blob_esnap_clone_hydrate(bool inflate)
 {
@@ -9037,6 +9106,7 @@ main(int argc, char **argv)
 		CU_ADD_TEST(suite, blob_esnap_io_512_4096);
 		CU_ADD_TEST(suite_esnap_bs, blob_esnap_thread_add_remove);
 		CU_ADD_TEST(suite_esnap_bs, blob_esnap_clone_snapshot);
+		CU_ADD_TEST(suite_esnap_bs, blob_esnap_clone_snapshot_cow);
 		CU_ADD_TEST(suite_esnap_bs, blob_esnap_clone_inflate);
 		CU_ADD_TEST(suite_esnap_bs, blob_esnap_clone_decouple);
 		CU_ADD_TEST(suite_esnap_bs, blob_esnap_clone_reload);
@@ -706,6 +706,7 @@ test_nvme_allocate_request(void)
 	STAILQ_INIT(&qpair.free_req);
 	STAILQ_INIT(&qpair.queued_req);
 	qpair.num_outstanding_reqs = 0;
+	qpair.req_pool = NULL;
 
 	/* Test trying to allocate a request when no requests are available */
 	req = nvme_allocate_request(&qpair, &payload, payload_struct_size, 0,
@@ -741,6 +742,7 @@ test_nvme_free_request(void)
 	qpair.num_outstanding_reqs = 1;
 	/* the code under tests asserts this condition */
 	match_req.num_children = 0;
+	match_req.shared = 0;
 	STAILQ_INIT(&qpair.free_req);
 	match_req.qpair->reserved_req = NULL;
 
@@ -753,7 +755,7 @@ test_nvme_free_request(void)
 static void
 test_nvme_allocate_request_user_copy(void)
 {
-	struct spdk_nvme_qpair qpair;
+	struct spdk_nvme_qpair qpair = {};
 	spdk_nvme_cmd_cb cb_fn = (spdk_nvme_cmd_cb)0x12345;
 	void *cb_arg = (void *)0x12345;
 	bool host_to_controller = true;
@@ -765,6 +767,8 @@ test_nvme_allocate_request_user_copy(void)
 
 	STAILQ_INIT(&qpair.free_req);
 	STAILQ_INIT(&qpair.queued_req);
+	qpair.num_outstanding_reqs = 0;
+	qpair.req_pool = NULL;
 
 	/* no buffer or valid payload size, early NULL return */
 	req = nvme_allocate_request_user_copy(&qpair, buffer, payload_size, cb_fn,
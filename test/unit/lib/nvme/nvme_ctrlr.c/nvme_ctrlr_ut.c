@@ -635,6 +635,7 @@ nvme_ns_has_supported_iocs_specific_data(struct spdk_nvme_ns *ns)
 		 */
 		return false;
 	case SPDK_NVME_CSI_ZNS:
+	case SPDK_NVME_CSI_KV:
 		return true;
 	default:
 		SPDK_WARNLOG("Unsupported CSI: %u for NSID: %u\n", ns->csi, ns->id);
@@ -655,6 +656,19 @@ nvme_ns_free_zns_specific_data(struct spdk_nvme_ns *ns)
 	}
 }
 
+void
+nvme_ns_free_kv_specific_data(struct spdk_nvme_ns *ns)
+{
+	if (!ns->id) {
+		return;
+	}
+
+	if (ns->nsdata_kv) {
+		spdk_free(ns->nsdata_kv);
+		ns->nsdata_kv = NULL;
+	}
+}
+
 void
 nvme_ns_destruct(struct spdk_nvme_ns *ns)
 {
@@ -0,0 +1,219 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 the SPDK authors.
+ *   All rights reserved.
+ */
+
+#include "spdk_internal/cunit.h"
+#include "spdk/endian.h"
+
+#include "nvme/nvme_kv.c"
+
+#include "common/lib/test_env.c"
+
+pid_t g_spdk_nvme_pid;
+
+static struct nvme_request *g_request;
+
+int
+nvme_qpair_submit_request(struct spdk_nvme_qpair *qpair, struct nvme_request *req)
+{
+	g_request = req;
+
+	return 0;
+}
+
+static void
+ut_init_qpair(struct spdk_nvme_qpair *qpair, struct nvme_request *req)
+{
+	memset(qpair, 0, sizeof(*qpair));
+	STAILQ_INIT(&qpair->free_req);
+	STAILQ_INSERT_HEAD(&qpair->free_req, req, stailq);
+	g_request = NULL;
+}
+
+static void
+test_nvme_kv_store(void)
+{
+	struct spdk_nvme_ns ns = { .id = 1 };
+	struct spdk_nvme_qpair qpair;
+	struct nvme_request req;
+	const uint8_t key[SPDK_NVME_KV_KEY_MAX_LEN] = {
+		0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+		0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10,
+	};
+	char value[512];
+	int rc;
+
+	ut_init_qpair(&qpair, &req);
+
+	rc = spdk_nvme_kv_store(&ns, &qpair, key, sizeof(key), value, sizeof(value),
+				SPDK_NVME_KV_STORE_MUST_NOT_EXIST, NULL, NULL);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(g_request == &req);
+	CU_ASSERT(req.cmd.opc == SPDK_NVME_OPC_KV_STORE);
+	CU_ASSERT(req.cmd.nsid == 1);
+	CU_ASSERT(req.cmd.rsvd2 == from_le32(&key[0]));
+	CU_ASSERT(req.cmd.rsvd3 == from_le32(&key[4]));
+	CU_ASSERT(req.cmd.cdw14 == from_le32(&key[8]));
+	CU_ASSERT(req.cmd.cdw15 == from_le32(&key[12]));
+	CU_ASSERT(req.cmd.cdw10 == sizeof(value));
+	CU_ASSERT(req.cmd.cdw11 == (sizeof(key) | SPDK_NVME_KV_STORE_MUST_NOT_EXIST << 8));
+	CU_ASSERT(req.payload.contig_or_cb_arg == value);
+	CU_ASSERT(req.payload_size == sizeof(value));
+
+	/* Unknown store options are rejected. */
+	ut_init_qpair(&qpair, &req);
+
+	rc = spdk_nvme_kv_store(&ns, &qpair, key, sizeof(key), value, sizeof(value),
+				0x80, NULL, NULL);
+	CU_ASSERT(rc == -EINVAL);
+	CU_ASSERT(g_request == NULL);
+}
+
+static void
+test_nvme_kv_retrieve(void)
+{
+	struct spdk_nvme_ns ns = { .id = 1 };
+	struct spdk_nvme_qpair qpair;
+	struct nvme_request req;
+	const char *key = "abc";
+	char value[4096];
+	int rc;
+
+	ut_init_qpair(&qpair, &req);
+
+	rc = spdk_nvme_kv_retrieve(&ns, &qpair, key, 3, value, sizeof(value), NULL, NULL);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(g_request == &req);
+	CU_ASSERT(req.cmd.opc == SPDK_NVME_OPC_KV_RETRIEVE);
+	CU_ASSERT(spdk_nvme_opc_get_data_transfer(req.cmd.opc) == SPDK_NVME_DATA_CONTROLLER_TO_HOST);
+	/* Short keys are padded with zeroes. */
+	CU_ASSERT(req.cmd.rsvd2 == ('a' | 'b' << 8 | 'c' << 16));
+	CU_ASSERT(req.cmd.rsvd3 == 0);
+	CU_ASSERT(req.cmd.cdw14 == 0);
+	CU_ASSERT(req.cmd.cdw15 == 0);
+	CU_ASSERT(req.cmd.cdw10 == sizeof(value));
+	CU_ASSERT(req.cmd.cdw11 == 3);
+}
+
+static void
+test_nvme_kv_no_data(void)
+{
+	struct spdk_nvme_ns ns = { .id = 2 };
+	struct spdk_nvme_qpair qpair;
+	struct nvme_request req;
+	const char *key = "key";
+	int rc;
+
+	ut_init_qpair(&qpair, &req);
+
+	rc = spdk_nvme_kv_delete(&ns, &qpair, key, 3, NULL, NULL);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(g_request == &req);
+	CU_ASSERT(req.cmd.opc == SPDK_NVME_OPC_KV_DELETE);
+	CU_ASSERT(spdk_nvme_opc_get_data_transfer(req.cmd.opc) == SPDK_NVME_DATA_NONE);
+	CU_ASSERT(req.cmd.nsid == 2);
+	CU_ASSERT(req.cmd.cdw10 == 0);
+	CU_ASSERT(req.cmd.cdw11 == 3);
+	CU_ASSERT(req.payload_size == 0);
+
+	ut_init_qpair(&qpair, &req);
+
+	rc = spdk_nvme_kv_exist(&ns, &qpair, key, 3, NULL, NULL);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(g_request == &req);
+	CU_ASSERT(req.cmd.opc == SPDK_NVME_OPC_KV_EXIST);
+	CU_ASSERT(spdk_nvme_opc_get_data_transfer(req.cmd.opc) == SPDK_NVME_DATA_NONE);
+	CU_ASSERT(req.cmd.cdw11 == 3);
+}
+
+static void
+test_nvme_kv_list(void)
+{
+	struct spdk_nvme_ns ns = { .id = 1 };
+	struct spdk_nvme_qpair qpair;
+	struct nvme_request req;
+	const char *key = "k";
+	char keys[4096];
+	int rc;
+
+	ut_init_qpair(&qpair, &req);
+
+	rc = spdk_nvme_kv_list(&ns, &qpair, key, 1, keys, sizeof(keys), NULL, NULL);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(g_request == &req);
+	CU_ASSERT(req.cmd.opc == SPDK_NVME_OPC_KV_LIST);
+	CU_ASSERT(spdk_nvme_opc_get_data_transfer(req.cmd.opc) == SPDK_NVME_DATA_CONTROLLER_TO_HOST);
+	CU_ASSERT(req.cmd.cdw10 == sizeof(keys));
+	CU_ASSERT(req.cmd.cdw11 == 1);
+	CU_ASSERT(req.payload.contig_or_cb_arg == keys);
+}
+
+static void
+test_nvme_kv_invalid_key(void)
+{
+	struct spdk_nvme_ns ns = { .id = 1 };
+	struct spdk_nvme_qpair qpair;
+	struct nvme_request req;
+	const char key[SPDK_NVME_KV_KEY_MAX_LEN + 1] = {};
+	int rc;
+
+	ut_init_qpair(&qpair, &req);
+
+	rc = spdk_nvme_kv_exist(&ns, &qpair, key, 0, NULL, NULL);
+	CU_ASSERT(rc == -EINVAL);
+
+	rc = spdk_nvme_kv_exist(&ns, &qpair, key, sizeof(key), NULL, NULL);
+	CU_ASSERT(rc == -EINVAL);
+
+	rc = spdk_nvme_kv_exist(&ns, &qpair, NULL, 1, NULL, NULL);
+	CU_ASSERT(rc == -EINVAL);
+
+	CU_ASSERT(g_request == NULL);
+	CU_ASSERT(STAILQ_FIRST(&qpair.free_req) == &req);
+
+	/* No request is available. */
+	STAILQ_INIT(&qpair.free_req);
+
+	rc = spdk_nvme_kv_exist(&ns, &qpair, key, 1, NULL, NULL);
+	CU_ASSERT(rc == -ENOMEM);
+}
+
+static void
+test_nvme_kv_ns_get_data(void)
+{
+	struct spdk_nvme_ns ns = {};
+	struct spdk_nvme_kv_ns_data nsdata_kv = {};
+
+	CU_ASSERT(spdk_nvme_kv_ns_get_data(&ns) == NULL);
+
+	nsdata_kv.kvf[0].kvkml = 16;
+	nsdata_kv.kvf[0].kvvml = 1024 * 1024;
+	ns.nsdata_kv = &nsdata_kv;
+
+	CU_ASSERT(spdk_nvme_kv_ns_get_data(&ns) == &nsdata_kv);
+	CU_ASSERT(spdk_nvme_kv_ns_get_max_key_len(&ns) == 16);
+	CU_ASSERT(spdk_nvme_kv_ns_get_max_value_len(&ns) == 1024 * 1024);
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("nvme_kv", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_nvme_kv_store);
+	CU_ADD_TEST(suite, test_nvme_kv_retrieve);
+	CU_ADD_TEST(suite, test_nvme_kv_no_data);
+	CU_ADD_TEST(suite, test_nvme_kv_list);
+	CU_ADD_TEST(suite, test_nvme_kv_invalid_key);
+	CU_ADD_TEST(suite, test_nvme_kv_ns_get_data);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+	return num_failures;
+}
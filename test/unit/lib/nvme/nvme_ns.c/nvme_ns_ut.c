@@ -19,6 +19,38 @@ DEFINE_STUB(nvme_wait_for_completion_robust_lock, int,
 	     pthread_mutex_t *robust_mutex), 0);
 DEFINE_STUB(nvme_ctrlr_multi_iocs_enabled, bool, (struct spdk_nvme_ctrlr *ctrlr), true);
 
+static uint16_t g_ut_nruhsd;
+static uint32_t g_ut_io_mgmt_recv_count;
+static uint16_t g_ut_io_mgmt_recv_sct = SPDK_NVME_SCT_GENERIC;
+static uint16_t g_ut_io_mgmt_recv_sc = SPDK_NVME_SC_SUCCESS;
+
+int
+spdk_nvme_ns_cmd_io_mgmt_recv(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
+			      void *payload, uint32_t len, uint8_t mo, uint16_t mos,
+			      spdk_nvme_cmd_cb cb_fn, void *cb_arg)
+{
+	struct spdk_nvme_fdp_ruhs *ruhs = payload;
+	struct spdk_nvme_cpl cpl = {};
+	uint16_t i;
+
+	CU_ASSERT(mo == SPDK_NVME_FDP_IO_MGMT_RECV_RUHS);
+	SPDK_CU_ASSERT_FATAL(len >= sizeof(*ruhs));
+
+	g_ut_io_mgmt_recv_count++;
+
+	ruhs->nruhsd = g_ut_nruhsd;
+	for (i = 0; i < g_ut_nruhsd && sizeof(*ruhs) + (i + 1) * sizeof(ruhs->ruhs_desc[0]) <= len; i++) {
+		ruhs->ruhs_desc[i].pid = 0x100 + i;
+	}
+
+	/* Complete inline, the completion callback may submit the next command */
+	cpl.status.sct = g_ut_io_mgmt_recv_sct;
+	cpl.status.sc = g_ut_io_mgmt_recv_sc;
+	cb_fn(cb_arg, &cpl);
+
+	return 0;
+}
+
 static struct spdk_nvme_cpl fake_cpl = {};
 static enum spdk_nvme_generic_command_status_code set_status_code = SPDK_NVME_SC_SUCCESS;
 
@@ -34,6 +66,10 @@ static struct spdk_nvme_zns_ns_data nsdata_zns = {
 	.mar = 1024,
 	.mor = 1024,
 };
+static struct spdk_nvme_kv_ns_data nsdata_kv = {
+	.nkvf = 1,
+	.kvf[0] = { .kvkml = 16, .kvvml = 4096 },
+};
 
 struct spdk_nvme_cmd g_ut_cmd = {};
 
@@ -53,10 +89,14 @@ nvme_ctrlr_cmd_identify(struct spdk_nvme_ctrlr *ctrlr, uint8_t cns, uint16_t cnt
 		}
 		fake_cpl_sc(cb_fn, cb_arg);
 		return 0;
-	} else if (cns == SPDK_NVME_IDENTIFY_NS_IOCS) {
+	} else if (cns == SPDK_NVME_IDENTIFY_NS_IOCS && csi == SPDK_NVME_CSI_ZNS) {
 		assert(payload_size == sizeof(struct spdk_nvme_zns_ns_data));
 		memcpy(payload, &nsdata_zns, sizeof(struct spdk_nvme_zns_ns_data));
 		return 0;
+	} else if (cns == SPDK_NVME_IDENTIFY_NS_IOCS && csi == SPDK_NVME_CSI_KV) {
+		assert(payload_size == sizeof(struct spdk_nvme_kv_ns_data));
+		memcpy(payload, &nsdata_kv, sizeof(struct spdk_nvme_kv_ns_data));
+		return 0;
 	} else if (cns == SPDK_NVME_IDENTIFY_NS_ID_DESCRIPTOR_LIST) {
 		g_ut_cmd.cdw10_bits.identify.cns = cns;
 		g_ut_cmd.cdw10_bits.identify.cntid = cntid;
@@ -408,8 +448,11 @@ test_nvme_ns_has_supported_iocs_specific_data(void)
 	/* case 2: ns.csi == SPDK_NVME_CSI_ZNS. Expect: true */
 	ns.csi = SPDK_NVME_CSI_ZNS;
 	CU_ASSERT(nvme_ns_has_supported_iocs_specific_data(&ns) == true);
-	/* case 3: default ns.csi == SPDK_NVME_CSI_KV. Expect: false */
+	/* case 3: ns.csi == SPDK_NVME_CSI_KV. Expect: true */
 	ns.csi = SPDK_NVME_CSI_KV;
+	CU_ASSERT(nvme_ns_has_supported_iocs_specific_data(&ns) == true);
+	/* case 4: default ns.csi == 0xff. Expect: false */
+	ns.csi = 0xff;
 	CU_ASSERT(nvme_ns_has_supported_iocs_specific_data(&ns) == false);
 }
 
@@ -434,6 +477,19 @@ test_nvme_ctrlr_identify_ns_iocs_specific(void)
 	/* case 2: Test nvme_ns_free_zns_specific_data. Expect: PASS. */
 	nvme_ns_free_zns_specific_data(&ns);
 	CU_ASSERT(ns.nsdata_zns == NULL);
+
+	/* case 3: Test nvme_ctrlr_identify_ns_iocs_specific for a KV namespace. Expect: PASS. */
+	ns.csi = SPDK_NVME_CSI_KV;
+	rc = nvme_ctrlr_identify_ns_iocs_specific(&ns);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(ns.nsdata_zns == NULL);
+	SPDK_CU_ASSERT_FATAL(ns.nsdata_kv != NULL);
+	CU_ASSERT(ns.nsdata_kv->kvf[0].kvkml == 16);
+	CU_ASSERT(ns.nsdata_kv->kvf[0].kvvml == 4096);
+
+	/* case 4: Test nvme_ns_free_iocs_specific_data. Expect: PASS. */
+	nvme_ns_free_iocs_specific_data(&ns);
+	CU_ASSERT(ns.nsdata_kv == NULL);
 }
 
 static void
@@ -494,6 +550,69 @@ test_nvme_ns_find_id_desc(void)
 	CU_ASSERT(csi == NULL);
 }
 
+static int g_ut_placement_ids_rc;
+static bool g_ut_placement_ids_done;
+
+static void
+ut_placement_ids_cb(void *cb_arg, int rc)
+{
+	g_ut_placement_ids_done = true;
+	g_ut_placement_ids_rc = rc;
+}
+
+static void
+test_spdk_nvme_ns_update_placement_ids(void)
+{
+	struct spdk_nvme_ctrlr ctrlr = {};
+	struct spdk_nvme_qpair qpair = {};
+	struct spdk_nvme_ns ns = {};
+	int rc;
+
+	ns.ctrlr = &ctrlr;
+	ns.id = 1;
+
+	/* Case 1: FDP not supported by the controller */
+	rc = spdk_nvme_ns_update_placement_ids(&ns, &qpair, ut_placement_ids_cb, NULL);
+	CU_ASSERT(rc == -ENOTSUP);
+	CU_ASSERT(g_ut_placement_ids_done == false);
+	CU_ASSERT(spdk_nvme_ns_get_num_placement_ids(&ns) == 0);
+
+	/* Case 2: four reclaim unit handles, read by a header and then a full command */
+	ctrlr.cdata.ctratt.fdps = 1;
+	g_ut_nruhsd = 4;
+	g_ut_io_mgmt_recv_count = 0;
+	rc = spdk_nvme_ns_update_placement_ids(&ns, &qpair, ut_placement_ids_cb, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_ut_placement_ids_done == true);
+	CU_ASSERT(g_ut_placement_ids_rc == 0);
+	CU_ASSERT(g_ut_io_mgmt_recv_count == 2);
+	CU_ASSERT(spdk_nvme_ns_get_num_placement_ids(&ns) == 4);
+	CU_ASSERT(spdk_nvme_ns_get_placement_id(&ns, 0) == 0x100);
+	CU_ASSERT(spdk_nvme_ns_get_placement_id(&ns, 3) == 0x103);
+
+	/* Case 3: the command fails, the previous placement ids are kept */
+	g_ut_placement_ids_done = false;
+	g_ut_io_mgmt_recv_sc = SPDK_NVME_SC_INVALID_FIELD;
+	rc = spdk_nvme_ns_update_placement_ids(&ns, &qpair, ut_placement_ids_cb, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_ut_placement_ids_done == true);
+	CU_ASSERT(g_ut_placement_ids_rc == -EIO);
+	CU_ASSERT(spdk_nvme_ns_get_num_placement_ids(&ns) == 4);
+	g_ut_io_mgmt_recv_sc = SPDK_NVME_SC_SUCCESS;
+
+	/* Case 4: no reclaim unit handle */
+	g_ut_placement_ids_done = false;
+	g_ut_nruhsd = 0;
+	g_ut_io_mgmt_recv_count = 0;
+	rc = spdk_nvme_ns_update_placement_ids(&ns, &qpair, ut_placement_ids_cb, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_ut_placement_ids_done == true);
+	CU_ASSERT(g_ut_placement_ids_rc == 0);
+	CU_ASSERT(g_ut_io_mgmt_recv_count == 1);
+	CU_ASSERT(spdk_nvme_ns_get_num_placement_ids(&ns) == 0);
+	CU_ASSERT(ns.fdp_pids == NULL);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -516,6 +635,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_nvme_ctrlr_identify_ns_iocs_specific);
 	CU_ADD_TEST(suite, test_nvme_ctrlr_identify_id_desc);
 	CU_ADD_TEST(suite, test_nvme_ns_find_id_desc);
+	CU_ADD_TEST(suite, test_spdk_nvme_ns_update_placement_ids);
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
 	CU_cleanup_registry();
@@ -41,7 +41,16 @@ DEFINE_STUB(spdk_pci_device_cfg_write16, int, (struct spdk_pci_device *dev, uint
 		uint32_t offset), 0);
 DEFINE_STUB(spdk_pci_device_cfg_read16, int, (struct spdk_pci_device *dev, uint16_t *value,
 		uint32_t offset), 0);
+DEFINE_STUB(spdk_pci_device_cfg_read8, int, (struct spdk_pci_device *dev, uint8_t *value,
+		uint32_t offset), 0);
+DEFINE_STUB(spdk_pci_device_enable_interrupts, int, (struct spdk_pci_device *dev,
+		uint32_t efd_count), 0);
+DEFINE_STUB(spdk_pci_device_disable_interrupts, int, (struct spdk_pci_device *dev), 0);
+DEFINE_STUB(spdk_pci_device_get_interrupt_efd_by_index, int, (struct spdk_pci_device *dev,
+		uint32_t index), -1);
+DEFINE_STUB_V(nvme_poll_group_kick, (struct spdk_nvme_poll_group *group));
 DEFINE_STUB(spdk_pci_device_get_id, struct spdk_pci_id, (struct spdk_pci_device *dev), {0});
+DEFINE_STUB(spdk_pci_device_get_socket_id, int, (struct spdk_pci_device *dev), SPDK_ENV_SOCKET_ID_ANY);
 DEFINE_STUB(spdk_pci_event_listen, int, (void), 0);
 DEFINE_STUB(spdk_pci_register_error_handler, int, (spdk_pci_error_handler sighandler, void *ctx),
 	    0);
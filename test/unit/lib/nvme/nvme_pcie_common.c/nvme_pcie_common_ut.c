@@ -37,6 +37,8 @@ DEFINE_STUB_V(spdk_nvme_qpair_print_completion, (struct spdk_nvme_qpair *qpair,
 
 DEFINE_STUB_V(nvme_qpair_deinit, (struct spdk_nvme_qpair *qpair));
 
+DEFINE_STUB_V(nvme_poll_group_kick, (struct spdk_nvme_poll_group *group));
+
 DEFINE_STUB(nvme_ctrlr_get_current_process, struct spdk_nvme_ctrlr_process *,
 	    (struct spdk_nvme_ctrlr *ctrlr), NULL);
 
@@ -220,34 +222,35 @@ test_nvme_pcie_qpair_construct_destroy(void)
 static void
 test_nvme_pcie_ctrlr_cmd_create_delete_io_queue(void)
 {
-	struct spdk_nvme_ctrlr ctrlr = {};
+	struct nvme_pcie_ctrlr pctrlr = {};
+	struct spdk_nvme_ctrlr *ctrlr = &pctrlr.ctrlr;
 	struct nvme_pcie_qpair pqpair = {};
 	struct spdk_nvme_qpair adminq = {};
 	struct nvme_request req = {};
 	int rc;
 
-	ctrlr.adminq = &adminq;
-	STAILQ_INIT(&ctrlr.adminq->free_req);
-	STAILQ_INSERT_HEAD(&ctrlr.adminq->free_req, &req, stailq);
+	ctrlr->adminq = &adminq;
+	STAILQ_INIT(&ctrlr->adminq->free_req);
+	STAILQ_INSERT_HEAD(&ctrlr->adminq->free_req, &req, stailq);
 	pqpair.qpair.id = 1;
 	pqpair.num_entries = 1;
 	pqpair.cpl_bus_addr = 0xDEADBEEF;
 	pqpair.cmd_bus_addr = 0xDDADBEEF;
 	pqpair.qpair.qprio = SPDK_NVME_QPRIO_HIGH;
 
-	rc = nvme_pcie_ctrlr_cmd_create_io_cq(&ctrlr, &pqpair.qpair, NULL, NULL);
+	rc = nvme_pcie_ctrlr_cmd_create_io_cq(ctrlr, &pqpair.qpair, NULL, NULL);
 	CU_ASSERT(rc == 0);
 	CU_ASSERT(req.cmd.opc == SPDK_NVME_OPC_CREATE_IO_CQ);
 	CU_ASSERT(req.cmd.cdw10_bits.create_io_q.qid == 1);
 	CU_ASSERT(req.cmd.cdw10_bits.create_io_q.qsize == 0);
 	CU_ASSERT(req.cmd.cdw11_bits.create_io_cq.pc == 1);
 	CU_ASSERT(req.cmd.dptr.prp.prp1 == 0xDEADBEEF);
-	CU_ASSERT(STAILQ_EMPTY(&ctrlr.adminq->free_req));
+	CU_ASSERT(STAILQ_EMPTY(&ctrlr->adminq->free_req));
 
 	memset(&req, 0, sizeof(req));
-	STAILQ_INSERT_HEAD(&ctrlr.adminq->free_req, &req, stailq);
+	STAILQ_INSERT_HEAD(&ctrlr->adminq->free_req, &req, stailq);
 
-	rc = nvme_pcie_ctrlr_cmd_create_io_sq(&ctrlr, &pqpair.qpair, NULL, NULL);
+	rc = nvme_pcie_ctrlr_cmd_create_io_sq(ctrlr, &pqpair.qpair, NULL, NULL);
 	CU_ASSERT(rc == 0);
 	CU_ASSERT(req.cmd.opc == SPDK_NVME_OPC_CREATE_IO_SQ);
 	CU_ASSERT(req.cmd.cdw10_bits.create_io_q.qid == 1);
@@ -256,39 +259,39 @@ test_nvme_pcie_ctrlr_cmd_create_delete_io_queue(void)
 	CU_ASSERT(req.cmd.cdw11_bits.create_io_sq.qprio == SPDK_NVME_QPRIO_HIGH);
 	CU_ASSERT(req.cmd.cdw11_bits.create_io_sq.cqid = 1);
 	CU_ASSERT(req.cmd.dptr.prp.prp1 == 0xDDADBEEF);
-	CU_ASSERT(STAILQ_EMPTY(&ctrlr.adminq->free_req));
+	CU_ASSERT(STAILQ_EMPTY(&ctrlr->adminq->free_req));
 
 	/* No free request available */
-	rc = nvme_pcie_ctrlr_cmd_create_io_cq(&ctrlr, &pqpair.qpair, NULL, NULL);
+	rc = nvme_pcie_ctrlr_cmd_create_io_cq(ctrlr, &pqpair.qpair, NULL, NULL);
 	CU_ASSERT(rc == -ENOMEM);
 
-	rc = nvme_pcie_ctrlr_cmd_create_io_sq(&ctrlr, &pqpair.qpair, NULL, NULL);
+	rc = nvme_pcie_ctrlr_cmd_create_io_sq(ctrlr, &pqpair.qpair, NULL, NULL);
 	CU_ASSERT(rc == -ENOMEM);
 
 	/* Delete cq or sq */
 	memset(&req, 0, sizeof(req));
-	STAILQ_INSERT_HEAD(&ctrlr.adminq->free_req, &req, stailq);
+	STAILQ_INSERT_HEAD(&ctrlr->adminq->free_req, &req, stailq);
 
-	rc = nvme_pcie_ctrlr_cmd_delete_io_cq(&ctrlr, &pqpair.qpair, NULL, NULL);
+	rc = nvme_pcie_ctrlr_cmd_delete_io_cq(ctrlr, &pqpair.qpair, NULL, NULL);
 	CU_ASSERT(rc == 0);
 	CU_ASSERT(req.cmd.opc == SPDK_NVME_OPC_DELETE_IO_CQ);
 	CU_ASSERT(req.cmd.cdw10_bits.delete_io_q.qid == 1);
-	CU_ASSERT(STAILQ_EMPTY(&ctrlr.adminq->free_req));
+	CU_ASSERT(STAILQ_EMPTY(&ctrlr->adminq->free_req));
 
 	memset(&req, 0, sizeof(req));
-	STAILQ_INSERT_HEAD(&ctrlr.adminq->free_req, &req, stailq);
+	STAILQ_INSERT_HEAD(&ctrlr->adminq->free_req, &req, stailq);
 
-	rc = nvme_pcie_ctrlr_cmd_delete_io_sq(&ctrlr, &pqpair.qpair, NULL, NULL);
+	rc = nvme_pcie_ctrlr_cmd_delete_io_sq(ctrlr, &pqpair.qpair, NULL, NULL);
 	CU_ASSERT(rc == 0);
 	CU_ASSERT(req.cmd.opc == SPDK_NVME_OPC_DELETE_IO_SQ);
 	CU_ASSERT(req.cmd.cdw10_bits.delete_io_q.qid == 1);
-	CU_ASSERT(STAILQ_EMPTY(&ctrlr.adminq->free_req));
+	CU_ASSERT(STAILQ_EMPTY(&ctrlr->adminq->free_req));
 
 	/* No free request available */
-	rc = nvme_pcie_ctrlr_cmd_delete_io_cq(&ctrlr, &pqpair.qpair, NULL, NULL);
+	rc = nvme_pcie_ctrlr_cmd_delete_io_cq(ctrlr, &pqpair.qpair, NULL, NULL);
 	CU_ASSERT(rc == -ENOMEM);
 
-	rc = nvme_pcie_ctrlr_cmd_delete_io_sq(&ctrlr, &pqpair.qpair, NULL, NULL);
+	rc = nvme_pcie_ctrlr_cmd_delete_io_sq(ctrlr, &pqpair.qpair, NULL, NULL);
 	CU_ASSERT(rc == -ENOMEM);
 }
 
@@ -579,6 +582,61 @@ test_nvme_pcie_poll_group_get_stats(void)
 	CU_ASSERT(rc == 0);
 }
 
+static void
+test_nvme_pcie_poll_group_submit_batch(void)
+{
+	struct spdk_nvme_poll_group group = {};
+	struct spdk_nvme_transport_poll_group *tgroup;
+	struct nvme_pcie_ctrlr pctrlr = {};
+	struct nvme_pcie_qpair pqpair = {};
+	struct spdk_nvme_pcie_stat stat = {};
+	struct spdk_nvme_cmd cmd[4] __attribute__((aligned(64))) = {};
+	struct nvme_request req __attribute__((aligned(64))) = {};
+	struct nvme_tracker tr = {};
+	uint32_t sq_tdbl = 0;
+
+	tgroup = nvme_pcie_poll_group_create();
+	SPDK_CU_ASSERT_FATAL(tgroup != NULL);
+	tgroup->group = &group;
+	STAILQ_INIT(&tgroup->connected_qpairs);
+	STAILQ_INIT(&tgroup->disconnected_qpairs);
+
+	pqpair.qpair.ctrlr = &pctrlr.ctrlr;
+	pqpair.qpair.poll_group = tgroup;
+	pqpair.cmd = cmd;
+	pqpair.num_entries = 4;
+	pqpair.sq_tdbl = &sq_tdbl;
+	pqpair.stat = &stat;
+	tr.req = &req;
+	STAILQ_INSERT_TAIL(&tgroup->connected_qpairs, &pqpair.qpair, poll_group_stailq);
+
+	/* Outside of a batch, the doorbell is rung for each command */
+	nvme_pcie_qpair_submit_tracker(&pqpair.qpair, &tr);
+	CU_ASSERT(sq_tdbl == 1);
+	CU_ASSERT(pqpair.last_sq_tail == 1);
+	CU_ASSERT(stat.sq_mmio_doorbell_updates == 1);
+
+	/* Within a batch, it is rung once when the batch ends */
+	group.in_submit_batch = true;
+	nvme_pcie_qpair_submit_tracker(&pqpair.qpair, &tr);
+	nvme_pcie_qpair_submit_tracker(&pqpair.qpair, &tr);
+	CU_ASSERT(sq_tdbl == 1);
+	CU_ASSERT(stat.sq_mmio_doorbell_updates == 1);
+
+	group.in_submit_batch = false;
+	nvme_pcie_poll_group_submit_batch_end(tgroup);
+	CU_ASSERT(sq_tdbl == 3);
+	CU_ASSERT(pqpair.last_sq_tail == 3);
+	CU_ASSERT(stat.sq_mmio_doorbell_updates == 2);
+
+	/* Nothing new to submit, the doorbell isn't rung */
+	nvme_pcie_poll_group_submit_batch_end(tgroup);
+	CU_ASSERT(stat.sq_mmio_doorbell_updates == 2);
+
+	STAILQ_REMOVE(&tgroup->connected_qpairs, &pqpair.qpair, spdk_nvme_qpair, poll_group_stailq);
+	CU_ASSERT(nvme_pcie_poll_group_destroy(tgroup) == 0);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -594,6 +652,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_nvme_pcie_ctrlr_connect_qpair);
 	CU_ADD_TEST(suite, test_nvme_pcie_ctrlr_construct_admin_qpair);
 	CU_ADD_TEST(suite, test_nvme_pcie_poll_group_get_stats);
+	CU_ADD_TEST(suite, test_nvme_pcie_poll_group_submit_batch);
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
 	CU_cleanup_registry();
@@ -34,6 +34,10 @@ struct spdk_nvme_transport t4 = {
 
 int64_t g_process_completions_return_value = 0;
 int g_destroy_return_value = 0;
+int g_qpair_fd = -1;
+int g_submit_batch_end_count = 0;
+struct spdk_nvme_ctrlr g_ctrlr = {};
+pid_t g_spdk_nvme_pid;
 
 TAILQ_HEAD(nvme_transport_list, spdk_nvme_transport) g_spdk_nvme_transports =
 	TAILQ_HEAD_INITIALIZER(g_spdk_nvme_transports);
@@ -59,6 +63,12 @@ nvme_transport_poll_group_get_stats(struct spdk_nvme_transport_poll_group *tgrou
 	return 0;
 }
 
+int
+nvme_transport_qpair_get_fd(struct spdk_nvme_qpair *qpair)
+{
+	return g_qpair_fd;
+}
+
 void
 nvme_transport_poll_group_free_stats(struct spdk_nvme_transport_poll_group *tgroup,
 				     struct spdk_nvme_transport_poll_group_stat *stats)
@@ -96,6 +106,7 @@ nvme_transport_poll_group_disconnect_qpair(struct spdk_nvme_qpair *qpair)
 		if (qpair == iter_qp) {
 			STAILQ_REMOVE(&tgroup->connected_qpairs, qpair, spdk_nvme_qpair, poll_group_stailq);
 			STAILQ_INSERT_TAIL(&tgroup->disconnected_qpairs, qpair, poll_group_stailq);
+			qpair->poll_group_tailq_head = &tgroup->disconnected_qpairs;
 			return 0;
 		}
 	}
@@ -121,12 +132,14 @@ nvme_transport_poll_group_connect_qpair(struct spdk_nvme_qpair *qpair)
 		if (qpair == iter_qp) {
 			STAILQ_REMOVE(&tgroup->disconnected_qpairs, qpair, spdk_nvme_qpair, poll_group_stailq);
 			STAILQ_INSERT_TAIL(&tgroup->connected_qpairs, qpair, poll_group_stailq);
+			qpair->poll_group_tailq_head = &tgroup->connected_qpairs;
 			return 0;
 		}
 	}
 
 	STAILQ_FOREACH(iter_qp, &tgroup->connected_qpairs, poll_group_stailq) {
 		if (qpair == iter_qp) {
+			qpair->poll_group_tailq_head = &tgroup->connected_qpairs;
 			return 0;
 		}
 	}
@@ -196,6 +209,14 @@ nvme_transport_poll_group_process_completions(struct spdk_nvme_transport_poll_gr
 	return g_process_completions_return_value;
 }
 
+void
+nvme_transport_poll_group_submit_batch_end(struct spdk_nvme_transport_poll_group *tgroup)
+{
+	/* The batch is closed before the transports flush their queues */
+	CU_ASSERT(tgroup->group->in_submit_batch == false);
+	g_submit_batch_end_count++;
+}
+
 static void
 test_spdk_nvme_poll_group_create(void)
 {
@@ -236,12 +257,12 @@ test_spdk_nvme_poll_group_add_remove(void)
 						       *tgroup_2 = NULL,
 							*tgroup_4 = NULL;
 	struct spdk_nvme_qpair *qpair;
-	struct spdk_nvme_qpair qpair1_1 = {0};
-	struct spdk_nvme_qpair qpair1_2 = {0};
-	struct spdk_nvme_qpair qpair2_1 = {0};
-	struct spdk_nvme_qpair qpair2_2 = {0};
-	struct spdk_nvme_qpair qpair4_1 = {0};
-	struct spdk_nvme_qpair qpair4_2 = {0};
+	struct spdk_nvme_qpair qpair1_1 = {.ctrlr = &g_ctrlr};
+	struct spdk_nvme_qpair qpair1_2 = {.ctrlr = &g_ctrlr};
+	struct spdk_nvme_qpair qpair2_1 = {.ctrlr = &g_ctrlr};
+	struct spdk_nvme_qpair qpair2_2 = {.ctrlr = &g_ctrlr};
+	struct spdk_nvme_qpair qpair4_1 = {.ctrlr = &g_ctrlr};
+	struct spdk_nvme_qpair qpair4_2 = {.ctrlr = &g_ctrlr};
 	int i = 0;
 
 	TAILQ_INSERT_TAIL(&g_spdk_nvme_transports, &t1, link);
@@ -374,7 +395,7 @@ test_spdk_nvme_poll_group_process_completions(void)
 {
 	struct spdk_nvme_poll_group *group;
 	struct spdk_nvme_transport_poll_group *tgroup, *tmp_tgroup;
-	struct spdk_nvme_qpair qpair1_1 = {0};
+	struct spdk_nvme_qpair qpair1_1 = {.ctrlr = &g_ctrlr};
 
 	group = spdk_nvme_poll_group_create(NULL, NULL);
 	SPDK_CU_ASSERT_FATAL(group != NULL);
@@ -417,7 +438,7 @@ test_spdk_nvme_poll_group_destroy(void)
 {
 	struct spdk_nvme_poll_group *group;
 	struct spdk_nvme_transport_poll_group *tgroup, *tgroup_1, *tgroup_2;
-	struct spdk_nvme_qpair qpair1_1 = {0};
+	struct spdk_nvme_qpair qpair1_1 = {.ctrlr = &g_ctrlr};
 	int num_tgroups = 0;
 
 	/* Simple destruction of empty poll group. */
@@ -480,6 +501,304 @@ test_spdk_nvme_poll_group_get_free_stats(void)
 	CU_ASSERT(rc == -ENOTSUP);
 }
 
+static void
+test_spdk_nvme_poll_group_interrupt(void)
+{
+	struct spdk_nvme_poll_group *group;
+	struct spdk_nvme_transport_poll_group *tgroup, *tmp_tgroup;
+	struct spdk_nvme_ctrlr intr_ctrlr = {};
+	struct spdk_nvme_qpair qpair1 = {.ctrlr = &g_ctrlr};
+	struct spdk_nvme_qpair qpair2 = {.ctrlr = &intr_ctrlr};
+	uint64_t notify = 1;
+	int fd;
+
+	intr_ctrlr.opts.enable_interrupts = true;
+	TAILQ_INSERT_TAIL(&g_spdk_nvme_transports, &t1, link);
+
+	/* A poll group holding qpairs can't be switched to interrupt mode anymore */
+	group = spdk_nvme_poll_group_create(NULL, NULL);
+	SPDK_CU_ASSERT_FATAL(group != NULL);
+	qpair1.state = NVME_QPAIR_DISCONNECTED;
+	qpair1.transport = &t1;
+	CU_ASSERT(spdk_nvme_poll_group_add(group, &qpair1) == 0);
+	CU_ASSERT(spdk_nvme_poll_group_get_fd(group) == -EINVAL);
+	CU_ASSERT(spdk_nvme_poll_group_wait(group, unit_test_disconnected_qpair_cb) == -EINVAL);
+	/* Qpairs with interrupts are simply polled by such a poll group */
+	qpair2.state = NVME_QPAIR_DISCONNECTED;
+	qpair2.transport = &t1;
+	CU_ASSERT(spdk_nvme_poll_group_add(group, &qpair2) == 0);
+	CU_ASSERT(spdk_nvme_poll_group_remove(group, &qpair2) == 0);
+	CU_ASSERT(spdk_nvme_poll_group_remove(group, &qpair1) == 0);
+	STAILQ_FOREACH_SAFE(tgroup, &group->tgroups, link, tmp_tgroup) {
+		STAILQ_REMOVE(&group->tgroups, tgroup, spdk_nvme_transport_poll_group, link);
+		free(tgroup);
+	}
+	SPDK_CU_ASSERT_FATAL(spdk_nvme_poll_group_destroy(group) == 0);
+
+	/* Interrupt mode poll group */
+	group = spdk_nvme_poll_group_create(NULL, NULL);
+	SPDK_CU_ASSERT_FATAL(group != NULL);
+	fd = spdk_nvme_poll_group_get_fd(group);
+	CU_ASSERT(fd >= 0);
+	CU_ASSERT(spdk_nvme_poll_group_get_fd(group) == fd);
+	CU_ASSERT(spdk_nvme_poll_group_add(group, &qpair2) == 0);
+
+	/* The fd of the qpair is added once it gets connected */
+	g_qpair_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	SPDK_CU_ASSERT_FATAL(g_qpair_fd >= 0);
+	qpair2.state = NVME_QPAIR_CONNECTED;
+	CU_ASSERT(nvme_poll_group_connect_qpair(&qpair2) == 0);
+	CU_ASSERT(nvme_poll_group_connect_qpair(&qpair2) == 0);
+	/* Connecting kicks the poll group so that the qpair gets polled right away */
+	CU_ASSERT(group->event_pending == true);
+	g_process_completions_return_value = 4;
+	CU_ASSERT(spdk_nvme_poll_group_wait(group, unit_test_disconnected_qpair_cb) == 4);
+	CU_ASSERT(group->event_pending == false);
+
+	/* Events on the qpair fd are dispatched */
+	CU_ASSERT(write(g_qpair_fd, &notify, sizeof(notify)) == sizeof(notify));
+	CU_ASSERT(spdk_fd_group_wait(group->fgrp, 0) == 1);
+	CU_ASSERT(read(g_qpair_fd, &notify, sizeof(notify)) == sizeof(notify));
+
+	/* The kicks are coalesced until the poll group processes them */
+	nvme_poll_group_kick(group);
+	nvme_poll_group_kick(group);
+	CU_ASSERT(spdk_fd_group_wait(group->fgrp, 0) == 1);
+	CU_ASSERT(group->event_pending == false);
+	CU_ASSERT(spdk_fd_group_wait(group->fgrp, 0) == 0);
+
+	/* Disconnecting removes the qpair fd and kicks the poll group to report it */
+	qpair2.state = NVME_QPAIR_DISCONNECTED;
+	CU_ASSERT(nvme_poll_group_disconnect_qpair(&qpair2) == 0);
+	CU_ASSERT(group->event_pending == true);
+	CU_ASSERT(write(g_qpair_fd, &notify, sizeof(notify)) == sizeof(notify));
+	CU_ASSERT(spdk_fd_group_wait(group->fgrp, 0) == 1);
+	CU_ASSERT(spdk_fd_group_wait(group->fgrp, 0) == 0);
+
+	CU_ASSERT(spdk_nvme_poll_group_remove(group, &qpair2) == 0);
+	STAILQ_FOREACH_SAFE(tgroup, &group->tgroups, link, tmp_tgroup) {
+		STAILQ_REMOVE(&group->tgroups, tgroup, spdk_nvme_transport_poll_group, link);
+		free(tgroup);
+	}
+	SPDK_CU_ASSERT_FATAL(spdk_nvme_poll_group_destroy(group) == 0);
+
+	close(g_qpair_fd);
+	g_qpair_fd = -1;
+	g_process_completions_return_value = 0;
+	TAILQ_REMOVE(&g_spdk_nvme_transports, &t1, link);
+}
+
+static void
+test_spdk_nvme_poll_group_interrupt_no_fd(void)
+{
+	struct spdk_nvme_poll_group *group;
+	struct spdk_nvme_transport_poll_group *tgroup, *tmp_tgroup;
+	struct spdk_nvme_ctrlr intr_ctrlr = {};
+	struct spdk_nvme_qpair qpair1 = {.ctrlr = &g_ctrlr};
+	struct spdk_nvme_qpair qpair2 = {.ctrlr = &intr_ctrlr};
+	int fd;
+
+	intr_ctrlr.opts.enable_interrupts = true;
+	TAILQ_INSERT_TAIL(&g_spdk_nvme_transports, &t1, link);
+
+	group = spdk_nvme_poll_group_create(NULL, NULL);
+	SPDK_CU_ASSERT_FATAL(group != NULL);
+	fd = spdk_nvme_poll_group_get_fd(group);
+	CU_ASSERT(fd >= 0);
+
+	/* Qpairs of controllers without interrupts, and qpairs the transport has no fd for,
+	 * still connect to a poll group in interrupt mode.
+	 */
+	qpair1.state = NVME_QPAIR_DISCONNECTED;
+	qpair1.transport = &t1;
+	qpair2.state = NVME_QPAIR_DISCONNECTED;
+	qpair2.transport = &t1;
+	CU_ASSERT(spdk_nvme_poll_group_add(group, &qpair1) == 0);
+	CU_ASSERT(spdk_nvme_poll_group_add(group, &qpair2) == 0);
+	g_qpair_fd = -ENOTSUP;
+	qpair1.state = NVME_QPAIR_CONNECTED;
+	CU_ASSERT(nvme_poll_group_connect_qpair(&qpair1) == 0);
+	CU_ASSERT(qpair1.no_intr_fd == 1);
+	qpair2.state = NVME_QPAIR_CONNECTED;
+	CU_ASSERT(nvme_poll_group_connect_qpair(&qpair2) == 0);
+	CU_ASSERT(qpair2.no_intr_fd == 1);
+	CU_ASSERT(qpair2.poll_group_tailq_head == &qpair2.poll_group->connected_qpairs);
+	CU_ASSERT(group->event_pending == true);
+
+	/* The poll group keeps waking itself up to poll them */
+	CU_ASSERT(spdk_nvme_poll_group_wait(group, unit_test_disconnected_qpair_cb) == 0);
+	CU_ASSERT(group->event_pending == true);
+	CU_ASSERT(spdk_fd_group_wait(group->fgrp, 0) == 1);
+	CU_ASSERT(spdk_nvme_poll_group_process_completions(group, 0,
+			unit_test_disconnected_qpair_cb) == 0);
+	CU_ASSERT(group->event_pending == true);
+
+	/* Until they're disconnected */
+	qpair1.state = NVME_QPAIR_DISCONNECTED;
+	CU_ASSERT(nvme_poll_group_disconnect_qpair(&qpair1) == 0);
+	CU_ASSERT(qpair1.no_intr_fd == 0);
+	qpair2.state = NVME_QPAIR_DISCONNECTED;
+	CU_ASSERT(nvme_poll_group_disconnect_qpair(&qpair2) == 0);
+	CU_ASSERT(qpair2.no_intr_fd == 0);
+	CU_ASSERT(spdk_nvme_poll_group_wait(group, unit_test_disconnected_qpair_cb) == 0);
+	CU_ASSERT(group->event_pending == false);
+	CU_ASSERT(spdk_fd_group_wait(group->fgrp, 0) == 0);
+
+	/* Other errors still fail the connection */
+	g_qpair_fd = -EIO;
+	qpair2.state = NVME_QPAIR_CONNECTED;
+	CU_ASSERT(nvme_poll_group_connect_qpair(&qpair2) == -EIO);
+	CU_ASSERT(qpair2.poll_group_tailq_head == &qpair2.poll_group->disconnected_qpairs);
+
+	CU_ASSERT(spdk_nvme_poll_group_remove(group, &qpair1) == 0);
+	CU_ASSERT(spdk_nvme_poll_group_remove(group, &qpair2) == 0);
+	STAILQ_FOREACH_SAFE(tgroup, &group->tgroups, link, tmp_tgroup) {
+		STAILQ_REMOVE(&group->tgroups, tgroup, spdk_nvme_transport_poll_group, link);
+		free(tgroup);
+	}
+	SPDK_CU_ASSERT_FATAL(spdk_nvme_poll_group_destroy(group) == 0);
+
+	g_qpair_fd = -1;
+	TAILQ_REMOVE(&g_spdk_nvme_transports, &t1, link);
+}
+
+static void
+test_spdk_nvme_poll_group_shared_requests(void)
+{
+	struct spdk_nvme_poll_group *group;
+	struct spdk_nvme_transport_poll_group *tgroup;
+	struct spdk_nvme_qpair qpair1_1 = {.ctrlr = &g_ctrlr};
+	struct spdk_nvme_qpair qpair1_2 = {.ctrlr = &g_ctrlr};
+	struct nvme_request own_req = {}, *req1, *req2, *req3;
+	struct nvme_request_pool *pool;
+	struct spdk_nvme_poll_group *other_group;
+
+	TAILQ_INSERT_TAIL(&g_spdk_nvme_transports, &t1, link);
+
+	group = spdk_nvme_poll_group_create(NULL, NULL);
+	SPDK_CU_ASSERT_FATAL(group != NULL);
+
+	CU_ASSERT(spdk_nvme_poll_group_set_shared_requests(group, 0) == -EINVAL);
+	CU_ASSERT(spdk_nvme_poll_group_set_shared_requests(group, 2) == 0);
+	CU_ASSERT(spdk_nvme_poll_group_set_shared_requests(group, 2) == -EBUSY);
+	pool = group->req_pool;
+	SPDK_CU_ASSERT_FATAL(pool != NULL);
+	CU_ASSERT(pool->num_requests == 2);
+
+	/* qpair1_1 has a floor of a single request of its own. */
+	STAILQ_INIT(&qpair1_1.free_req);
+	STAILQ_INSERT_HEAD(&qpair1_1.free_req, &own_req, stailq);
+	own_req.qpair = &qpair1_1;
+	qpair1_1.transport = &t1;
+	CU_ASSERT(spdk_nvme_poll_group_add(group, &qpair1_1) == 0);
+	CU_ASSERT(qpair1_1.req_pool == pool);
+
+	/* The own request is used first, then the shared ones until they run out. */
+	req1 = nvme_allocate_request_null(&qpair1_1, NULL, NULL);
+	CU_ASSERT(req1 == &own_req);
+	CU_ASSERT(!req1->shared);
+	req2 = nvme_allocate_request_null(&qpair1_1, NULL, NULL);
+	SPDK_CU_ASSERT_FATAL(req2 != NULL);
+	CU_ASSERT(req2->shared);
+	CU_ASSERT(req2->qpair == &qpair1_1);
+	req3 = nvme_allocate_request_null(&qpair1_1, NULL, NULL);
+	SPDK_CU_ASSERT_FATAL(req3 != NULL);
+	CU_ASSERT(req3->shared);
+	CU_ASSERT(nvme_allocate_request_null(&qpair1_1, NULL, NULL) == NULL);
+	CU_ASSERT(qpair1_1.num_outstanding_reqs == 3);
+	CU_ASSERT(qpair1_1.num_shared_reqs == 2);
+	CU_ASSERT(pool->num_outstanding_reqs == 2);
+
+	/* Shared requests go back to the pool, own ones to the qpair. */
+	nvme_free_request(req1);
+	nvme_free_request(req2);
+	CU_ASSERT(STAILQ_FIRST(&qpair1_1.free_req) == &own_req);
+	CU_ASSERT(STAILQ_FIRST(&pool->free_req) == req2);
+	CU_ASSERT(qpair1_1.num_outstanding_reqs == 1);
+	CU_ASSERT(qpair1_1.num_shared_reqs == 1);
+	CU_ASSERT(pool->num_outstanding_reqs == 1);
+
+	/* The pool can't be set once the group has qpairs. */
+	CU_ASSERT(spdk_nvme_poll_group_set_shared_requests(group, 2) == -EBUSY);
+
+	/* A removed qpair keeps the pool until it returned its requests. */
+	CU_ASSERT(spdk_nvme_poll_group_remove(group, &qpair1_1) == 0);
+	qpair1_1.poll_group = NULL;
+	CU_ASSERT(qpair1_1.req_pool == pool);
+
+	/* The group can't be destroyed while requests are outstanding. */
+	CU_ASSERT(spdk_nvme_poll_group_destroy(group) == -EBUSY);
+
+	/* The qpair can't be added to another group before returning them. */
+	other_group = spdk_nvme_poll_group_create(NULL, NULL);
+	SPDK_CU_ASSERT_FATAL(other_group != NULL);
+	CU_ASSERT(spdk_nvme_poll_group_add(other_group, &qpair1_1) == -EBUSY);
+
+	nvme_free_request(req3);
+	CU_ASSERT(qpair1_1.num_shared_reqs == 0);
+	CU_ASSERT(qpair1_1.req_pool == NULL);
+	CU_ASSERT(pool->num_outstanding_reqs == 0);
+
+	tgroup = STAILQ_FIRST(&group->tgroups);
+	SPDK_CU_ASSERT_FATAL(spdk_nvme_poll_group_destroy(group) == 0);
+	free(tgroup);
+
+	/* Without a pool, a qpair only uses its own requests. */
+	STAILQ_INIT(&qpair1_2.free_req);
+	qpair1_2.transport = &t1;
+	CU_ASSERT(spdk_nvme_poll_group_add(other_group, &qpair1_2) == 0);
+	CU_ASSERT(qpair1_2.req_pool == NULL);
+	CU_ASSERT(nvme_allocate_request_null(&qpair1_2, NULL, NULL) == NULL);
+	CU_ASSERT(spdk_nvme_poll_group_remove(other_group, &qpair1_2) == 0);
+
+	tgroup = STAILQ_FIRST(&other_group->tgroups);
+	SPDK_CU_ASSERT_FATAL(spdk_nvme_poll_group_destroy(other_group) == 0);
+	free(tgroup);
+
+	TAILQ_REMOVE(&g_spdk_nvme_transports, &t1, link);
+}
+
+static void
+test_spdk_nvme_poll_group_submit_batch(void)
+{
+	struct spdk_nvme_poll_group *group;
+	struct spdk_nvme_transport_poll_group *tgroup, *tmp_tgroup;
+	struct spdk_nvme_qpair qpair1_1 = {.ctrlr = &g_ctrlr};
+	struct spdk_nvme_qpair qpair2_1 = {.ctrlr = &g_ctrlr};
+
+	TAILQ_INSERT_TAIL(&g_spdk_nvme_transports, &t1, link);
+	TAILQ_INSERT_TAIL(&g_spdk_nvme_transports, &t2, link);
+
+	group = spdk_nvme_poll_group_create(NULL, NULL);
+	SPDK_CU_ASSERT_FATAL(group != NULL);
+
+	qpair1_1.state = NVME_QPAIR_DISCONNECTED;
+	qpair1_1.transport = &t1;
+	CU_ASSERT(spdk_nvme_poll_group_add(group, &qpair1_1) == 0);
+	qpair2_1.state = NVME_QPAIR_DISCONNECTED;
+	qpair2_1.transport = &t2;
+	CU_ASSERT(spdk_nvme_poll_group_add(group, &qpair2_1) == 0);
+
+	/* Ending the batch flushes each transport poll group once. */
+	g_submit_batch_end_count = 0;
+	spdk_nvme_poll_group_submit_batch_begin(group);
+	CU_ASSERT(group->in_submit_batch == true);
+	spdk_nvme_poll_group_submit_batch_end(group);
+	CU_ASSERT(group->in_submit_batch == false);
+	CU_ASSERT(g_submit_batch_end_count == 2);
+
+	CU_ASSERT(spdk_nvme_poll_group_remove(group, &qpair1_1) == 0);
+	CU_ASSERT(spdk_nvme_poll_group_remove(group, &qpair2_1) == 0);
+	STAILQ_FOREACH_SAFE(tgroup, &group->tgroups, link, tmp_tgroup) {
+		STAILQ_REMOVE(&group->tgroups, tgroup, spdk_nvme_transport_poll_group, link);
+		free(tgroup);
+	}
+	SPDK_CU_ASSERT_FATAL(spdk_nvme_poll_group_destroy(group) == 0);
+
+	TAILQ_REMOVE(&g_spdk_nvme_transports, &t1, link);
+	TAILQ_REMOVE(&g_spdk_nvme_transports, &t2, link);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -504,7 +823,14 @@ main(int argc, char **argv)
 			    test_spdk_nvme_poll_group_process_completions) == NULL ||
 		CU_add_test(suite, "nvme_poll_group_destroy_test", test_spdk_nvme_poll_group_destroy) == NULL ||
 		CU_add_test(suite, "nvme_poll_group_get_free_stats",
-			    test_spdk_nvme_poll_group_get_free_stats) == NULL
+			    test_spdk_nvme_poll_group_get_free_stats) == NULL ||
+		CU_add_test(suite, "nvme_poll_group_interrupt", test_spdk_nvme_poll_group_interrupt) == NULL ||
+		CU_add_test(suite, "nvme_poll_group_interrupt_no_fd",
+			    test_spdk_nvme_poll_group_interrupt_no_fd) == NULL ||
+		CU_add_test(suite, "nvme_poll_group_shared_requests",
+			    test_spdk_nvme_poll_group_shared_requests) == NULL ||
+		CU_add_test(suite, "nvme_poll_group_submit_batch",
+			    test_spdk_nvme_poll_group_submit_batch) == NULL
 	) {
 		CU_cleanup_registry();
 		return CU_get_error();
@@ -64,6 +64,16 @@ DEFINE_STUB(spdk_nvmf_subsystem_host_allowed,
 	    (struct spdk_nvmf_subsystem *subsystem, const char *hostnqn),
 	    true);
 
+#define UT_HOSTNQN1 "nqn.2016-06.io.spdk:host1"
+#define UT_HOSTNQN2 "nqn.2016-06.io.spdk:host2"
+
+uint32_t
+nvmf_subsystem_get_host_weight(struct spdk_nvmf_subsystem *subsystem, const char *hostnqn)
+{
+	/* UT_HOSTNQN1 gets three times the share of the other hosts */
+	return strcmp(hostnqn, UT_HOSTNQN1) == 0 ? 3 : 1;
+}
+
 DEFINE_STUB(nvmf_subsystem_add_ctrlr,
 	    int,
 	    (struct spdk_nvmf_subsystem *subsystem, struct spdk_nvmf_ctrlr *ctrlr),
@@ -238,6 +248,18 @@ nvmf_bdev_ctrlr_identify_ns(struct spdk_nvmf_ns *ns, struct spdk_nvme_ns_data *n
 	nsdata->lbaf[0].lbads = spdk_u32log2(512);
 }
 
+uint32_t
+spdk_bdev_get_block_size(const struct spdk_bdev *bdev)
+{
+	return bdev->blocklen;
+}
+
+uint64_t
+spdk_bdev_get_num_blocks(const struct spdk_bdev *bdev)
+{
+	return bdev->blockcnt;
+}
+
 struct spdk_nvmf_ns *
 spdk_nvmf_subsystem_get_first_ns(struct spdk_nvmf_subsystem *subsystem)
 {
@@ -3074,6 +3096,387 @@ test_nvmf_ctrlr_set_features_host_behavior_support(void)
 	CU_ASSERT(req.rsp->nvme_cpl.status.sc == SPDK_NVME_SC_INVALID_FIELD);
 }
 
+static struct spdk_nvmf_request *
+ut_fq_get_running_req(struct spdk_nvmf_request reqs[2][5], int *host)
+{
+	int i, j;
+
+	for (i = 0; i < 2; i++) {
+		for (j = 0; j < 5; j++) {
+			if (reqs[i][j].fq_tracked) {
+				*host = i;
+				return &reqs[i][j];
+			}
+		}
+	}
+
+	return NULL;
+}
+
+static void
+test_fair_queuing(void)
+{
+	struct spdk_nvmf_subsystem subsystem = {};
+	struct spdk_nvmf_ns ns = {};
+	struct spdk_nvmf_ns *subsys_ns[1] = {};
+	enum spdk_nvme_ana_state ana_state[1];
+	struct spdk_nvmf_subsystem_listener listener = { .ana_state = ana_state };
+	struct spdk_bdev bdev = { .blockcnt = 100, .blocklen = 512};
+	struct spdk_nvmf_transport transport = {};
+	struct spdk_nvmf_poll_group group = {};
+	struct spdk_nvmf_subsystem_poll_group sgroups = {};
+	struct spdk_nvmf_subsystem_pg_ns_info ns_info = {};
+	struct spdk_io_channel io_ch = {};
+	struct spdk_nvmf_ctrlr ctrlr[2] = {};
+	struct spdk_nvmf_qpair qpair[2] = {};
+	struct spdk_nvmf_request reqs[2][5] = {};
+	struct spdk_nvme_cmd cmds[2][5] = {};
+	union nvmf_c2h_msg rsps[2][5] = {};
+	struct spdk_nvmf_request *req;
+	int dispatched[2] = {};
+	int i, j, host;
+
+	ns.nsid = 1;
+	ns.bdev = &bdev;
+	ns.anagrpid = 1;
+	ns.weight = 1;
+	ns.subsystem = &subsystem;
+
+	subsystem.id = 0;
+	subsystem.max_nsid = 1;
+	subsys_ns[0] = &ns;
+	subsystem.ns = (struct spdk_nvmf_ns **)&subsys_ns;
+	/* Run a single command at a time */
+	subsystem.fq_max_inflight = 1;
+
+	listener.ana_state[0] = SPDK_NVME_ANA_OPTIMIZED_STATE;
+
+	group.thread = spdk_get_thread();
+	group.num_sgroups = 1;
+	sgroups.state = SPDK_NVMF_SUBSYSTEM_ACTIVE;
+	sgroups.num_ns = 1;
+	ns_info.state = SPDK_NVMF_SUBSYSTEM_ACTIVE;
+	ns_info.channel = &io_ch;
+	sgroups.ns_info = &ns_info;
+	TAILQ_INIT(&sgroups.queued);
+	TAILQ_INIT(&sgroups.fq_flows);
+	group.sgroups = &sgroups;
+
+	snprintf(ctrlr[0].hostnqn, sizeof(ctrlr[0].hostnqn), "%s", UT_HOSTNQN1);
+	snprintf(ctrlr[1].hostnqn, sizeof(ctrlr[1].hostnqn), "%s", UT_HOSTNQN2);
+
+	for (i = 0; i < 2; i++) {
+		ctrlr[i].vcprop.cc.bits.en = 1;
+		ctrlr[i].subsys = &subsystem;
+		ctrlr[i].listener = &listener;
+
+		TAILQ_INIT(&qpair[i].outstanding);
+		qpair[i].ctrlr = &ctrlr[i];
+		qpair[i].group = &group;
+		qpair[i].transport = &transport;
+		qpair[i].qid = 1;
+		qpair[i].state = SPDK_NVMF_QPAIR_ACTIVE;
+
+		for (j = 0; j < 5; j++) {
+			cmds[i][j].opc = SPDK_NVME_OPC_READ;
+			cmds[i][j].nsid = 1;
+			cmds[i][j].cid = j;
+			reqs[i][j].qpair = &qpair[i];
+			reqs[i][j].cmd = (union nvmf_h2c_msg *)&cmds[i][j];
+			reqs[i][j].rsp = &rsps[i][j];
+			reqs[i][j].length = 4096;
+		}
+	}
+
+	MOCK_SET(nvmf_bdev_ctrlr_read_cmd, SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS);
+
+	/* The first command runs right away */
+	spdk_nvmf_request_exec(&reqs[0][0]);
+	CU_ASSERT(reqs[0][0].fq_tracked);
+	CU_ASSERT(sgroups.fq_inflight == 1);
+	CU_ASSERT(sgroups.fq_queued == 0);
+
+	/* The others get queued in one flow per host */
+	for (j = 1; j < 5; j++) {
+		spdk_nvmf_request_exec(&reqs[0][j]);
+	}
+	for (j = 0; j < 5; j++) {
+		spdk_nvmf_request_exec(&reqs[1][j]);
+	}
+	CU_ASSERT(sgroups.fq_inflight == 1);
+	CU_ASSERT(sgroups.fq_queued == 9);
+	CU_ASSERT(ns_info.io_outstanding == 10);
+
+	/* Host 1 has three times the weight of host 2, so it gets three of the next four slots */
+	for (i = 0; i < 4; i++) {
+		req = ut_fq_get_running_req(reqs, &host);
+		SPDK_CU_ASSERT_FATAL(req != NULL);
+		_nvmf_request_complete(req);
+		CU_ASSERT(sgroups.fq_inflight == 1);
+		req = ut_fq_get_running_req(reqs, &host);
+		SPDK_CU_ASSERT_FATAL(req != NULL);
+		dispatched[host]++;
+	}
+	CU_ASSERT(dispatched[0] == 3);
+	CU_ASSERT(dispatched[1] == 1);
+	CU_ASSERT(sgroups.fq_queued == 5);
+
+	/* A queued command can be aborted by the host */
+	CU_ASSERT(nvmf_qpair_abort_fq_request(&qpair[1], 4));
+	CU_ASSERT(rsps[1][4].nvme_cpl.status.sc == SPDK_NVME_SC_ABORTED_BY_REQUEST);
+	CU_ASSERT(!nvmf_qpair_abort_fq_request(&qpair[1], 4));
+	CU_ASSERT(sgroups.fq_queued == 4);
+
+	/* Commands still queued are aborted when the qpair goes away */
+	nvmf_qpair_abort_fq_reqs(&qpair[1]);
+	for (j = 1; j < 4; j++) {
+		CU_ASSERT(rsps[1][j].nvme_cpl.status.sc == SPDK_NVME_SC_ABORTED_SQ_DELETION);
+	}
+	CU_ASSERT(sgroups.fq_queued == 1);
+	CU_ASSERT(ns_info.io_outstanding == 2);
+
+	/* Once fair queuing is disabled, the remaining commands are dispatched at once */
+	subsystem.fq_max_inflight = 0;
+	req = ut_fq_get_running_req(reqs, &host);
+	SPDK_CU_ASSERT_FATAL(req != NULL);
+	_nvmf_request_complete(req);
+	CU_ASSERT(sgroups.fq_queued == 0);
+	CU_ASSERT(sgroups.fq_inflight == 1);
+	CU_ASSERT(TAILQ_EMPTY(&sgroups.fq_flows));
+
+	req = ut_fq_get_running_req(reqs, &host);
+	SPDK_CU_ASSERT_FATAL(req != NULL);
+	_nvmf_request_complete(req);
+	CU_ASSERT(sgroups.fq_inflight == 0);
+	CU_ASSERT(ns_info.io_outstanding == 0);
+	CU_ASSERT(TAILQ_EMPTY(&qpair[0].outstanding));
+	CU_ASSERT(TAILQ_EMPTY(&qpair[1].outstanding));
+
+	/* Nothing gets queued with fair queuing disabled */
+	spdk_nvmf_request_exec(&reqs[0][0]);
+	CU_ASSERT(!reqs[0][0].fq_tracked);
+	CU_ASSERT(sgroups.fq_inflight == 0);
+	_nvmf_request_complete(&reqs[0][0]);
+
+	MOCK_CLEAR(nvmf_bdev_ctrlr_read_cmd);
+}
+
+static void
+test_passthru_io(void)
+{
+	struct spdk_nvmf_request req = {};
+	struct spdk_nvmf_qpair qpair = {};
+	struct spdk_nvmf_transport transport = {};
+	struct spdk_nvme_cmd cmd = {};
+	union nvmf_c2h_msg rsp = {};
+	struct spdk_nvmf_ctrlr ctrlr = {};
+	struct spdk_nvmf_subsystem subsystem = {};
+	struct spdk_nvmf_ns ns = {};
+	struct spdk_nvmf_ns *subsys_ns[1] = {};
+	enum spdk_nvme_ana_state ana_state[1];
+	struct spdk_nvmf_subsystem_listener listener = { .ana_state = ana_state };
+	struct spdk_bdev bdev = { .blockcnt = 100, .blocklen = 512};
+	struct spdk_nvmf_poll_group group = {};
+	struct spdk_nvmf_subsystem_poll_group sgroups = {};
+	struct spdk_nvmf_subsystem_pg_ns_info ns_info = {};
+	struct spdk_io_channel io_ch = {};
+	struct spdk_dif_ctx dif_ctx = {};
+	int rc;
+
+	ns.bdev = &bdev;
+	ns.anagrpid = 1;
+	ns.passthru_io = true;
+	ns.subsystem = &subsystem;
+
+	subsystem.id = 0;
+	subsystem.max_nsid = 1;
+	subsys_ns[0] = &ns;
+	subsystem.ns = (struct spdk_nvmf_ns **)&subsys_ns;
+
+	listener.ana_state[0] = SPDK_NVME_ANA_OPTIMIZED_STATE;
+
+	ctrlr.vcprop.cc.bits.en = 1;
+	ctrlr.subsys = &subsystem;
+	ctrlr.listener = &listener;
+	ctrlr.dif_insert_or_strip = true;
+
+	group.thread = spdk_get_thread();
+	group.num_sgroups = 1;
+	sgroups.state = SPDK_NVMF_SUBSYSTEM_ACTIVE;
+	sgroups.num_ns = 1;
+	ns_info.state = SPDK_NVMF_SUBSYSTEM_ACTIVE;
+	ns_info.channel = &io_ch;
+	sgroups.ns_info = &ns_info;
+	TAILQ_INIT(&sgroups.queued);
+	group.sgroups = &sgroups;
+	TAILQ_INIT(&qpair.outstanding);
+
+	qpair.ctrlr = &ctrlr;
+	qpair.group = &group;
+	qpair.transport = &transport;
+	qpair.qid = 1;
+	qpair.state = SPDK_NVMF_QPAIR_ACTIVE;
+
+	cmd.nsid = 1;
+	req.qpair = &qpair;
+	req.cmd = (union nvmf_h2c_msg *)&cmd;
+	req.rsp = &rsp;
+	req.length = 512;
+
+	MOCK_SET(nvmf_bdev_ctrlr_read_cmd, SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE);
+	MOCK_SET(nvmf_bdev_ctrlr_nvme_passthru_io, SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS);
+
+	/* A read is forwarded as it is to the bdev */
+	cmd.opc = SPDK_NVME_OPC_READ;
+	rc = nvmf_ctrlr_process_io_cmd(&req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS);
+
+	/* A read of more blocks than the request's buffers hold is rejected */
+	cmd.cdw12 = 7;
+	rc = nvmf_ctrlr_process_io_cmd(&req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE);
+	CU_ASSERT(rsp.nvme_cpl.status.sct == SPDK_NVME_SCT_GENERIC);
+	CU_ASSERT(rsp.nvme_cpl.status.sc == SPDK_NVME_SC_DATA_SGL_LENGTH_INVALID);
+
+	/* So is a read past the end of the namespace */
+	memset(&rsp, 0, sizeof(rsp));
+	cmd.cdw10 = 99;
+	cmd.cdw12 = 1;
+	req.length = 1024;
+	rc = nvmf_ctrlr_process_io_cmd(&req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE);
+	CU_ASSERT(rsp.nvme_cpl.status.sct == SPDK_NVME_SCT_GENERIC);
+	CU_ASSERT(rsp.nvme_cpl.status.sc == SPDK_NVME_SC_LBA_OUT_OF_RANGE);
+
+	memset(&rsp, 0, sizeof(rsp));
+	cmd.cdw10 = 0;
+	cmd.cdw12 = 0;
+	req.length = 512;
+
+	/* The data is transferred to the bdev untouched, without DIF insert/strip */
+	MOCK_SET(nvmf_bdev_ctrlr_get_dif_ctx, true);
+	CU_ASSERT(!nvmf_ctrlr_get_dif_ctx(&ctrlr, &cmd, &dif_ctx));
+	ns.passthru_io = false;
+	CU_ASSERT(nvmf_ctrlr_get_dif_ctx(&ctrlr, &cmd, &dif_ctx));
+	ns.passthru_io = true;
+	MOCK_CLEAR(nvmf_bdev_ctrlr_get_dif_ctx);
+
+	/* Reservations are still handled by the target */
+	cmd.opc = SPDK_NVME_OPC_RESERVATION_REPORT;
+	CU_ASSERT(nvmf_ctrlr_is_reservation_cmd(cmd.opc));
+	cmd.opc = SPDK_NVME_OPC_WRITE;
+	CU_ASSERT(!nvmf_ctrlr_is_reservation_cmd(cmd.opc));
+
+	/* Without passthrough, the read is translated to a bdev read */
+	ns.passthru_io = false;
+	cmd.opc = SPDK_NVME_OPC_READ;
+	rc = nvmf_ctrlr_process_io_cmd(&req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE);
+
+	MOCK_CLEAR(nvmf_bdev_ctrlr_read_cmd);
+	MOCK_CLEAR(nvmf_bdev_ctrlr_nvme_passthru_io);
+}
+
+static void
+test_fair_queuing_passthru_io(void)
+{
+	struct spdk_nvmf_subsystem subsystem = {};
+	struct spdk_nvmf_ns ns = {};
+	struct spdk_nvmf_ns *subsys_ns[1] = {};
+	enum spdk_nvme_ana_state ana_state[1];
+	struct spdk_nvmf_subsystem_listener listener = { .ana_state = ana_state };
+	struct spdk_bdev bdev = { .blockcnt = 100, .blocklen = 512};
+	struct spdk_nvmf_transport transport = {};
+	struct spdk_nvmf_poll_group group = {};
+	struct spdk_nvmf_subsystem_poll_group sgroups = {};
+	struct spdk_nvmf_subsystem_pg_ns_info ns_info = {};
+	struct spdk_io_channel io_ch = {};
+	struct spdk_nvmf_ctrlr ctrlr = {};
+	struct spdk_nvmf_qpair qpair = {};
+	struct spdk_nvmf_request reqs[3] = {};
+	struct spdk_nvme_cmd cmds[3] = {};
+	union nvmf_c2h_msg rsps[3] = {};
+	int i;
+
+	ns.nsid = 1;
+	ns.bdev = &bdev;
+	ns.anagrpid = 1;
+	ns.weight = 1;
+	ns.passthru_io = true;
+	ns.subsystem = &subsystem;
+
+	subsystem.id = 0;
+	subsystem.max_nsid = 1;
+	subsys_ns[0] = &ns;
+	subsystem.ns = (struct spdk_nvmf_ns **)&subsys_ns;
+	subsystem.fq_max_inflight = 1;
+
+	listener.ana_state[0] = SPDK_NVME_ANA_OPTIMIZED_STATE;
+
+	group.thread = spdk_get_thread();
+	group.num_sgroups = 1;
+	sgroups.state = SPDK_NVMF_SUBSYSTEM_ACTIVE;
+	sgroups.num_ns = 1;
+	ns_info.state = SPDK_NVMF_SUBSYSTEM_ACTIVE;
+	ns_info.channel = &io_ch;
+	sgroups.ns_info = &ns_info;
+	TAILQ_INIT(&sgroups.queued);
+	TAILQ_INIT(&sgroups.fq_flows);
+	group.sgroups = &sgroups;
+
+	snprintf(ctrlr.hostnqn, sizeof(ctrlr.hostnqn), "%s", UT_HOSTNQN1);
+	ctrlr.vcprop.cc.bits.en = 1;
+	ctrlr.subsys = &subsystem;
+	ctrlr.listener = &listener;
+
+	TAILQ_INIT(&qpair.outstanding);
+	qpair.ctrlr = &ctrlr;
+	qpair.group = &group;
+	qpair.transport = &transport;
+	qpair.qid = 1;
+	qpair.state = SPDK_NVMF_QPAIR_ACTIVE;
+
+	for (i = 0; i < 3; i++) {
+		cmds[i].opc = SPDK_NVME_OPC_READ;
+		cmds[i].nsid = 1;
+		cmds[i].cid = i;
+		reqs[i].qpair = &qpair;
+		reqs[i].cmd = (union nvmf_h2c_msg *)&cmds[i];
+		reqs[i].rsp = &rsps[i];
+		reqs[i].length = 512;
+	}
+	/* Only the passthrough path checks NLB against the request's length */
+	cmds[1].cdw12 = 7;
+
+	/* A bdev read would complete at once, the passthrough commands stay in flight */
+	MOCK_SET(nvmf_bdev_ctrlr_read_cmd, SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE);
+	MOCK_SET(nvmf_bdev_ctrlr_nvme_passthru_io, SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS);
+
+	for (i = 0; i < 3; i++) {
+		spdk_nvmf_request_exec(&reqs[i]);
+	}
+	CU_ASSERT(reqs[0].fq_tracked);
+	CU_ASSERT(sgroups.fq_inflight == 1);
+	CU_ASSERT(sgroups.fq_queued == 2);
+
+	/* The queued commands are passed through once dispatched */
+	_nvmf_request_complete(&reqs[0]);
+	CU_ASSERT(rsps[1].nvme_cpl.status.sct == SPDK_NVME_SCT_GENERIC);
+	CU_ASSERT(rsps[1].nvme_cpl.status.sc == SPDK_NVME_SC_DATA_SGL_LENGTH_INVALID);
+	CU_ASSERT(!reqs[1].fq_tracked);
+	CU_ASSERT(reqs[2].fq_tracked);
+	CU_ASSERT(sgroups.fq_inflight == 1);
+	CU_ASSERT(sgroups.fq_queued == 0);
+
+	_nvmf_request_complete(&reqs[2]);
+	CU_ASSERT(sgroups.fq_inflight == 0);
+	CU_ASSERT(ns_info.io_outstanding == 0);
+	CU_ASSERT(TAILQ_EMPTY(&qpair.outstanding));
+
+	MOCK_CLEAR(nvmf_bdev_ctrlr_read_cmd);
+	MOCK_CLEAR(nvmf_bdev_ctrlr_nvme_passthru_io);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -3113,6 +3516,9 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_nvmf_property_set);
 	CU_ADD_TEST(suite, test_nvmf_ctrlr_get_features_host_behavior_support);
 	CU_ADD_TEST(suite, test_nvmf_ctrlr_set_features_host_behavior_support);
+	CU_ADD_TEST(suite, test_fair_queuing);
+	CU_ADD_TEST(suite, test_passthru_io);
+	CU_ADD_TEST(suite, test_fair_queuing_passthru_io);
 
 	allocate_threads(1);
 	set_thread(0);
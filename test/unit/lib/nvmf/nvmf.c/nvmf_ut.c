@@ -16,6 +16,7 @@ DEFINE_STUB_V(nvmf_transport_qpair_fini, (struct spdk_nvmf_qpair *qpair,
 		void *cb_arg));
 DEFINE_STUB_V(nvmf_qpair_free_aer, (struct spdk_nvmf_qpair *qpair));
 DEFINE_STUB_V(nvmf_qpair_abort_pending_zcopy_reqs, (struct spdk_nvmf_qpair *qpair));
+DEFINE_STUB_V(nvmf_qpair_abort_fq_reqs, (struct spdk_nvmf_qpair *qpair));
 DEFINE_STUB(nvmf_transport_poll_group_create, struct spdk_nvmf_transport_poll_group *,
 	    (struct spdk_nvmf_transport *transport,
 	     struct spdk_nvmf_poll_group *group), NULL);
@@ -70,6 +71,9 @@ DEFINE_STUB(spdk_nvmf_subsystem_get_ana_reporting, bool, (struct spdk_nvmf_subsy
 DEFINE_STUB_V(spdk_nvmf_ns_get_opts, (const struct spdk_nvmf_ns *ns,
 				      struct spdk_nvmf_ns_opts *opts, size_t opts_size));
 DEFINE_STUB(spdk_nvmf_ns_get_id, uint32_t, (const struct spdk_nvmf_ns *ns), 0);
+DEFINE_STUB(spdk_nvmf_ns_get_weight, uint32_t, (const struct spdk_nvmf_ns *ns), 1);
+DEFINE_STUB(spdk_nvmf_subsystem_get_fair_queuing, uint32_t,
+	    (const struct spdk_nvmf_subsystem *subsystem), 0);
 DEFINE_STUB(spdk_nvmf_ns_get_bdev, struct spdk_bdev *, (struct spdk_nvmf_ns *ns), NULL);
 DEFINE_STUB(spdk_bdev_get_name, const char *, (const struct spdk_bdev *bdev), 0);
 DEFINE_STUB(spdk_nvmf_subsystem_get_next_ns, struct spdk_nvmf_ns *,
@@ -116,6 +120,50 @@ DEFINE_STUB_V(nvmf_update_discovery_log, (struct spdk_nvmf_tgt *tgt, const char
 DEFINE_STUB(nvmf_nqn_is_valid, bool, (const char *nqn), true);
 DEFINE_STUB(nvmf_nqn_is_discovery, bool, (const char *nqn), true);
 
+static int g_detach_rc;
+static int g_attach_rc;
+static int g_detach_count;
+static int g_attach_count;
+static int g_cancel_detach_count;
+static int g_pause_count;
+static int g_resume_count;
+
+int
+nvmf_transport_poll_group_detach(struct spdk_nvmf_transport_poll_group *group,
+				 struct spdk_nvmf_qpair *qpair)
+{
+	g_detach_count++;
+	return g_detach_rc;
+}
+
+int
+nvmf_transport_poll_group_attach(struct spdk_nvmf_transport_poll_group *group,
+				 struct spdk_nvmf_qpair *qpair)
+{
+	g_attach_count++;
+	return g_attach_rc;
+}
+
+void
+nvmf_transport_poll_group_cancel_detach(struct spdk_nvmf_transport_poll_group *group,
+					struct spdk_nvmf_qpair *qpair)
+{
+	g_cancel_detach_count++;
+}
+
+void
+nvmf_transport_poll_group_pause(struct spdk_nvmf_transport_poll_group *group)
+{
+	g_pause_count++;
+}
+
+int
+nvmf_transport_poll_group_resume(struct spdk_nvmf_transport_poll_group *group)
+{
+	g_resume_count++;
+	return 0;
+}
+
 struct spdk_io_channel {
 	struct spdk_thread		*thread;
 	struct io_device		*dev;
@@ -221,6 +269,342 @@ test_nvmf_tgt_create_poll_group(void)
 	MOCK_CLEAR(spdk_bdev_get_io_channel);
 }
 
+static int
+ut_poll_group_detach(struct spdk_nvmf_transport_poll_group *group, struct spdk_nvmf_qpair *qpair)
+{
+	return 0;
+}
+
+static int
+ut_poll_group_attach(struct spdk_nvmf_transport_poll_group *group, struct spdk_nvmf_qpair *qpair)
+{
+	return 0;
+}
+
+static const struct spdk_nvmf_transport_ops g_ut_transport_ops = {
+	.poll_group_detach = ut_poll_group_detach,
+	.poll_group_attach = ut_poll_group_attach,
+};
+
+static void
+ut_move_done(void *cb_arg, int status)
+{
+	int *move_status = cb_arg;
+
+	*move_status = status;
+}
+
+static void
+ut_poll_threads(struct spdk_thread **threads, int num_threads)
+{
+	int i;
+
+	for (i = 0; i < num_threads; i++) {
+		spdk_thread_poll(threads[i], 0, 0);
+	}
+}
+
+static void
+ut_init_move_groups(struct spdk_thread **threads, struct spdk_nvmf_poll_group *groups,
+		    struct spdk_nvmf_transport_poll_group *tgroups,
+		    struct spdk_nvmf_transport *transport)
+{
+	int i;
+
+	for (i = 0; i < 2; i++) {
+		threads[i] = spdk_thread_create(NULL, NULL);
+		SPDK_CU_ASSERT_FATAL(threads[i] != NULL);
+		groups[i].thread = threads[i];
+		TAILQ_INIT(&groups[i].qpairs);
+		TAILQ_INIT(&groups[i].tgroups);
+		tgroups[i].transport = transport;
+		tgroups[i].group = &groups[i];
+		TAILQ_INSERT_TAIL(&groups[i].tgroups, &tgroups[i], link);
+	}
+
+	transport->ops = &g_ut_transport_ops;
+	spdk_set_thread(threads[0]);
+}
+
+static void
+ut_init_move_qpair(struct spdk_nvmf_qpair *qpair, uint16_t qid, struct spdk_nvmf_ctrlr *ctrlr,
+		   struct spdk_nvmf_transport *transport, struct spdk_nvmf_poll_group *group)
+{
+	qpair->qid = qid;
+	qpair->ctrlr = ctrlr;
+	qpair->transport = transport;
+	qpair->group = group;
+	qpair->state = SPDK_NVMF_QPAIR_ACTIVE;
+	TAILQ_INIT(&qpair->outstanding);
+	TAILQ_INSERT_TAIL(&group->qpairs, qpair, link);
+	group->stat.current_io_qpairs++;
+}
+
+static void
+ut_fini_move_groups(struct spdk_thread **threads)
+{
+	int i;
+
+	for (i = 0; i < 2; i++) {
+		spdk_set_thread(threads[i]);
+		spdk_thread_exit(threads[i]);
+		while (!spdk_thread_is_exited(threads[i])) {
+			spdk_thread_poll(threads[i], 0, 0);
+		}
+		spdk_thread_destroy(threads[i]);
+	}
+	spdk_set_thread(NULL);
+}
+
+static void
+test_nvmf_qpair_move(void)
+{
+	struct spdk_thread *threads[2];
+	struct spdk_nvmf_poll_group groups[2] = {};
+	struct spdk_nvmf_transport_poll_group tgroups[2] = {};
+	struct spdk_nvmf_transport transport = {};
+	struct spdk_nvmf_ctrlr ctrlr = {};
+	struct spdk_nvmf_qpair qpair = {}, admin_qpair = {};
+	int status, rc;
+
+	ut_init_move_groups(threads, groups, tgroups, &transport);
+	ut_init_move_qpair(&qpair, 1, &ctrlr, &transport, &groups[0]);
+	ut_init_move_qpair(&admin_qpair, 0, &ctrlr, &transport, &groups[0]);
+
+	/* Admin qpairs and moves to the current poll group are rejected */
+	rc = spdk_nvmf_qpair_move(&admin_qpair, &groups[1], ut_move_done, &status);
+	CU_ASSERT(rc == -EINVAL);
+	rc = spdk_nvmf_qpair_move(&qpair, &groups[0], ut_move_done, &status);
+	CU_ASSERT(rc == -EINVAL);
+
+	/* The qpair stays in its poll group until the transport detached it */
+	g_detach_rc = -EAGAIN;
+	g_detach_count = 0;
+	g_cancel_detach_count = 0;
+	g_attach_rc = 0;
+	g_attach_count = 0;
+	status = 1;
+	rc = spdk_nvmf_qpair_move(&qpair, &groups[1], ut_move_done, &status);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(qpair.move_ctx != NULL);
+	rc = spdk_nvmf_qpair_move(&qpair, &groups[1], ut_move_done, &status);
+	CU_ASSERT(rc == -EBUSY);
+
+	ut_poll_threads(threads, 2);
+	ut_poll_threads(threads, 2);
+	CU_ASSERT(g_detach_count == 2);
+	CU_ASSERT(g_attach_count == 0);
+	CU_ASSERT(qpair.group == &groups[0]);
+	CU_ASSERT(TAILQ_FIRST(&groups[0].qpairs) == &qpair);
+	CU_ASSERT(status == 1);
+
+	/* Once detached, the qpair gets attached to the destination poll group */
+	g_detach_rc = 0;
+	spdk_thread_poll(threads[0], 0, 0);
+	CU_ASSERT(g_detach_count == 3);
+	CU_ASSERT(qpair.group == &groups[1]);
+	CU_ASSERT(TAILQ_FIRST(&groups[0].qpairs) == &admin_qpair);
+	CU_ASSERT(groups[0].stat.current_io_qpairs == 1);
+	CU_ASSERT(g_attach_count == 0);
+
+	spdk_thread_poll(threads[1], 0, 0);
+	CU_ASSERT(g_attach_count == 1);
+	CU_ASSERT(TAILQ_FIRST(&groups[1].qpairs) == &qpair);
+	CU_ASSERT(groups[1].stat.current_io_qpairs == 1);
+	CU_ASSERT(qpair.move_ctx == NULL);
+	CU_ASSERT(status == 1);
+
+	spdk_thread_poll(threads[0], 0, 0);
+	CU_ASSERT(status == 0);
+
+	/* A detach failure leaves the qpair in its poll group */
+	spdk_set_thread(threads[1]);
+	g_detach_rc = -ENOTCONN;
+	rc = spdk_nvmf_qpair_move(&qpair, &groups[0], ut_move_done, &status);
+	CU_ASSERT(rc == 0);
+	ut_poll_threads(threads, 2);
+	CU_ASSERT(status == -ENOTCONN);
+	CU_ASSERT(qpair.move_ctx == NULL);
+	CU_ASSERT(qpair.group == &groups[1]);
+	CU_ASSERT(TAILQ_FIRST(&groups[1].qpairs) == &qpair);
+	CU_ASSERT(g_cancel_detach_count == 1);
+
+	/* A qpair whose requests don't complete in time resumes in its poll group */
+	g_detach_rc = -EAGAIN;
+	g_attach_count = 0;
+	status = 1;
+	rc = spdk_nvmf_qpair_move(&qpair, &groups[0], ut_move_done, &status);
+	CU_ASSERT(rc == 0);
+	ut_poll_threads(threads, 2);
+	CU_ASSERT(status == 1);
+	CU_ASSERT(qpair.move_ctx != NULL);
+
+	spdk_delay_us(NVMF_QPAIR_MOVE_TIMEOUT_SEC * SPDK_SEC_TO_USEC);
+	ut_poll_threads(threads, 2);
+	CU_ASSERT(status == -ETIMEDOUT);
+	CU_ASSERT(qpair.move_ctx == NULL);
+	CU_ASSERT(g_cancel_detach_count == 2);
+	CU_ASSERT(g_attach_count == 0);
+	CU_ASSERT(qpair.group == &groups[1]);
+	CU_ASSERT(TAILQ_FIRST(&groups[1].qpairs) == &qpair);
+
+	/* Transports that can't detach qpairs don't support moving them */
+	transport.ops = &(const struct spdk_nvmf_transport_ops) {};
+	rc = spdk_nvmf_qpair_move(&qpair, &groups[0], ut_move_done, &status);
+	CU_ASSERT(rc == -ENOTSUP);
+
+	ut_fini_move_groups(threads);
+}
+
+static void
+test_nvmf_tgt_rebalance_move(void)
+{
+	struct spdk_thread *threads[2];
+	struct spdk_nvmf_poll_group groups[2] = {};
+	struct spdk_nvmf_transport_poll_group tgroups[2] = {};
+	struct spdk_nvmf_transport transport = {};
+	struct spdk_nvmf_ctrlr ctrlr = {};
+	struct spdk_nvmf_qpair qpairs[3] = {};
+	struct nvmf_tgt_rebalance_ctx *ctx;
+	int status = 1, i;
+
+	ut_init_move_groups(threads, groups, tgroups, &transport);
+	for (i = 0; i < 3; i++) {
+		ut_init_move_qpair(&qpairs[i], i + 1, &ctrlr, &transport, &groups[0]);
+	}
+
+	/* Loads of 2000 and 800: the qpair the closest to half of the difference is moved,
+	 * the one carrying the whole difference is not. */
+	qpairs[0].last_period_nvme_io = 1200;
+	qpairs[1].last_period_nvme_io = 300;
+	qpairs[2].last_period_nvme_io = 500;
+
+	ctx = calloc(1, sizeof(*ctx));
+	SPDK_CU_ASSERT_FATAL(ctx != NULL);
+	ctx->busiest = &groups[0];
+	ctx->busiest_load = 2000;
+	ctx->idlest = &groups[1];
+	ctx->idlest_load = 800;
+	ctx->thread = threads[0];
+	ctx->cb_fn = ut_move_done;
+	ctx->cb_arg = &status;
+
+	g_detach_rc = 0;
+	g_attach_rc = 0;
+	_nvmf_tgt_rebalance_move(ctx);
+	CU_ASSERT(qpairs[0].move_ctx == NULL);
+	CU_ASSERT(qpairs[1].move_ctx == NULL);
+	CU_ASSERT(qpairs[2].move_ctx != NULL);
+
+	for (i = 0; i < 3; i++) {
+		ut_poll_threads(threads, 2);
+	}
+	CU_ASSERT(status == 0);
+	CU_ASSERT(qpairs[2].group == &groups[1]);
+	CU_ASSERT(TAILQ_FIRST(&groups[1].qpairs) == &qpairs[2]);
+
+	/* No qpair can reduce the imbalance */
+	ctx = calloc(1, sizeof(*ctx));
+	SPDK_CU_ASSERT_FATAL(ctx != NULL);
+	ctx->busiest = &groups[0];
+	ctx->busiest_load = 1200;
+	ctx->idlest = &groups[1];
+	ctx->idlest_load = 600;
+	ctx->thread = threads[0];
+	ctx->cb_fn = ut_move_done;
+	ctx->cb_arg = &status;
+
+	qpairs[0].last_period_nvme_io = 1200;
+	qpairs[1].last_period_nvme_io = 0;
+	status = 1;
+	_nvmf_tgt_rebalance_move(ctx);
+	ut_poll_threads(threads, 2);
+	CU_ASSERT(status == 0);
+	CU_ASSERT(qpairs[0].group == &groups[0]);
+	CU_ASSERT(qpairs[1].group == &groups[0]);
+
+	ut_fini_move_groups(threads);
+}
+
+static void
+ut_polling_done(void *cb_arg, int status)
+{
+	int *polling_status = cb_arg;
+
+	*polling_status = status;
+}
+
+static void
+test_nvmf_tgt_pause_resume_polling(void)
+{
+	struct spdk_thread *thread;
+	struct spdk_nvmf_tgt tgt = {};
+	struct spdk_nvmf_transport transport = {};
+	struct spdk_nvmf_transport_poll_group transport_pg = {};
+	struct spdk_nvmf_poll_group *group;
+	struct spdk_io_channel *ch;
+	int status, rc;
+
+	thread = spdk_thread_create(NULL, NULL);
+	SPDK_CU_ASSERT_FATAL(thread != NULL);
+	spdk_set_thread(thread);
+
+	TAILQ_INIT(&tgt.transports);
+	TAILQ_INIT(&tgt.poll_groups);
+	RB_INIT(&tgt.subsystems);
+	pthread_mutex_init(&tgt.mutex, NULL);
+	tgt.max_subsystems = 1;
+	tgt.state = NVMF_TGT_RUNNING;
+	transport.tgt = &tgt;
+	TAILQ_INSERT_TAIL(&tgt.transports, &transport, link);
+	spdk_io_device_register(&tgt, nvmf_tgt_create_poll_group, nvmf_tgt_destroy_poll_group,
+				sizeof(struct spdk_nvmf_poll_group), "ut_nvmf_tgt");
+
+	/* Transport poll groups set themselves up when created, there is nothing to resume */
+	g_pause_count = 0;
+	g_resume_count = 0;
+	MOCK_SET(nvmf_transport_poll_group_create, &transport_pg);
+	ch = spdk_get_io_channel(&tgt);
+	MOCK_SET(nvmf_transport_poll_group_create, NULL);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+	group = spdk_io_channel_get_ctx(ch);
+	CU_ASSERT(group->poller != NULL);
+	CU_ASSERT(TAILQ_FIRST(&group->tgroups) == &transport_pg);
+	CU_ASSERT(g_resume_count == 0);
+
+	/* The transports are paused along with the poller */
+	status = 1;
+	rc = spdk_nvmf_tgt_pause_polling(&tgt, ut_polling_done, &status);
+	CU_ASSERT(rc == 0);
+	spdk_thread_poll(thread, 0, 0);
+	CU_ASSERT(status == 0);
+	CU_ASSERT(tgt.state == NVMF_TGT_PAUSED);
+	CU_ASSERT(group->poller == NULL);
+	CU_ASSERT(g_pause_count == 1);
+
+	/* And resumed once the poller is registered again */
+	status = 1;
+	rc = spdk_nvmf_tgt_resume_polling(&tgt, ut_polling_done, &status);
+	CU_ASSERT(rc == 0);
+	spdk_thread_poll(thread, 0, 0);
+	CU_ASSERT(status == 0);
+	CU_ASSERT(tgt.state == NVMF_TGT_RUNNING);
+	CU_ASSERT(group->poller != NULL);
+	CU_ASSERT(g_resume_count == 1);
+
+	spdk_put_io_channel(ch);
+	spdk_io_device_unregister(&tgt, NULL);
+	spdk_thread_poll(thread, 0, 0);
+	CU_ASSERT(TAILQ_EMPTY(&tgt.poll_groups));
+
+	spdk_thread_exit(thread);
+	while (!spdk_thread_is_exited(thread)) {
+		spdk_thread_poll(thread, 0, 0);
+	}
+	spdk_thread_destroy(thread);
+	pthread_mutex_destroy(&tgt.mutex);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -232,6 +616,9 @@ main(int argc, char **argv)
 	suite = CU_add_suite("nvmf", NULL, NULL);
 
 	CU_ADD_TEST(suite, test_nvmf_tgt_create_poll_group);
+	CU_ADD_TEST(suite, test_nvmf_qpair_move);
+	CU_ADD_TEST(suite, test_nvmf_tgt_rebalance_move);
+	CU_ADD_TEST(suite, test_nvmf_tgt_pause_resume_polling);
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
 	CU_cleanup_registry();
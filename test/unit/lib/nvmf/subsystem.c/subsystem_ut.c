@@ -283,6 +283,27 @@ test_spdk_nvmf_subsystem_add_ns(void)
 	CU_ASSERT(nsid == 0);
 	CU_ASSERT(subsystem.max_nsid == 1024);
 
+	/* Passthrough I/O requires a bdev supporting NVMe passthrough commands */
+	spdk_nvmf_ns_opts_get_defaults(&ns_opts, sizeof(ns_opts));
+	ns_opts.nsid = 6;
+	ns_opts.passthru_io = true;
+	nsid = spdk_nvmf_subsystem_add_ns_ext(&subsystem, "bdev1", &ns_opts, sizeof(ns_opts), NULL);
+	CU_ASSERT(nsid == 0);
+	CU_ASSERT(subsystem.ns[5] == NULL);
+
+	MOCK_SET(spdk_bdev_io_type_supported, true);
+	nsid = spdk_nvmf_subsystem_add_ns_ext(&subsystem, "bdev1", &ns_opts, sizeof(ns_opts), NULL);
+	CU_ASSERT(nsid == 6);
+	SPDK_CU_ASSERT_FATAL(subsystem.ns[nsid - 1] != NULL);
+	CU_ASSERT(subsystem.ns[nsid - 1]->passthru_io);
+	CU_ASSERT(subsystem.ns[nsid - 1]->opts.passthru_io);
+	/* Zero-copy is never used for such a namespace */
+	CU_ASSERT(!subsystem.ns[nsid - 1]->zcopy);
+	MOCK_CLEAR(spdk_bdev_io_type_supported);
+
+	rc = spdk_nvmf_subsystem_remove_ns(&subsystem, 6);
+	CU_ASSERT(rc == 0);
+
 	rc = spdk_nvmf_subsystem_remove_ns(&subsystem, 5);
 	CU_ASSERT(rc == 0);
 
@@ -1526,6 +1547,54 @@ test_spdk_nvmf_subsystem_add_host(void)
 	spdk_bit_array_free(&tgt.subsystem_ids);
 }
 
+static void
+test_spdk_nvmf_subsystem_set_host_weight(void)
+{
+	struct spdk_nvmf_tgt tgt = {};
+	struct spdk_nvmf_subsystem *subsystem = NULL;
+	const char hostnqn[] = "nqn.2016-06.io.spdk:host1";
+	const char hostnqn2[] = "nqn.2016-06.io.spdk:host2";
+	const char subsystemnqn[] = "nqn.2016-06.io.spdk:subsystem1";
+	uint32_t gen;
+	int rc;
+
+	tgt.max_subsystems = 1024;
+	tgt.subsystem_ids = spdk_bit_array_create(tgt.max_subsystems);
+	RB_INIT(&tgt.subsystems);
+
+	subsystem = spdk_nvmf_subsystem_create(&tgt, subsystemnqn, SPDK_NVMF_SUBTYPE_NVME, 0);
+	SPDK_CU_ASSERT_FATAL(subsystem != NULL);
+
+	rc = spdk_nvmf_subsystem_add_host(subsystem, hostnqn, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(nvmf_subsystem_get_host_weight(subsystem, hostnqn) == 1);
+
+	gen = subsystem->fq_weight_gen;
+	rc = spdk_nvmf_subsystem_set_host_weight(subsystem, hostnqn, 10);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(nvmf_subsystem_get_host_weight(subsystem, hostnqn) == 10);
+	CU_ASSERT(subsystem->fq_weight_gen != gen);
+
+	/* Out of range weights */
+	rc = spdk_nvmf_subsystem_set_host_weight(subsystem, hostnqn, 0);
+	CU_ASSERT(rc == -EINVAL);
+	rc = spdk_nvmf_subsystem_set_host_weight(subsystem, hostnqn, SPDK_NVMF_FQ_MAX_WEIGHT + 1);
+	CU_ASSERT(rc == -EINVAL);
+	CU_ASSERT(nvmf_subsystem_get_host_weight(subsystem, hostnqn) == 10);
+
+	/* Hosts that aren't in the list can't be given a weight, but default to 1 */
+	rc = spdk_nvmf_subsystem_set_host_weight(subsystem, hostnqn2, 2);
+	CU_ASSERT(rc == -ENOENT);
+	CU_ASSERT(nvmf_subsystem_get_host_weight(subsystem, hostnqn2) == 1);
+
+	rc = spdk_nvmf_subsystem_set_fair_queuing(subsystem, 64);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(spdk_nvmf_subsystem_get_fair_queuing(subsystem) == 64);
+
+	spdk_nvmf_subsystem_destroy(subsystem, NULL, NULL);
+	spdk_bit_array_free(&tgt.subsystem_ids);
+}
+
 static void
 test_nvmf_ns_reservation_report(void)
 {
@@ -1937,6 +2006,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_nvmf_ns_reservation_add_remove_registrant);
 	CU_ADD_TEST(suite, test_nvmf_subsystem_add_ctrlr);
 	CU_ADD_TEST(suite, test_spdk_nvmf_subsystem_add_host);
+	CU_ADD_TEST(suite, test_spdk_nvmf_subsystem_set_host_weight);
 	CU_ADD_TEST(suite, test_nvmf_ns_reservation_report);
 	CU_ADD_TEST(suite, test_nvmf_nqn_is_valid);
 	CU_ADD_TEST(suite, test_nvmf_ns_reservation_restore);
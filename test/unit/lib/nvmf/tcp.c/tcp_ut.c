@@ -86,6 +86,11 @@ DEFINE_STUB(spdk_nvmf_subsystem_host_allowed,
 	    (struct spdk_nvmf_subsystem *subsystem, const char *hostnqn),
 	    true);
 
+DEFINE_STUB(nvmf_subsystem_get_host_weight,
+	    uint32_t,
+	    (struct spdk_nvmf_subsystem *subsystem, const char *hostnqn),
+	    1);
+
 DEFINE_STUB(nvmf_ctrlr_dsm_supported,
 	    bool,
 	    (struct spdk_nvmf_ctrlr *ctrlr),
@@ -228,6 +233,8 @@ DEFINE_STUB(spdk_bdev_get_max_active_zones, uint32_t,
 DEFINE_STUB(spdk_bdev_get_max_open_zones, uint32_t,
 	    (const struct spdk_bdev *bdev), 0);
 DEFINE_STUB(spdk_bdev_is_zoned, bool, (const struct spdk_bdev *bdev), false);
+DEFINE_STUB(spdk_bdev_get_block_size, uint32_t, (const struct spdk_bdev *bdev), 512);
+DEFINE_STUB(spdk_bdev_get_num_blocks, uint64_t, (const struct spdk_bdev *bdev), 0);
 DEFINE_STUB(spdk_bdev_get_zone_size, uint64_t, (const struct spdk_bdev *bdev), 0);
 
 DEFINE_STUB(spdk_nvme_ns_get_format_index, uint32_t,
@@ -1102,6 +1109,221 @@ test_nvmf_tcp_invalid_sgl(void)
 	CU_ASSERT(tqpair.mgmt_pdu->hdr.term_req.common.pdu_type == SPDK_NVME_TCP_PDU_TYPE_C2H_TERM_REQ);
 }
 
+static void
+test_nvmf_tcp_poll_group_detach_attach(void)
+{
+	struct spdk_nvmf_tcp_transport ttransport = {};
+	struct spdk_nvmf_tcp_qpair tqpair = {};
+	struct spdk_nvmf_tcp_poll_group tcp_group[2] = {};
+	struct spdk_sock_group grp[2] = {};
+	struct spdk_nvmf_tcp_req tcp_req = {};
+	struct nvme_tcp_pdu pdu_in_progress = {};
+	int i, rc;
+
+	for (i = 0; i < 2; i++) {
+		tcp_group[i].sock_group = &grp[i];
+		TAILQ_INIT(&tcp_group[i].qpairs);
+		TAILQ_INIT(&tcp_group[i].await_req);
+		tcp_group[i].group.transport = &ttransport.transport;
+	}
+
+	TAILQ_INIT(&tqpair.tcp_req_free_queue);
+	TAILQ_INIT(&tqpair.tcp_req_working_queue);
+	tqpair.qpair.transport = &ttransport.transport;
+	tqpair.group = &tcp_group[0];
+	tqpair.pdu_in_progress = &pdu_in_progress;
+	tqpair.resource_count = 1;
+	tqpair.recv_state = NVME_TCP_PDU_RECV_STATE_AWAIT_PDU_READY;
+	TAILQ_INSERT_TAIL(&tcp_group[0].qpairs, &tqpair, link);
+
+	/* A request in flight keeps the qpair in its poll group */
+	tcp_req.state = TCP_REQUEST_STATE_EXECUTING;
+	TAILQ_INSERT_TAIL(&tqpair.tcp_req_working_queue, &tcp_req, state_link);
+	tqpair.state_cntr[TCP_REQUEST_STATE_EXECUTING] = 1;
+
+	rc = nvmf_tcp_poll_group_detach(&tcp_group[0].group, &tqpair.qpair);
+	CU_ASSERT(rc == -EAGAIN);
+	CU_ASSERT(tqpair.detaching);
+	CU_ASSERT(tqpair.group == &tcp_group[0]);
+
+	/* A cancelled detach lets the qpair start new requests again */
+	nvmf_tcp_poll_group_cancel_detach(&tcp_group[0].group, &tqpair.qpair);
+	CU_ASSERT(!tqpair.detaching);
+	CU_ASSERT(tqpair.group == &tcp_group[0]);
+
+	rc = nvmf_tcp_poll_group_detach(&tcp_group[0].group, &tqpair.qpair);
+	CU_ASSERT(rc == -EAGAIN);
+	CU_ASSERT(tqpair.detaching);
+
+	/* No new request is started meanwhile, the command waits in the await_req list */
+	pdu_in_progress.hdr.common.pdu_type = SPDK_NVME_TCP_PDU_TYPE_CAPSULE_CMD;
+	nvmf_tcp_qpair_set_recv_state(&tqpair, NVME_TCP_PDU_RECV_STATE_AWAIT_REQ);
+	TAILQ_REMOVE(&tqpair.tcp_req_working_queue, &tcp_req, state_link);
+	tcp_req.state = TCP_REQUEST_STATE_FREE;
+	TAILQ_INSERT_TAIL(&tqpair.tcp_req_free_queue, &tcp_req, state_link);
+	tqpair.state_cntr[TCP_REQUEST_STATE_EXECUTING] = 0;
+	tqpair.state_cntr[TCP_REQUEST_STATE_FREE] = 1;
+
+	nvmf_tcp_capsule_cmd_hdr_handle(&ttransport, &tqpair, &pdu_in_progress);
+	CU_ASSERT(tcp_req.state == TCP_REQUEST_STATE_FREE);
+	CU_ASSERT(tqpair.recv_state == NVME_TCP_PDU_RECV_STATE_AWAIT_REQ);
+
+	rc = nvmf_tcp_poll_group_detach(&tcp_group[0].group, &tqpair.qpair);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(tqpair.group == NULL);
+	CU_ASSERT(tqpair.sock_detached);
+	CU_ASSERT(TAILQ_EMPTY(&tcp_group[0].qpairs));
+	CU_ASSERT(TAILQ_EMPTY(&tcp_group[0].await_req));
+
+	rc = nvmf_tcp_poll_group_attach(&tcp_group[1].group, &tqpair.qpair);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(tqpair.group == &tcp_group[1]);
+	CU_ASSERT(!tqpair.detaching);
+	CU_ASSERT(!tqpair.sock_detached);
+	CU_ASSERT(TAILQ_FIRST(&tcp_group[1].await_req) == &tqpair);
+
+	/* A qpair that is being disconnected can't be moved */
+	nvmf_tcp_qpair_set_recv_state(&tqpair, NVME_TCP_PDU_RECV_STATE_QUIESCING);
+	rc = nvmf_tcp_poll_group_detach(&tcp_group[1].group, &tqpair.qpair);
+	CU_ASSERT(rc == -ENOTCONN);
+	CU_ASSERT(TAILQ_FIRST(&tcp_group[1].qpairs) == &tqpair);
+}
+
+static void
+test_nvmf_tcp_poll_group_intr(void)
+{
+	struct spdk_nvmf_tcp_transport ttransport = {};
+	struct spdk_nvmf_tcp_poll_group tgroup = {};
+	struct spdk_nvmf_tcp_qpair tqpair = {};
+	struct spdk_sock_group grp = {};
+	struct pollfd pfd = {};
+	int i, rc;
+
+	tgroup.sock_group = &grp;
+	tgroup.group.transport = &ttransport.transport;
+	STAILQ_INIT(&tgroup.group.pending_buf_queue);
+	TAILQ_INIT(&tgroup.qpairs);
+	TAILQ_INIT(&tgroup.await_req);
+	TAILQ_INSERT_TAIL(&tgroup.qpairs, &tqpair, link);
+	tqpair.group = &tgroup;
+
+	tgroup.busy_efd = eventfd(0, EFD_NONBLOCK);
+	SPDK_CU_ASSERT_FATAL(tgroup.busy_efd >= 0);
+	pfd.fd = tgroup.busy_efd;
+	pfd.events = POLLIN;
+
+	/* In poll mode, queuing a write doesn't need to wake the group up */
+	nvmf_tcp_poll_group_kick(&tgroup);
+	CU_ASSERT(!tgroup.busy);
+	CU_ASSERT(poll(&pfd, 1, 0) == 0);
+
+	/* Switching to interrupt mode polls the group once */
+	nvmf_tcp_poll_group_set_interrupt_mode(NULL, &tgroup, true);
+	CU_ASSERT(tgroup.in_interrupt);
+	CU_ASSERT(tgroup.busy);
+	CU_ASSERT(poll(&pfd, 1, 0) == 1);
+
+	/* A response waiting to be flushed keeps the group polling */
+	tqpair.state_cntr[TCP_REQUEST_STATE_TRANSFERRING_CONTROLLER_TO_HOST] = 1;
+	for (i = 0; i < NVMF_TCP_POLL_GROUP_MAX_IDLE_POLLS * 2; i++) {
+		rc = nvmf_tcp_poll_group_intr(&tgroup);
+		CU_ASSERT(rc == SPDK_POLLER_IDLE);
+	}
+	CU_ASSERT(tgroup.busy);
+	CU_ASSERT(poll(&pfd, 1, 0) == 1);
+
+	/* Once idle for long enough, it waits for the socket events again */
+	tqpair.state_cntr[TCP_REQUEST_STATE_TRANSFERRING_CONTROLLER_TO_HOST] = 0;
+	for (i = 0; i < NVMF_TCP_POLL_GROUP_MAX_IDLE_POLLS - 1; i++) {
+		nvmf_tcp_poll_group_intr(&tgroup);
+	}
+	CU_ASSERT(tgroup.busy);
+	nvmf_tcp_poll_group_intr(&tgroup);
+	CU_ASSERT(!tgroup.busy);
+	CU_ASSERT(poll(&pfd, 1, 0) == 0);
+
+	/* A write queued outside of the poller wakes it up */
+	nvmf_tcp_poll_group_kick(&tgroup);
+	CU_ASSERT(tgroup.busy);
+	CU_ASSERT(poll(&pfd, 1, 0) == 1);
+
+	/* The eventfd isn't waited on in poll mode, so it gets cleared */
+	nvmf_tcp_poll_group_set_interrupt_mode(NULL, &tgroup, false);
+	CU_ASSERT(!tgroup.in_interrupt);
+	CU_ASSERT(!tgroup.busy);
+	CU_ASSERT(poll(&pfd, 1, 0) == 0);
+
+	close(tgroup.busy_efd);
+}
+
+static void
+test_nvmf_tcp_poll_group_intr_fallback(void)
+{
+	struct spdk_nvmf_tcp_poll_group tgroup = {};
+	struct spdk_nvmf_poll_group group = {};
+	struct spdk_sock_group grp = {};
+	int rc;
+
+	tgroup.sock_group = &grp;
+	tgroup.busy_efd = -1;
+
+	/* Without an interrupt fd for the sock group, the group is left to its poller */
+	MOCK_SET(spdk_sock_group_get_interrupt_fd, -ENOTSUP);
+	rc = nvmf_tcp_poll_group_intr_init(&tgroup, &group);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(tgroup.sock_intr == NULL);
+	CU_ASSERT(tgroup.busy_intr == NULL);
+	CU_ASSERT(tgroup.busy_efd == -1);
+
+	/* A write queued outside of the poller doesn't try to wake it up */
+	nvmf_tcp_poll_group_kick(&tgroup);
+	CU_ASSERT(!tgroup.busy);
+
+	nvmf_tcp_poll_group_intr_fini(&tgroup);
+	CU_ASSERT(tgroup.busy_efd == -1);
+
+	/* Other errors still fail the poll group creation */
+	MOCK_SET(spdk_sock_group_get_interrupt_fd, -ENOMEM);
+	rc = nvmf_tcp_poll_group_intr_init(&tgroup, &group);
+	CU_ASSERT(rc == -ENOMEM);
+	CU_ASSERT(tgroup.sock_intr == NULL);
+
+	MOCK_CLEAR(spdk_sock_group_get_interrupt_fd);
+}
+
+static void
+test_nvmf_tcp_poll_group_pause_resume(void)
+{
+	struct spdk_nvmf_tcp_poll_group tgroup = {};
+	struct spdk_nvmf_poll_group group = {};
+	struct spdk_sock_group grp = {};
+	int rc;
+
+	tgroup.sock_group = &grp;
+	tgroup.group.group = &group;
+	tgroup.busy_efd = eventfd(0, EFD_NONBLOCK);
+	SPDK_CU_ASSERT_FATAL(tgroup.busy_efd >= 0);
+	tgroup.in_interrupt = true;
+	tgroup.busy = true;
+
+	/* Pausing stops the interrupts from polling the group behind the target's back */
+	nvmf_tcp_poll_group_pause(&tgroup.group);
+	CU_ASSERT(tgroup.busy_efd == -1);
+	CU_ASSERT(!tgroup.in_interrupt);
+	CU_ASSERT(!tgroup.busy);
+
+	/* A write queued while paused waits for the poller to be resumed */
+	nvmf_tcp_poll_group_kick(&tgroup);
+	CU_ASSERT(!tgroup.busy);
+
+	/* In poll mode, there's nothing to set up again on resume */
+	rc = nvmf_tcp_poll_group_resume(&tgroup.group);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(tgroup.sock_intr == NULL);
+	CU_ASSERT(tgroup.busy_intr == NULL);
+	CU_ASSERT(tgroup.busy_efd == -1);
+}
+
 static void
 test_nvmf_tcp_pdu_ch_handle(void)
 {
@@ -1264,6 +1486,152 @@ test_nvmf_tcp_pdu_ch_handle(void)
 			  struct spdk_nvme_tcp_common_pdu_hdr));
 }
 
+static void
+test_nvmf_tcp_recv_batch(void)
+{
+	struct spdk_nvmf_tcp_transport ttransport = {};
+	struct spdk_nvmf_tcp_poll_group tgroup = {};
+	struct spdk_nvmf_tcp_qpair tqpair = {};
+	struct nvme_tcp_pdu mgmt_pdu = {}, pdu_in_progress = {};
+	struct spdk_nvme_tcp_ic_req *ic_req;
+	struct spdk_nvme_tcp_common_pdu_hdr *ch;
+	uint8_t recv_buf[256] = {};
+	int rc;
+
+	ttransport.transport.opts.max_io_size = 4096;
+	TAILQ_INIT(&tgroup.qpairs);
+	TAILQ_INIT(&tgroup.await_req);
+	TAILQ_INIT(&tgroup.recv_pending);
+	tgroup.recv_buf = recv_buf;
+	tgroup.recv_buf_size = sizeof(recv_buf);
+
+	mgmt_pdu.qpair = &tqpair;
+	tqpair.mgmt_pdu = &mgmt_pdu;
+	tqpair.pdu_in_progress = &pdu_in_progress;
+	tqpair.qpair.transport = &ttransport.transport;
+	tqpair.group = &tgroup;
+	tqpair.state = NVME_TCP_QPAIR_STATE_INVALID;
+	tqpair.recv_state = NVME_TCP_PDU_RECV_STATE_AWAIT_PDU_READY;
+	TAILQ_INSERT_TAIL(&tgroup.qpairs, &tqpair, link);
+
+	/* An ICReq followed by the common header of a command capsule, received with one call */
+	ic_req = (struct spdk_nvme_tcp_ic_req *)recv_buf;
+	ic_req->common.pdu_type = SPDK_NVME_TCP_PDU_TYPE_IC_REQ;
+	ic_req->common.hlen = ic_req->common.plen = sizeof(*ic_req);
+	ch = (struct spdk_nvme_tcp_common_pdu_hdr *)(recv_buf + sizeof(*ic_req));
+	ch->pdu_type = SPDK_NVME_TCP_PDU_TYPE_CAPSULE_CMD;
+	ch->hlen = ch->plen = sizeof(struct spdk_nvme_tcp_cmd);
+
+	MOCK_SET(spdk_sock_recv, sizeof(*ic_req) + sizeof(*ch));
+	rc = nvmf_tcp_sock_process(&tqpair);
+	CU_ASSERT(rc >= 0);
+	CU_ASSERT(tqpair.state == NVME_TCP_QPAIR_STATE_INITIALIZING);
+	CU_ASSERT(mgmt_pdu.hdr.ic_resp.common.pdu_type == SPDK_NVME_TCP_PDU_TYPE_IC_RESP);
+
+	/* The capsule can't be parsed before the ICResp is sent, so its header is stashed and
+	 * the qpair waits in the recv_pending list, as the socket won't report it again.
+	 */
+	CU_ASSERT(tqpair.recv_data_len == sizeof(*ch));
+	SPDK_CU_ASSERT_FATAL(tqpair.recv_stash != NULL);
+	CU_ASSERT(tqpair.recv_data == tqpair.recv_stash);
+	CU_ASSERT(memcmp(tqpair.recv_stash, ch, sizeof(*ch)) == 0);
+	CU_ASSERT(TAILQ_FIRST(&tgroup.recv_pending) == &tqpair);
+	CU_ASSERT(nvmf_tcp_poll_group_has_pending_work(&tgroup));
+
+	/* Nothing is left to receive from the socket */
+	memset(recv_buf, 0, sizeof(recv_buf));
+	MOCK_SET(spdk_sock_recv, -1);
+	errno = EAGAIN;
+
+	rc = nvmf_tcp_sock_process(&tqpair);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(tqpair.recv_data_len == sizeof(*ch));
+	CU_ASSERT(TAILQ_FIRST(&tgroup.recv_pending) == &tqpair);
+
+	/* Once the qpair is running, the stashed header is parsed first */
+	tqpair.state = NVME_TCP_QPAIR_STATE_RUNNING;
+	rc = nvmf_tcp_sock_process(&tqpair);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(tqpair.recv_state == NVME_TCP_PDU_RECV_STATE_AWAIT_PDU_PSH);
+	CU_ASSERT(pdu_in_progress.ch_valid_bytes == sizeof(*ch));
+	CU_ASSERT(pdu_in_progress.hdr.common.pdu_type == SPDK_NVME_TCP_PDU_TYPE_CAPSULE_CMD);
+	CU_ASSERT(tqpair.recv_data_len == 0);
+	CU_ASSERT(TAILQ_EMPTY(&tgroup.recv_pending));
+
+	/* Received data is dropped once the qpair is being disconnected */
+	tqpair.recv_data = recv_buf;
+	tqpair.recv_data_len = 16;
+	TAILQ_INSERT_TAIL(&tgroup.recv_pending, &tqpair, recv_link);
+	tqpair.recv_state = NVME_TCP_PDU_RECV_STATE_QUIESCING;
+	tqpair.tcp_pdu_working_count = 1;
+	rc = nvmf_tcp_sock_process(&tqpair);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(tqpair.recv_data_len == 0);
+	CU_ASSERT(TAILQ_EMPTY(&tgroup.recv_pending));
+
+	MOCK_CLEAR(spdk_sock_recv);
+	free(tqpair.recv_stash);
+}
+
+static void
+test_nvmf_tcp_poll_group_move_recv_data(void)
+{
+	struct spdk_nvmf_tcp_transport ttransport = {};
+	struct spdk_nvmf_tcp_qpair tqpair = {};
+	struct spdk_nvmf_tcp_poll_group tcp_group[2] = {};
+	struct spdk_sock_group grp[2] = {};
+	struct spdk_nvmf_tcp_req tcp_req = {};
+	struct nvme_tcp_pdu pdu_in_progress = {};
+	uint8_t stash[16] = {};
+	int i, rc;
+
+	for (i = 0; i < 2; i++) {
+		tcp_group[i].sock_group = &grp[i];
+		TAILQ_INIT(&tcp_group[i].qpairs);
+		TAILQ_INIT(&tcp_group[i].await_req);
+		TAILQ_INIT(&tcp_group[i].recv_pending);
+		tcp_group[i].group.transport = &ttransport.transport;
+	}
+
+	TAILQ_INIT(&tqpair.tcp_req_free_queue);
+	TAILQ_INIT(&tqpair.tcp_req_working_queue);
+	tqpair.qpair.transport = &ttransport.transport;
+	tqpair.group = &tcp_group[0];
+	tqpair.pdu_in_progress = &pdu_in_progress;
+	tqpair.resource_count = 1;
+	tcp_req.state = TCP_REQUEST_STATE_FREE;
+	TAILQ_INSERT_TAIL(&tqpair.tcp_req_free_queue, &tcp_req, state_link);
+	tqpair.state_cntr[TCP_REQUEST_STATE_FREE] = 1;
+
+	/* A command capsule parked while detaching, followed by data stashed from the socket */
+	pdu_in_progress.hdr.common.pdu_type = SPDK_NVME_TCP_PDU_TYPE_CAPSULE_CMD;
+	tqpair.recv_state = NVME_TCP_PDU_RECV_STATE_AWAIT_REQ;
+	TAILQ_INSERT_TAIL(&tcp_group[0].await_req, &tqpair, link);
+	tqpair.recv_stash = stash;
+	tqpair.recv_stash_size = sizeof(stash);
+	tqpair.recv_data = stash;
+	tqpair.recv_data_len = sizeof(stash);
+	TAILQ_INSERT_TAIL(&tcp_group[0].recv_pending, &tqpair, recv_link);
+
+	/* The stashed data doesn't hold the qpair back, it moves along with it */
+	rc = nvmf_tcp_poll_group_detach(&tcp_group[0].group, &tqpair.qpair);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(tqpair.group == NULL);
+	CU_ASSERT(TAILQ_EMPTY(&tcp_group[0].await_req));
+	CU_ASSERT(TAILQ_EMPTY(&tcp_group[0].recv_pending));
+	CU_ASSERT(tqpair.recv_data == stash);
+	CU_ASSERT(tqpair.recv_data_len == sizeof(stash));
+
+	rc = nvmf_tcp_poll_group_attach(&tcp_group[1].group, &tqpair.qpair);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(tqpair.group == &tcp_group[1]);
+	CU_ASSERT(!tqpair.detaching);
+	CU_ASSERT(TAILQ_FIRST(&tcp_group[1].await_req) == &tqpair);
+	CU_ASSERT(TAILQ_FIRST(&tcp_group[1].recv_pending) == &tqpair);
+	CU_ASSERT(tqpair.recv_data_len == sizeof(stash));
+	CU_ASSERT(nvmf_tcp_poll_group_has_pending_work(&tcp_group[1]));
+}
+
 static void
 test_nvmf_tcp_tls_add_remove_credentials(void)
 {
@@ -1490,6 +1858,12 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_nvmf_tcp_check_xfer_type);
 	CU_ADD_TEST(suite, test_nvmf_tcp_invalid_sgl);
 	CU_ADD_TEST(suite, test_nvmf_tcp_pdu_ch_handle);
+	CU_ADD_TEST(suite, test_nvmf_tcp_poll_group_detach_attach);
+	CU_ADD_TEST(suite, test_nvmf_tcp_poll_group_intr);
+	CU_ADD_TEST(suite, test_nvmf_tcp_poll_group_intr_fallback);
+	CU_ADD_TEST(suite, test_nvmf_tcp_poll_group_pause_resume);
+	CU_ADD_TEST(suite, test_nvmf_tcp_recv_batch);
+	CU_ADD_TEST(suite, test_nvmf_tcp_poll_group_move_recv_data);
 	CU_ADD_TEST(suite, test_nvmf_tcp_tls_add_remove_credentials);
 	CU_ADD_TEST(suite, test_nvmf_tcp_tls_generate_psk_id);
 	CU_ADD_TEST(suite, test_nvmf_tcp_tls_generate_retained_psk);
@@ -135,6 +135,50 @@ flush(void)
 	free(req2);
 }
 
+static void
+readv_large(void)
+{
+	struct spdk_posix_sock psock = {};
+	struct spdk_sock *sock = &psock.base;
+	uint8_t wbuf[4 * MIN_SOCK_PIPE_SIZE], hdr[8], payload[4 * MIN_SOCK_PIPE_SIZE];
+	struct iovec iov[2];
+	ssize_t rc;
+	int fds[2], i;
+
+	rc = socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+	SPDK_CU_ASSERT_FATAL(rc == 0);
+	psock.fd = fds[0];
+	SPDK_CU_ASSERT_FATAL(posix_sock_alloc_pipe(&psock, MIN_SOCK_PIPE_SIZE) == 0);
+
+	for (i = 0; i < (int)sizeof(wbuf); i++) {
+		wbuf[i] = (uint8_t)i;
+	}
+	rc = write(fds[1], wbuf, sizeof(wbuf));
+	SPDK_CU_ASSERT_FATAL(rc == sizeof(wbuf));
+
+	/* A small read goes through the pipe, which then holds the start of the payload */
+	rc = posix_sock_readv(sock, &(struct iovec) {
+		.iov_base = hdr, .iov_len = sizeof(hdr)
+	}, 1);
+	CU_ASSERT(rc == sizeof(hdr));
+	CU_ASSERT(psock.pipe_has_data == true);
+
+	/* The large read drains the pipe and receives the rest in the same call */
+	iov[0].iov_base = payload;
+	iov[0].iov_len = MIN_SOCK_PIPE_SIZE;
+	iov[1].iov_base = payload + MIN_SOCK_PIPE_SIZE;
+	iov[1].iov_len = sizeof(wbuf) - sizeof(hdr) - MIN_SOCK_PIPE_SIZE;
+	rc = posix_sock_readv(sock, iov, 2);
+	CU_ASSERT(rc == sizeof(wbuf) - sizeof(hdr));
+	CU_ASSERT(psock.pipe_has_data == false);
+	CU_ASSERT(memcmp(hdr, wbuf, sizeof(hdr)) == 0);
+	CU_ASSERT(memcmp(payload, wbuf + sizeof(hdr), sizeof(wbuf) - sizeof(hdr)) == 0);
+
+	posix_sock_alloc_pipe(&psock, 0);
+	close(fds[0]);
+	close(fds[1]);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -146,6 +190,7 @@ main(int argc, char **argv)
 	suite = CU_add_suite("posix", NULL, NULL);
 
 	CU_ADD_TEST(suite, flush);
+	CU_ADD_TEST(suite, readv_large);
 
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
@@ -1236,6 +1236,55 @@ ut_sock_group_get_ctx(void)
 	CU_ASSERT(test_ctx1 == test_ctx2);
 }
 
+static int g_ut_group_efd = -1;
+
+static int
+spdk_ut_sock_group_impl_get_interrupt_fd(struct spdk_sock_group_impl *_group)
+{
+	return g_ut_group_efd;
+}
+
+static void
+sock_group_get_interrupt_fd(void)
+{
+	struct spdk_sock_group *group;
+	struct pollfd pfd = {};
+	uint64_t notify = 1;
+	int fd, rc;
+
+	group = spdk_sock_group_create(NULL);
+	SPDK_CU_ASSERT_FATAL(group != NULL);
+
+	/* The ut implementation doesn't support interrupts */
+	fd = spdk_sock_group_get_interrupt_fd(group);
+	CU_ASSERT(fd == -ENOTSUP);
+	CU_ASSERT(group->fgrp == NULL);
+
+	g_ut_net_impl.group_impl_get_interrupt_fd = spdk_ut_sock_group_impl_get_interrupt_fd;
+	g_ut_group_efd = eventfd(0, EFD_NONBLOCK);
+	SPDK_CU_ASSERT_FATAL(g_ut_group_efd >= 0);
+
+	fd = spdk_sock_group_get_interrupt_fd(group);
+	CU_ASSERT(fd >= 0);
+	CU_ASSERT(spdk_sock_group_get_interrupt_fd(group) == fd);
+
+	/* An event on any of the implementations wakes the group up */
+	pfd.fd = fd;
+	pfd.events = POLLIN;
+	CU_ASSERT(poll(&pfd, 1, 0) == 0);
+	rc = write(g_ut_group_efd, &notify, sizeof(notify));
+	CU_ASSERT(rc == sizeof(notify));
+	CU_ASSERT(poll(&pfd, 1, 0) == 1);
+
+	rc = spdk_sock_group_close(&group);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(group == NULL);
+
+	close(g_ut_group_efd);
+	g_ut_group_efd = -1;
+	g_ut_net_impl.group_impl_get_interrupt_fd = NULL;
+}
+
 int
 main(int argc, char **argv)
 {
@@ -1258,6 +1307,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, ut_sock_map);
 	CU_ADD_TEST(suite, override_impl_opts);
 	CU_ADD_TEST(suite, ut_sock_group_get_ctx);
+	CU_ADD_TEST(suite, sock_group_get_interrupt_fd);
 
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);